@@ -0,0 +1,124 @@
+/**
+ * @file ai_cache.h
+ * @brief Persistent exact-match cache for AI completions
+ *
+ * The same build error is often sent to the model several times: once per
+ * retry, again from /recover, and again in a later session. The cache keys
+ * a completion by a SHA-256 digest of everything that shapes the reply
+ * (provider, model, normalized messages, tools, temperature, max_tokens)
+ * and stores it as one JSON file per key, by default under
+ * ~/.cyxmake/ai_cache.
+ *
+ * Entries expire after a TTL and the directory is kept under a byte budget
+ * by evicting the least recently used entries. Several processes may share
+ * one directory; each keeps its own running totals and rescans the
+ * directory before evicting.
+ */
+
+#ifndef CYXMAKE_AI_CACHE_H
+#define CYXMAKE_AI_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cyxmake/ai_provider.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Hex digest plus terminator */
+#define AI_CACHE_KEY_SIZE 65
+
+typedef struct AIResponseCache AIResponseCache;
+
+/**
+ * Cache configuration
+ */
+typedef struct {
+    const char* cache_dir;   /* Directory (NULL = ~/.cyxmake/ai_cache) */
+    size_t max_bytes;        /* Size budget (0 = 64 MB) */
+    long ttl_sec;            /* Entry lifetime (0 = 7 days) */
+} AIResponseCacheConfig;
+
+/**
+ * Cache statistics (this process only, except entries/total_bytes)
+ */
+typedef struct {
+    int lookups;
+    int hits;
+    int misses;
+    int expired;             /* Lookups that found a stale entry */
+    int stores;
+    int evictions;
+    int entries;             /* Entries on disk */
+    size_t total_bytes;      /* Bytes on disk */
+} AIResponseCacheStats;
+
+/**
+ * Get the default configuration
+ */
+AIResponseCacheConfig ai_response_cache_config_default(void);
+
+/**
+ * Open a cache, creating its directory if needed
+ * @param config Configuration (NULL = defaults)
+ * @return Cache (caller frees with ai_response_cache_close) or NULL
+ */
+AIResponseCache* ai_response_cache_open(const AIResponseCacheConfig* config);
+
+/**
+ * Close a cache (entries stay on disk)
+ */
+void ai_response_cache_close(AIResponseCache* cache);
+
+/**
+ * Digest a list of strings into a key
+ * Text parts are normalized first: CRLF becomes LF, trailing whitespace is
+ * dropped from each line and leading/trailing blank space is trimmed. A
+ * NULL part hashes differently from an empty one.
+ * @param key Receives the hex digest
+ */
+void ai_response_cache_key(const char* const* parts, int count,
+                           char key[AI_CACHE_KEY_SIZE]);
+
+/**
+ * Compute the key for a completion request sent to a provider
+ * Provider defaults are folded in, so a request relying on the configured
+ * max_tokens matches one that sets the same value explicitly.
+ */
+void ai_response_cache_request_key(const AIProvider* provider,
+                                   const AIRequest* request,
+                                   char key[AI_CACHE_KEY_SIZE]);
+
+/**
+ * Look up a key
+ * @return Response marked cached (caller frees with ai_response_free),
+ *         NULL on a miss or an expired entry
+ */
+AIResponse* ai_response_cache_get(AIResponseCache* cache, const char* key);
+
+/**
+ * Store a response under a key
+ * Only successful responses are stored.
+ * @return true if stored
+ */
+bool ai_response_cache_put(AIResponseCache* cache, const char* key,
+                           const AIResponse* response);
+
+/**
+ * Get statistics
+ */
+AIResponseCacheStats ai_response_cache_get_stats(AIResponseCache* cache);
+
+/**
+ * Remove every entry
+ * @return Number of entries removed
+ */
+int ai_response_cache_clear(AIResponseCache* cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CYXMAKE_AI_CACHE_H */
@@ -14,6 +14,7 @@
 #ifndef CYXMAKE_AI_PROVIDER_H
 #define CYXMAKE_AI_PROVIDER_H
 
+#include "cyxmake/threading.h"
 #include <stdbool.h>
 #include <stddef.h>
 
@@ -23,6 +24,7 @@ extern "C" {
 
 /* Forward declaration for llama.cpp context */
 typedef struct LLMContext LLMContext;
+struct AISchema;
 
 /* ========================================================================
  * Provider Types
@@ -87,6 +89,7 @@ typedef struct {
     int timeout_sec;         /* Request timeout */
     int max_tokens;          /* Max response tokens */
     float temperature;       /* Generation temperature */
+    int context_tokens;      /* Prompt context budget (0 = unlimited) */
 
     /* Custom headers */
     AIProviderHeader* headers;
@@ -123,6 +126,26 @@ typedef struct {
     char* arguments;         /* JSON arguments string */
 } AIToolCall;
 
+/**
+ * Streaming callbacks
+ * Invoked on the requesting thread while the response is still arriving.
+ * Every member is optional.
+ */
+typedef struct {
+    /* Fragment of reply text (not NUL-terminated) */
+    void (*on_token)(const char* text, size_t len, void* user_data);
+
+    /* Fragment of a tool call's arguments; id and name are set on the
+     * fragment that opens the call, NULL afterwards */
+    void (*on_tool_call_delta)(int index, const char* id, const char* name,
+                               const char* arguments_delta, void* user_data);
+
+    /* Tool call whose arguments are complete (valid until the call returns) */
+    void (*on_tool_call)(int index, const AIToolCall* call, void* user_data);
+
+    void* user_data;
+} AIStreamCallbacks;
+
 /**
  * AI completion request
  */
@@ -136,10 +159,16 @@ typedef struct {
 
     /* Optional parameters */
     char* system_prompt;     /* System prompt (added as first message) */
-    bool stream;             /* Enable streaming (not yet supported) */
+    bool stream;             /* Stream the response through stream_callbacks */
+    const AIStreamCallbacks* stream_callbacks;  /* Not owned */
 
     /* Tool calling support */
     char* tools_json;        /* JSON array of tool definitions (OpenAI format) */
+
+    /* Structured output: JSON Schema the reply must match. OpenAI-compatible
+     * and Ollama providers enforce it, Gemini switches to JSON mode, others
+     * ignore it (see ai_schema_to_json_schema) */
+    char* response_schema;
 } AIRequest;
 
 /**
@@ -161,6 +190,9 @@ typedef struct {
 
     /* Timing */
     double duration_sec;
+    double first_token_sec;  /* Time to first streamed fragment (0 if not streamed) */
+
+    bool cached;             /* Served from the response cache */
 } AIResponse;
 
 /* ========================================================================
@@ -217,6 +249,10 @@ struct AIProvider {
     AIProviderStatus status;
     char* last_error;
     void* internal;          /* Provider-specific data */
+    struct HttpPool* http_pool;     /* Shared connection pool (cloud providers) */
+    struct AIProviderHttp* http;    /* Request URL and headers, built on first use */
+    MutexHandle http_lock;          /* Guards building and freeing http */
+    struct AIResponseCache* response_cache;  /* Optional, not owned */
 };
 
 /* ========================================================================
@@ -295,6 +331,21 @@ int ai_registry_list(AIProviderRegistry* registry, const char** names, int max_n
  */
 int ai_registry_count(AIProviderRegistry* registry);
 
+/**
+ * Give the registry a response cache shared by all its providers
+ * ai_registry_load_config opens one when [ai] response_cache = true.
+ * @param registry Provider registry
+ * @param cache Cache (registry takes ownership), NULL to disable caching
+ */
+void ai_registry_set_response_cache(AIProviderRegistry* registry,
+                                    struct AIResponseCache* cache);
+
+/**
+ * Get the registry's response cache
+ * @return Cache or NULL if caching is off
+ */
+struct AIResponseCache* ai_registry_get_response_cache(AIProviderRegistry* registry);
+
 /* ========================================================================
  * Provider Operations
  * ======================================================================== */
@@ -340,6 +391,13 @@ AIProviderStatus ai_provider_status(AIProvider* provider);
  */
 const char* ai_provider_error(AIProvider* provider);
 
+/**
+ * Get the token budget for prompt context sent to this provider
+ * @param provider Provider
+ * @return Token budget (0 = unlimited)
+ */
+int ai_provider_context_tokens(AIProvider* provider);
+
 /**
  * Send a completion request
  * @param provider Provider to use
@@ -348,6 +406,15 @@ const char* ai_provider_error(AIProvider* provider);
  */
 AIResponse* ai_provider_complete(AIProvider* provider, const AIRequest* request);
 
+/**
+ * Serve repeated requests from a response cache (see ai_cache.h)
+ * Lookups happen before the request is sent and successful responses are
+ * stored. A streamed request that hits is replayed through its callbacks.
+ * @param provider Provider
+ * @param cache Cache to use (not owned), NULL to stop caching
+ */
+void ai_provider_set_response_cache(AIProvider* provider, struct AIResponseCache* cache);
+
 /**
  * Simple query (single user message)
  * @param provider Provider to use
@@ -370,6 +437,18 @@ char* ai_provider_query_with_system(AIProvider* provider,
                                      const char* user_prompt,
                                      int max_tokens);
 
+/**
+ * Query for a reply shaped by a response schema
+ * @param provider Provider to use
+ * @param prompt User prompt
+ * @param max_tokens Maximum tokens (0 for default)
+ * @param schema Expected reply shape (NULL for an unconstrained query)
+ * @return Response content (caller must free) or NULL on error; parse it
+ *         with ai_schema_parse, since not every provider can enforce it
+ */
+char* ai_provider_query_structured(AIProvider* provider, const char* prompt,
+                                   int max_tokens, const struct AISchema* schema);
+
 /* ========================================================================
  * Request/Response Helpers
  * ======================================================================== */
@@ -570,9 +649,43 @@ AIResponse* ai_provider_complete_with_retry(AIProvider* provider,
                                              const AIRequest* request,
                                              const AIRetryConfig* retry_config);
 
+/**
+ * Hedged request configuration
+ * When the primary provider has not answered within a percentile of its
+ * recent latencies, the same request is also sent to the next provider.
+ * The first success wins and the requests still running are cancelled.
+ */
+typedef struct {
+    bool enabled;              /* Hedge non-streamed requests (default: false) */
+    double percentile;         /* Primary latency percentile, 0-1 (default: 0.95) */
+    int default_delay_ms;      /* Hedge delay before enough latency history (default: 2000) */
+    int min_delay_ms;          /* Lower bound on the hedge delay (default: 50) */
+    int max_hedges;            /* Extra providers raced at most (default: 1) */
+} AIHedgeConfig;
+
+/**
+ * Get default hedging configuration (disabled)
+ */
+AIHedgeConfig ai_hedge_config_default(void);
+
+/**
+ * Configure hedging for ai_registry_complete_with_fallback
+ * Also set from [ai] hedge_requests, hedge_percentile and hedge_delay_ms.
+ */
+void ai_registry_set_hedging(AIProviderRegistry* registry, const AIHedgeConfig* config);
+
+/**
+ * Latency of a provider's recent successful requests
+ * @param percentile Percentile, 0-1
+ * @return Latency in milliseconds, 0 if no requests succeeded yet
+ */
+double ai_provider_latency_percentile(AIProvider* provider, double percentile);
+
 /**
  * Send completion request with fallback to alternative providers
  * Tries providers in order: primary, fallback from registry, then all enabled providers
+ * With hedging enabled, the first providers are raced once before falling
+ * back to sequential retries.
  * @param registry Provider registry
  * @param request Request to send
  * @param primary_provider Primary provider name (NULL for default)
@@ -0,0 +1,124 @@
+/**
+ * @file ai_schema.h
+ * @brief Response schemas for structured AI output
+ *
+ * Agent, planner and intent replies are JSON objects of a known shape. A
+ * schema describes that shape once and is used three ways:
+ * - as a GBNF grammar for llama.cpp, so the local model can only produce
+ *   text that matches (LLMRequest.grammar)
+ * - as a JSON Schema for cloud providers' structured-output or JSON modes
+ *   (AIRequest.response_schema_json)
+ * - to parse a reply: the JSON is located in the text, parsed with cJSON
+ *   and checked against the schema
+ *
+ * Schemas are plain static tables; nothing here allocates them.
+ */
+
+#ifndef CYXMAKE_AI_SCHEMA_H
+#define CYXMAKE_AI_SCHEMA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct cJSON;
+
+/**
+ * Value types
+ */
+typedef enum {
+    AI_SCHEMA_STRING = 0,
+    AI_SCHEMA_NUMBER,
+    AI_SCHEMA_INTEGER,
+    AI_SCHEMA_BOOLEAN,
+    AI_SCHEMA_OBJECT,
+    AI_SCHEMA_ARRAY
+} AISchemaType;
+
+typedef struct AISchema AISchema;
+
+/**
+ * One value in a schema
+ *
+ * Object members are generated in the order listed. A grammar always
+ * emits every member; "required" only matters when parsing replies from
+ * providers that cannot be constrained.
+ */
+struct AISchema {
+    AISchemaType type;
+    const char* name;                 /* Member name (object members only) */
+    bool required;                    /* Parsing fails if missing */
+    bool nullable;                    /* null is accepted as well */
+    const char* const* enum_values;   /* Allowed strings, NULL-terminated */
+    const AISchema* items;            /* Element schema (arrays) */
+    const AISchema* properties;       /* Members (objects) */
+    int property_count;
+};
+
+/* ========================================================================
+ * Generation
+ * ======================================================================== */
+
+/**
+ * Build a GBNF grammar whose root rule matches the schema
+ *
+ * @param schema Schema
+ * @return Grammar text (caller must free), or NULL on error
+ */
+char* ai_schema_to_gbnf(const AISchema* schema);
+
+/**
+ * Build a JSON Schema document for the schema
+ *
+ * @param schema Schema
+ * @return Compact JSON text (caller must free), or NULL on error
+ */
+char* ai_schema_to_json_schema(const AISchema* schema);
+
+/* ========================================================================
+ * Parsing
+ * ======================================================================== */
+
+/**
+ * Extract and check the JSON value in a model reply
+ *
+ * The value may be fenced (```json ... ```) or surrounded by prose; the
+ * first candidate that parses is used. Numbers and booleans sent as
+ * strings are converted. Enumerations are not enforced here, so callers
+ * map unknown values to their own defaults.
+ *
+ * @param schema Expected shape
+ * @param text Model reply
+ * @param error Receives a description on failure (may be NULL)
+ * @param error_size Size of error
+ * @return Parsed value (free with cJSON_Delete), or NULL if no JSON
+ *         matching the schema was found
+ */
+struct cJSON* ai_schema_parse(const AISchema* schema, const char* text,
+                              char* error, size_t error_size);
+
+/**
+ * Copy a string member
+ *
+ * @return Copy (caller must free), or NULL if missing, null or empty
+ */
+char* ai_json_strdup(const struct cJSON* object, const char* key);
+
+/**
+ * Get a number member, or fallback if missing or not a number
+ */
+double ai_json_number(const struct cJSON* object, const char* key, double fallback);
+
+/**
+ * Get a boolean member, or fallback if missing or not a boolean
+ */
+bool ai_json_bool(const struct cJSON* object, const char* key, bool fallback);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CYXMAKE_AI_SCHEMA_H */
@@ -0,0 +1,66 @@
+/**
+ * @file ai_stream.h
+ * @brief Incremental parser for streamed AI completions
+ *
+ * Consumes a response body in arbitrary chunks as it comes off the wire
+ * and reports reply text and tool calls through AIStreamCallbacks while
+ * assembling the final AIResponse. Handles the two framings in use:
+ * - Server-sent events (OpenAI and compatible APIs, Anthropic, Gemini)
+ * - Newline-delimited JSON (Ollama)
+ *
+ * A tool call is reported complete as soon as the stream moves past it,
+ * so callers can start executing it before the rest of the reply arrives.
+ */
+
+#ifndef CYXMAKE_AI_STREAM_H
+#define CYXMAKE_AI_STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cyxmake/ai_provider.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct AIStreamParser AIStreamParser;
+
+/**
+ * Create a parser for a provider's stream format
+ * @param type Provider type (selects framing and event schema)
+ * @param callbacks Optional callbacks (copied)
+ */
+AIStreamParser* ai_stream_parser_create(AIProviderType type,
+                                        const AIStreamCallbacks* callbacks);
+
+/**
+ * Free a parser
+ */
+void ai_stream_parser_free(AIStreamParser* parser);
+
+/**
+ * Feed the next chunk of the response body
+ * @return false once the stream reported an error (stop reading)
+ */
+bool ai_stream_parser_feed(AIStreamParser* parser, const char* data, size_t len);
+
+/**
+ * Finish the stream and build the response
+ * Tool calls still open are completed. Returns NULL if no stream event was
+ * seen, e.g. when the server answered with a plain JSON body; that body is
+ * then available from ai_stream_parser_unframed().
+ * @return Response (caller frees with ai_response_free) or NULL
+ */
+AIResponse* ai_stream_parser_finish(AIStreamParser* parser);
+
+/**
+ * Body text that was not part of any stream event
+ */
+const char* ai_stream_parser_unframed(const AIStreamParser* parser);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CYXMAKE_AI_STREAM_H */
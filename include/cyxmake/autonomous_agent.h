@@ -94,6 +94,13 @@ typedef struct {
     bool verbose;           /* Print reasoning steps */
     bool require_approval;  /* Ask before dangerous actions */
     const char* working_dir; /* Working directory for file operations */
+    int context_tokens;     /* Prompt budget for history (0 = the provider's) */
+
+    /* Streaming (NULL = wait for complete replies). Reply text is passed
+     * on as it arrives and tool calls start as soon as their arguments
+     * are complete. */
+    void (*on_token)(const char* text, size_t len, void* user_data);
+    void* stream_user_data;
 } AgentConfig;
 
 typedef struct AutonomousAgent AutonomousAgent;
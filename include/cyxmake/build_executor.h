@@ -33,6 +33,7 @@ typedef struct {
     int parallel_jobs;      /* Number of parallel jobs (0 = auto) */
     char* target;           /* Specific target to build (NULL = default) */
     char* build_dir;        /* Build directory (NULL = auto) */
+    bool local_compile;     /* Compile compile_commands.json entries in-process first ([build] local_compile) */
 } BuildOptions;
 
 /**
@@ -34,6 +34,7 @@ typedef struct {
     char* build_dir;         /* Build directory (default: "build") */
     int parallel_jobs;       /* Parallel jobs (0 = auto) */
     bool clean_first;        /* Clean before building */
+    bool local_compile;      /* Compile compile_commands.json entries in-process first */
 } BuildConfig;
 
 /**
@@ -69,6 +70,8 @@ typedef struct {
     int timeout;              /* Request timeout in seconds */
     int max_tokens;           /* Max response tokens */
     float temperature;        /* Generation temperature */
+    bool prefetch_local_model; /* Load the local model in the background at startup */
+    int local_parallel;       /* Concurrent local model queries */
 } AIConfig;
 
 /**
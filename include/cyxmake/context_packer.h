@@ -0,0 +1,115 @@
+/**
+ * @file context_packer.h
+ * @brief Fit prompt context into a token budget
+ *
+ * Conversation turns, tool output, the current error and the open file
+ * compete for a fixed number of prompt tokens. Callers add each piece as an
+ * item with a priority; packing keeps the highest-priority items whole and
+ * falls back, in order, to an excerpt (head and tail of long text), a
+ * caller-supplied summary, or dropping the item. Items keep the order they
+ * were added in, whatever was kept.
+ *
+ * Tokens are counted with a caller-supplied counter, such as the local
+ * model's tokenizer (llm_count_tokens), or llm_estimate_tokens otherwise.
+ */
+
+#ifndef CYXMAKE_CONTEXT_PACKER_H
+#define CYXMAKE_CONTEXT_PACKER_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Tokens charged per item for role and separator framing */
+#define CONTEXT_ITEM_OVERHEAD 4
+
+/**
+ * Count the tokens in text
+ */
+typedef int (*ContextTokenCounter)(const char* text, void* user_data);
+
+/**
+ * One piece of context
+ */
+typedef struct {
+    const char* text;        /* Full text (copied) */
+    const char* summary;     /* Shorter stand-in if the text does not fit (optional, copied) */
+    int priority;            /* Higher is packed first; ties favour later items */
+    bool required;           /* Always kept whole, even over budget */
+    bool excerpt;            /* May be cut to its head and tail to fit */
+} ContextItem;
+
+/**
+ * How an item was packed
+ */
+typedef enum {
+    CONTEXT_PACKED_DROPPED = 0,
+    CONTEXT_PACKED_FULL,
+    CONTEXT_PACKED_EXCERPT,
+    CONTEXT_PACKED_SUMMARY
+} ContextPackedForm;
+
+typedef struct ContextPacker ContextPacker;
+
+/**
+ * Create a packer
+ * @param token_budget Tokens available (0 or less = unlimited)
+ * @param counter Token counter (NULL = llm_estimate_tokens)
+ * @param user_data Passed to counter
+ * @return New packer (free with context_packer_free) or NULL on error
+ */
+ContextPacker* context_packer_create(int token_budget, ContextTokenCounter counter,
+                                     void* user_data);
+
+/**
+ * Free a packer and the texts it holds
+ */
+void context_packer_free(ContextPacker* packer);
+
+/**
+ * Add an item
+ * @return Item index, or -1 on error
+ */
+int context_packer_add(ContextPacker* packer, const ContextItem* item);
+
+/**
+ * Decide what to keep of each item
+ * @return Tokens used by the kept items, overhead included
+ */
+int context_packer_pack(ContextPacker* packer);
+
+/**
+ * Get the packed text of an item
+ * @return Text (owned by the packer), or NULL if the item was dropped
+ */
+const char* context_packer_text(const ContextPacker* packer, int index);
+
+/**
+ * Get how an item was packed
+ */
+ContextPackedForm context_packer_form(const ContextPacker* packer, int index);
+
+/**
+ * Number of items dropped by the last pack
+ */
+int context_packer_dropped(const ContextPacker* packer);
+
+/**
+ * Make a one-line summary of text, for use as an item's summary
+ *
+ * Keeps the first line, clipped to a short length, with "..." when
+ * anything was cut, and prefixed with "[role]: " if role is given.
+ *
+ * @param role Speaker label (optional)
+ * @param text Text to summarize
+ * @return Allocated summary (caller frees) or NULL
+ */
+char* context_summarize_first_line(const char* role, const char* text);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CYXMAKE_CONTEXT_PACKER_H */
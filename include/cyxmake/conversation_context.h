@@ -9,6 +9,7 @@
 #ifndef CYXMAKE_CONVERSATION_CONTEXT_H
 #define CYXMAKE_CONVERSATION_CONTEXT_H
 
+#include "cyxmake/context_packer.h"
 #include <stdbool.h>
 #include <time.h>
 
@@ -104,6 +105,9 @@ struct ConversationContext {
     int context_window_size;    /* Number of recent messages to include */
     bool include_file_content;  /* Include file previews in context */
     bool include_tool_output;   /* Include tool output in context */
+    int context_token_budget;   /* Tokens for the context string (0 = unlimited) */
+    ContextTokenCounter token_counter;  /* NULL = llm_estimate_tokens */
+    void* token_counter_data;
 };
 
 typedef struct ConversationContext ConversationContext;
@@ -138,17 +142,27 @@ void conversation_add_message(ConversationContext* ctx,
                                bool success);
 
 /**
- * Set current file context
+ * Set current file context and record it as a recently accessed file
  * @param ctx Conversation context
  * @param path File path
- * @param preview First N lines (can be NULL)
- * @param line_count Total lines in file
+ * @param preview First N lines (NULL to read them from the file)
+ * @param line_count Total lines in file (0 to count them from the file)
  */
 void conversation_set_file(ConversationContext* ctx,
                             const char* path,
                             const char* preview,
                             int line_count);
 
+/**
+ * Set the project snapshot included in the context string
+ * @param ctx Conversation context
+ * @param project_type Build system name (can be NULL)
+ * @param working_dir Project working directory (can be NULL)
+ */
+void conversation_set_project(ConversationContext* ctx,
+                               const char* project_type,
+                               const char* working_dir);
+
 /**
  * Set last error context
  * @param ctx Conversation context
@@ -169,8 +183,26 @@ void conversation_set_error(ConversationContext* ctx,
  */
 void conversation_clear_error(ConversationContext* ctx);
 
+/**
+ * Set the token budget for conversation_get_context_string
+ * @param ctx Conversation context
+ * @param tokens Token budget (0 = unlimited)
+ * @param counter Token counter (NULL = llm_estimate_tokens)
+ * @param user_data Passed to counter
+ */
+void conversation_set_token_budget(ConversationContext* ctx,
+                                    int tokens,
+                                    ContextTokenCounter counter,
+                                    void* user_data);
+
 /**
  * Get recent messages for LLM context
+ *
+ * The last error, current file and newest messages are kept first when
+ * the window does not fit in context_token_budget; older messages are
+ * shortened to their first line or dropped, and long tool output is cut
+ * to its head and tail.
+ *
  * @param ctx Conversation context
  * @param count Number of messages to get (0 = use context_window_size)
  * @return Formatted string for LLM (caller must free)
@@ -4,6 +4,9 @@
  *
  * Provides token-based authentication for coordinator-worker communication.
  * Supports pre-shared tokens, challenge-response, and token revocation.
+ *
+ * Token values have the form "<token_id>.<secret>". The context keeps a
+ * salted digest of the secret, never the value itself.
  */
 
 #ifndef CYXMAKE_DISTRIBUTED_AUTH_H
@@ -61,7 +64,9 @@ typedef enum {
 
 typedef struct AuthToken {
     char* token_id;               /* Unique token identifier */
-    char* token_value;            /* The actual token string */
+    char* token_value;            /* The actual token string (issued copy only) */
+    char* token_hash;             /* Salted HMAC-SHA256 of the secret (base64) */
+    char* token_salt;             /* Per-token salt */
     AuthTokenType type;           /* Token type */
     char* issuer;                 /* Who issued this token */
     char* subject;                /* Who this token is for */
@@ -81,6 +86,7 @@ typedef struct AuthToken {
     int allowed_hosts_count;
 
     struct AuthToken* next;       /* For token list */
+    struct AuthToken* id_next;    /* Hash chain by ID (context internal) */
 } AuthToken;
 
 /* ============================================================
@@ -161,7 +167,9 @@ bool auth_context_save_tokens(AuthContext* ctx, const char* path);
  * @param type Token type
  * @param subject Who this token is for (e.g., worker name)
  * @param ttl_sec Time to live (0 = use default, -1 = never expires)
- * @return New token or NULL on error
+ * @return Copy of the new token holding its value (caller frees with
+ *         auth_token_free), or NULL on error. The context keeps only the
+ *         digest, so the value cannot be recovered later.
  */
 AuthToken* auth_token_generate(AuthContext* ctx,
                                 AuthTokenType type,
@@ -181,6 +189,7 @@ AuthResult auth_token_validate(AuthContext* ctx,
 
 /**
  * Get token by value
+ * @return The stored token (owned by the context; no token_value)
  */
 AuthToken* auth_token_lookup(AuthContext* ctx, const char* token_value);
 
@@ -258,11 +267,13 @@ char* auth_generate_random_token(size_t length);
 
 /**
  * Hash a token for storage
+ * @return Base64 HMAC-SHA256 of token_value keyed by salt (caller frees)
  */
 char* auth_hash_token(const char* token_value, const char* salt);
 
 /**
- * Create HMAC signature
+ * Create HMAC-SHA256 signature
+ * @return Base64 signature (caller frees)
  */
 char* auth_create_hmac(const void* data, size_t len,
                        const void* key, size_t key_len);
@@ -274,6 +285,11 @@ bool auth_verify_hmac(const void* data, size_t len,
                       const char* signature,
                       const void* key, size_t key_len);
 
+/**
+ * Compare secrets in constant time (only the length may leak)
+ */
+bool auth_secure_equals(const char* expected, const char* presented);
+
 /* ============================================================
  * Token Structure Management
  * ============================================================ */
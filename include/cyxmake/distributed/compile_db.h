@@ -0,0 +1,116 @@
+/**
+ * @file compile_db.h
+ * @brief Streaming reader for compile_commands.json
+ *
+ * Reads a JSON compilation database one entry at a time, so a 100k-entry
+ * file never becomes a single cJSON tree. Each entry is reduced to its
+ * compiler, flags, include directories, source and output. Every string is
+ * interned, and so is every flag list and include list: the thousands of
+ * translation units of a target share one copy of their (often very long)
+ * command line, and equal lists compare equal by pointer.
+ *
+ * Entries turn into exact per-TU compile jobs, artifact cache keys and
+ * command lines for local execution.
+ */
+
+#ifndef CYXMAKE_DISTRIBUTED_COMPILE_DB_H
+#define CYXMAKE_DISTRIBUTED_COMPILE_DB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cyxmake/distributed/protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct CompileDatabase CompileDatabase;
+
+/**
+ * One translation unit; all strings are owned by the database
+ */
+typedef struct {
+    const char* directory;        /* Directory the command runs in */
+    const char* file;             /* Source file as recorded */
+    const char* output;           /* Object file (NULL if not recorded) */
+    const char* compiler;         /* argv[0] */
+    const char* const* args;      /* Flags without -c, -o, -I, depfile options
+                                     or the source; shared by entries with
+                                     the same flags */
+    int arg_count;
+    const char* const* includes;  /* -I directories, shared likewise */
+    int include_count;
+    const char* const* depfile_args; /* -MD, -MF <file> ...: per-TU names kept
+                                     apart so the flag lists stay shared */
+    int depfile_arg_count;
+} CompileCommand;
+
+typedef struct {
+    int entries;                  /* Entries loaded */
+    int skipped;                  /* Entries without a file or command */
+    size_t unique_strings;        /* Distinct strings interned */
+    size_t unique_lists;          /* Distinct flag, include and depfile lists */
+    size_t string_bytes;          /* Bytes of interned text */
+    size_t bytes_read;            /* Size of the file */
+} CompileDbStats;
+
+/**
+ * Load a compilation database
+ * @return Database, or NULL if the file is missing or not a JSON array
+ */
+CompileDatabase* compile_db_load(const char* path);
+
+/**
+ * Free a database and every string its entries point to
+ */
+void compile_db_free(CompileDatabase* db);
+
+/**
+ * Get number of entries
+ */
+int compile_db_count(const CompileDatabase* db);
+
+/**
+ * Get an entry (NULL if index is out of range)
+ */
+const CompileCommand* compile_db_get(const CompileDatabase* db, int index);
+
+/**
+ * Get load statistics
+ */
+CompileDbStats compile_db_get_stats(const CompileDatabase* db);
+
+/**
+ * Create the compile job for an entry
+ * Depfile options are left out; the worker has nowhere to put them.
+ * @return Job (caller frees with distributed_job_free) or NULL
+ */
+DistributedJob* compile_db_make_job(const CompileCommand* cmd);
+
+/**
+ * Create compile jobs for every entry, in database order
+ * @return Number of jobs stored in out_jobs (at most max_jobs)
+ */
+int compile_db_decompose(const CompileDatabase* db,
+                         DistributedJob** out_jobs,
+                         int max_jobs);
+
+/**
+ * Generate the artifact cache key for an entry's object file
+ * @return Allocated key (caller frees) or NULL
+ */
+char* compile_db_cache_key(const CompileCommand* cmd);
+
+/**
+ * Build the shell command that compiles an entry locally, depfile
+ * options included. Run it from cmd->directory.
+ * @return Allocated command (caller frees) or NULL
+ */
+char* compile_db_command_line(const CompileCommand* cmd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CYXMAKE_DISTRIBUTED_COMPILE_DB_H */
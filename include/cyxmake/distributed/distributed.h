@@ -20,6 +20,8 @@
 #include "cyxmake/distributed/auth.h"
 #include "cyxmake/distributed/work_scheduler.h"
 #include "cyxmake/distributed/artifact_cache.h"
+#include "cyxmake/distributed/file_transfer.h"
+#include "cyxmake/distributed/timer_wheel.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -50,6 +52,7 @@ typedef struct {
     bool enable_tls;              /* Enable TLS */
     char* cert_path;              /* TLS certificate */
     char* key_path;               /* TLS private key */
+    bool json_frames;             /* Send JSON text frames (debugging) */
 
     /* Authentication */
     AuthMethod auth_method;       /* Authentication method */
@@ -58,6 +61,10 @@ typedef struct {
     /* Scheduling */
     DistributionStrategy default_strategy;
     LoadBalancingAlgorithm lb_algorithm;
+    char* history_path;           /* Job duration history (default: .cyxmake/job-history) */
+    char* trace_path;             /* Append completed jobs for schedule replay (NULL = off) */
+    int max_batch_size;           /* Short compiles per JOB_BATCH request (1 = no batching) */
+    bool speculative_execution;   /* Duplicate straggling jobs onto idle workers (opt-in) */
 
     /* Limits */
     int max_workers;              /* Maximum workers */
@@ -74,6 +81,10 @@ typedef struct {
     char* cache_dir;              /* Cache directory */
     size_t cache_max_size;        /* Maximum cache size */
 
+    /* File transfer */
+    char* transfer_dir;           /* Where received files land (default: <cache_dir>/incoming) */
+    FileTransferConfig transfer;  /* Chunk size and window */
+
     /* Logging */
     char* log_file;               /* Log file path */
     int log_level;                /* Log verbosity */
@@ -134,6 +145,15 @@ typedef struct {
     int active_builds;
     int pending_jobs;
     int running_jobs;
+    int job_batches;              /* JOB_BATCH requests sent */
+    int messages_saved;           /* JOB_REQUESTs avoided by batching */
+    int speculative_launched;     /* Straggler duplicates started */
+    int speculative_wins;         /* Duplicates that finished first */
+    double speculative_wasted_sec; /* Worker time spent on losing copies */
+    int declared_slots;           /* Job slots online workers advertised */
+    int effective_slots;          /* Slots left after capacity control */
+    WorkerJobMetrics job_metrics[WORKER_JOB_TYPE_COUNT]; /* Farm-wide, by job type:
+                                     mean latency, total throughput, mean failure rate */
     size_t cache_size;
     double cache_hit_rate;
     time_t started_at;
@@ -168,6 +188,19 @@ char* coordinator_generate_worker_token(Coordinator* coord,
                                          const char* worker_name,
                                          int ttl_sec);
 
+/**
+ * Stream a file to a worker in flow-controlled chunks
+ * @param coord Coordinator
+ * @param worker_id Destination worker
+ * @param path Local file to send
+ * @param remote_name Name on the worker (NULL = basename of path)
+ * @return true if the transfer was started
+ */
+bool coordinator_send_file(Coordinator* coord,
+                           const char* worker_id,
+                           const char* path,
+                           const char* remote_name);
+
 /* ============================================================
  * Distributed Build API
  * ============================================================ */
@@ -251,6 +284,7 @@ typedef struct {
     char* name;                   /* Worker name */
     char* coordinator_url;        /* Coordinator URL (ws://host:port) */
     char* auth_token;             /* Authentication token */
+    bool json_frames;             /* Send JSON text frames (debugging) */
 
     int max_jobs;                 /* Maximum concurrent jobs */
     bool auto_detect_tools;       /* Auto-detect available tools */
@@ -261,8 +295,12 @@ typedef struct {
     int max_reconnect_attempts;   /* Max reconnect attempts */
 
     /* Sandbox */
-    bool enable_sandbox;          /* Enable sandboxed execution */
-    char* sandbox_dir;            /* Sandbox working directory */
+    bool enable_sandbox;          /* Apply resource limits to job processes */
+    char* sandbox_dir;            /* Root for per-job temp dirs (default: system temp) */
+
+    /* Outputs */
+    char* cache_dir;              /* Artifact cache for job outputs
+                                     (default: .cyxmake/worker-cache) */
 } WorkerClientConfig;
 
 /**
@@ -324,6 +362,36 @@ bool worker_client_report_result(WorkerClient* client,
                                   const char* job_id,
                                   DistributedJobResult* result);
 
+/**
+ * Get the worker ID assigned by the coordinator (NULL until WELCOME)
+ */
+const char* worker_client_get_id(WorkerClient* client);
+
+/**
+ * Get number of jobs currently executing
+ */
+int worker_client_get_active_jobs(WorkerClient* client);
+
+/**
+ * Execute a job in a fresh temporary directory under sandbox_root
+ *
+ * Compile and link jobs run the compiler directly with -o pointing into
+ * the sandbox; other job types run build_command through the shell.
+ * Relative inputs resolve against job->working_dir. The declared output is
+ * stored in the cache keyed by its content hash, which is returned in
+ * artifact_hashes. The sandbox is removed before returning.
+ *
+ * @param job Job to run
+ * @param sandbox_root Parent directory for the sandbox (NULL = system temp)
+ * @param cache Cache receiving outputs (NULL = outputs are not kept)
+ * @param restrict_resources Apply CPU/memory limits to the job process
+ * @return Result (caller frees with distributed_job_result_free)
+ */
+DistributedJobResult* worker_execute_job(const DistributedJob* job,
+                                          const char* sandbox_root,
+                                          ArtifactCache* cache,
+                                          bool restrict_resources);
+
 /* ============================================================
  * Utility Functions
  * ============================================================ */
@@ -0,0 +1,209 @@
+/**
+ * @file file_transfer.h
+ * @brief Chunked, flow-controlled file transfer for distributed builds
+ *
+ * Streams files between coordinator and workers using the
+ * FILE_TRANSFER_START / FILE_CHUNK / FILE_TRANSFER_END / FILE_TRANSFER_ACK
+ * messages. Files are read and written one chunk at a time, so memory use
+ * is bounded by chunk_size * window_chunks regardless of file size.
+ *
+ * Flow:
+ *   sender   START {transfer_id, name, size, chunk_size, window_chunks}
+ *   receiver ACK   {offset, status:"resume"}     (bytes already on disk)
+ *   sender   CHUNK {offset, crc} + binary data   (up to window_chunks in flight)
+ *   receiver ACK   {offset, status:"ok"|"retry"} (every ack_every chunks,
+ *                                                 at most window_chunks / 2)
+ *   sender   END   {size, crc}
+ *   receiver ACK   {offset, status:"complete"|"failed"}
+ *
+ * Transfer IDs are derived from the file identity (name, size, mtime), so
+ * re-sending the same file after a reconnect resumes from the receiver's
+ * partial file instead of starting over.
+ */
+
+#ifndef CYXMAKE_DISTRIBUTED_FILE_TRANSFER_H
+#define CYXMAKE_DISTRIBUTED_FILE_TRANSFER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cyxmake/distributed/protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================
+ * Configuration
+ * ============================================================ */
+
+typedef struct {
+    size_t chunk_size;            /* Bytes per FILE_CHUNK (default: 256KB) */
+    int window_chunks;            /* Unacknowledged chunks in flight (default: 8) */
+    int ack_every;                /* Receiver acks every N chunks, capped at half
+                                   * the sender's window (default: 4) */
+} FileTransferConfig;
+
+/* ============================================================
+ * Transfer State
+ * ============================================================ */
+
+typedef enum {
+    FILE_TRANSFER_PENDING,        /* START not yet acknowledged */
+    FILE_TRANSFER_ACTIVE,         /* Streaming chunks */
+    FILE_TRANSFER_COMPLETE,       /* Receiver confirmed the file */
+    FILE_TRANSFER_FAILED          /* Unrecoverable error */
+} FileTransferState;
+
+typedef struct FileTransferSender FileTransferSender;
+typedef struct FileTransferReceiver FileTransferReceiver;
+
+/**
+ * Called by the receiver when a file has been fully received and verified
+ */
+typedef void (*OnFileReceivedCallback)(
+    const char* transfer_id,
+    const char* path,
+    uint64_t size,
+    void* user_data
+);
+
+/* ============================================================
+ * Sender API
+ * ============================================================ */
+
+/**
+ * Create a sender for a local file
+ * @param path Local file to send
+ * @param remote_name Name on the receiving side (NULL = basename of path)
+ * @param config Transfer settings (NULL = defaults)
+ * @return Sender or NULL if the file cannot be opened
+ */
+FileTransferSender* file_transfer_sender_create(const char* path,
+                                                 const char* remote_name,
+                                                 const FileTransferConfig* config);
+
+/**
+ * Free sender and close the file
+ */
+void file_transfer_sender_free(FileTransferSender* sender);
+
+/**
+ * Get next message to send, or NULL if the window is full or nothing is due
+ * Returns START first, then chunks while the window allows, then END.
+ */
+ProtocolMessage* file_transfer_sender_next(FileTransferSender* sender);
+
+/**
+ * Take back the message last returned by file_transfer_sender_next after it
+ * failed to send, so the next call returns it again
+ */
+void file_transfer_sender_rewind(FileTransferSender* sender);
+
+/**
+ * Handle a FILE_TRANSFER_ACK from the receiver
+ * @return false if the ack reports failure
+ */
+bool file_transfer_sender_handle_ack(FileTransferSender* sender,
+                                     const ProtocolMessage* ack);
+
+/**
+ * Restart after a reconnect: resend START and resume from the receiver's offset
+ */
+void file_transfer_sender_restart(FileTransferSender* sender);
+
+/**
+ * Get transfer ID
+ */
+const char* file_transfer_sender_get_id(FileTransferSender* sender);
+
+/**
+ * Get transfer state
+ */
+FileTransferState file_transfer_sender_get_state(FileTransferSender* sender);
+
+/**
+ * Get bytes acknowledged by the receiver
+ */
+uint64_t file_transfer_sender_get_acked(FileTransferSender* sender);
+
+/**
+ * Get total file size
+ */
+uint64_t file_transfer_sender_get_size(FileTransferSender* sender);
+
+/* ============================================================
+ * Receiver API
+ * ============================================================ */
+
+/**
+ * Create a receiver writing files into a directory
+ */
+FileTransferReceiver* file_transfer_receiver_create(const char* dest_dir,
+                                                     const FileTransferConfig* config);
+
+/**
+ * Free receiver (partial files are kept for resume)
+ */
+void file_transfer_receiver_free(FileTransferReceiver* receiver);
+
+/**
+ * Set completion callback
+ */
+void file_transfer_receiver_set_callback(FileTransferReceiver* receiver,
+                                          OnFileReceivedCallback callback,
+                                          void* user_data);
+
+/**
+ * Handle a START, CHUNK or END message
+ * @param receiver The receiver
+ * @param msg Incoming message
+ * @param reply Receives an ACK to send back, or NULL if none is due
+ * @return false if the message was not a valid transfer message
+ */
+bool file_transfer_receiver_handle(FileTransferReceiver* receiver,
+                                   const ProtocolMessage* msg,
+                                   ProtocolMessage** reply);
+
+/**
+ * Close file handles of transfers idle longer than max_idle_sec
+ * Partial data stays on disk so a later START can resume.
+ * @return Number of transfers closed
+ */
+int file_transfer_receiver_expire(FileTransferReceiver* receiver, int max_idle_sec);
+
+/**
+ * Get number of transfers in progress
+ */
+int file_transfer_receiver_get_active_count(FileTransferReceiver* receiver);
+
+/* ============================================================
+ * Utility Functions
+ * ============================================================ */
+
+/**
+ * Create default transfer configuration
+ */
+FileTransferConfig file_transfer_config_default(void);
+
+/**
+ * Update a CRC-32 (IEEE) checksum
+ */
+uint32_t file_transfer_crc32(uint32_t crc, const void* data, size_t len);
+
+/**
+ * Check whether a message type belongs to the file transfer protocol
+ */
+bool file_transfer_is_message(ProtocolMessageType type);
+
+/**
+ * Get transfer state name
+ */
+const char* file_transfer_state_name(FileTransferState state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CYXMAKE_DISTRIBUTED_FILE_TRANSFER_H */
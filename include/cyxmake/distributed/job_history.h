@@ -0,0 +1,77 @@
+/**
+ * @file job_history.h
+ * @brief Persisted job duration history for distributed scheduling
+ *
+ * Records how long each job took, keyed by a digest of its inputs
+ * (source content, compiler and arguments), so the scheduler can estimate
+ * durations of the next build and compute critical-path priorities.
+ *
+ * The history file is plain text, one entry per line:
+ *   <digest> <seconds> <samples>
+ */
+
+#ifndef CYXMAKE_DISTRIBUTED_JOB_HISTORY_H
+#define CYXMAKE_DISTRIBUTED_JOB_HISTORY_H
+
+#include <stdbool.h>
+
+#include "cyxmake/distributed/protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct JobHistory JobHistory;
+
+/**
+ * Create a history, loading entries from path if the file exists
+ * @param path History file (NULL = in-memory only)
+ */
+JobHistory* job_history_create(const char* path);
+
+/**
+ * Free history (does not save)
+ */
+void job_history_free(JobHistory* history);
+
+/**
+ * Write the history back to its file if it changed
+ * @return false on I/O error
+ */
+bool job_history_save(JobHistory* history);
+
+/**
+ * Get the estimated duration for a digest
+ * @return Seconds, or a negative value if the digest was never recorded
+ */
+double job_history_estimate(JobHistory* history, const char* digest);
+
+/**
+ * Record an observed duration (moving average over recent samples)
+ */
+void job_history_record(JobHistory* history, const char* digest, double duration_sec);
+
+/**
+ * Get the mean of all recorded estimates
+ * @return Seconds, or a negative value if the history is empty
+ */
+double job_history_mean(JobHistory* history);
+
+/**
+ * Get number of recorded digests
+ */
+int job_history_count(JobHistory* history);
+
+/**
+ * Compute the history key for a job
+ * Compile jobs hash the source content with the compiler and arguments;
+ * other jobs hash their command line.
+ * @return Hex digest (caller frees) or NULL
+ */
+char* job_history_digest(const DistributedJob* job);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CYXMAKE_DISTRIBUTED_JOB_HISTORY_H */
@@ -0,0 +1,66 @@
+/**
+ * @file local_executor.h
+ * @brief Local multi-process compile fan-out
+ *
+ * Runs the per-TU commands of a compilation database over a bounded pool
+ * of compiler processes on this machine, without a coordinator or network
+ * stack. Concurrency is metered through a GNU make compatible jobserver:
+ * an inherited one (MAKEFLAGS --jobserver-auth) is joined, otherwise a
+ * token pipe is created and exported to the compiles, so nested tools
+ * such as `gcc -flto=jobserver` share the same budget.
+ *
+ * Every compile consults the artifact cache first and stores its object
+ * afterwards.
+ */
+
+#ifndef CYXMAKE_DISTRIBUTED_LOCAL_EXECUTOR_H
+#define CYXMAKE_DISTRIBUTED_LOCAL_EXECUTOR_H
+
+#include <stdbool.h>
+
+#include "cyxmake/build_executor.h"
+#include "cyxmake/distributed/artifact_cache.h"
+#include "cyxmake/distributed/compile_db.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int max_jobs;                 /* Concurrent compiles (0 = CPU cores) */
+    ArtifactCache* cache;         /* Object cache (NULL = always compile) */
+    bool keep_going;              /* Keep compiling after a failure */
+    bool join_jobserver;          /* Take tokens from an inherited jobserver */
+} LocalExecutorConfig;
+
+typedef struct {
+    int total;                    /* Entries in the database */
+    int compiled;                 /* Compiles that ran and succeeded */
+    int cache_hits;               /* Objects restored from the cache */
+    int failed;                   /* Compiles that failed */
+    int not_run;                  /* Entries left after a failure */
+    int peak_running;             /* Most compiles in flight at once */
+    bool shared_jobserver;        /* Tokens came from an inherited jobserver */
+} LocalBuildStats;
+
+/**
+ * Get default configuration
+ */
+LocalExecutorConfig local_executor_config_default(void);
+
+/**
+ * Compile every entry of a database
+ * Output directories are created as needed. Compiler output is collected
+ * per compile and appended to stdout_output one command at a time.
+ * @param stats Optional statistics out parameter
+ * @return Build result (caller frees with build_result_free) or NULL
+ */
+BuildResult* local_execute_compile_db(const CompileDatabase* db,
+                                      const LocalExecutorConfig* config,
+                                      LocalBuildStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CYXMAKE_DISTRIBUTED_LOCAL_EXECUTOR_H */
@@ -80,6 +80,11 @@ typedef struct NetworkConfig {
     size_t max_message_size;      /* Maximum message size (default: 64MB) */
     size_t rx_buffer_size;        /* Receive buffer size */
     size_t tx_buffer_size;        /* Transmit buffer size */
+    size_t tx_high_water;         /* Queued bytes before a connection reports
+                                     backpressure (default: 1MB; relief at half) */
+
+    /* Framing */
+    ProtocolWireFormat wire_format; /* Outgoing frame format (default: binary) */
 } NetworkConfig;
 
 /* ============================================================
@@ -121,6 +126,16 @@ typedef void (*OnErrorCallback)(
     void* user_data
 );
 
+/**
+ * Called when a connection's send queue crosses the high-water mark
+ * (congested = true) or drains back below the low-water mark (false)
+ */
+typedef void (*OnBackpressureCallback)(
+    NetworkConnection* connection,
+    bool congested,
+    void* user_data
+);
+
 /* ============================================================
  * Network Server API (Coordinator)
  * ============================================================ */
@@ -133,6 +148,7 @@ typedef struct {
     OnConnectCallback on_connect;
     OnDisconnectCallback on_disconnect;
     OnErrorCallback on_error;
+    OnBackpressureCallback on_backpressure;
     void* user_data;
 } NetworkServerCallbacks;
 
@@ -179,6 +195,12 @@ void network_server_broadcast(NetworkServer* server, ProtocolMessage* msg);
  */
 int network_server_get_connection_count(NetworkServer* server);
 
+/**
+ * Get bytes queued for sending on a connection
+ */
+size_t network_server_get_pending_bytes(NetworkServer* server,
+                                         NetworkConnection* connection);
+
 /**
  * Close a specific connection
  */
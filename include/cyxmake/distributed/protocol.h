@@ -48,6 +48,7 @@ typedef enum {
     PROTO_MSG_JOB_FAILED,          /* Worker -> Coordinator: Job failed */
     PROTO_MSG_JOB_CANCEL,          /* Coordinator -> Worker: Cancel job */
     PROTO_MSG_JOB_CANCELLED,       /* Worker -> Coordinator: Job cancelled */
+    PROTO_MSG_JOB_BATCH,           /* Coordinator -> Worker: Execute several jobs */
 
     /* Artifact transfer */
     PROTO_MSG_ARTIFACT_REQUEST = 40, /* Request artifact from cache */
@@ -86,6 +87,46 @@ typedef struct ProtocolMessage {
     size_t binary_size;
 } ProtocolMessage;
 
+/* ============================================================
+ * Wire Format
+ * ============================================================ */
+
+typedef enum {
+    PROTO_WIRE_BINARY = 0,        /* Length-prefixed binary frame (default) */
+    PROTO_WIRE_JSON               /* JSON text frame (debugging) */
+} ProtocolWireFormat;
+
+typedef enum {
+    PROTO_PAYLOAD_NONE = 0,       /* No payload */
+    PROTO_PAYLOAD_JSON,           /* UTF-8 JSON text */
+    PROTO_PAYLOAD_MSGPACK         /* Reserved for MessagePack */
+} ProtocolPayloadEncoding;
+
+/*
+ * Binary frame layout (integers are little-endian):
+ *
+ *   offset  size  field
+ *   0       4     magic "CYXF"
+ *   4       1     version
+ *   5       1     message type
+ *   6       1     payload encoding (ProtocolPayloadEncoding)
+ *   7       1     reserved (0)
+ *   8       8     timestamp (ms)
+ *   16      2     id length
+ *   18      2     correlation id length
+ *   20      2     sender id length
+ *   22      2     reserved (0)
+ *   24      4     payload length
+ *   28      4     binary tail length
+ *   32      ...   id, correlation id, sender id, payload, binary tail
+ *
+ * Binary frames are sent as WebSocket binary messages so the tail
+ * (file chunks, artifacts) travels without base64 expansion.
+ */
+#define PROTO_FRAME_MAGIC "CYXF"
+#define PROTO_FRAME_VERSION 1
+#define PROTO_FRAME_HEADER_SIZE 32
+
 /* ============================================================
  * Worker Capability Flags
  * ============================================================ */
@@ -124,7 +165,10 @@ typedef enum {
     WORKER_CAP_SANDBOX        = (1 << 19),
     WORKER_CAP_DOCKER         = (1 << 20),
     WORKER_CAP_HIGH_MEMORY    = (1 << 21),
-    WORKER_CAP_SSD_STORAGE    = (1 << 22)
+    WORKER_CAP_SSD_STORAGE    = (1 << 22),
+
+    /* Protocol features */
+    WORKER_CAP_JOB_BATCH      = (1 << 23)   /* Accepts JOB_BATCH requests */
 } WorkerCapability;
 
 /* ============================================================
@@ -277,6 +321,49 @@ bool protocol_message_set_binary(ProtocolMessage* msg,
                                   const uint8_t* data,
                                   size_t size);
 
+/* ============================================================
+ * Frame Encoding API
+ * ============================================================ */
+
+/**
+ * Get the size of a message encoded as a binary frame
+ */
+size_t protocol_message_encoded_size(const ProtocolMessage* msg);
+
+/**
+ * Encode message as a binary frame into a caller-provided buffer
+ * @return Bytes written, or 0 if the buffer is too small
+ */
+size_t protocol_message_encode_to(const ProtocolMessage* msg,
+                                  uint8_t* buffer,
+                                  size_t capacity);
+
+/**
+ * Encode message in the given wire format
+ * @param msg Message to encode
+ * @param format Binary frame or JSON text
+ * @param out_size Receives the encoded length (excluding any terminator)
+ * @return Allocated frame or NULL on error
+ */
+uint8_t* protocol_message_encode(const ProtocolMessage* msg,
+                                 ProtocolWireFormat format,
+                                 size_t* out_size);
+
+/**
+ * Decode a frame in either wire format (detected from the magic)
+ */
+ProtocolMessage* protocol_message_decode(const uint8_t* data, size_t size);
+
+/**
+ * Check whether a buffer starts with a binary frame header
+ */
+bool protocol_frame_is_binary(const uint8_t* data, size_t size);
+
+/**
+ * Get wire format name as string
+ */
+const char* protocol_wire_format_name(ProtocolWireFormat format);
+
 /* ============================================================
  * Job Serialization API
  * ============================================================ */
@@ -0,0 +1,104 @@
+/**
+ * @file schedule_sim.h
+ * @brief Critical-path analysis and build schedule simulation
+ *
+ * Computes bottom-level priorities (the longest path from a job to the end
+ * of the build) over a job DAG, and replays recorded builds through a
+ * discrete-event list scheduler to compare makespan across policies.
+ *
+ * Build traces are plain text, one completed job per line:
+ *   <build_id> <job_id> <seconds> [dep_id,dep_id,...]
+ */
+
+#ifndef CYXMAKE_DISTRIBUTED_SCHEDULE_SIM_H
+#define CYXMAKE_DISTRIBUTED_SCHEDULE_SIM_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================
+ * Job DAG
+ * ============================================================ */
+
+typedef struct {
+    double duration_sec;          /* Estimated or recorded duration */
+    int* deps;                    /* Indices of jobs that must finish first */
+    int dep_count;
+} SimJob;
+
+/**
+ * Compute bottom levels: a job's duration plus the longest chain of
+ * jobs that depend on it
+ * @param jobs Job DAG (dependency indices must be in range)
+ * @param count Number of jobs
+ * @param out_levels Receives one level per job
+ * @return false if the graph has a cycle (levels of jobs on it are 0)
+ */
+bool schedule_critical_path(const SimJob* jobs, int count, double* out_levels);
+
+/* ============================================================
+ * Simulation
+ * ============================================================ */
+
+typedef enum {
+    SIM_POLICY_FIFO,              /* Ready jobs in submission order, first free worker */
+    SIM_POLICY_ROUND_ROBIN,       /* Ready jobs in submission order, rotating workers */
+    SIM_POLICY_CRITICAL_PATH      /* Longest bottom level first, fastest free worker */
+} SimPolicy;
+
+typedef struct {
+    int slots;                    /* Concurrent jobs */
+    double speed;                 /* Duration multiplier (1.0 = nominal, <1 = faster) */
+} SimWorker;
+
+/**
+ * Simulate a build and return its makespan
+ * @return Seconds until the last job finishes, or negative on a cycle or
+ *         if no worker has a slot
+ */
+double schedule_simulate(const SimJob* jobs, int count,
+                         const SimWorker* workers, int worker_count,
+                         SimPolicy policy);
+
+/**
+ * Lower bound on makespan: max(critical path, total work / capacity)
+ */
+double schedule_lower_bound(const SimJob* jobs, int count,
+                            const SimWorker* workers, int worker_count);
+
+/* ============================================================
+ * Build Traces
+ * ============================================================ */
+
+typedef struct {
+    char* build_id;
+    SimJob* jobs;
+    int count;
+} SimTrace;
+
+/**
+ * Load one build from a trace file
+ * Dependencies on jobs not in the trace are dropped.
+ * @param build_id Build to load (NULL = first build in the file)
+ * @return Trace or NULL if the file or build is missing
+ */
+SimTrace* schedule_trace_load(const char* path, const char* build_id);
+
+/**
+ * Free a trace
+ */
+void schedule_trace_free(SimTrace* trace);
+
+/**
+ * Get policy name
+ */
+const char* sim_policy_name(SimPolicy policy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CYXMAKE_DISTRIBUTED_SCHEDULE_SIM_H */
@@ -0,0 +1,61 @@
+/**
+ * @file sha256.h
+ * @brief SHA-256 and HMAC-SHA256 for authentication
+ *
+ * A self-contained implementation (FIPS 180-4, RFC 2104) so token digests
+ * and challenge responses do not depend on OpenSSL, which the build only
+ * requires for TLS.
+ */
+
+#ifndef CYXMAKE_DISTRIBUTED_SHA256_H
+#define CYXMAKE_DISTRIBUTED_SHA256_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SHA256_DIGEST_SIZE 32
+#define SHA256_BLOCK_SIZE 64
+
+typedef struct Sha256Context {
+    uint32_t state[8];
+    uint64_t length;              /* Bytes hashed so far */
+    uint8_t block[SHA256_BLOCK_SIZE];
+    size_t block_len;
+} Sha256Context;
+
+/**
+ * Start a new digest
+ */
+void sha256_init(Sha256Context* ctx);
+
+/**
+ * Hash more data
+ */
+void sha256_update(Sha256Context* ctx, const void* data, size_t len);
+
+/**
+ * Finish the digest (the context must be re-initialized before reuse)
+ */
+void sha256_final(Sha256Context* ctx, uint8_t out[SHA256_DIGEST_SIZE]);
+
+/**
+ * Hash a buffer in one call
+ */
+void sha256(const void* data, size_t len, uint8_t out[SHA256_DIGEST_SIZE]);
+
+/**
+ * Compute HMAC-SHA256 of data under key
+ */
+void hmac_sha256(const void* key, size_t key_len,
+                 const void* data, size_t len,
+                 uint8_t out[SHA256_DIGEST_SIZE]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CYXMAKE_DISTRIBUTED_SHA256_H */
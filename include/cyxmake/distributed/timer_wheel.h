@@ -0,0 +1,89 @@
+/**
+ * @file timer_wheel.h
+ * @brief Hashed timer wheel for coordinator timeouts and periodic checks
+ *
+ * Timers hash into slots by deadline tick, so scheduling and cancelling
+ * are O(1) and advancing touches only the slots that came due. Callbacks
+ * run on the thread that calls timer_wheel_advance, outside the wheel's
+ * lock, so they may schedule or cancel other timers.
+ */
+
+#ifndef CYXMAKE_DISTRIBUTED_TIMER_WHEEL_H
+#define CYXMAKE_DISTRIBUTED_TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct TimerWheel TimerWheel;
+
+/** Timer handle; 0 is never a valid timer */
+typedef uint64_t TimerId;
+
+typedef void (*TimerCallback)(void* user_data);
+
+/**
+ * Create a timer wheel
+ * @param tick_ms Resolution (timers fire up to one tick late)
+ * @param slot_count Slots per rotation; timers further out wait extra rotations
+ */
+TimerWheel* timer_wheel_create(unsigned int tick_ms, int slot_count);
+
+/**
+ * Free the wheel, releasing user data of timers that never fired
+ */
+void timer_wheel_free(TimerWheel* wheel);
+
+/**
+ * Schedule a timer
+ * @param delay_ms Delay before the first firing
+ * @param interval_ms Repeat interval (0 = fire once)
+ * @param callback Called when the timer fires
+ * @param user_data Passed to callback
+ * @param free_data Releases user_data when a one-shot timer has fired or
+ *                  any timer is cancelled (NULL = caller owns it)
+ * @return Timer ID, or 0 on allocation failure
+ */
+TimerId timer_wheel_schedule(TimerWheel* wheel,
+                             unsigned int delay_ms,
+                             unsigned int interval_ms,
+                             TimerCallback callback,
+                             void* user_data,
+                             void (*free_data)(void*));
+
+/**
+ * Cancel a pending timer
+ * @return false if the timer already fired or was cancelled
+ */
+bool timer_wheel_cancel(TimerWheel* wheel, TimerId id);
+
+/**
+ * Fire every timer due at or before now_ms
+ * @return Number of callbacks run
+ */
+int timer_wheel_advance(TimerWheel* wheel, uint64_t now_ms);
+
+/**
+ * Get milliseconds from now_ms until the next timer is due
+ * @return Delay (0 if one is already due), or -1 if no timers are pending
+ */
+int64_t timer_wheel_next_delay_ms(TimerWheel* wheel, uint64_t now_ms);
+
+/**
+ * Get number of pending timers
+ */
+int timer_wheel_count(TimerWheel* wheel);
+
+/**
+ * Monotonic clock in milliseconds (the wheel's time base)
+ */
+uint64_t timer_wheel_now_ms(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CYXMAKE_DISTRIBUTED_TIMER_WHEEL_H */
@@ -21,6 +21,8 @@
 extern "C" {
 #endif
 
+struct ProjectGraph;
+
 /* ============================================================
  * Distribution Strategy
  * ============================================================ */
@@ -39,9 +41,10 @@ typedef enum {
 typedef enum {
     LB_ROUND_ROBIN,               /* Simple round-robin */
     LB_LEAST_LOADED,              /* Prefer workers with fewer active jobs */
-    LB_LEAST_LATENCY,             /* Prefer workers with lowest network latency */
-    LB_WEIGHTED,                  /* Weight by CPU cores and job capacity */
-    LB_RANDOM                     /* Random selection (for testing) */
+    LB_LEAST_LATENCY,             /* Prefer the lowest observed job latency */
+    LB_WEIGHTED,                  /* Weight by observed job throughput */
+    LB_RANDOM,                    /* Random selection (for testing) */
+    LB_CRITICAL_PATH              /* Longest remaining path first, on the fastest workers */
 } LoadBalancingAlgorithm;
 
 /* ============================================================
@@ -103,11 +106,21 @@ typedef struct ScheduledJob {
     /* Timeout */
     int timeout_sec;              /* Job timeout */
     time_t deadline;              /* Absolute deadline */
+    uint64_t timeout_timer;       /* Owner's deadline timer handle (0 = none) */
+
+    /* Speculative execution */
+    char* speculative_worker_id;  /* Worker running a duplicate (NULL = none) */
+    time_t speculated_at;         /* When the duplicate was launched */
 
     /* Dependencies */
     char** depends_on;            /* Job IDs this depends on */
     int depends_count;
 
+    /* Critical-path scheduling */
+    char* digest;                 /* Duration history key */
+    double estimated_sec;         /* Estimated run time */
+    double critical_path_sec;     /* Estimated time from this job's start to the end of its build */
+
     /* Callbacks */
     void (*on_complete)(struct ScheduledJob*, void*);
     void (*on_failed)(struct ScheduledJob*, void*);
@@ -178,9 +191,17 @@ typedef struct {
     int max_concurrent_builds;    /* Maximum concurrent builds (default: 10) */
 
     /* Optimization */
-    bool enable_job_coalescing;   /* Combine small jobs */
-    bool enable_speculative;      /* Run speculative jobs on idle workers */
+    bool enable_job_coalescing;   /* Send short compiles to one worker as a batch (default: true) */
+    int max_batch_size;           /* Jobs per batch request (default: 16) */
+    double batch_max_job_sec;     /* Only batch jobs predicted shorter than this (default: 2.0) */
+    bool enable_speculative;      /* Duplicate stragglers onto idle workers (default: false) */
+    double speculative_factor;    /* Straggler once running this multiple of its
+                                     predicted duration (default: 2.0) */
     int min_job_size_bytes;       /* Minimum job size to distribute */
+
+    /* Duration history (paths are copied) */
+    const char* history_path;     /* Job duration history file (NULL = in-memory) */
+    const char* trace_path;       /* Append completed jobs for schedule replay (NULL = off) */
 } SchedulerConfig;
 
 /* ============================================================
@@ -220,11 +241,51 @@ typedef void (*OnBuildCompletedCallback)(
     void* user_data
 );
 
+/**
+ * Called once for several jobs assigned to the same worker in one pass,
+ * instead of on_job_assigned for each, so they can share one request.
+ * Each job still completes, fails and retries on its own.
+ */
+typedef void (*OnBatchAssignedCallback)(
+    WorkScheduler* scheduler,
+    ScheduledJob** jobs,
+    int count,
+    RemoteWorker* worker,
+    void* user_data
+);
+
+/**
+ * Called when one copy of a speculatively duplicated job is no longer
+ * needed because the other copy finished first or the job gave up. The
+ * owner should tell worker_id to cancel the job. The copy keeps its slot
+ * on worker_id until scheduler_report_copy_released.
+ */
+typedef void (*OnJobRevokedCallback)(
+    WorkScheduler* scheduler,
+    ScheduledJob* job,
+    const char* worker_id,
+    void* user_data
+);
+
+/**
+ * Called when queued work may have become assignable: a job was submitted
+ * or requeued, a worker slot was freed, or a build started. Runs with the
+ * scheduler lock held, so it should only wake whatever thread calls
+ * scheduler_process_queue, not call back into the scheduler.
+ */
+typedef void (*OnDispatchNeededCallback)(
+    WorkScheduler* scheduler,
+    void* user_data
+);
+
 typedef struct {
     OnJobAssignedCallback on_job_assigned;
+    OnBatchAssignedCallback on_batch_assigned;  /* NULL = no batching */
     OnJobCompletedCallback on_job_completed;
     OnJobFailedCallback on_job_failed;
     OnBuildCompletedCallback on_build_completed;
+    OnJobRevokedCallback on_job_revoked;
+    OnDispatchNeededCallback on_dispatch_needed;
     void* user_data;
 } SchedulerCallbacks;
 
@@ -292,8 +353,27 @@ ScheduledJob* scheduler_submit_job(WorkScheduler* scheduler,
                                     DistributedJob* job,
                                     int priority);
 
+/**
+ * Make a pending job wait for another job to complete
+ * Call before scheduler_start_build so the dependency counts toward
+ * critical-path priorities.
+ * @return false if the job is not pending
+ */
+bool scheduler_add_job_dependency(WorkScheduler* scheduler,
+                                   ScheduledJob* job,
+                                   const char* depends_on_job_id);
+
+/**
+ * Use a project include graph to estimate durations of compile jobs
+ * that have no recorded history (graph is borrowed, NULL to clear)
+ */
+void scheduler_set_project_graph(WorkScheduler* scheduler,
+                                  struct ProjectGraph* graph);
+
 /**
  * Start executing a build
+ * Computes critical-path priorities over the build's job graph and
+ * reorders the pending queue by them.
  */
 bool scheduler_start_build(WorkScheduler* scheduler, const char* build_id);
 
@@ -333,8 +413,15 @@ bool scheduler_cancel_job(WorkScheduler* scheduler,
                            const char* job_id,
                            const char* reason);
 
+/**
+ * Mark an assigned job as running (worker sent JOB_ACCEPT)
+ */
+void scheduler_report_job_started(WorkScheduler* scheduler, const char* job_id);
+
 /**
  * Report job result (called when worker reports completion)
+ * A failed result is handled like scheduler_report_job_failure. The
+ * result remains owned by the caller.
  */
 void scheduler_report_job_result(WorkScheduler* scheduler,
                                   const char* job_id,
@@ -347,6 +434,44 @@ void scheduler_report_job_failure(WorkScheduler* scheduler,
                                    const char* job_id,
                                    const char* error);
 
+/**
+ * Report a result from a specific worker
+ * While a job runs on two workers the first success wins and the other
+ * copy is revoked; a failure only drops the copy that failed. Reports
+ * from workers holding neither copy are ignored.
+ * @param worker_id Reporting worker (NULL = the job's primary worker)
+ */
+void scheduler_report_worker_result(WorkScheduler* scheduler,
+                                     const char* worker_id,
+                                     const char* job_id,
+                                     DistributedJobResult* result);
+
+/**
+ * Report a failure from a specific worker
+ * @param worker_id Reporting worker (NULL = the job's primary worker)
+ */
+void scheduler_report_worker_failure(WorkScheduler* scheduler,
+                                      const char* worker_id,
+                                      const char* job_id,
+                                      const char* error);
+
+/**
+ * Report that a revoked copy of a job has stopped on its worker
+ * Frees the worker slot the copy held since it was revoked.
+ */
+void scheduler_report_copy_released(WorkScheduler* scheduler,
+                                     const char* worker_id,
+                                     const char* job_id);
+
+/**
+ * Get the output path of a running job, if worker_id holds a copy of it
+ * Results are materialized here, never at a path the worker reports.
+ * @return Output path (caller must free), or NULL
+ */
+char* scheduler_get_job_output(WorkScheduler* scheduler,
+                               const char* worker_id,
+                               const char* job_id);
+
 /**
  * Handle worker disconnect (reschedule its jobs)
  */
@@ -369,7 +494,7 @@ int scheduler_get_running_count(WorkScheduler* scheduler);
 
 /**
  * Process queue (assign jobs to workers)
- * Call periodically or when workers become available
+ * Call when on_dispatch_needed fires or workers become available
  */
 int scheduler_process_queue(WorkScheduler* scheduler);
 
@@ -379,6 +504,22 @@ int scheduler_process_queue(WorkScheduler* scheduler);
  */
 int scheduler_check_timeouts(WorkScheduler* scheduler);
 
+/**
+ * Duplicate straggling jobs onto idle workers (no-op unless
+ * enable_speculative is set)
+ * Call periodically, after scheduler_process_queue so queued work gets
+ * free slots first.
+ * @return Number of duplicates launched
+ */
+int scheduler_speculate_stragglers(WorkScheduler* scheduler);
+
+/**
+ * Fail one job if it is still running past its deadline
+ * Lets the owner arm a timer per assignment instead of sweeping.
+ * @return true if the job timed out
+ */
+bool scheduler_check_job_timeout(WorkScheduler* scheduler, const char* job_id);
+
 /* ============================================================
  * Strategy Helpers
  * ============================================================ */
@@ -435,6 +576,16 @@ typedef struct {
     /* Worker utilization */
     double avg_worker_utilization;
     int peak_concurrent_jobs;
+
+    /* Job batching */
+    int batches_dispatched;       /* Batch requests handed to on_batch_assigned */
+    int batched_jobs;             /* Jobs sent inside those batches */
+    int messages_saved;           /* Requests avoided by batching */
+
+    /* Speculative execution */
+    int speculative_launched;     /* Duplicates started for stragglers */
+    int speculative_wins;         /* Jobs whose duplicate finished first */
+    double speculative_wasted_sec; /* Worker time spent on copies that lost */
 } SchedulerStats;
 
 /**
@@ -34,6 +34,20 @@ typedef struct WorkerTool {
     struct WorkerTool* next;      /* Linked list */
 } WorkerTool;
 
+/* ============================================================
+ * Observed Job Metrics
+ * ============================================================ */
+
+#define WORKER_JOB_TYPE_COUNT (JOB_TYPE_CUSTOM + 1)
+
+/* Exponentially weighted estimates for one job type on one worker */
+typedef struct {
+    double latency_sec;           /* Job duration */
+    double throughput;            /* Jobs/sec at the observed concurrency */
+    double failure_rate;          /* 0.0 - 1.0 */
+    int samples;                  /* Jobs observed */
+} WorkerJobMetrics;
+
 /* ============================================================
  * Remote Worker
  * ============================================================ */
@@ -58,10 +72,13 @@ typedef struct RemoteWorker {
 
     /* Job tracking */
     int active_jobs;              /* Current number of active jobs */
-    int max_jobs;                 /* Maximum concurrent jobs */
+    int max_jobs;                 /* Maximum concurrent jobs (as declared) */
+    double capacity;              /* AIMD-controlled effective slots (<= max_jobs) */
     int total_jobs_completed;     /* Total jobs completed */
     int total_jobs_failed;        /* Total jobs failed */
     double avg_job_duration_sec;  /* Average job duration */
+    double speed_factor;          /* Actual / estimated job duration (1.0 = nominal) */
+    WorkerJobMetrics metrics[WORKER_JOB_TYPE_COUNT]; /* Indexed by DistributedJobType */
 
     /* Performance metrics */
     double health_score;          /* Overall health score (0.0 - 1.0) */
@@ -71,13 +88,23 @@ typedef struct RemoteWorker {
 
     /* Network connection */
     NetworkConnection* connection; /* Active network connection */
+    bool congested;               /* Send queue above high-water mark */
 
     /* Registry internal */
     struct RemoteWorker* next;    /* Linked list for registry */
+    struct RemoteWorker* id_next; /* Hash chain by ID */
+    struct RemoteWorker* conn_next; /* Hash chain by connection */
 } RemoteWorker;
 
 /* ============================================================
  * Worker Registry
+ *
+ * Writers (registration, state changes, heartbeats) serialize on the
+ * registry mutex and keep hash indexes by ID and connection. Selection
+ * reads an immutable snapshot of the online workers instead, so it never
+ * waits for writers: a new snapshot is published whenever a worker joins,
+ * leaves, goes on or offline, or changes capabilities. Load, health and
+ * metrics are read live from each worker.
  * ============================================================ */
 
 typedef struct WorkerRegistry WorkerRegistry;
@@ -94,6 +121,11 @@ typedef struct {
     int min_available_slots;         /* Minimum job slots available */
     bool prefer_local;               /* Prefer workers on same network */
     bool prefer_idle;                /* Prefer workers with low load */
+    bool prefer_fast;                /* Prefer workers with the lowest speed factor */
+    bool prefer_throughput;          /* Prefer the highest observed throughput for job_type */
+    bool prefer_low_latency;         /* Prefer the lowest observed latency for job_type */
+    DistributedJobType job_type;     /* Metrics used by the two preferences above */
+    const char* exclude_worker_id;   /* Never select this worker (optional) */
 } WorkerSelectionCriteria;
 
 /* ============================================================
@@ -247,6 +279,14 @@ void worker_registry_foreach(WorkerRegistry* registry,
 RemoteWorker* worker_registry_select_worker(WorkerRegistry* registry,
                                               const WorkerSelectionCriteria* criteria);
 
+/**
+ * Select the next worker with a free slot in rotation
+ * @param turn Rotation position (callers increment it per selection)
+ * @return Worker or NULL if none has a free slot
+ */
+RemoteWorker* worker_registry_select_round_robin(WorkerRegistry* registry,
+                                                   unsigned int turn);
+
 /**
  * Select multiple workers for parallel job distribution
  * @param registry The registry
@@ -286,12 +326,52 @@ void worker_registry_update_job_count(WorkerRegistry* registry,
                                        int delta);
 
 /**
- * Record job completion (updates stats)
+ * Mark worker's connection as congested (skipped by worker selection)
+ */
+void worker_registry_set_congested(WorkerRegistry* registry,
+                                    RemoteWorker* worker,
+                                    bool congested);
+
+/**
+ * Apply the name, capabilities and job slots a worker advertised in HELLO
+ * @param max_jobs Job slots (<= 0 keeps the CPU-based default)
+ */
+void worker_registry_set_profile(WorkerRegistry* registry,
+                                  RemoteWorker* worker,
+                                  const char* name,
+                                  uint32_t capabilities,
+                                  int max_jobs);
+
+/**
+ * Record job completion (updates stats, metrics and effective capacity)
+ *
+ * Capacity follows AIMD: each job finishing in normal time adds
+ * 1/capacity slots, up to max_jobs; a job running far slower than this
+ * worker normally runs it (a timeout, say) halves capacity, never below
+ * one slot. Failures feed the failure rate and health only.
+ *
+ * @param type Job type, for per-type metrics
+ * @param estimated_sec Predicted duration (<= 0 = unknown, no slowdown check)
  */
 void worker_registry_record_job_complete(WorkerRegistry* registry,
                                           RemoteWorker* worker,
+                                          DistributedJobType type,
                                           bool success,
-                                          double duration_sec);
+                                          double duration_sec,
+                                          double estimated_sec);
+
+/**
+ * Get the number of jobs the worker may run right now
+ * @return Effective slot count (capacity bounded by max_jobs)
+ */
+int worker_slot_limit(const RemoteWorker* worker);
+
+/**
+ * Fold a job's actual / estimated duration ratio into the worker's speed factor
+ */
+void worker_registry_record_job_speed(WorkerRegistry* registry,
+                                       RemoteWorker* worker,
+                                       double ratio);
 
 /**
  * Check for stale workers (missed heartbeats)
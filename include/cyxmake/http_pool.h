@@ -0,0 +1,155 @@
+/**
+ * @file http_pool.h
+ * @brief Pooled HTTP client for cloud AI providers
+ *
+ * Keeps libcurl easy handles alive between requests and shares one DNS,
+ * TLS session and connection cache between them, so consecutive agent
+ * turns reuse the same connection instead of paying a TCP and TLS
+ * handshake each time. HTTP/2 is negotiated where the endpoint offers it.
+ *
+ * Without CURL every request fails with an explanatory error.
+ */
+
+#ifndef CYXMAKE_HTTP_POOL_H
+#define CYXMAKE_HTTP_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct HttpPool HttpPool;
+
+/**
+ * Prebuilt request header list, reused across requests
+ */
+typedef struct HttpHeaders HttpHeaders;
+
+/**
+ * HTTP response
+ */
+typedef struct {
+    long status;                  /* HTTP status (0 if no response) */
+    char* body;                   /* Response body (never NULL on success) */
+    size_t body_size;
+    char* error;                  /* Transport error, NULL on success */
+    double total_ms;              /* Request time */
+    bool new_connection;          /* A connection had to be opened */
+} HttpResponse;
+
+/**
+ * Pool statistics
+ */
+typedef struct {
+    int requests;                 /* Requests performed */
+    int handles_created;          /* Easy handles ever created */
+    int connections_opened;       /* Requests that opened a connection */
+    int idle_handles;             /* Handles waiting for reuse */
+} HttpPoolStats;
+
+/**
+ * Create a pool
+ * @param max_idle Handles kept for reuse (0 = default)
+ */
+HttpPool* http_pool_create(int max_idle);
+
+/**
+ * Free a pool, closing its connections
+ */
+void http_pool_free(HttpPool* pool);
+
+/**
+ * Get the process-wide pool shared by all providers, creating it on first
+ * use. Each call takes a reference; pair it with http_pool_release_shared.
+ * Providers are created and freed from one thread.
+ */
+HttpPool* http_pool_acquire_shared(void);
+
+/**
+ * Drop a reference to the shared pool (freed with the last one)
+ */
+void http_pool_release_shared(void);
+
+/**
+ * POST a body and collect the response
+ * Safe to call from several threads at once.
+ * @return Response (caller frees with http_response_free), NULL if out of memory
+ */
+HttpResponse* http_pool_post(HttpPool* pool, const char* url,
+                             const HttpHeaders* headers,
+                             const char* body, int timeout_sec);
+
+/**
+ * Receives a streamed response body chunk by chunk
+ * @return false to abort the transfer
+ */
+typedef bool (*HttpChunkCallback)(const char* data, size_t len, void* user_data);
+
+/**
+ * POST a body and hand the response to on_chunk as it arrives
+ * The returned response carries status and timing; body stays NULL. An
+ * abort from on_chunk is reported as a transport error.
+ * @return Response (caller frees with http_response_free), NULL if out of memory
+ */
+HttpResponse* http_pool_post_stream(HttpPool* pool, const char* url,
+                                    const HttpHeaders* headers,
+                                    const char* body, int timeout_sec,
+                                    HttpChunkCallback on_chunk, void* user_data);
+
+/**
+ * One request of a concurrent batch
+ */
+typedef struct {
+    const char* url;
+    const HttpHeaders* headers;
+    const char* body;
+    int timeout_sec;
+    int start_delay_ms;           /* Launch this long after the batch starts */
+} HttpBatchRequest;
+
+/**
+ * POST several bodies concurrently on one event loop
+ * A delayed request is launched when its delay expires, or earlier once
+ * every request launched before it has failed. With first_success the
+ * batch ends at the first 2xx response: requests still in flight are
+ * cancelled and report the error "Cancelled".
+ * @param responses Receives a response per request, NULL for requests never
+ *                  launched (caller frees each with http_response_free)
+ * @return Index of the first 2xx response, -1 if none
+ */
+int http_pool_post_batch(HttpPool* pool, const HttpBatchRequest* requests, int count,
+                         bool first_success, HttpResponse** responses);
+
+/**
+ * Get statistics
+ */
+HttpPoolStats http_pool_get_stats(HttpPool* pool);
+
+/**
+ * Free a response
+ */
+void http_response_free(HttpResponse* response);
+
+/**
+ * Create an empty header list
+ */
+HttpHeaders* http_headers_create(void);
+
+/**
+ * Append a "Name: value" header
+ * @return false if out of memory
+ */
+bool http_headers_add(HttpHeaders* headers, const char* name, const char* value);
+
+/**
+ * Free a header list
+ */
+void http_headers_free(HttpHeaders* headers);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CYXMAKE_HTTP_POOL_H */
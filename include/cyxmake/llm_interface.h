@@ -7,10 +7,15 @@
  * and project understanding.
  *
  * Architecture:
- * - Synchronous API (blocking calls)
+ * - Synchronous API (blocking calls), with futures for concurrent queries
  * - Single model instance per context
  * - Memory-mapped model loading for performance
- * - Thread-safe operations (future enhancement)
+ * - Optional deferred loading: on first use or on a background thread
+ * - KV cache kept between queries; only the part of a prompt that
+ *   differs from the previous one is processed
+ * - Thread-safe queries: serialized by default, or served concurrently
+ *   with n_parallel > 1 (one KV sequence and sampler per request, decode
+ *   steps of all active requests merged into one batch)
  *
  * Model Requirements:
  * - Format: GGUF (llama.cpp compatible)
@@ -31,6 +36,7 @@ extern "C" {
 
 /* Forward declarations */
 typedef struct LLMContext LLMContext;
+struct AIResponseCache;
 
 /**
  * GPU backend type
@@ -43,14 +49,28 @@ typedef enum {
     LLM_GPU_OPENCL       /**< OpenCL */
 } LLMGpuBackend;
 
+/**
+ * Model loading state
+ */
+typedef enum {
+    LLM_LOAD_PENDING = 0,  /**< Deferred, not started yet */
+    LLM_LOAD_LOADING,      /**< Load in progress */
+    LLM_LOAD_READY,        /**< Loaded and ready */
+    LLM_LOAD_FAILED        /**< Load failed (see llm_get_last_error) */
+} LLMLoadState;
+
 /**
  * LLM configuration options
  */
 typedef struct {
     const char* model_path;          /**< Path to GGUF model file */
     int n_ctx;                       /**< Context size (default: 8192) */
-    int n_threads;                   /**< Number of threads (0 = auto-detect) */
+    int n_threads;                   /**< Threads for generation (0 = physical cores) */
+    int n_threads_batch;             /**< Threads for prompt processing (0 = physical cores) */
+    int n_batch;                     /**< Prompt tokens per decode call (default: 512) */
+    int n_ubatch;                    /**< Physical batch size, <= n_batch (default: 512) */
     int n_gpu_layers;                /**< Number of layers to offload to GPU (-1 = auto, 0 = CPU only) */
+    int n_parallel;                  /**< Concurrent query sequences (default: 1, see llm_query_async) */
     bool use_mmap;                   /**< Use memory-mapped file (default: true) */
     bool use_mlock;                  /**< Lock model in RAM (default: false) */
     bool verbose;                    /**< Enable verbose logging (default: false) */
@@ -69,6 +89,8 @@ typedef struct {
     float top_p;                     /**< Top-P (nucleus) sampling (default: 0.9) */
     float repeat_penalty;            /**< Repetition penalty (default: 1.1) */
     const char* stop_sequence;       /**< Stop generation at this sequence (optional) */
+    const char* grammar;             /**< GBNF grammar the output must match, root rule
+                                          "root" (optional, see ai_schema_to_gbnf) */
 } LLMRequest;
 
 /**
@@ -78,11 +100,20 @@ typedef struct {
     char* text;                      /**< Generated text (caller must free) */
     int tokens_generated;            /**< Number of tokens generated */
     int tokens_prompt;               /**< Number of tokens in prompt */
+    int tokens_reused;               /**< Prompt tokens served from the KV cache */
     double duration_sec;             /**< Inference duration in seconds */
+    double prompt_sec;               /**< Time spent processing the prompt */
+    double generation_sec;           /**< Time spent generating tokens */
     bool success;                    /**< True if generation succeeded */
     char* error_message;             /**< Error message if success=false (caller must free) */
+    bool cached;                     /**< True if served from the response cache */
 } LLMResponse;
 
+/**
+ * Pending result of an asynchronous query (see llm_query_async)
+ */
+typedef struct LLMFuture LLMFuture;
+
 /**
  * LLM model information
  */
@@ -135,10 +166,42 @@ void llm_config_free(LLMConfig* config);
  */
 LLMContext* llm_init(const LLMConfig* config);
 
+/**
+ * Create an LLM context without loading the model yet
+ *
+ * The model is loaded by whichever comes first: the background prefetch
+ * (if requested) or the first call that needs it (llm_is_ready(),
+ * llm_query(), ...). Later callers wait for that load to finish. Runs that
+ * never need the model never pay for loading it.
+ *
+ * @param config Configuration (copied)
+ * @param prefetch Start loading on a background thread right away
+ * @return Context (NULL only if config is invalid)
+ */
+LLMContext* llm_init_deferred(const LLMConfig* config, bool prefetch);
+
+/**
+ * Load the model if that has not happened yet, or wait for the load in
+ * progress
+ *
+ * @param ctx LLM context
+ * @return True if the model is loaded
+ */
+bool llm_wait_ready(LLMContext* ctx);
+
+/**
+ * Get the loading state without waiting or starting a load
+ *
+ * @param ctx LLM context
+ * @return Current state (LLM_LOAD_FAILED for NULL)
+ */
+LLMLoadState llm_load_state(const LLMContext* ctx);
+
 /**
  * Shutdown LLM context and unload model
  *
- * Frees all resources associated with the context.
+ * Frees all resources associated with the context. Waits for a
+ * background load to finish first.
  *
  * @param ctx Context to shutdown (NULL-safe)
  */
@@ -147,6 +210,9 @@ void llm_shutdown(LLMContext* ctx);
 /**
  * Check if LLM is ready for inference
  *
+ * For a deferred context this loads the model first, or waits for the
+ * background load; use llm_load_state() to check without blocking.
+ *
  * @param ctx LLM context
  * @return True if model is loaded and ready
  */
@@ -161,6 +227,19 @@ bool llm_is_ready(const LLMContext* ctx);
  */
 LLMModelInfo* llm_get_model_info(const LLMContext* ctx);
 
+/**
+ * Read model information from a GGUF file without loading the weights
+ *
+ * No inference context is created, so this is cheap enough for status
+ * output. n_gpu_layers and gpu_backend are not meaningful here and
+ * is_loaded is false.
+ *
+ * @param model_path Path to the GGUF model file
+ * @return Model info, or NULL if the file cannot be read
+ *         Caller must free with llm_model_info_free()
+ */
+LLMModelInfo* llm_read_model_info(const char* model_path);
+
 /**
  * Free model information
  *
@@ -251,6 +330,59 @@ void llm_request_free(LLMRequest* request);
  */
 LLMResponse* llm_query(LLMContext* ctx, const LLMRequest* request);
 
+/**
+ * Start a query without waiting for it
+ *
+ * With n_parallel > 1 the request gets its own KV sequence and sampler,
+ * and is decoded together with the other active requests in one batch
+ * per step. Each sequence gets n_ctx tokens of context. Otherwise the
+ * query runs before this returns and the future is already complete.
+ *
+ * The request is copied, so it can be freed right away.
+ *
+ * @param ctx LLM context
+ * @param request Query parameters
+ * @return Future (free with llm_future_free), or NULL on error
+ */
+LLMFuture* llm_query_async(LLMContext* ctx, const LLMRequest* request);
+
+/**
+ * Check whether a query has finished, without blocking
+ *
+ * @param future Future from llm_query_async
+ * @return True if llm_future_wait() would return immediately
+ */
+bool llm_future_ready(LLMFuture* future);
+
+/**
+ * Wait for a query to finish and take its response
+ *
+ * @param future Future from llm_query_async
+ * @return Response (caller must free with llm_response_free), or NULL on
+ *         error or if the response was already taken
+ */
+LLMResponse* llm_future_wait(LLMFuture* future);
+
+/**
+ * Free a future
+ *
+ * A query still running is not cancelled; its response is discarded.
+ *
+ * @param future Future to free (NULL-safe)
+ */
+void llm_future_free(LLMFuture* future);
+
+/**
+ * Serve repeated queries from a response cache (see ai_cache.h)
+ *
+ * Queries are keyed by model path, prompt and sampling parameters.
+ * Successful responses are stored; a hit skips inference entirely.
+ *
+ * @param ctx LLM context
+ * @param cache Cache to use (not owned), NULL to stop caching
+ */
+void llm_set_response_cache(LLMContext* ctx, struct AIResponseCache* cache);
+
 /**
  * Free LLM response
  *
@@ -258,6 +390,70 @@ LLMResponse* llm_query(LLMContext* ctx, const LLMRequest* request);
  */
 void llm_response_free(LLMResponse* response);
 
+/* ========================================================================
+ * Session State
+ * ======================================================================== */
+
+/*
+ * The context keeps the tokens of the last query (prompt and reply) in its
+ * KV cache. The next llm_query() reuses the longest common token prefix and
+ * decodes only the rest, so prompts sharing a long system prompt pay for
+ * it once.
+ *
+ * With n_parallel > 1 queries are served on per-request sequences and no
+ * session context is created: there is no prefix reuse, and the functions
+ * below fail (llm_session_reset does nothing).
+ */
+
+/**
+ * Process a fixed prompt prefix ahead of time
+ *
+ * With state_path, a state saved by an earlier run is loaded first and
+ * whatever part of it matches is reused; if anything had to be decoded the
+ * new state is written back, so the next run starts warm.
+ *
+ * @param ctx LLM context
+ * @param prefix Prompt prefix (e.g. a system prompt)
+ * @param state_path State file (optional, ~ is expanded)
+ * @return True if the prefix is cached
+ */
+bool llm_session_prime(LLMContext* ctx, const char* prefix, const char* state_path);
+
+/**
+ * Save the cached session to a file
+ *
+ * The file is tied to the model and context settings it was saved with.
+ *
+ * @param ctx LLM context
+ * @param path State file (~ is expanded)
+ * @return True on success
+ */
+bool llm_session_save(LLMContext* ctx, const char* path);
+
+/**
+ * Replace the cached session with one saved by llm_session_save()
+ *
+ * @param ctx LLM context
+ * @param path State file (~ is expanded)
+ * @return True on success (on failure the session is empty)
+ */
+bool llm_session_load(LLMContext* ctx, const char* path);
+
+/**
+ * Drop the cached session
+ *
+ * @param ctx LLM context
+ */
+void llm_session_reset(LLMContext* ctx);
+
+/**
+ * Get the number of tokens in the cached session
+ *
+ * @param ctx LLM context
+ * @return Token count (0 if not ready)
+ */
+int llm_session_tokens(const LLMContext* ctx);
+
 /* ========================================================================
  * Convenience Functions
  * ======================================================================== */
@@ -307,6 +503,18 @@ char* llm_get_default_model_path(void);
  */
 int llm_estimate_tokens(const char* text);
 
+/**
+ * Count tokens in text with the model's tokenizer
+ *
+ * Falls back to llm_estimate_tokens while the model is not loaded; never
+ * triggers a deferred load.
+ *
+ * @param ctx LLM context
+ * @param text Input text
+ * @return Token count
+ */
+int llm_count_tokens(LLMContext* ctx, const char* text);
+
 /* ========================================================================
  * Error Handling
  * ======================================================================== */
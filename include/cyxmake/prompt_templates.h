@@ -13,8 +13,9 @@
 extern "C" {
 #endif
 
-/* Forward declaration */
+/* Forward declarations */
 typedef struct LLMContext LLMContext;
+struct AISchema;
 
 /**
  * Generate prompt for analyzing a build error
@@ -198,6 +199,16 @@ char* prompt_ai_agent(const char* user_request,
  */
 AIAgentResponse* parse_ai_agent_response(const char* response);
 
+/**
+ * Reply schema for prompt_ai_agent
+ *
+ * Pass it to ai_provider_query_structured, or its GBNF (ai_schema_to_gbnf)
+ * as LLMRequest.grammar, so the model can only produce replies that
+ * parse_ai_agent_response accepts.
+ * @return Static schema
+ */
+const struct AISchema* ai_agent_response_schema(void);
+
 /**
  * Free AI action chain
  * @param action Action to free (frees entire chain)
@@ -99,6 +99,7 @@ typedef struct ReplSession {
     /* Session state */
     bool running;
     int command_count;
+    bool reply_streamed;                 /* Agent reply already printed as it arrived */
 
     /* History (deprecated - use input->history instead) */
     char** history;
@@ -576,7 +576,7 @@ SandboxConfig sandbox_config_default(SandboxLevel level);
 /**
  * Execute a command in a sandbox
  * @param command Command to execute
- * @param args Command arguments (NULL-terminated array)
+ * @param args Command arguments (NULL-terminated array, args[0] = program name)
  * @param working_dir Working directory
  * @param config Sandbox configuration
  * @return Sandbox result (caller must free with sandbox_result_free)
@@ -274,6 +274,13 @@ int thread_pool_thread_count(ThreadPool* pool);
  */
 int thread_get_cpu_count(void);
 
+/**
+ * Get number of physical CPU cores (SMT siblings counted once)
+ *
+ * @return Number of physical cores, or the logical count if unknown
+ */
+int thread_get_physical_core_count(void);
+
 /* ============================================================================
  * Atomic Operations (for lock-free counters)
  * ============================================================================ */
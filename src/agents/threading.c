@@ -17,6 +17,10 @@
     #include <unistd.h>
     #include <sys/time.h>
     #include <errno.h>
+    #include <stdio.h>
+    #ifdef __APPLE__
+        #include <sys/sysctl.h>
+    #endif
 #endif
 
 /* ============================================================================
@@ -324,6 +328,59 @@ int thread_get_cpu_count(void) {
 #endif
 }
 
+int thread_get_physical_core_count(void) {
+    int logical = thread_get_cpu_count();
+
+#ifdef CYXMAKE_WINDOWS
+    DWORD len = 0;
+    GetLogicalProcessorInformation(NULL, &len);
+    SYSTEM_LOGICAL_PROCESSOR_INFORMATION* info = malloc(len);
+    if (!info) return logical;
+
+    int cores = 0;
+    if (GetLogicalProcessorInformation(info, &len)) {
+        for (DWORD i = 0; i < len / sizeof(*info); i++) {
+            if (info[i].Relationship == RelationProcessorCore) cores++;
+        }
+    }
+    free(info);
+    return cores > 0 ? cores : logical;
+#elif defined(__APPLE__)
+    int cores = 0;
+    size_t size = sizeof(cores);
+    if (sysctlbyname("hw.physicalcpu", &cores, &size, NULL, 0) != 0 || cores <= 0) {
+        return logical;
+    }
+    return cores;
+#else
+    /* Count distinct SMT sibling sets; each is one core */
+    char (*siblings)[64] = calloc((size_t)logical, sizeof(*siblings));
+    if (!siblings) return logical;
+
+    int cores = 0;
+    for (int cpu = 0; cpu < logical; cpu++) {
+        char path[128], line[64];
+        snprintf(path, sizeof(path),
+                 "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list", cpu);
+        FILE* fp = fopen(path, "r");
+        if (!fp) continue;
+        bool ok = fgets(line, sizeof(line), fp) != NULL;
+        fclose(fp);
+        if (!ok) continue;
+
+        bool seen = false;
+        for (int i = 0; i < cores && !seen; i++) {
+            seen = strcmp(siblings[i], line) == 0;
+        }
+        if (!seen) {
+            strcpy(siblings[cores++], line);
+        }
+    }
+    free(siblings);
+    return cores > 0 ? cores : logical;
+#endif
+}
+
 /* ============================================================================
  * Thread Pool Implementation
  * ============================================================================ */
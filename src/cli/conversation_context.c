@@ -11,6 +11,8 @@
 #define DEFAULT_CAPACITY 64
 #define DEFAULT_CONTEXT_WINDOW 10
 #define FILE_PREVIEW_LINES 20
+#define MAX_RECENT_FILES 5
+#define DEFAULT_CONTEXT_TOKENS 1024
 
 /* Helper to duplicate strings safely */
 static char* safe_strdup(const char* s) {
@@ -77,6 +79,7 @@ ConversationContext* conversation_context_create(int max_messages) {
     ctx->context_window_size = DEFAULT_CONTEXT_WINDOW;
     ctx->include_file_content = true;
     ctx->include_tool_output = true;
+    ctx->context_token_budget = DEFAULT_CONTEXT_TOKENS;
 
     ctx->messages = calloc(ctx->message_capacity, sizeof(ConversationMessage));
     if (!ctx->messages) {
@@ -147,6 +150,93 @@ void conversation_add_message(ConversationContext* ctx,
     ctx->message_count++;
 }
 
+/* Read the first FILE_PREVIEW_LINES lines of a file, counting all of them
+ * when line_count is 0 */
+static char* read_file_preview(const char* path, int* line_count) {
+    FILE* file = fopen(path, "r");
+    if (!file) return NULL;
+
+    size_t capacity = 1024;
+    size_t length = 0;
+    char* preview = malloc(capacity);
+    if (!preview) {
+        fclose(file);
+        return NULL;
+    }
+
+    int lines = 0;
+    bool at_line_start = true;
+    int c;
+    while ((c = fgetc(file)) != EOF) {
+        if (at_line_start) lines++;
+        at_line_start = (c == '\n');
+
+        if (lines > FILE_PREVIEW_LINES) {
+            if (*line_count > 0) break;
+            continue;
+        }
+        if (length + 1 >= capacity) {
+            char* grown = realloc(preview, capacity * 2);
+            if (!grown) break;
+            preview = grown;
+            capacity *= 2;
+        }
+        preview[length++] = (char)c;
+    }
+    fclose(file);
+    while (length > 0 && preview[length - 1] == '\n') length--;
+    preview[length] = '\0';
+
+    if (*line_count <= 0) *line_count = lines;
+    if (length == 0) {
+        free(preview);
+        return NULL;
+    }
+    return preview;
+}
+
+/* Get the project snapshot, creating it on first use */
+static ProjectSnapshot* get_project_snapshot(ConversationContext* ctx) {
+    if (!ctx->project) {
+        ctx->project = calloc(1, sizeof(ProjectSnapshot));
+    }
+    return ctx->project;
+}
+
+/* Move a path to the front of the recent files, keeping MAX_RECENT_FILES */
+static void add_recent_file(ConversationContext* ctx, const char* path) {
+    ProjectSnapshot* ps = get_project_snapshot(ctx);
+    if (!ps) return;
+
+    if (!ps->recent_files) {
+        ps->recent_files = calloc(MAX_RECENT_FILES, sizeof(char*));
+        if (!ps->recent_files) return;
+    }
+
+    int found = -1;
+    for (int i = 0; i < ps->recent_files_count; i++) {
+        if (strcmp(ps->recent_files[i], path) == 0) {
+            found = i;
+            break;
+        }
+    }
+
+    char* entry;
+    if (found >= 0) {
+        entry = ps->recent_files[found];
+    } else {
+        entry = strdup(path);
+        if (!entry) return;
+        if (ps->recent_files_count == MAX_RECENT_FILES) {
+            free(ps->recent_files[--ps->recent_files_count]);
+        }
+        found = ps->recent_files_count++;
+    }
+
+    memmove(&ps->recent_files[1], &ps->recent_files[0], found * sizeof(char*));
+    ps->recent_files[0] = entry;
+}
+
 /* Set current file context */
 void conversation_set_file(ConversationContext* ctx,
                             const char* path,
@@ -164,9 +254,31 @@ void conversation_set_file(ConversationContext* ctx,
     if (!ctx->current_file) return;
 
     ctx->current_file->path = safe_strdup(path);
-    ctx->current_file->content_preview = safe_strdup(preview);
-    ctx->current_file->line_count = line_count;
+    if (preview) {
+        ctx->current_file->content_preview = safe_strdup(preview);
+        ctx->current_file->line_count = line_count;
+    } else {
+        ctx->current_file->content_preview = read_file_preview(path, &line_count);
+        ctx->current_file->line_count = line_count;
+    }
     ctx->current_file->last_accessed = time(NULL);
+
+    add_recent_file(ctx, path);
+}
+
+/* Set project snapshot */
+void conversation_set_project(ConversationContext* ctx,
+                               const char* project_type,
+                               const char* working_dir) {
+    if (!ctx) return;
+
+    ProjectSnapshot* ps = get_project_snapshot(ctx);
+    if (!ps) return;
+
+    free(ps->project_type);
+    free(ps->working_dir);
+    ps->project_type = safe_strdup(project_type);
+    ps->working_dir = safe_strdup(working_dir);
 }
 
 /* Set last error context */
@@ -200,6 +312,17 @@ void conversation_clear_error(ConversationContext* ctx) {
     ctx->last_error = NULL;
 }
 
+/* Set token budget for the context string */
+void conversation_set_token_budget(ConversationContext* ctx,
+                                    int tokens,
+                                    ContextTokenCounter counter,
+                                    void* user_data) {
+    if (!ctx) return;
+    ctx->context_token_budget = tokens > 0 ? tokens : 0;
+    ctx->token_counter = counter;
+    ctx->token_counter_data = user_data;
+}
+
 /* Get context string for LLM */
 char* conversation_get_context_string(ConversationContext* ctx, int count) {
     if (!ctx) return NULL;
@@ -207,44 +330,128 @@ char* conversation_get_context_string(ConversationContext* ctx, int count) {
     int window = count > 0 ? count : ctx->context_window_size;
     int start = ctx->message_count > window ? ctx->message_count - window : 0;
 
-    /* Calculate buffer size */
-    size_t buffer_size = 4096;
-    char* buffer = malloc(buffer_size);
-    if (!buffer) return NULL;
-    buffer[0] = '\0';
-    size_t offset = 0;
+    ContextPacker* packer = context_packer_create(ctx->context_token_budget,
+                                                  ctx->token_counter,
+                                                  ctx->token_counter_data);
+    if (!packer) return NULL;
+    int item_count = 0;
+
+    /* Add the project snapshot; it is short and always kept */
+    if (ctx->project) {
+        char text[1024];
+        int written = snprintf(text, sizeof(text), "[Project: %s in %s",
+                               ctx->project->project_type ? ctx->project->project_type : "unknown",
+                               ctx->project->working_dir ? ctx->project->working_dir : ".");
+        for (int i = 0; i < ctx->project->recent_files_count &&
+                        written > 0 && (size_t)written < sizeof(text); i++) {
+            written += snprintf(text + written, sizeof(text) - written, "%s%s",
+                                i == 0 ? "; recent files: " : ", ",
+                                ctx->project->recent_files[i]);
+        }
+        if (written > 0 && (size_t)written < sizeof(text)) {
+            snprintf(text + written, sizeof(text) - written, "]");
+        }
+        ContextItem item = { .text = text, .priority = 3, .required = true };
+        if (context_packer_add(packer, &item) >= 0) item_count++;
+    }
 
     /* Add current file context if available */
     if (ctx->current_file && ctx->include_file_content) {
-        int written = snprintf(buffer + offset, buffer_size - offset,
-                                "[Current file: %s (%d lines)]\n",
-                                ctx->current_file->path,
-                                ctx->current_file->line_count);
-        if (written > 0) offset += written;
+        char text[1024];
+        snprintf(text, sizeof(text), "[Current file: %s (%d lines)]",
+                 ctx->current_file->path, ctx->current_file->line_count);
+        ContextItem item = { .text = text, .priority = 1 };
+        if (context_packer_add(packer, &item) >= 0) item_count++;
+
+        /* The preview ranks below the error but above every message */
+        if (ctx->current_file->content_preview) {
+            ContextItem preview = {
+                .text = ctx->current_file->content_preview,
+                .priority = 0,
+                .excerpt = true
+            };
+            if (context_packer_add(packer, &preview) >= 0) item_count++;
+        }
     }
 
     /* Add last error if available */
-    if (ctx->last_error) {
-        int written = snprintf(buffer + offset, buffer_size - offset,
-                                "[Last error: %s]\n",
-                                ctx->last_error->message);
-        if (written > 0) offset += written;
+    if (ctx->last_error && ctx->last_error->message) {
+        size_t size = strlen(ctx->last_error->message) + 16;
+        char* text = malloc(size);
+        if (text) {
+            snprintf(text, size, "[Last error: %s]", ctx->last_error->message);
+            ContextItem item = { .text = text, .priority = 2, .excerpt = true };
+            if (context_packer_add(packer, &item) >= 0) item_count++;
+            free(text);
+        }
     }
 
-    /* Add recent messages */
+    /* Add recent messages, ranked by age below the file and error */
+    int first_message = -1;
     for (int i = start; i < ctx->message_count; i++) {
         ConversationMessage* msg = &ctx->messages[i];
+        if (!msg->content) continue;
+
         const char* role = message_role_name(msg->role);
+        size_t size = strlen(role) + strlen(msg->content) + 8;
+        char* text = malloc(size);
+        char* summary = context_summarize_first_line(role, msg->content);
+        if (text) {
+            snprintf(text, size, "[%s]: %s", role, msg->content);
+            ContextItem item = {
+                .text = text,
+                .summary = summary,
+                .priority = i - ctx->message_count,
+                .excerpt = msg->role == MSG_ROLE_TOOL
+            };
+            if (context_packer_add(packer, &item) >= 0) {
+                if (first_message < 0) first_message = item_count;
+                item_count++;
+            }
+        }
+        free(text);
+        free(summary);
+    }
 
-        int written = snprintf(buffer + offset, buffer_size - offset,
-                                "[%s]: %s\n",
-                                role, msg->content);
-        if (written > 0) offset += written;
+    context_packer_pack(packer);
+
+    int dropped = 0;
+    for (int i = first_message; i >= 0 && i < item_count; i++) {
+        if (context_packer_form(packer, i) == CONTEXT_PACKED_DROPPED) dropped++;
+    }
+
+    /* Join what was kept, in the original order */
+    char note[64] = "";
+    if (dropped > 0) {
+        snprintf(note, sizeof(note), "[%d earlier message%s omitted]\n",
+                 dropped, dropped == 1 ? "" : "s");
+    }
+
+    size_t buffer_size = strlen(note) + 1;
+    for (int i = 0; i < item_count; i++) {
+        const char* text = context_packer_text(packer, i);
+        if (text) buffer_size += strlen(text) + 1;
+    }
 
-        /* Ensure we don't overflow */
-        if (offset >= buffer_size - 256) break;
+    char* buffer = malloc(buffer_size);
+    if (!buffer) {
+        context_packer_free(packer);
+        return NULL;
+    }
+    buffer[0] = '\0';
+    size_t offset = 0;
+
+    for (int i = 0; i < item_count; i++) {
+        if (i == first_message) {
+            offset += snprintf(buffer + offset, buffer_size - offset, "%s", note);
+        }
+        const char* text = context_packer_text(packer, i);
+        if (text) {
+            offset += snprintf(buffer + offset, buffer_size - offset, "%s\n", text);
+        }
     }
 
+    context_packer_free(packer);
     return buffer;
 }
 
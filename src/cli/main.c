@@ -5,6 +5,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <signal.h>
 #include "cyxmake/cyxmake.h"
 #include "cyxmake/logger.h"
 #include "cyxmake/llm_interface.h"
@@ -12,6 +13,7 @@
 #include "cyxmake/prompt_templates.h"
 #include "cyxmake/file_ops.h"
 #include "cyxmake/repl.h"
+#include "cyxmake/distributed/distributed.h"
 
 static void print_version(void) {
     log_plain("CyxMake version %s\n", cyxmake_version());
@@ -37,6 +39,7 @@ static void print_help(const char* program_name) {
     log_plain("  cache             Manage project cache\n");
     log_plain("  config            Manage configuration\n");
     log_plain("  test-llm          Test LLM integration (requires model)\n");
+    log_plain("  worker start      Run as a distributed build worker\n");
     log_plain("  help              Show this help message\n");
     log_plain("  version           Show version information\n");
     log_plain("\n");
@@ -64,6 +67,7 @@ static void print_help(const char* program_name) {
     log_plain("  %s build --no-ai           # Build without AI\n", program_name);
     log_plain("  %s build --auto-fix        # Build with auto-fix enabled\n", program_name);
     log_plain("  %s create \"C++ game engine\" my_game  # Create in my_game/\n", program_name);
+    log_plain("  %s worker start --coordinator host:9876 --token <token>\n", program_name);
     log_plain("\n");
     log_plain("Natural Language:\n");
     log_plain("  You can also use plain English commands:\n");
@@ -76,6 +80,114 @@ static void print_help(const char* program_name) {
     log_plain("Report issues: https://github.com/cyxmake/cyxmake/issues\n");
 }
 
+static WorkerClient* active_worker = NULL;
+
+static void on_worker_signal(int sig) {
+    (void)sig;
+    if (active_worker) {
+        worker_client_stop(active_worker);
+    }
+}
+
+static void print_worker_help(const char* program_name) {
+    log_plain("Usage: %s worker start --coordinator <host:port> [options]\n", program_name);
+    log_plain("\n");
+    log_plain("Options:\n");
+    log_plain("  --coordinator <url>  Coordinator address (ws://host:port or host:port)\n");
+    log_plain("  --token <token>      Worker authentication token\n");
+    log_plain("  --name <name>        Worker name shown by the coordinator\n");
+    log_plain("  --jobs <n>           Concurrent job slots (default: CPU count)\n");
+    log_plain("  --sandbox-dir <dir>  Root for per-job temp directories\n");
+    log_plain("  --cache-dir <dir>    Artifact cache for job outputs\n");
+    log_plain("  --limit-resources    Apply CPU/memory limits to job processes\n");
+    log_plain("  --json-frames        Send JSON text frames (debugging)\n");
+}
+
+/* cyxmake worker start ... */
+static int run_worker(int argc, char** argv) {
+    if (argc < 3 || strcmp(argv[2], "start") != 0) {
+        print_worker_help(argv[0]);
+        bool asked = argc >= 3 &&
+                     (strcmp(argv[2], "help") == 0 || strcmp(argv[2], "--help") == 0);
+        return asked ? 0 : CYXMAKE_ERROR_INVALID_ARG;
+    }
+
+    WorkerClientConfig config = worker_client_config_default();
+    config.max_jobs = 0;  /* CPU count */
+
+    for (int i = 3; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--limit-resources") == 0) {
+            config.enable_sandbox = true;
+            continue;
+        }
+        if (strcmp(arg, "--json-frames") == 0) {
+            config.json_frames = true;
+            continue;
+        }
+        if (!value) {
+            log_error("Missing value for %s", arg);
+            worker_client_config_free(&config);
+            return CYXMAKE_ERROR_INVALID_ARG;
+        }
+
+        if (strcmp(arg, "--coordinator") == 0) {
+            free(config.coordinator_url);
+            config.coordinator_url = strdup(value);
+        } else if (strcmp(arg, "--token") == 0) {
+            free(config.auth_token);
+            config.auth_token = strdup(value);
+        } else if (strcmp(arg, "--name") == 0) {
+            free(config.name);
+            config.name = strdup(value);
+        } else if (strcmp(arg, "--jobs") == 0) {
+            config.max_jobs = atoi(value);
+        } else if (strcmp(arg, "--sandbox-dir") == 0) {
+            free(config.sandbox_dir);
+            config.sandbox_dir = strdup(value);
+        } else if (strcmp(arg, "--cache-dir") == 0) {
+            free(config.cache_dir);
+            config.cache_dir = strdup(value);
+        } else {
+            log_error("Unknown worker option: %s", arg);
+            worker_client_config_free(&config);
+            return CYXMAKE_ERROR_INVALID_ARG;
+        }
+        i++;
+    }
+
+    if (!config.coordinator_url) {
+        log_error("No coordinator given (use --coordinator <host:port>)");
+        worker_client_config_free(&config);
+        return CYXMAKE_ERROR_INVALID_ARG;
+    }
+
+    WorkerClient* worker = worker_client_create(&config);
+    worker_client_config_free(&config);
+    if (!worker) {
+        return CYXMAKE_ERROR_INTERNAL;
+    }
+
+    if (!worker_client_connect(worker)) {
+        worker_client_free(worker);
+        return CYXMAKE_ERROR_INTERNAL;
+    }
+
+    active_worker = worker;
+    signal(SIGINT, on_worker_signal);
+    signal(SIGTERM, on_worker_signal);
+
+    log_info("Worker running (Ctrl+C to stop)");
+    worker_client_run(worker);
+
+    active_worker = NULL;
+    worker_client_free(worker);
+    log_info("Worker stopped");
+    return 0;
+}
+
 int main(int argc, char** argv) {
     // Initialize logger
     log_init(NULL);  /* Use default configuration */
@@ -121,6 +233,13 @@ int main(int argc, char** argv) {
         return 0;
     }
 
+    // Worker mode runs without the orchestrator
+    if (strcmp(argv[1], "worker") == 0) {
+        int result = run_worker(argc, argv);
+        log_shutdown();
+        return result;
+    }
+
     // Initialize CyxMake
     log_info("CyxMake v%s - AI-Powered Build Automation", cyxmake_version());
     log_info("Initializing...");
@@ -331,30 +450,23 @@ int main(int argc, char** argv) {
         if (model_path && llm_validate_model_file(model_path)) {
             log_success("  Model status: Available");
 
-            /* Quick model info */
-            LLMConfig* config = llm_config_default();
-            config->model_path = model_path;
-            LLMContext* llm = llm_init(config);
-            if (llm) {
-                LLMModelInfo* info = llm_get_model_info(llm);
-                if (info) {
-                    log_info("  Model name: %s", info->model_name);
-                    log_info("  Model type: %s", info->model_type);
-                    log_info("  Context: %d tokens", info->context_length);
-
-                    /* Check GPU */
-                    LLMGpuBackend gpu = llm_detect_gpu();
-                    if (gpu != LLM_GPU_NONE) {
-                        log_info("  GPU: %s", llm_gpu_backend_name(gpu));
-                    } else {
-                        log_info("  GPU: None (CPU mode)");
-                    }
-
-                    llm_model_info_free(info);
+            /* Quick model info (GGUF metadata only, weights stay on disk) */
+            LLMModelInfo* info = llm_read_model_info(model_path);
+            if (info) {
+                log_info("  Model name: %s", info->model_name);
+                log_info("  Model type: %s", info->model_type);
+                log_info("  Context: %d tokens", info->context_length);
+
+                /* Check GPU */
+                LLMGpuBackend gpu = llm_detect_gpu();
+                if (gpu != LLM_GPU_NONE) {
+                    log_info("  GPU: %s", llm_gpu_backend_name(gpu));
+                } else {
+                    log_info("  GPU: None (CPU mode)");
                 }
-                llm_shutdown(llm);
+
+                llm_model_info_free(info);
             }
-            llm_config_free(config);
         } else {
             log_warning("  Model status: Not found");
             log_info("  To enable AI, download a GGUF model to:");
@@ -108,6 +108,37 @@ static void strip_non_ascii(char* str) {
     *dst = '\0';
 }
 
+/**
+ * Print agent reply text as it streams in
+ * Same filtering as strip_non_ascii: bytes outside ASCII are dropped.
+ */
+static void repl_stream_token(const char* text, size_t len, void* user_data) {
+    ReplSession* session = (ReplSession*)user_data;
+
+    if (!session->reply_streamed) {
+        session->reply_streamed = true;
+        printf("\n%s", session->config.colors_enabled ? COLOR_GREEN : "");
+    }
+    for (size_t i = 0; i < len; i++) {
+        if ((unsigned char)text[i] < 0x80) putchar(text[i]);
+    }
+    fflush(stdout);
+}
+
+/* End the line of a streamed reply; false if nothing was streamed */
+static bool repl_end_agent_stream(ReplSession* session) {
+    if (!session->reply_streamed) return false;
+    printf("%s\n", session->config.colors_enabled ? COLOR_RESET : "");
+    return true;
+}
+
+/* Print an agent reply unless it was already streamed */
+static void repl_print_agent_reply(ReplSession* session, char* result) {
+    if (repl_end_agent_stream(session)) return;
+    strip_non_ascii(result);
+    printf("\n%s%s%s\n", COLOR_GREEN, result, COLOR_RESET);
+}
+
 /* Default configuration */
 ReplConfig repl_config_default(void) {
     return (ReplConfig){
@@ -161,6 +192,11 @@ ReplSession* repl_session_create(const ReplConfig* config, Orchestrator* orch) {
 
     /* Initialize conversation context */
     session->conversation = conversation_context_create(session->config.history_size);
+    if (session->conversation && session->working_dir) {
+        conversation_set_project(session->conversation,
+                                 build_system_to_string(detect_build_system(session->working_dir)),
+                                 session->working_dir);
+    }
 
     /* Initialize AI provider registry and load from config */
     session->ai_registry = ai_registry_create();
@@ -234,6 +270,8 @@ ReplSession* repl_session_create(const ReplConfig* config, Orchestrator* orch) {
         agent_cfg.working_dir = session->working_dir;
         agent_cfg.max_iterations = 20;  /* Allow more steps for complex tasks */
         agent_cfg.require_approval = false;  /* Auto-approve for now */
+        agent_cfg.on_token = repl_stream_token;
+        agent_cfg.stream_user_data = session;
 
         session->autonomous_agent = agent_create(session->current_provider, &agent_cfg);
         if (session->autonomous_agent) {
@@ -851,11 +889,11 @@ static bool execute_natural_language(ReplSession* session, const char* input) {
         }
 
         agent_set_working_dir(session->autonomous_agent, session->working_dir);
+        session->reply_streamed = false;
         char* result = agent_run(session->autonomous_agent, input);
 
         if (result) {
-            strip_non_ascii(result);
-            printf("\n%s%s%s\n", COLOR_GREEN, result, COLOR_RESET);
+            repl_print_agent_reply(session, result);
 
             if (session->conversation) {
                 conversation_add_message(session->conversation, MSG_ROLE_ASSISTANT,
@@ -863,6 +901,7 @@ static bool execute_natural_language(ReplSession* session, const char* input) {
             }
             free(result);
         } else {
+            repl_end_agent_stream(session);
             const char* error = autonomous_agent_get_error(session->autonomous_agent);
             if (error) {
                 printf("%sAgent error: %s%s\n", COLOR_RED, error, COLOR_RESET);
@@ -991,9 +1030,10 @@ static bool execute_natural_language(ReplSession* session, const char* input) {
     /* Define confidence threshold - below this, route to AI if available */
     const float AI_ROUTING_THRESHOLD = 0.6f;
 
-    /* Check if we should route to AI instead of local execution */
+    /* Check if we should route to AI instead of local execution (without
+     * loading a deferred model just to decide) */
     bool has_ai = (session->current_provider && ai_provider_is_ready(session->current_provider)) ||
-                  (session->llm && llm_is_ready(session->llm));
+                  (session->llm && llm_load_state(session->llm) != LLM_LOAD_FAILED);
     bool low_confidence = cmd->confidence < AI_ROUTING_THRESHOLD && cmd->confidence > 0;
 
     if (has_ai && low_confidence && cmd->intent != INTENT_UNKNOWN) {
@@ -1348,12 +1388,12 @@ static bool execute_natural_language(ReplSession* session, const char* input) {
                     agent_set_working_dir(session->autonomous_agent, session->working_dir);
 
                     /* Run the autonomous agent on the task */
+                    session->reply_streamed = false;
                     char* result = agent_run(session->autonomous_agent, input);
 
                     if (result) {
-                        /* Display the result */
-                        strip_non_ascii(result);
-                        printf("\n%s%s%s\n", COLOR_GREEN, result, COLOR_RESET);
+                        /* Display the result (streamed replies are already on screen) */
+                        repl_print_agent_reply(session, result);
 
                         /* Add to conversation */
                         if (session->conversation) {
@@ -1362,6 +1402,7 @@ static bool execute_natural_language(ReplSession* session, const char* input) {
                         }
                         free(result);
                     } else {
+                        repl_end_agent_stream(session);
                         const char* error = autonomous_agent_get_error(session->autonomous_agent);
                         if (error) {
                             printf("%sAgent error: %s%s\n", COLOR_RED, error, COLOR_RESET);
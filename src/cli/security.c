@@ -1091,8 +1091,9 @@ SandboxResult* sandbox_execute(const char* command,
     char cmdline[4096] = "";
     strncpy(cmdline, command, sizeof(cmdline) - 1);
 
-    if (args) {
-        for (int i = 0; args[i]; i++) {
+    if (args && args[0]) {
+        /* args[0] is the program name, as with execvp */
+        for (int i = 1; args[i]; i++) {
             strncat(cmdline, " ", sizeof(cmdline) - strlen(cmdline) - 1);
             strncat(cmdline, args[i], sizeof(cmdline) - strlen(cmdline) - 1);
         }
@@ -1229,6 +1230,7 @@ SandboxResult* sandbox_execute(const char* command,
 #include <sys/resource.h>
 #include <signal.h>
 #include <errno.h>
+#include <poll.h>
 
 bool sandbox_is_available(void) {
     return true;  /* Resource limits available on all Unix systems */
@@ -1333,18 +1335,42 @@ SandboxResult* sandbox_execute(const char* command,
     result->stdout_output[0] = '\0';
     result->stderr_output[0] = '\0';
 
-    while ((bytesRead = read(stdout_pipe[0], buffer, sizeof(buffer) - 1)) > 0) {
-        buffer[bytesRead] = '\0';
-        result->stdout_output = realloc(result->stdout_output, stdoutSize + bytesRead + 1);
-        memcpy(result->stdout_output + stdoutSize, buffer, bytesRead + 1);
-        stdoutSize += bytesRead;
-    }
+    /* Drain both pipes together so a chatty stderr can't block the child */
+    struct pollfd fds[2] = {
+        { stdout_pipe[0], POLLIN, 0 },
+        { stderr_pipe[0], POLLIN, 0 }
+    };
+    int open_fds = 2;
 
-    while ((bytesRead = read(stderr_pipe[0], buffer, sizeof(buffer) - 1)) > 0) {
-        buffer[bytesRead] = '\0';
-        result->stderr_output = realloc(result->stderr_output, stderrSize + bytesRead + 1);
-        memcpy(result->stderr_output + stderrSize, buffer, bytesRead + 1);
-        stderrSize += bytesRead;
+    while (open_fds > 0) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (int i = 0; i < 2; i++) {
+            if (fds[i].fd < 0 || !(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                continue;
+            }
+
+            bytesRead = read(fds[i].fd, buffer, sizeof(buffer) - 1);
+            if (bytesRead <= 0) {
+                fds[i].fd = -1;
+                open_fds--;
+                continue;
+            }
+
+            buffer[bytesRead] = '\0';
+            if (i == 0) {
+                result->stdout_output = realloc(result->stdout_output, stdoutSize + bytesRead + 1);
+                memcpy(result->stdout_output + stdoutSize, buffer, bytesRead + 1);
+                stdoutSize += bytesRead;
+            } else {
+                result->stderr_output = realloc(result->stderr_output, stderrSize + bytesRead + 1);
+                memcpy(result->stderr_output + stderrSize, buffer, bytesRead + 1);
+                stderrSize += bytesRead;
+            }
+        }
     }
 
     close(stdout_pipe[0]);
@@ -11,6 +11,7 @@
 #include "cyxmake/conversation_context.h"
 #include "cyxmake/llm_interface.h"
 #include "cyxmake/ai_provider.h"
+#include "cyxmake/ai_cache.h"
 #include "cyxmake/project_graph.h"
 #include "cyxmake/project_context.h"
 #include "cyxmake/smart_agent.h"
@@ -57,6 +58,11 @@
 #define SYM_WARN    "[!]"
 #define SYM_ARROW   "->"
 
+/* Token counter for conversation context, backed by the local model */
+static int count_local_tokens(const char* text, void* user_data) {
+    return llm_count_tokens((LLMContext*)user_data, text);
+}
+
 /* Helper to convert ErrorPatternType to string */
 static const char* error_pattern_type_name(ErrorPatternType type) {
     switch (type) {
@@ -604,8 +610,9 @@ bool cmd_build(ReplSession* session, const char* args) {
                                    session->last_error, "build", NULL, 0);
         }
 
-        /* Offer automatic recovery if AI/tools available */
-        bool has_recovery = (session->llm && llm_is_ready(session->llm)) ||
+        /* Offer automatic recovery if AI/tools available; a deferred model
+         * only loads if recovery actually runs */
+        bool has_recovery = (session->llm && llm_load_state(session->llm) != LLM_LOAD_FAILED) ||
                             (session->current_provider && ai_provider_is_ready(session->current_provider)) ||
                             (session->orchestrator && cyxmake_get_tools(session->orchestrator));
 
@@ -1142,6 +1149,11 @@ bool cmd_ai(ReplSession* session, const char* args) {
             }
 
             if (session->llm) {
+                if (session->conversation) {
+                    conversation_set_token_budget(session->conversation,
+                                                  session->conversation->context_token_budget,
+                                                  NULL, NULL);
+                }
                 llm_shutdown(session->llm);
                 session->llm = NULL;
             }
@@ -1157,6 +1169,17 @@ bool cmd_ai(ReplSession* session, const char* args) {
                 /* Clear cloud provider when using local */
                 session->current_provider = NULL;
 
+                /* Local queries share the providers' response cache */
+                llm_set_response_cache(session->llm,
+                                       ai_registry_get_response_cache(session->ai_registry));
+
+                /* Budget conversation context with the model's own tokenizer */
+                if (session->conversation) {
+                    conversation_set_token_budget(session->conversation,
+                                                  session->conversation->context_token_budget,
+                                                  count_local_tokens, session->llm);
+                }
+
                 if (session->config.colors_enabled) {
                     printf("%s%s Local AI model loaded!%s\n", COLOR_GREEN, SYM_CHECK, COLOR_RESET);
                 } else {
@@ -1186,9 +1209,44 @@ bool cmd_ai(ReplSession* session, const char* args) {
             free(model_path);
             return true;
         }
+        else if (strncmp(args, "cache", 5) == 0) {
+            /* /ai cache [clear] - show or clear the response cache */
+            const char* action = args + 5;
+            while (*action == ' ' || *action == '\t') action++;
+
+            AIResponseCache* cache = ai_registry_get_response_cache(session->ai_registry);
+            if (!cache) {
+                printf("Response cache is off. Enable it with 'response_cache = true' "
+                       "under [ai] in cyxmake.toml.\n");
+                return true;
+            }
+
+            if (strcmp(action, "clear") == 0) {
+                int removed = ai_response_cache_clear(cache);
+                printf("Removed %d cached response%s.\n", removed, removed == 1 ? "" : "s");
+                return true;
+            }
+
+            AIResponseCacheStats stats = ai_response_cache_get_stats(cache);
+            if (session->config.colors_enabled) {
+                printf("\n%s%sAI Response Cache%s\n\n", COLOR_BOLD, COLOR_CYAN, COLOR_RESET);
+            } else {
+                printf("\nAI Response Cache\n\n");
+            }
+            printf("  Entries: %d (%.1f KB)\n", stats.entries, stats.total_bytes / 1024.0);
+            printf("  Lookups: %d (%d hits, %d misses, %d expired)\n",
+                   stats.lookups, stats.hits, stats.misses, stats.expired);
+            printf("  Stored: %d, evicted: %d\n\n", stats.stores, stats.evictions);
+            return true;
+        }
         else if (strncmp(args, "unload", 6) == 0) {
             /* /ai unload - unload all AI */
             if (session->llm) {
+                if (session->conversation) {
+                    conversation_set_token_budget(session->conversation,
+                                                  session->conversation->context_token_budget,
+                                                  NULL, NULL);
+                }
                 llm_shutdown(session->llm);
                 session->llm = NULL;
             }
@@ -1251,6 +1309,7 @@ bool cmd_ai(ReplSession* session, const char* args) {
         printf("  %s/ai test%s          - Test current AI\n", COLOR_CYAN, COLOR_RESET);
         printf("  %s/ai load [path]%s   - Load local GGUF model\n", COLOR_CYAN, COLOR_RESET);
         printf("  %s/ai unload%s        - Unload AI\n", COLOR_CYAN, COLOR_RESET);
+        printf("  %s/ai cache [clear]%s - Show or clear cached responses\n", COLOR_CYAN, COLOR_RESET);
         printf("\n%sConfiguration:%s cyxmake.toml\n", COLOR_YELLOW, COLOR_RESET);
         printf("\n");
     } else {
@@ -1288,6 +1347,7 @@ bool cmd_ai(ReplSession* session, const char* args) {
         printf("  /ai test          - Test current AI\n");
         printf("  /ai load [path]   - Load local GGUF model\n");
         printf("  /ai unload        - Unload AI\n");
+        printf("  /ai cache [clear] - Show or clear cached responses\n");
         printf("\nConfiguration: cyxmake.toml\n");
         printf("\n");
     }
@@ -3959,9 +4019,16 @@ bool cmd_coordinator(ReplSession* session, const char* args) {
                    status.running ? "Yes" : "No", COLOR_RESET);
             printf("  %sWorkers:%s      %d connected, %d online\n", COLOR_BOLD, COLOR_RESET,
                    status.connected_workers, status.online_workers);
+            printf("  %sSlots:%s        %d effective of %d declared\n", COLOR_BOLD, COLOR_RESET,
+                   status.effective_slots, status.declared_slots);
             printf("  %sBuilds:%s       %d active\n", COLOR_BOLD, COLOR_RESET, status.active_builds);
             printf("  %sJobs:%s         %d pending, %d running\n", COLOR_BOLD, COLOR_RESET,
                    status.pending_jobs, status.running_jobs);
+            printf("  %sBatching:%s     %d batches, %d requests saved\n", COLOR_BOLD, COLOR_RESET,
+                   status.job_batches, status.messages_saved);
+            printf("  %sSpeculation:%s  %d launched, %d won, %.0fs wasted\n", COLOR_BOLD, COLOR_RESET,
+                   status.speculative_launched, status.speculative_wins,
+                   status.speculative_wasted_sec);
             printf("  %sCache:%s        %.1f MB (%.1f%% hit rate)\n", COLOR_BOLD, COLOR_RESET,
                    (double)status.cache_size / (1024 * 1024), status.cache_hit_rate * 100);
             printf("  %sUptime:%s       %ld seconds\n\n", COLOR_BOLD, COLOR_RESET, (long)status.uptime_sec);
@@ -3969,8 +4036,15 @@ bool cmd_coordinator(ReplSession* session, const char* args) {
             printf("\n=== Coordinator Status ===\n\n");
             printf("  Running:      %s\n", status.running ? "Yes" : "No");
             printf("  Workers:      %d connected, %d online\n", status.connected_workers, status.online_workers);
+            printf("  Slots:        %d effective of %d declared\n",
+                   status.effective_slots, status.declared_slots);
             printf("  Builds:       %d active\n", status.active_builds);
             printf("  Jobs:         %d pending, %d running\n", status.pending_jobs, status.running_jobs);
+            printf("  Batching:     %d batches, %d requests saved\n",
+                   status.job_batches, status.messages_saved);
+            printf("  Speculation:  %d launched, %d won, %.0fs wasted\n",
+                   status.speculative_launched, status.speculative_wins,
+                   status.speculative_wasted_sec);
             printf("  Cache:        %.1f MB (%.1f%% hit rate)\n",
                    (double)status.cache_size / (1024 * 1024), status.cache_hit_rate * 100);
             printf("  Uptime:       %ld seconds\n\n", (long)status.uptime_sec);
@@ -7,6 +7,7 @@
 #include "cyxmake/project_context.h"
 #include "cyxmake/logger.h"
 #include "cyxmake/compat.h"
+#include "cyxmake/distributed/local_executor.h"
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
@@ -39,6 +40,7 @@ BuildOptions* build_options_default(void) {
     opts->parallel_jobs = 0;  /* Auto-detect */
     opts->target = NULL;
     opts->build_dir = NULL;
+    opts->local_compile = false;
 
     return opts;
 }
@@ -288,6 +290,40 @@ BuildResult* build_execute_command(const char* command, const char* working_dir)
     return result;
 }
 
+/**
+ * Compile the translation units listed in the build directory's
+ * compile_commands.json over a local process pool, with the artifact cache.
+ * The native build then only has to link.
+ * @return Result, or NULL if there is no compilation database
+ */
+static BuildResult* build_compile_locally(const char* build_dir, const BuildOptions* opts) {
+    char db_path[1024];
+    snprintf(db_path, sizeof(db_path), "%s/compile_commands.json", build_dir);
+    if (access(db_path, F_OK) != 0) {
+        log_debug("No compilation database in %s, skipping local compile", build_dir);
+        return NULL;
+    }
+
+    CompileDatabase* db = compile_db_load(db_path);
+    if (!db) return NULL;
+
+    ArtifactCache* cache = artifact_cache_create(NULL);
+    if (cache && !artifact_cache_init(cache)) {
+        artifact_cache_free(cache);
+        cache = NULL;
+    }
+
+    LocalExecutorConfig config = local_executor_config_default();
+    config.max_jobs = opts->parallel_jobs;
+    config.cache = cache;
+
+    BuildResult* result = local_execute_compile_db(db, &config, NULL);
+
+    artifact_cache_free(cache);
+    compile_db_free(db);
+    return result;
+}
+
 /* Execute build */
 BuildResult* build_execute(const ProjectContext* ctx, const BuildOptions* opts) {
     if (!ctx) return NULL;
@@ -404,6 +440,19 @@ BuildResult* build_execute(const ProjectContext* ctx, const BuildOptions* opts)
     const char* working_dir = opts->build_dir ? opts->build_dir :
                              (build_dir ? build_dir : ctx->root_path);
 
+    /* Compile sources over a local process pool first; a failure there
+     * is the build's failure */
+    if (opts->local_compile) {
+        BuildResult* local = build_compile_locally(working_dir, opts);
+        if (local && !local->success) {
+            free(command);
+            free(build_dir);
+            if (default_opts) build_options_free(default_opts);
+            return local;
+        }
+        build_result_free(local);
+    }
+
     /* Execute command */
     log_plain("\n");
     BuildResult* result = build_execute_command(command, working_dir);
@@ -72,6 +72,7 @@ Config* config_create_default(void) {
     config->build.build_dir = strdup("build");
     config->build.parallel_jobs = 0;   /* Auto-detect */
     config->build.clean_first = false;
+    config->build.local_compile = false;
 
     /* Permission defaults - safe by default */
     config->permissions.auto_approve_read = true;
@@ -94,6 +95,8 @@ Config* config_create_default(void) {
     config->ai.timeout = 300;
     config->ai.max_tokens = 1024;
     config->ai.temperature = 0.7f;
+    config->ai.prefetch_local_model = false;
+    config->ai.local_parallel = 1;
 
     config->loaded = false;
     return config;
@@ -200,6 +203,7 @@ Config* config_load(const char* config_path) {
 
         config->build.parallel_jobs = toml_int_or_default(build, "parallel_jobs", 0);
         config->build.clean_first = toml_bool_or_default(build, "clean_first", false);
+        config->build.local_compile = toml_bool_or_default(build, "local_compile", false);
     }
 
     /* Parse [permissions] section */
@@ -234,6 +238,8 @@ Config* config_load(const char* config_path) {
         config->ai.timeout = toml_int_or_default(ai, "timeout", 300);
         config->ai.max_tokens = toml_int_or_default(ai, "max_tokens", 1024);
         config->ai.temperature = (float)toml_double_or_default(ai, "temperature", 0.7);
+        config->ai.prefetch_local_model = toml_bool_or_default(ai, "prefetch_local_model", false);
+        config->ai.local_parallel = toml_int_or_default(ai, "local_parallel", 1);
     }
 
     toml_free(root);
@@ -133,19 +133,19 @@ Orchestrator* cyxmake_init(const char* config_path) {
             llm_config->model_path = model_path;
             llm_config->n_ctx = 4096;       /* Context for error analysis */
             llm_config->verbose = false;
+            if (orch->config && orch->config->ai.local_parallel > 1) {
+                llm_config->n_parallel = orch->config->ai.local_parallel;
+            }
 
-            orch->llm = llm_init(llm_config);
+            /* The model loads on the first AI request (or in the background
+             * when prefetch is on), so runs that never need AI skip it */
+            bool prefetch = orch->config && orch->config->ai.prefetch_local_model;
+            orch->llm = llm_init_deferred(llm_config, prefetch);
 
-            if (orch->llm && llm_is_ready(orch->llm)) {
-                log_success("AI engine ready (local llama.cpp)");
+            if (orch->llm) {
+                log_success("AI engine ready (local llama.cpp, %s)",
+                           prefetch ? "loading in background" : "loads on first use");
                 orch->ai_enabled = true;
-
-                /* Get model info */
-                LLMModelInfo* info = llm_get_model_info(orch->llm);
-                if (info) {
-                    log_debug("Model: %s (%s)", info->model_name, info->model_type);
-                    llm_model_info_free(info);
-                }
             } else {
                 log_warning("AI engine failed to initialize - continuing without AI");
                 orch->ai_enabled = false;
@@ -393,6 +393,20 @@ CyxMakeError cyxmake_build(Orchestrator* orch, const char* project_path) {
 
     log_plain("\n");
 
+    /* Build options only come from config when it asks for something the
+     * defaults don't do */
+    BuildOptions* build_opts = NULL;
+    if (orch->config && orch->config->build.local_compile) {
+        build_opts = build_options_default();
+        if (build_opts) {
+            int cores = build_get_cpu_cores();
+            build_opts->parallel_jobs = orch->config->build.parallel_jobs > 0
+                ? orch->config->build.parallel_jobs
+                : (cores > 1 ? cores - 1 : 1);
+            build_opts->local_compile = true;
+        }
+    }
+
     /* Use AI-powered recovery if enabled */
     BuildResult* result = NULL;
 
@@ -415,7 +429,7 @@ CyxMakeError cyxmake_build(Orchestrator* orch, const char* project_path) {
             log_info("Starting build with recovery enabled (max %d retries)",
                     orch->recovery_strategy.max_retries);
 
-            result = build_with_retry(orch->current_project, NULL, &orch->recovery_strategy);
+            result = build_with_retry(orch->current_project, build_opts, &orch->recovery_strategy);
 
             /* Get recovery stats */
             int total_attempts, successful_recoveries;
@@ -435,13 +449,15 @@ CyxMakeError cyxmake_build(Orchestrator* orch, const char* project_path) {
             recovery_context_free(recovery_ctx);
         } else {
             /* Fallback to simple build */
-            result = build_execute(orch->current_project, NULL);
+            result = build_execute(orch->current_project, build_opts);
         }
     } else {
         /* Simple build without recovery */
-        result = build_execute(orch->current_project, NULL);
+        result = build_execute(orch->current_project, build_opts);
     }
 
+    build_options_free(build_opts);
+
     if (!result) {
         log_error("Failed to execute build");
         return CYXMAKE_ERROR_BUILD;
@@ -7,15 +7,18 @@
  */
 
 #include "cyxmake/distributed/artifact_cache.h"
+#include "cyxmake/distributed/sha256.h"
 #include "cyxmake/logger.h"
 #include "cyxmake/compat.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <ctype.h>
 #include <sys/stat.h>
 
 #ifdef _WIN32
+#include <windows.h>
 #include <direct.h>
 #include <io.h>
 #define mkdir(path, mode) _mkdir(path)
@@ -137,23 +140,88 @@ static bool copy_file(const char* src, const char* dst) {
     return success;
 }
 
-/* Simple SHA-256-like hash (not cryptographically secure) */
-static void simple_hash(const void* data, size_t len, unsigned char* out) {
-    const unsigned char* input = (const unsigned char*)data;
-    unsigned char state[32] = {
-        0x6a, 0x09, 0xe6, 0x67, 0xbb, 0x67, 0xae, 0x85,
-        0x3c, 0x6e, 0xf3, 0x72, 0xa5, 0x4f, 0xf5, 0x3a,
-        0x51, 0x0e, 0x52, 0x7f, 0x9b, 0x05, 0x68, 0x8c,
-        0x1f, 0x83, 0xd9, 0xab, 0x5b, 0xe0, 0xcd, 0x19
-    };
+static bool replace_file(const char* src, const char* dst) {
+#ifdef _WIN32
+    return MoveFileExA(src, dst, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(src, dst) == 0;
+#endif
+}
 
-    for (size_t i = 0; i < len; i++) {
-        state[i % 32] ^= input[i];
-        state[(i + 1) % 32] += state[i % 32];
-        state[(i + 7) % 32] ^= (state[(i + 3) % 32] >> 3);
+static void remove_directory_files(const char* dir) {
+    char path[1024];
+#ifdef _WIN32
+    char pattern[1024];
+    snprintf(pattern, sizeof(pattern), "%s\\*", dir);
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA(pattern, &data);
+    if (find == INVALID_HANDLE_VALUE) return;
+    do {
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+        snprintf(path, sizeof(path), "%s\\%s", dir, data.cFileName);
+        remove(path);
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+#else
+    DIR* d = opendir(dir);
+    if (!d) return;
+    struct dirent* ent;
+    while ((ent = readdir(d)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+        remove(path);
+    }
+    closedir(d);
+#endif
+}
+
+/* Caller holds the cache lock */
+static ArtifactEntry* find_entry(ArtifactCache* cache, const char* cache_key) {
+    for (ArtifactEntry* e = cache->entries; e; e = e->next) {
+        if (strcmp(e->cache_key, cache_key) == 0) return e;
+    }
+    return NULL;
+}
+
+/**
+ * Register an artifact stored under its key by an earlier process.
+ * Entries only live in memory, so without this a new process never hits.
+ * Caller holds the cache lock.
+ */
+static ArtifactEntry* adopt_stored_entry(ArtifactCache* cache, const char* cache_key) {
+    if (!cache->config.cache_dir || strlen(cache_key) < 2) return NULL;
+
+    /* Keys are hex digests; anything else must not reach the path */
+    for (const char* k = cache_key; *k; k++) {
+        if (!isalnum((unsigned char)*k)) return NULL;
     }
 
-    memcpy(out, state, 32);
+    char cached_path[512];
+    snprintf(cached_path, sizeof(cached_path), "%s/%c%c/%s",
+             cache->config.cache_dir, cache_key[0], cache_key[1], cache_key);
+    if (!file_exists(cached_path)) return NULL;
+
+    ArtifactEntry* entry = calloc(1, sizeof(ArtifactEntry));
+    if (!entry) return NULL;
+
+    entry->cache_key = strdup(cache_key);
+    entry->cached_path = strdup(cached_path);
+    if (!entry->cache_key || !entry->cached_path) {
+        artifact_entry_free(entry);
+        return NULL;
+    }
+    entry->type = ARTIFACT_OTHER;
+    entry->size_bytes = get_file_size(cached_path);
+    entry->created_at = time(NULL);
+    entry->last_accessed = entry->created_at;
+
+    entry->next = cache->entries;
+    cache->entries = entry;
+    cache->entry_count++;
+    cache->total_size += entry->size_bytes;
+
+    log_debug("Adopted stored artifact: %s", cache_key);
+    return entry;
 }
 
 static char* bytes_to_hex(const unsigned char* bytes, size_t len) {
@@ -342,12 +410,18 @@ char* artifact_cache_generate_key(const CacheKeyInput* input) {
     total_len += strlen(input->source_file) + 1;
     if (input->compiler) total_len += strlen(input->compiler) + 1;
     if (input->target_triple) total_len += strlen(input->target_triple) + 1;
+    if (input->source_content) total_len += input->source_size + 1;
 
     for (int i = 0; i < input->flag_count && input->compiler_flags; i++) {
         if (input->compiler_flags[i]) {
             total_len += strlen(input->compiler_flags[i]) + 1;
         }
     }
+    for (int i = 0; i < input->include_count && input->include_paths; i++) {
+        if (input->include_paths[i]) {
+            total_len += strlen(input->include_paths[i]) + 3;
+        }
+    }
 
     char* combined = malloc(total_len + 1);
     if (!combined) return NULL;
@@ -363,9 +437,22 @@ char* artifact_cache_generate_key(const CacheKeyInput* input) {
         }
     }
 
+    /* Include directories change which headers the source sees */
+    for (int i = 0; i < input->include_count && input->include_paths; i++) {
+        if (input->include_paths[i]) {
+            p += sprintf(p, "-I%s|", input->include_paths[i]);
+        }
+    }
+
+    if (input->source_content) {
+        memcpy(p, input->source_content, input->source_size);
+        p += input->source_size;
+        *p++ = '|';
+    }
+
     /* Hash the combined string */
     unsigned char hash[32];
-    simple_hash(combined, strlen(combined), hash);
+    sha256(combined, (size_t)(p - combined), hash);
     free(combined);
 
     return bytes_to_hex(hash, 32);
@@ -378,15 +465,15 @@ CacheHitStatus artifact_cache_lookup(ArtifactCache* cache,
     cache_lock(cache);
     cache->stats.total_lookups++;
 
-    /* Search local entries */
-    for (ArtifactEntry* e = cache->entries; e; e = e->next) {
-        if (strcmp(e->cache_key, cache_key) == 0) {
-            e->last_accessed = time(NULL);
-            e->access_count++;
-            cache->stats.local_hits++;
-            cache_unlock(cache);
-            return CACHE_HIT_LOCAL;
-        }
+    /* Search local entries, then what earlier processes left on disk */
+    ArtifactEntry* e = find_entry(cache, cache_key);
+    if (!e) e = adopt_stored_entry(cache, cache_key);
+    if (e) {
+        e->last_accessed = time(NULL);
+        e->access_count++;
+        cache->stats.local_hits++;
+        cache_unlock(cache);
+        return CACHE_HIT_LOCAL;
     }
 
     cache->stats.misses++;
@@ -403,17 +490,15 @@ ArtifactEntry* artifact_cache_get(ArtifactCache* cache,
 
     cache_lock(cache);
 
-    for (ArtifactEntry* e = cache->entries; e; e = e->next) {
-        if (strcmp(e->cache_key, cache_key) == 0) {
-            e->last_accessed = time(NULL);
-            e->access_count++;
-            cache_unlock(cache);
-            return e;
-        }
+    ArtifactEntry* e = find_entry(cache, cache_key);
+    if (!e) e = adopt_stored_entry(cache, cache_key);
+    if (e) {
+        e->last_accessed = time(NULL);
+        e->access_count++;
     }
 
     cache_unlock(cache);
-    return NULL;
+    return e;
 }
 
 bool artifact_cache_retrieve(ArtifactCache* cache,
@@ -493,9 +578,13 @@ ArtifactEntry* artifact_cache_store(ArtifactCache* cache,
 
     entry->cached_path = strdup(cached_path);
 
-    /* Copy file to cache */
-    if (!copy_file(file_path, cached_path)) {
+    /* Copy file to cache; the rename keeps a partial copy from ever
+     * being found under the key by a later process */
+    char temp_path[520];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", cached_path);
+    if (!copy_file(file_path, temp_path) || !replace_file(temp_path, cached_path)) {
         log_error("Failed to store artifact: %s", cache_key);
+        remove(temp_path);
         artifact_entry_free(entry);
         cache_unlock(cache);
         return NULL;
@@ -768,6 +857,15 @@ void artifact_cache_clear(ArtifactCache* cache) {
     cache->entry_count = 0;
     cache->total_size = 0;
 
+    /* Artifacts stored by other processes would otherwise be adopted again */
+    if (cache->config.cache_dir) {
+        for (int i = 0; i < 256; i++) {
+            char subdir[512];
+            snprintf(subdir, sizeof(subdir), "%s/%02x", cache->config.cache_dir, i);
+            remove_directory_files(subdir);
+        }
+    }
+
     cache_unlock(cache);
 
     log_info("Artifact cache cleared");
@@ -819,26 +917,27 @@ char* artifact_hash_file(const char* file_path) {
     FILE* f = fopen(file_path, "rb");
     if (!f) return NULL;
 
-    unsigned char hash[32] = {0};
+    Sha256Context ctx;
+    sha256_init(&ctx);
+
     unsigned char buffer[8192];
     size_t bytes;
-
     while ((bytes = fread(buffer, 1, sizeof(buffer), f)) > 0) {
-        for (size_t i = 0; i < bytes; i++) {
-            hash[i % 32] ^= buffer[i];
-            hash[(i + 1) % 32] += hash[i % 32];
-        }
+        sha256_update(&ctx, buffer, bytes);
     }
 
     fclose(f);
-    return bytes_to_hex(hash, 32);
+
+    unsigned char hash[SHA256_DIGEST_SIZE];
+    sha256_final(&ctx, hash);
+    return bytes_to_hex(hash, SHA256_DIGEST_SIZE);
 }
 
 char* artifact_hash_buffer(const void* data, size_t size) {
     if (!data || size == 0) return NULL;
 
     unsigned char hash[32];
-    simple_hash(data, size, hash);
+    sha256(data, size, hash);
     return bytes_to_hex(hash, 32);
 }
 
@@ -4,9 +4,16 @@
  *
  * Provides secure token-based authentication with HMAC signing,
  * challenge-response support, and token lifecycle management.
+ *
+ * A token value is "<token_id>.<secret>". The context stores only a
+ * salted HMAC-SHA256 digest of the secret, in a hash table keyed by token
+ * ID, so validation is one bucket lookup and one digest regardless of
+ * how many tokens are issued. Digests and challenge responses are
+ * compared in constant time.
  */
 
 #include "cyxmake/distributed/auth.h"
+#include "cyxmake/distributed/sha256.h"
 #include "cyxmake/logger.h"
 
 #include <stdlib.h>
@@ -32,6 +39,9 @@
 #define DEFAULT_LOCKOUT_DURATION_SEC 300
 #define DEFAULT_MAX_CHALLENGE_ATTEMPTS 5
 #define TOKEN_RANDOM_BYTES 32
+#define TOKEN_SALT_BYTES 16
+#define TOKEN_ID_SEPARATOR '.'
+#define MIN_TOKEN_BUCKETS 64
 #define CHALLENGE_RANDOM_BYTES 32
 #define MAX_CHALLENGES 100
 
@@ -47,6 +57,8 @@ struct AuthContext {
     AuthConfig config;
     AuthToken* tokens;            /* Token list */
     int token_count;
+    AuthToken** by_id;            /* Hash index, chained through id_next */
+    size_t bucket_count;          /* Power of two, grown to keep chains short */
     AuthChallenge* challenges[MAX_CHALLENGES];
     int challenge_count;
 
@@ -167,22 +179,87 @@ static char* generate_uuid(void) {
     return uuid;
 }
 
-/* Simple HMAC-like hash (not cryptographically secure without OpenSSL) */
-static char* simple_hash(const char* data, const char* key) {
-    if (!data || !key) return NULL;
+/* Compare without an early exit, so timing does not reveal the matching prefix */
+static bool constant_time_equal(const void* a, const void* b, size_t len) {
+    const volatile unsigned char* x = (const volatile unsigned char*)a;
+    const volatile unsigned char* y = (const volatile unsigned char*)b;
+    unsigned char diff = 0;
+    for (size_t i = 0; i < len; i++) {
+        diff |= x[i] ^ y[i];
+    }
+    return diff == 0;
+}
+
+/* ============================================================
+ * Token Index (caller holds the lock)
+ * ============================================================ */
+
+static size_t token_bucket(const AuthContext* ctx, const char* id, size_t id_len) {
+    uint32_t h = 2166136261u;     /* FNV-1a */
+    for (size_t i = 0; i < id_len; i++) {
+        h ^= (uint8_t)id[i];
+        h *= 16777619u;
+    }
+    return h & (ctx->bucket_count - 1);
+}
+
+static AuthToken* index_find(const AuthContext* ctx, const char* id, size_t id_len) {
+    for (AuthToken* t = ctx->by_id[token_bucket(ctx, id, id_len)]; t; t = t->id_next) {
+        if (strncmp(t->token_id, id, id_len) == 0 && t->token_id[id_len] == '\0') {
+            return t;
+        }
+    }
+    return NULL;
+}
+
+static void index_insert(AuthContext* ctx, AuthToken* token) {
+    /* Keep the load factor at or below one */
+    if ((size_t)ctx->token_count >= ctx->bucket_count) {
+        size_t grown = ctx->bucket_count * 2;
+        AuthToken** buckets = calloc(grown, sizeof(AuthToken*));
+        if (buckets) {
+            free(ctx->by_id);
+            ctx->by_id = buckets;
+            ctx->bucket_count = grown;
+            for (AuthToken* t = ctx->tokens; t; t = t->next) {
+                if (t == token) continue;
+                size_t b = token_bucket(ctx, t->token_id, strlen(t->token_id));
+                t->id_next = ctx->by_id[b];
+                ctx->by_id[b] = t;
+            }
+        }
+        /* On failure chains just get longer */
+    }
 
-    /* XOR-based hash (for demonstration - use OpenSSL in production) */
-    size_t data_len = strlen(data);
-    size_t key_len = strlen(key);
-    unsigned char hash[32] = {0};
+    size_t b = token_bucket(ctx, token->token_id, strlen(token->token_id));
+    token->id_next = ctx->by_id[b];
+    ctx->by_id[b] = token;
+}
 
-    for (size_t i = 0; i < data_len; i++) {
-        hash[i % 32] ^= (unsigned char)data[i];
-        hash[(i + 1) % 32] ^= (unsigned char)key[i % key_len];
-        hash[(i + 2) % 32] ^= (unsigned char)(i & 0xFF);
+static void index_remove(AuthContext* ctx, AuthToken* token) {
+    size_t b = token_bucket(ctx, token->token_id, strlen(token->token_id));
+    for (AuthToken** pp = &ctx->by_id[b]; *pp; pp = &(*pp)->id_next) {
+        if (*pp == token) {
+            *pp = token->id_next;
+            return;
+        }
     }
+}
+
+/* Find the stored token a presented value belongs to, verifying its secret */
+static AuthToken* find_by_value(AuthContext* ctx, const char* token_value) {
+    const char* separator = strchr(token_value, TOKEN_ID_SEPARATOR);
+    if (!separator) return NULL;
+
+    AuthToken* token = index_find(ctx, token_value, (size_t)(separator - token_value));
+    if (!token || !token->token_hash) return NULL;
 
-    return base64_encode(hash, 32);
+    char* digest = auth_hash_token(separator + 1, token->token_salt);
+    bool match = digest && strlen(digest) == strlen(token->token_hash) &&
+                 constant_time_equal(digest, token->token_hash, strlen(digest));
+    free(digest);
+
+    return match ? token : NULL;
 }
 
 /* ============================================================
@@ -251,6 +328,15 @@ AuthContext* auth_context_create(const AuthConfig* config) {
         }
     }
 
+    ctx->bucket_count = MIN_TOKEN_BUCKETS;
+    ctx->by_id = calloc(ctx->bucket_count, sizeof(AuthToken*));
+    if (!ctx->by_id) {
+        log_error("Failed to allocate token index");
+        auth_config_free(&ctx->config);
+        free(ctx);
+        return NULL;
+    }
+
 #ifdef CYXMAKE_ENABLE_DISTRIBUTED
     if (!mutex_init(&ctx->mutex)) {
         log_error("Failed to create auth context mutex");
@@ -270,6 +356,7 @@ void auth_context_free(AuthContext* ctx) {
 
     /* Free all tokens */
     auth_token_list_free(ctx->tokens);
+    free(ctx->by_id);
 
     /* Free all challenges */
     for (int i = 0; i < ctx->challenge_count; i++) {
@@ -296,6 +383,8 @@ void auth_token_free(AuthToken* token) {
 
     free(token->token_id);
     free(token->token_value);
+    free(token->token_hash);
+    free(token->token_salt);
     free(token->issuer);
     free(token->subject);
     free(token->revocation_reason);
@@ -335,6 +424,8 @@ AuthToken* auth_token_clone(const AuthToken* token) {
 
     if (token->token_id) clone->token_id = strdup(token->token_id);
     if (token->token_value) clone->token_value = strdup(token->token_value);
+    if (token->token_hash) clone->token_hash = strdup(token->token_hash);
+    if (token->token_salt) clone->token_salt = strdup(token->token_salt);
     if (token->issuer) clone->issuer = strdup(token->issuer);
     if (token->subject) clone->subject = strdup(token->subject);
     if (token->revocation_reason) clone->revocation_reason = strdup(token->revocation_reason);
@@ -374,11 +465,14 @@ AuthToken* auth_token_generate(AuthContext* ctx,
         return NULL;
     }
 
-    /* Generate token ID and value */
+    /* Generate token ID and secret; only the salted digest is kept */
     token->token_id = generate_uuid();
-    token->token_value = auth_generate_random_token(TOKEN_RANDOM_BYTES);
+    char* secret = auth_generate_random_token(TOKEN_RANDOM_BYTES);
+    token->token_salt = auth_generate_random_token(TOKEN_SALT_BYTES);
+    token->token_hash = secret ? auth_hash_token(secret, token->token_salt) : NULL;
 
-    if (!token->token_id || !token->token_value) {
+    if (!token->token_id || !token->token_salt || !token->token_hash) {
+        free(secret);
         auth_token_free(token);
         context_unlock(ctx);
         return NULL;
@@ -424,9 +518,25 @@ AuthToken* auth_token_generate(AuthContext* ctx,
             break;
     }
 
-    /* Add to list */
+    /* The caller's copy carries the only plaintext value */
+    AuthToken* issued = auth_token_clone(token);
+    size_t value_len = strlen(token->token_id) + 1 + strlen(secret) + 1;
+    char* value = issued ? malloc(value_len) : NULL;
+    if (!value) {
+        free(secret);
+        auth_token_free(issued);
+        auth_token_free(token);
+        context_unlock(ctx);
+        return NULL;
+    }
+    snprintf(value, value_len, "%s%c%s", token->token_id, TOKEN_ID_SEPARATOR, secret);
+    issued->token_value = value;
+    free(secret);
+
+    /* Add to list and index */
     token->next = ctx->tokens;
     ctx->tokens = token;
+    index_insert(ctx, token);
     ctx->token_count++;
 
     log_info("Token generated: %s (type: %s, subject: %s)",
@@ -436,7 +546,7 @@ AuthToken* auth_token_generate(AuthContext* ctx,
 
     context_unlock(ctx);
 
-    return token;
+    return issued;
 }
 
 AuthResult auth_token_validate(AuthContext* ctx,
@@ -452,13 +562,7 @@ AuthResult auth_token_validate(AuthContext* ctx,
 
     context_lock(ctx);
 
-    AuthToken* token = NULL;
-    for (AuthToken* t = ctx->tokens; t; t = t->next) {
-        if (strcmp(t->token_value, token_value) == 0) {
-            token = t;
-            break;
-        }
-    }
+    AuthToken* token = find_by_value(ctx, token_value);
 
     if (!token) {
         context_unlock(ctx);
@@ -504,32 +608,20 @@ AuthToken* auth_token_lookup(AuthContext* ctx, const char* token_value) {
     if (!ctx || !token_value) return NULL;
 
     context_lock(ctx);
-
-    for (AuthToken* t = ctx->tokens; t; t = t->next) {
-        if (strcmp(t->token_value, token_value) == 0) {
-            context_unlock(ctx);
-            return t;
-        }
-    }
-
+    AuthToken* token = find_by_value(ctx, token_value);
     context_unlock(ctx);
-    return NULL;
+
+    return token;
 }
 
 AuthToken* auth_token_lookup_by_id(AuthContext* ctx, const char* token_id) {
     if (!ctx || !token_id) return NULL;
 
     context_lock(ctx);
-
-    for (AuthToken* t = ctx->tokens; t; t = t->next) {
-        if (strcmp(t->token_id, token_id) == 0) {
-            context_unlock(ctx);
-            return t;
-        }
-    }
-
+    AuthToken* token = index_find(ctx, token_id, strlen(token_id));
     context_unlock(ctx);
-    return NULL;
+
+    return token;
 }
 
 bool auth_token_revoke(AuthContext* ctx,
@@ -539,18 +631,17 @@ bool auth_token_revoke(AuthContext* ctx,
 
     context_lock(ctx);
 
-    for (AuthToken* t = ctx->tokens; t; t = t->next) {
-        if (strcmp(t->token_id, token_id) == 0) {
-            t->revoked = true;
-            free(t->revocation_reason);
-            t->revocation_reason = reason ? strdup(reason) : NULL;
+    AuthToken* t = index_find(ctx, token_id, strlen(token_id));
+    if (t) {
+        t->revoked = true;
+        free(t->revocation_reason);
+        t->revocation_reason = reason ? strdup(reason) : NULL;
 
-            log_info("Token revoked: %s (%s)", token_id,
-                     reason ? reason : "no reason");
+        log_info("Token revoked: %s (%s)", token_id,
+                 reason ? reason : "no reason");
 
-            context_unlock(ctx);
-            return true;
-        }
+        context_unlock(ctx);
+        return true;
     }
 
     context_unlock(ctx);
@@ -570,13 +661,7 @@ AuthToken* auth_token_refresh(AuthContext* ctx,
 
     context_lock(ctx);
 
-    AuthToken* token = NULL;
-    for (AuthToken* t = ctx->tokens; t; t = t->next) {
-        if (strcmp(t->token_value, token_value) == 0) {
-            token = t;
-            break;
-        }
-    }
+    AuthToken* token = find_by_value(ctx, token_value);
 
     if (!token || token->revoked) {
         context_unlock(ctx);
@@ -623,6 +708,7 @@ int auth_token_cleanup_expired(AuthContext* ctx) {
             } else {
                 ctx->tokens = next;
             }
+            index_remove(ctx, token);
             ctx->token_count--;
             removed++;
 
@@ -691,8 +777,10 @@ AuthChallenge* auth_challenge_create(AuthContext* ctx) {
     }
 
     /* Compute expected response */
-    challenge->expected_response = simple_hash(challenge->challenge_data,
-                                                ctx->config.hmac_secret);
+    challenge->expected_response = auth_create_hmac(challenge->challenge_data,
+                                                    strlen(challenge->challenge_data),
+                                                    ctx->config.hmac_secret,
+                                                    ctx->config.hmac_secret_len);
 
     challenge->created_at = now;
     challenge->expires_at = now + ctx->config.challenge_ttl_sec;
@@ -751,8 +839,7 @@ AuthResult auth_challenge_verify(AuthContext* ctx,
     challenge->used = true;
 
     /* Verify response */
-    bool valid = (challenge->expected_response &&
-                  strcmp(response, challenge->expected_response) == 0);
+    bool valid = auth_secure_equals(challenge->expected_response, response);
 
     context_unlock(ctx);
 
@@ -792,43 +879,22 @@ char* auth_generate_random_token(size_t length) {
 char* auth_hash_token(const char* token_value, const char* salt) {
     if (!token_value) return NULL;
 
-    /* Combine token and salt */
-    size_t token_len = strlen(token_value);
-    size_t salt_len = salt ? strlen(salt) : 0;
-    char* combined = malloc(token_len + salt_len + 1);
-    if (!combined) return NULL;
-
-    strcpy(combined, token_value);
-    if (salt) {
-        strcat(combined, salt);
-    }
-
-    char* hash = simple_hash(combined, "cyxmake-token-hash");
-    free(combined);
+    /* The salt keys the HMAC, so equal secrets never share a digest */
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    hmac_sha256(salt ? salt : "", salt ? strlen(salt) : 0,
+                token_value, strlen(token_value), digest);
 
-    return hash;
+    return base64_encode(digest, sizeof(digest));
 }
 
 char* auth_create_hmac(const void* data, size_t len,
                        const void* key, size_t key_len) {
     if (!data || !key) return NULL;
 
-    /* Simple HMAC approximation */
-    char* data_str = base64_encode(data, len);
-    char* key_str = base64_encode(key, key_len);
-
-    if (!data_str || !key_str) {
-        free(data_str);
-        free(key_str);
-        return NULL;
-    }
-
-    char* hmac = simple_hash(data_str, key_str);
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    hmac_sha256(key, key_len, data, len, digest);
 
-    free(data_str);
-    free(key_str);
-
-    return hmac;
+    return base64_encode(digest, sizeof(digest));
 }
 
 bool auth_verify_hmac(const void* data, size_t len,
@@ -839,12 +905,21 @@ bool auth_verify_hmac(const void* data, size_t len,
     char* computed = auth_create_hmac(data, len, key, key_len);
     if (!computed) return false;
 
-    bool valid = (strcmp(computed, signature) == 0);
+    bool valid = auth_secure_equals(computed, signature);
     free(computed);
 
     return valid;
 }
 
+bool auth_secure_equals(const char* expected, const char* presented) {
+    if (!expected || !presented) return false;
+
+    /* Only the lengths may leak; contents are compared in full */
+    size_t len = strlen(expected);
+    if (strlen(presented) != len) return false;
+    return constant_time_equal(expected, presented, len);
+}
+
 /* ============================================================
  * Result Helpers
  * ============================================================ */
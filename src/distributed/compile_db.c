@@ -0,0 +1,795 @@
+/**
+ * @file compile_db.c
+ * @brief Streaming compile_commands.json reader with string interning
+ *
+ * The file is read in chunks and split into top-level array elements by a
+ * small scanner that tracks brace depth and string state across chunk
+ * boundaries. Only one element is handed to cJSON at a time, so memory is
+ * bounded by the largest entry plus the interned data.
+ *
+ * Strings and string lists are interned in chained hash tables (64-bit
+ * FNV-1a). Lists hash the pointers of their interned items, so comparing
+ * two lists never touches the text.
+ */
+
+#include "cyxmake/distributed/compile_db.h"
+#include "cyxmake/distributed/artifact_cache.h"
+#include "cyxmake/logger.h"
+
+#include <cJSON.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================
+ * Constants
+ * ============================================================ */
+
+#define READ_CHUNK_SIZE (64 * 1024)
+#define MIN_INTERN_BUCKETS 256
+#define MIN_ENTRY_CAPACITY 64
+
+/* ============================================================
+ * Internal Structures
+ * ============================================================ */
+
+typedef struct InternNode {
+    struct InternNode* next;
+    uint64_t hash;
+} InternNode;
+
+typedef struct {
+    InternNode node;
+    size_t len;
+    char text[];
+} InternedString;
+
+typedef struct {
+    InternNode node;
+    int count;
+    const char* items[];          /* count items, then NULL */
+} InternedList;
+
+typedef struct {
+    InternNode** buckets;
+    size_t bucket_count;          /* Power of two */
+    size_t count;
+} InternTable;
+
+struct CompileDatabase {
+    CompileCommand* entries;
+    int entry_count;
+    int entry_capacity;
+
+    InternTable strings;
+    InternTable lists;
+    CompileDbStats stats;
+};
+
+/* A growable list of interned pointers used while reading one entry */
+typedef struct {
+    const char** items;
+    int count;
+    int capacity;
+} PtrList;
+
+/* ============================================================
+ * Interning
+ * ============================================================ */
+
+static uint64_t fnv1a(uint64_t h, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+#define FNV_OFFSET 14695981039346656037ull
+
+static bool table_init(InternTable* table) {
+    table->bucket_count = MIN_INTERN_BUCKETS;
+    table->count = 0;
+    table->buckets = calloc(table->bucket_count, sizeof(InternNode*));
+    return table->buckets != NULL;
+}
+
+static void table_free(InternTable* table) {
+    for (size_t b = 0; b < table->bucket_count && table->buckets; b++) {
+        InternNode* node = table->buckets[b];
+        while (node) {
+            InternNode* next = node->next;
+            free(node);
+            node = next;
+        }
+    }
+    free(table->buckets);
+    table->buckets = NULL;
+}
+
+/* Keep the load factor at or below one; a failed grow only lengthens chains */
+static void table_insert(InternTable* table, InternNode* node) {
+    if (table->count >= table->bucket_count) {
+        size_t grown = table->bucket_count * 2;
+        InternNode** buckets = calloc(grown, sizeof(InternNode*));
+        if (buckets) {
+            for (size_t b = 0; b < table->bucket_count; b++) {
+                InternNode* n = table->buckets[b];
+                while (n) {
+                    InternNode* next = n->next;
+                    size_t slot = (size_t)n->hash & (grown - 1);
+                    n->next = buckets[slot];
+                    buckets[slot] = n;
+                    n = next;
+                }
+            }
+            free(table->buckets);
+            table->buckets = buckets;
+            table->bucket_count = grown;
+        }
+    }
+
+    size_t slot = (size_t)node->hash & (table->bucket_count - 1);
+    node->next = table->buckets[slot];
+    table->buckets[slot] = node;
+    table->count++;
+}
+
+static const char* intern_string(CompileDatabase* db, const char* s) {
+    if (!s) return NULL;
+
+    size_t len = strlen(s);
+    uint64_t hash = fnv1a(FNV_OFFSET, s, len);
+    size_t slot = (size_t)hash & (db->strings.bucket_count - 1);
+
+    for (InternNode* n = db->strings.buckets[slot]; n; n = n->next) {
+        InternedString* str = (InternedString*)n;
+        if (n->hash == hash && str->len == len && memcmp(str->text, s, len) == 0) {
+            return str->text;
+        }
+    }
+
+    InternedString* str = malloc(sizeof(InternedString) + len + 1);
+    if (!str) return NULL;
+    str->node.hash = hash;
+    str->len = len;
+    memcpy(str->text, s, len + 1);
+    table_insert(&db->strings, &str->node);
+    db->stats.string_bytes += len + 1;
+    return str->text;
+}
+
+/* Items must already be interned */
+static const char* const* intern_list(CompileDatabase* db, const PtrList* list) {
+    size_t bytes = sizeof(const char*) * (size_t)list->count;
+    uint64_t hash = fnv1a(FNV_OFFSET, list->items, bytes);
+    size_t slot = (size_t)hash & (db->lists.bucket_count - 1);
+
+    for (InternNode* n = db->lists.buckets[slot]; n; n = n->next) {
+        InternedList* l = (InternedList*)n;
+        if (n->hash == hash && l->count == list->count &&
+            (bytes == 0 || memcmp(l->items, list->items, bytes) == 0)) {
+            return l->items;
+        }
+    }
+
+    InternedList* l = malloc(sizeof(InternedList) + bytes + sizeof(const char*));
+    if (!l) return NULL;
+    l->node.hash = hash;
+    l->count = list->count;
+    if (bytes > 0) memcpy(l->items, list->items, bytes);
+    l->items[list->count] = NULL;
+    table_insert(&db->lists, &l->node);
+    return l->items;
+}
+
+static bool ptr_push(PtrList* list, const char* item) {
+    if (!item) return false;
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 32;
+        const char** items = realloc(list->items, sizeof(const char*) * (size_t)capacity);
+        if (!items) return false;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = item;
+    return true;
+}
+
+/* ============================================================
+ * Command Lines
+ * ============================================================ */
+
+/**
+ * Split a shell command into words in place (POSIX quoting rules)
+ * @return Number of words stored in words
+ */
+static int split_command(char* text, char** words, int max_words) {
+    int count = 0;
+    char* in = text;
+    char* out = text;
+
+    while (*in) {
+        while (*in == ' ' || *in == '\t' || *in == '\n' || *in == '\r') in++;
+        if (!*in) break;
+
+        char* word = out;
+        while (*in && *in != ' ' && *in != '\t' && *in != '\n' && *in != '\r') {
+            if (*in == '\'') {
+                in++;
+                while (*in && *in != '\'') *out++ = *in++;
+                if (*in) in++;
+            } else if (*in == '"') {
+                in++;
+                while (*in && *in != '"') {
+                    if (*in == '\\' && (in[1] == '"' || in[1] == '\\' ||
+                                        in[1] == '$' || in[1] == '`')) {
+                        in++;
+                    }
+                    *out++ = *in++;
+                }
+                if (*in) in++;
+            } else if (*in == '\\' && in[1]) {
+                in++;
+                *out++ = *in++;
+            } else {
+                *out++ = *in++;
+            }
+        }
+
+        /* The terminator may overwrite the separator just consumed */
+        bool more = *in != '\0';
+        if (more) in++;
+        *out++ = '\0';
+        if (count < max_words) words[count++] = word;
+        if (!more) break;
+    }
+
+    return count;
+}
+
+static const char* path_basename(const char* path) {
+    const char* base = path;
+    for (const char* p = path; *p; p++) {
+        if (*p == '/' || *p == '\\') base = p + 1;
+    }
+    return base;
+}
+
+/* Options whose value is the next argument */
+static bool takes_value(const char* arg) {
+    static const char* const options[] = {
+        "-D", "-U", "-MF", "-MT", "-MQ", "-include", "-imacros", "-isystem",
+        "-iquote", "-idirafter", "-isysroot", "-x", "-arch", "-target",
+        "-Xclang", "-Xlinker", "-Xpreprocessor", "-Xassembler", NULL
+    };
+    for (int i = 0; options[i]; i++) {
+        if (strcmp(arg, options[i]) == 0) return true;
+    }
+    return false;
+}
+
+/* Arguments of a depfile option starting at args[i] (0 = not one) */
+static int depfile_flag_span(char** args, int i, int count) {
+    const char* arg = args[i];
+    if (strcmp(arg, "-M") == 0 || strcmp(arg, "-MM") == 0 || strcmp(arg, "-MD") == 0 ||
+        strcmp(arg, "-MMD") == 0 || strcmp(arg, "-MP") == 0 || strcmp(arg, "-MG") == 0) {
+        return 1;
+    }
+    if (strncmp(arg, "-MF", 3) == 0 || strncmp(arg, "-MT", 3) == 0 ||
+        strncmp(arg, "-MQ", 3) == 0) {
+        return arg[3] == '\0' && i + 1 < count ? 2 : 1;
+    }
+    return 0;
+}
+
+/**
+ * Reduce argv to compiler, flags, include directories and output
+ * @return false if out of memory
+ */
+static bool classify_arguments(CompileDatabase* db, CompileCommand* cmd,
+                               char** argv, int argc) {
+    PtrList args = {0}, includes = {0}, depfile = {0};
+    bool ok = true;
+    const char* source_base = path_basename(cmd->file);
+    const char* output = NULL;
+
+    cmd->compiler = intern_string(db, argv[0]);
+
+    for (int i = 1; ok && i < argc; i++) {
+        const char* arg = argv[i];
+        bool has_next = i + 1 < argc;
+        int depfile_span = depfile_flag_span(argv, i, argc);
+
+        if (depfile_span > 0) {
+            for (int k = 0; ok && k < depfile_span; k++) {
+                ok = ptr_push(&depfile, intern_string(db, argv[i + k]));
+            }
+            i += depfile_span - 1;
+        } else if (strcmp(arg, "-c") == 0) {
+            continue;
+        } else if (strcmp(arg, "-o") == 0 && has_next) {
+            output = argv[++i];
+        } else if (strncmp(arg, "-o", 2) == 0 && arg[2]) {
+            output = arg + 2;
+        } else if (strcmp(arg, "-I") == 0 && has_next) {
+            ok = ptr_push(&includes, intern_string(db, argv[++i]));
+        } else if (strncmp(arg, "-I", 2) == 0 && arg[2]) {
+            ok = ptr_push(&includes, intern_string(db, arg + 2));
+        } else if (arg[0] != '-' && strcmp(path_basename(arg), source_base) == 0) {
+            continue;  /* The source itself */
+        } else if (takes_value(arg) && has_next) {
+            ok = ptr_push(&args, intern_string(db, arg)) &&
+                 ptr_push(&args, intern_string(db, argv[++i]));
+        } else {
+            ok = ptr_push(&args, intern_string(db, arg));
+        }
+    }
+
+    if (ok && !cmd->output && output) {
+        cmd->output = intern_string(db, output);
+        ok = cmd->output != NULL;
+    }
+    if (ok) {
+        cmd->args = intern_list(db, &args);
+        cmd->arg_count = args.count;
+        cmd->includes = intern_list(db, &includes);
+        cmd->include_count = includes.count;
+        cmd->depfile_args = intern_list(db, &depfile);
+        cmd->depfile_arg_count = depfile.count;
+        ok = cmd->compiler && cmd->args && cmd->includes && cmd->depfile_args;
+    }
+
+    free(args.items);
+    free(includes.items);
+    free(depfile.items);
+    return ok;
+}
+
+/* ============================================================
+ * Entries
+ * ============================================================ */
+
+static const char* json_string(const cJSON* object, const char* key) {
+    const cJSON* item = cJSON_GetObjectItemCaseSensitive(object, key);
+    return cJSON_IsString(item) ? item->valuestring : NULL;
+}
+
+/**
+ * Add one database entry
+ * @return false if out of memory (malformed entries are skipped)
+ */
+static bool add_entry(CompileDatabase* db, const cJSON* object) {
+    const char* directory = json_string(object, "directory");
+    const char* file = json_string(object, "file");
+    const char* command = json_string(object, "command");
+    const cJSON* arguments = cJSON_GetObjectItemCaseSensitive(object, "arguments");
+
+    if (!file || (!cJSON_IsArray(arguments) && !command)) {
+        db->stats.skipped++;
+        return true;
+    }
+
+    /* Collect argv from "arguments", or split "command" */
+    int argc = cJSON_IsArray(arguments) ? cJSON_GetArraySize(arguments)
+                                        : (int)strlen(command) / 2 + 1;
+    char** argv = malloc(sizeof(char*) * (size_t)(argc > 0 ? argc : 1));
+    char* scratch = NULL;
+    if (!argv) return false;
+
+    if (cJSON_IsArray(arguments)) {
+        int n = 0;
+        const cJSON* item;
+        cJSON_ArrayForEach(item, arguments) {
+            if (cJSON_IsString(item)) argv[n++] = item->valuestring;
+        }
+        argc = n;
+    } else {
+        scratch = strdup(command);
+        if (!scratch) {
+            free(argv);
+            return false;
+        }
+        argc = split_command(scratch, argv, argc);
+    }
+
+    if (argc == 0) {
+        free(argv);
+        free(scratch);
+        db->stats.skipped++;
+        return true;
+    }
+
+    if (db->entry_count == db->entry_capacity) {
+        int capacity = db->entry_capacity ? db->entry_capacity * 2 : MIN_ENTRY_CAPACITY;
+        CompileCommand* entries = realloc(db->entries, sizeof(CompileCommand) * (size_t)capacity);
+        if (!entries) {
+            free(argv);
+            free(scratch);
+            return false;
+        }
+        db->entries = entries;
+        db->entry_capacity = capacity;
+    }
+
+    CompileCommand* cmd = &db->entries[db->entry_count];
+    memset(cmd, 0, sizeof(*cmd));
+    cmd->directory = intern_string(db, directory ? directory : ".");
+    cmd->file = intern_string(db, file);
+    const char* output = json_string(object, "output");
+    if (output) cmd->output = intern_string(db, output);
+
+    bool ok = cmd->directory && cmd->file && (!output || cmd->output) &&
+              classify_arguments(db, cmd, argv, argc);
+    if (ok) db->entry_count++;
+
+    free(argv);
+    free(scratch);
+    return ok;
+}
+
+/* ============================================================
+ * Streaming Reader
+ * ============================================================ */
+
+typedef struct {
+    FILE* file;
+    char* buf;
+    size_t len;                   /* Bytes in buf */
+    size_t cap;
+    size_t pos;                   /* Next unread byte */
+    size_t bytes_read;
+} JsonStream;
+
+/* Read more input, keeping bytes from keep onward; false at end of file */
+static bool stream_fill(JsonStream* s, size_t* keep) {
+    if (*keep > 0) {
+        memmove(s->buf, s->buf + *keep, s->len - *keep);
+        s->len -= *keep;
+        s->pos -= *keep;
+        *keep = 0;
+    }
+    if (s->len == s->cap) {
+        size_t cap = s->cap * 2;
+        char* buf = realloc(s->buf, cap);
+        if (!buf) return false;
+        s->buf = buf;
+        s->cap = cap;
+    }
+
+    size_t n = fread(s->buf + s->len, 1, s->cap - s->len, s->file);
+    s->len += n;
+    s->bytes_read += n;
+    return n > 0;
+}
+
+/* Next non-space byte, or -1 at end of file */
+static int stream_peek(JsonStream* s) {
+    size_t keep = s->pos;
+    for (;;) {
+        while (s->pos < s->len) {
+            char c = s->buf[s->pos];
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r') return (unsigned char)c;
+            s->pos++;
+        }
+        keep = s->pos;
+        if (!stream_fill(s, &keep)) return -1;
+    }
+}
+
+/**
+ * Find the extent of the object starting at s->pos
+ * @return true with the object at buf[*start, s->pos)
+ */
+static bool stream_object(JsonStream* s, size_t* start) {
+    *start = s->pos;
+    int depth = 0;
+    bool in_string = false, escaped = false;
+
+    for (;;) {
+        while (s->pos < s->len) {
+            char c = s->buf[s->pos++];
+            if (in_string) {
+                if (escaped) escaped = false;
+                else if (c == '\\') escaped = true;
+                else if (c == '"') in_string = false;
+            } else if (c == '"') {
+                in_string = true;
+            } else if (c == '{' || c == '[') {
+                depth++;
+            } else if ((c == '}' || c == ']') && --depth == 0) {
+                return true;
+            }
+        }
+        if (!stream_fill(s, start)) return false;
+    }
+}
+
+static bool read_database(CompileDatabase* db, JsonStream* s, const char* path) {
+    /* A UTF-8 byte order mark is allowed before the array */
+    if (stream_peek(s) == 0xEF && s->len - s->pos >= 3 &&
+        memcmp(s->buf + s->pos, "\xEF\xBB\xBF", 3) == 0) {
+        s->pos += 3;
+    }
+    if (stream_peek(s) != '[') {
+        log_error("%s: not a JSON array", path);
+        return false;
+    }
+    s->pos++;
+
+    for (;;) {
+        int c = stream_peek(s);
+        if (c == ',') {
+            s->pos++;
+            continue;
+        }
+        if (c == ']') return true;
+        if (c != '{') {
+            log_error("%s: malformed entry %d", path, db->entry_count + db->stats.skipped + 1);
+            return false;
+        }
+
+        size_t start;
+        if (!stream_object(s, &start)) {
+            log_error("%s: truncated entry %d", path, db->entry_count + db->stats.skipped + 1);
+            return false;
+        }
+
+        cJSON* object = cJSON_ParseWithLength(s->buf + start, s->pos - start);
+        if (!object) {
+            log_error("%s: malformed entry %d", path, db->entry_count + db->stats.skipped + 1);
+            return false;
+        }
+        bool ok = add_entry(db, object);
+        cJSON_Delete(object);
+        if (!ok) {
+            log_error("%s: out of memory", path);
+            return false;
+        }
+    }
+}
+
+/* ============================================================
+ * Database API
+ * ============================================================ */
+
+CompileDatabase* compile_db_load(const char* path) {
+    if (!path) return NULL;
+
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        log_error("Cannot open compilation database: %s", path);
+        return NULL;
+    }
+
+    CompileDatabase* db = calloc(1, sizeof(CompileDatabase));
+    JsonStream stream = {0};
+    stream.file = file;
+    stream.cap = READ_CHUNK_SIZE;
+    stream.buf = malloc(stream.cap);
+
+    bool ok = db && stream.buf && table_init(&db->strings) && table_init(&db->lists) &&
+              read_database(db, &stream, path);
+
+    fclose(file);
+    free(stream.buf);
+    if (!ok) {
+        compile_db_free(db);
+        return NULL;
+    }
+
+    db->stats.entries = db->entry_count;
+    db->stats.unique_strings = db->strings.count;
+    db->stats.unique_lists = db->lists.count;
+    db->stats.bytes_read = stream.bytes_read;
+    log_debug("Loaded %d compile commands from %s (%zu strings, %zu lists)",
+              db->entry_count, path, db->stats.unique_strings, db->stats.unique_lists);
+    return db;
+}
+
+void compile_db_free(CompileDatabase* db) {
+    if (!db) return;
+    table_free(&db->strings);
+    table_free(&db->lists);
+    free(db->entries);
+    free(db);
+}
+
+int compile_db_count(const CompileDatabase* db) {
+    return db ? db->entry_count : 0;
+}
+
+const CompileCommand* compile_db_get(const CompileDatabase* db, int index) {
+    if (!db || index < 0 || index >= db->entry_count) return NULL;
+    return &db->entries[index];
+}
+
+CompileDbStats compile_db_get_stats(const CompileDatabase* db) {
+    if (!db) {
+        CompileDbStats empty = {0};
+        return empty;
+    }
+    return db->stats;
+}
+
+/* ============================================================
+ * Consumers
+ * ============================================================ */
+
+static char** dup_strings(const char* const* items, int count) {
+    char** copy = malloc(sizeof(char*) * (size_t)(count + 1));
+    if (!copy) return NULL;
+    for (int i = 0; i < count; i++) {
+        copy[i] = strdup(items[i]);
+        if (!copy[i]) {
+            while (i-- > 0) free(copy[i]);
+            free(copy);
+            return NULL;
+        }
+    }
+    copy[count] = NULL;
+    return copy;
+}
+
+DistributedJob* compile_db_make_job(const CompileCommand* cmd) {
+    if (!cmd) return NULL;
+
+    DistributedJob* job = calloc(1, sizeof(DistributedJob));
+    if (!job) return NULL;
+
+    job->type = JOB_TYPE_COMPILE;
+    job->source_file = strdup(cmd->file);
+    job->output_file = cmd->output ? strdup(cmd->output) : NULL;
+    job->compiler = strdup(cmd->compiler);
+    job->working_dir = strdup(cmd->directory);
+
+    job->compiler_args = dup_strings(cmd->args, cmd->arg_count);
+    job->arg_count = job->compiler_args ? (size_t)cmd->arg_count : 0;
+
+    job->include_paths = dup_strings(cmd->includes, cmd->include_count);
+    job->include_count = job->include_paths ? (size_t)cmd->include_count : 0;
+
+    if (!job->source_file || !job->compiler || !job->working_dir ||
+        (cmd->output && !job->output_file) ||
+        !job->compiler_args || !job->include_paths) {
+        distributed_job_free(job);
+        return NULL;
+    }
+    return job;
+}
+
+int compile_db_decompose(const CompileDatabase* db,
+                         DistributedJob** out_jobs,
+                         int max_jobs) {
+    if (!db || !out_jobs) return 0;
+
+    int created = 0;
+    for (int i = 0; i < db->entry_count && created < max_jobs; i++) {
+        DistributedJob* job = compile_db_make_job(&db->entries[i]);
+        if (!job) break;
+        out_jobs[created++] = job;
+    }
+    return created;
+}
+
+char* compile_db_cache_key(const CompileCommand* cmd) {
+    if (!cmd) return NULL;
+
+    /* Key on the source's content, which is what the object depends on */
+    char* source = NULL;
+    if (cmd->file[0] == '/' || cmd->file[0] == '\\' ||
+        (cmd->file[0] && cmd->file[1] == ':')) {
+        source = strdup(cmd->file);
+    } else {
+        size_t len = strlen(cmd->directory) + strlen(cmd->file) + 2;
+        source = malloc(len);
+        if (source) snprintf(source, len, "%s/%s", cmd->directory, cmd->file);
+    }
+    char* content = source ? artifact_hash_file(source) : NULL;
+    free(source);
+
+    CacheKeyInput input = {0};
+    input.source_file = cmd->file;
+    input.source_content = content;
+    input.source_size = content ? strlen(content) : 0;
+    input.compiler = cmd->compiler;
+    input.compiler_flags = (const char**)cmd->args;
+    input.flag_count = cmd->arg_count;
+    input.include_paths = (const char**)cmd->includes;
+    input.include_count = cmd->include_count;
+
+    char* key = artifact_cache_generate_key(&input);
+    free(content);
+    return key;
+}
+
+/* Characters that never need quoting in a shell word */
+static bool shell_safe(const char* s) {
+    if (!*s) return false;
+    for (; *s; s++) {
+        char c = *s;
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+              strchr("_-+=/.,:@%", c))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Append a word, quoted if needed; *len tracks the used length */
+static bool append_word(char** buf, size_t* len, size_t* cap, const char* prefix,
+                        const char* word) {
+    size_t need = *len + strlen(prefix) + strlen(word) * 4 + 4;
+    if (need > *cap) {
+        size_t grown = *cap * 2 > need ? *cap * 2 : need;
+        char* bigger = realloc(*buf, grown);
+        if (!bigger) return false;
+        *buf = bigger;
+        *cap = grown;
+    }
+
+    char* out = *buf + *len;
+    if (*len > 0) *out++ = ' ';
+    out += sprintf(out, "%s", prefix);
+
+    if (shell_safe(word)) {
+        out += sprintf(out, "%s", word);
+    } else {
+#ifdef _WIN32
+        *out++ = '"';
+        for (const char* p = word; *p; p++) {
+            if (*p == '"') *out++ = '\\';
+            *out++ = *p;
+        }
+        *out++ = '"';
+#else
+        *out++ = '\'';
+        for (const char* p = word; *p; p++) {
+            if (*p == '\'') {
+                memcpy(out, "'\\''", 4);
+                out += 4;
+            } else {
+                *out++ = *p;
+            }
+        }
+        *out++ = '\'';
+#endif
+    }
+    *out = '\0';
+    *len = (size_t)(out - *buf);
+    return true;
+}
+
+char* compile_db_command_line(const CompileCommand* cmd) {
+    if (!cmd) return NULL;
+
+    size_t len = 0, cap = 256;
+    char* line = malloc(cap);
+    if (!line) return NULL;
+    line[0] = '\0';
+
+    bool ok = append_word(&line, &len, &cap, "", cmd->compiler);
+    for (int i = 0; ok && i < cmd->arg_count; i++) {
+        ok = append_word(&line, &len, &cap, "", cmd->args[i]);
+    }
+    for (int i = 0; ok && i < cmd->include_count; i++) {
+        ok = append_word(&line, &len, &cap, "-I", cmd->includes[i]);
+    }
+    for (int i = 0; ok && i < cmd->depfile_arg_count; i++) {
+        ok = append_word(&line, &len, &cap, "", cmd->depfile_args[i]);
+    }
+    ok = ok && append_word(&line, &len, &cap, "", "-c");
+    if (ok && cmd->output) {
+        ok = append_word(&line, &len, &cap, "", "-o") &&
+             append_word(&line, &len, &cap, "", cmd->output);
+    }
+    ok = ok && append_word(&line, &len, &cap, "", cmd->file);
+
+    if (!ok) {
+        free(line);
+        return NULL;
+    }
+    return line;
+}
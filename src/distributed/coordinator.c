@@ -7,8 +7,11 @@
  */
 
 #include "cyxmake/distributed/distributed.h"
+#include "cyxmake/file_ops.h"
 #include "cyxmake/logger.h"
 
+#include <cJSON.h>
+#include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -36,6 +39,25 @@
 #define DEFAULT_HEARTBEAT_SEC 30
 #define DEFAULT_JOB_TIMEOUT_SEC 600
 #define DEFAULT_CONN_TIMEOUT_SEC 10
+#define DEFAULT_TRANSFER_DIR ".cyxmake/incoming"
+#define DEFAULT_HISTORY_PATH ".cyxmake/job-history"
+#define DEFAULT_MAX_BATCH_SIZE 16
+#define TRANSFER_IDLE_TIMEOUT_SEC 300
+#define TRANSFER_EXPIRE_CHECK_SEC 60
+#define TIMER_TICK_MS 100
+#define TIMER_SLOTS 512
+#define EVENT_MAX_WAIT_MS 1000
+#define STRAGGLER_CHECK_MS 1000
+
+/* ============================================================
+ * Outgoing File Transfers
+ * ============================================================ */
+
+typedef struct OutgoingTransfer {
+    FileTransferSender* sender;
+    NetworkConnection* connection;
+    struct OutgoingTransfer* next;
+} OutgoingTransfer;
 
 /* ============================================================
  * Coordinator Structure
@@ -51,6 +73,10 @@ struct Coordinator {
     AuthContext* auth;
     ArtifactCache* cache;
 
+    /* File transfers */
+    FileTransferReceiver* transfers_in;
+    OutgoingTransfer* transfers_out;
+
     /* State */
     volatile bool running;
     time_t started_at;
@@ -58,9 +84,21 @@ struct Coordinator {
     /* Callbacks */
     CoordinatorCallbacks callbacks;
 
+    /* Heartbeat checks, transfer expiry and job deadlines */
+    TimerWheel* timers;
+    TimerId heartbeat_timer;
+    TimerId transfer_timer;
+    TimerId straggler_timer;
+
 #ifdef CYXMAKE_ENABLE_DISTRIBUTED
     MutexHandle mutex;
-    ThreadHandle heartbeat_thread;
+
+    /* Event loop: woken by dispatch requests or the next timer */
+    ThreadHandle event_thread;
+    bool event_thread_started;
+    MutexHandle event_mutex;
+    ConditionHandle event_cond;
+    bool dispatch_pending;
 #endif
 };
 
@@ -75,10 +113,15 @@ DistributedCoordinatorConfig distributed_coordinator_config_default(void) {
         .enable_tls = false,
         .cert_path = NULL,
         .key_path = NULL,
+        .json_frames = false,
         .auth_method = AUTH_METHOD_TOKEN,
         .auth_token = NULL,
         .default_strategy = DIST_STRATEGY_COMPILE_UNITS,
-        .lb_algorithm = LB_LEAST_LOADED,
+        .lb_algorithm = LB_CRITICAL_PATH,
+        .history_path = NULL,
+        .trace_path = NULL,
+        .max_batch_size = DEFAULT_MAX_BATCH_SIZE,
+        .speculative_execution = false,
         .max_workers = DEFAULT_MAX_WORKERS,
         .max_concurrent_builds = DEFAULT_MAX_BUILDS,
         .max_pending_jobs = DEFAULT_MAX_PENDING,
@@ -88,6 +131,8 @@ DistributedCoordinatorConfig distributed_coordinator_config_default(void) {
         .enable_cache = true,
         .cache_dir = NULL,
         .cache_max_size = 10ULL * 1024 * 1024 * 1024,  /* 10GB */
+        .transfer_dir = NULL,
+        .transfer = file_transfer_config_default(),
         .log_file = NULL,
         .log_level = 0
     };
@@ -100,10 +145,290 @@ void distributed_coordinator_config_free(DistributedCoordinatorConfig* config) {
     free(config->cert_path);
     free(config->key_path);
     free(config->auth_token);
+    free(config->history_path);
+    free(config->trace_path);
     free(config->cache_dir);
+    free(config->transfer_dir);
     free(config->log_file);
 }
 
+/* ============================================================
+ * File Transfer Helpers
+ * ============================================================ */
+
+static void coord_lock(Coordinator* coord) {
+#ifdef CYXMAKE_ENABLE_DISTRIBUTED
+    mutex_lock(&coord->mutex);
+#else
+    (void)coord;
+#endif
+}
+
+static void coord_unlock(Coordinator* coord) {
+#ifdef CYXMAKE_ENABLE_DISTRIBUTED
+    mutex_unlock(&coord->mutex);
+#else
+    (void)coord;
+#endif
+}
+
+/* Wake the event loop to run the scheduler; safe under the scheduler lock */
+static void request_dispatch(Coordinator* coord) {
+#ifdef CYXMAKE_ENABLE_DISTRIBUTED
+    mutex_lock(&coord->event_mutex);
+    coord->dispatch_pending = true;
+    condition_signal(&coord->event_cond);
+    mutex_unlock(&coord->event_mutex);
+#else
+    (void)coord;
+#endif
+}
+
+/* Send as many messages as the transfer window allows (caller holds lock) */
+static void pump_transfer(Coordinator* coord, OutgoingTransfer* out) {
+    ProtocolMessage* msg;
+    while ((msg = file_transfer_sender_next(out->sender)) != NULL) {
+        bool sent = network_server_send(coord->server, out->connection, msg);
+        protocol_message_free(msg);
+        if (!sent) {
+            /* The next pump resends this message instead of skipping it */
+            file_transfer_sender_rewind(out->sender);
+            break;
+        }
+    }
+}
+
+static void remove_transfer(Coordinator* coord, OutgoingTransfer* target) {
+    OutgoingTransfer** pp = &coord->transfers_out;
+    while (*pp) {
+        if (*pp == target) {
+            *pp = target->next;
+            file_transfer_sender_free(target->sender);
+            free(target);
+            return;
+        }
+        pp = &(*pp)->next;
+    }
+}
+
+/*
+ * Transfer IDs are only unique per endpoint, so an ACK applies to the
+ * transfers sent over the connection it arrived on.
+ */
+static void handle_transfer_ack(Coordinator* coord, NetworkConnection* conn,
+                                const ProtocolMessage* msg) {
+    coord_lock(coord);
+
+    OutgoingTransfer* out = coord->transfers_out;
+    while (out) {
+        OutgoingTransfer* next = out->next;
+        if (out->connection != conn) {
+            out = next;
+            continue;
+        }
+        file_transfer_sender_handle_ack(out->sender, msg);
+
+        FileTransferState state = file_transfer_sender_get_state(out->sender);
+        if (state == FILE_TRANSFER_COMPLETE || state == FILE_TRANSFER_FAILED) {
+            log_info("File transfer %s %s",
+                     file_transfer_sender_get_id(out->sender),
+                     file_transfer_state_name(state));
+            remove_transfer(coord, out);
+        } else {
+            pump_transfer(coord, out);
+        }
+        out = next;
+    }
+
+    coord_unlock(coord);
+}
+
+static bool is_content_hash(const char* name) {
+    size_t len = 0;
+    for (; name[len]; len++) {
+        if (!isxdigit((unsigned char)name[len])) return false;
+    }
+    return len == 64;
+}
+
+/* Worker outputs arrive named by content hash; file them in the cache */
+static void on_file_received(const char* transfer_id, const char* path,
+                             uint64_t size, void* user_data) {
+    Coordinator* coord = (Coordinator*)user_data;
+    (void)transfer_id;
+    (void)size;
+
+    const char* name = path;
+    for (const char* p = path; *p; p++) {
+        if (*p == '/' || *p == '\\') name = p + 1;
+    }
+    if (!coord->cache || !is_content_hash(name)) return;
+
+    if (artifact_cache_contains(coord->cache, name) ||
+        artifact_cache_store(coord->cache, name, path, ARTIFACT_OTHER, NULL)) {
+        file_delete(path);
+    }
+}
+
+static void handle_transfer_data(Coordinator* coord,
+                                 NetworkConnection* conn,
+                                 const ProtocolMessage* msg) {
+    coord_lock(coord);
+
+    if (!coord->transfers_in) {
+        const char* dir = coord->config.transfer_dir ?
+                          coord->config.transfer_dir : DEFAULT_TRANSFER_DIR;
+        coord->transfers_in = file_transfer_receiver_create(dir, &coord->config.transfer);
+        file_transfer_receiver_set_callback(coord->transfers_in, on_file_received, coord);
+    }
+
+    ProtocolMessage* reply = NULL;
+    if (coord->transfers_in) {
+        file_transfer_receiver_handle(coord->transfers_in, msg, &reply);
+    }
+
+    coord_unlock(coord);
+
+    if (reply) {
+        network_server_send(coord->server, conn, reply);
+        protocol_message_free(reply);
+    }
+}
+
+/* Drop transfers bound to a closed connection; a resend resumes by offset */
+static void drop_connection_transfers(Coordinator* coord, NetworkConnection* conn) {
+    coord_lock(coord);
+
+    OutgoingTransfer* out = coord->transfers_out;
+    while (out) {
+        OutgoingTransfer* next = out->next;
+        if (out->connection == conn) {
+            log_info("File transfer %s interrupted at %llu bytes",
+                     file_transfer_sender_get_id(out->sender),
+                     (unsigned long long)file_transfer_sender_get_acked(out->sender));
+            remove_transfer(coord, out);
+        }
+        out = next;
+    }
+
+    coord_unlock(coord);
+}
+
+/* ============================================================
+ * Worker Messages
+ * ============================================================ */
+
+static bool worker_token_valid(Coordinator* coord, const char* token,
+                               NetworkConnection* conn) {
+    /* A pre-shared token is not registered with the auth context */
+    if (auth_secure_equals(coord->config.auth_token, token)) return true;
+    return coord->auth &&
+           auth_token_validate(coord->auth, token,
+                               network_connection_get_remote_addr(conn)) == AUTH_RESULT_SUCCESS;
+}
+
+/* Apply the name, capabilities and slot count from a HELLO payload */
+static void apply_worker_profile(Coordinator* coord, RemoteWorker* worker,
+                                 const cJSON* hello) {
+    const cJSON* name = cJSON_GetObjectItem(hello, "name");
+    const cJSON* max_jobs = cJSON_GetObjectItem(hello, "max_jobs");
+    const cJSON* caps = cJSON_GetObjectItem(hello, "capabilities");
+
+    const char* cap_names[32];
+    int cap_count = 0;
+    const cJSON* cap;
+    cJSON_ArrayForEach(cap, caps) {
+        if (cJSON_IsString(cap) && cap_count < 32) {
+            cap_names[cap_count++] = cap->valuestring;
+        }
+    }
+
+    worker_registry_set_profile(coord->registry, worker,
+                                cJSON_IsString(name) ? name->valuestring : NULL,
+                                worker_capabilities_parse(cap_names, cap_count),
+                                cJSON_IsNumber(max_jobs) ? max_jobs->valueint : 0);
+}
+
+/*
+ * Copy a job's output from the cache to the path the build expects. The
+ * path comes from the job as scheduled; the worker only names the content.
+ */
+static bool materialize_artifacts(Coordinator* coord, const char* worker_id,
+                                  const char* job_id, const DistributedJobResult* result) {
+    if (!coord->cache || result->artifact_count == 0) return true;
+
+    const char* hash = result->artifact_hashes ? result->artifact_hashes[0] : NULL;
+    if (!hash || !is_content_hash(hash)) {
+        log_warning("Job %s reported an invalid output hash", job_id);
+        return false;
+    }
+
+    char* path = scheduler_get_job_output(coord->scheduler, worker_id, job_id);
+    if (!path) return true;
+
+    char* dir = strdup(path);
+    char* sep = dir ? strrchr(dir, '/') : NULL;
+#ifdef _WIN32
+    char* bsep = dir ? strrchr(dir, '\\') : NULL;
+    if (bsep > sep) sep = bsep;
+#endif
+    if (sep && sep != dir) {
+        *sep = '\0';
+        dir_create(dir);
+    }
+    free(dir);
+
+    bool ok = artifact_cache_retrieve(coord->cache, hash, path);
+    if (!ok) {
+        log_warning("Output %s was not received from worker", path);
+    }
+    free(path);
+    return ok;
+}
+
+/* Reporting worker's ID, so the scheduler can tell speculative copies apart */
+static const char* connection_worker_id(Coordinator* coord, NetworkConnection* conn) {
+    RemoteWorker* worker = worker_registry_find_by_connection(coord->registry, conn);
+    return worker ? worker->id : NULL;
+}
+
+/* Job and transfer messages are only taken from registered workers */
+static const char* require_worker(Coordinator* coord, NetworkConnection* conn,
+                                  const ProtocolMessage* msg) {
+    const char* worker_id = connection_worker_id(coord, conn);
+    if (!worker_id) {
+        const char* addr = network_connection_get_remote_addr(conn);
+        log_warning("Ignoring %s from unregistered connection %s",
+                    protocol_message_type_name(msg->type), addr ? addr : "unknown");
+    }
+    return worker_id;
+}
+
+static void handle_job_result(Coordinator* coord, NetworkConnection* conn,
+                              const ProtocolMessage* msg) {
+    if (!msg->correlation_id) return;
+
+    const char* worker_id = require_worker(coord, conn, msg);
+    if (!worker_id) return;
+
+    DistributedJobResult* result = msg->payload_json ?
+        distributed_job_result_from_json(msg->payload_json) : NULL;
+    if (!result) {
+        scheduler_report_worker_failure(coord->scheduler, worker_id, msg->correlation_id,
+                                         "Malformed job result");
+        return;
+    }
+
+    if (msg->type == PROTO_MSG_JOB_FAILED) {
+        result->success = false;
+    } else if (!materialize_artifacts(coord, worker_id, msg->correlation_id, result)) {
+        result->success = false;
+    }
+
+    scheduler_report_worker_result(coord->scheduler, worker_id, msg->correlation_id, result);
+    distributed_job_result_free(result);
+}
+
 /* ============================================================
  * Network Callbacks
  * ============================================================ */
@@ -124,6 +449,8 @@ static void on_client_disconnect(NetworkConnection* conn,
     Coordinator* coord = (Coordinator*)user_data;
     if (!coord) return;
 
+    drop_connection_transfers(coord, conn);
+
     /* Find and unregister worker */
     RemoteWorker* worker = worker_registry_find_by_connection(
         coord->registry, conn);
@@ -158,24 +485,52 @@ static void on_client_message(NetworkConnection* conn,
             /* Worker registration */
             log_debug("Received HELLO from worker");
 
+            cJSON* hello = msg->payload_json ? cJSON_Parse(msg->payload_json) : NULL;
+
             /* Validate auth if enabled */
             if (coord->config.auth_method != AUTH_METHOD_NONE &&
                 coord->config.auth_token) {
-                /* Extract token from payload and validate */
-                /* TODO: Parse payload JSON for token */
+                cJSON* token = cJSON_GetObjectItem(hello, "auth_token");
+                if (!cJSON_IsString(token) ||
+                    !worker_token_valid(coord, token->valuestring, conn)) {
+                    const char* addr = network_connection_get_remote_addr(conn);
+                    log_warning("Worker from %s failed authentication",
+                                addr ? addr : "unknown");
+                    ProtocolMessage* denied = protocol_message_create_response(
+                        msg, PROTO_MSG_AUTH_FAILED);
+                    if (denied) {
+                        network_server_send(coord->server, conn, denied);
+                        protocol_message_free(denied);
+                    }
+                    cJSON_Delete(hello);
+                    break;
+                }
             }
 
             /* Parse worker info from payload */
-            WorkerSystemInfo info = {0};
-            /* TODO: Parse JSON payload for system info */
+            WorkerSystemInfo* info = msg->payload_json ?
+                worker_system_info_from_json(msg->payload_json) : NULL;
 
             RemoteWorker* worker = worker_registry_register(
-                coord->registry, &info, conn);
+                coord->registry, info, conn);
+            worker_system_info_free(info);
 
             if (worker) {
+                if (hello) {
+                    apply_worker_profile(coord, worker, hello);
+                }
+
                 /* Send WELCOME response */
-                ProtocolMessage* welcome = protocol_message_create(PROTO_MSG_WELCOME);
+                ProtocolMessage* welcome = protocol_message_create_response(
+                    msg, PROTO_MSG_WELCOME);
                 if (welcome) {
+                    cJSON* payload = cJSON_CreateObject();
+                    cJSON_AddStringToObject(payload, "worker_id", worker->id);
+                    char* json = cJSON_PrintUnformatted(payload);
+                    protocol_message_set_payload(welcome, json);
+                    free(json);
+                    cJSON_Delete(payload);
+
                     network_server_send(coord->server, conn, welcome);
                     protocol_message_free(welcome);
                 }
@@ -186,16 +541,24 @@ static void on_client_message(NetworkConnection* conn,
                                                           coord->callbacks.user_data);
                 }
 
-                log_info("Worker registered: %s", worker->id);
+                log_info("Worker registered: %s (%s, %d slots)", worker->id,
+                         worker->name ? worker->name : "unnamed", worker->max_jobs);
+
+                /* New slots may unblock queued jobs */
+                request_dispatch(coord);
             } else {
                 /* Send error */
                 ProtocolMessage* error = protocol_message_create(PROTO_MSG_ERROR);
                 if (error) {
                     error->payload_json = strdup("Registration failed");
+                    if (error->payload_json) {
+                        error->payload_size = strlen(error->payload_json);
+                    }
                     network_server_send(coord->server, conn, error);
                     protocol_message_free(error);
                 }
             }
+            cJSON_Delete(hello);
             break;
         }
 
@@ -216,34 +579,54 @@ static void on_client_message(NetworkConnection* conn,
             if (worker) {
                 /* TODO: Parse status from payload */
                 worker_registry_update_health(coord->registry, worker);
+                request_dispatch(coord);
+            }
+            break;
+        }
+
+        case PROTO_MSG_JOB_ACCEPT:
+            if (msg->correlation_id && require_worker(coord, conn, msg)) {
+                scheduler_report_job_started(coord->scheduler, msg->correlation_id);
+            }
+            break;
+
+        case PROTO_MSG_JOB_REJECT: {
+            const char* worker_id = msg->correlation_id ?
+                                    require_worker(coord, conn, msg) : NULL;
+            if (worker_id) {
+                log_debug("Job %s rejected by worker", msg->correlation_id);
+                scheduler_report_worker_failure(coord->scheduler, worker_id,
+                                                 msg->correlation_id, "Rejected by worker");
             }
             break;
         }
 
         case PROTO_MSG_JOB_PROGRESS: {
             /* Job progress update */
-            /* TODO: Update job progress */
+            cJSON* payload = msg->payload_json ? cJSON_Parse(msg->payload_json) : NULL;
+            cJSON* phase = cJSON_GetObjectItem(payload, "phase");
+            cJSON* percent = cJSON_GetObjectItem(payload, "percent");
+            log_debug("Job %s: %s (%d%%)",
+                      msg->correlation_id ? msg->correlation_id : "?",
+                      cJSON_IsString(phase) ? phase->valuestring : "running",
+                      cJSON_IsNumber(percent) ? percent->valueint : 0);
+            cJSON_Delete(payload);
             break;
         }
 
-        case PROTO_MSG_JOB_COMPLETE: {
-            /* Job completed */
-            DistributedJobResult* result = NULL;
-            /* TODO: Parse result from payload */
-
-            if (msg->correlation_id) {
-                scheduler_report_job_result(coord->scheduler,
-                                            msg->correlation_id, result);
-            }
+        case PROTO_MSG_JOB_COMPLETE:
+        case PROTO_MSG_JOB_FAILED:
+            handle_job_result(coord, conn, msg);
             break;
-        }
 
-        case PROTO_MSG_JOB_FAILED: {
-            /* Job failed */
-            if (msg->correlation_id) {
-                scheduler_report_job_failure(coord->scheduler,
-                                              msg->correlation_id,
-                                              msg->payload_json);
+        case PROTO_MSG_JOB_CANCELLED: {
+            /* The revoked copy has stopped, so its slot is free */
+            const char* worker_id = msg->correlation_id ?
+                                    require_worker(coord, conn, msg) : NULL;
+            if (worker_id) {
+                log_debug("Job %s cancelled on worker", msg->correlation_id);
+                scheduler_report_copy_released(coord->scheduler, worker_id,
+                                               msg->correlation_id);
             }
             break;
         }
@@ -260,6 +643,18 @@ static void on_client_message(NetworkConnection* conn,
             break;
         }
 
+        case PROTO_MSG_FILE_TRANSFER_START:
+        case PROTO_MSG_FILE_CHUNK:
+        case PROTO_MSG_FILE_TRANSFER_END:
+            if (require_worker(coord, conn, msg)) {
+                handle_transfer_data(coord, conn, msg);
+            }
+            break;
+
+        case PROTO_MSG_FILE_TRANSFER_ACK:
+            handle_transfer_ack(coord, conn, msg);
+            break;
+
         default:
             log_warning("Unknown message type: %d", msg->type);
             break;
@@ -279,10 +674,113 @@ static void on_client_error(NetworkConnection* conn,
     }
 }
 
+static void on_client_backpressure(NetworkConnection* conn,
+                                   bool congested,
+                                   void* user_data) {
+    Coordinator* coord = (Coordinator*)user_data;
+    if (!coord) return;
+
+    RemoteWorker* worker = worker_registry_find_by_connection(coord->registry, conn);
+    if (!worker) return;
+
+    worker_registry_set_congested(coord->registry, worker, congested);
+
+    if (congested) {
+        log_debug("Worker %s send queue congested, pausing assignments", worker->id);
+    } else {
+        log_debug("Worker %s send queue drained", worker->id);
+        /* Hand it the work it missed while congested */
+        request_dispatch(coord);
+    }
+}
+
+/* ============================================================
+ * Timers
+ * ============================================================ */
+
+typedef struct {
+    Coordinator* coord;
+    char job_id[];
+} JobTimer;
+
+static void on_job_deadline(void* user_data) {
+    JobTimer* timer = (JobTimer*)user_data;
+    scheduler_check_job_timeout(timer->coord->scheduler, timer->job_id);
+}
+
+/* Arm the job's deadline timer, replacing one left from an earlier attempt */
+static void arm_job_timer(Coordinator* coord, ScheduledJob* job) {
+    if (job->timeout_timer) {
+        timer_wheel_cancel(coord->timers, job->timeout_timer);
+        job->timeout_timer = 0;
+    }
+    if (job->timeout_sec <= 0) return;
+
+    size_t id_len = strlen(job->job_id) + 1;
+    JobTimer* timer = malloc(sizeof(JobTimer) + id_len);
+    if (!timer) return;
+    timer->coord = coord;
+    memcpy(timer->job_id, job->job_id, id_len);
+
+    job->timeout_timer = timer_wheel_schedule(coord->timers,
+                                              (unsigned int)job->timeout_sec * 1000, 0,
+                                              on_job_deadline, timer, free);
+    if (!job->timeout_timer) {
+        free(timer);
+        log_warning("Failed to arm timeout for job %s", job->job_id);
+    }
+}
+
+static void disarm_job_timer(Coordinator* coord, ScheduledJob* job) {
+    if (job->timeout_timer) {
+        timer_wheel_cancel(coord->timers, job->timeout_timer);
+        job->timeout_timer = 0;
+    }
+}
+
+static void on_heartbeat_timer(void* user_data) {
+    Coordinator* coord = (Coordinator*)user_data;
+
+    worker_registry_check_heartbeats(coord->registry);
+
+    /* Backstop for capacity changes that raise no event */
+    request_dispatch(coord);
+}
+
+static void on_straggler_timer(void* user_data) {
+    Coordinator* coord = (Coordinator*)user_data;
+
+    /* Queued work gets free slots before duplicates do */
+    scheduler_process_queue(coord->scheduler);
+    scheduler_speculate_stragglers(coord->scheduler);
+}
+
+static void on_transfer_expire_timer(void* user_data) {
+    Coordinator* coord = (Coordinator*)user_data;
+
+    /* Release file handles of stalled incoming transfers */
+    coord_lock(coord);
+    file_transfer_receiver_expire(coord->transfers_in, TRANSFER_IDLE_TIMEOUT_SEC);
+    coord_unlock(coord);
+}
+
 /* ============================================================
  * Scheduler Callbacks
  * ============================================================ */
 
+/* Arm the deadline and notify the owner once a job is on its way */
+static void job_dispatched(Coordinator* coord, ScheduledJob* job, RemoteWorker* worker) {
+    arm_job_timer(coord, job);
+
+    /* Callback */
+    if (coord->callbacks.on_job_assigned) {
+        coord->callbacks.on_job_assigned(coord, job, worker,
+                                          coord->callbacks.user_data);
+    }
+
+    log_debug("Job %s assigned to worker %s", job->job_id, worker->id);
+}
+
 static void on_job_assigned(WorkScheduler* scheduler,
                              ScheduledJob* job,
                              RemoteWorker* worker,
@@ -312,13 +810,97 @@ static void on_job_assigned(WorkScheduler* scheduler,
         protocol_message_free(msg);
     }
 
-    /* Callback */
-    if (coord->callbacks.on_job_assigned) {
-        coord->callbacks.on_job_assigned(coord, job, worker,
-                                          coord->callbacks.user_data);
+    job_dispatched(coord, job, worker);
+}
+
+static void on_batch_assigned(WorkScheduler* scheduler,
+                               ScheduledJob** jobs,
+                               int count,
+                               RemoteWorker* worker,
+                               void* user_data) {
+    Coordinator* coord = (Coordinator*)user_data;
+    if (!coord || !jobs || !worker) return;
+
+    (void)scheduler;
+
+    /* One request carrying every job; each keeps its scheduler job ID */
+    cJSON* payload = cJSON_CreateObject();
+    cJSON* list = payload ? cJSON_AddArrayToObject(payload, "jobs") : NULL;
+    for (int i = 0; list && i < count; i++) {
+        char* json = jobs[i]->spec ? distributed_job_to_json(jobs[i]->spec) : NULL;
+        cJSON* item = json ? cJSON_Parse(json) : cJSON_CreateObject();
+        free(json);
+        if (!item) continue;
+
+        cJSON_DeleteItemFromObject(item, "job_id");
+        cJSON_AddStringToObject(item, "job_id", jobs[i]->job_id);
+        cJSON_AddItemToArray(list, item);
     }
 
-    log_debug("Job %s assigned to worker %s", job->job_id, worker->id);
+    ProtocolMessage* msg = protocol_message_create(PROTO_MSG_JOB_BATCH);
+    char* json = list ? cJSON_PrintUnformatted(payload) : NULL;
+    cJSON_Delete(payload);
+    if (msg && json) {
+        protocol_message_set_payload(msg, json);
+        if (worker->connection) {
+            network_server_send(coord->server, worker->connection, msg);
+        }
+    }
+    free(json);
+    protocol_message_free(msg);
+
+    /* Jobs lost to a failed send come back through their deadline timers */
+    for (int i = 0; i < count; i++) {
+        job_dispatched(coord, jobs[i], worker);
+    }
+
+    log_debug("Sent batch of %d jobs to worker %s", count, worker->id);
+}
+
+static void on_job_completed(WorkScheduler* scheduler,
+                              ScheduledJob* job,
+                              DistributedJobResult* result,
+                              void* user_data) {
+    (void)scheduler;
+    (void)result;
+    disarm_job_timer((Coordinator*)user_data, job);
+}
+
+static void on_job_failed(WorkScheduler* scheduler,
+                           ScheduledJob* job,
+                           const char* error,
+                           void* user_data) {
+    (void)scheduler;
+    (void)error;
+    disarm_job_timer((Coordinator*)user_data, job);
+}
+
+static void on_job_revoked(WorkScheduler* scheduler,
+                            ScheduledJob* job,
+                            const char* worker_id,
+                            void* user_data) {
+    Coordinator* coord = (Coordinator*)user_data;
+    if (!coord || !job || !worker_id) return;
+
+    (void)scheduler;
+
+    RemoteWorker* worker = worker_registry_find_by_id(coord->registry, worker_id);
+    if (!worker || !worker->connection) return;
+
+    /* The worker drops its result and frees the slot once the process exits */
+    ProtocolMessage* msg = protocol_message_create(PROTO_MSG_JOB_CANCEL);
+    if (msg) {
+        msg->correlation_id = strdup(job->job_id);
+        network_server_send(coord->server, worker->connection, msg);
+        protocol_message_free(msg);
+    }
+
+    log_debug("Revoked copy of job %s on worker %s", job->job_id, worker_id);
+}
+
+static void on_dispatch_needed(WorkScheduler* scheduler, void* user_data) {
+    (void)scheduler;
+    request_dispatch((Coordinator*)user_data);
 }
 
 static void on_build_completed(WorkScheduler* scheduler,
@@ -339,30 +921,44 @@ static void on_build_completed(WorkScheduler* scheduler,
 }
 
 /* ============================================================
- * Heartbeat Thread
+ * Event Loop
  * ============================================================ */
 
 #ifdef CYXMAKE_ENABLE_DISTRIBUTED
 #ifdef CYXMAKE_WINDOWS
-static DWORD WINAPI heartbeat_thread_func(LPVOID arg) {
+static DWORD WINAPI event_thread_func(LPVOID arg) {
 #else
-static void* heartbeat_thread_func(void* arg) {
+static void* event_thread_func(void* arg) {
 #endif
     Coordinator* coord = (Coordinator*)arg;
 
+    mutex_lock(&coord->event_mutex);
     while (coord->running) {
-        /* Check worker heartbeats */
-        worker_registry_check_heartbeats(coord->registry);
+        if (!coord->dispatch_pending) {
+            int64_t delay = timer_wheel_next_delay_ms(coord->timers, timer_wheel_now_ms());
+            if (delay < 0 || delay > EVENT_MAX_WAIT_MS) {
+                delay = EVENT_MAX_WAIT_MS;
+            }
+            if (delay > 0) {
+                condition_timedwait(&coord->event_cond, &coord->event_mutex,
+                                    (unsigned int)delay);
+            }
+        }
 
-        /* Check job timeouts */
-        scheduler_check_timeouts(coord->scheduler);
+        bool dispatch = coord->dispatch_pending;
+        coord->dispatch_pending = false;
+        mutex_unlock(&coord->event_mutex);
 
-        /* Process job queue */
-        scheduler_process_queue(coord->scheduler);
+        timer_wheel_advance(coord->timers, timer_wheel_now_ms());
+
+        /* Requests arriving meanwhile set the flag again, so none are lost */
+        if (dispatch) {
+            scheduler_process_queue(coord->scheduler);
+        }
 
-        /* Sleep for heartbeat interval */
-        thread_sleep(coord->config.heartbeat_interval_sec * 1000);
+        mutex_lock(&coord->event_mutex);
     }
+    mutex_unlock(&coord->event_mutex);
 
 #ifdef CYXMAKE_WINDOWS
     return 0;
@@ -398,9 +994,18 @@ Coordinator* distributed_coordinator_create(const DistributedCoordinatorConfig*
         if (config->auth_token) {
             coord->config.auth_token = strdup(config->auth_token);
         }
+        if (config->history_path) {
+            coord->config.history_path = strdup(config->history_path);
+        }
+        if (config->trace_path) {
+            coord->config.trace_path = strdup(config->trace_path);
+        }
         if (config->cache_dir) {
             coord->config.cache_dir = strdup(config->cache_dir);
         }
+        if (config->transfer_dir) {
+            coord->config.transfer_dir = strdup(config->transfer_dir);
+        }
         if (config->log_file) {
             coord->config.log_file = strdup(config->log_file);
         }
@@ -409,13 +1014,21 @@ Coordinator* distributed_coordinator_create(const DistributedCoordinatorConfig*
     }
 
 #ifdef CYXMAKE_ENABLE_DISTRIBUTED
-    if (!mutex_init(&coord->mutex)) {
+    if (!mutex_init(&coord->mutex) || !mutex_init(&coord->event_mutex) ||
+        !condition_init(&coord->event_cond)) {
         log_error("Failed to create coordinator mutex");
         distributed_coordinator_free(coord);
         return NULL;
     }
 #endif
 
+    coord->timers = timer_wheel_create(TIMER_TICK_MS, TIMER_SLOTS);
+    if (!coord->timers) {
+        log_error("Failed to create coordinator timers");
+        distributed_coordinator_free(coord);
+        return NULL;
+    }
+
     /* Create network server */
     NetworkConfig net_config = {0};
     net_config.bind_address = coord->config.bind_address ?
@@ -426,6 +1039,7 @@ Coordinator* distributed_coordinator_create(const DistributedCoordinatorConfig*
     net_config.key_path = coord->config.key_path;
     net_config.max_connections = coord->config.max_workers;
     net_config.connection_timeout_sec = coord->config.connection_timeout_sec;
+    net_config.wire_format = coord->config.json_frames ? PROTO_WIRE_JSON : PROTO_WIRE_BINARY;
 
     coord->server = network_server_create(&net_config);
     if (!coord->server) {
@@ -440,6 +1054,7 @@ Coordinator* distributed_coordinator_create(const DistributedCoordinatorConfig*
         .on_disconnect = on_client_disconnect,
         .on_message = on_client_message,
         .on_error = on_client_error,
+        .on_backpressure = on_client_backpressure,
         .user_data = coord
     };
     network_server_set_callbacks(coord->server, &server_cbs);
@@ -463,6 +1078,12 @@ Coordinator* distributed_coordinator_create(const DistributedCoordinatorConfig*
     sched_config.max_concurrent_builds = coord->config.max_concurrent_builds;
     sched_config.max_pending_jobs = coord->config.max_pending_jobs;
     sched_config.default_job_timeout_sec = coord->config.job_timeout_sec;
+    sched_config.history_path = coord->config.history_path ?
+                                coord->config.history_path : DEFAULT_HISTORY_PATH;
+    sched_config.trace_path = coord->config.trace_path;
+    sched_config.enable_job_coalescing = coord->config.max_batch_size > 1;
+    sched_config.max_batch_size = coord->config.max_batch_size;
+    sched_config.enable_speculative = coord->config.speculative_execution;
 
     coord->scheduler = scheduler_create(&sched_config, coord->registry);
     if (!coord->scheduler) {
@@ -474,7 +1095,12 @@ Coordinator* distributed_coordinator_create(const DistributedCoordinatorConfig*
     /* Set scheduler callbacks */
     SchedulerCallbacks sched_cbs = {
         .on_job_assigned = on_job_assigned,
+        .on_batch_assigned = on_batch_assigned,
+        .on_job_completed = on_job_completed,
+        .on_job_failed = on_job_failed,
         .on_build_completed = on_build_completed,
+        .on_job_revoked = on_job_revoked,
+        .on_dispatch_needed = on_dispatch_needed,
         .user_data = coord
     };
     scheduler_set_callbacks(coord->scheduler, &sched_cbs);
@@ -497,6 +1123,7 @@ Coordinator* distributed_coordinator_create(const DistributedCoordinatorConfig*
         if (token) {
             coord->config.auth_token = strdup(token->token_value);
             log_info("Generated worker token: %s", token->token_value);
+            auth_token_free(token);
         }
     }
 
@@ -534,6 +1161,7 @@ void distributed_coordinator_free(Coordinator* coord) {
     if (coord->scheduler) {
         scheduler_free(coord->scheduler);
     }
+    timer_wheel_free(coord->timers);
     if (coord->registry) {
         worker_registry_free(coord->registry);
     }
@@ -541,8 +1169,15 @@ void distributed_coordinator_free(Coordinator* coord) {
         network_server_free(coord->server);
     }
 
+    while (coord->transfers_out) {
+        remove_transfer(coord, coord->transfers_out);
+    }
+    file_transfer_receiver_free(coord->transfers_in);
+
 #ifdef CYXMAKE_ENABLE_DISTRIBUTED
     mutex_destroy(&coord->mutex);
+    mutex_destroy(&coord->event_mutex);
+    condition_destroy(&coord->event_cond);
 #endif
 
     distributed_coordinator_config_free(&coord->config);
@@ -581,10 +1216,27 @@ bool coordinator_start(Coordinator* coord) {
     coord->running = true;
     coord->started_at = time(NULL);
 
+    /* Job timeouts are armed per assignment; these are the periodic checks */
+    unsigned int heartbeat_ms = (unsigned int)coord->config.heartbeat_interval_sec * 1000;
+    coord->heartbeat_timer = timer_wheel_schedule(coord->timers, heartbeat_ms, heartbeat_ms,
+                                                  on_heartbeat_timer, coord, NULL);
+    coord->transfer_timer = timer_wheel_schedule(coord->timers,
+                                                 TRANSFER_EXPIRE_CHECK_SEC * 1000,
+                                                 TRANSFER_EXPIRE_CHECK_SEC * 1000,
+                                                 on_transfer_expire_timer, coord, NULL);
+    if (coord->config.speculative_execution) {
+        coord->straggler_timer = timer_wheel_schedule(coord->timers,
+                                                      STRAGGLER_CHECK_MS, STRAGGLER_CHECK_MS,
+                                                      on_straggler_timer, coord, NULL);
+    }
+
 #ifdef CYXMAKE_ENABLE_DISTRIBUTED
-    /* Start heartbeat/maintenance thread */
-    if (!thread_create(&coord->heartbeat_thread, (ThreadFunc)heartbeat_thread_func, coord)) {
-        log_warning("Failed to start heartbeat thread");
+    /* Start event loop: dispatch on scheduler events, timers in between */
+    coord->dispatch_pending = true;
+    coord->event_thread_started = thread_create(&coord->event_thread,
+                                                (ThreadFunc)event_thread_func, coord);
+    if (!coord->event_thread_started) {
+        log_warning("Failed to start coordinator event thread");
     }
 #endif
 
@@ -598,12 +1250,23 @@ void coordinator_stop(Coordinator* coord) {
     coord->running = false;
 
 #ifdef CYXMAKE_ENABLE_DISTRIBUTED
-    if (coord->heartbeat_thread) {
-        thread_join(coord->heartbeat_thread);
-        coord->heartbeat_thread = NULL;
+    if (coord->event_thread_started) {
+        mutex_lock(&coord->event_mutex);
+        condition_broadcast(&coord->event_cond);
+        mutex_unlock(&coord->event_mutex);
+
+        thread_join(coord->event_thread);
+        coord->event_thread_started = false;
     }
 #endif
 
+    timer_wheel_cancel(coord->timers, coord->heartbeat_timer);
+    timer_wheel_cancel(coord->timers, coord->transfer_timer);
+    timer_wheel_cancel(coord->timers, coord->straggler_timer);
+    coord->heartbeat_timer = 0;
+    coord->transfer_timer = 0;
+    coord->straggler_timer = 0;
+
     if (coord->scheduler) {
         scheduler_stop(coord->scheduler);
     }
@@ -619,6 +1282,27 @@ bool coordinator_is_running(Coordinator* coord) {
     return coord && coord->running;
 }
 
+/* Sum slots and fold per-worker metrics into farm-wide ones */
+static void accumulate_worker_metrics(RemoteWorker* worker, void* user_data) {
+    CoordinatorStatus* status = (CoordinatorStatus*)user_data;
+    if (worker->state != WORKER_STATE_ONLINE && worker->state != WORKER_STATE_BUSY) return;
+
+    status->declared_slots += worker->max_jobs;
+    status->effective_slots += worker_slot_limit(worker);
+
+    for (int t = 0; t < WORKER_JOB_TYPE_COUNT; t++) {
+        const WorkerJobMetrics* m = &worker->metrics[t];
+        WorkerJobMetrics* farm = &status->job_metrics[t];
+        if (m->samples == 0) continue;
+
+        /* Sample-weighted sums here; divided out once all workers are in */
+        farm->latency_sec += m->latency_sec * m->samples;
+        farm->failure_rate += m->failure_rate * m->samples;
+        farm->throughput += m->throughput;
+        farm->samples += m->samples;
+    }
+}
+
 CoordinatorStatus coordinator_get_status(Coordinator* coord) {
     CoordinatorStatus status = {0};
 
@@ -637,12 +1321,25 @@ CoordinatorStatus coordinator_get_status(Coordinator* coord) {
 
     if (coord->registry) {
         status.online_workers = worker_registry_get_online_count(coord->registry);
+        worker_registry_foreach(coord->registry, accumulate_worker_metrics, &status);
+        for (int t = 0; t < WORKER_JOB_TYPE_COUNT; t++) {
+            WorkerJobMetrics* farm = &status.job_metrics[t];
+            if (farm->samples > 0) {
+                farm->latency_sec /= farm->samples;
+                farm->failure_rate /= farm->samples;
+            }
+        }
     }
 
     if (coord->scheduler) {
         SchedulerStats stats = scheduler_get_stats(coord->scheduler);
         status.pending_jobs = scheduler_get_pending_count(coord->scheduler);
         status.running_jobs = scheduler_get_running_count(coord->scheduler);
+        status.job_batches = stats.batches_dispatched;
+        status.messages_saved = stats.messages_saved;
+        status.speculative_launched = stats.speculative_launched;
+        status.speculative_wins = stats.speculative_wins;
+        status.speculative_wasted_sec = stats.speculative_wasted_sec;
         status.active_builds = stats.total_builds - stats.successful_builds - stats.failed_builds;
     }
 
@@ -697,6 +1394,42 @@ char* coordinator_generate_worker_token(Coordinator* coord,
 #endif
 }
 
+bool coordinator_send_file(Coordinator* coord,
+                           const char* worker_id,
+                           const char* path,
+                           const char* remote_name) {
+    if (!coord || !worker_id || !path) return false;
+
+    RemoteWorker* worker = worker_registry_find_by_id(coord->registry, worker_id);
+    if (!worker || !worker->connection) {
+        log_error("Cannot send file: worker %s not connected", worker_id);
+        return false;
+    }
+
+    FileTransferSender* sender = file_transfer_sender_create(path, remote_name,
+                                                              &coord->config.transfer);
+    if (!sender) return false;
+
+    OutgoingTransfer* out = calloc(1, sizeof(OutgoingTransfer));
+    if (!out) {
+        file_transfer_sender_free(sender);
+        return false;
+    }
+    out->sender = sender;
+    out->connection = worker->connection;
+
+    /* An ACK may finish and free the transfer once it is listed */
+    log_info("Sending %s to worker %s (%llu bytes)", path, worker_id,
+             (unsigned long long)file_transfer_sender_get_size(sender));
+
+    coord_lock(coord);
+    out->next = coord->transfers_out;
+    coord->transfers_out = out;
+    pump_transfer(coord, out);
+    coord_unlock(coord);
+    return true;
+}
+
 /* ============================================================
  * Build Submission
  * ============================================================ */
@@ -853,33 +1586,3 @@ void distributed_build_options_free(DistributedBuildOptions* options) {
     free(options->target_os);
     free(options->cross_target);
 }
-
-/* ============================================================
- * Worker Client Stubs (to be implemented in worker_daemon.c)
- * ============================================================ */
-
-WorkerClientConfig worker_client_config_default(void) {
-    WorkerClientConfig config = {
-        .name = NULL,
-        .coordinator_url = NULL,
-        .auth_token = NULL,
-        .max_jobs = 4,
-        .auto_detect_tools = true,
-        .auto_reconnect = true,
-        .reconnect_delay_sec = 5,
-        .max_reconnect_attempts = 10,
-        .enable_sandbox = false,
-        .sandbox_dir = NULL
-    };
-    return config;
-}
-
-void worker_client_config_free(WorkerClientConfig* config) {
-    if (!config) return;
-    free(config->name);
-    free(config->coordinator_url);
-    free(config->auth_token);
-    free(config->sandbox_dir);
-}
-
-/* Worker client implementation will be in worker_daemon.c */
@@ -0,0 +1,861 @@
+/**
+ * @file file_transfer.c
+ * @brief Chunked, flow-controlled file transfer implementation
+ *
+ * The sender reads one chunk at a time and keeps at most window_chunks
+ * unacknowledged; the receiver writes each chunk straight into a partial
+ * file and renames it into place once the whole-file CRC matches.
+ */
+
+#ifndef _WIN32
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include "cyxmake/distributed/file_transfer.h"
+#include "cyxmake/logger.h"
+#include "cyxmake/compat.h"
+
+#include <cJSON.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#define ft_fseek _fseeki64
+#define ft_mkdir(path) _mkdir(path)
+#else
+#include <sys/types.h>
+#define ft_fseek fseeko
+#define ft_mkdir(path) mkdir(path, 0755)
+#endif
+
+/* ============================================================
+ * Constants
+ * ============================================================ */
+
+#define DEFAULT_CHUNK_SIZE (256 * 1024)
+#define DEFAULT_WINDOW_CHUNKS 8
+#define DEFAULT_ACK_EVERY 4
+#define MIN_CHUNK_SIZE 1024
+#define MAX_CHUNK_SIZE (4 * 1024 * 1024)   /* Must stay below the transport message limit */
+
+/* ============================================================
+ * CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320)
+ * ============================================================ */
+
+static uint32_t crc_table[256];
+static bool crc_table_ready = false;
+
+static void crc_table_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        crc_table[i] = c;
+    }
+    crc_table_ready = true;
+}
+
+uint32_t file_transfer_crc32(uint32_t crc, const void* data, size_t len) {
+    if (!crc_table_ready) crc_table_init();
+
+    const uint8_t* p = (const uint8_t*)data;
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = crc_table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+/* CRC of the first `length` bytes of an open file, reusing `buf` */
+static bool crc_file_prefix(FILE* file, uint64_t length, uint8_t* buf,
+                            size_t buf_size, uint32_t* out_crc) {
+    uint32_t crc = 0;
+    if (ft_fseek(file, 0, SEEK_SET) != 0) return false;
+
+    uint64_t remaining = length;
+    while (remaining > 0) {
+        size_t want = remaining < buf_size ? (size_t)remaining : buf_size;
+        size_t got = fread(buf, 1, want, file);
+        if (got != want) return false;
+        crc = file_transfer_crc32(crc, buf, got);
+        remaining -= got;
+    }
+
+    *out_crc = crc;
+    return true;
+}
+
+/* ============================================================
+ * Helpers
+ * ============================================================ */
+
+static FileTransferConfig resolve_config(const FileTransferConfig* config) {
+    FileTransferConfig c = config ? *config : file_transfer_config_default();
+
+    if (c.chunk_size < MIN_CHUNK_SIZE) c.chunk_size = MIN_CHUNK_SIZE;
+    if (c.chunk_size > MAX_CHUNK_SIZE) c.chunk_size = MAX_CHUNK_SIZE;
+    if (c.window_chunks < 1) c.window_chunks = 1;
+    if (c.ack_every < 1) c.ack_every = 1;
+    if (c.ack_every > c.window_chunks) c.ack_every = c.window_chunks;
+    return c;
+}
+
+static const char* path_basename(const char* path) {
+    const char* base = path;
+    for (const char* p = path; *p; p++) {
+        if (*p == '/' || *p == '\\') base = p + 1;
+    }
+    return base;
+}
+
+/* Transfer IDs hash the file identity so a resend resumes the same partial file */
+static char* make_transfer_id(const char* name, uint64_t size, time_t mtime) {
+    char identity[512];
+    snprintf(identity, sizeof(identity), "%s|%llu|%lld",
+             name, (unsigned long long)size, (long long)mtime);
+
+    uint64_t hash = 1469598103934665603ULL;  /* FNV-1a 64 */
+    for (const char* p = identity; *p; p++) {
+        hash ^= (uint8_t)*p;
+        hash *= 1099511628211ULL;
+    }
+
+    char* id = (char*)malloc(20);
+    if (id) snprintf(id, 20, "ft-%016llx", (unsigned long long)hash);
+    return id;
+}
+
+static cJSON* parse_payload(const ProtocolMessage* msg) {
+    if (!msg || !msg->payload_json) return NULL;
+    return cJSON_ParseWithLength(msg->payload_json, msg->payload_size);
+}
+
+static const char* json_string(cJSON* obj, const char* key) {
+    cJSON* item = cJSON_GetObjectItem(obj, key);
+    return cJSON_IsString(item) ? item->valuestring : NULL;
+}
+
+static uint64_t json_u64(cJSON* obj, const char* key) {
+    cJSON* item = cJSON_GetObjectItem(obj, key);
+    return cJSON_IsNumber(item) && item->valuedouble > 0 ?
+           (uint64_t)item->valuedouble : 0;
+}
+
+static ProtocolMessage* make_message(ProtocolMessageType type, cJSON* payload) {
+    ProtocolMessage* msg = protocol_message_create(type);
+    if (!msg) {
+        cJSON_Delete(payload);
+        return NULL;
+    }
+
+    char* json = cJSON_PrintUnformatted(payload);
+    cJSON_Delete(payload);
+    if (!json) {
+        protocol_message_free(msg);
+        return NULL;
+    }
+
+    msg->payload_json = json;
+    msg->payload_size = strlen(json);
+    return msg;
+}
+
+/* ============================================================
+ * Sender
+ * ============================================================ */
+
+struct FileTransferSender {
+    FileTransferConfig config;
+    char* transfer_id;
+    char* path;
+    char* remote_name;
+
+    FILE* file;
+    uint64_t size;
+    uint8_t* chunk_buf;
+
+    uint64_t next_offset;         /* Next byte to send */
+    uint64_t acked_offset;        /* Bytes confirmed by receiver */
+    uint32_t crc;                 /* CRC of bytes [0, next_offset) */
+
+    FileTransferState state;
+    bool start_sent;
+    bool end_sent;
+
+    /* Undo record for the last message returned, for rewind */
+    ProtocolMessageType last_type;
+    uint64_t last_offset;
+    uint32_t last_crc;
+};
+
+FileTransferSender* file_transfer_sender_create(const char* path,
+                                                 const char* remote_name,
+                                                 const FileTransferConfig* config) {
+    if (!path) return NULL;
+
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+        log_error("Cannot send file: %s", path);
+        return NULL;
+    }
+
+    FileTransferSender* sender = calloc(1, sizeof(FileTransferSender));
+    if (!sender) return NULL;
+
+    sender->config = resolve_config(config);
+    sender->path = strdup(path);
+    sender->remote_name = strdup(remote_name ? remote_name : path_basename(path));
+    sender->size = (uint64_t)st.st_size;
+    sender->file = fopen(path, "rb");
+    sender->chunk_buf = malloc(sender->config.chunk_size);
+    sender->transfer_id = make_transfer_id(sender->remote_name, sender->size, st.st_mtime);
+    sender->state = FILE_TRANSFER_PENDING;
+
+    if (!sender->path || !sender->remote_name || !sender->file ||
+        !sender->chunk_buf || !sender->transfer_id) {
+        log_error("Failed to prepare transfer for %s", path);
+        file_transfer_sender_free(sender);
+        return NULL;
+    }
+
+    log_debug("File transfer %s: %s (%llu bytes)", sender->transfer_id,
+              sender->remote_name, (unsigned long long)sender->size);
+    return sender;
+}
+
+void file_transfer_sender_free(FileTransferSender* sender) {
+    if (!sender) return;
+
+    if (sender->file) fclose(sender->file);
+    free(sender->chunk_buf);
+    free(sender->transfer_id);
+    free(sender->path);
+    free(sender->remote_name);
+    free(sender);
+}
+
+static bool sender_rewind(FileTransferSender* sender, uint64_t offset) {
+    if (offset > sender->size) return false;
+
+    uint32_t crc = 0;
+    if (!crc_file_prefix(sender->file, offset, sender->chunk_buf,
+                         sender->config.chunk_size, &crc)) {
+        log_error("Failed to read %s while resuming transfer", sender->path);
+        return false;
+    }
+
+    sender->crc = crc;
+    sender->next_offset = offset;
+    sender->acked_offset = offset;
+    sender->end_sent = false;
+    return true;
+}
+
+ProtocolMessage* file_transfer_sender_next(FileTransferSender* sender) {
+    if (!sender) return NULL;
+    if (sender->state == FILE_TRANSFER_COMPLETE ||
+        sender->state == FILE_TRANSFER_FAILED) {
+        return NULL;
+    }
+
+    if (!sender->start_sent) {
+        cJSON* payload = cJSON_CreateObject();
+        cJSON_AddStringToObject(payload, "transfer_id", sender->transfer_id);
+        cJSON_AddStringToObject(payload, "name", sender->remote_name);
+        cJSON_AddNumberToObject(payload, "size", (double)sender->size);
+        cJSON_AddNumberToObject(payload, "chunk_size", (double)sender->config.chunk_size);
+        cJSON_AddNumberToObject(payload, "window_chunks", (double)sender->config.window_chunks);
+
+        sender->start_sent = true;
+        sender->last_type = PROTO_MSG_FILE_TRANSFER_START;
+        return make_message(PROTO_MSG_FILE_TRANSFER_START, payload);
+    }
+
+    /* Wait for the receiver to report its resume offset */
+    if (sender->state == FILE_TRANSFER_PENDING) return NULL;
+
+    if (sender->next_offset < sender->size) {
+        uint64_t in_flight = sender->next_offset - sender->acked_offset;
+        if (in_flight >= (uint64_t)sender->config.window_chunks * sender->config.chunk_size) {
+            return NULL;
+        }
+
+        uint64_t remaining = sender->size - sender->next_offset;
+        size_t len = remaining < sender->config.chunk_size ?
+                     (size_t)remaining : sender->config.chunk_size;
+
+        if (ft_fseek(sender->file, (long long)sender->next_offset, SEEK_SET) != 0 ||
+            fread(sender->chunk_buf, 1, len, sender->file) != len) {
+            log_error("Failed to read %s at offset %llu", sender->path,
+                      (unsigned long long)sender->next_offset);
+            sender->state = FILE_TRANSFER_FAILED;
+            return NULL;
+        }
+
+        cJSON* payload = cJSON_CreateObject();
+        cJSON_AddStringToObject(payload, "transfer_id", sender->transfer_id);
+        cJSON_AddNumberToObject(payload, "offset", (double)sender->next_offset);
+        cJSON_AddNumberToObject(payload, "crc",
+                                (double)file_transfer_crc32(0, sender->chunk_buf, len));
+
+        ProtocolMessage* msg = make_message(PROTO_MSG_FILE_CHUNK, payload);
+        if (!msg || !protocol_message_set_binary(msg, sender->chunk_buf, len)) {
+            protocol_message_free(msg);
+            return NULL;
+        }
+
+        sender->last_type = PROTO_MSG_FILE_CHUNK;
+        sender->last_offset = sender->next_offset;
+        sender->last_crc = sender->crc;
+        sender->crc = file_transfer_crc32(sender->crc, sender->chunk_buf, len);
+        sender->next_offset += len;
+        return msg;
+    }
+
+    if (!sender->end_sent) {
+        cJSON* payload = cJSON_CreateObject();
+        cJSON_AddStringToObject(payload, "transfer_id", sender->transfer_id);
+        cJSON_AddNumberToObject(payload, "size", (double)sender->size);
+        cJSON_AddNumberToObject(payload, "crc", (double)sender->crc);
+
+        sender->end_sent = true;
+        sender->last_type = PROTO_MSG_FILE_TRANSFER_END;
+        return make_message(PROTO_MSG_FILE_TRANSFER_END, payload);
+    }
+
+    return NULL;
+}
+
+void file_transfer_sender_rewind(FileTransferSender* sender) {
+    if (!sender) return;
+
+    switch (sender->last_type) {
+        case PROTO_MSG_FILE_TRANSFER_START:
+            sender->start_sent = false;
+            break;
+        case PROTO_MSG_FILE_CHUNK:
+            sender->next_offset = sender->last_offset;
+            sender->crc = sender->last_crc;
+            break;
+        case PROTO_MSG_FILE_TRANSFER_END:
+            sender->end_sent = false;
+            break;
+        default:
+            break;
+    }
+    sender->last_type = 0;
+}
+
+bool file_transfer_sender_handle_ack(FileTransferSender* sender,
+                                     const ProtocolMessage* ack) {
+    if (!sender || !ack || ack->type != PROTO_MSG_FILE_TRANSFER_ACK) return false;
+
+    cJSON* payload = parse_payload(ack);
+    if (!payload) return false;
+
+    const char* id = json_string(payload, "transfer_id");
+    if (!id || strcmp(id, sender->transfer_id) != 0) {
+        cJSON_Delete(payload);
+        return true;  /* Not ours */
+    }
+
+    const char* status = json_string(payload, "status");
+    uint64_t offset = json_u64(payload, "offset");
+    bool ok = true;
+
+    if (!status || strcmp(status, "failed") == 0) {
+        const char* error = json_string(payload, "error");
+        log_error("File transfer %s failed: %s", sender->transfer_id,
+                  error ? error : "receiver error");
+        sender->state = FILE_TRANSFER_FAILED;
+        ok = false;
+    } else if (strcmp(status, "complete") == 0) {
+        sender->acked_offset = sender->size;
+        sender->state = FILE_TRANSFER_COMPLETE;
+        log_debug("File transfer %s complete", sender->transfer_id);
+    } else if (strcmp(status, "resume") == 0 || strcmp(status, "retry") == 0) {
+        if (offset > 0 && strcmp(status, "resume") == 0) {
+            log_info("Resuming transfer %s at offset %llu", sender->transfer_id,
+                     (unsigned long long)offset);
+        }
+        if (sender_rewind(sender, offset)) {
+            sender->state = FILE_TRANSFER_ACTIVE;
+        } else {
+            sender->state = FILE_TRANSFER_FAILED;
+            ok = false;
+        }
+    } else if (offset > sender->acked_offset && offset <= sender->next_offset) {
+        sender->acked_offset = offset;
+    }
+
+    cJSON_Delete(payload);
+    return ok;
+}
+
+void file_transfer_sender_restart(FileTransferSender* sender) {
+    if (!sender || sender->state == FILE_TRANSFER_COMPLETE) return;
+
+    sender->state = FILE_TRANSFER_PENDING;
+    sender->start_sent = false;
+    sender->end_sent = false;
+}
+
+const char* file_transfer_sender_get_id(FileTransferSender* sender) {
+    return sender ? sender->transfer_id : NULL;
+}
+
+FileTransferState file_transfer_sender_get_state(FileTransferSender* sender) {
+    return sender ? sender->state : FILE_TRANSFER_FAILED;
+}
+
+uint64_t file_transfer_sender_get_acked(FileTransferSender* sender) {
+    return sender ? sender->acked_offset : 0;
+}
+
+uint64_t file_transfer_sender_get_size(FileTransferSender* sender) {
+    return sender ? sender->size : 0;
+}
+
+/* ============================================================
+ * Receiver
+ * ============================================================ */
+
+typedef struct IncomingTransfer {
+    char* transfer_id;
+    char* final_path;
+    char* part_path;
+    FILE* file;
+
+    uint64_t size;
+    uint64_t committed;           /* Contiguous bytes written */
+    uint32_t crc;                 /* CRC of committed bytes */
+    size_t chunk_size;
+
+    int ack_every;                /* Fits the sender's window */
+    int chunks_since_ack;
+    bool retry_pending;           /* Retry sent; drop chunks until offset matches */
+    time_t last_activity;
+
+    struct IncomingTransfer* next;
+} IncomingTransfer;
+
+struct FileTransferReceiver {
+    FileTransferConfig config;
+    char* dest_dir;
+    IncomingTransfer* transfers;
+    int active_count;
+
+    OnFileReceivedCallback on_received;
+    void* user_data;
+};
+
+static bool make_dirs(const char* path) {
+    char* copy = strdup(path);
+    if (!copy) return false;
+
+    for (char* p = copy + 1; *p; p++) {
+        if (*p == '/' || *p == '\\') {
+            char saved = *p;
+            *p = '\0';
+            ft_mkdir(copy);
+            *p = saved;
+        }
+    }
+    ft_mkdir(copy);
+
+    struct stat st;
+    bool ok = stat(copy, &st) == 0 && S_ISDIR(st.st_mode);
+    free(copy);
+    return ok;
+}
+
+static char* join_path(const char* dir, const char* name) {
+    size_t len = strlen(dir) + strlen(name) + 2;
+    char* path = malloc(len);
+    if (path) snprintf(path, len, "%s%s%s", dir, DIR_SEP_STR, name);
+    return path;
+}
+
+static void incoming_free(IncomingTransfer* t) {
+    if (!t) return;
+    if (t->file) fclose(t->file);
+    free(t->transfer_id);
+    free(t->final_path);
+    free(t->part_path);
+    free(t);
+}
+
+static IncomingTransfer* find_incoming(FileTransferReceiver* receiver, const char* id) {
+    for (IncomingTransfer* t = receiver->transfers; t; t = t->next) {
+        if (strcmp(t->transfer_id, id) == 0) return t;
+    }
+    return NULL;
+}
+
+static void remove_incoming(FileTransferReceiver* receiver, IncomingTransfer* target) {
+    IncomingTransfer** pp = &receiver->transfers;
+    while (*pp) {
+        if (*pp == target) {
+            *pp = target->next;
+            receiver->active_count--;
+            incoming_free(target);
+            return;
+        }
+        pp = &(*pp)->next;
+    }
+}
+
+static ProtocolMessage* make_ack(const ProtocolMessage* request, const char* transfer_id,
+                                 uint64_t offset, const char* status, const char* error) {
+    cJSON* payload = cJSON_CreateObject();
+    cJSON_AddStringToObject(payload, "transfer_id", transfer_id);
+    cJSON_AddNumberToObject(payload, "offset", (double)offset);
+    cJSON_AddStringToObject(payload, "status", status);
+    if (error) cJSON_AddStringToObject(payload, "error", error);
+
+    ProtocolMessage* ack = make_message(PROTO_MSG_FILE_TRANSFER_ACK, payload);
+    if (ack && request && request->id) {
+        ack->correlation_id = strdup(request->id);
+    }
+    return ack;
+}
+
+/* Open the partial file and work out how much of it can be kept */
+static bool open_part(IncomingTransfer* t) {
+    if (t->file) {
+        fclose(t->file);
+        t->file = NULL;
+    }
+
+    uint64_t resume = 0;
+    struct stat st;
+    if (stat(t->part_path, &st) == 0 && (uint64_t)st.st_size <= t->size) {
+        resume = (uint64_t)st.st_size / t->chunk_size * t->chunk_size;
+        t->file = fopen(t->part_path, "r+b");
+    }
+    if (!t->file) {
+        resume = 0;
+        t->file = fopen(t->part_path, "w+b");
+        if (!t->file) return false;
+    }
+
+    /* Rebuild the running CRC over the kept prefix */
+    uint8_t* buf = malloc(t->chunk_size);
+    uint32_t crc = 0;
+    bool ok = buf && crc_file_prefix(t->file, resume, buf, t->chunk_size, &crc);
+    free(buf);
+
+    if (!ok) {
+        fclose(t->file);
+        t->file = fopen(t->part_path, "w+b");
+        if (!t->file) return false;
+        resume = 0;
+        crc = 0;
+    }
+
+    t->committed = resume;
+    t->crc = crc;
+    t->retry_pending = false;
+    t->chunks_since_ack = 0;
+    return true;
+}
+
+static ProtocolMessage* handle_start(FileTransferReceiver* receiver,
+                                     const ProtocolMessage* msg, cJSON* payload) {
+    const char* id = json_string(payload, "transfer_id");
+    const char* name = json_string(payload, "name");
+    uint64_t size = json_u64(payload, "size");
+    size_t chunk_size = (size_t)json_u64(payload, "chunk_size");
+    int window = (int)json_u64(payload, "window_chunks");
+
+    if (!id || !name) return NULL;
+
+    /* Never let the sender choose a path outside dest_dir */
+    const char* base = path_basename(name);
+    if (!*base || strcmp(base, ".") == 0 || strcmp(base, "..") == 0) {
+        return make_ack(msg, id, 0, "failed", "invalid file name");
+    }
+    if (chunk_size < MIN_CHUNK_SIZE || chunk_size > MAX_CHUNK_SIZE) {
+        chunk_size = receiver->config.chunk_size;
+    }
+
+    IncomingTransfer* t = find_incoming(receiver, id);
+    if (!t) {
+        t = calloc(1, sizeof(IncomingTransfer));
+        if (!t) return make_ack(msg, id, 0, "failed", "out of memory");
+
+        char part_name[64];
+        snprintf(part_name, sizeof(part_name), ".%s.part", id);
+
+        t->transfer_id = strdup(id);
+        t->final_path = join_path(receiver->dest_dir, base);
+        t->part_path = join_path(receiver->dest_dir, part_name);
+        if (!t->transfer_id || !t->final_path || !t->part_path) {
+            incoming_free(t);
+            return make_ack(msg, id, 0, "failed", "out of memory");
+        }
+
+        t->next = receiver->transfers;
+        receiver->transfers = t;
+        receiver->active_count++;
+    }
+
+    t->size = size;
+    t->chunk_size = chunk_size;
+    t->last_activity = time(NULL);
+
+    /* Ack at least twice per sender window so it never stalls waiting */
+    t->ack_every = receiver->config.ack_every;
+    if (window > 0 && t->ack_every > window / 2) {
+        t->ack_every = window / 2 > 0 ? window / 2 : 1;
+    }
+
+    if (!open_part(t)) {
+        log_error("Cannot write %s", t->part_path);
+        remove_incoming(receiver, t);
+        return make_ack(msg, id, 0, "failed", "cannot open destination");
+    }
+
+    log_debug("Receiving %s (%llu bytes, resume at %llu)", t->final_path,
+              (unsigned long long)size, (unsigned long long)t->committed);
+    return make_ack(msg, id, t->committed, "resume", NULL);
+}
+
+static ProtocolMessage* handle_chunk(FileTransferReceiver* receiver,
+                                     const ProtocolMessage* msg, cJSON* payload) {
+    const char* id = json_string(payload, "transfer_id");
+    if (!id) return NULL;
+
+    IncomingTransfer* t = find_incoming(receiver, id);
+    if (!t) return make_ack(msg, id, 0, "failed", "unknown transfer");
+
+    t->last_activity = time(NULL);
+    if (!t->file && !open_part(t)) {
+        remove_incoming(receiver, t);
+        return make_ack(msg, id, 0, "failed", "cannot open destination");
+    }
+
+    uint64_t offset = json_u64(payload, "offset");
+    uint32_t crc = (uint32_t)json_u64(payload, "crc");
+    size_t len = msg->binary_size;
+
+    bool valid = offset == t->committed && msg->binary_data && len > 0 &&
+                 t->committed + len <= t->size &&
+                 file_transfer_crc32(0, msg->binary_data, len) == crc;
+
+    if (!valid) {
+        /* One retry per gap; later chunks of the same window are dropped */
+        if (t->retry_pending) return NULL;
+        t->retry_pending = true;
+        log_debug("Transfer %s: rejecting chunk at %llu (expected %llu)", id,
+                  (unsigned long long)offset, (unsigned long long)t->committed);
+        return make_ack(msg, id, t->committed, "retry", NULL);
+    }
+
+    if (ft_fseek(t->file, (long long)offset, SEEK_SET) != 0 ||
+        fwrite(msg->binary_data, 1, len, t->file) != len) {
+        log_error("Failed to write %s", t->part_path);
+        uint64_t committed = t->committed;
+        remove_incoming(receiver, t);
+        return make_ack(msg, id, committed, "failed", "write error");
+    }
+
+    t->crc = file_transfer_crc32(t->crc, msg->binary_data, len);
+    t->committed += len;
+    t->retry_pending = false;
+
+    if (++t->chunks_since_ack >= t->ack_every) {
+        t->chunks_since_ack = 0;
+        return make_ack(msg, id, t->committed, "ok", NULL);
+    }
+    return NULL;
+}
+
+static ProtocolMessage* handle_end(FileTransferReceiver* receiver,
+                                   const ProtocolMessage* msg, cJSON* payload) {
+    const char* id = json_string(payload, "transfer_id");
+    if (!id) return NULL;
+
+    IncomingTransfer* t = find_incoming(receiver, id);
+    if (!t) return make_ack(msg, id, 0, "failed", "unknown transfer");
+
+    uint64_t size = json_u64(payload, "size");
+    uint32_t crc = (uint32_t)json_u64(payload, "crc");
+
+    if (t->committed < size) {
+        if (t->retry_pending) return NULL;
+        t->retry_pending = true;
+        return make_ack(msg, id, t->committed, "retry", NULL);
+    }
+
+    if (t->committed != size || t->crc != crc) {
+        log_error("Transfer %s failed verification", id);
+        if (t->file) {
+            fclose(t->file);
+            t->file = NULL;
+        }
+        remove(t->part_path);
+        remove_incoming(receiver, t);
+        return make_ack(msg, id, 0, "failed", "checksum mismatch");
+    }
+
+    if (t->file) {
+        fclose(t->file);
+        t->file = NULL;
+    }
+
+    remove(t->final_path);
+    if (rename(t->part_path, t->final_path) != 0) {
+        log_error("Failed to move %s into place", t->final_path);
+        remove_incoming(receiver, t);
+        return make_ack(msg, id, size, "failed", "rename failed");
+    }
+
+    log_debug("Received %s (%llu bytes)", t->final_path, (unsigned long long)size);
+
+    if (receiver->on_received) {
+        receiver->on_received(id, t->final_path, size, receiver->user_data);
+    }
+
+    ProtocolMessage* ack = make_ack(msg, id, size, "complete", NULL);
+    remove_incoming(receiver, t);
+    return ack;
+}
+
+FileTransferReceiver* file_transfer_receiver_create(const char* dest_dir,
+                                                     const FileTransferConfig* config) {
+    if (!dest_dir) return NULL;
+
+    if (!make_dirs(dest_dir)) {
+        log_error("Cannot create transfer directory: %s", dest_dir);
+        return NULL;
+    }
+
+    FileTransferReceiver* receiver = calloc(1, sizeof(FileTransferReceiver));
+    if (!receiver) return NULL;
+
+    receiver->config = resolve_config(config);
+    receiver->dest_dir = strdup(dest_dir);
+    if (!receiver->dest_dir) {
+        free(receiver);
+        return NULL;
+    }
+
+    return receiver;
+}
+
+void file_transfer_receiver_free(FileTransferReceiver* receiver) {
+    if (!receiver) return;
+
+    IncomingTransfer* t = receiver->transfers;
+    while (t) {
+        IncomingTransfer* next = t->next;
+        incoming_free(t);
+        t = next;
+    }
+
+    free(receiver->dest_dir);
+    free(receiver);
+}
+
+void file_transfer_receiver_set_callback(FileTransferReceiver* receiver,
+                                          OnFileReceivedCallback callback,
+                                          void* user_data) {
+    if (!receiver) return;
+    receiver->on_received = callback;
+    receiver->user_data = user_data;
+}
+
+bool file_transfer_receiver_handle(FileTransferReceiver* receiver,
+                                   const ProtocolMessage* msg,
+                                   ProtocolMessage** reply) {
+    if (reply) *reply = NULL;
+    if (!receiver || !msg) return false;
+
+    cJSON* payload = parse_payload(msg);
+    if (!payload) return false;
+
+    ProtocolMessage* ack = NULL;
+    bool handled = true;
+
+    switch (msg->type) {
+        case PROTO_MSG_FILE_TRANSFER_START:
+            ack = handle_start(receiver, msg, payload);
+            break;
+        case PROTO_MSG_FILE_CHUNK:
+            ack = handle_chunk(receiver, msg, payload);
+            break;
+        case PROTO_MSG_FILE_TRANSFER_END:
+            ack = handle_end(receiver, msg, payload);
+            break;
+        default:
+            handled = false;
+            break;
+    }
+
+    cJSON_Delete(payload);
+
+    if (reply) {
+        *reply = ack;
+    } else {
+        protocol_message_free(ack);
+    }
+    return handled;
+}
+
+int file_transfer_receiver_expire(FileTransferReceiver* receiver, int max_idle_sec) {
+    if (!receiver) return 0;
+
+    int closed = 0;
+    time_t now = time(NULL);
+
+    for (IncomingTransfer* t = receiver->transfers; t; t = t->next) {
+        if (t->file && now - t->last_activity > max_idle_sec) {
+            fclose(t->file);
+            t->file = NULL;
+            closed++;
+            log_debug("Transfer %s idle, closed (partial data kept)", t->transfer_id);
+        }
+    }
+
+    return closed;
+}
+
+int file_transfer_receiver_get_active_count(FileTransferReceiver* receiver) {
+    return receiver ? receiver->active_count : 0;
+}
+
+/* ============================================================
+ * Utility Functions
+ * ============================================================ */
+
+FileTransferConfig file_transfer_config_default(void) {
+    FileTransferConfig config = {
+        .chunk_size = DEFAULT_CHUNK_SIZE,
+        .window_chunks = DEFAULT_WINDOW_CHUNKS,
+        .ack_every = DEFAULT_ACK_EVERY
+    };
+    return config;
+}
+
+bool file_transfer_is_message(ProtocolMessageType type) {
+    return type == PROTO_MSG_FILE_TRANSFER_START ||
+           type == PROTO_MSG_FILE_CHUNK ||
+           type == PROTO_MSG_FILE_TRANSFER_END ||
+           type == PROTO_MSG_FILE_TRANSFER_ACK;
+}
+
+const char* file_transfer_state_name(FileTransferState state) {
+    switch (state) {
+        case FILE_TRANSFER_PENDING: return "pending";
+        case FILE_TRANSFER_ACTIVE: return "active";
+        case FILE_TRANSFER_COMPLETE: return "complete";
+        case FILE_TRANSFER_FAILED: return "failed";
+        default: return "unknown";
+    }
+}
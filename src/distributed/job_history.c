@@ -0,0 +1,278 @@
+/**
+ * @file job_history.c
+ * @brief Persisted job duration history implementation
+ *
+ * Open-addressing hash table of digest -> moving-average duration. Not
+ * thread-safe; the scheduler only touches it while holding its own lock.
+ */
+
+#include "cyxmake/distributed/job_history.h"
+#include "cyxmake/distributed/artifact_cache.h"
+#include "cyxmake/file_ops.h"
+#include "cyxmake/logger.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+/* ============================================================
+ * Constants
+ * ============================================================ */
+
+#define HISTORY_INITIAL_CAPACITY 256
+#define HISTORY_MAX_DIGEST 128
+#define HISTORY_EWMA_ALPHA 0.3    /* Weight of the newest sample */
+
+/* ============================================================
+ * Internal Structures
+ * ============================================================ */
+
+typedef struct {
+    char* digest;                 /* NULL = empty slot */
+    double seconds;               /* Moving-average duration */
+    int samples;                  /* Observations folded into seconds */
+} HistoryEntry;
+
+struct JobHistory {
+    char* path;
+    HistoryEntry* entries;
+    int capacity;                 /* Power of two */
+    int count;
+    bool dirty;
+};
+
+/* ============================================================
+ * Hash Table
+ * ============================================================ */
+
+static uint32_t digest_hash(const char* s) {
+    uint32_t h = 2166136261u;     /* FNV-1a */
+    while (*s) {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static HistoryEntry* find_slot(HistoryEntry* entries, int capacity, const char* digest) {
+    uint32_t mask = (uint32_t)capacity - 1;
+    uint32_t i = digest_hash(digest) & mask;
+    while (entries[i].digest && strcmp(entries[i].digest, digest) != 0) {
+        i = (i + 1) & mask;
+    }
+    return &entries[i];
+}
+
+static bool grow(JobHistory* history) {
+    int capacity = history->capacity * 2;
+    HistoryEntry* entries = calloc((size_t)capacity, sizeof(HistoryEntry));
+    if (!entries) return false;
+
+    for (int i = 0; i < history->capacity; i++) {
+        if (history->entries[i].digest) {
+            *find_slot(entries, capacity, history->entries[i].digest) = history->entries[i];
+        }
+    }
+
+    free(history->entries);
+    history->entries = entries;
+    history->capacity = capacity;
+    return true;
+}
+
+/* Insert or update an entry without averaging (used when loading) */
+static void put_entry(JobHistory* history, const char* digest, double seconds, int samples) {
+    if ((history->count + 1) * 10 > history->capacity * 7 && !grow(history)) {
+        return;
+    }
+
+    HistoryEntry* slot = find_slot(history->entries, history->capacity, digest);
+    if (!slot->digest) {
+        slot->digest = strdup(digest);
+        if (!slot->digest) return;
+        history->count++;
+    }
+    slot->seconds = seconds;
+    slot->samples = samples;
+}
+
+/* ============================================================
+ * Persistence
+ * ============================================================ */
+
+static void load_history(JobHistory* history) {
+    FILE* f = fopen(history->path, "r");
+    if (!f) return;  /* First run */
+
+    char digest[HISTORY_MAX_DIGEST + 1];
+    double seconds;
+    int samples;
+    int loaded = 0;
+
+    while (fscanf(f, "%128s %lf %d", digest, &seconds, &samples) == 3) {
+        if (seconds >= 0 && samples > 0) {
+            put_entry(history, digest, seconds, samples);
+            loaded++;
+        }
+    }
+
+    fclose(f);
+    log_debug("Loaded %d job durations from %s", loaded, history->path);
+}
+
+bool job_history_save(JobHistory* history) {
+    if (!history || !history->path || !history->dirty) return true;
+
+    /* Make sure the parent directory exists */
+    char* dir = strdup(history->path);
+    char* sep = dir ? strrchr(dir, '/') : NULL;
+#ifdef _WIN32
+    char* bsep = dir ? strrchr(dir, '\\') : NULL;
+    if (bsep > sep) sep = bsep;
+#endif
+    if (sep && sep != dir) {
+        *sep = '\0';
+        dir_create(dir);
+    }
+    free(dir);
+
+    size_t tmp_len = strlen(history->path) + 5;
+    char* tmp_path = malloc(tmp_len);
+    if (!tmp_path) return false;
+    snprintf(tmp_path, tmp_len, "%s.tmp", history->path);
+
+    FILE* f = fopen(tmp_path, "w");
+    if (!f) {
+        log_warning("Cannot write job history: %s", tmp_path);
+        free(tmp_path);
+        return false;
+    }
+
+    bool ok = true;
+    for (int i = 0; i < history->capacity && ok; i++) {
+        HistoryEntry* e = &history->entries[i];
+        if (e->digest) {
+            ok = fprintf(f, "%s %.3f %d\n", e->digest, e->seconds, e->samples) > 0;
+        }
+    }
+    if (fclose(f) != 0) ok = false;
+
+    /* Replace atomically so a crash never leaves a truncated history */
+#ifdef _WIN32
+    if (ok) remove(history->path);
+#endif
+    if (ok && rename(tmp_path, history->path) != 0) ok = false;
+    if (!ok) {
+        log_warning("Failed to save job history: %s", history->path);
+        remove(tmp_path);
+    } else {
+        history->dirty = false;
+    }
+
+    free(tmp_path);
+    return ok;
+}
+
+/* ============================================================
+ * History API
+ * ============================================================ */
+
+JobHistory* job_history_create(const char* path) {
+    JobHistory* history = calloc(1, sizeof(JobHistory));
+    if (!history) {
+        log_error("Failed to allocate job history");
+        return NULL;
+    }
+
+    history->capacity = HISTORY_INITIAL_CAPACITY;
+    history->entries = calloc((size_t)history->capacity, sizeof(HistoryEntry));
+    if (!history->entries) {
+        free(history);
+        return NULL;
+    }
+
+    if (path) {
+        history->path = strdup(path);
+        load_history(history);
+    }
+
+    return history;
+}
+
+void job_history_free(JobHistory* history) {
+    if (!history) return;
+
+    for (int i = 0; i < history->capacity; i++) {
+        free(history->entries[i].digest);
+    }
+    free(history->entries);
+    free(history->path);
+    free(history);
+}
+
+double job_history_estimate(JobHistory* history, const char* digest) {
+    if (!history || !digest) return -1.0;
+
+    HistoryEntry* slot = find_slot(history->entries, history->capacity, digest);
+    return slot->digest ? slot->seconds : -1.0;
+}
+
+void job_history_record(JobHistory* history, const char* digest, double duration_sec) {
+    if (!history || !digest || duration_sec < 0 || strlen(digest) > HISTORY_MAX_DIGEST) {
+        return;
+    }
+
+    HistoryEntry* slot = find_slot(history->entries, history->capacity, digest);
+    if (slot->digest) {
+        slot->seconds += HISTORY_EWMA_ALPHA * (duration_sec - slot->seconds);
+        slot->samples++;
+    } else {
+        put_entry(history, digest, duration_sec, 1);
+    }
+    history->dirty = true;
+}
+
+double job_history_mean(JobHistory* history) {
+    if (!history || history->count == 0) return -1.0;
+
+    double total = 0.0;
+    for (int i = 0; i < history->capacity; i++) {
+        if (history->entries[i].digest) {
+            total += history->entries[i].seconds;
+        }
+    }
+    return total / history->count;
+}
+
+int job_history_count(JobHistory* history) {
+    return history ? history->count : 0;
+}
+
+char* job_history_digest(const DistributedJob* job) {
+    if (!job) return NULL;
+
+    const char* parts[64];
+    int n = 0;
+    char type[16];
+    snprintf(type, sizeof(type), "type=%d", (int)job->type);
+    parts[n++] = type;
+
+    if (job->type == JOB_TYPE_COMPILE && job->source_file) {
+        /* Identical content compiles identically, wherever the file lives */
+        char* content = artifact_hash_file(job->source_file);
+        parts[n++] = content ? content : job->source_file;
+        parts[n++] = job->compiler;
+        for (size_t i = 0; i < job->arg_count && n < 64; i++) {
+            parts[n++] = job->compiler_args[i];
+        }
+        char* digest = artifact_hash_combined(parts, n);
+        free(content);
+        return digest;
+    }
+
+    parts[n++] = job->build_command;
+    parts[n++] = job->output_file;
+    parts[n++] = job->project_archive_hash;
+    return artifact_hash_combined(parts, n);
+}
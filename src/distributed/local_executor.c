@@ -0,0 +1,831 @@
+/**
+ * @file local_executor.c
+ * @brief Local multi-process compile fan-out implementation
+ *
+ * One event loop owns every compiler process: it polls their output pipes
+ * and, while starved, the jobserver token pipe. The first compile runs on
+ * the implicit token every make client holds; each further one needs a
+ * token read from the pipe, written back when the compile is reaped.
+ *
+ * Cache lookups work in two steps, as a translation unit's object depends
+ * on headers that the compilation database does not list. The source and
+ * flags key a manifest naming the headers the last compile read (taken
+ * from its depfile); the object is keyed on that plus every header's
+ * content. Entries without a depfile are compiled but never cached.
+ */
+
+#include "cyxmake/distributed/local_executor.h"
+#include "cyxmake/logger.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <direct.h>
+#define le_mkdir(path) _mkdir(path)
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#define le_mkdir(path) mkdir(path, 0755)
+extern char** environ;
+#endif
+
+/* ============================================================
+ * Constants
+ * ============================================================ */
+
+#define MAX_TASK_OUTPUT (64 * 1024)      /* Compiler output kept per compile */
+#define MAX_RESULT_OUTPUT (1024 * 1024)  /* Matches build_execute_command */
+#define DIGEST_BUCKETS 4096
+#define MAX_JOBSERVER_TOKENS 4096
+
+/* ============================================================
+ * Internal Structures
+ * ============================================================ */
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t cap;
+    size_t limit;
+    bool truncated;
+} TextBuffer;
+
+/* Content digest of a header, computed once per run */
+typedef struct HeaderDigest {
+    char* path;
+    char* digest;                 /* NULL if unreadable */
+    struct HeaderDigest* next;
+} HeaderDigest;
+
+typedef struct {
+    const CompileCommand* cmd;
+    char* output_path;            /* Absolute object path (NULL if unknown) */
+    char* depfile_path;           /* Absolute depfile path (NULL if none) */
+    char* source_key;             /* Source and flags key (NULL = uncached) */
+    TextBuffer output;
+#ifndef _WIN32
+    pid_t pid;
+    int out_fd;
+    char token;
+    bool holds_token;
+#endif
+} CompileTask;
+
+typedef struct {
+    const LocalExecutorConfig* config;
+    LocalBuildStats stats;
+    TextBuffer log;
+    HeaderDigest* digests[DIGEST_BUCKETS];
+    bool stop;
+} LocalRun;
+
+/* ============================================================
+ * Helpers
+ * ============================================================ */
+
+static double wall_time_sec(void) {
+#ifdef _WIN32
+    return (double)GetTickCount64() / 1000.0;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+static void text_append(TextBuffer* buf, const char* data, size_t len) {
+    if (buf->truncated) return;
+    if (buf->len + len > buf->limit) {
+        len = buf->limit - buf->len;
+        buf->truncated = true;
+    }
+    if (buf->len + len + 1 > buf->cap) {
+        size_t cap = buf->cap ? buf->cap : 1024;
+        while (cap < buf->len + len + 1) cap *= 2;
+        char* data_new = realloc(buf->data, cap);
+        if (!data_new) {
+            buf->truncated = true;
+            return;
+        }
+        buf->data = data_new;
+        buf->cap = cap;
+    }
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+    buf->data[buf->len] = '\0';
+}
+
+static void text_append_str(TextBuffer* buf, const char* s) {
+    text_append(buf, s, strlen(s));
+}
+
+static bool is_absolute(const char* path) {
+    return path[0] == '/' || path[0] == '\\' || (path[0] && path[1] == ':');
+}
+
+static char* resolve_path(const char* dir, const char* path) {
+    if (is_absolute(path) || !dir || !dir[0]) return strdup(path);
+    size_t len = strlen(dir) + strlen(path) + 2;
+    char* full = malloc(len);
+    if (full) snprintf(full, len, "%s/%s", dir, path);
+    return full;
+}
+
+/* Create every missing directory above a file */
+static void make_parent_dirs(const char* file_path) {
+    char* copy = strdup(file_path);
+    if (!copy) return;
+
+    for (char* p = copy + 1; *p; p++) {
+        if (*p == '/' || *p == '\\') {
+            char saved = *p;
+            *p = '\0';
+            le_mkdir(copy);
+            *p = saved;
+        }
+    }
+    free(copy);
+}
+
+static char* read_file(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+
+    TextBuffer buf = { .limit = SIZE_MAX };
+    char chunk[8192];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        text_append(&buf, chunk, n);
+    }
+    fclose(f);
+
+    if (!buf.data) buf.data = calloc(1, 1);
+    return buf.data;
+}
+
+/* ============================================================
+ * Depfiles and Cache Keys
+ * ============================================================ */
+
+/* Depfile the compile writes: -MF's value, else the object with .d */
+static char* find_depfile(const CompileCommand* cmd, const char* output_path) {
+    bool writes_depfile = false;
+    for (int i = 0; i < cmd->depfile_arg_count; i++) {
+        const char* arg = cmd->depfile_args[i];
+        if (strcmp(arg, "-MF") == 0 && i + 1 < cmd->depfile_arg_count) {
+            return resolve_path(cmd->directory, cmd->depfile_args[i + 1]);
+        }
+        if (strncmp(arg, "-MF", 3) == 0 && arg[3]) {
+            return resolve_path(cmd->directory, arg + 3);
+        }
+        if (strcmp(arg, "-MD") == 0 || strcmp(arg, "-MMD") == 0) {
+            writes_depfile = true;
+        }
+    }
+    if (!writes_depfile || !output_path) return NULL;
+
+    size_t len = strlen(output_path);
+    const char* dot = strrchr(output_path, '.');
+    const char* slash = strrchr(output_path, '/');
+    if (dot && (!slash || dot > slash)) len = (size_t)(dot - output_path);
+
+    char* path = malloc(len + 3);
+    if (path) {
+        memcpy(path, output_path, len);
+        memcpy(path + len, ".d", 3);
+    }
+    return path;
+}
+
+/**
+ * Extract the prerequisites of a depfile's first rule as a list of
+ * newline-terminated absolute paths (escaped spaces and "$$" undone)
+ */
+static char* depfile_prerequisites(const char* depfile_path, const char* dir) {
+    char* text = read_file(depfile_path);
+    if (!text) return NULL;
+
+    /* Prerequisites start after the first ':' that ends the target;
+     * a drive letter's colon is followed by a path separator */
+    char* p = text;
+    while (*p && !(*p == ':' && (p[1] == ' ' || p[1] == '\t' ||
+                                 p[1] == '\n' || p[1] == '\r' || !p[1]))) {
+        p++;
+    }
+    if (!*p) {
+        free(text);
+        return NULL;
+    }
+    p++;
+
+    TextBuffer list = { .limit = SIZE_MAX };
+    char word[4096];
+    size_t wlen = 0;
+
+    for (;; p++) {
+        char c = *p;
+        bool end_word = false;
+        bool end_rule = false;
+
+        if (c == '\\' && (p[1] == '\n' || (p[1] == '\r' && p[2] == '\n'))) {
+            p += p[1] == '\r' ? 2 : 1;
+            end_word = true;
+        } else if (c == '\\' && p[1] == ' ') {
+            if (wlen < sizeof(word) - 1) word[wlen++] = ' ';
+            p++;
+        } else if (c == '$' && p[1] == '$') {
+            if (wlen < sizeof(word) - 1) word[wlen++] = '$';
+            p++;
+        } else if (c == ' ' || c == '\t' || c == '\r') {
+            end_word = true;
+        } else if (c == '\n' || c == '\0') {
+            end_word = true;
+            end_rule = true;
+        } else if (wlen < sizeof(word) - 1) {
+            word[wlen++] = c;
+        }
+
+        if (end_word && wlen > 0) {
+            word[wlen] = '\0';
+            char* full = resolve_path(dir, word);
+            if (full) {
+                text_append_str(&list, full);
+                text_append(&list, "\n", 1);
+                free(full);
+            }
+            wlen = 0;
+        }
+        if (end_rule) break;
+    }
+
+    free(text);
+    if (!list.data) list.data = calloc(1, 1);
+    return list.data;
+}
+
+static const char* header_digest(LocalRun* run, const char* path) {
+    uint64_t h = 14695981039346656037ull;
+    for (const unsigned char* p = (const unsigned char*)path; *p; p++) {
+        h = (h ^ *p) * 1099511628211ull;
+    }
+    size_t bucket = (size_t)(h % DIGEST_BUCKETS);
+
+    for (HeaderDigest* d = run->digests[bucket]; d; d = d->next) {
+        if (strcmp(d->path, path) == 0) return d->digest;
+    }
+
+    HeaderDigest* d = calloc(1, sizeof(HeaderDigest));
+    if (!d) return NULL;
+    d->path = strdup(path);
+    if (!d->path) {
+        free(d);
+        return NULL;
+    }
+    d->digest = artifact_hash_file(path);
+    d->next = run->digests[bucket];
+    run->digests[bucket] = d;
+    return d->digest;
+}
+
+/* Key of the manifest listing a source's headers */
+static char* manifest_key(const char* source_key) {
+    const char* parts[] = { "manifest", source_key };
+    return artifact_hash_combined(parts, 2);
+}
+
+/* Object key: source key plus the content of every listed header */
+static char* object_key(LocalRun* run, const char* source_key, const char* headers) {
+    TextBuffer combined = { .limit = SIZE_MAX };
+    text_append_str(&combined, source_key);
+
+    bool ok = true;
+    const char* line = headers;
+    while (ok && *line) {
+        const char* nl = strchr(line, '\n');
+        size_t len = nl ? (size_t)(nl - line) : strlen(line);
+        char path[4096];
+        if (len > 0 && len < sizeof(path)) {
+            memcpy(path, line, len);
+            path[len] = '\0';
+            const char* digest = header_digest(run, path);
+            if (digest) {
+                text_append(&combined, "|", 1);
+                text_append_str(&combined, digest);
+            } else {
+                ok = false;  /* A header is gone; the manifest is stale */
+            }
+        }
+        line = nl ? nl + 1 : line + len;
+    }
+
+    char* key = NULL;
+    if (ok && combined.data && !combined.truncated) {
+        key = artifact_hash_buffer(combined.data, combined.len);
+    }
+    free(combined.data);
+    return key;
+}
+
+/* Restore a task's object from the cache */
+static bool restore_from_cache(LocalRun* run, CompileTask* task) {
+    ArtifactCache* cache = run->config->cache;
+
+    char* mkey = manifest_key(task->source_key);
+    ArtifactEntry* manifest = mkey ? artifact_cache_get(cache, mkey) : NULL;
+    char* headers = manifest && manifest->cached_path ?
+                    read_file(manifest->cached_path) : NULL;
+    free(mkey);
+
+    char* okey = headers ? object_key(run, task->source_key, headers) : NULL;
+    free(headers);
+
+    bool restored = okey &&
+                    artifact_cache_lookup(cache, okey) == CACHE_HIT_LOCAL &&
+                    artifact_cache_retrieve(cache, okey, task->output_path);
+    free(okey);
+    return restored;
+}
+
+/* Store a finished compile's object under its header manifest */
+static void store_in_cache(LocalRun* run, CompileTask* task) {
+    ArtifactCache* cache = run->config->cache;
+
+    char* headers = depfile_prerequisites(task->depfile_path, task->cmd->directory);
+    if (!headers || !headers[0]) {
+        free(headers);
+        return;
+    }
+
+    char* mkey = manifest_key(task->source_key);
+    char* okey = object_key(run, task->source_key, headers);
+    if (mkey && okey &&
+        artifact_cache_store_buffer(cache, mkey, headers, strlen(headers), ARTIFACT_OTHER)) {
+        artifact_cache_store(cache, okey, task->output_path, ARTIFACT_OBJECT_FILE, NULL);
+    }
+
+    free(mkey);
+    free(okey);
+    free(headers);
+}
+
+/* ============================================================
+ * Tasks
+ * ============================================================ */
+
+static void task_free(CompileTask* task) {
+    if (!task) return;
+    free(task->output_path);
+    free(task->depfile_path);
+    free(task->source_key);
+    free(task->output.data);
+    free(task);
+}
+
+/**
+ * Prepare an entry: resolve paths, create the object's directory and try
+ * the cache
+ * @return Task to run, or NULL if the object was restored
+ */
+static CompileTask* task_prepare(LocalRun* run, const CompileCommand* cmd) {
+    CompileTask* task = calloc(1, sizeof(CompileTask));
+    if (!task) return NULL;
+
+    task->cmd = cmd;
+    task->output.limit = MAX_TASK_OUTPUT;
+#ifndef _WIN32
+    task->out_fd = -1;
+#endif
+
+    if (cmd->output) {
+        task->output_path = resolve_path(cmd->directory, cmd->output);
+        if (task->output_path) make_parent_dirs(task->output_path);
+    }
+
+    if (run->config->cache && task->output_path) {
+        task->depfile_path = find_depfile(cmd, task->output_path);
+        if (task->depfile_path) {
+            task->source_key = compile_db_cache_key(cmd);
+        }
+    }
+
+    if (task->source_key && restore_from_cache(run, task)) {
+        run->stats.cache_hits++;
+        log_debug("Restored from cache: %s", cmd->file);
+        task_free(task);
+        return NULL;
+    }
+    return task;
+}
+
+static void task_finish(LocalRun* run, CompileTask* task, int exit_code) {
+    if (exit_code == 0) {
+        run->stats.compiled++;
+        if (task->source_key) store_in_cache(run, task);
+        if (task->output.len > 0) {
+            text_append(&run->log, task->output.data, task->output.len);
+        }
+        return;
+    }
+
+    run->stats.failed++;
+    log_error("Compile failed (exit %d): %s", exit_code, task->cmd->file);
+
+    char* command = compile_db_command_line(task->cmd);
+    text_append_str(&run->log, "FAILED: ");
+    text_append_str(&run->log, task->cmd->file);
+    text_append(&run->log, "\n", 1);
+    if (command) {
+        text_append_str(&run->log, command);
+        text_append(&run->log, "\n", 1);
+        free(command);
+    }
+    if (task->output.len > 0) {
+        text_append(&run->log, task->output.data, task->output.len);
+    }
+    if (task->output.truncated) {
+        text_append_str(&run->log, "[output truncated]\n");
+    }
+
+    if (!run->config->keep_going) run->stop = true;
+}
+
+#ifndef _WIN32
+
+/* ============================================================
+ * Jobserver
+ * ============================================================ */
+
+typedef struct {
+    int read_fd;
+    int write_fd;
+    bool owned;                   /* Pipe created by this run */
+    char* makeflags;              /* MAKEFLAGS exported to compiles */
+} Jobserver;
+
+static bool fd_valid(int fd) {
+    return fd >= 0 && fcntl(fd, F_GETFD) != -1;
+}
+
+/**
+ * Join the jobserver described by MAKEFLAGS: "--jobserver-auth=R,W"
+ * (make 4.2+), "--jobserver-fds=R,W" (older) or "--jobserver-auth=fifo:PATH"
+ * (make 4.4)
+ */
+static bool jobserver_join(Jobserver* js) {
+    const char* flags = getenv("MAKEFLAGS");
+    if (!flags) return false;
+
+    const char* auth = NULL;
+    const char* options[] = { "--jobserver-auth=", "--jobserver-fds=" };
+    for (int i = 0; i < 2 && !auth; i++) {
+        const char* found = strstr(flags, options[i]);
+        if (found) auth = found + strlen(options[i]);
+    }
+    if (!auth) return false;
+
+    if (strncmp(auth, "fifo:", 5) == 0) {
+        char path[1024];
+        size_t len = strcspn(auth + 5, " \t");
+        if (len == 0 || len >= sizeof(path)) return false;
+        memcpy(path, auth + 5, len);
+        path[len] = '\0';
+        int fd = open(path, O_RDWR | O_CLOEXEC);
+        if (fd < 0) return false;
+        js->read_fd = js->write_fd = fd;
+        return true;
+    }
+
+    int r, w;
+    if (sscanf(auth, "%d,%d", &r, &w) != 2 || !fd_valid(r) || !fd_valid(w)) {
+        return false;
+    }
+    js->read_fd = r;
+    js->write_fd = w;
+    return true;
+}
+
+/* Create a token pipe for tokens - 1 extra compiles */
+static bool jobserver_create(Jobserver* js, int tokens) {
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+
+    /* Fill before anyone reads; a full pipe would otherwise block us */
+    int extra = tokens - 1 < MAX_JOBSERVER_TOKENS ? tokens - 1 : MAX_JOBSERVER_TOKENS;
+    for (int i = 0; i < extra; i++) {
+        if (write(fds[1], "+", 1) != 1) break;
+    }
+
+    js->read_fd = fds[0];
+    js->write_fd = fds[1];
+    js->owned = true;
+
+    char flags[128];
+    snprintf(flags, sizeof(flags), "MAKEFLAGS= -j%d --jobserver-auth=%d,%d",
+             tokens, fds[0], fds[1]);
+    js->makeflags = strdup(flags);
+    return true;
+}
+
+static void jobserver_close(Jobserver* js) {
+    if (js->owned) {
+        close(js->read_fd);
+        close(js->write_fd);
+    } else if (js->read_fd == js->write_fd && js->read_fd >= 0) {
+        close(js->read_fd);  /* Our own open of a fifo */
+    }
+    free(js->makeflags);
+}
+
+/* Take a token if one is ready. Another client of a shared pipe can win
+ * the race after poll, so this may block until a token comes back. */
+static bool jobserver_try_acquire(Jobserver* js, char* token) {
+    struct pollfd pfd = { .fd = js->read_fd, .events = POLLIN };
+    if (poll(&pfd, 1, 0) <= 0 || !(pfd.revents & POLLIN)) return false;
+    return read(js->read_fd, token, 1) == 1;
+}
+
+static void jobserver_release(Jobserver* js, char token) {
+    while (write(js->write_fd, &token, 1) < 0 && errno == EINTR) {
+    }
+}
+
+/* Environment for compiles: ours with MAKEFLAGS replaced if we own the pipe */
+static char** build_environment(const Jobserver* js) {
+    int count = 0;
+    while (environ[count]) count++;
+
+    char** envp = calloc((size_t)count + 2, sizeof(char*));
+    if (!envp) return NULL;
+
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        if (js->makeflags && strncmp(environ[i], "MAKEFLAGS=", 10) == 0) continue;
+        envp[n++] = environ[i];
+    }
+    if (js->makeflags) envp[n++] = js->makeflags;
+    envp[n] = NULL;
+    return envp;
+}
+
+/* ============================================================
+ * Process Pool
+ * ============================================================ */
+
+static bool task_spawn(CompileTask* task, char* const* envp) {
+    char* command = compile_db_command_line(task->cmd);
+    if (!command) return false;
+
+    /* Close-on-exec so other compiles never hold this pipe open */
+    int fds[2];
+    if (pipe(fds) != 0) {
+        free(command);
+        return false;
+    }
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        free(command);
+        return false;
+    }
+
+    if (pid == 0) {
+        dup2(fds[1], STDOUT_FILENO);
+        dup2(fds[1], STDERR_FILENO);
+        if (task->cmd->directory[0] && chdir(task->cmd->directory) != 0) _exit(127);
+        char* argv[] = { "sh", "-c", command, NULL };
+        execve("/bin/sh", argv, envp);
+        _exit(127);
+    }
+
+    close(fds[1]);
+    free(command);
+    task->pid = pid;
+    task->out_fd = fds[0];
+    log_debug("Compiling %s (pid %d)", task->cmd->file, (int)pid);
+    return true;
+}
+
+/* Drain a compile's output; reap it at end of file */
+static bool task_read(CompileTask* task, int* exit_code) {
+    char chunk[4096];
+    ssize_t n = read(task->out_fd, chunk, sizeof(chunk));
+    if (n > 0) {
+        text_append(&task->output, chunk, (size_t)n);
+        return false;
+    }
+    if (n < 0 && errno == EINTR) return false;
+
+    close(task->out_fd);
+    task->out_fd = -1;
+
+    int status = 0;
+    while (waitpid(task->pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    *exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    return true;
+}
+
+static void run_pool(LocalRun* run, const CompileDatabase* db, int max_jobs) {
+    Jobserver js = { .read_fd = -1, .write_fd = -1 };
+    if (run->config->join_jobserver && jobserver_join(&js)) {
+        run->stats.shared_jobserver = true;
+        log_debug("Joined inherited jobserver");
+    } else if (!jobserver_create(&js, max_jobs)) {
+        log_warning("Failed to create jobserver pipe, compiling serially");
+        max_jobs = 1;
+    }
+
+    char** envp = build_environment(&js);
+    CompileTask** running = calloc((size_t)max_jobs, sizeof(CompileTask*));
+    struct pollfd* pfds = calloc((size_t)max_jobs + 1, sizeof(struct pollfd));
+    if (!envp || !running || !pfds) {
+        log_error("Out of memory starting local compiles");
+        run->stop = true;
+    }
+
+    int total = compile_db_count(db);
+    int next = 0;
+    int active = 0;
+    CompileTask* staged = NULL;
+
+    while (true) {
+        /* Stage the next entry that the cache cannot satisfy */
+        while (!run->stop && !staged && next < total) {
+            staged = task_prepare(run, compile_db_get(db, next++));
+        }
+
+        /* The first compile runs on the implicit token */
+        while (staged && !run->stop && active < max_jobs) {
+            char token = 0;
+            bool needs_token = active > 0;
+            if (needs_token && !jobserver_try_acquire(&js, &token)) break;
+
+            if (!task_spawn(staged, envp)) {
+                if (needs_token) jobserver_release(&js, token);
+                task_finish(run, staged, 127);
+                task_free(staged);
+            } else {
+                staged->token = token;
+                staged->holds_token = needs_token;
+                running[active++] = staged;
+                if (active > run->stats.peak_running) run->stats.peak_running = active;
+            }
+            staged = NULL;
+            while (!run->stop && !staged && next < total) {
+                staged = task_prepare(run, compile_db_get(db, next++));
+            }
+        }
+
+        if (active == 0) {
+            if (staged && !run->stop) continue;
+            break;
+        }
+
+        /* Wait for compiler output, exits, or a token while starved */
+        int nfds = 0;
+        for (int i = 0; i < active; i++) {
+            pfds[nfds++] = (struct pollfd){ .fd = running[i]->out_fd, .events = POLLIN };
+        }
+        bool want_token = staged && !run->stop && active < max_jobs;
+        if (want_token) {
+            pfds[nfds++] = (struct pollfd){ .fd = js.read_fd, .events = POLLIN };
+        }
+        bool drain = false;
+        if (poll(pfds, (nfds_t)nfds, -1) < 0) {
+            if (errno == EINTR) continue;
+            log_error("poll failed: %s", strerror(errno));
+            run->stop = true;
+            drain = true;  /* Blocking reads until every compile is reaped */
+        }
+
+        for (int i = active - 1; i >= 0; i--) {
+            if (!drain && !(pfds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+            CompileTask* task = running[i];
+            int exit_code = 0;
+            if (!task_read(task, &exit_code)) continue;
+
+            if (task->holds_token) jobserver_release(&js, task->token);
+            task_finish(run, task, exit_code);
+            task_free(task);
+            running[i] = running[--active];
+        }
+    }
+
+    task_free(staged);
+    free(pfds);
+    free(running);
+    free(envp);
+    jobserver_close(&js);
+}
+
+#else /* _WIN32 */
+
+/* No jobserver or fork on Windows: compile one entry at a time */
+static void run_pool(LocalRun* run, const CompileDatabase* db, int max_jobs) {
+    (void)max_jobs;
+    int total = compile_db_count(db);
+
+    for (int i = 0; i < total && !run->stop; i++) {
+        CompileTask* task = task_prepare(run, compile_db_get(db, i));
+        if (!task) continue;
+
+        char* command = compile_db_command_line(task->cmd);
+        BuildResult* result = command ?
+            build_execute_command(command, task->cmd->directory) : NULL;
+        free(command);
+
+        run->stats.peak_running = 1;
+        if (result && result->stdout_output) {
+            text_append_str(&task->output, result->stdout_output);
+        }
+        task_finish(run, task, result ? result->exit_code : -1);
+        build_result_free(result);
+        task_free(task);
+    }
+}
+
+#endif /* _WIN32 */
+
+/* ============================================================
+ * Public API
+ * ============================================================ */
+
+LocalExecutorConfig local_executor_config_default(void) {
+    LocalExecutorConfig config = {
+        .max_jobs = 0,
+        .cache = NULL,
+        .keep_going = false,
+        .join_jobserver = true
+    };
+    return config;
+}
+
+BuildResult* local_execute_compile_db(const CompileDatabase* db,
+                                      const LocalExecutorConfig* config,
+                                      LocalBuildStats* stats) {
+    if (!db) return NULL;
+
+    LocalExecutorConfig defaults = local_executor_config_default();
+    if (!config) config = &defaults;
+
+    LocalRun* run = calloc(1, sizeof(LocalRun));
+    BuildResult* result = calloc(1, sizeof(BuildResult));
+    if (!run || !result) {
+        free(run);
+        free(result);
+        return NULL;
+    }
+    run->config = config;
+    run->log.limit = MAX_RESULT_OUTPUT - 1;
+    run->stats.total = compile_db_count(db);
+
+    int max_jobs = config->max_jobs > 0 ? config->max_jobs : build_get_cpu_cores();
+    log_info("Compiling %d translation units locally (%d processes)",
+             run->stats.total, max_jobs);
+
+    double start = wall_time_sec();
+    run_pool(run, db, max_jobs);
+
+    run->stats.not_run = run->stats.total - run->stats.compiled -
+                         run->stats.cache_hits - run->stats.failed;
+
+    log_info("Local compile: %d compiled, %d from cache, %d failed, %d not run "
+             "(peak %d processes)",
+             run->stats.compiled, run->stats.cache_hits, run->stats.failed,
+             run->stats.not_run, run->stats.peak_running);
+
+    result->duration_sec = wall_time_sec() - start;
+    result->exit_code = run->stats.failed > 0 ? 1 : 0;
+    result->success = run->stats.failed == 0 && run->stats.not_run == 0;
+    result->stdout_output = run->log.data ? run->log.data : strdup("");
+    result->stderr_output = strdup("");
+
+    for (int i = 0; i < DIGEST_BUCKETS; i++) {
+        HeaderDigest* d = run->digests[i];
+        while (d) {
+            HeaderDigest* next = d->next;
+            free(d->path);
+            free(d->digest);
+            free(d);
+            d = next;
+        }
+    }
+
+    if (stats) *stats = run->stats;
+    free(run);
+    return result;
+}
@@ -303,12 +303,9 @@ static int callback_cyxmake_client(struct lws* wsi, enum lws_callback_reasons re
 
             /* Check for final fragment */
             if (lws_is_final_fragment(wsi)) {
-                /* Null-terminate the buffer for parsing */
-                client->rx_buffer[client->rx_buffer_used] = '\0';
-
-                /* Parse complete message */
-                ProtocolMessage* msg = protocol_message_deserialize(
-                    (const char*)client->rx_buffer);
+                /* Parse complete message (binary frame or JSON text) */
+                ProtocolMessage* msg = protocol_message_decode(
+                    client->rx_buffer, client->rx_buffer_used);
 
                 if (msg) {
                     if (client->callbacks.on_message) {
@@ -321,6 +318,15 @@ static int callback_cyxmake_client(struct lws* wsi, enum lws_callback_reasons re
                 }
 
                 client->rx_buffer_used = 0;
+
+                /* Give back memory grown for an unusually large message */
+                if (client->rx_buffer_size > CLIENT_RX_BUFFER_SIZE) {
+                    uint8_t* small = realloc(client->rx_buffer, CLIENT_RX_BUFFER_SIZE);
+                    if (small) {
+                        client->rx_buffer = small;
+                        client->rx_buffer_size = CLIENT_RX_BUFFER_SIZE;
+                    }
+                }
             }
             break;
         }
@@ -329,8 +335,11 @@ static int callback_cyxmake_client(struct lws* wsi, enum lws_callback_reasons re
             /* Send pending messages */
             MessageQueueEntry* entry = dequeue_message(client);
             if (entry) {
+                enum lws_write_protocol mode =
+                    protocol_frame_is_binary(entry->data + LWS_PRE, entry->len) ?
+                    LWS_WRITE_BINARY : LWS_WRITE_TEXT;
                 int written = lws_write(wsi, entry->data + LWS_PRE,
-                                        entry->len, LWS_WRITE_TEXT);
+                                        entry->len, mode);
                 if (written < (int)entry->len) {
                     log_error("Failed to send message: wrote %d of %zu bytes",
                               written, entry->len);
@@ -679,17 +688,17 @@ bool network_client_send(NetworkClient* client, ProtocolMessage* msg) {
         return false;
     }
 
-    /* Serialize message */
-    char* json = protocol_message_serialize(msg);
-    if (!json) {
-        log_error("Failed to serialize message");
+    /* Encode message */
+    size_t len = 0;
+    uint8_t* frame = protocol_message_encode(msg, client->config.wire_format, &len);
+    if (!frame) {
+        log_error("Failed to encode message");
         return false;
     }
 
     /* Queue for sending */
-    size_t json_len = strlen(json);
-    bool result = queue_message(client, (const uint8_t*)json, json_len);
-    free(json);
+    bool result = queue_message(client, frame, len);
+    free(frame);
 
     return result;
 }
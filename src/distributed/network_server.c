@@ -24,7 +24,17 @@
 
 #define MAX_CONNECTIONS 256
 #define RX_BUFFER_SIZE (64 * 1024)
-#define MAX_MESSAGE_SIZE (64 * 1024 * 1024)  /* 64 MB */
+#define MAX_MESSAGE_SIZE (8 * 1024 * 1024)  /* 8 MB; files stream as FILE_CHUNKs */
+#define TX_RING_INITIAL 16                  /* Initial send ring slots (power of two) */
+#define TX_FRAME_RETAIN (64 * 1024)         /* Larger slot buffers are freed once sent */
+#define TX_HIGH_WATER (1024 * 1024)         /* Queued bytes before backpressure */
+
+/* Send ring slot; buffer keeps LWS_PRE headroom and is reused across frames */
+typedef struct {
+    unsigned char* buf;           /* LWS_PRE + cap bytes */
+    size_t cap;                   /* Payload capacity */
+    size_t len;                   /* Queued payload length */
+} TxFrame;
 
 /* Per-connection data */
 typedef struct ConnectionData {
@@ -37,12 +47,15 @@ typedef struct ConnectionData {
     char* rx_buffer;
     size_t rx_len;
     size_t rx_capacity;
-
-    /* Send queue */
-    char** tx_queue;
-    size_t* tx_sizes;
-    size_t tx_count;
-    size_t tx_capacity;
+    bool rx_discard;              /* Dropping the rest of an oversized message */
+
+    /* Send ring */
+    TxFrame* tx_ring;
+    size_t tx_head;               /* Oldest queued frame */
+    size_t tx_count;              /* Queued frames */
+    size_t tx_capacity;           /* Ring slots (power of two) */
+    size_t tx_bytes;              /* Queued payload bytes */
+    bool tx_congested;            /* Above high-water mark, reported to on_backpressure */
     MutexHandle tx_mutex;
 
     /* Latency tracking */
@@ -87,7 +100,10 @@ static ConnectionData* find_connection_by_wsi(NetworkServer* server, struct lws*
 static ConnectionData* create_connection(NetworkServer* server, struct lws* wsi);
 static void destroy_connection(NetworkServer* server, ConnectionData* conn);
 static void* server_thread_func(void* arg);
-static bool queue_message(ConnectionData* conn, const char* data, size_t len);
+static bool queue_message(ConnectionData* conn, const uint8_t* data, size_t len);
+static bool queue_protocol_message(ConnectionData* conn, const ProtocolMessage* msg);
+static size_t tx_high_water(ConnectionData* conn);
+static void tx_pop(ConnectionData* conn);
 
 /* ============================================================
  * Protocol Definition
@@ -156,20 +172,30 @@ static int callback_cyxmake(struct lws* wsi, enum lws_callback_reasons reason,
             /* Handle fragmented messages */
             size_t remaining = lws_remaining_packet_payload(wsi);
             bool is_final = lws_is_final_fragment(wsi);
+            bool complete = is_final && remaining == 0;
+
+            if (conn->rx_discard) {
+                if (complete) conn->rx_discard = false;
+                break;
+            }
 
             /* Grow buffer if needed */
             size_t needed = conn->rx_len + len;
             if (needed > conn->rx_capacity) {
+                size_t limit = server->config.max_message_size > 0 ?
+                               server->config.max_message_size : MAX_MESSAGE_SIZE;
                 size_t new_cap = conn->rx_capacity * 2;
                 if (new_cap < needed) new_cap = needed;
-                if (new_cap > MAX_MESSAGE_SIZE) {
-                    /* Message too large */
+                if (new_cap > limit) new_cap = limit;
+                if (needed > limit) {
+                    /* Message too large: drop it through its final fragment */
                     if (server->callbacks.on_error) {
                         server->callbacks.on_error((NetworkConnection*)conn,
                                                    "Message exceeds maximum size",
                                                    server->callbacks.user_data);
                     }
                     conn->rx_len = 0;
+                    conn->rx_discard = !complete;
                     break;
                 }
                 char* new_buf = (char*)realloc(conn->rx_buffer, new_cap);
@@ -183,11 +209,10 @@ static int callback_cyxmake(struct lws* wsi, enum lws_callback_reasons reason,
             conn->rx_len += len;
 
             /* Process complete message */
-            if (is_final && remaining == 0) {
-                conn->rx_buffer[conn->rx_len] = '\0';
-
-                /* Parse and deliver message */
-                ProtocolMessage* msg = protocol_message_deserialize(conn->rx_buffer);
+            if (complete) {
+                /* Parse and deliver message (binary frame or JSON text) */
+                ProtocolMessage* msg = protocol_message_decode(
+                    (const uint8_t*)conn->rx_buffer, conn->rx_len);
                 if (msg && server->callbacks.on_message) {
                     server->callbacks.on_message((NetworkConnection*)conn, msg,
                                                  server->callbacks.user_data);
@@ -195,6 +220,15 @@ static int callback_cyxmake(struct lws* wsi, enum lws_callback_reasons reason,
                 protocol_message_free(msg);
 
                 conn->rx_len = 0;
+
+                /* Give back memory grown for an unusually large message */
+                if (conn->rx_capacity > RX_BUFFER_SIZE) {
+                    char* small = (char*)realloc(conn->rx_buffer, RX_BUFFER_SIZE);
+                    if (small) {
+                        conn->rx_buffer = small;
+                        conn->rx_capacity = RX_BUFFER_SIZE;
+                    }
+                }
             }
             break;
         }
@@ -202,42 +236,46 @@ static int callback_cyxmake(struct lws* wsi, enum lws_callback_reasons reason,
         case LWS_CALLBACK_SERVER_WRITEABLE: {
             if (!conn) break;
 
+            bool failed = false;
+            bool relieved = false;
+
             mutex_lock(&conn->tx_mutex);
 
+            /* lws allows one write per WRITEABLE callback; ask again for the rest */
             if (conn->tx_count > 0) {
-                /* Send first message in queue */
-                char* data = conn->tx_queue[0];
-                size_t size = conn->tx_sizes[0];
-
-                /* Allocate buffer with LWS_PRE padding */
-                unsigned char* buf = (unsigned char*)malloc(LWS_PRE + size);
-                if (buf) {
-                    memcpy(buf + LWS_PRE, data, size);
-                    int written = lws_write(wsi, buf + LWS_PRE, size, LWS_WRITE_TEXT);
-                    free(buf);
-
-                    if (written < (int)size) {
-                        /* Write failed */
-                        mutex_unlock(&conn->tx_mutex);
-                        return -1;
-                    }
+                TxFrame* frame = &conn->tx_ring[conn->tx_head];
+                unsigned char* data = frame->buf + LWS_PRE;
+
+                enum lws_write_protocol mode =
+                    protocol_frame_is_binary(data, frame->len) ?
+                    LWS_WRITE_BINARY : LWS_WRITE_TEXT;
+                int written = lws_write(wsi, data, frame->len, mode);
+                if (written < (int)frame->len) {
+                    failed = true;
+                } else {
+                    tx_pop(conn);
                 }
+            }
 
-                /* Remove from queue */
-                free(data);
-                memmove(conn->tx_queue, conn->tx_queue + 1,
-                        (conn->tx_count - 1) * sizeof(char*));
-                memmove(conn->tx_sizes, conn->tx_sizes + 1,
-                        (conn->tx_count - 1) * sizeof(size_t));
-                conn->tx_count--;
-
-                /* Schedule more writes if needed */
-                if (conn->tx_count > 0) {
-                    lws_callback_on_writable(wsi);
-                }
+            if (!failed && conn->tx_count > 0) {
+                lws_callback_on_writable(wsi);
+            }
+
+            if (conn->tx_congested && conn->tx_bytes <= tx_high_water(conn) / 2) {
+                conn->tx_congested = false;
+                relieved = true;
             }
 
             mutex_unlock(&conn->tx_mutex);
+
+            if (failed) {
+                return -1;
+            }
+
+            if (relieved && server && server->callbacks.on_backpressure) {
+                server->callbacks.on_backpressure((NetworkConnection*)conn, false,
+                                                  server->callbacks.user_data);
+            }
             break;
         }
 
@@ -304,11 +342,9 @@ static ConnectionData* create_connection(NetworkServer* server, struct lws* wsi)
     conn->rx_buffer = (char*)malloc(conn->rx_capacity);
     conn->rx_len = 0;
 
-    /* Initialize send queue */
-    conn->tx_capacity = 16;
-    conn->tx_queue = (char**)calloc(conn->tx_capacity, sizeof(char*));
-    conn->tx_sizes = (size_t*)calloc(conn->tx_capacity, sizeof(size_t));
-    conn->tx_count = 0;
+    /* Initialize send ring (slot buffers are allocated on first use) */
+    conn->tx_capacity = TX_RING_INITIAL;
+    conn->tx_ring = (TxFrame*)calloc(conn->tx_capacity, sizeof(TxFrame));
     mutex_init(&conn->tx_mutex);
 
     /* Add to server's connection list */
@@ -339,11 +375,10 @@ static void destroy_connection(NetworkServer* server, ConnectionData* conn) {
     free(conn->rx_buffer);
 
     mutex_lock(&conn->tx_mutex);
-    for (size_t i = 0; i < conn->tx_count; i++) {
-        free(conn->tx_queue[i]);
+    for (size_t i = 0; i < conn->tx_capacity; i++) {
+        free(conn->tx_ring[i].buf);
     }
-    free(conn->tx_queue);
-    free(conn->tx_sizes);
+    free(conn->tx_ring);
     mutex_unlock(&conn->tx_mutex);
     mutex_destroy(&conn->tx_mutex);
 
@@ -365,41 +400,134 @@ static ConnectionData* find_connection_by_wsi(NetworkServer* server, struct lws*
     return NULL;
 }
 
-static bool queue_message(ConnectionData* conn, const char* data, size_t len) {
-    mutex_lock(&conn->tx_mutex);
+/* ============================================================
+ * Send Ring
+ * ============================================================ */
 
-    /* Grow queue if needed */
-    if (conn->tx_count >= conn->tx_capacity) {
+static size_t tx_high_water(ConnectionData* conn) {
+    size_t limit = conn->server ? conn->server->config.tx_high_water : 0;
+    return limit > 0 ? limit : TX_HIGH_WATER;
+}
+
+/* Reserve the next free slot with room for len payload bytes (tx_mutex held) */
+static TxFrame* tx_reserve(ConnectionData* conn, size_t len) {
+    if (!conn->tx_ring) return NULL;
+
+    if (conn->tx_count == conn->tx_capacity) {
+        /* Grow and unwrap so the oldest frame is at index 0 */
         size_t new_cap = conn->tx_capacity * 2;
-        char** new_queue = (char**)realloc(conn->tx_queue, new_cap * sizeof(char*));
-        size_t* new_sizes = (size_t*)realloc(conn->tx_sizes, new_cap * sizeof(size_t));
-        if (!new_queue || !new_sizes) {
-            mutex_unlock(&conn->tx_mutex);
-            return false;
+        TxFrame* ring = (TxFrame*)calloc(new_cap, sizeof(TxFrame));
+        if (!ring) return NULL;
+
+        for (size_t i = 0; i < conn->tx_capacity; i++) {
+            ring[i] = conn->tx_ring[(conn->tx_head + i) & (conn->tx_capacity - 1)];
         }
-        conn->tx_queue = new_queue;
-        conn->tx_sizes = new_sizes;
+        free(conn->tx_ring);
+        conn->tx_ring = ring;
+        conn->tx_head = 0;
         conn->tx_capacity = new_cap;
     }
 
-    /* Copy message to queue */
-    char* copy = (char*)malloc(len + 1);
-    if (!copy) {
+    TxFrame* frame = &conn->tx_ring[(conn->tx_head + conn->tx_count) &
+                                    (conn->tx_capacity - 1)];
+    if (frame->cap < len) {
+        /* Round up so slightly larger frames don't reallocate every time */
+        size_t cap = (len + 255) & ~(size_t)255;
+        unsigned char* buf = (unsigned char*)malloc(LWS_PRE + cap);
+        if (!buf) return NULL;
+        free(frame->buf);
+        frame->buf = buf;
+        frame->cap = cap;
+    }
+
+    return frame;
+}
+
+/* Publish a filled slot; returns true if this crossed the high-water mark */
+static bool tx_commit(ConnectionData* conn, TxFrame* frame, size_t len) {
+    frame->len = len;
+    conn->tx_count++;
+    conn->tx_bytes += len;
+
+    if (!conn->tx_congested && conn->tx_bytes > tx_high_water(conn)) {
+        conn->tx_congested = true;
+        return true;
+    }
+    return false;
+}
+
+/* Retire the oldest frame, keeping its buffer unless it is oversized */
+static void tx_pop(ConnectionData* conn) {
+    TxFrame* frame = &conn->tx_ring[conn->tx_head];
+
+    conn->tx_bytes -= frame->len;
+    frame->len = 0;
+    if (frame->cap > TX_FRAME_RETAIN) {
+        free(frame->buf);
+        frame->buf = NULL;
+        frame->cap = 0;
+    }
+
+    conn->tx_head = (conn->tx_head + 1) & (conn->tx_capacity - 1);
+    conn->tx_count--;
+}
+
+static void notify_congested(ConnectionData* conn) {
+    NetworkServer* server = conn->server;
+
+    if (server && server->callbacks.on_backpressure) {
+        server->callbacks.on_backpressure((NetworkConnection*)conn, true,
+                                          server->callbacks.user_data);
+    }
+}
+
+static bool queue_message(ConnectionData* conn, const uint8_t* data, size_t len) {
+    mutex_lock(&conn->tx_mutex);
+
+    TxFrame* frame = tx_reserve(conn, len);
+    if (!frame) {
         mutex_unlock(&conn->tx_mutex);
         return false;
     }
-    memcpy(copy, data, len);
-    copy[len] = '\0';
 
-    conn->tx_queue[conn->tx_count] = copy;
-    conn->tx_sizes[conn->tx_count] = len;
-    conn->tx_count++;
+    memcpy(frame->buf + LWS_PRE, data, len);
+    bool congested = tx_commit(conn, frame, len);
 
     mutex_unlock(&conn->tx_mutex);
 
     /* Request write callback */
     lws_callback_on_writable(conn->wsi);
 
+    if (congested) {
+        notify_congested(conn);
+    }
+
+    return true;
+}
+
+/* Encode a binary frame straight into the ring slot, avoiding a copy */
+static bool queue_protocol_message(ConnectionData* conn, const ProtocolMessage* msg) {
+    size_t len = protocol_message_encoded_size(msg);
+
+    mutex_lock(&conn->tx_mutex);
+
+    TxFrame* frame = tx_reserve(conn, len);
+    if (!frame ||
+        protocol_message_encode_to(msg, frame->buf + LWS_PRE, frame->cap) != len) {
+        mutex_unlock(&conn->tx_mutex);
+        return false;
+    }
+
+    bool congested = tx_commit(conn, frame, len);
+
+    mutex_unlock(&conn->tx_mutex);
+
+    lws_callback_on_writable(conn->wsi);
+
+    if (congested) {
+        notify_congested(conn);
+    }
+
     return true;
 }
 
@@ -574,12 +702,17 @@ bool network_server_send(NetworkServer* server,
         msg->sender_id = strdup(server->server_id);
     }
 
-    /* Serialize message */
-    char* json = protocol_message_serialize(msg);
-    if (!json) return false;
+    if (server->config.wire_format == PROTO_WIRE_BINARY) {
+        return queue_protocol_message(conn, msg);
+    }
+
+    /* Encode message */
+    size_t len = 0;
+    uint8_t* frame = protocol_message_encode(msg, server->config.wire_format, &len);
+    if (!frame) return false;
 
-    bool result = queue_message(conn, json, strlen(json));
-    free(json);
+    bool result = queue_message(conn, frame, len);
+    free(frame);
 
     return result;
 }
@@ -592,23 +725,23 @@ void network_server_broadcast(NetworkServer* server, ProtocolMessage* msg) {
         msg->sender_id = strdup(server->server_id);
     }
 
-    /* Serialize once */
-    char* json = protocol_message_serialize(msg);
-    if (!json) return;
-    size_t len = strlen(json);
+    /* Encode once */
+    size_t len = 0;
+    uint8_t* frame = protocol_message_encode(msg, server->config.wire_format, &len);
+    if (!frame) return;
 
     mutex_lock(&server->connections_mutex);
 
     for (int i = 0; i < server->connection_count; i++) {
         ConnectionData* conn = server->connections[i];
         if (conn->state == TRANSPORT_CONNECTED) {
-            queue_message(conn, json, len);
+            queue_message(conn, frame, len);
         }
     }
 
     mutex_unlock(&server->connections_mutex);
 
-    free(json);
+    free(frame);
 }
 
 int network_server_get_connection_count(NetworkServer* server) {
@@ -621,6 +754,19 @@ int network_server_get_connection_count(NetworkServer* server) {
     return count;
 }
 
+size_t network_server_get_pending_bytes(NetworkServer* server,
+                                         NetworkConnection* connection) {
+    if (!server || !connection) return 0;
+
+    ConnectionData* conn = (ConnectionData*)connection;
+
+    mutex_lock(&conn->tx_mutex);
+    size_t bytes = conn->tx_bytes;
+    mutex_unlock(&conn->tx_mutex);
+
+    return bytes;
+}
+
 void network_server_close_connection(NetworkServer* server,
                                       NetworkConnection* connection,
                                       const char* reason) {
@@ -659,6 +805,8 @@ NetworkConfig* network_config_create_default(void) {
     config->max_message_size = MAX_MESSAGE_SIZE;
     config->rx_buffer_size = RX_BUFFER_SIZE;
     config->tx_buffer_size = RX_BUFFER_SIZE;
+    config->tx_high_water = TX_HIGH_WATER;
+    config->wire_format = PROTO_WIRE_BINARY;
 
     return config;
 }
@@ -723,6 +871,13 @@ int network_server_get_connection_count(NetworkServer* server) {
     return 0;
 }
 
+size_t network_server_get_pending_bytes(NetworkServer* server,
+                                         NetworkConnection* connection) {
+    (void)server;
+    (void)connection;
+    return 0;
+}
+
 void network_server_close_connection(NetworkServer* server,
                                       NetworkConnection* connection,
                                       const char* reason) {
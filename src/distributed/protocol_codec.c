@@ -41,6 +41,7 @@ static const char* message_type_names[] = {
     [PROTO_MSG_JOB_FAILED] = "JOB_FAILED",
     [PROTO_MSG_JOB_CANCEL] = "JOB_CANCEL",
     [PROTO_MSG_JOB_CANCELLED] = "JOB_CANCELLED",
+    [PROTO_MSG_JOB_BATCH] = "JOB_BATCH",
     [PROTO_MSG_ARTIFACT_REQUEST] = "ARTIFACT_REQUEST",
     [PROTO_MSG_ARTIFACT_RESPONSE] = "ARTIFACT_RESPONSE",
     [PROTO_MSG_ARTIFACT_PUSH] = "ARTIFACT_PUSH",
@@ -64,6 +65,81 @@ static ProtocolMessageType message_type_from_name(const char* name) {
     return PROTO_MSG_ERROR;
 }
 
+/* ============================================================
+ * Base64 (binary data in JSON frames)
+ * ============================================================ */
+
+static const char base64_table[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static char* base64_encode(const uint8_t* data, size_t len) {
+    size_t out_len = 4 * ((len + 2) / 3);
+    char* out = (char*)malloc(out_len + 1);
+    if (!out) return NULL;
+
+    size_t i = 0, j = 0;
+    while (i < len) {
+        uint32_t a = data[i++];
+        uint32_t b = i < len ? data[i++] : 0;
+        uint32_t c = i < len ? data[i++] : 0;
+        uint32_t triple = (a << 16) | (b << 8) | c;
+
+        out[j++] = base64_table[(triple >> 18) & 0x3F];
+        out[j++] = base64_table[(triple >> 12) & 0x3F];
+        out[j++] = base64_table[(triple >> 6) & 0x3F];
+        out[j++] = base64_table[triple & 0x3F];
+    }
+
+    size_t mod = len % 3;
+    if (mod > 0) {
+        out[out_len - 1] = '=';
+        if (mod == 1) out[out_len - 2] = '=';
+    }
+
+    out[out_len] = '\0';
+    return out;
+}
+
+static int base64_value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+static uint8_t* base64_decode(const char* text, size_t* out_size) {
+    size_t len = strlen(text);
+    if (len == 0 || len % 4 != 0) return NULL;
+
+    size_t size = len / 4 * 3;
+    if (text[len - 1] == '=') size--;
+    if (text[len - 2] == '=') size--;
+
+    uint8_t* out = (uint8_t*)malloc(size > 0 ? size : 1);
+    if (!out) return NULL;
+
+    size_t j = 0;
+    for (size_t i = 0; i < len; i += 4) {
+        uint32_t triple = 0;
+        for (int k = 0; k < 4; k++) {
+            int v = text[i + k] == '=' ? 0 : base64_value(text[i + k]);
+            if (v < 0) {
+                free(out);
+                return NULL;
+            }
+            triple = (triple << 6) | (uint32_t)v;
+        }
+        if (j < size) out[j++] = (uint8_t)(triple >> 16);
+        if (j < size) out[j++] = (uint8_t)(triple >> 8);
+        if (j < size) out[j++] = (uint8_t)triple;
+    }
+
+    *out_size = size;
+    return out;
+}
+
 /* ============================================================
  * UUID Generation
  * ============================================================ */
@@ -204,7 +280,7 @@ char* protocol_message_serialize(const ProtocolMessage* msg) {
     if (msg->sender_id) cJSON_AddStringToObject(root, "sender", msg->sender_id);
 
     /* Add payload as nested object if it's valid JSON */
-    if (msg->payload_json && msg->payload_size > 0) {
+    if (msg->payload_json && msg->payload_json[0] != '\0') {
         cJSON* payload = cJSON_Parse(msg->payload_json);
         if (payload) {
             cJSON_AddItemToObject(root, "payload", payload);
@@ -214,12 +290,15 @@ char* protocol_message_serialize(const ProtocolMessage* msg) {
         }
     }
 
-    /* Binary data is base64 encoded */
+    /* Binary data is base64 encoded (binary frames carry it raw) */
     if (msg->binary_data && msg->binary_size > 0) {
-        /* Simple base64 encoding - in production use a proper base64 library */
         cJSON_AddNumberToObject(root, "binary_size", (double)msg->binary_size);
-        /* For now, just indicate binary data exists */
         cJSON_AddBoolToObject(root, "has_binary", true);
+        char* encoded = base64_encode(msg->binary_data, msg->binary_size);
+        if (encoded) {
+            cJSON_AddStringToObject(root, "binary", encoded);
+            free(encoded);
+        }
     }
 
     char* json = cJSON_PrintUnformatted(root);
@@ -227,10 +306,8 @@ char* protocol_message_serialize(const ProtocolMessage* msg) {
     return json;
 }
 
-ProtocolMessage* protocol_message_deserialize(const char* json) {
-    if (!json) return NULL;
-
-    cJSON* root = cJSON_Parse(json);
+static ProtocolMessage* deserialize_json(const char* json, size_t len) {
+    cJSON* root = cJSON_ParseWithLength(json, len);
     if (!root) return NULL;
 
     ProtocolMessage* msg = (ProtocolMessage*)calloc(1, sizeof(ProtocolMessage));
@@ -284,10 +361,223 @@ ProtocolMessage* protocol_message_deserialize(const char* json) {
         }
     }
 
+    /* Parse binary data */
+    cJSON* binary_item = cJSON_GetObjectItem(root, "binary");
+    if (cJSON_IsString(binary_item)) {
+        msg->binary_data = base64_decode(binary_item->valuestring, &msg->binary_size);
+    }
+
     cJSON_Delete(root);
     return msg;
 }
 
+ProtocolMessage* protocol_message_deserialize(const char* json) {
+    if (!json) return NULL;
+    return deserialize_json(json, strlen(json));
+}
+
+/* ============================================================
+ * Binary Frame Encoding
+ * ============================================================ */
+
+static void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void put_u64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint16_t get_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+static uint64_t get_u64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+static size_t frame_string_len(const char* s) {
+    return s ? strlen(s) : 0;
+}
+
+/* payload_size is optional for callers that set payload_json directly */
+static size_t frame_payload_len(const ProtocolMessage* msg) {
+    if (!msg->payload_json) return 0;
+    return msg->payload_size > 0 ? msg->payload_size : strlen(msg->payload_json);
+}
+
+static char* frame_read_string(const uint8_t* p, size_t len) {
+    if (len == 0) return NULL;
+    char* s = (char*)malloc(len + 1);
+    if (!s) return NULL;
+    memcpy(s, p, len);
+    s[len] = '\0';
+    return s;
+}
+
+size_t protocol_message_encoded_size(const ProtocolMessage* msg) {
+    if (!msg) return 0;
+
+    return PROTO_FRAME_HEADER_SIZE
+         + frame_string_len(msg->id)
+         + frame_string_len(msg->correlation_id)
+         + frame_string_len(msg->sender_id)
+         + frame_payload_len(msg)
+         + (msg->binary_data ? msg->binary_size : 0);
+}
+
+size_t protocol_message_encode_to(const ProtocolMessage* msg,
+                                  uint8_t* buffer,
+                                  size_t capacity) {
+    if (!msg || !buffer) return 0;
+
+    size_t id_len = frame_string_len(msg->id);
+    size_t corr_len = frame_string_len(msg->correlation_id);
+    size_t sender_len = frame_string_len(msg->sender_id);
+    size_t payload_len = frame_payload_len(msg);
+    size_t binary_len = msg->binary_data ? msg->binary_size : 0;
+
+    if (id_len > UINT16_MAX || corr_len > UINT16_MAX || sender_len > UINT16_MAX ||
+        payload_len > UINT32_MAX || binary_len > UINT32_MAX) {
+        return 0;
+    }
+
+    size_t total = protocol_message_encoded_size(msg);
+    if (total > capacity) return 0;
+
+    uint8_t* p = buffer;
+    memcpy(p, PROTO_FRAME_MAGIC, 4);
+    p[4] = PROTO_FRAME_VERSION;
+    p[5] = (uint8_t)msg->type;
+    p[6] = payload_len > 0 ? PROTO_PAYLOAD_JSON : PROTO_PAYLOAD_NONE;
+    p[7] = 0;
+    put_u64(p + 8, msg->timestamp);
+    put_u16(p + 16, (uint16_t)id_len);
+    put_u16(p + 18, (uint16_t)corr_len);
+    put_u16(p + 20, (uint16_t)sender_len);
+    put_u16(p + 22, 0);
+    put_u32(p + 24, (uint32_t)payload_len);
+    put_u32(p + 28, (uint32_t)binary_len);
+    p += PROTO_FRAME_HEADER_SIZE;
+
+    if (id_len) { memcpy(p, msg->id, id_len); p += id_len; }
+    if (corr_len) { memcpy(p, msg->correlation_id, corr_len); p += corr_len; }
+    if (sender_len) { memcpy(p, msg->sender_id, sender_len); p += sender_len; }
+    if (payload_len) { memcpy(p, msg->payload_json, payload_len); p += payload_len; }
+    if (binary_len) { memcpy(p, msg->binary_data, binary_len); p += binary_len; }
+
+    return total;
+}
+
+uint8_t* protocol_message_encode(const ProtocolMessage* msg,
+                                 ProtocolWireFormat format,
+                                 size_t* out_size) {
+    if (!msg) return NULL;
+
+    if (format == PROTO_WIRE_JSON) {
+        char* json = protocol_message_serialize(msg);
+        if (json && out_size) *out_size = strlen(json);
+        return (uint8_t*)json;
+    }
+
+    size_t size = protocol_message_encoded_size(msg);
+    uint8_t* frame = (uint8_t*)malloc(size);
+    if (!frame) return NULL;
+
+    if (protocol_message_encode_to(msg, frame, size) != size) {
+        free(frame);
+        return NULL;
+    }
+
+    if (out_size) *out_size = size;
+    return frame;
+}
+
+bool protocol_frame_is_binary(const uint8_t* data, size_t size) {
+    return data && size >= PROTO_FRAME_HEADER_SIZE &&
+           memcmp(data, PROTO_FRAME_MAGIC, 4) == 0;
+}
+
+static ProtocolMessage* decode_binary(const uint8_t* data, size_t size) {
+    if (data[4] != PROTO_FRAME_VERSION) return NULL;
+
+    size_t id_len = get_u16(data + 16);
+    size_t corr_len = get_u16(data + 18);
+    size_t sender_len = get_u16(data + 20);
+    size_t payload_len = get_u32(data + 24);
+    size_t binary_len = get_u32(data + 28);
+
+    /* Validate lengths against the frame before touching the body */
+    size_t body = id_len + corr_len + sender_len;
+    if (body > size - PROTO_FRAME_HEADER_SIZE ||
+        payload_len > size - PROTO_FRAME_HEADER_SIZE - body ||
+        binary_len != size - PROTO_FRAME_HEADER_SIZE - body - payload_len) {
+        return NULL;
+    }
+
+    ProtocolMessage* msg = (ProtocolMessage*)calloc(1, sizeof(ProtocolMessage));
+    if (!msg) return NULL;
+
+    msg->type = (ProtocolMessageType)data[5];
+    msg->timestamp = get_u64(data + 8);
+
+    const uint8_t* p = data + PROTO_FRAME_HEADER_SIZE;
+    msg->id = frame_read_string(p, id_len);
+    p += id_len;
+    msg->correlation_id = frame_read_string(p, corr_len);
+    p += corr_len;
+    msg->sender_id = frame_read_string(p, sender_len);
+    p += sender_len;
+
+    if (payload_len > 0) {
+        msg->payload_json = frame_read_string(p, payload_len);
+        msg->payload_size = msg->payload_json ? payload_len : 0;
+        p += payload_len;
+    }
+
+    if (binary_len > 0) {
+        msg->binary_data = (uint8_t*)malloc(binary_len);
+        if (!msg->binary_data) {
+            protocol_message_free(msg);
+            return NULL;
+        }
+        memcpy(msg->binary_data, p, binary_len);
+        msg->binary_size = binary_len;
+    }
+
+    return msg;
+}
+
+ProtocolMessage* protocol_message_decode(const uint8_t* data, size_t size) {
+    if (!data || size == 0) return NULL;
+
+    if (protocol_frame_is_binary(data, size)) {
+        return decode_binary(data, size);
+    }
+    return deserialize_json((const char*)data, size);
+}
+
+const char* protocol_wire_format_name(ProtocolWireFormat format) {
+    switch (format) {
+        case PROTO_WIRE_BINARY: return "binary";
+        case PROTO_WIRE_JSON: return "json";
+        default: return "unknown";
+    }
+}
+
 /* ============================================================
  * Job Serialization
  * ============================================================ */
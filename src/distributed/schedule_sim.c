@@ -0,0 +1,510 @@
+/**
+ * @file schedule_sim.c
+ * @brief Critical-path analysis and build schedule simulation implementation
+ *
+ * The simulator is a discrete-event list scheduler: whenever a worker slot
+ * is free and a job is ready, the policy picks the job and the worker.
+ * Worker speed scales job duration, so heterogeneous farms can be modelled.
+ */
+
+#include "cyxmake/distributed/schedule_sim.h"
+#include "cyxmake/logger.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+/* ============================================================
+ * Critical Path
+ * ============================================================ */
+
+/* Build successor lists in CSR form; caller frees both arrays */
+static bool build_successors(const SimJob* jobs, int count,
+                             int** out_start, int** out_succ) {
+    int* start = calloc((size_t)count + 1, sizeof(int));
+    if (!start) return false;
+
+    int edges = 0;
+    for (int j = 0; j < count; j++) {
+        for (int d = 0; d < jobs[j].dep_count; d++) {
+            start[jobs[j].deps[d] + 1]++;
+            edges++;
+        }
+    }
+    for (int j = 0; j < count; j++) {
+        start[j + 1] += start[j];
+    }
+
+    int* succ = malloc(sizeof(int) * (size_t)(edges > 0 ? edges : 1));
+    int* fill = calloc((size_t)count, sizeof(int));
+    if (!succ || !fill) {
+        free(start);
+        free(succ);
+        free(fill);
+        return false;
+    }
+
+    for (int j = 0; j < count; j++) {
+        for (int d = 0; d < jobs[j].dep_count; d++) {
+            int dep = jobs[j].deps[d];
+            succ[start[dep] + fill[dep]++] = j;
+        }
+    }
+
+    free(fill);
+    *out_start = start;
+    *out_succ = succ;
+    return true;
+}
+
+bool schedule_critical_path(const SimJob* jobs, int count, double* out_levels) {
+    if (!jobs || !out_levels || count <= 0) return false;
+
+    int* succ_start = NULL;
+    int* succ = NULL;
+    int* pending = malloc(sizeof(int) * (size_t)count);
+    int* order = malloc(sizeof(int) * (size_t)count);
+    if (!pending || !order || !build_successors(jobs, count, &succ_start, &succ)) {
+        free(pending);
+        free(order);
+        return false;
+    }
+
+    for (int j = 0; j < count; j++) {
+        pending[j] = jobs[j].dep_count;
+    }
+
+    /* Topological order (Kahn) */
+    int ordered = 0;
+    for (int j = 0; j < count; j++) {
+        if (pending[j] == 0) order[ordered++] = j;
+    }
+    for (int i = 0; i < ordered; i++) {
+        int j = order[i];
+        for (int s = succ_start[j]; s < succ_start[j + 1]; s++) {
+            if (--pending[succ[s]] == 0) order[ordered++] = succ[s];
+        }
+    }
+
+    /* Bottom levels in reverse topological order */
+    memset(out_levels, 0, sizeof(double) * (size_t)count);
+    for (int i = ordered - 1; i >= 0; i--) {
+        int j = order[i];
+        double longest = 0.0;
+        for (int s = succ_start[j]; s < succ_start[j + 1]; s++) {
+            if (out_levels[succ[s]] > longest) longest = out_levels[succ[s]];
+        }
+        out_levels[j] = jobs[j].duration_sec + longest;
+    }
+
+    free(succ_start);
+    free(succ);
+    free(pending);
+    free(order);
+    return ordered == count;
+}
+
+/* ============================================================
+ * Event Heap
+ * ============================================================ */
+
+typedef struct {
+    double key;                   /* Larger pops first */
+    int job;
+    int worker;
+} HeapItem;
+
+typedef struct {
+    HeapItem* items;
+    int count;
+} Heap;
+
+static bool heap_before(const HeapItem* a, const HeapItem* b) {
+    if (a->key != b->key) return a->key > b->key;
+    return a->job < b->job;
+}
+
+static void heap_push(Heap* heap, HeapItem item) {
+    int i = heap->count++;
+    heap->items[i] = item;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!heap_before(&heap->items[i], &heap->items[parent])) break;
+        HeapItem tmp = heap->items[i];
+        heap->items[i] = heap->items[parent];
+        heap->items[parent] = tmp;
+        i = parent;
+    }
+}
+
+static HeapItem heap_pop(Heap* heap) {
+    HeapItem top = heap->items[0];
+    heap->items[0] = heap->items[--heap->count];
+
+    int i = 0;
+    for (;;) {
+        int best = i;
+        int l = 2 * i + 1, r = l + 1;
+        if (l < heap->count && heap_before(&heap->items[l], &heap->items[best])) best = l;
+        if (r < heap->count && heap_before(&heap->items[r], &heap->items[best])) best = r;
+        if (best == i) break;
+        HeapItem tmp = heap->items[i];
+        heap->items[i] = heap->items[best];
+        heap->items[best] = tmp;
+        i = best;
+    }
+    return top;
+}
+
+/* ============================================================
+ * Simulation
+ * ============================================================ */
+
+static int pick_worker(const SimWorker* workers, int worker_count, const int* free_slots,
+                       SimPolicy policy, int* rr_next) {
+    int chosen = -1;
+
+    switch (policy) {
+        case SIM_POLICY_ROUND_ROBIN:
+            for (int i = 0; i < worker_count; i++) {
+                int w = (*rr_next + i) % worker_count;
+                if (free_slots[w] > 0) {
+                    chosen = w;
+                    *rr_next = (w + 1) % worker_count;
+                    break;
+                }
+            }
+            break;
+
+        case SIM_POLICY_CRITICAL_PATH:
+            for (int w = 0; w < worker_count; w++) {
+                if (free_slots[w] > 0 &&
+                    (chosen < 0 || workers[w].speed < workers[chosen].speed)) {
+                    chosen = w;
+                }
+            }
+            break;
+
+        case SIM_POLICY_FIFO:
+        default:
+            for (int w = 0; w < worker_count; w++) {
+                if (free_slots[w] > 0) {
+                    chosen = w;
+                    break;
+                }
+            }
+            break;
+    }
+
+    return chosen;
+}
+
+double schedule_simulate(const SimJob* jobs, int count,
+                         const SimWorker* workers, int worker_count,
+                         SimPolicy policy) {
+    if (!jobs || count <= 0) return 0.0;
+    if (!workers || worker_count <= 0) return -1.0;
+
+    double* levels = malloc(sizeof(double) * (size_t)count);
+    int* remaining = malloc(sizeof(int) * (size_t)count);
+    int* free_slots = malloc(sizeof(int) * (size_t)worker_count);
+    Heap ready = { malloc(sizeof(HeapItem) * (size_t)count), 0 };
+    Heap events = { malloc(sizeof(HeapItem) * (size_t)count), 0 };
+    int* succ_start = NULL;
+    int* succ = NULL;
+    double makespan = -1.0;
+
+    if (!levels || !remaining || !free_slots || !ready.items || !events.items ||
+        !build_successors(jobs, count, &succ_start, &succ)) {
+        goto cleanup;
+    }
+
+    if (policy == SIM_POLICY_CRITICAL_PATH &&
+        !schedule_critical_path(jobs, count, levels)) {
+        goto cleanup;
+    }
+
+    int total_slots = 0;
+    for (int w = 0; w < worker_count; w++) {
+        free_slots[w] = workers[w].slots > 0 ? workers[w].slots : 0;
+        total_slots += free_slots[w];
+    }
+    if (total_slots == 0) goto cleanup;
+
+    /* FIFO and round-robin take ready jobs in submission order */
+    for (int j = 0; j < count; j++) {
+        remaining[j] = jobs[j].dep_count;
+        if (remaining[j] == 0) {
+            HeapItem item = { policy == SIM_POLICY_CRITICAL_PATH ? levels[j] : -(double)j, j, -1 };
+            heap_push(&ready, item);
+        }
+    }
+
+    double now = 0.0;
+    int done = 0;
+    int rr_next = 0;
+
+    while (done < count) {
+        while (ready.count > 0) {
+            int w = pick_worker(workers, worker_count, free_slots, policy, &rr_next);
+            if (w < 0) break;
+
+            HeapItem item = heap_pop(&ready);
+            double speed = workers[w].speed > 0 ? workers[w].speed : 1.0;
+            HeapItem finish = { -(now + jobs[item.job].duration_sec * speed), item.job, w };
+            heap_push(&events, finish);
+            free_slots[w]--;
+        }
+
+        if (events.count == 0) goto cleanup;  /* Cycle: nothing can run */
+
+        HeapItem finished = heap_pop(&events);
+        now = -finished.key;
+        free_slots[finished.worker]++;
+        done++;
+
+        int j = finished.job;
+        for (int s = succ_start[j]; s < succ_start[j + 1]; s++) {
+            int next = succ[s];
+            if (--remaining[next] == 0) {
+                HeapItem item = { policy == SIM_POLICY_CRITICAL_PATH ?
+                                  levels[next] : -(double)next, next, -1 };
+                heap_push(&ready, item);
+            }
+        }
+    }
+
+    makespan = now;
+
+cleanup:
+    free(levels);
+    free(remaining);
+    free(succ_start);
+    free(free_slots);
+    free(ready.items);
+    free(events.items);
+    free(succ);
+    return makespan;
+}
+
+double schedule_lower_bound(const SimJob* jobs, int count,
+                            const SimWorker* workers, int worker_count) {
+    if (!jobs || count <= 0 || !workers || worker_count <= 0) return 0.0;
+
+    double* levels = malloc(sizeof(double) * (size_t)count);
+    if (!levels) return 0.0;
+    schedule_critical_path(jobs, count, levels);
+
+    double critical = 0.0, work = 0.0;
+    for (int j = 0; j < count; j++) {
+        if (levels[j] > critical) critical = levels[j];
+        work += jobs[j].duration_sec;
+    }
+    free(levels);
+
+    double fastest = 0.0, capacity = 0.0;
+    for (int w = 0; w < worker_count; w++) {
+        if (workers[w].slots <= 0) continue;
+        double speed = workers[w].speed > 0 ? workers[w].speed : 1.0;
+        if (fastest == 0.0 || speed < fastest) fastest = speed;
+        capacity += workers[w].slots / speed;
+    }
+    if (capacity == 0.0) return 0.0;
+
+    double by_path = critical * fastest;
+    double by_work = work / capacity;
+    return by_path > by_work ? by_path : by_work;
+}
+
+/* ============================================================
+ * Build Traces
+ * ============================================================ */
+
+typedef struct {
+    char* job_id;
+    char* deps;                   /* Comma-separated IDs, resolved later */
+} TraceLine;
+
+/* Read a whole line of any length; caller frees */
+static char* read_line(FILE* f) {
+    size_t cap = 256, len = 0;
+    char* line = malloc(cap);
+    if (!line) return NULL;
+
+    while (fgets(line + len, (int)(cap - len), f)) {
+        len += strlen(line + len);
+        if (len > 0 && line[len - 1] == '\n') {
+            line[--len] = '\0';
+            if (len > 0 && line[len - 1] == '\r') line[--len] = '\0';
+            return line;
+        }
+        if (len + 1 < cap) break;  /* EOF without newline */
+        char* grown = realloc(line, cap * 2);
+        if (!grown) {
+            free(line);
+            return NULL;
+        }
+        line = grown;
+        cap *= 2;
+    }
+
+    if (len == 0) {
+        free(line);
+        return NULL;
+    }
+    return line;
+}
+
+static uint32_t id_hash(const char* s) {
+    uint32_t h = 2166136261u;     /* FNV-1a */
+    while (*s) {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* Index of job_id in the id table, or -1 */
+static int lookup_id(const int* table, uint32_t mask, const TraceLine* lines, const char* id) {
+    for (uint32_t i = id_hash(id) & mask; table[i] >= 0; i = (i + 1) & mask) {
+        if (strcmp(lines[table[i]].job_id, id) == 0) return table[i];
+    }
+    return -1;
+}
+
+SimTrace* schedule_trace_load(const char* path, const char* build_id) {
+    if (!path) return NULL;
+
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        log_error("Cannot open build trace: %s", path);
+        return NULL;
+    }
+
+    SimTrace* trace = calloc(1, sizeof(SimTrace));
+    TraceLine* lines = NULL;
+    int capacity = 0;
+    if (!trace) {
+        fclose(f);
+        return NULL;
+    }
+
+    char* line;
+    while ((line = read_line(f)) != NULL) {
+        char* build = strtok(line, " \t");
+        char* job_id = strtok(NULL, " \t");
+        char* seconds = strtok(NULL, " \t");
+        char* deps = strtok(NULL, " \t");
+
+        if (!build || build[0] == '#' || !job_id || !seconds) {
+            free(line);
+            continue;
+        }
+        if (!trace->build_id) {
+            if (build_id && strcmp(build, build_id) != 0) {
+                free(line);
+                continue;
+            }
+            trace->build_id = strdup(build);
+        } else if (strcmp(build, trace->build_id) != 0) {
+            free(line);
+            continue;
+        }
+
+        if (trace->count == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            TraceLine* grown_lines = realloc(lines, sizeof(TraceLine) * (size_t)capacity);
+            SimJob* grown_jobs = realloc(trace->jobs, sizeof(SimJob) * (size_t)capacity);
+            if (grown_lines) lines = grown_lines;
+            if (grown_jobs) trace->jobs = grown_jobs;
+            if (!grown_lines || !grown_jobs) {
+                free(line);
+                break;
+            }
+        }
+
+        lines[trace->count].job_id = strdup(job_id);
+        lines[trace->count].deps = deps ? strdup(deps) : NULL;
+        memset(&trace->jobs[trace->count], 0, sizeof(SimJob));
+        trace->jobs[trace->count].duration_sec = atof(seconds);
+        trace->count++;
+        free(line);
+    }
+    fclose(f);
+
+    if (trace->count == 0) {
+        log_error("No jobs for build %s in trace %s", build_id ? build_id : "(any)", path);
+        free(lines);
+        schedule_trace_free(trace);
+        return NULL;
+    }
+
+    /* Resolve dependency IDs to indices */
+    uint32_t table_size = 1;
+    while (table_size < (uint32_t)trace->count * 2) table_size <<= 1;
+    int* table = malloc(sizeof(int) * table_size);
+    if (table) {
+        memset(table, 0xff, sizeof(int) * table_size);
+        for (int j = 0; j < trace->count; j++) {
+            if (!lines[j].job_id) continue;
+            uint32_t i = id_hash(lines[j].job_id) & (table_size - 1);
+            while (table[i] >= 0) i = (i + 1) & (table_size - 1);
+            table[i] = j;
+        }
+    }
+
+    int dropped = 0;
+    for (int j = 0; j < trace->count; j++) {
+        char* deps = lines[j].deps;
+        if (!deps || !table) continue;
+
+        int n = 1;
+        for (char* p = deps; *p; p++) {
+            if (*p == ',') n++;
+        }
+        trace->jobs[j].deps = malloc(sizeof(int) * (size_t)n);
+        if (!trace->jobs[j].deps) continue;
+
+        for (char* id = strtok(deps, ","); id; id = strtok(NULL, ",")) {
+            int dep = lookup_id(table, table_size - 1, lines, id);
+            if (dep >= 0 && dep != j) {
+                trace->jobs[j].deps[trace->jobs[j].dep_count++] = dep;
+            } else {
+                dropped++;
+            }
+        }
+    }
+
+    if (dropped > 0) {
+        log_debug("Dropped %d trace dependencies on unknown jobs", dropped);
+    }
+
+    for (int j = 0; j < trace->count; j++) {
+        free(lines[j].job_id);
+        free(lines[j].deps);
+    }
+    free(lines);
+    free(table);
+    return trace;
+}
+
+void schedule_trace_free(SimTrace* trace) {
+    if (!trace) return;
+
+    for (int j = 0; j < trace->count; j++) {
+        free(trace->jobs[j].deps);
+    }
+    free(trace->jobs);
+    free(trace->build_id);
+    free(trace);
+}
+
+const char* sim_policy_name(SimPolicy policy) {
+    switch (policy) {
+        case SIM_POLICY_FIFO: return "FIFO";
+        case SIM_POLICY_ROUND_ROBIN: return "ROUND_ROBIN";
+        case SIM_POLICY_CRITICAL_PATH: return "CRITICAL_PATH";
+        default: return "UNKNOWN";
+    }
+}
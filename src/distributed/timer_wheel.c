@@ -0,0 +1,439 @@
+/**
+ * @file timer_wheel.c
+ * @brief Hashed timer wheel implementation
+ *
+ * Timer nodes live in a growable pool and are linked into slot lists by
+ * index. A timer ID packs the pool index with a generation counter, so a
+ * stale ID from a fired or cancelled timer never matches a reused node.
+ */
+
+#include "cyxmake/distributed/timer_wheel.h"
+#include "cyxmake/logger.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#ifdef CYXMAKE_ENABLE_DISTRIBUTED
+#include "cyxmake/threading.h"
+#endif
+
+/* ============================================================
+ * Constants
+ * ============================================================ */
+
+#define INITIAL_POOL_SIZE 64
+#define NO_NODE (-1)
+
+/* ============================================================
+ * Internal Structures
+ * ============================================================ */
+
+typedef struct {
+    uint32_t generation;          /* Bumped whenever the node is released */
+    bool active;
+    uint64_t deadline_tick;
+    uint64_t interval_ticks;      /* 0 = one-shot */
+    TimerCallback callback;
+    void* user_data;
+    void (*free_data)(void*);
+    int prev;                     /* Slot list links (pool indices) */
+    int next;
+} TimerNode;
+
+typedef struct {
+    TimerCallback callback;
+    void* user_data;
+    void (*free_data)(void*);     /* Non-NULL only for fired one-shots */
+} DueTimer;
+
+struct TimerWheel {
+    unsigned int tick_ms;
+    int slot_count;
+    int* slots;                   /* Head node index per slot */
+
+    TimerNode* nodes;
+    int node_capacity;
+    int free_head;                /* Free list through next */
+    int count;                    /* Pending timers */
+
+    uint64_t start_ms;            /* Tick 0 */
+    uint64_t current_tick;        /* Last tick processed */
+
+#ifdef CYXMAKE_ENABLE_DISTRIBUTED
+    MutexHandle mutex;
+#endif
+};
+
+/* ============================================================
+ * Helper Functions
+ * ============================================================ */
+
+static void wheel_lock(TimerWheel* wheel) {
+#ifdef CYXMAKE_ENABLE_DISTRIBUTED
+    mutex_lock(&wheel->mutex);
+#else
+    (void)wheel;
+#endif
+}
+
+static void wheel_unlock(TimerWheel* wheel) {
+#ifdef CYXMAKE_ENABLE_DISTRIBUTED
+    mutex_unlock(&wheel->mutex);
+#else
+    (void)wheel;
+#endif
+}
+
+uint64_t timer_wheel_now_ms(void) {
+#ifdef _WIN32
+    return (uint64_t)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+#endif
+}
+
+static uint64_t tick_at(TimerWheel* wheel, uint64_t ms) {
+    return ms > wheel->start_ms ? (ms - wheel->start_ms) / wheel->tick_ms : 0;
+}
+
+static TimerId make_id(int index, uint32_t generation) {
+    return ((TimerId)generation << 32) | (TimerId)(uint32_t)(index + 1);
+}
+
+static void slot_insert(TimerWheel* wheel, int index) {
+    TimerNode* node = &wheel->nodes[index];
+    int slot = (int)(node->deadline_tick % (uint64_t)wheel->slot_count);
+
+    node->prev = NO_NODE;
+    node->next = wheel->slots[slot];
+    if (node->next != NO_NODE) {
+        wheel->nodes[node->next].prev = index;
+    }
+    wheel->slots[slot] = index;
+}
+
+static void slot_remove(TimerWheel* wheel, int index) {
+    TimerNode* node = &wheel->nodes[index];
+
+    if (node->prev != NO_NODE) {
+        wheel->nodes[node->prev].next = node->next;
+    } else {
+        int slot = (int)(node->deadline_tick % (uint64_t)wheel->slot_count);
+        wheel->slots[slot] = node->next;
+    }
+    if (node->next != NO_NODE) {
+        wheel->nodes[node->next].prev = node->prev;
+    }
+}
+
+static void release_node(TimerWheel* wheel, int index) {
+    TimerNode* node = &wheel->nodes[index];
+    node->active = false;
+    node->generation++;
+    node->next = wheel->free_head;
+    wheel->free_head = index;
+    wheel->count--;
+}
+
+static int alloc_node(TimerWheel* wheel) {
+    if (wheel->free_head == NO_NODE) {
+        int capacity = wheel->node_capacity * 2;
+        TimerNode* nodes = realloc(wheel->nodes, sizeof(TimerNode) * (size_t)capacity);
+        if (!nodes) return NO_NODE;
+
+        memset(nodes + wheel->node_capacity, 0,
+               sizeof(TimerNode) * (size_t)(capacity - wheel->node_capacity));
+        for (int i = capacity - 1; i >= wheel->node_capacity; i--) {
+            nodes[i].next = wheel->free_head;
+            wheel->free_head = i;
+        }
+        wheel->nodes = nodes;
+        wheel->node_capacity = capacity;
+    }
+
+    int index = wheel->free_head;
+    wheel->free_head = wheel->nodes[index].next;
+    return index;
+}
+
+/* ============================================================
+ * Timer Wheel API
+ * ============================================================ */
+
+TimerWheel* timer_wheel_create(unsigned int tick_ms, int slot_count) {
+    if (tick_ms == 0 || slot_count <= 0) return NULL;
+
+    TimerWheel* wheel = calloc(1, sizeof(TimerWheel));
+    if (!wheel) {
+        log_error("Failed to allocate timer wheel");
+        return NULL;
+    }
+
+    wheel->tick_ms = tick_ms;
+    wheel->slot_count = slot_count;
+    wheel->slots = malloc(sizeof(int) * (size_t)slot_count);
+    wheel->nodes = calloc(INITIAL_POOL_SIZE, sizeof(TimerNode));
+    if (!wheel->slots || !wheel->nodes) {
+        free(wheel->slots);
+        free(wheel->nodes);
+        free(wheel);
+        return NULL;
+    }
+
+    for (int i = 0; i < slot_count; i++) {
+        wheel->slots[i] = NO_NODE;
+    }
+    wheel->node_capacity = INITIAL_POOL_SIZE;
+    wheel->free_head = NO_NODE;
+    for (int i = INITIAL_POOL_SIZE - 1; i >= 0; i--) {
+        wheel->nodes[i].next = wheel->free_head;
+        wheel->free_head = i;
+    }
+    wheel->start_ms = timer_wheel_now_ms();
+
+#ifdef CYXMAKE_ENABLE_DISTRIBUTED
+    if (!mutex_init(&wheel->mutex)) {
+        log_error("Failed to create timer wheel mutex");
+        free(wheel->slots);
+        free(wheel->nodes);
+        free(wheel);
+        return NULL;
+    }
+#endif
+
+    return wheel;
+}
+
+void timer_wheel_free(TimerWheel* wheel) {
+    if (!wheel) return;
+
+    for (int i = 0; i < wheel->node_capacity; i++) {
+        TimerNode* node = &wheel->nodes[i];
+        if (node->active && node->free_data) {
+            node->free_data(node->user_data);
+        }
+    }
+
+#ifdef CYXMAKE_ENABLE_DISTRIBUTED
+    mutex_destroy(&wheel->mutex);
+#endif
+
+    free(wheel->slots);
+    free(wheel->nodes);
+    free(wheel);
+}
+
+TimerId timer_wheel_schedule(TimerWheel* wheel,
+                             unsigned int delay_ms,
+                             unsigned int interval_ms,
+                             TimerCallback callback,
+                             void* user_data,
+                             void (*free_data)(void*)) {
+    if (!wheel || !callback) return 0;
+
+    uint64_t now = timer_wheel_now_ms();
+
+    wheel_lock(wheel);
+
+    int index = alloc_node(wheel);
+    if (index == NO_NODE) {
+        wheel_unlock(wheel);
+        return 0;
+    }
+
+    /* Round up so a timer never fires before its delay has elapsed */
+    uint64_t elapsed = now > wheel->start_ms ? now - wheel->start_ms : 0;
+    uint64_t deadline = (elapsed + delay_ms + wheel->tick_ms - 1) / wheel->tick_ms;
+    if (deadline <= wheel->current_tick) {
+        deadline = wheel->current_tick + 1;
+    }
+
+    TimerNode* node = &wheel->nodes[index];
+    node->active = true;
+    node->deadline_tick = deadline;
+    node->interval_ticks = interval_ms > 0 ?
+        (interval_ms + wheel->tick_ms - 1) / wheel->tick_ms : 0;
+    node->callback = callback;
+    node->user_data = user_data;
+    node->free_data = free_data;
+    slot_insert(wheel, index);
+    wheel->count++;
+
+    TimerId id = make_id(index, node->generation);
+    wheel_unlock(wheel);
+    return id;
+}
+
+bool timer_wheel_cancel(TimerWheel* wheel, TimerId id) {
+    if (!wheel || id == 0) return false;
+
+    int index = (int)(uint32_t)(id & 0xFFFFFFFFu) - 1;
+    uint32_t generation = (uint32_t)(id >> 32);
+
+    wheel_lock(wheel);
+
+    if (index < 0 || index >= wheel->node_capacity ||
+        !wheel->nodes[index].active || wheel->nodes[index].generation != generation) {
+        wheel_unlock(wheel);
+        return false;
+    }
+
+    TimerNode* node = &wheel->nodes[index];
+    void* user_data = node->user_data;
+    void (*free_data)(void*) = node->free_data;
+
+    slot_remove(wheel, index);
+    release_node(wheel, index);
+
+    wheel_unlock(wheel);
+
+    if (free_data) {
+        free_data(user_data);
+    }
+    return true;
+}
+
+int timer_wheel_advance(TimerWheel* wheel, uint64_t now_ms) {
+    if (!wheel) return 0;
+
+    wheel_lock(wheel);
+
+    uint64_t now_tick = tick_at(wheel, now_ms);
+    if (now_tick <= wheel->current_tick || wheel->count == 0) {
+        if (now_tick > wheel->current_tick) wheel->current_tick = now_tick;
+        wheel_unlock(wheel);
+        return 0;
+    }
+
+    /* A jump of a full rotation or more visits every slot once */
+    uint64_t steps = now_tick - wheel->current_tick;
+    if (steps > (uint64_t)wheel->slot_count) {
+        steps = (uint64_t)wheel->slot_count;
+    }
+
+    DueTimer* due = NULL;
+    int due_count = 0, due_capacity = 0;
+    int* repeat = NULL;
+    int repeat_count = 0, repeat_capacity = 0;
+
+    for (uint64_t t = wheel->current_tick + 1; t <= wheel->current_tick + steps; t++) {
+        int slot = (int)(t % (uint64_t)wheel->slot_count);
+        int index = wheel->slots[slot];
+
+        while (index != NO_NODE) {
+            TimerNode* node = &wheel->nodes[index];
+            int next = node->next;
+
+            if (node->deadline_tick <= now_tick) {
+                if (due_count == due_capacity) {
+                    due_capacity = due_capacity ? due_capacity * 2 : 16;
+                    DueTimer* grown = realloc(due, sizeof(DueTimer) * (size_t)due_capacity);
+                    if (!grown) break;
+                    due = grown;
+                }
+
+                slot_remove(wheel, index);
+                due[due_count].callback = node->callback;
+                due[due_count].user_data = node->user_data;
+                due[due_count].free_data = NULL;
+
+                if (node->interval_ticks > 0) {
+                    /* Re-inserted after the scan so it cannot fire twice */
+                    if (repeat_count == repeat_capacity) {
+                        repeat_capacity = repeat_capacity ? repeat_capacity * 2 : 8;
+                        int* grown = realloc(repeat, sizeof(int) * (size_t)repeat_capacity);
+                        if (!grown) {
+                            slot_insert(wheel, index);
+                            break;
+                        }
+                        repeat = grown;
+                    }
+                    repeat[repeat_count++] = index;
+                } else {
+                    due[due_count].free_data = node->free_data;
+                    release_node(wheel, index);
+                }
+                due_count++;
+            }
+
+            index = next;
+        }
+    }
+
+    wheel->current_tick = now_tick;
+
+    for (int i = 0; i < repeat_count; i++) {
+        TimerNode* node = &wheel->nodes[repeat[i]];
+        node->deadline_tick += node->interval_ticks;
+        if (node->deadline_tick <= now_tick) {
+            node->deadline_tick = now_tick + node->interval_ticks;  /* Skip missed periods */
+        }
+        slot_insert(wheel, repeat[i]);
+    }
+
+    wheel_unlock(wheel);
+
+    for (int i = 0; i < due_count; i++) {
+        due[i].callback(due[i].user_data);
+        if (due[i].free_data) {
+            due[i].free_data(due[i].user_data);
+        }
+    }
+
+    free(due);
+    free(repeat);
+    return due_count;
+}
+
+int64_t timer_wheel_next_delay_ms(TimerWheel* wheel, uint64_t now_ms) {
+    if (!wheel) return -1;
+
+    wheel_lock(wheel);
+
+    if (wheel->count == 0) {
+        wheel_unlock(wheel);
+        return -1;
+    }
+
+    /* First slot in this rotation holding a timer due in this rotation */
+    uint64_t next_tick = 0;
+    bool found = false;
+    for (int i = 1; i <= wheel->slot_count && !found; i++) {
+        uint64_t t = wheel->current_tick + (uint64_t)i;
+        int index = wheel->slots[t % (uint64_t)wheel->slot_count];
+        for (; index != NO_NODE; index = wheel->nodes[index].next) {
+            if (wheel->nodes[index].deadline_tick <= t) {
+                next_tick = wheel->nodes[index].deadline_tick;
+                found = true;
+                break;
+            }
+        }
+    }
+
+    /* Everything is more than a rotation away */
+    if (!found) {
+        for (int i = 0; i < wheel->node_capacity; i++) {
+            if (wheel->nodes[i].active &&
+                (!found || wheel->nodes[i].deadline_tick < next_tick)) {
+                next_tick = wheel->nodes[i].deadline_tick;
+                found = true;
+            }
+        }
+    }
+
+    uint64_t deadline_ms = wheel->start_ms + next_tick * wheel->tick_ms;
+    wheel_unlock(wheel);
+
+    return deadline_ms > now_ms ? (int64_t)(deadline_ms - now_ms) : 0;
+}
+
+int timer_wheel_count(TimerWheel* wheel) {
+    return wheel ? wheel->count : 0;
+}
@@ -7,6 +7,9 @@
  */
 
 #include "cyxmake/distributed/work_scheduler.h"
+#include "cyxmake/distributed/job_history.h"
+#include "cyxmake/distributed/schedule_sim.h"
+#include "cyxmake/project_graph.h"
 #include "cyxmake/logger.h"
 
 #include <stdlib.h>
@@ -29,10 +32,33 @@
 #define DEFAULT_MAX_CONCURRENT_BUILDS 10
 #define DEFAULT_MIN_JOB_SIZE_BYTES 1024
 
+/* Job batching */
+#define DEFAULT_MAX_BATCH_SIZE 16
+#define DEFAULT_BATCH_MAX_JOB_SEC 2.0
+#define MAX_BATCH_SIZE 64
+#define BATCH_SCAN_LIMIT 128
+
+/* Speculative execution */
+#define DEFAULT_SPECULATIVE_FACTOR 2.0
+#define SPECULATIVE_MIN_ELAPSED_SEC 2.0
+
+/* Duration estimates for jobs without history */
+#define DEFAULT_JOB_ESTIMATE_SEC 1.0
+#define COMPILE_BASE_SEC 0.2
+#define COMPILE_SEC_PER_LINE 0.001
+#define MAX_GRAPH_WALK 512
+
 /* ============================================================
  * Internal Structures
  * ============================================================ */
 
+/* A revoked copy still running on its worker, holding the slot */
+typedef struct RevokedCopy {
+    char* job_id;
+    char* worker_id;
+    struct RevokedCopy* next;
+} RevokedCopy;
+
 struct WorkScheduler {
     SchedulerConfig config;
     WorkerRegistry* worker_registry;
@@ -44,6 +70,7 @@ struct WorkScheduler {
 
     ScheduledJob* running_head;   /* Running jobs list */
     int running_count;
+    RevokedCopy* revoked;         /* Copies told to cancel, not yet stopped */
 
     /* Build sessions */
     BuildSession* builds;
@@ -51,7 +78,12 @@ struct WorkScheduler {
 
     /* State */
     volatile bool running;
-    int round_robin_index;        /* For round-robin LB */
+    unsigned int round_robin_index;   /* For round-robin LB */
+
+    /* Critical-path scheduling */
+    JobHistory* history;          /* Durations keyed by job digest */
+    char* trace_path;             /* Completed-job trace for replay */
+    ProjectGraph* project_graph;  /* Borrowed; sizes jobs without history */
 
     /* Statistics */
     SchedulerStats stats;
@@ -59,6 +91,7 @@ struct WorkScheduler {
 #ifdef CYXMAKE_ENABLE_DISTRIBUTED
     MutexHandle mutex;
     ThreadHandle scheduler_thread;
+    bool scheduler_thread_started;
 #endif
 
     SchedulerCallbacks callbacks;
@@ -115,15 +148,20 @@ static char* generate_build_id(void) {
 SchedulerConfig scheduler_config_default(void) {
     SchedulerConfig config = {
         .default_strategy = DIST_STRATEGY_COMPILE_UNITS,
-        .lb_algorithm = LB_LEAST_LOADED,
+        .lb_algorithm = LB_CRITICAL_PATH,
         .default_job_timeout_sec = DEFAULT_JOB_TIMEOUT_SEC,
         .max_retries = DEFAULT_MAX_RETRIES,
         .retry_delay_sec = DEFAULT_RETRY_DELAY_SEC,
         .max_pending_jobs = DEFAULT_MAX_PENDING_JOBS,
         .max_concurrent_builds = DEFAULT_MAX_CONCURRENT_BUILDS,
-        .enable_job_coalescing = false,
+        .enable_job_coalescing = true,
+        .max_batch_size = DEFAULT_MAX_BATCH_SIZE,
+        .batch_max_job_sec = DEFAULT_BATCH_MAX_JOB_SEC,
         .enable_speculative = false,
-        .min_job_size_bytes = DEFAULT_MIN_JOB_SIZE_BYTES
+        .speculative_factor = DEFAULT_SPECULATIVE_FACTOR,
+        .min_job_size_bytes = DEFAULT_MIN_JOB_SIZE_BYTES,
+        .history_path = NULL,
+        .trace_path = NULL
     };
     return config;
 }
@@ -139,6 +177,8 @@ void scheduled_job_free(ScheduledJob* job) {
     free(job->build_id);
     free(job->assigned_worker_id);
     free(job->last_error);
+    free(job->digest);
+    free(job->speculative_worker_id);
 
     if (job->depends_on) {
         for (int i = 0; i < job->depends_count; i++) {
@@ -174,65 +214,59 @@ void build_session_free(BuildSession* session) {
  * Worker Selection
  * ============================================================ */
 
-/* Context for round-robin worker selection callback */
-typedef struct {
-    int target;
-    int current;
-    RemoteWorker* selected;
-} RoundRobinContext;
-
-static void round_robin_worker_checker(RemoteWorker* w, void* data) {
-    RoundRobinContext* ctx = (RoundRobinContext*)data;
-    if ((w->state == WORKER_STATE_ONLINE || w->state == WORKER_STATE_BUSY) &&
-        w->active_jobs < w->max_jobs) {
-        if (ctx->current == ctx->target) {
-            ctx->selected = w;
-        }
-        ctx->current++;
-    }
-}
-
 static RemoteWorker* select_worker_round_robin(WorkScheduler* scheduler) {
-    int online = worker_registry_get_online_count(scheduler->worker_registry);
-    if (online == 0) return NULL;
-
-    /* Find the nth online worker */
-    RoundRobinContext ctx = {0};
-    ctx.target = scheduler->round_robin_index % online;
-    ctx.current = 0;
-    ctx.selected = NULL;
-
-    scheduler->round_robin_index++;
-
-    worker_registry_foreach(scheduler->worker_registry,
-                            round_robin_worker_checker,
-                            &ctx);
-
-    return ctx.selected;
+    return worker_registry_select_round_robin(scheduler->worker_registry,
+                                              scheduler->round_robin_index++);
 }
 
-static RemoteWorker* select_worker_least_loaded(WorkScheduler* scheduler,
-                                                  ScheduledJob* job) {
-    WorkerSelectionCriteria criteria = {0};
-
-    /* Determine required capabilities from job type */
+/* Capabilities a worker needs to run this job */
+static uint32_t job_required_capabilities(ScheduledJob* job) {
     if (job->spec) {
         switch (job->spec->type) {
             case JOB_TYPE_COMPILE:
-                criteria.required_capabilities = WORKER_CAP_COMPILE_C | WORKER_CAP_COMPILE_CPP;
-                break;
+                return WORKER_CAP_COMPILE_C | WORKER_CAP_COMPILE_CPP;
             case JOB_TYPE_LINK:
-                criteria.required_capabilities = WORKER_CAP_COMPILE_C;
-                break;
+                return WORKER_CAP_COMPILE_C;
             case JOB_TYPE_CMAKE_CONFIG:
-                criteria.required_capabilities = WORKER_CAP_CMAKE;
-                break;
+                return WORKER_CAP_CMAKE;
             default:
                 break;
         }
     }
+    return 0;
+}
+
+static RemoteWorker* select_worker_least_loaded(WorkScheduler* scheduler,
+                                                  ScheduledJob* job) {
+    WorkerSelectionCriteria criteria = {0};
+    criteria.required_capabilities = job_required_capabilities(job);
+    criteria.prefer_idle = true;
+    criteria.min_available_slots = 1;
 
+    return worker_registry_select_worker(scheduler->worker_registry, &criteria);
+}
+
+/* Weighted by what each worker has actually delivered for this kind of job */
+static RemoteWorker* select_worker_by_metrics(WorkScheduler* scheduler,
+                                               ScheduledJob* job,
+                                               bool low_latency) {
+    WorkerSelectionCriteria criteria = {0};
+    criteria.required_capabilities = job_required_capabilities(job);
+    criteria.min_available_slots = 1;
+    criteria.job_type = job->spec ? job->spec->type : JOB_TYPE_CUSTOM;
+    criteria.prefer_throughput = !low_latency;
+    criteria.prefer_low_latency = low_latency;
     criteria.prefer_idle = true;
+
+    return worker_registry_select_worker(scheduler->worker_registry, &criteria);
+}
+
+/* Jobs leave the queue longest-path first, so the fastest worker goes to them */
+static RemoteWorker* select_worker_fastest(WorkScheduler* scheduler,
+                                             ScheduledJob* job) {
+    WorkerSelectionCriteria criteria = {0};
+    criteria.required_capabilities = job_required_capabilities(job);
+    criteria.prefer_fast = true;
     criteria.min_available_slots = 1;
 
     return worker_registry_select_worker(scheduler->worker_registry, &criteria);
@@ -244,16 +278,16 @@ static RemoteWorker* select_worker(WorkScheduler* scheduler, ScheduledJob* job)
             return select_worker_round_robin(scheduler);
 
         case LB_LEAST_LOADED:
-        case LB_WEIGHTED:
             return select_worker_least_loaded(scheduler, job);
 
-        case LB_LEAST_LATENCY: {
-            /* Select worker with lowest latency */
-            WorkerSelectionCriteria criteria = {0};
-            criteria.min_available_slots = 1;
-            /* TODO: Implement latency-based selection */
-            return worker_registry_select_worker(scheduler->worker_registry, &criteria);
-        }
+        case LB_WEIGHTED:
+            return select_worker_by_metrics(scheduler, job, false);
+
+        case LB_LEAST_LATENCY:
+            return select_worker_by_metrics(scheduler, job, true);
+
+        case LB_CRITICAL_PATH:
+            return select_worker_fastest(scheduler, job);
 
         case LB_RANDOM: {
             /* Random selection */
@@ -271,9 +305,14 @@ static RemoteWorker* select_worker(WorkScheduler* scheduler, ScheduledJob* job)
  * Queue Operations
  * ============================================================ */
 
+/* Queue order: priority, then longest remaining path, then FIFO */
+static bool runs_before(const ScheduledJob* a, const ScheduledJob* b) {
+    if (a->priority != b->priority) return a->priority > b->priority;
+    return a->critical_path_sec > b->critical_path_sec;
+}
+
 static void enqueue_job(WorkScheduler* scheduler, ScheduledJob* job) {
-    /* Insert by priority (higher priority first) */
-    if (!scheduler->pending_head || job->priority > scheduler->pending_head->priority) {
+    if (!scheduler->pending_head || runs_before(job, scheduler->pending_head)) {
         job->next = scheduler->pending_head;
         scheduler->pending_head = job;
         if (!scheduler->pending_tail) {
@@ -281,7 +320,7 @@ static void enqueue_job(WorkScheduler* scheduler, ScheduledJob* job) {
         }
     } else {
         ScheduledJob* prev = scheduler->pending_head;
-        while (prev->next && prev->next->priority >= job->priority) {
+        while (prev->next && !runs_before(job, prev->next)) {
             prev = prev->next;
         }
         job->next = prev->next;
@@ -294,18 +333,56 @@ static void enqueue_job(WorkScheduler* scheduler, ScheduledJob* job) {
     scheduler->pending_count++;
 }
 
-static ScheduledJob* dequeue_job(WorkScheduler* scheduler) {
-    if (!scheduler->pending_head) return NULL;
-
-    ScheduledJob* job = scheduler->pending_head;
-    scheduler->pending_head = job->next;
-    if (!scheduler->pending_head) {
-        scheduler->pending_tail = NULL;
+/* Unlink a pending job given its predecessor (NULL = head) */
+static void dequeue_job(WorkScheduler* scheduler, ScheduledJob* prev, ScheduledJob* job) {
+    if (prev) {
+        prev->next = job->next;
+    } else {
+        scheduler->pending_head = job->next;
+    }
+    if (scheduler->pending_tail == job) {
+        scheduler->pending_tail = prev;
     }
     job->next = NULL;
     scheduler->pending_count--;
+}
 
-    return job;
+/* Stable merge sort of the pending list by runs_before */
+static ScheduledJob* sort_jobs(ScheduledJob* head, int count) {
+    if (count <= 1) {
+        if (head) head->next = NULL;
+        return head;
+    }
+
+    int half = count / 2;
+    ScheduledJob* mid = head;
+    for (int i = 0; i < half; i++) mid = mid->next;
+
+    ScheduledJob* left = sort_jobs(head, half);
+    ScheduledJob* right = sort_jobs(mid, count - half);
+
+    ScheduledJob merged = {0};
+    ScheduledJob* tail = &merged;
+    while (left && right) {
+        if (runs_before(right, left)) {
+            tail->next = right;
+            right = right->next;
+        } else {
+            tail->next = left;
+            left = left->next;
+        }
+        tail = tail->next;
+    }
+    tail->next = left ? left : right;
+    return merged.next;
+}
+
+/* Tell the owner queued work may be assignable; caller holds the lock */
+static void request_dispatch(WorkScheduler* scheduler) {
+    if (scheduler->callbacks.on_dispatch_needed) {
+        scheduler->callbacks.on_dispatch_needed(scheduler,
+                                                scheduler->callbacks.user_data);
+    }
 }
 
 static void add_to_running(WorkScheduler* scheduler, ScheduledJob* job) {
@@ -338,6 +415,140 @@ static void remove_from_running(WorkScheduler* scheduler, ScheduledJob* job) {
     }
 }
 
+/* ============================================================
+ * Duration Estimates
+ * ============================================================ */
+
+/* Lines the compiler reads for a source: the file plus everything it includes */
+static int translation_unit_lines(GraphNode* root) {
+    GraphNode* visited[MAX_GRAPH_WALK];
+    int count = 0, next = 0, lines = 0;
+
+    visited[count++] = root;
+    while (next < count) {
+        GraphNode* node = visited[next++];
+        lines += node->code_lines;
+
+        for (int i = 0; i < node->depends_on_count && count < MAX_GRAPH_WALK; i++) {
+            GraphNode* dep = node->depends_on[i];
+            bool seen = false;
+            for (int v = 0; v < count && !seen; v++) {
+                seen = (visited[v] == dep);
+            }
+            if (!seen) visited[count++] = dep;
+        }
+    }
+
+    return lines;
+}
+
+/* Estimate a job's run time; caller holds the lock */
+static double estimate_job_duration(WorkScheduler* scheduler, ScheduledJob* job) {
+    double estimate = job_history_estimate(scheduler->history, job->digest);
+    if (estimate >= 0) return estimate;
+
+    if (scheduler->project_graph && job->spec && job->spec->type == JOB_TYPE_COMPILE &&
+        job->spec->source_file) {
+        GraphNode* node = project_graph_find(scheduler->project_graph, job->spec->source_file);
+        if (node) {
+            return COMPILE_BASE_SEC + COMPILE_SEC_PER_LINE * translation_unit_lines(node);
+        }
+    }
+
+    /* Unknown jobs are assumed to be typical for this project */
+    estimate = job_history_mean(scheduler->history);
+    return estimate >= 0 ? estimate : DEFAULT_JOB_ESTIMATE_SEC;
+}
+
+typedef struct {
+    const char* job_id;
+    int index;
+} JobIndex;
+
+static int compare_job_index(const void* a, const void* b) {
+    return strcmp(((const JobIndex*)a)->job_id, ((const JobIndex*)b)->job_id);
+}
+
+/* Set critical_path_sec for the pending jobs of a build; caller holds the lock */
+static void compute_critical_paths(WorkScheduler* scheduler, const char* build_id) {
+    int count = 0;
+    for (ScheduledJob* j = scheduler->pending_head; j; j = j->next) {
+        if (j->build_id && strcmp(j->build_id, build_id) == 0) count++;
+    }
+    if (count == 0) return;
+
+    ScheduledJob** jobs = malloc(sizeof(ScheduledJob*) * (size_t)count);
+    JobIndex* index = malloc(sizeof(JobIndex) * (size_t)count);
+    SimJob* dag = calloc((size_t)count, sizeof(SimJob));
+    double* levels = malloc(sizeof(double) * (size_t)count);
+    if (!jobs || !index || !dag || !levels) {
+        free(jobs);
+        free(index);
+        free(dag);
+        free(levels);
+        return;
+    }
+
+    int n = 0;
+    for (ScheduledJob* j = scheduler->pending_head; j; j = j->next) {
+        if (j->build_id && strcmp(j->build_id, build_id) == 0) {
+            j->estimated_sec = estimate_job_duration(scheduler, j);
+            dag[n].duration_sec = j->estimated_sec;
+            index[n].job_id = j->job_id;
+            index[n].index = n;
+            jobs[n++] = j;
+        }
+    }
+    qsort(index, (size_t)n, sizeof(JobIndex), compare_job_index);
+
+    /* Edges between jobs of this build; finished or foreign deps don't delay it */
+    for (int i = 0; i < n; i++) {
+        if (jobs[i]->depends_count == 0) continue;
+        dag[i].deps = malloc(sizeof(int) * (size_t)jobs[i]->depends_count);
+        if (!dag[i].deps) continue;
+
+        for (int d = 0; d < jobs[i]->depends_count; d++) {
+            JobIndex key = { jobs[i]->depends_on[d], 0 };
+            JobIndex* found = bsearch(&key, index, (size_t)n, sizeof(JobIndex),
+                                      compare_job_index);
+            if (found && found->index != i) {
+                dag[i].deps[dag[i].dep_count++] = found->index;
+            }
+        }
+    }
+
+    if (!schedule_critical_path(dag, n, levels)) {
+        log_warning("Dependency cycle in build %s; cyclic jobs keep FIFO order", build_id);
+    }
+
+    double longest = 0.0;
+    for (int i = 0; i < n; i++) {
+        jobs[i]->critical_path_sec = levels[i];
+        if (levels[i] > longest) longest = levels[i];
+        free(dag[i].deps);
+    }
+
+    log_debug("Build %s: %d jobs, critical path %.1fs", build_id, n, longest);
+
+    free(jobs);
+    free(index);
+    free(dag);
+    free(levels);
+}
+
+/* Append a completed job to the replay trace; caller holds the lock */
+static void append_trace(WorkScheduler* scheduler, ScheduledJob* job, double duration_sec) {
+    FILE* f = fopen(scheduler->trace_path, "a");
+    if (!f) return;
+
+    fprintf(f, "%s %s %.3f", job->build_id ? job->build_id : "-", job->job_id, duration_sec);
+    for (int i = 0; i < job->depends_count; i++) {
+        fprintf(f, "%c%s", i == 0 ? ' ' : ',', job->depends_on[i]);
+    }
+    fputc('\n', f);
+    fclose(f);
+}
+
 /* ============================================================
  * Scheduler API Implementation
  * ============================================================ */
@@ -363,9 +574,23 @@ WorkScheduler* scheduler_create(const SchedulerConfig* config,
 
     scheduler->worker_registry = worker_registry;
 
+    scheduler->history = job_history_create(scheduler->config.history_path);
+    if (!scheduler->history) {
+        free(scheduler);
+        return NULL;
+    }
+    scheduler->trace_path = scheduler->config.trace_path ?
+                            strdup(scheduler->config.trace_path) : NULL;
+
+    /* The caller's strings need not outlive create */
+    scheduler->config.history_path = NULL;
+    scheduler->config.trace_path = NULL;
+
 #ifdef CYXMAKE_ENABLE_DISTRIBUTED
     if (!mutex_init(&scheduler->mutex)) {
         log_error("Failed to create scheduler mutex");
+        job_history_free(scheduler->history);
+        free(scheduler->trace_path);
         free(scheduler);
         return NULL;
     }
@@ -407,6 +632,18 @@ void scheduler_free(WorkScheduler* scheduler) {
         build = next;
     }
 
+    while (scheduler->revoked) {
+        RevokedCopy* copy = scheduler->revoked;
+        scheduler->revoked = copy->next;
+        free(copy->job_id);
+        free(copy->worker_id);
+        free(copy);
+    }
+
+    job_history_save(scheduler->history);
+    job_history_free(scheduler->history);
+    free(scheduler->trace_path);
+
 #ifdef CYXMAKE_ENABLE_DISTRIBUTED
     mutex_destroy(&scheduler->mutex);
 #endif
@@ -436,9 +673,9 @@ void scheduler_stop(WorkScheduler* scheduler) {
     scheduler->running = false;
 
 #ifdef CYXMAKE_ENABLE_DISTRIBUTED
-    if (scheduler->scheduler_thread) {
+    if (scheduler->scheduler_thread_started) {
         thread_join(scheduler->scheduler_thread);
-        scheduler->scheduler_thread = NULL;
+        scheduler->scheduler_thread_started = false;
     }
 #endif
 
@@ -502,18 +739,23 @@ ScheduledJob* scheduler_submit_job(WorkScheduler* scheduler,
                                     int priority) {
     if (!scheduler || !job_spec) return NULL;
 
+    /* Hashing reads the source file, so do it before taking the lock */
+    char* digest = job_history_digest(job_spec);
+
     scheduler_lock(scheduler);
 
     /* Check queue limit */
     if (scheduler->pending_count >= scheduler->config.max_pending_jobs) {
         log_warning("Job queue full (%d)", scheduler->config.max_pending_jobs);
         scheduler_unlock(scheduler);
+        free(digest);
         return NULL;
     }
 
     ScheduledJob* job = calloc(1, sizeof(ScheduledJob));
     if (!job) {
         scheduler_unlock(scheduler);
+        free(digest);
         return NULL;
     }
 
@@ -526,10 +768,16 @@ ScheduledJob* scheduler_submit_job(WorkScheduler* scheduler,
     job->max_retries = scheduler->config.max_retries;
     job->timeout_sec = job_spec->timeout_sec > 0 ?
                        job_spec->timeout_sec : scheduler->config.default_job_timeout_sec;
+    job->digest = digest;
+
+    /* Until the build starts, a job's path is just its own duration */
+    job->estimated_sec = estimate_job_duration(scheduler, job);
+    job->critical_path_sec = job->estimated_sec;
 
     /* Enqueue */
     enqueue_job(scheduler, job);
     scheduler->stats.total_jobs_submitted++;
+    request_dispatch(scheduler);
 
     /* Update build session */
     if (build_id) {
@@ -548,6 +796,43 @@ ScheduledJob* scheduler_submit_job(WorkScheduler* scheduler,
     return job;
 }
 
+bool scheduler_add_job_dependency(WorkScheduler* scheduler,
+                                   ScheduledJob* job,
+                                   const char* depends_on_job_id) {
+    if (!scheduler || !job || !depends_on_job_id) return false;
+
+    scheduler_lock(scheduler);
+
+    if (job->state != JOB_STATE_PENDING) {
+        scheduler_unlock(scheduler);
+        return false;
+    }
+
+    char** deps = realloc(job->depends_on, sizeof(char*) * (size_t)(job->depends_count + 1));
+    char* dep_id = strdup(depends_on_job_id);
+    if (!deps || !dep_id) {
+        if (deps) job->depends_on = deps;
+        free(dep_id);
+        scheduler_unlock(scheduler);
+        return false;
+    }
+
+    job->depends_on = deps;
+    job->depends_on[job->depends_count++] = dep_id;
+
+    scheduler_unlock(scheduler);
+    return true;
+}
+
+void scheduler_set_project_graph(WorkScheduler* scheduler,
+                                  struct ProjectGraph* graph) {
+    if (!scheduler) return;
+
+    scheduler_lock(scheduler);
+    scheduler->project_graph = graph;
+    scheduler_unlock(scheduler);
+}
+
 bool scheduler_start_build(WorkScheduler* scheduler, const char* build_id) {
     if (!scheduler || !build_id) return false;
 
@@ -556,7 +841,17 @@ bool scheduler_start_build(WorkScheduler* scheduler, const char* build_id) {
     for (BuildSession* build = scheduler->builds; build; build = build->next) {
         if (strcmp(build->build_id, build_id) == 0) {
             build->state = BUILD_STATE_RUNNING;
+
+            compute_critical_paths(scheduler, build_id);
+            scheduler->pending_head = sort_jobs(scheduler->pending_head,
+                                                scheduler->pending_count);
+            scheduler->pending_tail = scheduler->pending_head;
+            while (scheduler->pending_tail && scheduler->pending_tail->next) {
+                scheduler->pending_tail = scheduler->pending_tail->next;
+            }
+
             log_info("Build started: %s", build_id);
+            request_dispatch(scheduler);
             scheduler_unlock(scheduler);
             return true;
         }
@@ -644,30 +939,32 @@ double scheduler_get_build_progress(WorkScheduler* scheduler,
  * Job Management
  * ============================================================ */
 
-ScheduledJob* scheduler_get_job(WorkScheduler* scheduler,
-                                 const char* job_id) {
-    if (!scheduler || !job_id) return NULL;
-
-    scheduler_lock(scheduler);
-
-    /* Check pending queue */
+/* Find a pending or running job; caller holds the lock */
+static ScheduledJob* find_job(WorkScheduler* scheduler, const char* job_id) {
     for (ScheduledJob* j = scheduler->pending_head; j; j = j->next) {
-        if (strcmp(j->job_id, job_id) == 0) {
-            scheduler_unlock(scheduler);
-            return j;
-        }
+        if (strcmp(j->job_id, job_id) == 0) return j;
+    }
+    for (ScheduledJob* j = scheduler->running_head; j; j = j->next) {
+        if (strcmp(j->job_id, job_id) == 0) return j;
     }
+    return NULL;
+}
 
-    /* Check running list */
+static ScheduledJob* find_running_job(WorkScheduler* scheduler, const char* job_id) {
     for (ScheduledJob* j = scheduler->running_head; j; j = j->next) {
-        if (strcmp(j->job_id, job_id) == 0) {
-            scheduler_unlock(scheduler);
-            return j;
-        }
+        if (strcmp(j->job_id, job_id) == 0) return j;
     }
+    return NULL;
+}
+
+ScheduledJob* scheduler_get_job(WorkScheduler* scheduler,
+                                 const char* job_id) {
+    if (!scheduler || !job_id) return NULL;
 
+    scheduler_lock(scheduler);
+    ScheduledJob* job = find_job(scheduler, job_id);
     scheduler_unlock(scheduler);
-    return NULL;
+    return job;
 }
 
 bool scheduler_cancel_job(WorkScheduler* scheduler,
@@ -690,149 +987,378 @@ bool scheduler_cancel_job(WorkScheduler* scheduler,
     return true;
 }
 
-void scheduler_report_job_result(WorkScheduler* scheduler,
-                                  const char* job_id,
-                                  DistributedJobResult* result) {
-    if (!scheduler || !job_id) return;
+/* Release the job's worker slot; caller holds the lock */
+static void release_worker(WorkScheduler* scheduler, ScheduledJob* job,
+                           bool success, double duration_sec) {
+    if (!job->assigned_worker_id) return;
+
+    RemoteWorker* worker = worker_registry_find_by_id(
+        scheduler->worker_registry, job->assigned_worker_id);
+    if (worker) {
+        /* Recorded while the job still counts toward the worker's concurrency */
+        worker_registry_record_job_complete(scheduler->worker_registry, worker,
+                                             job->spec ? job->spec->type : JOB_TYPE_CUSTOM,
+                                             success, duration_sec, job->estimated_sec);
+        worker_registry_update_job_count(scheduler->worker_registry, worker, -1);
+    }
+}
 
-    scheduler_lock(scheduler);
+/* Count a finished job against its build; caller holds the lock */
+static void update_build_progress(WorkScheduler* scheduler, ScheduledJob* job,
+                                  bool success) {
+    if (!job->build_id) return;
 
-    /* Find job in running list */
-    ScheduledJob* job = NULL;
-    for (ScheduledJob* j = scheduler->running_head; j; j = j->next) {
-        if (strcmp(j->job_id, job_id) == 0) {
-            job = j;
+    for (BuildSession* b = scheduler->builds; b; b = b->next) {
+        if (strcmp(b->build_id, job->build_id) == 0) {
+            b->running_jobs--;
+            if (success) {
+                b->completed_jobs++;
+            } else {
+                b->failed_jobs++;
+            }
+            b->progress_percent = (double)b->completed_jobs / b->total_jobs * 100.0;
+
+            /* Check if build complete */
+            if (b->completed_jobs + b->failed_jobs >= b->total_jobs) {
+                b->completed_at = time(NULL);
+                b->success = (b->failed_jobs == 0);
+                b->state = b->success ? BUILD_STATE_COMPLETED : BUILD_STATE_FAILED;
+
+                if (b->success) {
+                    scheduler->stats.successful_builds++;
+                } else {
+                    scheduler->stats.failed_builds++;
+                }
+                job_history_save(scheduler->history);
+
+                if (scheduler->callbacks.on_build_completed) {
+                    scheduler->callbacks.on_build_completed(scheduler, b,
+                                                             scheduler->callbacks.user_data);
+                }
+            }
             break;
         }
     }
+}
 
-    if (!job) {
-        scheduler_unlock(scheduler);
-        log_warning("Job not found for result: %s", job_id);
-        return;
+/* Free a worker slot held by a copy that has stopped; caller holds the lock */
+static void release_copy_slot(WorkScheduler* scheduler, const char* worker_id) {
+    RemoteWorker* worker = worker_registry_find_by_id(scheduler->worker_registry, worker_id);
+    if (worker) {
+        worker_registry_update_job_count(scheduler->worker_registry, worker, -1);
+        request_dispatch(scheduler);
     }
+}
 
-    /* Update job */
-    job->completed_at = time(NULL);
-    job->result = result;
-
-    if (result->success) {
-        job->state = JOB_STATE_COMPLETED;
-        scheduler->stats.total_jobs_completed++;
-
-        double wait_time = difftime(job->assigned_at, job->queued_at);
-        double run_time = difftime(job->completed_at, job->started_at);
+/*
+ * Keep a revoked copy's slot until its worker reports it stopped; the
+ * worker rejects new jobs until then. Caller holds the lock.
+ */
+static bool hold_revoked_copy(WorkScheduler* scheduler, ScheduledJob* job,
+                              const char* worker_id) {
+    RevokedCopy* copy = calloc(1, sizeof(RevokedCopy));
+    if (!copy) return false;
+    copy->job_id = strdup(job->job_id);
+    copy->worker_id = strdup(worker_id);
+    if (!copy->job_id || !copy->worker_id) {
+        free(copy->job_id);
+        free(copy->worker_id);
+        free(copy);
+        return false;
+    }
+    copy->next = scheduler->revoked;
+    scheduler->revoked = copy;
+    return true;
+}
 
-        /* Update averages */
-        int total = scheduler->stats.total_jobs_completed;
-        scheduler->stats.avg_job_wait_time_sec =
-            ((total - 1) * scheduler->stats.avg_job_wait_time_sec + wait_time) / total;
-        scheduler->stats.avg_job_run_time_sec =
-            ((total - 1) * scheduler->stats.avg_job_run_time_sec + run_time) / total;
+/*
+ * Stop tracking one copy of a speculated job. A copy that failed or whose
+ * worker left frees its slot now; a revoked one frees it once the worker
+ * reports it stopped. Dropping the primary promotes the duplicate. Caller
+ * holds the lock.
+ */
+static void drop_copy(WorkScheduler* scheduler, ScheduledJob* job,
+                      bool duplicate, bool revoke) {
+    char* worker_id = duplicate ? job->speculative_worker_id : job->assigned_worker_id;
+    time_t since = duplicate ? job->speculated_at :
+                   (job->started_at ? job->started_at : job->assigned_at);
 
-        log_debug("Job completed: %s (%.2fs)", job_id, run_time);
+    scheduler->stats.speculative_wasted_sec += difftime(time(NULL), since);
 
-        if (scheduler->callbacks.on_job_completed) {
-            scheduler->callbacks.on_job_completed(scheduler, job, result,
-                                                   scheduler->callbacks.user_data);
+    if (revoke && scheduler->callbacks.on_job_revoked) {
+        if (!hold_revoked_copy(scheduler, job, worker_id)) {
+            release_copy_slot(scheduler, worker_id);
         }
+        scheduler->callbacks.on_job_revoked(scheduler, job, worker_id,
+                                             scheduler->callbacks.user_data);
     } else {
-        job->state = JOB_STATE_FAILED;
-        free(job->last_error);
-        job->last_error = result->stderr_output ? strdup(result->stderr_output) : NULL;
-        scheduler_report_job_failure(scheduler, job_id,
-                                      result->stderr_output ? result->stderr_output : "Unknown error");
+        release_copy_slot(scheduler, worker_id);
     }
 
-    /* Remove from running */
-    remove_from_running(scheduler, job);
-
-    /* Update worker */
-    if (job->assigned_worker_id) {
-        RemoteWorker* worker = worker_registry_find_by_id(
-            scheduler->worker_registry, job->assigned_worker_id);
-        if (worker) {
-            worker_registry_update_job_count(scheduler->worker_registry, worker, -1);
-            worker_registry_record_job_complete(scheduler->worker_registry, worker,
-                                                 result->success, result->duration_sec);
-        }
+    if (!duplicate) {
+        job->assigned_worker_id = job->speculative_worker_id;
+        job->started_at = job->speculated_at;
     }
-
-    /* Update build */
-    if (job->build_id) {
-        for (BuildSession* b = scheduler->builds; b; b = b->next) {
-            if (strcmp(b->build_id, job->build_id) == 0) {
-                b->running_jobs--;
-                if (result->success) {
-                    b->completed_jobs++;
-                } else {
-                    b->failed_jobs++;
-                }
-                b->progress_percent = (double)b->completed_jobs / b->total_jobs * 100.0;
-
-                /* Check if build complete */
-                if (b->completed_jobs + b->failed_jobs >= b->total_jobs) {
-                    b->completed_at = time(NULL);
-                    b->success = (b->failed_jobs == 0);
-                    b->state = b->success ? BUILD_STATE_COMPLETED : BUILD_STATE_FAILED;
-
-                    if (b->success) {
-                        scheduler->stats.successful_builds++;
-                    } else {
-                        scheduler->stats.failed_builds++;
-                    }
-
-                    if (scheduler->callbacks.on_build_completed) {
-                        scheduler->callbacks.on_build_completed(scheduler, b,
-                                                                 scheduler->callbacks.user_data);
-                    }
-                }
-                break;
-            }
-        }
-    }
-
-    scheduler_unlock(scheduler);
+    job->speculative_worker_id = NULL;
+    free(worker_id);
 }
 
-void scheduler_report_job_failure(WorkScheduler* scheduler,
-                                   const char* job_id,
-                                   const char* error) {
-    if (!scheduler || !job_id) return;
-
-    ScheduledJob* job = scheduler_get_job(scheduler, job_id);
-    if (!job) return;
-
-    scheduler_lock(scheduler);
-
+/* Retry a running job or mark it failed; caller holds the lock */
+static void fail_job(WorkScheduler* scheduler, ScheduledJob* job,
+                     const char* error, double duration_sec) {
     free(job->last_error);
     job->last_error = error ? strdup(error) : NULL;
 
+    /* A timeout gives up on both copies */
+    if (job->speculative_worker_id) {
+        drop_copy(scheduler, job, true, true);
+    }
+
+    release_worker(scheduler, job, false, duration_sec);
+    remove_from_running(scheduler, job);
+
     /* Check if can retry */
     if (job->retry_count < job->max_retries) {
         job->retry_count++;
         job->state = JOB_STATE_RETRY;
         scheduler->stats.total_retries++;
+        free(job->assigned_worker_id);
+        job->assigned_worker_id = NULL;
 
         log_info("Job will retry (%d/%d): %s",
-                 job->retry_count, job->max_retries, job_id);
+                 job->retry_count, job->max_retries, job->job_id);
 
         /* Move back to pending queue */
-        remove_from_running(scheduler, job);
         enqueue_job(scheduler, job);
     } else {
         job->state = JOB_STATE_FAILED;
         scheduler->stats.total_jobs_failed++;
 
-        log_error("Job failed (max retries): %s - %s", job_id, error ? error : "");
+        log_error("Job failed (max retries): %s - %s", job->job_id, error ? error : "");
 
         if (scheduler->callbacks.on_job_failed) {
             scheduler->callbacks.on_job_failed(scheduler, job, error,
                                                 scheduler->callbacks.user_data);
         }
+
+        update_build_progress(scheduler, job, false);
+    }
+
+    /* Either the retry or another job can use the freed slot */
+    request_dispatch(scheduler);
+}
+
+void scheduler_report_job_started(WorkScheduler* scheduler, const char* job_id) {
+    if (!scheduler || !job_id) return;
+
+    scheduler_lock(scheduler);
+
+    ScheduledJob* job = find_running_job(scheduler, job_id);
+    if (job && job->state == JOB_STATE_ASSIGNED) {
+        job->state = JOB_STATE_RUNNING;
+        job->started_at = time(NULL);
+    }
+
+    scheduler_unlock(scheduler);
+}
+
+/*
+ * Match a report to a copy of the job: false if worker_id holds neither.
+ * *duplicate is set when it came from the speculative copy.
+ */
+static bool report_source(ScheduledJob* job, const char* worker_id, bool* duplicate) {
+    *duplicate = false;
+    if (!worker_id) return true;
+
+    if (job->speculative_worker_id && strcmp(job->speculative_worker_id, worker_id) == 0) {
+        *duplicate = true;
+        return true;
+    }
+    return !job->assigned_worker_id || strcmp(job->assigned_worker_id, worker_id) == 0;
+}
+
+void scheduler_report_job_result(WorkScheduler* scheduler,
+                                  const char* job_id,
+                                  DistributedJobResult* result) {
+    scheduler_report_worker_result(scheduler, NULL, job_id, result);
+}
+
+void scheduler_report_worker_result(WorkScheduler* scheduler,
+                                     const char* worker_id,
+                                     const char* job_id,
+                                     DistributedJobResult* result) {
+    if (!scheduler || !job_id || !result) return;
+
+    scheduler_lock(scheduler);
+
+    /* Find job in running list */
+    ScheduledJob* job = find_running_job(scheduler, job_id);
+    if (!job) {
+        scheduler_unlock(scheduler);
+        log_warning("Job not found for result: %s", job_id);
+        return;
+    }
+
+    bool duplicate;
+    if (!report_source(job, worker_id, &duplicate)) {
+        scheduler_unlock(scheduler);
+        log_debug("Ignoring result for %s from revoked worker %s", job_id, worker_id);
+        return;
+    }
+
+    if (job->speculative_worker_id) {
+        if (!result->success) {
+            /* The other copy may still succeed */
+            log_info("Copy of job %s failed; waiting for the other", job_id);
+            drop_copy(scheduler, job, duplicate, false);
+            scheduler_unlock(scheduler);
+            return;
+        }
+
+        /* First success wins; the loser is told to stop */
+        if (duplicate) {
+            scheduler->stats.speculative_wins++;
+            log_info("Speculative copy of job %s won", job_id);
+        }
+        drop_copy(scheduler, job, !duplicate, true);
+    }
+
+    job->completed_at = time(NULL);
+
+    if (!result->success) {
+        fail_job(scheduler, job,
+                 result->stderr_output && *result->stderr_output ?
+                 result->stderr_output : "Job failed",
+                 result->duration_sec);
+        scheduler_unlock(scheduler);
+        return;
+    }
+
+    job->state = JOB_STATE_COMPLETED;
+    scheduler->stats.total_jobs_completed++;
+
+    /* A job whose JOB_ACCEPT never arrived counts from assignment */
+    time_t started_at = job->started_at ? job->started_at : job->assigned_at;
+    double wait_time = difftime(job->assigned_at, job->queued_at);
+    double run_time = difftime(job->completed_at, started_at);
+
+    /* Update averages */
+    int total = scheduler->stats.total_jobs_completed;
+    scheduler->stats.avg_job_wait_time_sec =
+        ((total - 1) * scheduler->stats.avg_job_wait_time_sec + wait_time) / total;
+    scheduler->stats.avg_job_run_time_sec =
+        ((total - 1) * scheduler->stats.avg_job_run_time_sec + run_time) / total;
+
+    log_debug("Job completed: %s (%.2fs)", job_id, run_time);
+
+    /* Learn from the worker's measurement; it excludes queueing and transfer */
+    double measured = result->duration_sec > 0 ? result->duration_sec : run_time;
+    double recorded = job_history_estimate(scheduler->history, job->digest);
+    if (recorded > 0 && job->assigned_worker_id) {
+        RemoteWorker* worker = worker_registry_find_by_id(scheduler->worker_registry,
+                                                          job->assigned_worker_id);
+        worker_registry_record_job_speed(scheduler->worker_registry, worker,
+                                         measured / recorded);
+    }
+    job_history_record(scheduler->history, job->digest, measured);
+    if (scheduler->trace_path) {
+        append_trace(scheduler, job, measured);
+    }
+
+    /* The result stays owned by the caller; it is only valid during callbacks */
+    if (scheduler->callbacks.on_job_completed) {
+        scheduler->callbacks.on_job_completed(scheduler, job, result,
+                                               scheduler->callbacks.user_data);
+    }
+
+    remove_from_running(scheduler, job);
+    release_worker(scheduler, job, true, result->duration_sec);
+    update_build_progress(scheduler, job, true);
+
+    /* The freed slot and any unblocked dependents can be dispatched */
+    request_dispatch(scheduler);
+
+    scheduler_unlock(scheduler);
+}
+
+void scheduler_report_job_failure(WorkScheduler* scheduler,
+                                   const char* job_id,
+                                   const char* error) {
+    scheduler_report_worker_failure(scheduler, NULL, job_id, error);
+}
+
+void scheduler_report_worker_failure(WorkScheduler* scheduler,
+                                      const char* worker_id,
+                                      const char* job_id,
+                                      const char* error) {
+    if (!scheduler || !job_id) return;
+
+    scheduler_lock(scheduler);
+
+    ScheduledJob* job = find_running_job(scheduler, job_id);
+    if (!job) {
+        scheduler_unlock(scheduler);
+        log_warning("Job not found for failure: %s", job_id);
+        return;
+    }
+
+    bool duplicate;
+    if (!report_source(job, worker_id, &duplicate)) {
+        scheduler_unlock(scheduler);
+        return;
+    }
+
+    if (job->speculative_worker_id) {
+        drop_copy(scheduler, job, duplicate, false);
+        scheduler_unlock(scheduler);
+        return;
+    }
+
+    job->completed_at = time(NULL);
+    fail_job(scheduler, job, error, 0.0);
+
+    scheduler_unlock(scheduler);
+}
+
+void scheduler_report_copy_released(WorkScheduler* scheduler,
+                                     const char* worker_id,
+                                     const char* job_id) {
+    if (!scheduler || !worker_id || !job_id) return;
+
+    scheduler_lock(scheduler);
+
+    for (RevokedCopy** pp = &scheduler->revoked; *pp; pp = &(*pp)->next) {
+        RevokedCopy* copy = *pp;
+        if (strcmp(copy->job_id, job_id) == 0 && strcmp(copy->worker_id, worker_id) == 0) {
+            *pp = copy->next;
+            release_copy_slot(scheduler, worker_id);
+            free(copy->job_id);
+            free(copy->worker_id);
+            free(copy);
+            break;
+        }
+    }
+
+    scheduler_unlock(scheduler);
+}
+
+char* scheduler_get_job_output(WorkScheduler* scheduler,
+                               const char* worker_id,
+                               const char* job_id) {
+    if (!scheduler || !worker_id || !job_id) return NULL;
+
+    scheduler_lock(scheduler);
+
+    char* output = NULL;
+    bool duplicate;
+    ScheduledJob* job = find_running_job(scheduler, job_id);
+    if (job && job->spec && job->spec->output_file &&
+        report_source(job, worker_id, &duplicate)) {
+        output = strdup(job->spec->output_file);
     }
 
     scheduler_unlock(scheduler);
+    return output;
 }
 
 void scheduler_handle_worker_disconnect(WorkScheduler* scheduler,
@@ -841,13 +1367,34 @@ void scheduler_handle_worker_disconnect(WorkScheduler* scheduler,
 
     scheduler_lock(scheduler);
 
+    /* Revoked copies on this worker are gone with it */
+    for (RevokedCopy** pp = &scheduler->revoked; *pp; ) {
+        RevokedCopy* copy = *pp;
+        if (strcmp(copy->worker_id, worker_id) == 0) {
+            *pp = copy->next;
+            free(copy->job_id);
+            free(copy->worker_id);
+            free(copy);
+        } else {
+            pp = &copy->next;
+        }
+    }
+
     /* Find all jobs assigned to this worker and reschedule */
+    int requeued = 0;
     ScheduledJob* job = scheduler->running_head;
     while (job) {
         ScheduledJob* next = job->next;
 
-        if (job->assigned_worker_id &&
-            strcmp(job->assigned_worker_id, worker_id) == 0) {
+        /* A job with a copy elsewhere keeps running there */
+        if (job->speculative_worker_id) {
+            bool duplicate = strcmp(job->speculative_worker_id, worker_id) == 0;
+            if (duplicate || (job->assigned_worker_id &&
+                              strcmp(job->assigned_worker_id, worker_id) == 0)) {
+                drop_copy(scheduler, job, duplicate, false);
+            }
+        } else if (job->assigned_worker_id &&
+                   strcmp(job->assigned_worker_id, worker_id) == 0) {
 
             log_warning("Rescheduling job %s (worker disconnected)", job->job_id);
 
@@ -858,11 +1405,16 @@ void scheduler_handle_worker_disconnect(WorkScheduler* scheduler,
 
             remove_from_running(scheduler, job);
             enqueue_job(scheduler, job);
+            requeued++;
         }
 
         job = next;
     }
 
+    if (requeued > 0) {
+        request_dispatch(scheduler);
+    }
+
     scheduler_unlock(scheduler);
 }
 
@@ -878,28 +1430,83 @@ int scheduler_get_running_count(WorkScheduler* scheduler) {
     return scheduler ? scheduler->running_count : 0;
 }
 
+/* Caller holds the lock */
+static bool dependencies_met(WorkScheduler* scheduler, ScheduledJob* job) {
+    for (int i = 0; i < job->depends_count; i++) {
+        ScheduledJob* dep = find_job(scheduler, job->depends_on[i]);
+        if (dep && dep->state != JOB_STATE_COMPLETED) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Short compiles, where a request round trip rivals the compile itself */
+static bool job_batchable(WorkScheduler* scheduler, ScheduledJob* job) {
+    return job->spec && job->spec->type == JOB_TYPE_COMPILE &&
+           job->estimated_sec <= scheduler->config.batch_max_job_sec;
+}
+
+/* Whether more jobs can join a batch to this worker */
+static bool worker_has_batch_room(RemoteWorker* worker) {
+    return (worker->capabilities & WORKER_CAP_JOB_BATCH) && !worker->congested &&
+           worker->active_jobs < worker_slot_limit(worker);
+}
+
+/* Mark a dequeued job as assigned to worker; caller holds the lock */
+static void assign_job(WorkScheduler* scheduler, ScheduledJob* job, RemoteWorker* worker) {
+    job->state = JOB_STATE_ASSIGNED;
+    job->assigned_at = time(NULL);
+    /* A retried job starts over; its last attempt's times no longer apply */
+    job->started_at = 0;
+    job->speculated_at = 0;
+    job->assigned_worker_id = strdup(worker->id);
+    job->deadline = job->assigned_at + job->timeout_sec;
+
+    add_to_running(scheduler, job);
+    worker_registry_update_job_count(scheduler->worker_registry, worker, 1);
+
+    log_debug("Job %s assigned to worker %s", job->job_id, worker->id);
+}
+
+/* Hand assignments to the owner, as one batch when it can send one */
+static void notify_assigned(WorkScheduler* scheduler, ScheduledJob** jobs, int count,
+                            RemoteWorker* worker) {
+    if (count > 1 && scheduler->callbacks.on_batch_assigned) {
+        scheduler->stats.batches_dispatched++;
+        scheduler->stats.batched_jobs += count;
+        scheduler->stats.messages_saved += count - 1;
+        scheduler->callbacks.on_batch_assigned(scheduler, jobs, count, worker,
+                                                scheduler->callbacks.user_data);
+        return;
+    }
+
+    for (int i = 0; i < count && scheduler->callbacks.on_job_assigned; i++) {
+        scheduler->callbacks.on_job_assigned(scheduler, jobs[i], worker,
+                                              scheduler->callbacks.user_data);
+    }
+}
+
 int scheduler_process_queue(WorkScheduler* scheduler) {
     if (!scheduler || !scheduler->running) return 0;
 
     scheduler_lock(scheduler);
 
     int assigned = 0;
+    int batch_limit = scheduler->config.enable_job_coalescing &&
+                      scheduler->callbacks.on_batch_assigned ?
+                      scheduler->config.max_batch_size : 1;
+    if (batch_limit > MAX_BATCH_SIZE) batch_limit = MAX_BATCH_SIZE;
+    ScheduledJob* batch[MAX_BATCH_SIZE];
 
-    /* Process pending jobs */
-    while (scheduler->pending_head) {
-        ScheduledJob* job = scheduler->pending_head;
-
-        /* Check if dependencies satisfied */
-        bool deps_ok = true;
-        for (int i = 0; i < job->depends_count && deps_ok; i++) {
-            ScheduledJob* dep = scheduler_get_job(scheduler, job->depends_on[i]);
-            if (dep && dep->state != JOB_STATE_COMPLETED) {
-                deps_ok = false;
-            }
-        }
-
-        if (!deps_ok) {
-            break;  /* Wait for dependencies */
+    /* Process pending jobs in queue order, skipping those still blocked */
+    ScheduledJob* prev = NULL;
+    ScheduledJob* job = scheduler->pending_head;
+    while (job) {
+        if (!dependencies_met(scheduler, job)) {
+            prev = job;  /* Wait for dependencies; later jobs may be ready */
+            job = job->next;
+            continue;
         }
 
         /* Select worker */
@@ -909,22 +1516,43 @@ int scheduler_process_queue(WorkScheduler* scheduler) {
         }
 
         /* Assign job */
-        dequeue_job(scheduler);
-        job->state = JOB_STATE_ASSIGNED;
-        job->assigned_at = time(NULL);
-        job->assigned_worker_id = strdup(worker->id);
-        job->deadline = job->assigned_at + job->timeout_sec;
-
-        add_to_running(scheduler, job);
-        worker_registry_update_job_count(scheduler->worker_registry, worker, 1);
-        assigned++;
+        ScheduledJob* next = job->next;
+        dequeue_job(scheduler, prev, job);
+        assign_job(scheduler, job, worker);
+        batch[0] = job;
+        int batch_count = 1;
+
+        /*
+         * Fill the worker's remaining slots with other short ready jobs so
+         * they travel in one request. The batch grows with free slots and
+         * stays within jobs whose predicted time is overhead-dominated.
+         */
+        if (batch_limit > 1 && job_batchable(scheduler, job)) {
+            uint32_t caps = worker->capabilities;
+            ScheduledJob* scan_prev = prev;
+            ScheduledJob* candidate = next;
+            for (int scanned = 0; candidate && scanned < BATCH_SCAN_LIMIT &&
+                 batch_count < batch_limit && worker_has_batch_room(worker); scanned++) {
+                ScheduledJob* after = candidate->next;
+                uint32_t required = job_required_capabilities(candidate);
+
+                if (job_batchable(scheduler, candidate) && (caps & required) == required &&
+                    dependencies_met(scheduler, candidate)) {
+                    dequeue_job(scheduler, scan_prev, candidate);
+                    if (candidate == next) next = after;
+                    assign_job(scheduler, candidate, worker);
+                    batch[batch_count++] = candidate;
+                } else {
+                    scan_prev = candidate;
+                }
+                candidate = after;
+            }
+        }
 
-        log_debug("Job %s assigned to worker %s", job->job_id, worker->id);
+        assigned += batch_count;
+        notify_assigned(scheduler, batch, batch_count, worker);
 
-        if (scheduler->callbacks.on_job_assigned) {
-            scheduler->callbacks.on_job_assigned(scheduler, job, worker,
-                                                  scheduler->callbacks.user_data);
-        }
+        job = next;
     }
 
     scheduler_unlock(scheduler);
@@ -947,7 +1575,8 @@ int scheduler_check_timeouts(WorkScheduler* scheduler) {
             log_warning("Job timed out: %s", job->job_id);
 
             job->state = JOB_STATE_TIMEOUT;
-            scheduler_report_job_failure(scheduler, job->job_id, "Job timed out");
+            job->completed_at = now;
+            fail_job(scheduler, job, "Job timed out", difftime(now, job->assigned_at));
             timed_out++;
         }
 
@@ -958,6 +1587,79 @@ int scheduler_check_timeouts(WorkScheduler* scheduler) {
     return timed_out;
 }
 
+int scheduler_speculate_stragglers(WorkScheduler* scheduler) {
+    if (!scheduler || !scheduler->running || !scheduler->config.enable_speculative) return 0;
+
+    scheduler_lock(scheduler);
+
+    time_t now = time(NULL);
+    int launched = 0;
+
+    for (ScheduledJob* job = scheduler->running_head; job; job = job->next) {
+        if (job->speculative_worker_id || !job->assigned_worker_id) continue;
+
+        time_t started_at = job->started_at ? job->started_at : job->assigned_at;
+        double elapsed = difftime(now, started_at);
+        if (elapsed < SPECULATIVE_MIN_ELAPSED_SEC ||
+            elapsed < job->estimated_sec * scheduler->config.speculative_factor) {
+            continue;
+        }
+
+        WorkerSelectionCriteria criteria = {0};
+        criteria.required_capabilities = job_required_capabilities(job);
+        criteria.min_available_slots = 1;
+        criteria.prefer_fast = true;
+        criteria.exclude_worker_id = job->assigned_worker_id;
+
+        RemoteWorker* worker = worker_registry_select_worker(scheduler->worker_registry,
+                                                             &criteria);
+        if (!worker) {
+            continue;  /* Another straggler may fit elsewhere */
+        }
+
+        /* The duplicate gets a full timeout of its own */
+        job->speculative_worker_id = strdup(worker->id);
+        job->speculated_at = now;
+        job->deadline = now + job->timeout_sec;
+        worker_registry_update_job_count(scheduler->worker_registry, worker, 1);
+        scheduler->stats.speculative_launched++;
+        launched++;
+
+        log_info("Job %s running %.0fs (predicted %.1fs), duplicating on worker %s",
+                 job->job_id, elapsed, job->estimated_sec, worker->id);
+
+        if (scheduler->callbacks.on_job_assigned) {
+            scheduler->callbacks.on_job_assigned(scheduler, job, worker,
+                                                  scheduler->callbacks.user_data);
+        }
+    }
+
+    scheduler_unlock(scheduler);
+    return launched;
+}
+
+bool scheduler_check_job_timeout(WorkScheduler* scheduler, const char* job_id) {
+    if (!scheduler || !job_id) return false;
+
+    scheduler_lock(scheduler);
+
+    /* A stale timer may outlive its assignment; only the deadline decides */
+    ScheduledJob* job = find_running_job(scheduler, job_id);
+    time_t now = time(NULL);
+    bool timed_out = job && job->deadline > 0 && now >= job->deadline;
+
+    if (timed_out) {
+        log_warning("Job timed out: %s", job->job_id);
+
+        job->state = JOB_STATE_TIMEOUT;
+        job->completed_at = now;
+        fail_job(scheduler, job, "Job timed out", difftime(now, job->assigned_at));
+    }
+
+    scheduler_unlock(scheduler);
+    return timed_out;
+}
+
 /* ============================================================
  * Strategy Helpers
  * ============================================================ */
@@ -1085,6 +1787,7 @@ const char* lb_algorithm_name(LoadBalancingAlgorithm algo) {
         case LB_LEAST_LATENCY: return "LEAST_LATENCY";
         case LB_WEIGHTED: return "WEIGHTED";
         case LB_RANDOM: return "RANDOM";
+        case LB_CRITICAL_PATH: return "CRITICAL_PATH";
         default: return "UNKNOWN";
     }
 }
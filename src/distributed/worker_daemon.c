@@ -0,0 +1,1382 @@
+/**
+ * @file worker_daemon.c
+ * @brief Worker-side job executor for distributed builds
+ *
+ * A worker connects to the coordinator, advertises its capabilities and
+ * job slots in HELLO, and runs the jobs it is sent on a thread pool. Each
+ * job executes in its own temporary directory; outputs are stored in the
+ * local artifact cache under their content hash and streamed back to the
+ * coordinator with the file transfer protocol before JOB_COMPLETE is sent.
+ *
+ * Job flow:
+ *   coordinator JOB_REQUEST
+ *   worker      JOB_ACCEPT (or JOB_REJECT when all slots are busy)
+ *   worker      JOB_PROGRESS {phase: "running" | "uploading"}
+ *   worker      FILE_TRANSFER_* for each output (name = content hash)
+ *   worker      JOB_COMPLETE / JOB_FAILED with the artifact hashes
+ */
+
+#include "cyxmake/distributed/distributed.h"
+#include "cyxmake/security.h"
+#include "cyxmake/file_ops.h"
+#include "cyxmake/tool_executor.h"
+#include "cyxmake/logger.h"
+#include "cyxmake/compat.h"
+
+#include <cJSON.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#define getcwd _getcwd
+#else
+#include <unistd.h>
+#endif
+
+#ifdef CYXMAKE_ENABLE_DISTRIBUTED
+#include "cyxmake/threading.h"
+#endif
+
+/* ============================================================
+ * Constants
+ * ============================================================ */
+
+#define DEFAULT_MAX_JOBS 4
+#define DEFAULT_CACHE_DIR ".cyxmake/worker-cache"
+#define SANDBOX_DIR_NAME "cyxmake-worker"
+#define MAX_OUTPUT_CAPTURE (64 * 1024)
+#define HEARTBEAT_INTERVAL_MS 10000
+#define RUN_POLL_MS 100
+
+/* ============================================================
+ * Path Helpers
+ * ============================================================ */
+
+static bool path_is_absolute(const char* path) {
+#ifdef _WIN32
+    return path[0] == '\\' || path[0] == '/' || (path[0] && path[1] == ':');
+#else
+    return path[0] == '/';
+#endif
+}
+
+static char* path_join(const char* dir, const char* name) {
+    size_t len = strlen(dir) + strlen(name) + 2;
+    char* out = malloc(len);
+    if (out) snprintf(out, len, "%s%s%s", dir, DIR_SEP_STR, name);
+    return out;
+}
+
+static const char* path_basename(const char* path) {
+    const char* base = path;
+    for (const char* p = path; *p; p++) {
+        if (*p == '/' || *p == '\\') base = p + 1;
+    }
+    return base;
+}
+
+/* Jobs run with the sandbox as their cwd, so every path handed to them
+ * must be absolute */
+static char* absolute_path(const char* path) {
+    if (path_is_absolute(path)) return strdup(path);
+
+    char* cwd = getcwd(NULL, 0);
+    if (!cwd) return strdup(path);
+    char* resolved = path_join(cwd, path);
+    free(cwd);
+    return resolved;
+}
+
+/* Resolve a job input against the job's working directory, else ours */
+static char* resolve_input(const DistributedJob* job, const char* path) {
+    if (job->working_dir && !path_is_absolute(path)) {
+        char* joined = path_join(job->working_dir, path);
+        char* resolved = joined ? absolute_path(joined) : NULL;
+        free(joined);
+        return resolved;
+    }
+    return absolute_path(path);
+}
+
+/* Inputs are read in place (the worker does not stage them), so a job
+ * whose inputs are not visible here cannot run */
+#define MISSING_INPUT_ERROR \
+    "Input file not found on worker (distributed builds require a shared filesystem)"
+
+static char* require_input(const DistributedJob* job, const char* path,
+                           const char** error) {
+    char* resolved = resolve_input(job, path);
+    if (resolved && !file_exists(resolved)) {
+        log_error("Job %s: input %s not found on this worker",
+                  job->job_id ? job->job_id : "?", resolved);
+        *error = MISSING_INPUT_ERROR;
+        free(resolved);
+        return NULL;
+    }
+    return resolved;
+}
+
+static char* default_sandbox_root(void) {
+#ifdef _WIN32
+    const char* tmp = getenv("TEMP");
+    if (!tmp || !*tmp) tmp = ".";
+#else
+    const char* tmp = getenv("TMPDIR");
+    if (!tmp || !*tmp) tmp = "/tmp";
+#endif
+    return path_join(tmp, SANDBOX_DIR_NAME);
+}
+
+/* ============================================================
+ * Argument Lists
+ * ============================================================ */
+
+typedef struct {
+    char** argv;                  /* NULL-terminated */
+    int argc;
+    int capacity;
+} ArgList;
+
+static bool arg_push(ArgList* list, const char* value) {
+    if (list->argc + 2 > list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 16;
+        char** argv = realloc(list->argv, (size_t)capacity * sizeof(char*));
+        if (!argv) return false;
+        list->argv = argv;
+        list->capacity = capacity;
+    }
+    list->argv[list->argc] = strdup(value);
+    if (!list->argv[list->argc]) return false;
+    list->argc++;
+    list->argv[list->argc] = NULL;
+    return true;
+}
+
+static void arg_list_free(ArgList* list) {
+    for (int i = 0; i < list->argc; i++) free(list->argv[i]);
+    free(list->argv);
+    memset(list, 0, sizeof(*list));
+}
+
+static bool has_arg(const DistributedJob* job, const char* arg) {
+    for (size_t i = 0; i < job->arg_count; i++) {
+        if (job->compiler_args[i] && strcmp(job->compiler_args[i], arg) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Environment overrides are applied through env(1) so the worker's own
+ * environment is never modified by a job */
+static bool push_env_prefix(ArgList* list, const DistributedJob* job) {
+#ifdef _WIN32
+    (void)list;
+    if (job->env_count > 0) {
+        log_warning("Job %s: environment overrides are not supported on Windows",
+                    job->job_id ? job->job_id : "?");
+    }
+    return true;
+#else
+    if (job->env_count == 0) return true;
+    if (!arg_push(list, "env")) return false;
+    for (size_t i = 0; i < job->env_count; i++) {
+        if (job->env_vars[i] && !arg_push(list, job->env_vars[i])) return false;
+    }
+    return true;
+#endif
+}
+
+/**
+ * Build the command line for a job
+ * @param output Receives the path the job is expected to produce (or NULL)
+ * @param error Receives a static message when the job is malformed
+ */
+static bool build_command(const DistributedJob* job, const char* sandbox,
+                          ArgList* list, char** output, const char** error) {
+    *output = NULL;
+    if (!push_env_prefix(list, job)) return false;
+
+    if (job->type == JOB_TYPE_COMPILE || job->type == JOB_TYPE_LINK) {
+        bool compile = job->type == JOB_TYPE_COMPILE;
+        if (compile && !job->source_file) {
+            *error = "Compile job has no source file";
+            return false;
+        }
+        if (!arg_push(list, job->compiler ? job->compiler : "cc")) return false;
+
+        for (size_t i = 0; i < job->arg_count; i++) {
+            const char* arg = job->compiler_args[i];
+            if (!arg) continue;
+            /* Link inputs are object files relative to the submitter */
+            if (!compile && arg[0] != '-') {
+                char* input = require_input(job, arg, error);
+                bool ok = input && arg_push(list, input);
+                free(input);
+                if (!ok) return false;
+            } else if (!arg_push(list, arg)) {
+                return false;
+            }
+        }
+
+        for (size_t i = 0; i < job->include_count; i++) {
+            if (!job->include_paths[i]) continue;
+            char* dir = resolve_input(job, job->include_paths[i]);
+            if (!dir) return false;
+            size_t len = strlen(dir) + 3;
+            char* flag = malloc(len);
+            if (flag) snprintf(flag, len, "-I%s", dir);
+            free(dir);
+            bool ok = flag && arg_push(list, flag);
+            free(flag);
+            if (!ok) return false;
+        }
+
+        char name[512];
+        if (job->output_file) {
+            snprintf(name, sizeof(name), "%s", path_basename(job->output_file));
+        } else if (compile) {
+            snprintf(name, sizeof(name), "%s.o", path_basename(job->source_file));
+        } else {
+            snprintf(name, sizeof(name), "a.out");
+        }
+        *output = path_join(sandbox, name);
+        if (!*output) return false;
+
+        if (compile && !has_arg(job, "-c") && !arg_push(list, "-c")) return false;
+        if (!arg_push(list, "-o") || !arg_push(list, *output)) return false;
+
+        if (compile) {
+            char* source = require_input(job, job->source_file, error);
+            bool ok = source && arg_push(list, source);
+            free(source);
+            if (!ok) return false;
+        }
+        return true;
+    }
+
+    /* CMake, full build and custom jobs run their command through the shell */
+    if (!job->build_command) {
+        *error = "Job has no build command";
+        return false;
+    }
+#ifdef _WIN32
+    if (!arg_push(list, "cmd.exe") || !arg_push(list, "/c")) return false;
+#else
+    if (!arg_push(list, "/bin/sh") || !arg_push(list, "-c")) return false;
+#endif
+    if (!arg_push(list, job->build_command)) return false;
+
+    if (job->output_file) {
+        *output = path_is_absolute(job->output_file)
+            ? strdup(job->output_file)
+            : path_join(sandbox, job->output_file);
+        if (!*output) return false;
+    }
+    return true;
+}
+
+/* ============================================================
+ * Job Execution
+ * ============================================================ */
+
+static char* capture_output(const char* text) {
+    if (!text) return strdup("");
+    size_t len = strlen(text);
+    if (len <= MAX_OUTPUT_CAPTURE) return strdup(text);
+
+    static const char marker[] = "\n[output truncated]\n";
+    char* out = malloc(MAX_OUTPUT_CAPTURE + sizeof(marker));
+    if (!out) return NULL;
+    memcpy(out, text, MAX_OUTPUT_CAPTURE);
+    memcpy(out + MAX_OUTPUT_CAPTURE, marker, sizeof(marker));
+    return out;
+}
+
+static void append_text(char** dst, const char* text) {
+    size_t old_len = *dst ? strlen(*dst) : 0;
+    size_t add = strlen(text);
+    char* grown = realloc(*dst, old_len + add + 2);
+    if (!grown) return;
+    if (old_len > 0 && grown[old_len - 1] != '\n') {
+        grown[old_len++] = '\n';
+    }
+    memcpy(grown + old_len, text, add + 1);
+    *dst = grown;
+}
+
+static DistributedJobResult* job_result_failed(const DistributedJob* job,
+                                                const char* error) {
+    DistributedJobResult* result = calloc(1, sizeof(DistributedJobResult));
+    if (!result) return NULL;
+    result->job_id = job->job_id ? strdup(job->job_id) : NULL;
+    result->success = false;
+    result->exit_code = -1;
+    result->stdout_output = strdup("");
+    result->stderr_output = strdup(error);
+    return result;
+}
+
+/* Store the job output in the cache and record it in the result */
+static bool collect_output(const DistributedJob* job, const char* output,
+                           ArtifactCache* cache, DistributedJobResult* result) {
+    if (!file_exists(output)) {
+        char msg[600];
+        snprintf(msg, sizeof(msg), "Expected output was not produced: %s",
+                 path_basename(output));
+        append_text(&result->stderr_output, msg);
+        return false;
+    }
+
+    char* hash = artifact_hash_file(output);
+    if (!hash) {
+        append_text(&result->stderr_output, "Failed to hash job output");
+        return false;
+    }
+
+    if (cache) {
+        ArtifactType type = job->type == JOB_TYPE_COMPILE
+            ? ARTIFACT_OBJECT_FILE : ARTIFACT_OTHER;
+        if (!artifact_cache_contains(cache, hash) &&
+            !artifact_cache_store(cache, hash, output, type, NULL)) {
+            append_text(&result->stderr_output, "Failed to store job output in cache");
+            free(hash);
+            return false;
+        }
+    }
+
+    result->artifact_paths = calloc(1, sizeof(char*));
+    result->artifact_hashes = calloc(1, sizeof(char*));
+    if (!result->artifact_paths || !result->artifact_hashes) {
+        free(hash);
+        return false;
+    }
+    result->artifact_paths[0] = strdup(job->output_file
+        ? job->output_file : path_basename(output));
+    result->artifact_hashes[0] = hash;
+    result->artifact_count = 1;
+    return true;
+}
+
+DistributedJobResult* worker_execute_job(const DistributedJob* job,
+                                          const char* sandbox_root,
+                                          ArtifactCache* cache,
+                                          bool restrict_resources) {
+    if (!job) return NULL;
+
+    char* root = sandbox_root ? absolute_path(sandbox_root) : default_sandbox_root();
+    char* id = protocol_generate_uuid();
+    char* sandbox = NULL;
+    if (root && id) {
+        size_t len = strlen(root) + strlen(id) + 6;
+        sandbox = malloc(len);
+        if (sandbox) snprintf(sandbox, len, "%s%sjob-%s", root, DIR_SEP_STR, id);
+    }
+    free(id);
+    free(root);
+
+    if (!sandbox || !dir_create(sandbox)) {
+        log_error("Failed to create sandbox directory for job %s",
+                  job->job_id ? job->job_id : "?");
+        free(sandbox);
+        return job_result_failed(job, "Failed to create sandbox directory");
+    }
+
+    ArgList args = {0};
+    char* output = NULL;
+    const char* error = "Out of memory";
+    if (!build_command(job, sandbox, &args, &output, &error)) {
+        arg_list_free(&args);
+        free(output);
+        dir_delete_recursive(sandbox);
+        free(sandbox);
+        return job_result_failed(job, error);
+    }
+
+    SandboxConfig limits = sandbox_config_default(
+        restrict_resources ? SANDBOX_LIGHT : SANDBOX_NONE);
+    limits.allow_subprocesses = true;  /* Compiler drivers spawn cc1, as, ld */
+    if (restrict_resources && job->timeout_sec > 0) {
+        limits.max_cpu_sec = job->timeout_sec;
+    }
+
+    log_debug("Job %s: running %s in %s",
+              job->job_id ? job->job_id : "?", args.argv[0], sandbox);
+
+    uint64_t started = protocol_get_timestamp_ms();
+    SandboxResult* run = sandbox_execute(args.argv[0], args.argv, sandbox, &limits);
+    uint64_t finished = protocol_get_timestamp_ms();
+    arg_list_free(&args);
+
+    DistributedJobResult* result = calloc(1, sizeof(DistributedJobResult));
+    if (!result || !run) {
+        free(result);
+        sandbox_result_free(run);
+        free(output);
+        dir_delete_recursive(sandbox);
+        free(sandbox);
+        return job_result_failed(job, "Failed to execute job");
+    }
+
+    result->job_id = job->job_id ? strdup(job->job_id) : NULL;
+    result->exit_code = run->exit_code;
+    result->success = run->success;
+    result->stdout_output = capture_output(run->stdout_output);
+    result->stderr_output = capture_output(run->stderr_output);
+    result->duration_sec = (double)(finished - started) / 1000.0;
+    result->cpu_time_sec = run->cpu_time_used;
+
+    if (run->was_killed) {
+        append_text(&result->stderr_output,
+                    run->kill_reason ? run->kill_reason : "Job was killed");
+    }
+    sandbox_result_free(run);
+
+    if (result->success && output) {
+        result->success = collect_output(job, output, cache, result);
+    }
+
+    free(output);
+    dir_delete_recursive(sandbox);
+    free(sandbox);
+    return result;
+}
+
+/* ============================================================
+ * Worker Client Configuration
+ * ============================================================ */
+
+WorkerClientConfig worker_client_config_default(void) {
+    WorkerClientConfig config = {
+        .name = NULL,
+        .coordinator_url = NULL,
+        .auth_token = NULL,
+        .json_frames = false,
+        .max_jobs = DEFAULT_MAX_JOBS,
+        .auto_detect_tools = true,
+        .auto_reconnect = true,
+        .reconnect_delay_sec = 5,
+        .max_reconnect_attempts = 10,
+        .enable_sandbox = false,
+        .sandbox_dir = NULL,
+        .cache_dir = NULL
+    };
+    return config;
+}
+
+void worker_client_config_free(WorkerClientConfig* config) {
+    if (!config) return;
+    free(config->name);
+    free(config->coordinator_url);
+    free(config->auth_token);
+    free(config->sandbox_dir);
+    free(config->cache_dir);
+}
+
+#ifdef CYXMAKE_ENABLE_DISTRIBUTED
+
+/* ============================================================
+ * Worker Client Structure
+ * ============================================================ */
+
+typedef struct RunningJob {
+    char* job_id;
+    bool cancelled;               /* Result is discarded when the job ends */
+    struct RunningJob* next;
+} RunningJob;
+
+/* A finished job waiting for its outputs to reach the coordinator */
+typedef struct PendingResult {
+    DistributedJobResult* result;
+    int uploads_left;
+    bool upload_failed;
+    struct PendingResult* next;
+} PendingResult;
+
+typedef struct ArtifactUpload {
+    FileTransferSender* sender;
+    PendingResult* owner;
+    struct ArtifactUpload* next;
+} ArtifactUpload;
+
+struct WorkerClient {
+    WorkerClientConfig config;
+    WorkerClientCallbacks callbacks;
+
+    /* Components */
+    NetworkClient* net;
+    ThreadPool* pool;
+    ArtifactCache* cache;
+    char* sandbox_root;
+    uint32_t capabilities;
+
+    /* State */
+    char* worker_id;
+    RunningJob* jobs;
+    int active_jobs;
+    PendingResult* results;
+    ArtifactUpload* uploads;
+    volatile bool running;
+
+    MutexHandle mutex;
+};
+
+typedef struct {
+    WorkerClient* client;
+    DistributedJob* job;
+} JobTask;
+
+/* ============================================================
+ * Capabilities and System Info
+ * ============================================================ */
+
+static uint32_t detect_capabilities(const WorkerClientConfig* config) {
+    static const struct {
+        const char* tool;
+        uint32_t caps;
+    } probes[] = {
+        { "cc",      WORKER_CAP_COMPILE_C },
+        { "gcc",     WORKER_CAP_COMPILE_C },
+        { "clang",   WORKER_CAP_COMPILE_C },
+        { "c++",     WORKER_CAP_COMPILE_CPP },
+        { "g++",     WORKER_CAP_COMPILE_CPP },
+        { "clang++", WORKER_CAP_COMPILE_CPP },
+        { "cl",      WORKER_CAP_MSVC | WORKER_CAP_COMPILE_C | WORKER_CAP_COMPILE_CPP },
+        { "cmake",   WORKER_CAP_CMAKE },
+        { "make",    WORKER_CAP_MAKE },
+        { "ninja",   WORKER_CAP_NINJA },
+        { "msbuild", WORKER_CAP_MSBUILD }
+    };
+
+    uint32_t caps = 0;
+    if (config->auto_detect_tools) {
+        for (size_t i = 0; i < sizeof(probes) / sizeof(probes[0]); i++) {
+            if ((caps & probes[i].caps) == probes[i].caps) continue;
+            char* path = tool_find_in_path(probes[i].tool);
+            if (path) {
+                caps |= probes[i].caps;
+                free(path);
+            }
+        }
+    } else {
+        caps = WORKER_CAP_COMPILE_C | WORKER_CAP_COMPILE_CPP;
+    }
+
+    if (caps & (WORKER_CAP_COMPILE_C | WORKER_CAP_COMPILE_CPP)) {
+        caps |= WORKER_CAP_LINK;
+    }
+    if (config->enable_sandbox) {
+        caps |= WORKER_CAP_SANDBOX;
+    }
+    return caps | WORKER_CAP_JOB_BATCH;
+}
+
+static void fill_system_info(WorkerSystemInfo* info) {
+#if defined(__x86_64__) || defined(_M_X64)
+    info->arch = "x86_64";
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    info->arch = "arm64";
+#elif defined(__i386__) || defined(_M_IX86)
+    info->arch = "x86";
+#elif defined(__arm__) || defined(_M_ARM)
+    info->arch = "arm";
+#else
+    info->arch = "unknown";
+#endif
+
+#if defined(CYXMAKE_WINDOWS)
+    info->os = "windows";
+#elif defined(CYXMAKE_MACOS)
+    info->os = "darwin";
+#elif defined(CYXMAKE_LINUX)
+    info->os = "linux";
+#else
+    info->os = "unknown";
+#endif
+
+    info->cpu_cores = thread_get_cpu_count();
+    info->cpu_threads = info->cpu_cores;
+}
+
+/* ============================================================
+ * Outgoing Messages
+ * ============================================================ */
+
+static void send_json(WorkerClient* client, ProtocolMessageType type,
+                      const char* job_id, cJSON* payload) {
+    ProtocolMessage* msg = protocol_message_create(type);
+    if (!msg) {
+        cJSON_Delete(payload);
+        return;
+    }
+    if (job_id) msg->correlation_id = strdup(job_id);
+
+    if (payload) {
+        char* json = cJSON_PrintUnformatted(payload);
+        if (json) {
+            protocol_message_set_payload(msg, json);
+            free(json);
+        }
+        cJSON_Delete(payload);
+    }
+
+    network_client_send(client->net, msg);
+    protocol_message_free(msg);
+}
+
+static void send_hello(WorkerClient* client) {
+    WorkerSystemInfo info = {0};
+    fill_system_info(&info);
+
+    char* system = worker_system_info_to_json(&info);
+    cJSON* payload = system ? cJSON_Parse(system) : NULL;
+    free(system);
+    if (!payload) payload = cJSON_CreateObject();
+    if (!payload) return;
+
+    if (client->config.name) {
+        cJSON_AddStringToObject(payload, "name", client->config.name);
+    }
+    cJSON_AddNumberToObject(payload, "max_jobs", client->config.max_jobs);
+
+    cJSON* caps = cJSON_AddArrayToObject(payload, "capabilities");
+    for (int bit = 0; caps && bit < 32; bit++) {
+        uint32_t cap = 1u << bit;
+        if (client->capabilities & cap) {
+            const char* name = worker_capability_name((WorkerCapability)cap);
+            if (name) cJSON_AddItemToArray(caps, cJSON_CreateString(name));
+        }
+    }
+
+    if (client->config.auth_token) {
+        cJSON_AddStringToObject(payload, "auth_token", client->config.auth_token);
+    }
+
+    send_json(client, PROTO_MSG_HELLO, NULL, payload);
+}
+
+static void send_progress(WorkerClient* client, const char* job_id,
+                          const char* phase, int percent) {
+    cJSON* payload = cJSON_CreateObject();
+    if (!payload) return;
+    cJSON_AddStringToObject(payload, "job_id", job_id);
+    cJSON_AddStringToObject(payload, "phase", phase);
+    cJSON_AddNumberToObject(payload, "percent", percent);
+    send_json(client, PROTO_MSG_JOB_PROGRESS, job_id, payload);
+}
+
+static void send_job_status(WorkerClient* client, ProtocolMessageType type,
+                            const char* job_id, const char* reason) {
+    cJSON* payload = cJSON_CreateObject();
+    if (!payload) return;
+    cJSON_AddStringToObject(payload, "job_id", job_id);
+    if (reason) cJSON_AddStringToObject(payload, "reason", reason);
+    send_json(client, type, job_id, payload);
+}
+
+/* ============================================================
+ * Artifact Uploads (caller holds the mutex)
+ * ============================================================ */
+
+static void pump_upload(WorkerClient* client, ArtifactUpload* upload) {
+    ProtocolMessage* msg;
+    while ((msg = file_transfer_sender_next(upload->sender)) != NULL) {
+        bool sent = network_client_send(client->net, msg);
+        protocol_message_free(msg);
+        if (!sent) {
+            file_transfer_sender_rewind(upload->sender);
+            break;
+        }
+    }
+}
+
+static void finish_pending(WorkerClient* client, PendingResult* pending) {
+    for (PendingResult** pp = &client->results; *pp; pp = &(*pp)->next) {
+        if (*pp == pending) {
+            *pp = pending->next;
+            break;
+        }
+    }
+
+    DistributedJobResult* result = pending->result;
+    if (pending->upload_failed) {
+        result->success = false;
+        append_text(&result->stderr_output, "Failed to upload job outputs");
+    }
+    worker_client_report_result(client, result->job_id, result);
+    distributed_job_result_free(result);
+    free(pending);
+}
+
+static void drop_uploads(WorkerClient* client) {
+    while (client->uploads) {
+        ArtifactUpload* upload = client->uploads;
+        client->uploads = upload->next;
+        file_transfer_sender_free(upload->sender);
+        free(upload);
+    }
+    while (client->results) {
+        PendingResult* pending = client->results;
+        client->results = pending->next;
+        distributed_job_result_free(pending->result);
+        free(pending);
+    }
+}
+
+/* Upload the job's outputs, then report; takes ownership of result */
+static void deliver_result(WorkerClient* client, DistributedJobResult* result) {
+    if (!result->success || result->artifact_count == 0 || !client->cache) {
+        worker_client_report_result(client, result->job_id, result);
+        distributed_job_result_free(result);
+        return;
+    }
+
+    PendingResult* pending = calloc(1, sizeof(PendingResult));
+    if (!pending) {
+        worker_client_report_result(client, result->job_id, result);
+        distributed_job_result_free(result);
+        return;
+    }
+    pending->result = result;
+
+    send_progress(client, result->job_id, "uploading", 90);
+
+    mutex_lock(&client->mutex);
+
+    for (size_t i = 0; i < result->artifact_count; i++) {
+        const char* hash = result->artifact_hashes[i];
+        ArtifactEntry* entry = hash ? artifact_cache_get(client->cache, hash) : NULL;
+        FileTransferSender* sender = entry && entry->cached_path
+            ? file_transfer_sender_create(entry->cached_path, hash, NULL)
+            : NULL;
+        ArtifactUpload* upload = sender ? calloc(1, sizeof(ArtifactUpload)) : NULL;
+        if (!upload) {
+            file_transfer_sender_free(sender);
+            pending->upload_failed = true;
+            continue;
+        }
+        upload->sender = sender;
+        upload->owner = pending;
+        upload->next = client->uploads;
+        client->uploads = upload;
+        pending->uploads_left++;
+    }
+
+    if (pending->uploads_left == 0) {
+        finish_pending(client, pending);
+    } else {
+        pending->next = client->results;
+        client->results = pending;
+        for (ArtifactUpload* u = client->uploads; u; u = u->next) {
+            if (u->owner == pending) pump_upload(client, u);
+        }
+    }
+
+    mutex_unlock(&client->mutex);
+}
+
+static void handle_transfer_ack(WorkerClient* client, const ProtocolMessage* msg) {
+    mutex_lock(&client->mutex);
+
+    ArtifactUpload** pp = &client->uploads;
+    while (*pp) {
+        ArtifactUpload* upload = *pp;
+        file_transfer_sender_handle_ack(upload->sender, msg);
+        FileTransferState state = file_transfer_sender_get_state(upload->sender);
+
+        if (state == FILE_TRANSFER_COMPLETE || state == FILE_TRANSFER_FAILED) {
+            PendingResult* owner = upload->owner;
+            if (state == FILE_TRANSFER_FAILED) owner->upload_failed = true;
+            *pp = upload->next;
+            file_transfer_sender_free(upload->sender);
+            free(upload);
+            if (--owner->uploads_left == 0) finish_pending(client, owner);
+            continue;
+        }
+
+        pump_upload(client, upload);
+        pp = &upload->next;
+    }
+
+    mutex_unlock(&client->mutex);
+}
+
+/* ============================================================
+ * Job Handling
+ * ============================================================ */
+
+static void report_failure(WorkerClient* client, const DistributedJob* job,
+                           const char* error) {
+    DistributedJobResult* result = job_result_failed(job, error);
+    if (result) {
+        worker_client_report_result(client, job->job_id, result);
+        distributed_job_result_free(result);
+    }
+}
+
+/* Remove a job from the running list; returns whether it was cancelled */
+static bool release_job(WorkerClient* client, const char* job_id) {
+    bool cancelled = false;
+    mutex_lock(&client->mutex);
+    for (RunningJob** pp = &client->jobs; *pp; pp = &(*pp)->next) {
+        RunningJob* job = *pp;
+        if (strcmp(job->job_id, job_id) == 0) {
+            cancelled = job->cancelled;
+            *pp = job->next;
+            free(job->job_id);
+            free(job);
+            client->active_jobs--;
+            break;
+        }
+    }
+    mutex_unlock(&client->mutex);
+    return cancelled;
+}
+
+static void job_task(void* arg) {
+    JobTask* task = (JobTask*)arg;
+    WorkerClient* client = task->client;
+    DistributedJob* job = task->job;
+
+    send_progress(client, job->job_id, "running", 0);
+
+    DistributedJobResult* result = worker_execute_job(
+        job, client->sandbox_root, client->cache, client->config.enable_sandbox);
+
+    if (release_job(client, job->job_id)) {
+        /* Cancelled by the coordinator meanwhile; the slot is free now */
+        log_debug("Discarding result of cancelled job %s", job->job_id);
+        distributed_job_result_free(result);
+        send_job_status(client, PROTO_MSG_JOB_CANCELLED, job->job_id, NULL);
+    } else if (!result) {
+        report_failure(client, job, "Failed to execute job");
+    } else {
+        log_info("Job %s %s in %.2fs", job->job_id,
+                 result->success ? "completed" : "failed", result->duration_sec);
+        deliver_result(client, result);
+    }
+
+    distributed_job_free(job);
+    free(task);
+}
+
+/* Accept or reject one job, taking ownership of it (NULL = malformed) */
+static void start_job(WorkerClient* client, DistributedJob* job, const char* fallback_id) {
+    const char* job_id = job && job->job_id ? job->job_id : fallback_id;
+    if (!job_id) {
+        log_warning("Ignoring job request without a job ID");
+        distributed_job_free(job);
+        return;
+    }
+
+    const char* reason = NULL;
+    RunningJob* running = NULL;
+
+    mutex_lock(&client->mutex);
+    if (!job) {
+        reason = "Malformed job";
+    } else if (client->active_jobs >= client->config.max_jobs) {
+        reason = "No free job slots";
+    } else if ((running = calloc(1, sizeof(RunningJob))) == NULL ||
+               (running->job_id = strdup(job_id)) == NULL) {
+        free(running);
+        running = NULL;
+        reason = "Out of memory";
+    } else {
+        running->next = client->jobs;
+        client->jobs = running;
+        client->active_jobs++;
+    }
+    mutex_unlock(&client->mutex);
+
+    if (reason) {
+        log_debug("Rejecting job %s: %s", job_id, reason);
+        send_job_status(client, PROTO_MSG_JOB_REJECT, job_id, reason);
+        distributed_job_free(job);
+        return;
+    }
+
+    send_job_status(client, PROTO_MSG_JOB_ACCEPT, job_id, NULL);
+
+    if (client->callbacks.on_job_received) {
+        client->callbacks.on_job_received(client, job, client->callbacks.user_data);
+    }
+
+    JobTask* task = malloc(sizeof(JobTask));
+    if (task) {
+        task->client = client;
+        task->job = job;
+    }
+    if (!task || !thread_pool_submit(client->pool, job_task, task)) {
+        free(task);
+        release_job(client, job->job_id);
+        report_failure(client, job, "Failed to queue job");
+        distributed_job_free(job);
+    }
+}
+
+static void handle_job_request(WorkerClient* client, const ProtocolMessage* msg) {
+    DistributedJob* job = msg->payload_json
+        ? distributed_job_from_json(msg->payload_json) : NULL;
+
+    /* The coordinator tracks the job by the request's correlation ID */
+    if (job && msg->correlation_id) {
+        free(job->job_id);
+        job->job_id = strdup(msg->correlation_id);
+    }
+    start_job(client, job, msg->correlation_id);
+}
+
+/* Several jobs in one request; each is accepted and reported on its own */
+static void handle_job_batch(WorkerClient* client, const ProtocolMessage* msg) {
+    cJSON* payload = msg->payload_json ? cJSON_Parse(msg->payload_json) : NULL;
+    cJSON* jobs = payload ? cJSON_GetObjectItem(payload, "jobs") : NULL;
+    if (!cJSON_IsArray(jobs)) {
+        log_warning("Ignoring malformed JOB_BATCH");
+        cJSON_Delete(payload);
+        return;
+    }
+
+    cJSON* item;
+    cJSON_ArrayForEach(item, jobs) {
+        cJSON* id = cJSON_GetObjectItem(item, "job_id");
+        char* json = cJSON_PrintUnformatted(item);
+        DistributedJob* job = json ? distributed_job_from_json(json) : NULL;
+        free(json);
+        start_job(client, job, cJSON_IsString(id) ? id->valuestring : NULL);
+    }
+
+    cJSON_Delete(payload);
+}
+
+static void handle_job_cancel(WorkerClient* client, const ProtocolMessage* msg) {
+    if (!msg->correlation_id) return;
+
+    bool found = false;
+    mutex_lock(&client->mutex);
+    for (RunningJob* job = client->jobs; job; job = job->next) {
+        if (strcmp(job->job_id, msg->correlation_id) == 0) {
+            job->cancelled = true;
+            found = true;
+            break;
+        }
+    }
+    mutex_unlock(&client->mutex);
+
+    /*
+     * The process runs to completion and keeps its slot; JOB_CANCELLED is
+     * sent when it exits. A job that already finished is reported now.
+     */
+    if (!found) {
+        send_job_status(client, PROTO_MSG_JOB_CANCELLED, msg->correlation_id, NULL);
+    }
+}
+
+/* ============================================================
+ * Network Callbacks
+ * ============================================================ */
+
+static void on_net_message(NetworkConnection* conn, ProtocolMessage* msg,
+                           void* user_data) {
+    (void)conn;
+    WorkerClient* client = (WorkerClient*)user_data;
+    if (!client || !msg) return;
+
+    switch (msg->type) {
+        case PROTO_MSG_WELCOME: {
+            cJSON* payload = msg->payload_json ? cJSON_Parse(msg->payload_json) : NULL;
+            cJSON* id = payload ? cJSON_GetObjectItem(payload, "worker_id") : NULL;
+            mutex_lock(&client->mutex);
+            free(client->worker_id);
+            client->worker_id = cJSON_IsString(id) ? strdup(id->valuestring) : NULL;
+            mutex_unlock(&client->mutex);
+            cJSON_Delete(payload);
+
+            log_info("Registered with coordinator as %s (%d job slots)",
+                     client->worker_id ? client->worker_id : "(unnamed)",
+                     client->config.max_jobs);
+            if (client->callbacks.on_connected) {
+                client->callbacks.on_connected(client, client->callbacks.user_data);
+            }
+            break;
+        }
+
+        case PROTO_MSG_AUTH_FAILED:
+            log_error("Coordinator rejected authentication");
+            if (client->callbacks.on_error) {
+                client->callbacks.on_error(client, "Authentication failed",
+                                           client->callbacks.user_data);
+            }
+            client->running = false;
+            break;
+
+        case PROTO_MSG_JOB_REQUEST:
+            handle_job_request(client, msg);
+            break;
+
+        case PROTO_MSG_JOB_BATCH:
+            handle_job_batch(client, msg);
+            break;
+
+        case PROTO_MSG_JOB_CANCEL:
+            handle_job_cancel(client, msg);
+            break;
+
+        case PROTO_MSG_FILE_TRANSFER_ACK:
+            handle_transfer_ack(client, msg);
+            break;
+
+        case PROTO_MSG_SHUTDOWN:
+            log_info("Coordinator requested shutdown");
+            client->running = false;
+            break;
+
+        case PROTO_MSG_ERROR:
+            log_warning("Coordinator error: %s",
+                        msg->payload_json ? msg->payload_json : "(no details)");
+            if (client->callbacks.on_error) {
+                client->callbacks.on_error(client, msg->payload_json,
+                                           client->callbacks.user_data);
+            }
+            break;
+
+        default:
+            log_debug("Ignoring %s from coordinator",
+                      protocol_message_type_name(msg->type));
+            break;
+    }
+}
+
+static void on_net_connect(NetworkConnection* conn, void* user_data) {
+    (void)conn;
+    WorkerClient* client = (WorkerClient*)user_data;
+    log_info("Connected to coordinator, sending HELLO");
+    send_hello(client);
+}
+
+static void on_net_disconnect(NetworkConnection* conn, const char* reason,
+                              void* user_data) {
+    (void)conn;
+    WorkerClient* client = (WorkerClient*)user_data;
+
+    /* The coordinator reschedules everything this worker held, so results
+     * that arrive after a reconnect would be duplicates */
+    mutex_lock(&client->mutex);
+    drop_uploads(client);
+    for (RunningJob* job = client->jobs; job; job = job->next) {
+        job->cancelled = true;
+    }
+    free(client->worker_id);
+    client->worker_id = NULL;
+    mutex_unlock(&client->mutex);
+
+    log_warning("Disconnected from coordinator: %s", reason ? reason : "unknown");
+    if (client->callbacks.on_disconnected) {
+        client->callbacks.on_disconnected(client, reason, client->callbacks.user_data);
+    }
+}
+
+static void on_net_error(NetworkConnection* conn, const char* error, void* user_data) {
+    (void)conn;
+    WorkerClient* client = (WorkerClient*)user_data;
+    log_error("Worker connection error: %s", error ? error : "unknown");
+    if (client->callbacks.on_error) {
+        client->callbacks.on_error(client, error, client->callbacks.user_data);
+    }
+}
+
+/* ============================================================
+ * Worker Client Lifecycle
+ * ============================================================ */
+
+static char* dup_or_null(const char* s) {
+    return s ? strdup(s) : NULL;
+}
+
+WorkerClient* worker_client_create(const WorkerClientConfig* config) {
+    WorkerClient* client = calloc(1, sizeof(WorkerClient));
+    if (!client) return NULL;
+
+    client->config = config ? *config : worker_client_config_default();
+    client->config.name = dup_or_null(client->config.name);
+    client->config.coordinator_url = dup_or_null(client->config.coordinator_url);
+    client->config.auth_token = dup_or_null(client->config.auth_token);
+    client->config.sandbox_dir = dup_or_null(client->config.sandbox_dir);
+    client->config.cache_dir = dup_or_null(client->config.cache_dir);
+    if (client->config.max_jobs <= 0) {
+        client->config.max_jobs = thread_get_cpu_count();
+    }
+
+    if (!mutex_init(&client->mutex)) {
+        worker_client_config_free(&client->config);
+        free(client);
+        return NULL;
+    }
+
+    client->sandbox_root = client->config.sandbox_dir
+        ? absolute_path(client->config.sandbox_dir) : default_sandbox_root();
+    if (!client->sandbox_root || !dir_create(client->sandbox_root)) {
+        log_error("Failed to create sandbox root: %s",
+                  client->sandbox_root ? client->sandbox_root : "(null)");
+        worker_client_free(client);
+        return NULL;
+    }
+
+    ArtifactCacheConfig cache_config = artifact_cache_config_default();
+    cache_config.cache_dir = client->config.cache_dir
+        ? client->config.cache_dir : DEFAULT_CACHE_DIR;
+    client->cache = artifact_cache_create(&cache_config);
+    if (!client->cache || !artifact_cache_init(client->cache)) {
+        log_error("Failed to initialize worker artifact cache");
+        worker_client_free(client);
+        return NULL;
+    }
+
+    client->pool = thread_pool_create(client->config.max_jobs);
+    if (!client->pool) {
+        log_error("Failed to create worker thread pool");
+        worker_client_free(client);
+        return NULL;
+    }
+
+    NetworkConfig net_config = {0};
+    net_config.connection_timeout_sec = 10;
+    net_config.ping_interval_sec = 30;
+    net_config.wire_format = client->config.json_frames
+        ? PROTO_WIRE_JSON : PROTO_WIRE_BINARY;
+    client->net = network_client_create(&net_config);
+    if (!client->net) {
+        log_error("Failed to create network client");
+        worker_client_free(client);
+        return NULL;
+    }
+
+    NetworkClientCallbacks net_cbs = {
+        .on_message = on_net_message,
+        .on_connect = on_net_connect,
+        .on_disconnect = on_net_disconnect,
+        .on_error = on_net_error,
+        .user_data = client
+    };
+    network_client_set_callbacks(client->net, &net_cbs);
+    network_client_set_auto_reconnect(client->net, client->config.auto_reconnect,
+                                      client->config.reconnect_delay_sec * 1000,
+                                      client->config.max_reconnect_attempts);
+
+    client->capabilities = detect_capabilities(&client->config);
+
+    log_info("Worker created: %d job slots, sandbox %s",
+             client->config.max_jobs, client->sandbox_root);
+    return client;
+}
+
+void worker_client_free(WorkerClient* client) {
+    if (!client) return;
+
+    client->running = false;
+
+    /* Stop the service thread first so no new jobs arrive */
+    if (client->net) {
+        network_client_disconnect(client->net);
+    }
+    if (client->pool) {
+        thread_pool_wait_all(client->pool);
+        thread_pool_free(client->pool);
+    }
+    network_client_free(client->net);
+
+    drop_uploads(client);
+    while (client->jobs) {
+        RunningJob* job = client->jobs;
+        client->jobs = job->next;
+        free(job->job_id);
+        free(job);
+    }
+
+    artifact_cache_free(client->cache);
+    free(client->sandbox_root);
+    free(client->worker_id);
+    worker_client_config_free(&client->config);
+    mutex_destroy(&client->mutex);
+    free(client);
+}
+
+void worker_client_set_callbacks(WorkerClient* client,
+                                  const WorkerClientCallbacks* callbacks) {
+    if (!client || !callbacks) return;
+    client->callbacks = *callbacks;
+}
+
+bool worker_client_connect(WorkerClient* client) {
+    if (!client || !client->config.coordinator_url) {
+        log_error("No coordinator URL configured");
+        return false;
+    }
+
+    const char* url = client->config.coordinator_url;
+    char* full_url = NULL;
+    if (!strstr(url, "://")) {
+        size_t len = strlen(url) + 6;
+        full_url = malloc(len);
+        if (!full_url) return false;
+        snprintf(full_url, len, "ws://%s", url);
+        url = full_url;
+    }
+
+    client->running = true;
+    bool ok = network_client_connect(client->net, url);
+    if (!ok) {
+        log_error("Failed to connect to coordinator at %s", url);
+        client->running = false;
+    }
+    free(full_url);
+    return ok;
+}
+
+void worker_client_disconnect(WorkerClient* client) {
+    if (!client) return;
+    client->running = false;
+    network_client_disconnect(client->net);
+}
+
+bool worker_client_is_connected(WorkerClient* client) {
+    return client && network_client_is_connected(client->net);
+}
+
+void worker_client_run(WorkerClient* client) {
+    if (!client) return;
+
+    uint64_t last_heartbeat = protocol_get_timestamp_ms();
+    bool was_connected = false;
+
+    while (client->running) {
+        thread_sleep(RUN_POLL_MS);
+
+        TransportState state = network_client_get_state(client->net);
+        if (state == TRANSPORT_CONNECTED) {
+            was_connected = true;
+        } else if (was_connected && !client->config.auto_reconnect &&
+                   (state == TRANSPORT_DISCONNECTED || state == TRANSPORT_ERROR)) {
+            log_info("Connection closed, worker stopping");
+            break;
+        }
+
+        uint64_t now = protocol_get_timestamp_ms();
+        if (state == TRANSPORT_CONNECTED && client->worker_id &&
+            now - last_heartbeat >= HEARTBEAT_INTERVAL_MS) {
+            cJSON* payload = cJSON_CreateObject();
+            if (payload) {
+                cJSON_AddNumberToObject(payload, "active_jobs",
+                                        worker_client_get_active_jobs(client));
+                cJSON_AddNumberToObject(payload, "max_jobs", client->config.max_jobs);
+                send_json(client, PROTO_MSG_HEARTBEAT, NULL, payload);
+            }
+            last_heartbeat = now;
+        }
+    }
+
+    client->running = false;
+}
+
+void worker_client_stop(WorkerClient* client) {
+    if (client) client->running = false;
+}
+
+bool worker_client_report_result(WorkerClient* client,
+                                  const char* job_id,
+                                  DistributedJobResult* result) {
+    if (!client || !job_id || !result) return false;
+
+    ProtocolMessage* msg = protocol_message_create(
+        result->success ? PROTO_MSG_JOB_COMPLETE : PROTO_MSG_JOB_FAILED);
+    if (!msg) return false;
+    msg->correlation_id = strdup(job_id);
+
+    char* json = distributed_job_result_to_json(result);
+    if (json) {
+        protocol_message_set_payload(msg, json);
+        free(json);
+    }
+
+    bool ok = network_client_send(client->net, msg);
+    protocol_message_free(msg);
+    return ok;
+}
+
+const char* worker_client_get_id(WorkerClient* client) {
+    return client ? client->worker_id : NULL;
+}
+
+int worker_client_get_active_jobs(WorkerClient* client) {
+    if (!client) return 0;
+    mutex_lock(&client->mutex);
+    int active = client->active_jobs;
+    mutex_unlock(&client->mutex);
+    return active;
+}
+
+#else /* !CYXMAKE_ENABLE_DISTRIBUTED */
+
+/* Stub implementations when distributed builds are disabled */
+
+WorkerClient* worker_client_create(const WorkerClientConfig* config) {
+    (void)config;
+    log_error("Distributed builds not enabled (rebuild with CYXMAKE_ENABLE_DISTRIBUTED)");
+    return NULL;
+}
+
+void worker_client_free(WorkerClient* client) {
+    (void)client;
+}
+
+void worker_client_set_callbacks(WorkerClient* client,
+                                  const WorkerClientCallbacks* callbacks) {
+    (void)client;
+    (void)callbacks;
+}
+
+bool worker_client_connect(WorkerClient* client) {
+    (void)client;
+    return false;
+}
+
+void worker_client_disconnect(WorkerClient* client) {
+    (void)client;
+}
+
+bool worker_client_is_connected(WorkerClient* client) {
+    (void)client;
+    return false;
+}
+
+void worker_client_run(WorkerClient* client) {
+    (void)client;
+}
+
+void worker_client_stop(WorkerClient* client) {
+    (void)client;
+}
+
+bool worker_client_report_result(WorkerClient* client,
+                                  const char* job_id,
+                                  DistributedJobResult* result) {
+    (void)client;
+    (void)job_id;
+    (void)result;
+    return false;
+}
+
+const char* worker_client_get_id(WorkerClient* client) {
+    (void)client;
+    return NULL;
+}
+
+int worker_client_get_active_jobs(WorkerClient* client) {
+    (void)client;
+    return 0;
+}
+
+#endif /* CYXMAKE_ENABLE_DISTRIBUTED */
@@ -4,6 +4,11 @@
  *
  * Manages remote worker lifecycle, capability tracking, health monitoring,
  * and intelligent worker selection for job distribution.
+ *
+ * Snapshots are reference counted. Each published snapshot pins the one
+ * that replaced it, so snapshots are released oldest first, and a worker
+ * retired onto the current snapshot is freed only once no reader can
+ * still reach it through any older one.
  */
 
 #include "cyxmake/distributed/worker_registry.h"
@@ -50,17 +55,51 @@ static inline int popcount32(uint32_t x) {
 #define HEALTH_WEIGHT_HEARTBEAT 0.2
 #define HEALTH_WEIGHT_UPTIME 0.1
 
+/* Observed job metrics */
+#define METRICS_EWMA_ALPHA 0.2    /* Weight of the newest sample */
+#define METRICS_MIN_SAMPLES 3     /* Before a worker's metrics count in selection */
+
+/* AIMD capacity control */
+#define AIMD_DECREASE_FACTOR 0.5
+#define AIMD_SLOWDOWN_RATIO 2.0   /* Slower than this x normal counts as overload */
+
+/* Hash index sizing */
+#define MIN_INDEX_BUCKETS 16
+
+/* One bitmap of online workers per capability bit */
+#define CAPABILITY_BITS 32
+
 /* ============================================================
  * Registry Structure
  * ============================================================ */
 
+/* Immutable view of the online workers used by selection */
+typedef struct WorkerSnapshot {
+    int refs;                     /* Guarded by snapshot_mutex */
+    int count;
+    RemoteWorker** workers;
+    int words;                    /* 64-bit words per capability bitmap */
+    uint64_t* cap_index;          /* CAPABILITY_BITS bitmaps over workers[] */
+    RemoteWorker* retired;        /* Unregistered workers, freed with this snapshot */
+    struct WorkerSnapshot* newer; /* Pinned until this snapshot is released */
+} WorkerSnapshot;
+
 struct WorkerRegistry {
     WorkerRegistryConfig config;
     RemoteWorker* workers;        /* Linked list head */
     int worker_count;
 
+    /* Hash indexes, chained through the workers (guarded by mutex) */
+    RemoteWorker** by_id;
+    RemoteWorker** by_connection;
+    uint32_t bucket_mask;
+
+    /* Current selection snapshot; the registry holds one reference */
+    WorkerSnapshot* snapshot;
+
 #ifdef CYXMAKE_ENABLE_DISTRIBUTED
     MutexHandle mutex;            /* Thread safety */
+    MutexHandle snapshot_mutex;   /* Snapshot pointer and reference counts only */
 #endif
 
     WorkerRegistryCallbacks callbacks;
@@ -102,6 +141,202 @@ static void registry_unlock(WorkerRegistry* registry) {
 #endif
 }
 
+static void snapshot_lock(WorkerRegistry* registry) {
+#ifdef CYXMAKE_ENABLE_DISTRIBUTED
+    mutex_lock(&registry->snapshot_mutex);
+#else
+    (void)registry;
+#endif
+}
+
+static void snapshot_unlock(WorkerRegistry* registry) {
+#ifdef CYXMAKE_ENABLE_DISTRIBUTED
+    mutex_unlock(&registry->snapshot_mutex);
+#else
+    (void)registry;
+#endif
+}
+
+static bool state_is_online(WorkerState state) {
+    return state == WORKER_STATE_ONLINE || state == WORKER_STATE_BUSY;
+}
+
+/* ============================================================
+ * Hash Indexes (caller holds the registry mutex)
+ * ============================================================ */
+
+static uint32_t id_bucket(const WorkerRegistry* registry, const char* id) {
+    uint32_t h = 2166136261u;     /* FNV-1a */
+    while (*id) {
+        h ^= (uint8_t)*id++;
+        h *= 16777619u;
+    }
+    return h & registry->bucket_mask;
+}
+
+static uint32_t connection_bucket(const WorkerRegistry* registry,
+                                  const NetworkConnection* connection) {
+    uint64_t h = (uint64_t)(uintptr_t)connection * 0x9E3779B97F4A7C15ull;
+    return (uint32_t)(h >> 32) & registry->bucket_mask;
+}
+
+static void index_insert(WorkerRegistry* registry, RemoteWorker* worker) {
+    uint32_t b = id_bucket(registry, worker->id);
+    worker->id_next = registry->by_id[b];
+    registry->by_id[b] = worker;
+
+    if (worker->connection) {
+        b = connection_bucket(registry, worker->connection);
+        worker->conn_next = registry->by_connection[b];
+        registry->by_connection[b] = worker;
+    }
+}
+
+static void index_remove(WorkerRegistry* registry, RemoteWorker* worker) {
+    for (RemoteWorker** pp = &registry->by_id[id_bucket(registry, worker->id)];
+         *pp; pp = &(*pp)->id_next) {
+        if (*pp == worker) {
+            *pp = worker->id_next;
+            break;
+        }
+    }
+
+    if (worker->connection) {
+        for (RemoteWorker** pp = &registry->by_connection[
+                 connection_bucket(registry, worker->connection)];
+             *pp; pp = &(*pp)->conn_next) {
+            if (*pp == worker) {
+                *pp = worker->conn_next;
+                break;
+            }
+        }
+    }
+}
+
+/* ============================================================
+ * Selection Snapshots
+ * ============================================================ */
+
+static void snapshot_destroy(WorkerSnapshot* snapshot) {
+    while (snapshot->retired) {
+        RemoteWorker* worker = snapshot->retired;
+        snapshot->retired = worker->next;
+        remote_worker_free(worker);
+    }
+    free(snapshot->workers);
+    free(snapshot->cap_index);
+    free(snapshot);
+}
+
+/* Readers hold the returned snapshot until snapshot_release */
+static WorkerSnapshot* snapshot_acquire(WorkerRegistry* registry) {
+    snapshot_lock(registry);
+    WorkerSnapshot* snapshot = registry->snapshot;
+    if (snapshot) snapshot->refs++;
+    snapshot_unlock(registry);
+    return snapshot;
+}
+
+static void snapshot_release(WorkerRegistry* registry, WorkerSnapshot* snapshot) {
+    while (snapshot) {
+        snapshot_lock(registry);
+        bool last = --snapshot->refs == 0;
+        snapshot_unlock(registry);
+        if (!last) return;
+
+        /* Dropping this snapshot unpins the one that replaced it */
+        WorkerSnapshot* newer = snapshot->newer;
+        snapshot_destroy(snapshot);
+        snapshot = newer;
+    }
+}
+
+static WorkerSnapshot* snapshot_build(WorkerRegistry* registry) {
+    WorkerSnapshot* snapshot = calloc(1, sizeof(WorkerSnapshot));
+    if (!snapshot) return NULL;
+
+    int capacity = registry->worker_count > 0 ? registry->worker_count : 1;
+    snapshot->words = (capacity + 63) / 64;
+    snapshot->workers = malloc(sizeof(RemoteWorker*) * (size_t)capacity);
+    snapshot->cap_index = calloc((size_t)CAPABILITY_BITS * (size_t)snapshot->words,
+                                 sizeof(uint64_t));
+    if (!snapshot->workers || !snapshot->cap_index) {
+        snapshot_destroy(snapshot);
+        return NULL;
+    }
+
+    for (RemoteWorker* worker = registry->workers; worker; worker = worker->next) {
+        if (!state_is_online(worker->state)) continue;
+
+        int i = snapshot->count++;
+        snapshot->workers[i] = worker;
+        for (int bit = 0; bit < CAPABILITY_BITS; bit++) {
+            if (worker->capabilities & (1u << bit)) {
+                snapshot->cap_index[bit * snapshot->words + i / 64] |= 1ull << (i % 64);
+            }
+        }
+    }
+
+    snapshot->refs = 1;           /* The registry's reference */
+    return snapshot;
+}
+
+/*
+ * Replace the snapshot after online membership or capabilities changed.
+ * Caller holds the registry mutex. On allocation failure the old snapshot
+ * stays current; selection re-checks live state, so it is merely stale.
+ */
+static void snapshot_publish(WorkerRegistry* registry) {
+    WorkerSnapshot* fresh = snapshot_build(registry);
+    if (!fresh) {
+        log_error("Failed to rebuild worker selection snapshot");
+        return;
+    }
+
+    snapshot_lock(registry);
+    WorkerSnapshot* old = registry->snapshot;
+    registry->snapshot = fresh;
+    if (old) {
+        old->newer = fresh;
+        fresh->refs++;
+    }
+    snapshot_unlock(registry);
+
+    snapshot_release(registry, old);
+}
+
+/* Free an unlinked worker once readers of older snapshots are done; caller holds the mutex */
+static void snapshot_retire(WorkerRegistry* registry, RemoteWorker* worker) {
+    if (!registry->snapshot) {
+        remote_worker_free(worker);
+        return;
+    }
+    worker->next = registry->snapshot->retired;
+    registry->snapshot->retired = worker;
+}
+
+/* Candidates having every required capability, as a bitmap over the snapshot */
+static void snapshot_candidates(const WorkerSnapshot* snapshot, uint32_t required,
+                                uint64_t* out) {
+    for (int w = 0; w < snapshot->words; w++) {
+        out[w] = ~0ull;
+    }
+    for (int bit = 0; bit < CAPABILITY_BITS; bit++) {
+        if (!(required & (1u << bit))) continue;
+        const uint64_t* index = &snapshot->cap_index[bit * snapshot->words];
+        for (int w = 0; w < snapshot->words; w++) {
+            out[w] &= index[w];
+        }
+    }
+}
+
+/* Live checks; the snapshot may be a moment behind */
+static bool worker_can_take_job(const RemoteWorker* worker) {
+    return state_is_online(worker->state) &&
+           worker->active_jobs < worker_slot_limit(worker) &&
+           !worker->congested;    /* Don't pile work onto a connection that can't drain */
+}
+
 /* ============================================================
  * Configuration
  * ============================================================ */
@@ -133,7 +368,9 @@ RemoteWorker* remote_worker_create(const char* id, const char* name) {
     worker->name = name ? strdup(name) : NULL;
     worker->state = WORKER_STATE_OFFLINE;
     worker->health_score = 1.0;  /* Start healthy */
+    worker->speed_factor = 1.0;  /* Nominal until jobs are measured */
     worker->max_jobs = 4;        /* Default concurrency */
+    worker->capacity = worker->max_jobs;
 
     if (!worker->id) {
         free(worker);
@@ -233,9 +470,38 @@ WorkerRegistry* worker_registry_create(const WorkerRegistryConfig* config) {
         registry->config = worker_registry_config_default();
     }
 
+    uint32_t buckets = MIN_INDEX_BUCKETS;
+    while (buckets < (uint32_t)registry->config.max_workers && buckets < (1u << 16)) {
+        buckets <<= 1;
+    }
+    registry->bucket_mask = buckets - 1;
+    registry->by_id = calloc(buckets, sizeof(RemoteWorker*));
+    registry->by_connection = calloc(buckets, sizeof(RemoteWorker*));
+    registry->snapshot = snapshot_build(registry);
+    if (!registry->by_id || !registry->by_connection || !registry->snapshot) {
+        log_error("Failed to allocate worker registry indexes");
+        free(registry->by_id);
+        free(registry->by_connection);
+        if (registry->snapshot) snapshot_destroy(registry->snapshot);
+        free(registry);
+        return NULL;
+    }
+
 #ifdef CYXMAKE_ENABLE_DISTRIBUTED
     if (!mutex_init(&registry->mutex)) {
         log_error("Failed to create registry mutex");
+        snapshot_destroy(registry->snapshot);
+        free(registry->by_id);
+        free(registry->by_connection);
+        free(registry);
+        return NULL;
+    }
+    if (!mutex_init(&registry->snapshot_mutex)) {
+        log_error("Failed to create registry snapshot mutex");
+        mutex_destroy(&registry->mutex);
+        snapshot_destroy(registry->snapshot);
+        free(registry->by_id);
+        free(registry->by_connection);
         free(registry);
         return NULL;
     }
@@ -250,6 +516,10 @@ WorkerRegistry* worker_registry_create(const WorkerRegistryConfig* config) {
 void worker_registry_free(WorkerRegistry* registry) {
     if (!registry) return;
 
+    /* Frees retired workers; no reader may hold a snapshot past this point */
+    snapshot_release(registry, registry->snapshot);
+    registry->snapshot = NULL;
+
     /* Free all workers */
     RemoteWorker* worker = registry->workers;
     while (worker) {
@@ -260,8 +530,11 @@ void worker_registry_free(WorkerRegistry* registry) {
 
 #ifdef CYXMAKE_ENABLE_DISTRIBUTED
     mutex_destroy(&registry->mutex);
+    mutex_destroy(&registry->snapshot_mutex);
 #endif
 
+    free(registry->by_id);
+    free(registry->by_connection);
     free(registry);
     log_debug("Worker registry freed");
 }
@@ -325,6 +598,7 @@ RemoteWorker* worker_registry_register(WorkerRegistry* registry,
         /* Set max jobs based on CPU cores */
         if (worker_info->cpu_cores > 0) {
             worker->max_jobs = worker_info->cpu_cores;
+            worker->capacity = worker->max_jobs;
         }
     }
 
@@ -332,6 +606,8 @@ RemoteWorker* worker_registry_register(WorkerRegistry* registry,
     worker->next = registry->workers;
     registry->workers = worker;
     registry->worker_count++;
+    index_insert(registry, worker);
+    snapshot_publish(registry);
 
     log_info("Worker registered: %s (%s)", worker->id,
              worker->hostname ? worker->hostname : "unknown");
@@ -354,39 +630,45 @@ void worker_registry_unregister(WorkerRegistry* registry,
 
     registry_lock(registry);
 
-    RemoteWorker* prev = NULL;
-    RemoteWorker* worker = registry->workers;
-
-    while (worker) {
-        if (strcmp(worker->id, worker_id) == 0) {
-            /* Remove from list */
-            if (prev) {
-                prev->next = worker->next;
-            } else {
-                registry->workers = worker->next;
-            }
-            registry->worker_count--;
+    RemoteWorker* worker = NULL;
+    for (RemoteWorker* w = registry->by_id[id_bucket(registry, worker_id)]; w; w = w->id_next) {
+        if (strcmp(w->id, worker_id) == 0) {
+            worker = w;
+            break;
+        }
+    }
+    if (!worker) {
+        registry_unlock(registry);
+        log_warning("Worker not found for unregistration: %s", worker_id);
+        return;
+    }
 
-            log_info("Worker unregistered: %s (%s)",
-                     worker_id, reason ? reason : "no reason");
+    /* Remove from list and indexes; selection stops seeing it */
+    for (RemoteWorker** pp = &registry->workers; *pp; pp = &(*pp)->next) {
+        if (*pp == worker) {
+            *pp = worker->next;
+            break;
+        }
+    }
+    registry->worker_count--;
+    index_remove(registry, worker);
+    snapshot_publish(registry);
 
-            registry_unlock(registry);
+    log_info("Worker unregistered: %s (%s)",
+             worker_id, reason ? reason : "no reason");
 
-            /* Callback before freeing */
-            if (registry->callbacks.on_unregistered) {
-                registry->callbacks.on_unregistered(registry, worker_id, reason,
-                                                     registry->callbacks.user_data);
-            }
+    registry_unlock(registry);
 
-            remote_worker_free(worker);
-            return;
-        }
-        prev = worker;
-        worker = worker->next;
+    /* Callback before freeing */
+    if (registry->callbacks.on_unregistered) {
+        registry->callbacks.on_unregistered(registry, worker_id, reason,
+                                             registry->callbacks.user_data);
     }
 
+    /* Readers of older snapshots may still hold it */
+    registry_lock(registry);
+    snapshot_retire(registry, worker);
     registry_unlock(registry);
-    log_warning("Worker not found for unregistration: %s", worker_id);
 }
 
 RemoteWorker* worker_registry_find_by_id(WorkerRegistry* registry,
@@ -395,15 +677,17 @@ RemoteWorker* worker_registry_find_by_id(WorkerRegistry* registry,
 
     registry_lock(registry);
 
-    for (RemoteWorker* worker = registry->workers; worker; worker = worker->next) {
+    RemoteWorker* found = NULL;
+    for (RemoteWorker* worker = registry->by_id[id_bucket(registry, worker_id)];
+         worker; worker = worker->id_next) {
         if (strcmp(worker->id, worker_id) == 0) {
-            registry_unlock(registry);
-            return worker;
+            found = worker;
+            break;
         }
     }
 
     registry_unlock(registry);
-    return NULL;
+    return found;
 }
 
 RemoteWorker* worker_registry_find_by_connection(WorkerRegistry* registry,
@@ -412,15 +696,17 @@ RemoteWorker* worker_registry_find_by_connection(WorkerRegistry* registry,
 
     registry_lock(registry);
 
-    for (RemoteWorker* worker = registry->workers; worker; worker = worker->next) {
+    RemoteWorker* found = NULL;
+    for (RemoteWorker* worker = registry->by_connection[connection_bucket(registry, connection)];
+         worker; worker = worker->conn_next) {
         if (worker->connection == connection) {
-            registry_unlock(registry);
-            return worker;
+            found = worker;
+            break;
         }
     }
 
     registry_unlock(registry);
-    return NULL;
+    return found;
 }
 
 RemoteWorker* worker_registry_find_by_name(WorkerRegistry* registry,
@@ -447,37 +733,32 @@ int worker_registry_get_count(WorkerRegistry* registry) {
 int worker_registry_get_online_count(WorkerRegistry* registry) {
     if (!registry) return 0;
 
-    registry_lock(registry);
-
+    WorkerSnapshot* snapshot = snapshot_acquire(registry);
     int count = 0;
-    for (RemoteWorker* worker = registry->workers; worker; worker = worker->next) {
-        if (worker->state == WORKER_STATE_ONLINE ||
-            worker->state == WORKER_STATE_BUSY) {
+    for (int i = 0; snapshot && i < snapshot->count; i++) {
+        if (state_is_online(snapshot->workers[i]->state)) {
             count++;
         }
     }
-
-    registry_unlock(registry);
+    snapshot_release(registry, snapshot);
     return count;
 }
 
 int worker_registry_get_available_slots(WorkerRegistry* registry) {
     if (!registry) return 0;
 
-    registry_lock(registry);
-
+    WorkerSnapshot* snapshot = snapshot_acquire(registry);
     int slots = 0;
-    for (RemoteWorker* worker = registry->workers; worker; worker = worker->next) {
-        if (worker->state == WORKER_STATE_ONLINE ||
-            worker->state == WORKER_STATE_BUSY) {
-            int available = worker->max_jobs - worker->active_jobs;
+    for (int i = 0; snapshot && i < snapshot->count; i++) {
+        RemoteWorker* worker = snapshot->workers[i];
+        if (state_is_online(worker->state)) {
+            int available = worker_slot_limit(worker) - worker->active_jobs;
             if (available > 0) {
                 slots += available;
             }
         }
     }
-
-    registry_unlock(registry);
+    snapshot_release(registry, snapshot);
     return slots;
 }
 
@@ -499,10 +780,56 @@ void worker_registry_foreach(WorkerRegistry* registry,
  * Worker Selection
  * ============================================================ */
 
+/* Farm-wide means of the metrics a selection compares workers against */
+typedef struct {
+    double latency_sec;
+    double throughput;
+} MetricsBaseline;
+
+/* Metrics for a job type once enough samples make them meaningful */
+static const WorkerJobMetrics* observed_metrics(const RemoteWorker* worker,
+                                                DistributedJobType type) {
+    if ((int)type < 0 || (int)type >= WORKER_JOB_TYPE_COUNT) return NULL;
+    const WorkerJobMetrics* m = &worker->metrics[type];
+    return m->samples >= METRICS_MIN_SAMPLES && m->latency_sec > 0 ? m : NULL;
+}
+
+static MetricsBaseline metrics_baseline(const WorkerSnapshot* snapshot,
+                                        const WorkerSelectionCriteria* criteria) {
+    MetricsBaseline baseline = {0};
+    if (!criteria->prefer_throughput && !criteria->prefer_low_latency) return baseline;
+
+    int count = 0;
+    for (int i = 0; i < snapshot->count; i++) {
+        const WorkerJobMetrics* m = observed_metrics(snapshot->workers[i], criteria->job_type);
+        if (m) {
+            baseline.latency_sec += m->latency_sec;
+            baseline.throughput += m->throughput;
+            count++;
+        }
+    }
+    if (count > 0) {
+        baseline.latency_sec /= count;
+        baseline.throughput /= count;
+    }
+    return baseline;
+}
+
+/* Ratio to the farm mean, clamped; workers without data score as average */
+static double relative_to(double value, double mean) {
+    if (value <= 0 || mean <= 0) return 1.0;
+    return fmin(fmax(value / mean, 0.1), 10.0);
+}
+
 static double score_worker(RemoteWorker* worker,
-                           const WorkerSelectionCriteria* criteria) {
+                           const WorkerSelectionCriteria* criteria,
+                           const MetricsBaseline* baseline) {
     double score = worker->health_score;
 
+    if (criteria->exclude_worker_id && strcmp(worker->id, criteria->exclude_worker_id) == 0) {
+        return -1.0;
+    }
+
     /* Check required capabilities */
     if (criteria->required_capabilities) {
         if ((worker->capabilities & criteria->required_capabilities) !=
@@ -512,7 +839,8 @@ static double score_worker(RemoteWorker* worker,
     }
 
     /* Check available slots */
-    int available = worker->max_jobs - worker->active_jobs;
+    int slots = worker_slot_limit(worker);
+    int available = slots - worker->active_jobs;
     if (criteria->min_available_slots > 0 &&
         available < criteria->min_available_slots) {
         return -1.0;  /* Not enough slots */
@@ -530,10 +858,27 @@ static double score_worker(RemoteWorker* worker,
 
     /* Bonus for low load */
     if (criteria->prefer_idle) {
-        double load = (double)worker->active_jobs / worker->max_jobs;
+        double load = (double)worker->active_jobs / slots;
         score += 0.3 * (1.0 - load);
     }
 
+    /* Bonus for fast workers, large enough to outweigh load and health */
+    if (criteria->prefer_fast) {
+        double speed = worker->speed_factor > 0.1 ? worker->speed_factor : 0.1;
+        score += 1.0 / speed;
+    }
+
+    /* Bonuses from observed metrics, relative to the farm mean */
+    if (criteria->prefer_throughput || criteria->prefer_low_latency) {
+        const WorkerJobMetrics* m = observed_metrics(worker, criteria->job_type);
+        if (criteria->prefer_throughput) {
+            score += relative_to(m ? m->throughput : 0, baseline->throughput);
+        }
+        if (criteria->prefer_low_latency) {
+            score += 1.0 / relative_to(m ? m->latency_sec : 0, baseline->latency_sec);
+        }
+    }
+
     /* Check target architecture */
     if (criteria->target_arch && worker->system_info.arch) {
         if (strcmp(criteria->target_arch, worker->system_info.arch) == 0) {
@@ -551,35 +896,59 @@ static double score_worker(RemoteWorker* worker,
     return score;
 }
 
+/*
+ * Score every candidate in the snapshot that can take a job now.
+ * Returns the number scored; scores[i] < 0 marks workers left out.
+ */
+static int score_candidates(const WorkerSnapshot* snapshot,
+                            const WorkerSelectionCriteria* criteria,
+                            uint64_t* candidates,
+                            double* scores) {
+    snapshot_candidates(snapshot, criteria->required_capabilities, candidates);
+    MetricsBaseline baseline = metrics_baseline(snapshot, criteria);
+
+    int scored = 0;
+    for (int i = 0; i < snapshot->count; i++) {
+        scores[i] = -1.0;
+        if (!(candidates[i / 64] & (1ull << (i % 64)))) continue;
+
+        RemoteWorker* worker = snapshot->workers[i];
+        if (!worker_can_take_job(worker)) continue;
+
+        scores[i] = score_worker(worker, criteria, &baseline);
+        if (scores[i] >= 0) scored++;
+    }
+    return scored;
+}
+
 RemoteWorker* worker_registry_select_worker(WorkerRegistry* registry,
                                               const WorkerSelectionCriteria* criteria) {
-    if (!registry) return NULL;
+    if (!registry || !criteria) return NULL;
 
-    registry_lock(registry);
+    WorkerSnapshot* snapshot = snapshot_acquire(registry);
+    if (!snapshot || snapshot->count == 0) {
+        snapshot_release(registry, snapshot);
+        return NULL;
+    }
 
+    uint64_t* candidates = malloc(sizeof(uint64_t) * (size_t)snapshot->words);
+    double* scores = malloc(sizeof(double) * (size_t)snapshot->count);
     RemoteWorker* best = NULL;
     double best_score = -1.0;
 
-    for (RemoteWorker* worker = registry->workers; worker; worker = worker->next) {
-        /* Only consider online or busy workers */
-        if (worker->state != WORKER_STATE_ONLINE &&
-            worker->state != WORKER_STATE_BUSY) {
-            continue;
-        }
-
-        /* Check if worker has available slots */
-        if (worker->active_jobs >= worker->max_jobs) {
-            continue;
-        }
-
-        double score = score_worker(worker, criteria);
-        if (score > best_score) {
-            best_score = score;
-            best = worker;
+    if (candidates && scores) {
+        score_candidates(snapshot, criteria, candidates, scores);
+        for (int i = 0; i < snapshot->count; i++) {
+            if (scores[i] > best_score) {
+                best_score = scores[i];
+                best = snapshot->workers[i];
+            }
         }
     }
 
-    registry_unlock(registry);
+    free(candidates);
+    free(scores);
+    snapshot_release(registry, snapshot);
 
     if (best) {
         log_debug("Selected worker %s (score: %.2f)", best->id, best_score);
@@ -588,64 +957,76 @@ RemoteWorker* worker_registry_select_worker(WorkerRegistry* registry,
     return best;
 }
 
+RemoteWorker* worker_registry_select_round_robin(WorkerRegistry* registry,
+                                                   unsigned int turn) {
+    if (!registry) return NULL;
+
+    WorkerSnapshot* snapshot = snapshot_acquire(registry);
+    RemoteWorker* selected = NULL;
+
+    /* Start at this turn's worker; skip ahead past full or congested ones */
+    int count = snapshot ? snapshot->count : 0;
+    for (int n = 0; n < count && !selected; n++) {
+        RemoteWorker* worker = snapshot->workers[(turn + (unsigned int)n) % (unsigned int)count];
+        if (worker_can_take_job(worker)) {
+            selected = worker;
+        }
+    }
+
+    snapshot_release(registry, snapshot);
+    return selected;
+}
+
+typedef struct {
+    RemoteWorker* worker;
+    double score;
+} ScoredWorker;
+
+static int compare_scored(const void* a, const void* b) {
+    double x = ((const ScoredWorker*)a)->score;
+    double y = ((const ScoredWorker*)b)->score;
+    return x < y ? 1 : (x > y ? -1 : 0);      /* Highest first */
+}
+
 int worker_registry_select_workers(WorkerRegistry* registry,
                                     const WorkerSelectionCriteria* criteria,
                                     int max_workers,
                                     RemoteWorker** out_workers) {
-    if (!registry || !out_workers || max_workers <= 0) return 0;
-
-    registry_lock(registry);
-
-    /* Score all workers */
-    typedef struct {
-        RemoteWorker* worker;
-        double score;
-    } ScoredWorker;
+    if (!registry || !criteria || !out_workers || max_workers <= 0) return 0;
 
-    ScoredWorker* scored = malloc(sizeof(ScoredWorker) * registry->worker_count);
-    if (!scored) {
-        registry_unlock(registry);
+    WorkerSnapshot* snapshot = snapshot_acquire(registry);
+    if (!snapshot || snapshot->count == 0) {
+        snapshot_release(registry, snapshot);
         return 0;
     }
 
-    int scored_count = 0;
-    for (RemoteWorker* worker = registry->workers; worker; worker = worker->next) {
-        if (worker->state != WORKER_STATE_ONLINE &&
-            worker->state != WORKER_STATE_BUSY) {
-            continue;
-        }
-
-        if (worker->active_jobs >= worker->max_jobs) {
-            continue;
-        }
+    uint64_t* candidates = malloc(sizeof(uint64_t) * (size_t)snapshot->words);
+    double* scores = malloc(sizeof(double) * (size_t)snapshot->count);
+    ScoredWorker* scored = malloc(sizeof(ScoredWorker) * (size_t)snapshot->count);
+    int selected = 0;
 
-        double score = score_worker(worker, criteria);
-        if (score >= 0) {
-            scored[scored_count].worker = worker;
-            scored[scored_count].score = score;
-            scored_count++;
-        }
-    }
+    if (candidates && scores && scored) {
+        score_candidates(snapshot, criteria, candidates, scores);
 
-    /* Sort by score (simple bubble sort for small lists) */
-    for (int i = 0; i < scored_count - 1; i++) {
-        for (int j = 0; j < scored_count - i - 1; j++) {
-            if (scored[j].score < scored[j + 1].score) {
-                ScoredWorker tmp = scored[j];
-                scored[j] = scored[j + 1];
-                scored[j + 1] = tmp;
+        int scored_count = 0;
+        for (int i = 0; i < snapshot->count; i++) {
+            if (scores[i] >= 0) {
+                scored[scored_count].worker = snapshot->workers[i];
+                scored[scored_count].score = scores[i];
+                scored_count++;
             }
         }
-    }
+        qsort(scored, (size_t)scored_count, sizeof(ScoredWorker), compare_scored);
 
-    /* Select top workers */
-    int selected = 0;
-    for (int i = 0; i < scored_count && selected < max_workers; i++) {
-        out_workers[selected++] = scored[i].worker;
+        for (int i = 0; i < scored_count && selected < max_workers; i++) {
+            out_workers[selected++] = scored[i].worker;
+        }
     }
 
+    free(candidates);
+    free(scores);
     free(scored);
-    registry_unlock(registry);
+    snapshot_release(registry, snapshot);
 
     return selected;
 }
@@ -654,13 +1035,12 @@ int worker_registry_select_workers(WorkerRegistry* registry,
  * Worker State Management
  * ============================================================ */
 
-void worker_registry_set_state(WorkerRegistry* registry,
-                                RemoteWorker* worker,
-                                WorkerState new_state) {
-    if (!registry || !worker) return;
-
+/* Caller holds the lock; returns the previous state */
+static WorkerState set_state_locked(WorkerRegistry* registry,
+                                    RemoteWorker* worker,
+                                    WorkerState new_state) {
     WorkerState old_state = worker->state;
-    if (old_state == new_state) return;
+    if (old_state == new_state) return old_state;
 
     worker->state = new_state;
 
@@ -669,13 +1049,35 @@ void worker_registry_set_state(WorkerRegistry* registry,
               worker_state_name(old_state),
               worker_state_name(new_state));
 
-    if (registry->callbacks.on_state_changed) {
+    /* ONLINE <-> BUSY keeps membership; selection checks slots live */
+    if (state_is_online(old_state) != state_is_online(new_state)) {
+        snapshot_publish(registry);
+    }
+    return old_state;
+}
+
+static void notify_state_changed(WorkerRegistry* registry,
+                                 RemoteWorker* worker,
+                                 WorkerState old_state) {
+    if (old_state != worker->state && registry->callbacks.on_state_changed) {
         registry->callbacks.on_state_changed(registry, worker,
-                                              old_state, new_state,
+                                              old_state, worker->state,
                                               registry->callbacks.user_data);
     }
 }
 
+void worker_registry_set_state(WorkerRegistry* registry,
+                                RemoteWorker* worker,
+                                WorkerState new_state) {
+    if (!registry || !worker) return;
+
+    registry_lock(registry);
+    WorkerState old_state = set_state_locked(registry, worker, new_state);
+    registry_unlock(registry);
+
+    notify_state_changed(registry, worker, old_state);
+}
+
 void worker_registry_heartbeat(WorkerRegistry* registry,
                                 RemoteWorker* worker,
                                 const WorkerSystemInfo* updated_info) {
@@ -705,7 +1107,7 @@ void worker_registry_update_job_count(WorkerRegistry* registry,
     if (worker->active_jobs < 0) worker->active_jobs = 0;
 
     /* Update state based on load */
-    if (worker->active_jobs >= worker->max_jobs) {
+    if (worker->active_jobs >= worker_slot_limit(worker)) {
         if (worker->state == WORKER_STATE_ONLINE) {
             worker_registry_set_state(registry, worker, WORKER_STATE_BUSY);
         }
@@ -716,12 +1118,71 @@ void worker_registry_update_job_count(WorkerRegistry* registry,
     }
 }
 
+void worker_registry_set_congested(WorkerRegistry* registry,
+                                    RemoteWorker* worker,
+                                    bool congested) {
+    if (!registry || !worker) return;
+
+    registry_lock(registry);
+    worker->congested = congested;
+    registry_unlock(registry);
+}
+
+void worker_registry_set_profile(WorkerRegistry* registry,
+                                  RemoteWorker* worker,
+                                  const char* name,
+                                  uint32_t capabilities,
+                                  int max_jobs) {
+    if (!registry || !worker) return;
+
+    registry_lock(registry);
+    if (name) {
+        free(worker->name);
+        worker->name = strdup(name);
+    }
+    bool reindex = worker->capabilities != capabilities;
+    worker->capabilities = capabilities;
+    if (max_jobs > 0) {
+        worker->max_jobs = max_jobs;
+        worker->capacity = max_jobs;
+    }
+    if (reindex && state_is_online(worker->state)) {
+        snapshot_publish(registry);
+    }
+    registry_unlock(registry);
+}
+
+static double ewma(double current, double sample, bool first) {
+    return first ? sample : (1.0 - METRICS_EWMA_ALPHA) * current + METRICS_EWMA_ALPHA * sample;
+}
+
+/* Additive increase on healthy completions, multiplicative decrease on overload */
+static void adjust_capacity(RemoteWorker* worker, bool overloaded) {
+    double old_capacity = worker->capacity;
+
+    if (overloaded) {
+        worker->capacity = fmax(worker->capacity * AIMD_DECREASE_FACTOR, 1.0);
+    } else {
+        worker->capacity = fmin(worker->capacity + 1.0 / fmax(worker->capacity, 1.0),
+                                (double)worker->max_jobs);
+    }
+
+    if ((int)worker->capacity != (int)old_capacity) {
+        log_debug("Worker %s capacity %d -> %d of %d slots", worker->id,
+                  (int)old_capacity, (int)worker->capacity, worker->max_jobs);
+    }
+}
+
 void worker_registry_record_job_complete(WorkerRegistry* registry,
                                           RemoteWorker* worker,
+                                          DistributedJobType type,
                                           bool success,
-                                          double duration_sec) {
+                                          double duration_sec,
+                                          double estimated_sec) {
     if (!registry || !worker) return;
 
+    registry_lock(registry);
+
     if (success) {
         worker->total_jobs_completed++;
     } else {
@@ -736,10 +1197,57 @@ void worker_registry_record_job_complete(WorkerRegistry* registry,
             0.9 * worker->avg_job_duration_sec + 0.1 * duration_sec;
     }
 
+    if ((int)type >= 0 && (int)type < WORKER_JOB_TYPE_COUNT) {
+        WorkerJobMetrics* m = &worker->metrics[type];
+        bool first = m->samples == 0;
+        m->failure_rate = ewma(m->failure_rate, success ? 0.0 : 1.0, first);
+        if (duration_sec > 0) {
+            /* Little's law: the jobs in flight finish at concurrency / latency */
+            int concurrency = worker->active_jobs > 0 ? worker->active_jobs : 1;
+            m->latency_sec = ewma(m->latency_sec, duration_sec, m->latency_sec == 0);
+            m->throughput = ewma(m->throughput, concurrency / duration_sec, m->throughput == 0);
+        }
+        m->samples++;
+    }
+
+    /*
+     * A job far slower than this worker's norm, timeouts included, means its
+     * slots are oversubscribed. Quick failures are usually the job's own
+     * fault (a compile error) and only count against health.
+     */
+    bool slow = estimated_sec > 0 && duration_sec >
+                AIMD_SLOWDOWN_RATIO * estimated_sec * worker->speed_factor;
+    if (slow || success) {
+        adjust_capacity(worker, slow);
+    }
+
+    registry_unlock(registry);
+
     /* Recalculate health */
     worker_registry_update_health(registry, worker);
 }
 
+int worker_slot_limit(const RemoteWorker* worker) {
+    if (!worker) return 0;
+    int limit = (int)worker->capacity;
+    if (limit < 1) limit = 1;
+    return limit < worker->max_jobs ? limit : worker->max_jobs;
+}
+
+void worker_registry_record_job_speed(WorkerRegistry* registry,
+                                       RemoteWorker* worker,
+                                       double ratio) {
+    if (!registry || !worker || ratio <= 0) return;
+
+    /* Clamp outliers (cold caches, stalls) before averaging */
+    if (ratio < 0.1) ratio = 0.1;
+    if (ratio > 10.0) ratio = 10.0;
+
+    registry_lock(registry);
+    worker->speed_factor = 0.8 * worker->speed_factor + 0.2 * ratio;
+    registry_unlock(registry);
+}
+
 void worker_registry_check_heartbeats(WorkerRegistry* registry) {
     if (!registry) return;
 
@@ -766,7 +1274,9 @@ void worker_registry_check_heartbeats(WorkerRegistry* registry) {
                 if (worker->missed_heartbeats >= registry->config.max_missed_heartbeats) {
                     log_warning("Worker %s marked offline (missed %d heartbeats)",
                                 worker->id, worker->missed_heartbeats);
-                    worker_registry_set_state(registry, worker, WORKER_STATE_OFFLINE);
+                    WorkerState old_state = set_state_locked(registry, worker,
+                                                             WORKER_STATE_OFFLINE);
+                    notify_state_changed(registry, worker, old_state);
                 }
             }
         }
@@ -786,9 +1296,17 @@ double worker_registry_calculate_health(RemoteWorker* worker) {
 
     double health = 0.0;
 
-    /* Success rate */
+    /* Success rate, recent failures weighing most */
+    double failures = 0.0;
+    int samples = 0;
+    for (int t = 0; t < WORKER_JOB_TYPE_COUNT; t++) {
+        failures += worker->metrics[t].failure_rate * worker->metrics[t].samples;
+        samples += worker->metrics[t].samples;
+    }
     int total = worker->total_jobs_completed + worker->total_jobs_failed;
-    if (total > 0) {
+    if (samples > 0) {
+        health += HEALTH_WEIGHT_SUCCESS_RATE * (1.0 - failures / samples);
+    } else if (total > 0) {
         health += HEALTH_WEIGHT_SUCCESS_RATE *
                   ((double)worker->total_jobs_completed / total);
     } else {
@@ -882,6 +1400,7 @@ const char* worker_capability_name(WorkerCapability cap) {
         case WORKER_CAP_DOCKER: return "DOCKER";
         case WORKER_CAP_HIGH_MEMORY: return "HIGH_MEMORY";
         case WORKER_CAP_SSD_STORAGE: return "SSD_STORAGE";
+        case WORKER_CAP_JOB_BATCH: return "JOB_BATCH";
         default: return "UNKNOWN";
     }
 }
@@ -914,6 +1433,7 @@ uint32_t worker_capabilities_parse(const char** capability_names, int count) {
         else if (strcmp(name, "DOCKER") == 0) caps |= WORKER_CAP_DOCKER;
         else if (strcmp(name, "HIGH_MEMORY") == 0) caps |= WORKER_CAP_HIGH_MEMORY;
         else if (strcmp(name, "SSD_STORAGE") == 0) caps |= WORKER_CAP_SSD_STORAGE;
+        else if (strcmp(name, "JOB_BATCH") == 0) caps |= WORKER_CAP_JOB_BATCH;
     }
 
     return caps;
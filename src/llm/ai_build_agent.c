@@ -5,8 +5,10 @@
 
 #include "cyxmake/ai_build_agent.h"
 #include "cyxmake/build_intelligence.h"
+#include "cyxmake/ai_schema.h"
 #include "cyxmake/logger.h"
 #include "cyxmake/compat.h"
+#include "cJSON.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -386,64 +388,51 @@ char* prompt_ai_error_fix(const char* error_output,
 }
 
 /* ========================================================================
- * JSON Parsing Helpers
+ * Response Parsing
  * ======================================================================== */
 
-/* Extract string value from JSON */
-static char* json_get_string(const char* json, const char* key) {
-    if (!json || !key) return NULL;
-
-    char pattern[128];
-    snprintf(pattern, sizeof(pattern), "\"%s\"", key);
-
-    const char* key_pos = strstr(json, pattern);
-    if (!key_pos) return NULL;
-
-    /* Find the colon */
-    const char* colon = strchr(key_pos + strlen(pattern), ':');
-    if (!colon) return NULL;
-
-    /* Skip whitespace */
-    const char* start = colon + 1;
-    while (*start == ' ' || *start == '\t' || *start == '\n' || *start == '\r') start++;
-
-    /* Check for null */
-    if (strncmp(start, "null", 4) == 0) return NULL;
+/* Reply shapes requested by the plan and error analysis prompts */
+static const char* const BUILD_STEP_TYPES[] = {
+    "configure", "build", "install_dep", "create_dir", "run_command", "clean", NULL
+};
 
-    /* Must be a string */
-    if (*start != '"') return NULL;
-    start++;
+static const AISchema BUILD_STEP_FIELDS[] = {
+    { .type = AI_SCHEMA_STRING, .name = "type", .enum_values = BUILD_STEP_TYPES },
+    { .type = AI_SCHEMA_STRING, .name = "description" },
+    { .type = AI_SCHEMA_STRING, .name = "command", .nullable = true },
+    { .type = AI_SCHEMA_STRING, .name = "target", .nullable = true },
+    { .type = AI_SCHEMA_STRING, .name = "reason", .nullable = true },
+};
 
-    /* Find end quote (handle escapes) */
-    const char* end = start;
-    while (*end && !(*end == '"' && *(end-1) != '\\')) end++;
+static const AISchema BUILD_STEP = {
+    .type = AI_SCHEMA_OBJECT,
+    .properties = BUILD_STEP_FIELDS,
+    .property_count = 5
+};
 
-    if (!*end) return NULL;
+static const AISchema BUILD_PLAN_FIELDS[] = {
+    { .type = AI_SCHEMA_STRING, .name = "summary" },
+    { .type = AI_SCHEMA_ARRAY, .name = "steps", .required = true, .items = &BUILD_STEP },
+};
 
-    size_t len = end - start;
-    char* result = malloc(len + 1);
-    if (!result) return NULL;
+/* Also accepts fix replies, whose extra members are read separately */
+static const AISchema BUILD_PLAN_SCHEMA = {
+    .type = AI_SCHEMA_OBJECT,
+    .properties = BUILD_PLAN_FIELDS,
+    .property_count = 2
+};
 
-    /* Copy and unescape */
-    size_t j = 0;
-    for (size_t i = 0; i < len; i++) {
-        if (start[i] == '\\' && i + 1 < len) {
-            i++;
-            switch (start[i]) {
-                case 'n': result[j++] = '\n'; break;
-                case 't': result[j++] = '\t'; break;
-                case '"': result[j++] = '"'; break;
-                case '\\': result[j++] = '\\'; break;
-                default: result[j++] = start[i]; break;
-            }
-        } else {
-            result[j++] = start[i];
-        }
-    }
-    result[j] = '\0';
+static const AISchema BUILD_FIX_FIELDS[] = {
+    { .type = AI_SCHEMA_STRING, .name = "analysis" },
+    { .type = AI_SCHEMA_STRING, .name = "root_cause" },
+    { .type = AI_SCHEMA_ARRAY, .name = "steps", .required = true, .items = &BUILD_STEP },
+};
 
-    return result;
-}
+static const AISchema BUILD_FIX_SCHEMA = {
+    .type = AI_SCHEMA_OBJECT,
+    .properties = BUILD_FIX_FIELDS,
+    .property_count = 3
+};
 
 /* Parse step type from string */
 static BuildStepType parse_step_type(const char* type_str) {
@@ -464,90 +453,43 @@ AIBuildPlan* parse_ai_build_plan_response(const char* response,
                                            const char* project_path) {
     if (!response) return NULL;
 
-    AIBuildPlan* plan = ai_build_plan_create(project_path);
-    if (!plan) return NULL;
-
-    /* Find JSON block */
-    const char* json_start = strstr(response, "```json");
-    if (json_start) {
-        json_start += 7;
-        while (*json_start == '\n' || *json_start == '\r') json_start++;
-    } else {
-        json_start = strchr(response, '{');
+    char error[256];
+    cJSON* json = ai_schema_parse(&BUILD_PLAN_SCHEMA, response, error, sizeof(error));
+    if (!json) {
+        log_warning("No build plan in AI response: %s", error);
+        return NULL;
     }
 
-    if (!json_start) {
-        log_warning("No JSON found in AI response");
-        ai_build_plan_free(plan);
+    AIBuildPlan* plan = ai_build_plan_create(project_path);
+    if (!plan) {
+        cJSON_Delete(json);
         return NULL;
     }
 
-    /* Extract summary */
-    plan->summary = json_get_string(json_start, "summary");
+    plan->summary = ai_json_strdup(json, "summary");
     if (!plan->summary) {
-        plan->summary = json_get_string(json_start, "analysis");
+        plan->summary = ai_json_strdup(json, "analysis");
     }
 
-    /* Find steps array */
-    const char* steps_start = strstr(json_start, "\"steps\"");
-    if (!steps_start) {
-        log_warning("No steps array in AI response");
-        ai_build_plan_free(plan);
-        return NULL;
-    }
-
-    steps_start = strchr(steps_start, '[');
-    if (!steps_start) {
-        ai_build_plan_free(plan);
-        return NULL;
-    }
+    const cJSON* item = NULL;
+    cJSON_ArrayForEach(item, cJSON_GetObjectItemCaseSensitive(json, "steps")) {
+        BuildStepType type =
+            parse_step_type(cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(item, "type")));
+        char* description = ai_json_strdup(item, "description");
+        char* command = ai_json_strdup(item, "command");
+        char* target = ai_json_strdup(item, "target");
 
-    /* Parse each step object */
-    const char* step_obj = strchr(steps_start, '{');
-    while (step_obj) {
-        /* Find end of this step object */
-        const char* step_end = strchr(step_obj, '}');
-        if (!step_end) break;
-
-        /* Check if we've left the steps array */
-        const char* array_end = strchr(steps_start, ']');
-        if (array_end && step_obj > array_end) break;
-
-        /* Extract step fields from this object */
-        size_t step_len = step_end - step_obj + 1;
-        char* step_json = malloc(step_len + 1);
-        if (!step_json) break;
-        strncpy(step_json, step_obj, step_len);
-        step_json[step_len] = '\0';
-
-        /* Parse step fields */
-        char* type_str = json_get_string(step_json, "type");
-        char* description = json_get_string(step_json, "description");
-        char* command = json_get_string(step_json, "command");
-        char* target = json_get_string(step_json, "target");
-        char* reason = json_get_string(step_json, "reason");
-
-        BuildStepType type = parse_step_type(type_str);
-
-        /* Create and add step */
         AIBuildStep* step = ai_build_step_create(type, description, command, target);
         if (step) {
-            step->reason = reason;
-            reason = NULL;  /* Ownership transferred */
+            step->reason = ai_json_strdup(item, "reason");
             ai_build_plan_add_step(plan, step);
         }
 
-        /* Cleanup */
-        free(type_str);
         free(description);
         free(command);
         free(target);
-        free(reason);
-        free(step_json);
-
-        /* Find next step object */
-        step_obj = strchr(step_end + 1, '{');
     }
+    cJSON_Delete(json);
 
     if (plan->step_count == 0) {
         log_warning("No steps parsed from AI response");
@@ -796,7 +738,8 @@ AIBuildPlan* ai_build_agent_plan(AIBuildAgent* agent,
     if (!prompt) return NULL;
 
     /* Query AI provider */
-    char* response_text = ai_provider_query(agent->ai, prompt, 2048);
+    char* response_text = ai_provider_query_structured(agent->ai, prompt, 2048,
+                                                       &BUILD_PLAN_SCHEMA);
 
     AIBuildPlan* plan = NULL;
     if (response_text) {
@@ -907,7 +850,8 @@ AIBuildPlan* ai_build_agent_analyze_error(AIBuildAgent* agent,
     if (!prompt) return NULL;
 
     /* Query AI provider */
-    char* response_text = ai_provider_query(agent->ai, prompt, 2048);
+    char* response_text = ai_provider_query_structured(agent->ai, prompt, 2048,
+                                                       &BUILD_FIX_SCHEMA);
 
     AIBuildPlan* plan = NULL;
     if (response_text) {
@@ -0,0 +1,557 @@
+/**
+ * @file ai_cache.c
+ * @brief Persistent exact-match cache for AI completions
+ *
+ * Each entry is <key>.json in the cache directory. A lookup is a single
+ * file read, so entries written by another process are found without any
+ * shared index. Recency is the file's modification time, refreshed on every
+ * hit; eviction rescans the directory and removes the oldest files until
+ * the total is back under 90% of the budget.
+ */
+
+#include "cyxmake/ai_cache.h"
+#include "cyxmake/distributed/sha256.h"
+#include "cyxmake/file_ops.h"
+#include "cyxmake/threading.h"
+#include "cyxmake/logger.h"
+#include "cJSON.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <sys/utime.h>
+#define strdup _strdup
+#define utime _utime
+#else
+#include <sys/time.h>
+#include <dirent.h>
+#include <utime.h>
+#endif
+
+#define DEFAULT_MAX_BYTES (64u * 1024 * 1024)
+#define DEFAULT_TTL_SEC (7L * 24 * 60 * 60)
+#define EVICTION_TARGET 0.9
+#define KEY_HEX_LENGTH (AI_CACHE_KEY_SIZE - 1)
+#define ENTRY_SUFFIX ".json"
+
+/* Bumped whenever the key derivation or entry format changes */
+#define KEY_VERSION "cyxmake-ai-cache-v2"
+
+struct AIResponseCache {
+    char* dir;
+    size_t max_bytes;
+    long ttl_sec;
+    MutexHandle mutex;            /* Guards stats and eviction */
+    AIResponseCacheStats stats;
+};
+
+/* ========================================================================
+ * Helpers
+ * ======================================================================== */
+
+static double now_sec(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart / (double)freq.QuadPart;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1e6;
+#endif
+}
+
+static char* default_cache_dir(void) {
+#ifdef _WIN32
+    const char* home = getenv("USERPROFILE");
+#else
+    const char* home = getenv("HOME");
+#endif
+    if (!home) home = ".";
+
+    size_t len = strlen(home) + 32;
+    char* dir = malloc(len);
+    if (dir) snprintf(dir, len, "%s/.cyxmake/ai_cache", home);
+    return dir;
+}
+
+/* Keys are hex digests; anything else must not reach a path */
+static bool is_valid_key(const char* key) {
+    if (!key) return false;
+    for (int i = 0; i < KEY_HEX_LENGTH; i++) {
+        char c = key[i];
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) return false;
+    }
+    return key[KEY_HEX_LENGTH] == '\0';
+}
+
+static bool is_entry_name(const char* name) {
+    return strlen(name) == KEY_HEX_LENGTH + strlen(ENTRY_SUFFIX) &&
+           strcmp(name + KEY_HEX_LENGTH, ENTRY_SUFFIX) == 0;
+}
+
+static void entry_path(const AIResponseCache* cache, const char* key,
+                       char* path, size_t size) {
+    snprintf(path, size, "%s/%s%s", cache->dir, key, ENTRY_SUFFIX);
+}
+
+static bool file_info(const char* path, size_t* size, time_t* mtime) {
+    struct stat st;
+    if (stat(path, &st) != 0) return false;
+    if (size) *size = (size_t)st.st_size;
+    if (mtime) *mtime = st.st_mtime;
+    return true;
+}
+
+static bool replace_file(const char* src, const char* dst) {
+#ifdef _WIN32
+    return MoveFileExA(src, dst, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(src, dst) == 0;
+#endif
+}
+
+/* ========================================================================
+ * Directory Scan
+ * ======================================================================== */
+
+typedef struct {
+    char name[KEY_HEX_LENGTH + 8];
+    size_t size;
+    time_t mtime;
+} StoredEntry;
+
+typedef struct {
+    StoredEntry* items;
+    int count;
+    int capacity;
+} StoredEntryList;
+
+static void list_add(StoredEntryList* list, const char* dir, const char* name) {
+    if (!is_entry_name(name)) return;
+
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    StoredEntry entry;
+    if (!file_info(path, &entry.size, &entry.mtime)) return;
+    snprintf(entry.name, sizeof(entry.name), "%s", name);
+
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 64;
+        StoredEntry* items = realloc(list->items, capacity * sizeof(StoredEntry));
+        if (!items) return;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = entry;
+}
+
+static StoredEntryList scan_entries(const char* dir) {
+    StoredEntryList list = {0};
+#ifdef _WIN32
+    char pattern[1024];
+    snprintf(pattern, sizeof(pattern), "%s\\*", dir);
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA(pattern, &data);
+    if (find == INVALID_HANDLE_VALUE) return list;
+    do {
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+        list_add(&list, dir, data.cFileName);
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+#else
+    DIR* d = opendir(dir);
+    if (!d) return list;
+    struct dirent* ent;
+    while ((ent = readdir(d)) != NULL) {
+        list_add(&list, dir, ent->d_name);
+    }
+    closedir(d);
+#endif
+    return list;
+}
+
+static int compare_oldest_first(const void* a, const void* b) {
+    time_t ta = ((const StoredEntry*)a)->mtime;
+    time_t tb = ((const StoredEntry*)b)->mtime;
+    return (ta > tb) - (ta < tb);
+}
+
+/* Recount the directory and evict down to the target. Caller holds the lock. */
+static void refresh_and_evict(AIResponseCache* cache) {
+    StoredEntryList list = scan_entries(cache->dir);
+
+    size_t total = 0;
+    for (int i = 0; i < list.count; i++) total += list.items[i].size;
+
+    int entries = list.count;
+    if (total > cache->max_bytes) {
+        size_t target = (size_t)(cache->max_bytes * EVICTION_TARGET);
+        qsort(list.items, list.count, sizeof(StoredEntry), compare_oldest_first);
+
+        char path[1024];
+        for (int i = 0; i < list.count && total > target; i++) {
+            snprintf(path, sizeof(path), "%s/%s", cache->dir, list.items[i].name);
+            if (remove(path) != 0) continue;
+            total -= list.items[i].size;
+            entries--;
+            cache->stats.evictions++;
+        }
+        log_debug("AI cache evicted down to %zu bytes", total);
+    }
+
+    cache->stats.entries = entries;
+    cache->stats.total_bytes = total;
+    free(list.items);
+}
+
+/* ========================================================================
+ * Keys
+ * ======================================================================== */
+
+/* CRLF to LF, trailing whitespace dropped per line, blank ends trimmed */
+static char* normalize_text(const char* text, size_t* out_len) {
+    size_t len = strlen(text);
+    char* out = malloc(len + 1);
+    if (!out) return NULL;
+
+    size_t n = 0;
+    for (size_t i = 0; i < len; i++) {
+        char c = text[i];
+        if (c == '\r' && text[i + 1] == '\n') continue;
+        if (c == '\n') {
+            while (n > 0 && (out[n - 1] == ' ' || out[n - 1] == '\t' ||
+                             out[n - 1] == '\r')) {
+                n--;
+            }
+        }
+        out[n++] = c;
+    }
+
+    size_t start = 0;
+    while (start < n && (out[start] == ' ' || out[start] == '\t' ||
+                         out[start] == '\n' || out[start] == '\r')) {
+        start++;
+    }
+    while (n > start && (out[n - 1] == ' ' || out[n - 1] == '\t' ||
+                         out[n - 1] == '\n' || out[n - 1] == '\r')) {
+        n--;
+    }
+
+    memmove(out, out + start, n - start);
+    *out_len = n - start;
+    out[*out_len] = '\0';
+    return out;
+}
+
+static void hash_part(Sha256Context* ctx, const char* part) {
+    /* Tag and length prefix keep ("ab", "c") apart from ("a", "bc") */
+    uint8_t tag = part ? 1 : 0;
+    sha256_update(ctx, &tag, 1);
+    if (!part) return;
+
+    size_t len = 0;
+    char* text = normalize_text(part, &len);
+    const char* data = text ? text : part;
+    if (!text) len = strlen(part);
+
+    uint8_t prefix[8];
+    for (int i = 0; i < 8; i++) prefix[i] = (uint8_t)((uint64_t)len >> (8 * i));
+    sha256_update(ctx, prefix, sizeof(prefix));
+    sha256_update(ctx, (const uint8_t*)data, len);
+    free(text);
+}
+
+static void finish_key(Sha256Context* ctx, char key[AI_CACHE_KEY_SIZE]) {
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    sha256_final(ctx, digest);
+    for (int i = 0; i < SHA256_DIGEST_SIZE; i++) {
+        snprintf(key + 2 * i, 3, "%02x", digest[i]);
+    }
+}
+
+void ai_response_cache_key(const char* const* parts, int count,
+                           char key[AI_CACHE_KEY_SIZE]) {
+    Sha256Context ctx;
+    sha256_init(&ctx);
+    for (int i = 0; i < count; i++) hash_part(&ctx, parts[i]);
+
+    finish_key(&ctx, key);
+}
+
+void ai_response_cache_request_key(const AIProvider* provider,
+                                   const AIRequest* request,
+                                   char key[AI_CACHE_KEY_SIZE]) {
+    int max_tokens = request->max_tokens > 0 ? request->max_tokens
+                                             : provider->config.max_tokens;
+    float temperature = request->temperature > 0 ? request->temperature
+                                                 : provider->config.temperature;
+    char max_tokens_str[32], temperature_str[32];
+    snprintf(max_tokens_str, sizeof(max_tokens_str), "%d", max_tokens);
+    snprintf(temperature_str, sizeof(temperature_str), "%.2f", temperature);
+
+    Sha256Context ctx;
+    sha256_init(&ctx);
+    hash_part(&ctx, KEY_VERSION);
+    hash_part(&ctx, ai_provider_type_to_string(provider->config.type));
+    hash_part(&ctx, provider->config.base_url);
+    hash_part(&ctx, provider->config.type == AI_PROVIDER_LLAMACPP
+                        ? provider->config.model_path : provider->config.model);
+    hash_part(&ctx, request->system_prompt);
+    for (int i = 0; i < request->message_count; i++) {
+        const AIMessage* msg = &request->messages[i];
+        hash_part(&ctx, msg->role == AI_ROLE_SYSTEM ? "system" :
+                        msg->role == AI_ROLE_USER ? "user" : "assistant");
+        hash_part(&ctx, msg->content);
+    }
+    hash_part(&ctx, request->tools_json);
+    hash_part(&ctx, request->response_schema);
+    hash_part(&ctx, max_tokens_str);
+    hash_part(&ctx, temperature_str);
+
+    finish_key(&ctx, key);
+}
+
+/* ========================================================================
+ * Lifecycle
+ * ======================================================================== */
+
+AIResponseCacheConfig ai_response_cache_config_default(void) {
+    AIResponseCacheConfig config = {
+        .cache_dir = NULL,
+        .max_bytes = DEFAULT_MAX_BYTES,
+        .ttl_sec = DEFAULT_TTL_SEC
+    };
+    return config;
+}
+
+AIResponseCache* ai_response_cache_open(const AIResponseCacheConfig* config) {
+    AIResponseCacheConfig defaults = ai_response_cache_config_default();
+    if (!config) config = &defaults;
+
+    AIResponseCache* cache = calloc(1, sizeof(AIResponseCache));
+    if (!cache) return NULL;
+
+    cache->dir = config->cache_dir ? strdup(config->cache_dir) : default_cache_dir();
+    cache->max_bytes = config->max_bytes > 0 ? config->max_bytes : DEFAULT_MAX_BYTES;
+    cache->ttl_sec = config->ttl_sec > 0 ? config->ttl_sec : DEFAULT_TTL_SEC;
+
+    if (!cache->dir || !dir_create(cache->dir)) {
+        log_error("Cannot create AI response cache directory: %s",
+                  cache->dir ? cache->dir : "(null)");
+        free(cache->dir);
+        free(cache);
+        return NULL;
+    }
+
+    mutex_init(&cache->mutex);
+    refresh_and_evict(cache);
+
+    log_debug("AI response cache: %s (%d entries, %zu bytes)",
+              cache->dir, cache->stats.entries, cache->stats.total_bytes);
+    return cache;
+}
+
+void ai_response_cache_close(AIResponseCache* cache) {
+    if (!cache) return;
+    mutex_destroy(&cache->mutex);
+    free(cache->dir);
+    free(cache);
+}
+
+/* ========================================================================
+ * Lookup and Store
+ * ======================================================================== */
+
+static char* json_string(const cJSON* obj, const char* name) {
+    const cJSON* item = cJSON_GetObjectItemCaseSensitive(obj, name);
+    return cJSON_IsString(item) ? strdup(item->valuestring) : NULL;
+}
+
+static int json_int(const cJSON* obj, const char* name) {
+    const cJSON* item = cJSON_GetObjectItemCaseSensitive(obj, name);
+    return cJSON_IsNumber(item) ? item->valueint : 0;
+}
+
+static AIResponse* response_from_json(const cJSON* root) {
+    AIResponse* response = calloc(1, sizeof(AIResponse));
+    if (!response) return NULL;
+
+    response->success = true;
+    response->cached = true;
+    response->content = json_string(root, "content");
+    response->prompt_tokens = json_int(root, "prompt_tokens");
+    response->completion_tokens = json_int(root, "completion_tokens");
+    response->total_tokens = json_int(root, "total_tokens");
+
+    const cJSON* calls = cJSON_GetObjectItemCaseSensitive(root, "tool_calls");
+    int count = cJSON_IsArray(calls) ? cJSON_GetArraySize(calls) : 0;
+    if (count > 0) {
+        response->tool_calls = calloc(count, sizeof(AIToolCall));
+        if (response->tool_calls) {
+            const cJSON* call;
+            cJSON_ArrayForEach(call, calls) {
+                AIToolCall* tc = &response->tool_calls[response->tool_call_count++];
+                tc->id = json_string(call, "id");
+                tc->name = json_string(call, "name");
+                tc->arguments = json_string(call, "arguments");
+            }
+        }
+    }
+    return response;
+}
+
+static void remove_entry(AIResponseCache* cache, const char* path) {
+    size_t size = 0;
+    if (file_info(path, &size, NULL) && remove(path) == 0) {
+        mutex_lock(&cache->mutex);
+        if (cache->stats.entries > 0) cache->stats.entries--;
+        cache->stats.total_bytes -= size < cache->stats.total_bytes
+                                        ? size : cache->stats.total_bytes;
+        mutex_unlock(&cache->mutex);
+    }
+}
+
+AIResponse* ai_response_cache_get(AIResponseCache* cache, const char* key) {
+    if (!cache || !is_valid_key(key)) return NULL;
+
+    double start = now_sec();
+    char path[1024];
+    entry_path(cache, key, path, sizeof(path));
+
+    /* A miss is the common case; file_read would log it as an error */
+    char* text = file_info(path, NULL, NULL) ? file_read(path, NULL) : NULL;
+    cJSON* root = text ? cJSON_Parse(text) : NULL;
+    free(text);
+
+    bool expired = false;
+    AIResponse* response = NULL;
+    if (root) {
+        const cJSON* created = cJSON_GetObjectItemCaseSensitive(root, "created");
+        expired = !cJSON_IsNumber(created) ||
+                  difftime(time(NULL), (time_t)created->valuedouble) > (double)cache->ttl_sec;
+        if (!expired) response = response_from_json(root);
+        cJSON_Delete(root);
+    }
+
+    if (expired) {
+        remove_entry(cache, path);
+    } else if (response) {
+        utime(path, NULL);  /* Mark as recently used */
+        response->duration_sec = now_sec() - start;
+    }
+
+    mutex_lock(&cache->mutex);
+    cache->stats.lookups++;
+    if (response) {
+        cache->stats.hits++;
+    } else {
+        cache->stats.misses++;
+        if (expired) cache->stats.expired++;
+    }
+    mutex_unlock(&cache->mutex);
+
+    return response;
+}
+
+bool ai_response_cache_put(AIResponseCache* cache, const char* key,
+                           const AIResponse* response) {
+    if (!cache || !is_valid_key(key) || !response || !response->success) {
+        return false;
+    }
+
+    cJSON* root = cJSON_CreateObject();
+    if (!root) return false;
+    cJSON_AddNumberToObject(root, "created", (double)time(NULL));
+    if (response->content) {
+        cJSON_AddStringToObject(root, "content", response->content);
+    }
+    if (response->tool_call_count > 0) {
+        cJSON* calls = cJSON_AddArrayToObject(root, "tool_calls");
+        for (int i = 0; i < response->tool_call_count; i++) {
+            const AIToolCall* tc = &response->tool_calls[i];
+            cJSON* call = cJSON_CreateObject();
+            if (tc->id) cJSON_AddStringToObject(call, "id", tc->id);
+            if (tc->name) cJSON_AddStringToObject(call, "name", tc->name);
+            if (tc->arguments) cJSON_AddStringToObject(call, "arguments", tc->arguments);
+            cJSON_AddItemToArray(calls, call);
+        }
+    }
+    cJSON_AddNumberToObject(root, "prompt_tokens", response->prompt_tokens);
+    cJSON_AddNumberToObject(root, "completion_tokens", response->completion_tokens);
+    cJSON_AddNumberToObject(root, "total_tokens", response->total_tokens);
+
+    char* text = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    if (!text) return false;
+
+    char path[1024], temp_path[1040];
+    entry_path(cache, key, path, sizeof(path));
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+
+    /* Write aside and rename so readers never see a partial entry */
+    size_t old_size = 0;
+    bool existed = file_info(path, &old_size, NULL);
+    size_t new_size = strlen(text);
+    bool stored = file_write(temp_path, text) && replace_file(temp_path, path);
+    free(text);
+
+    if (!stored) {
+        log_warning("Failed to store AI response cache entry: %s", key);
+        remove(temp_path);
+        return false;
+    }
+
+    mutex_lock(&cache->mutex);
+    cache->stats.stores++;
+    if (existed) {
+        cache->stats.total_bytes -= old_size < cache->stats.total_bytes
+                                        ? old_size : cache->stats.total_bytes;
+    } else {
+        cache->stats.entries++;
+    }
+    cache->stats.total_bytes += new_size;
+    if (cache->stats.total_bytes > cache->max_bytes) {
+        refresh_and_evict(cache);
+    }
+    mutex_unlock(&cache->mutex);
+
+    return true;
+}
+
+AIResponseCacheStats ai_response_cache_get_stats(AIResponseCache* cache) {
+    AIResponseCacheStats stats = {0};
+    if (!cache) return stats;
+
+    mutex_lock(&cache->mutex);
+    stats = cache->stats;
+    mutex_unlock(&cache->mutex);
+    return stats;
+}
+
+int ai_response_cache_clear(AIResponseCache* cache) {
+    if (!cache) return 0;
+
+    mutex_lock(&cache->mutex);
+    StoredEntryList list = scan_entries(cache->dir);
+    int removed = 0;
+    char path[1024];
+    for (int i = 0; i < list.count; i++) {
+        snprintf(path, sizeof(path), "%s/%s", cache->dir, list.items[i].name);
+        if (remove(path) == 0) removed++;
+    }
+    free(list.items);
+    cache->stats.entries = 0;
+    cache->stats.total_bytes = 0;
+    mutex_unlock(&cache->mutex);
+
+    return removed;
+}
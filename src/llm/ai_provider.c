@@ -4,6 +4,11 @@
  */
 
 #include "cyxmake/ai_provider.h"
+#include "cyxmake/http_pool.h"
+#include "cyxmake/ai_stream.h"
+#include "cyxmake/ai_cache.h"
+#include "cyxmake/ai_schema.h"
+#include "cyxmake/threading.h"
 #include "cyxmake/logger.h"
 #include "tomlc99/toml.h"
 #include <stdlib.h>
@@ -33,10 +38,13 @@ struct AIProviderRegistry {
     int count;
     char* default_provider;
     char* fallback_provider;
+    AIResponseCache* response_cache;
+    AIHedgeConfig hedge;
 };
 
 AIProviderRegistry* ai_registry_create(void) {
     AIProviderRegistry* registry = calloc(1, sizeof(AIProviderRegistry));
+    if (registry) registry->hedge = ai_hedge_config_default();
     return registry;
 }
 
@@ -47,6 +55,7 @@ void ai_registry_free(AIProviderRegistry* registry) {
         ai_provider_free(registry->providers[i]);
     }
 
+    ai_response_cache_close(registry->response_cache);
     free(registry->default_provider);
     free(registry->fallback_provider);
     free(registry);
@@ -62,6 +71,7 @@ bool ai_registry_add(AIProviderRegistry* registry, const AIProviderConfig* confi
         return false;
     }
 
+    ai_provider_set_response_cache(provider, registry->response_cache);
     registry->providers[registry->count++] = provider;
 
     /* Set as default if it's the first enabled provider */
@@ -143,6 +153,21 @@ int ai_registry_count(AIProviderRegistry* registry) {
     return count;
 }
 
+void ai_registry_set_response_cache(AIProviderRegistry* registry,
+                                    AIResponseCache* cache) {
+    if (!registry || registry->response_cache == cache) return;
+
+    ai_response_cache_close(registry->response_cache);
+    registry->response_cache = cache;
+    for (int i = 0; i < registry->count; i++) {
+        ai_provider_set_response_cache(registry->providers[i], cache);
+    }
+}
+
+AIResponseCache* ai_registry_get_response_cache(AIProviderRegistry* registry) {
+    return registry ? registry->response_cache : NULL;
+}
+
 /* ========================================================================
  * TOML Configuration Loading
  * ======================================================================== */
@@ -244,6 +269,7 @@ int ai_registry_load_config(AIProviderRegistry* registry, const char* config_pat
     int global_timeout = 120;  /* 2 minutes default for AI responses */
     int global_max_tokens = 2048;
     float global_temperature = 0.7f;
+    int global_context_tokens = 8192;
 
     toml_datum_t timeout = toml_int_in(ai, "timeout");
     if (timeout.ok) global_timeout = (int)timeout.u.i;
@@ -254,6 +280,46 @@ int ai_registry_load_config(AIProviderRegistry* registry, const char* config_pat
     toml_datum_t temperature = toml_double_in(ai, "temperature");
     if (temperature.ok) global_temperature = (float)temperature.u.d;
 
+    toml_datum_t context_tokens = toml_int_in(ai, "context_tokens");
+    if (context_tokens.ok) global_context_tokens = (int)context_tokens.u.i;
+
+    /* Opt-in response cache, opened before providers so they all share it */
+    toml_datum_t response_cache = toml_bool_in(ai, "response_cache");
+    if (response_cache.ok && response_cache.u.b && !registry->response_cache) {
+        AIResponseCacheConfig cache_config = ai_response_cache_config_default();
+
+        toml_datum_t cache_mb = toml_int_in(ai, "response_cache_mb");
+        if (cache_mb.ok && cache_mb.u.i > 0) {
+            cache_config.max_bytes = (size_t)cache_mb.u.i * 1024 * 1024;
+        }
+
+        toml_datum_t cache_ttl = toml_int_in(ai, "response_cache_ttl_hours");
+        if (cache_ttl.ok && cache_ttl.u.i > 0) {
+            cache_config.ttl_sec = (long)cache_ttl.u.i * 60 * 60;
+        }
+
+        ai_registry_set_response_cache(registry, ai_response_cache_open(&cache_config));
+    }
+
+    /* Hedged fallback requests */
+    toml_datum_t hedge = toml_bool_in(ai, "hedge_requests");
+    if (hedge.ok) registry->hedge.enabled = hedge.u.b;
+
+    toml_datum_t hedge_percentile = toml_double_in(ai, "hedge_percentile");
+    if (!hedge_percentile.ok) {
+        toml_datum_t whole = toml_int_in(ai, "hedge_percentile");
+        hedge_percentile.ok = whole.ok;
+        hedge_percentile.u.d = (double)whole.u.i;
+    }
+    if (hedge_percentile.ok && hedge_percentile.u.d > 0 && hedge_percentile.u.d <= 100) {
+        registry->hedge.percentile = hedge_percentile.u.d / 100.0;
+    }
+
+    toml_datum_t hedge_delay = toml_int_in(ai, "hedge_delay_ms");
+    if (hedge_delay.ok && hedge_delay.u.i > 0) {
+        registry->hedge.default_delay_ms = (int)hedge_delay.u.i;
+    }
+
     /* Get [ai.providers] section */
     toml_table_t* providers = toml_table_in(ai, "providers");
     if (!providers) {
@@ -301,6 +367,7 @@ int ai_registry_load_config(AIProviderRegistry* registry, const char* config_pat
         config->timeout_sec = global_timeout;
         config->max_tokens = global_max_tokens;
         config->temperature = global_temperature;
+        config->context_tokens = global_context_tokens;
 
         /* Get API key */
         toml_datum_t api_key = toml_string_in(provider, "api_key");
@@ -334,6 +401,15 @@ int ai_registry_load_config(AIProviderRegistry* registry, const char* config_pat
         toml_datum_t context_size = toml_int_in(provider, "context_size");
         if (context_size.ok) config->context_size = (int)context_size.u.i;
 
+        /* Get prompt context budget, kept within a local model's window */
+        toml_datum_t provider_context_tokens = toml_int_in(provider, "context_tokens");
+        if (provider_context_tokens.ok) {
+            config->context_tokens = (int)provider_context_tokens.u.i;
+        } else if (type == AI_PROVIDER_LLAMACPP && context_size.ok) {
+            int window = config->context_size - config->max_tokens;
+            if (window > 0 && window < config->context_tokens) config->context_tokens = window;
+        }
+
         /* Get GPU layers */
         toml_datum_t gpu_layers = toml_int_in(provider, "gpu_layers");
         if (gpu_layers.ok) config->gpu_layers = (int)gpu_layers.u.i;
@@ -399,6 +475,7 @@ AIProviderConfig* ai_config_create(const char* name, AIProviderType type) {
     config->timeout_sec = 120;  /* 2 minutes default */
     config->max_tokens = 2048;
     config->temperature = 0.7f;
+    config->context_tokens = 8192;
     config->context_size = 4096;
     config->threads = 4;
 
@@ -535,6 +612,7 @@ void ai_request_free(AIRequest* request) {
     free(request->messages);
     free(request->system_prompt);
     free(request->tools_json);
+    free(request->response_schema);
     free(request);
 }
 
@@ -568,6 +646,7 @@ static AIProviderVTable* get_llamacpp_vtable(void);
 /* Forward declarations for HTTP support functions */
 bool ai_provider_has_http_support(void);
 bool ai_provider_type_requires_http(AIProviderType type);
+static void provider_http_free(AIProvider* provider);
 
 AIProvider* ai_provider_create(const AIProviderConfig* config) {
     if (!config) return NULL;
@@ -598,6 +677,7 @@ AIProvider* ai_provider_create(const AIProviderConfig* config) {
     provider->config.timeout_sec = config->timeout_sec > 0 ? config->timeout_sec : 60;
     provider->config.max_tokens = config->max_tokens > 0 ? config->max_tokens : 1024;
     provider->config.temperature = config->temperature;
+    provider->config.context_tokens = config->context_tokens > 0 ? config->context_tokens : 0;
 
     /* Copy headers */
     if (config->headers && config->header_count > 0) {
@@ -633,6 +713,12 @@ AIProvider* ai_provider_create(const AIProviderConfig* config) {
 
     provider->status = config->enabled ? PROVIDER_STATUS_UNKNOWN : PROVIDER_STATUS_DISABLED;
 
+    /* Cloud providers share one pool of warm connections */
+    if (ai_provider_type_requires_http(config->type)) {
+        provider->http_pool = http_pool_acquire_shared();
+    }
+    mutex_init(&provider->http_lock);
+
     return provider;
 }
 
@@ -659,6 +745,10 @@ void ai_provider_free(AIProvider* provider) {
         free(provider->config.headers);
     }
 
+    provider_http_free(provider);
+    mutex_destroy(&provider->http_lock);
+    if (provider->http_pool) http_pool_release_shared();
+
     free(provider->last_error);
     free(provider);
 }
@@ -694,6 +784,26 @@ const char* ai_provider_error(AIProvider* provider) {
     return provider->last_error;
 }
 
+int ai_provider_context_tokens(AIProvider* provider) {
+    return provider ? provider->config.context_tokens : 0;
+}
+
+/* Deliver a cached reply through the stream callbacks, as if it had streamed */
+static void replay_cached_response(AIResponse* response, const AIStreamCallbacks* callbacks) {
+    if (!callbacks) return;
+
+    if (callbacks->on_token && response->content && response->content[0]) {
+        callbacks->on_token(response->content, strlen(response->content),
+                            callbacks->user_data);
+    }
+    if (callbacks->on_tool_call) {
+        for (int i = 0; i < response->tool_call_count; i++) {
+            callbacks->on_tool_call(i, &response->tool_calls[i], callbacks->user_data);
+        }
+    }
+    response->first_token_sec = response->duration_sec;
+}
+
 AIResponse* ai_provider_complete(AIProvider* provider, const AIRequest* request) {
     if (!provider || !request) return NULL;
 
@@ -704,7 +814,26 @@ AIResponse* ai_provider_complete(AIProvider* provider, const AIRequest* request)
         return response;
     }
 
-    return provider->vtable->complete(provider, request);
+    char key[AI_CACHE_KEY_SIZE];
+    if (provider->response_cache) {
+        ai_response_cache_request_key(provider, request, key);
+        AIResponse* cached = ai_response_cache_get(provider->response_cache, key);
+        if (cached) {
+            log_debug("AI response cache hit (%.0f us)", cached->duration_sec * 1e6);
+            if (request->stream) replay_cached_response(cached, request->stream_callbacks);
+            return cached;
+        }
+    }
+
+    AIResponse* response = provider->vtable->complete(provider, request);
+    if (provider->response_cache && response && response->success) {
+        ai_response_cache_put(provider->response_cache, key, response);
+    }
+    return response;
+}
+
+void ai_provider_set_response_cache(AIProvider* provider, AIResponseCache* cache) {
+    if (provider) provider->response_cache = cache;
 }
 
 char* ai_provider_query(AIProvider* provider, const char* prompt, int max_tokens) {
@@ -763,6 +892,33 @@ char* ai_provider_query_with_system(AIProvider* provider,
     return result;
 }
 
+char* ai_provider_query_structured(AIProvider* provider, const char* prompt,
+                                   int max_tokens, const AISchema* schema) {
+    if (!provider || !prompt) return NULL;
+
+    AIRequest* request = ai_request_create();
+    if (!request) return NULL;
+
+    ai_request_add_message(request, AI_ROLE_USER, prompt);
+    if (max_tokens > 0) {
+        request->max_tokens = max_tokens;
+    }
+    request->response_schema = schema ? ai_schema_to_json_schema(schema) : NULL;
+
+    AIResponse* response = ai_provider_complete(provider, request);
+    ai_request_free(request);
+
+    if (!response) return NULL;
+
+    char* result = NULL;
+    if (response->success && response->content) {
+        result = strdup(response->content);
+    }
+
+    ai_response_free(response);
+    return result;
+}
+
 /* ========================================================================
  * Quick Setup Helpers
  * ======================================================================== */
@@ -888,8 +1044,10 @@ AIProvider* ai_provider_from_env(void) {
  * ======================================================================== */
 
 /*
- * Note: The actual HTTP implementations will use libcurl.
- * For now, we provide stub implementations that can be filled in.
+ * Cloud providers send their requests through the shared HTTP pool. The
+ * URL and header list depend only on configuration, so they are built on
+ * the first request and reused. Streamed requests feed the body to an
+ * AIStreamParser as it arrives instead of collecting it first.
  */
 
 /* Helper to set error on provider */
@@ -899,6 +1057,245 @@ static void set_provider_error(AIProvider* provider, const char* error) {
     provider->status = PROVIDER_STATUS_ERROR;
 }
 
+/* Helper to create a failed response */
+static AIResponse* error_response(const char* error) {
+    AIResponse* response = calloc(1, sizeof(AIResponse));
+    if (!response) return NULL;
+    response->success = false;
+    response->error = strdup(error);
+    return response;
+}
+
+/* Successful request times kept per provider for hedging */
+#define LATENCY_SAMPLES 64
+
+/* Request URL and prebuilt headers of a cloud provider */
+struct AIProviderHttp {
+    char* url;
+    char* stream_url;             /* Endpoint for streamed requests */
+    HttpHeaders* headers;
+
+    MutexHandle latency_lock;     /* Guards the latency ring */
+    double latency_ms[LATENCY_SAMPLES];
+    int latency_count;
+    int latency_next;
+};
+
+static void provider_http_free(AIProvider* provider) {
+    mutex_lock(&provider->http_lock);
+    struct AIProviderHttp* http = provider->http;
+    provider->http = NULL;
+    mutex_unlock(&provider->http_lock);
+
+    if (!http) return;
+    free(http->url);
+    free(http->stream_url);
+    http_headers_free(http->headers);
+    mutex_destroy(&http->latency_lock);
+    free(http);
+}
+
+static void record_latency(AIProvider* provider, double ms) {
+    struct AIProviderHttp* http = provider->http;
+    if (!http) return;
+
+    mutex_lock(&http->latency_lock);
+    http->latency_ms[http->latency_next] = ms;
+    http->latency_next = (http->latency_next + 1) % LATENCY_SAMPLES;
+    if (http->latency_count < LATENCY_SAMPLES) http->latency_count++;
+    mutex_unlock(&http->latency_lock);
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+double ai_provider_latency_percentile(AIProvider* provider, double percentile) {
+    if (!provider || !provider->http) return 0;
+
+    struct AIProviderHttp* http = provider->http;
+    double sorted[LATENCY_SAMPLES];
+    mutex_lock(&http->latency_lock);
+    int count = http->latency_count;
+    memcpy(sorted, http->latency_ms, sizeof(double) * (size_t)count);
+    mutex_unlock(&http->latency_lock);
+    if (count == 0) return 0;
+
+    qsort(sorted, (size_t)count, sizeof(double), compare_double);
+    if (percentile < 0) percentile = 0;
+    if (percentile > 1) percentile = 1;
+    int rank = (int)(percentile * count + 0.999999) - 1;
+    return sorted[rank < 0 ? 0 : rank];
+}
+
+static struct AIProviderHttp* provider_http_build(AIProvider* provider) {
+    struct AIProviderHttp* http = calloc(1, sizeof(struct AIProviderHttp));
+    if (!http) return NULL;
+    http->headers = http_headers_create();
+
+    const AIProviderConfig* cfg = &provider->config;
+    const char* base = cfg->base_url ? cfg->base_url : "";
+    char url[1024];
+    char stream_url[1024] = "";
+    bool ok = http->headers &&
+              http_headers_add(http->headers, "Content-Type", "application/json");
+
+    switch (cfg->type) {
+        case AI_PROVIDER_OLLAMA:
+            snprintf(url, sizeof(url), "%s/api/chat", base);
+            break;
+
+        case AI_PROVIDER_GEMINI:
+            /* Gemini URL format: {base_url}/models/{model}:generateContent?key={api_key} */
+            snprintf(url, sizeof(url), "%s/models/%s:generateContent?key=%s",
+                     base, cfg->model ? cfg->model : "",
+                     cfg->api_key ? cfg->api_key : "");
+            /* Streaming is a separate method; alt=sse selects SSE framing */
+            snprintf(stream_url, sizeof(stream_url),
+                     "%s/models/%s:streamGenerateContent?alt=sse&key=%s",
+                     base, cfg->model ? cfg->model : "",
+                     cfg->api_key ? cfg->api_key : "");
+            break;
+
+        case AI_PROVIDER_ANTHROPIC:
+            snprintf(url, sizeof(url), "%s/messages", base);
+            /* Anthropic uses x-api-key and requires anthropic-version */
+            if (ok && cfg->api_key) ok = http_headers_add(http->headers, "x-api-key", cfg->api_key);
+            if (ok) ok = http_headers_add(http->headers, "anthropic-version", "2023-06-01");
+            break;
+
+        default:
+            snprintf(url, sizeof(url), "%s/chat/completions", base);
+            if (ok && cfg->api_key) {
+                char auth[512];
+                snprintf(auth, sizeof(auth), "Bearer %s", cfg->api_key);
+                ok = http_headers_add(http->headers, "Authorization", auth);
+            }
+            break;
+    }
+
+    /* Custom headers (Ollama and Gemini never sent them) */
+    if (cfg->type == AI_PROVIDER_ANTHROPIC || cfg->type == AI_PROVIDER_OPENAI ||
+        cfg->type == AI_PROVIDER_CUSTOM) {
+        for (int i = 0; ok && i < cfg->header_count; i++) {
+            ok = http_headers_add(http->headers, cfg->headers[i].name, cfg->headers[i].value);
+        }
+    }
+
+    http->url = strdup(url);
+    http->stream_url = strdup(stream_url[0] ? stream_url : url);
+    if (!ok || !http->url || !http->stream_url) {
+        free(http->url);
+        free(http->stream_url);
+        http_headers_free(http->headers);
+        free(http);
+        return NULL;
+    }
+
+    mutex_init(&http->latency_lock);
+    return http;
+}
+
+/* Requests on several threads may race to build it; the lock picks one */
+static struct AIProviderHttp* provider_http(AIProvider* provider) {
+    mutex_lock(&provider->http_lock);
+    struct AIProviderHttp* http = provider->http;
+    if (!http) {
+        http = provider_http_build(provider);
+        provider->http = http;
+    }
+    mutex_unlock(&provider->http_lock);
+    return http;
+}
+
+/* Parser for a complete (non-streamed) response body */
+typedef AIResponse* (*ResponseParser)(const char* response_body);
+
+typedef struct {
+    AIStreamParser* parser;
+    bool stopped;                 /* Parser saw an error event */
+} StreamContext;
+
+static bool stream_chunk(const char* data, size_t len, void* user_data) {
+    StreamContext* ctx = (StreamContext*)user_data;
+    if (!ai_stream_parser_feed(ctx->parser, data, len)) {
+        ctx->stopped = true;
+        return false;
+    }
+    return true;
+}
+
+static AIResponse* provider_stream(AIProvider* provider, struct AIProviderHttp* http,
+                                   const AIRequest* request, const char* json,
+                                   ResponseParser parse) {
+    StreamContext ctx = {
+        ai_stream_parser_create(provider->config.type, request->stream_callbacks),
+        false
+    };
+    if (!ctx.parser) return error_response("Out of memory");
+
+    HttpResponse* reply = http_pool_post_stream(provider->http_pool, http->stream_url,
+                                                http->headers, json,
+                                                provider->config.timeout_sec,
+                                                stream_chunk, &ctx);
+    AIResponse* response = NULL;
+    if (!reply) {
+        response = error_response("Out of memory");
+    } else if (reply->error && !ctx.stopped) {
+        /* Connection failed or dropped mid-stream: do not trust a partial reply */
+        response = error_response(reply->error);
+    } else {
+        response = ai_stream_parser_finish(ctx.parser);
+        if (!response) {
+            /* No stream events: an error body or a server that ignored "stream" */
+            response = parse(ai_stream_parser_unframed(ctx.parser));
+        }
+    }
+
+    if (response && reply) response->duration_sec = reply->total_ms / 1000.0;
+    http_response_free(reply);
+    ai_stream_parser_free(ctx.parser);
+    return response;
+}
+
+/* Turn a complete HTTP reply into a response */
+static AIResponse* parse_reply(const HttpResponse* reply, ResponseParser parse) {
+    AIResponse* response = reply && !reply->error ?
+        parse(reply->body) :
+        error_response(reply ? reply->error : "Out of memory");
+    if (response && reply) response->duration_sec = reply->total_ms / 1000.0;
+    return response;
+}
+
+/* Send a request body built by a provider and parse the reply; takes json */
+static AIResponse* provider_exchange(AIProvider* provider, const AIRequest* request,
+                                     char* json, ResponseParser parse) {
+    if (!json) return error_response("Failed to build request");
+
+    struct AIProviderHttp* http = provider_http(provider);
+    if (!http) {
+        free(json);
+        return error_response("Out of memory");
+    }
+
+    if (request->stream) {
+        AIResponse* response = provider_stream(provider, http, request, json, parse);
+        free(json);
+        if (response && response->success) record_latency(provider, response->duration_sec * 1000.0);
+        return response;
+    }
+
+    HttpResponse* reply = http_pool_post(provider->http_pool, http->url, http->headers,
+                                         json, provider->config.timeout_sec);
+    free(json);
+
+    AIResponse* response = parse_reply(reply, parse);
+    if (response && response->success) record_latency(provider, reply->total_ms);
+    http_response_free(reply);
+    return response;
+}
+
 /* ========================================================================
  * OpenAI Provider (and compatible APIs)
  * ======================================================================== */
@@ -930,6 +1327,7 @@ static bool openai_init(AIProvider* provider) {
 static void openai_shutdown(AIProvider* provider) {
     if (provider) {
         provider->status = PROVIDER_STATUS_UNKNOWN;
+        provider_http_free(provider);  /* Rebuilt from config on next use */
     }
 }
 
@@ -959,6 +1357,9 @@ static char* build_openai_request_json(AIProvider* provider, const AIRequest* re
     if (request->tools_json) {
         size += strlen(request->tools_json) + 100;
     }
+    if (request->response_schema) {
+        size += strlen(request->response_schema) + 128;
+    }
 
     char* json = malloc(size);
     if (!json) return NULL;
@@ -1022,6 +1423,22 @@ static char* build_openai_request_json(AIProvider* provider, const AIRequest* re
                            request->tools_json);
     }
 
+    if (request->response_schema) {
+        offset += snprintf(json + offset, size - offset,
+                           ",\"response_format\":{\"type\":\"json_schema\",\"json_schema\":"
+                           "{\"name\":\"response\",\"schema\":%s}}",
+                           request->response_schema);
+    }
+
+    /* Streamed replies only carry usage when asked (OpenAI itself) */
+    if (request->stream) {
+        offset += snprintf(json + offset, size - offset, ",\"stream\":true");
+        if (provider->config.type == AI_PROVIDER_OPENAI) {
+            offset += snprintf(json + offset, size - offset,
+                               ",\"stream_options\":{\"include_usage\":true}");
+        }
+    }
+
     /* Close JSON object */
     offset += snprintf(json + offset, size - offset, "}");
 
@@ -1257,117 +1674,14 @@ static AIResponse* parse_openai_response(const char* response_body) {
     return response;
 }
 
-#ifdef CYXMAKE_USE_CURL
-#include <curl/curl.h>
-
-/* CURL write callback */
-struct CurlBuffer {
-    char* data;
-    size_t size;
-};
-
-static size_t cyxmake_curl_write_cb(void* contents, size_t size, size_t nmemb, void* userp) {
-    size_t realsize = size * nmemb;
-    struct CurlBuffer* buf = (struct CurlBuffer*)userp;
-
-    char* ptr = realloc(buf->data, buf->size + realsize + 1);
-    if (!ptr) return 0;
-
-    buf->data = ptr;
-    memcpy(&(buf->data[buf->size]), contents, realsize);
-    buf->size += realsize;
-    buf->data[buf->size] = '\0';
-
-    return realsize;
-}
-
 static AIResponse* openai_complete(AIProvider* provider, const AIRequest* request) {
     if (!provider || !request) return NULL;
 
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        AIResponse* response = calloc(1, sizeof(AIResponse));
-        response->error = strdup("Failed to initialize CURL");
-        return response;
-    }
-
-    /* Build request JSON */
-    char* json = build_openai_request_json(provider, request);
-    if (!json) {
-        curl_easy_cleanup(curl);
-        AIResponse* response = calloc(1, sizeof(AIResponse));
-        response->error = strdup("Failed to build request");
-        return response;
-    }
-
-    /* Build URL */
-    char url[512];
-    snprintf(url, sizeof(url), "%s/chat/completions", provider->config.base_url);
-
-    /* Set up headers */
-    struct curl_slist* headers = NULL;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-
-    if (provider->config.api_key) {
-        char auth[512];
-        snprintf(auth, sizeof(auth), "Authorization: Bearer %s", provider->config.api_key);
-        headers = curl_slist_append(headers, auth);
-    }
-
-    /* Add custom headers */
-    for (int i = 0; i < provider->config.header_count; i++) {
-        char header[512];
-        snprintf(header, sizeof(header), "%s: %s",
-                 provider->config.headers[i].name,
-                 provider->config.headers[i].value);
-        headers = curl_slist_append(headers, header);
-    }
-
-    /* Response buffer */
-    struct CurlBuffer response_buf = {0};
-
-    /* Configure CURL */
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, cyxmake_curl_write_cb);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_buf);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, provider->config.timeout_sec);
-
-    /* Perform request */
-    CURLcode res = curl_easy_perform(curl);
-
-    AIResponse* response = NULL;
-    if (res == CURLE_OK) {
-        response = parse_openai_response(response_buf.data);
-    } else {
-        response = calloc(1, sizeof(AIResponse));
-        response->error = strdup(curl_easy_strerror(res));
-    }
-
-    /* Cleanup */
-    free(json);
-    free(response_buf.data);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    return response;
-}
-
-#else /* No CURL */
-
-static AIResponse* openai_complete(AIProvider* provider, const AIRequest* request) {
-    (void)provider;
-    (void)request;
-
-    AIResponse* response = calloc(1, sizeof(AIResponse));
-    response->success = false;
-    response->error = strdup("HTTP support not compiled (CURL not available)");
-    return response;
+    return provider_exchange(provider, request,
+                             build_openai_request_json(provider, request),
+                             parse_openai_response);
 }
 
-#endif /* CYXMAKE_USE_CURL */
-
 static AIProviderVTable openai_vtable = {
     .init = openai_init,
     .shutdown = openai_shutdown,
@@ -1409,6 +1723,9 @@ static char* build_ollama_request_json(AIProvider* provider, const AIRequest* re
     for (int i = 0; i < request->message_count; i++) {
         size += strlen(request->messages[i].content) + 100;
     }
+    if (request->response_schema) {
+        size += strlen(request->response_schema) + 32;
+    }
 
     char* json = malloc(size);
     if (!json) return NULL;
@@ -1448,101 +1765,56 @@ static char* build_ollama_request_json(AIProvider* provider, const AIRequest* re
         }
     }
 
-    offset += snprintf(json + offset, size - offset, "],\"stream\":false}");
-
-    return json;
-}
-
-#ifdef CYXMAKE_USE_CURL
-
-static AIResponse* ollama_complete(AIProvider* provider, const AIRequest* request) {
-    if (!provider || !request) return NULL;
-
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        AIResponse* response = calloc(1, sizeof(AIResponse));
-        response->error = strdup("Failed to initialize CURL");
-        return response;
-    }
+    offset += snprintf(json + offset, size - offset, "],\"stream\":%s",
+                       request->stream ? "true" : "false");
 
-    char* json = build_ollama_request_json(provider, request);
-    if (!json) {
-        curl_easy_cleanup(curl);
-        AIResponse* response = calloc(1, sizeof(AIResponse));
-        response->error = strdup("Failed to build request");
-        return response;
+    /* Ollama constrains the output to the schema itself */
+    if (request->response_schema) {
+        offset += snprintf(json + offset, size - offset, ",\"format\":%s",
+                           request->response_schema);
     }
 
-    char url[512];
-    snprintf(url, sizeof(url), "%s/api/chat", provider->config.base_url);
-
-    struct curl_slist* headers = NULL;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-
-    struct CurlBuffer response_buf = {0};
-
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, cyxmake_curl_write_cb);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_buf);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, provider->config.timeout_sec);
+    offset += snprintf(json + offset, size - offset, "}");
 
-    CURLcode res = curl_easy_perform(curl);
+    return json;
+}
 
-    AIResponse* response = NULL;
-    if (res == CURLE_OK) {
-        /* Parse Ollama response format */
-        response = calloc(1, sizeof(AIResponse));
+/* Parse Ollama response: "message":{"role":"assistant","content":"..."} */
+static AIResponse* parse_ollama_response(const char* response_body) {
+    AIResponse* response = calloc(1, sizeof(AIResponse));
+    if (!response) return NULL;
 
-        /* Look for "message":{"role":"assistant","content":"..."} */
-        const char* content_start = strstr(response_buf.data, "\"content\":");
+    const char* content_start = strstr(response_body, "\"content\":");
+    if (content_start) {
+        content_start = strchr(content_start + 10, '"');
         if (content_start) {
-            content_start = strchr(content_start + 10, '"');
-            if (content_start) {
-                content_start++;
-                const char* content_end = content_start;
-                while (*content_end && !(*content_end == '"' && *(content_end - 1) != '\\')) {
-                    content_end++;
-                }
-                size_t len = content_end - content_start;
-                response->content = malloc(len + 1);
-                strncpy(response->content, content_start, len);
-                response->content[len] = '\0';
-                response->success = true;
+            content_start++;
+            const char* content_end = content_start;
+            while (*content_end && !(*content_end == '"' && *(content_end - 1) != '\\')) {
+                content_end++;
             }
+            size_t len = content_end - content_start;
+            response->content = malloc(len + 1);
+            strncpy(response->content, content_start, len);
+            response->content[len] = '\0';
+            response->success = true;
         }
-
-        if (!response->success) {
-            response->error = strdup("Failed to parse Ollama response");
-        }
-    } else {
-        response = calloc(1, sizeof(AIResponse));
-        response->error = strdup(curl_easy_strerror(res));
     }
 
-    free(json);
-    free(response_buf.data);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
+    if (!response->success) {
+        response->error = strdup("Failed to parse Ollama response");
+    }
     return response;
 }
 
-#else
-
 static AIResponse* ollama_complete(AIProvider* provider, const AIRequest* request) {
-    (void)provider;
-    (void)request;
+    if (!provider || !request) return NULL;
 
-    AIResponse* response = calloc(1, sizeof(AIResponse));
-    response->success = false;
-    response->error = strdup("HTTP support not compiled (CURL not available)");
-    return response;
+    return provider_exchange(provider, request,
+                             build_ollama_request_json(provider, request),
+                             parse_ollama_response);
 }
 
-#endif
-
 static AIProviderVTable ollama_vtable = {
     .init = ollama_init,
     .shutdown = openai_shutdown,
@@ -1630,9 +1902,17 @@ static char* build_gemini_request_json(AIProvider* provider, const AIRequest* re
     float temp = request->temperature > 0 ? request->temperature : provider->config.temperature;
 
     offset += snprintf(json + offset, size - offset,
-                       "],\"generationConfig\":{\"maxOutputTokens\":%d,\"temperature\":%.2f}}",
+                       "],\"generationConfig\":{\"maxOutputTokens\":%d,\"temperature\":%.2f",
                        max_tokens, temp);
 
+    /* JSON mode only; the schema is still checked when the reply is parsed */
+    if (request->response_schema) {
+        offset += snprintf(json + offset, size - offset,
+                           ",\"responseMimeType\":\"application/json\"");
+    }
+
+    offset += snprintf(json + offset, size - offset, "}}");
+
     return json;
 }
 
@@ -1708,75 +1988,14 @@ static AIResponse* parse_gemini_response(const char* response_body) {
     return response;
 }
 
-#ifdef CYXMAKE_USE_CURL
-
 static AIResponse* gemini_complete(AIProvider* provider, const AIRequest* request) {
     if (!provider || !request) return NULL;
 
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        AIResponse* response = calloc(1, sizeof(AIResponse));
-        response->error = strdup("Failed to initialize CURL");
-        return response;
-    }
-
-    char* json = build_gemini_request_json(provider, request);
-    if (!json) {
-        curl_easy_cleanup(curl);
-        AIResponse* response = calloc(1, sizeof(AIResponse));
-        response->error = strdup("Failed to build request");
-        return response;
-    }
-
-    /* Gemini URL format: {base_url}/models/{model}:generateContent?key={api_key} */
-    char url[1024];
-    snprintf(url, sizeof(url), "%s/models/%s:generateContent?key=%s",
-             provider->config.base_url, provider->config.model, provider->config.api_key);
-
-    struct curl_slist* headers = NULL;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-
-    struct CurlBuffer response_buf = {0};
-
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, cyxmake_curl_write_cb);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_buf);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, provider->config.timeout_sec);
-
-    CURLcode res = curl_easy_perform(curl);
-
-    AIResponse* response = NULL;
-    if (res == CURLE_OK) {
-        response = parse_gemini_response(response_buf.data);
-    } else {
-        response = calloc(1, sizeof(AIResponse));
-        response->error = strdup(curl_easy_strerror(res));
-    }
-
-    free(json);
-    free(response_buf.data);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    return response;
+    return provider_exchange(provider, request,
+                             build_gemini_request_json(provider, request),
+                             parse_gemini_response);
 }
 
-#else
-
-static AIResponse* gemini_complete(AIProvider* provider, const AIRequest* request) {
-    (void)provider;
-    (void)request;
-
-    AIResponse* response = calloc(1, sizeof(AIResponse));
-    response->success = false;
-    response->error = strdup("HTTP support not compiled (CURL not available)");
-    return response;
-}
-
-#endif
-
 static AIProviderVTable gemini_vtable = {
     .init = gemini_init,
     .shutdown = openai_shutdown,
@@ -1835,8 +2054,9 @@ static char* build_anthropic_request_json(AIProvider* provider, const AIRequest*
     int max_tokens = request->max_tokens > 0 ? request->max_tokens : provider->config.max_tokens;
 
     offset += snprintf(json + offset, size - offset,
-                       "{\"model\":\"%s\",\"max_tokens\":%d,",
-                       provider->config.model, max_tokens);
+                       "{\"model\":\"%s\",\"max_tokens\":%d,%s",
+                       provider->config.model, max_tokens,
+                       request->stream ? "\"stream\":true," : "");
 
     /* Add system prompt if present */
     if (request->system_prompt) {
@@ -1976,93 +2196,14 @@ static AIResponse* parse_anthropic_response(const char* response_body) {
     return response;
 }
 
-#ifdef CYXMAKE_USE_CURL
-
 static AIResponse* anthropic_complete(AIProvider* provider, const AIRequest* request) {
     if (!provider || !request) return NULL;
 
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        AIResponse* response = calloc(1, sizeof(AIResponse));
-        response->error = strdup("Failed to initialize CURL");
-        return response;
-    }
-
-    char* json = build_anthropic_request_json(provider, request);
-    if (!json) {
-        curl_easy_cleanup(curl);
-        AIResponse* response = calloc(1, sizeof(AIResponse));
-        response->error = strdup("Failed to build request");
-        return response;
-    }
-
-    /* Anthropic URL: {base_url}/messages */
-    char url[512];
-    snprintf(url, sizeof(url), "%s/messages", provider->config.base_url);
-
-    struct curl_slist* headers = NULL;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-
-    /* Anthropic uses x-api-key header */
-    if (provider->config.api_key) {
-        char auth[512];
-        snprintf(auth, sizeof(auth), "x-api-key: %s", provider->config.api_key);
-        headers = curl_slist_append(headers, auth);
-    }
-
-    /* Anthropic requires anthropic-version header */
-    headers = curl_slist_append(headers, "anthropic-version: 2023-06-01");
-
-    /* Add custom headers */
-    for (int i = 0; i < provider->config.header_count; i++) {
-        char header[512];
-        snprintf(header, sizeof(header), "%s: %s",
-                 provider->config.headers[i].name,
-                 provider->config.headers[i].value);
-        headers = curl_slist_append(headers, header);
-    }
-
-    struct CurlBuffer response_buf = {0};
-
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, cyxmake_curl_write_cb);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_buf);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, provider->config.timeout_sec);
-
-    CURLcode res = curl_easy_perform(curl);
-
-    AIResponse* response = NULL;
-    if (res == CURLE_OK) {
-        response = parse_anthropic_response(response_buf.data);
-    } else {
-        response = calloc(1, sizeof(AIResponse));
-        response->error = strdup(curl_easy_strerror(res));
-    }
-
-    free(json);
-    free(response_buf.data);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    return response;
-}
-
-#else
-
-static AIResponse* anthropic_complete(AIProvider* provider, const AIRequest* request) {
-    (void)provider;
-    (void)request;
-
-    AIResponse* response = calloc(1, sizeof(AIResponse));
-    response->success = false;
-    response->error = strdup("HTTP support not compiled (CURL not available)");
-    return response;
+    return provider_exchange(provider, request,
+                             build_anthropic_request_json(provider, request),
+                             parse_anthropic_response);
 }
 
-#endif
-
 static AIProviderVTable anthropic_vtable = {
     .init = anthropic_init,
     .shutdown = openai_shutdown,
@@ -2120,6 +2261,37 @@ static AIProviderVTable* get_llamacpp_vtable(void) {
     return &llamacpp_vtable;
 }
 
+/* ========================================================================
+ * Request Codecs
+ * ======================================================================== */
+
+/* Builds a provider's request body (caller frees) */
+typedef char* (*RequestBuilder)(AIProvider* provider, const AIRequest* request);
+
+/**
+ * Look up how a cloud provider encodes requests and decodes replies, for
+ * callers that drive the HTTP exchange themselves
+ */
+static bool provider_codec(AIProvider* provider, RequestBuilder* build,
+                           ResponseParser* parse) {
+    if (provider->vtable == get_openai_vtable()) {
+        *build = build_openai_request_json;
+        *parse = parse_openai_response;
+    } else if (provider->vtable == get_ollama_vtable()) {
+        *build = build_ollama_request_json;
+        *parse = parse_ollama_response;
+    } else if (provider->vtable == get_gemini_vtable()) {
+        *build = build_gemini_request_json;
+        *parse = parse_gemini_response;
+    } else if (provider->vtable == get_anthropic_vtable()) {
+        *build = build_anthropic_request_json;
+        *parse = parse_anthropic_response;
+    } else {
+        return false;
+    }
+    return provider->http_pool != NULL && provider_http(provider) != NULL;
+}
+
 /* ========================================================================
  * HTTP Support Detection
  * ======================================================================== */
@@ -2319,6 +2491,113 @@ AIProvider* ai_registry_get_fallback(AIProviderRegistry* registry) {
 /* Maximum providers to try during fallback */
 #define AI_MAX_FALLBACK_PROVIDERS 16
 
+/* Latency history needed before the hedge delay follows the percentile */
+#define HEDGE_MIN_SAMPLES 8
+
+AIHedgeConfig ai_hedge_config_default(void) {
+    AIHedgeConfig config = {
+        .enabled = false,
+        .percentile = 0.95,
+        .default_delay_ms = 2000,
+        .min_delay_ms = 50,
+        .max_hedges = 1
+    };
+    return config;
+}
+
+void ai_registry_set_hedging(AIProviderRegistry* registry, const AIHedgeConfig* config) {
+    if (!registry) return;
+    registry->hedge = config ? *config : ai_hedge_config_default();
+}
+
+/* How long the primary gets before the next provider is raced against it */
+static int hedge_delay_ms(AIProvider* primary, const AIHedgeConfig* hedge) {
+    int delay = hedge->default_delay_ms;
+
+    struct AIProviderHttp* http = primary->http;
+    if (http) {
+        mutex_lock(&http->latency_lock);
+        int samples = http->latency_count;
+        mutex_unlock(&http->latency_lock);
+        if (samples >= HEDGE_MIN_SAMPLES) {
+            delay = (int)ai_provider_latency_percentile(primary, hedge->percentile);
+        }
+    }
+    return delay < hedge->min_delay_ms ? hedge->min_delay_ms : delay;
+}
+
+/**
+ * Race the first providers once: each further provider starts after the
+ * hedge delay, or at once when every provider already started has failed.
+ * @return Successful response, NULL to fall back to sequential retries
+ */
+static AIResponse* complete_hedged(const AIHedgeConfig* hedge, AIProvider** providers,
+                                   int provider_count, const AIRequest* request) {
+    /* A cached answer from the primary beats any race */
+    char key[AI_CACHE_KEY_SIZE];
+    if (providers[0]->response_cache) {
+        ai_response_cache_request_key(providers[0], request, key);
+        AIResponse* cached = ai_response_cache_get(providers[0]->response_cache, key);
+        if (cached) return cached;
+    }
+
+    AIProvider* racers[AI_MAX_FALLBACK_PROVIDERS];
+    ResponseParser parsers[AI_MAX_FALLBACK_PROVIDERS];
+    HttpBatchRequest batch[AI_MAX_FALLBACK_PROVIDERS];
+    int count = 0;
+    int delay = 0;
+
+    for (int i = 0; i < provider_count && count <= hedge->max_hedges; i++) {
+        AIProvider* provider = providers[i];
+        RequestBuilder build;
+        if (!ai_provider_is_ready(provider) && !ai_provider_init(provider)) continue;
+        if (!provider_codec(provider, &build, &parsers[count])) continue;
+
+        char* body = build(provider, request);
+        if (!body) continue;
+
+        if (count == 1) delay = hedge_delay_ms(racers[0], hedge);
+        batch[count] = (HttpBatchRequest){
+            provider->http->url, provider->http->headers, body,
+            provider->config.timeout_sec, delay * count
+        };
+        racers[count++] = provider;
+    }
+
+    AIResponse* response = NULL;
+    if (count >= 2) {
+        log_debug("Hedging across %d providers after %d ms", count, delay);
+
+        HttpResponse* replies[AI_MAX_FALLBACK_PROVIDERS];
+        int winner = http_pool_post_batch(racers[0]->http_pool, batch, count, true, replies);
+        if (winner >= 0) {
+            response = parse_reply(replies[winner], parsers[winner]);
+            if (response && response->success) {
+                AIProvider* provider = racers[winner];
+                record_latency(provider, replies[winner]->total_ms);
+                if (winner > 0) {
+                    log_info("Hedged request answered first by '%s'", provider->config.name);
+                }
+                if (provider->response_cache) {
+                    ai_response_cache_request_key(provider, request, key);
+                    ai_response_cache_put(provider->response_cache, key, response);
+                }
+            } else {
+                ai_response_free(response);
+                response = NULL;
+            }
+        }
+        for (int i = 0; i < count; i++) http_response_free(replies[i]);
+
+        if (!response) {
+            log_warning("Hedged request failed on %d providers, retrying in turn", count);
+        }
+    }
+
+    for (int i = 0; i < count; i++) free((char*)batch[i].body);
+    return response;
+}
+
 AIResponse* ai_registry_complete_with_fallback(AIProviderRegistry* registry,
                                                 const AIRequest* request,
                                                 const char* primary_provider,
@@ -2402,6 +2681,13 @@ AIResponse* ai_registry_complete_with_fallback(AIProviderRegistry* registry,
         return response;
     }
 
+    /* Race the first providers when the caller waits for a whole reply */
+    if (registry->hedge.enabled && !request->stream && provider_count > 1) {
+        AIResponse* response = complete_hedged(&registry->hedge, providers,
+                                               provider_count, request);
+        if (response) return response;
+    }
+
     /* Try each provider in order */
     AIResponse* last_response = NULL;
     for (int i = 0; i < provider_count; i++) {
@@ -2474,27 +2760,11 @@ void ai_health_check_free(AIHealthCheckResult* result) {
     free(result);
 }
 
-AIHealthCheckResult* ai_provider_health_check(AIProvider* provider) {
-    AIHealthCheckResult* result = calloc(1, sizeof(AIHealthCheckResult));
-    if (!result) return NULL;
-
-    if (!provider) {
-        result->healthy = false;
-        result->status = PROVIDER_STATUS_UNKNOWN;
-        result->message = strdup("Provider is NULL");
-        return result;
-    }
-
-    /* Check if provider has custom health check */
-    if (provider->vtable && provider->vtable->health_check) {
-        AIHealthCheckResult* custom_result = provider->vtable->health_check(provider);
-        if (custom_result) {
-            free(result);
-            return custom_result;
-        }
-    }
-
-    /* Default health check: try a minimal completion request */
+/**
+ * Run the checks that need no request
+ * @return false if the result is already final
+ */
+static bool health_check_prepare(AIProvider* provider, AIHealthCheckResult* result) {
     result->status = ai_provider_status(provider);
 
     /* Check if provider is ready */
@@ -2504,7 +2774,7 @@ AIHealthCheckResult* ai_provider_health_check(AIProvider* provider) {
             result->healthy = false;
             result->message = strdup(provider->last_error ? provider->last_error :
                                      "Failed to initialize provider");
-            return result;
+            return false;
         }
         result->status = ai_provider_status(provider);
     }
@@ -2515,27 +2785,25 @@ AIHealthCheckResult* ai_provider_health_check(AIProvider* provider) {
         result->healthy = false;
         result->message = strdup("HTTP support not available (CURL not compiled)");
         result->status = PROVIDER_STATUS_ERROR;
-        return result;
+        return false;
     }
 
-    /* Send a minimal test request */
-    long start_time = get_time_ms();
+    return true;
+}
 
+/* The minimal request a health check sends */
+static AIRequest* health_check_request(void) {
     AIRequest* request = ai_request_create();
-    if (!request) {
-        result->healthy = false;
-        result->message = strdup("Failed to create test request");
-        return result;
-    }
+    if (!request) return NULL;
 
     ai_request_add_message(request, AI_ROLE_USER, "Reply with: OK");
     request->max_tokens = 10;  /* Minimal response */
+    return request;
+}
 
-    AIResponse* response = ai_provider_complete(provider, request);
-    ai_request_free(request);
-
-    long end_time = get_time_ms();
-    result->latency_ms = (int)(end_time - start_time);
+static void health_check_finish(AIHealthCheckResult* result, const AIResponse* response,
+                                int latency_ms) {
+    result->latency_ms = latency_ms;
 
     if (response && response->success) {
         result->healthy = true;
@@ -2550,53 +2818,162 @@ AIHealthCheckResult* ai_provider_health_check(AIProvider* provider) {
         result->message = strdup(response && response->error ?
                                  response->error : "Health check failed");
     }
+}
+
+AIHealthCheckResult* ai_provider_health_check(AIProvider* provider) {
+    AIHealthCheckResult* result = calloc(1, sizeof(AIHealthCheckResult));
+    if (!result) return NULL;
+
+    if (!provider) {
+        result->healthy = false;
+        result->status = PROVIDER_STATUS_UNKNOWN;
+        result->message = strdup("Provider is NULL");
+        return result;
+    }
+
+    /* Check if provider has custom health check */
+    if (provider->vtable && provider->vtable->health_check) {
+        AIHealthCheckResult* custom_result = provider->vtable->health_check(provider);
+        if (custom_result) {
+            free(result);
+            return custom_result;
+        }
+    }
 
+    /* Default health check: try a minimal completion request */
+    if (!health_check_prepare(provider, result)) {
+        return result;
+    }
+
+    /* Send a minimal test request */
+    long start_time = get_time_ms();
+
+    AIRequest* request = health_check_request();
+    if (!request) {
+        result->healthy = false;
+        result->message = strdup("Failed to create test request");
+        return result;
+    }
+
+    /* Bypass the response cache: the point is to reach the provider */
+    AIResponse* response = provider->vtable->complete(provider, request);
+    ai_request_free(request);
+
+    health_check_finish(result, response, (int)(get_time_ms() - start_time));
     ai_response_free(response);
     return result;
 }
 
+/* Health-check providers, sending the default checks concurrently */
+static void health_check_providers(AIProvider** providers, int count,
+                                   AIHealthCheckResult** results) {
+    HttpBatchRequest batch[AI_MAX_FALLBACK_PROVIDERS];
+    char* bodies[AI_MAX_FALLBACK_PROVIDERS];
+    ResponseParser parsers[AI_MAX_FALLBACK_PROVIDERS];
+    int batch_slot[AI_MAX_FALLBACK_PROVIDERS];
+    int batch_count = 0;
+    HttpPool* pool = NULL;
+    AIRequest* request = health_check_request();
+
+    for (int i = 0; i < count; i++) {
+        AIProvider* provider = providers[i];
+        RequestBuilder build;
+        ResponseParser parse;
+
+        /* Custom checks and local providers run on their own */
+        if (!request || (provider->vtable && provider->vtable->health_check) ||
+            !ai_provider_has_http_support() || !provider_codec(provider, &build, &parse)) {
+            results[i] = ai_provider_health_check(provider);
+            continue;
+        }
+
+        AIHealthCheckResult* result = calloc(1, sizeof(AIHealthCheckResult));
+        results[i] = result;
+        if (!result || !health_check_prepare(provider, result)) continue;
+
+        char* body = build(provider, request);
+        if (!body) {
+            result->healthy = false;
+            result->status = PROVIDER_STATUS_ERROR;
+            result->message = strdup("Failed to build request");
+            continue;
+        }
+        batch[batch_count] = (HttpBatchRequest){
+            provider->http->url, provider->http->headers, body,
+            provider->config.timeout_sec, 0
+        };
+        bodies[batch_count] = body;
+        parsers[batch_count] = parse;
+        batch_slot[batch_count++] = i;
+        pool = provider->http_pool;
+    }
+    ai_request_free(request);
+
+    if (batch_count == 0) return;
+
+    HttpResponse* replies[AI_MAX_FALLBACK_PROVIDERS];
+    http_pool_post_batch(pool, batch, batch_count, false, replies);
+
+    for (int i = 0; i < batch_count; i++) {
+        AIResponse* response = parse_reply(replies[i], parsers[i]);
+        health_check_finish(results[batch_slot[i]], response,
+                            replies[i] ? (int)replies[i]->total_ms : 0);
+        ai_response_free(response);
+        http_response_free(replies[i]);
+        free(bodies[i]);
+    }
+    log_debug("Checked %d providers concurrently", batch_count);
+}
+
+/* Collect registry providers in list order */
+static int registry_providers(AIProviderRegistry* registry, bool enabled_only,
+                              AIProvider** providers, const char** names, int max_count) {
+    const char* all_names[AI_MAX_FALLBACK_PROVIDERS];
+    int total = ai_registry_list(registry, all_names, AI_MAX_FALLBACK_PROVIDERS);
+
+    int count = 0;
+    for (int i = 0; i < total && count < max_count; i++) {
+        AIProvider* provider = ai_registry_get(registry, all_names[i]);
+        if (!provider || (enabled_only && !provider->config.enabled)) continue;
+        providers[count] = provider;
+        if (names) names[count] = all_names[i];
+        count++;
+    }
+    return count;
+}
+
 int ai_registry_health_check_all(AIProviderRegistry* registry,
                                   AIHealthCheckResult** results,
                                   const char** names,
                                   int max_count) {
     if (!registry || !results || !names || max_count <= 0) return 0;
 
-    const char* provider_names[AI_MAX_FALLBACK_PROVIDERS];
-    int total = ai_registry_list(registry, provider_names, AI_MAX_FALLBACK_PROVIDERS);
-
-    int count = 0;
-    for (int i = 0; i < total && count < max_count; i++) {
-        AIProvider* provider = ai_registry_get(registry, provider_names[i]);
-        if (provider) {
-            names[count] = provider_names[i];
-            results[count] = ai_provider_health_check(provider);
-            count++;
-        }
-    }
+    AIProvider* providers[AI_MAX_FALLBACK_PROVIDERS];
+    if (max_count > AI_MAX_FALLBACK_PROVIDERS) max_count = AI_MAX_FALLBACK_PROVIDERS;
+    int count = registry_providers(registry, false, providers, names, max_count);
 
+    health_check_providers(providers, count, results);
     return count;
 }
 
 AIProvider* ai_registry_find_healthy(AIProviderRegistry* registry) {
     if (!registry) return NULL;
 
-    const char* names[AI_MAX_FALLBACK_PROVIDERS];
-    int total = ai_registry_list(registry, names, AI_MAX_FALLBACK_PROVIDERS);
-
-    for (int i = 0; i < total; i++) {
-        AIProvider* provider = ai_registry_get(registry, names[i]);
-        if (provider && provider->config.enabled) {
-            AIHealthCheckResult* result = ai_provider_health_check(provider);
-            bool healthy = result && result->healthy;
-            ai_health_check_free(result);
+    AIProvider* providers[AI_MAX_FALLBACK_PROVIDERS];
+    AIHealthCheckResult* results[AI_MAX_FALLBACK_PROVIDERS];
+    int count = registry_providers(registry, true, providers, NULL,
+                                   AI_MAX_FALLBACK_PROVIDERS);
+    health_check_providers(providers, count, results);
 
-            if (healthy) {
-                return provider;
-            }
+    AIProvider* healthy = NULL;
+    for (int i = 0; i < count; i++) {
+        if (!healthy && results[i] && results[i]->healthy) {
+            healthy = providers[i];
         }
+        ai_health_check_free(results[i]);
     }
 
-    return NULL;
+    return healthy;
 }
 
 void ai_registry_print_health_report(AIProviderRegistry* registry) {
@@ -2605,24 +2982,27 @@ void ai_registry_print_health_report(AIProviderRegistry* registry) {
         return;
     }
 
+    AIProvider* providers[AI_MAX_FALLBACK_PROVIDERS];
+    AIHealthCheckResult* results[AI_MAX_FALLBACK_PROVIDERS];
     const char* names[AI_MAX_FALLBACK_PROVIDERS];
-    int total = ai_registry_list(registry, names, AI_MAX_FALLBACK_PROVIDERS);
+    int total = registry_providers(registry, false, providers, names,
+                                   AI_MAX_FALLBACK_PROVIDERS);
 
     if (total == 0) {
         log_info("No AI providers configured");
         return;
     }
 
+    health_check_providers(providers, total, results);
+
     log_info("=== AI Provider Health Report ===");
     log_info("Providers: %d", total);
     log_info("");
 
     int healthy_count = 0;
     for (int i = 0; i < total; i++) {
-        AIProvider* provider = ai_registry_get(registry, names[i]);
-        if (!provider) continue;
-
-        AIHealthCheckResult* result = ai_provider_health_check(provider);
+        AIProvider* provider = providers[i];
+        AIHealthCheckResult* result = results[i];
 
         const char* status_icon = result && result->healthy ? "[OK]" : "[FAIL]";
         const char* type_str = ai_provider_type_to_string(provider->config.type);
@@ -0,0 +1,411 @@
+/**
+ * @file ai_schema.c
+ * @brief Response schemas: GBNF and JSON Schema generation, reply parsing
+ *
+ * Grammar rules are named after the path to the value they match
+ * (root, root-actions, root-actions-item, ...), so each nested object or
+ * array gets exactly one rule. Primitive values share a fixed set of rules
+ * modelled on llama.cpp's json.gbnf; whitespace between tokens is bounded
+ * so the model cannot stall on it.
+ */
+
+#include "cyxmake/ai_schema.h"
+#include "cyxmake/logger.h"
+#include "cJSON.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <ctype.h>
+
+#ifdef _WIN32
+#define strdup _strdup
+#endif
+
+/* Candidate JSON starts tried in one reply */
+#define MAX_PARSE_ATTEMPTS 16
+
+static const char* GBNF_PRIMITIVES =
+    "ws ::= | \" \" | \"\\n\" [ \\t]{0,20}\n"
+    "string ::= \"\\\"\" ( [^\"\\\\\\x7F\\x00-\\x1F] | \"\\\\\" ( [\"\\\\/bfnrt] | \"u\" [0-9a-fA-F]{4} ) )* \"\\\"\"\n"
+    "number ::= \"-\"? ( [0-9] | [1-9] [0-9]{0,15} ) ( \".\" [0-9]+ )? ( [eE] [-+]? [0-9]+ )?\n"
+    "integer ::= \"-\"? ( [0-9] | [1-9] [0-9]{0,15} )\n"
+    "boolean ::= \"true\" | \"false\"\n"
+    "null ::= \"null\"\n";
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t cap;
+    bool failed;              /* An allocation failed; result is unusable */
+} TextBuffer;
+
+static void text_append(TextBuffer* buf, const char* text) {
+    size_t len = strlen(text);
+    if (buf->failed) return;
+
+    if (buf->len + len + 1 > buf->cap) {
+        size_t cap = buf->cap ? buf->cap : 256;
+        while (cap < buf->len + len + 1) cap *= 2;
+        char* grown = realloc(buf->data, cap);
+        if (!grown) {
+            buf->failed = true;
+            return;
+        }
+        buf->data = grown;
+        buf->cap = cap;
+    }
+    memcpy(buf->data + buf->len, text, len);
+    buf->len += len;
+    buf->data[buf->len] = '\0';
+}
+
+/* ========================================================================
+ * GBNF
+ * ======================================================================== */
+
+/* Literal matching a JSON string with this exact value: "\"value\"" */
+static void append_quoted_literal(TextBuffer* buf, const char* value) {
+    text_append(buf, "\"\\\"");
+    text_append(buf, value);
+    text_append(buf, "\\\"\"");
+}
+
+/* Rule names may only use letters, digits and dashes */
+static char* rule_name(const char* parent, const char* suffix) {
+    size_t len = strlen(parent) + strlen(suffix) + 2;
+    char* name = malloc(len);
+    if (!name) return NULL;
+
+    snprintf(name, len, "%s-%s", parent, suffix);
+    for (char* p = name; *p; p++) {
+        if (!isalnum((unsigned char)*p)) *p = '-';
+    }
+    return name;
+}
+
+/**
+ * Append the expression matching one value to expr, adding rules for
+ * nested objects and arrays to rules
+ */
+static void gbnf_value(const AISchema* schema, const char* name,
+                       TextBuffer* rules, TextBuffer* expr);
+
+static void gbnf_object(const AISchema* schema, const char* name, TextBuffer* rules) {
+    TextBuffer body = {0};
+
+    text_append(&body, name);
+    text_append(&body, " ::= \"{\" ws");
+    for (int i = 0; i < schema->property_count; i++) {
+        const AISchema* member = &schema->properties[i];
+        char* member_rule = rule_name(name, member->name);
+        if (!member_rule) {
+            rules->failed = true;
+            break;
+        }
+
+        if (i > 0) text_append(&body, " \",\" ws");
+        text_append(&body, " ");
+        append_quoted_literal(&body, member->name);
+        text_append(&body, " ws \":\" ws ");
+        gbnf_value(member, member_rule, rules, &body);
+        text_append(&body, " ws");
+        free(member_rule);
+    }
+    text_append(&body, " \"}\"\n");
+
+    if (body.failed) rules->failed = true;
+    else text_append(rules, body.data);
+    free(body.data);
+}
+
+static void gbnf_array(const AISchema* schema, const char* name, TextBuffer* rules) {
+    TextBuffer body = {0};
+    TextBuffer item = {0};
+    char* item_rule = rule_name(name, "item");
+
+    if (item_rule && schema->items) {
+        gbnf_value(schema->items, item_rule, rules, &item);
+    } else {
+        text_append(&item, "string");
+    }
+
+    text_append(&body, name);
+    text_append(&body, " ::= \"[\" ws ( ");
+    text_append(&body, item.data ? item.data : "string");
+    text_append(&body, " ws ( \",\" ws ");
+    text_append(&body, item.data ? item.data : "string");
+    text_append(&body, " ws )* )? \"]\"\n");
+
+    if (body.failed || item.failed || !item_rule) rules->failed = true;
+    else text_append(rules, body.data);
+    free(body.data);
+    free(item.data);
+    free(item_rule);
+}
+
+static void gbnf_value(const AISchema* schema, const char* name,
+                       TextBuffer* rules, TextBuffer* expr) {
+    if (schema->nullable) text_append(expr, "( ");
+
+    switch (schema->type) {
+        case AI_SCHEMA_STRING:
+            if (schema->enum_values && schema->enum_values[0]) {
+                text_append(expr, "( ");
+                for (int i = 0; schema->enum_values[i]; i++) {
+                    if (i > 0) text_append(expr, " | ");
+                    append_quoted_literal(expr, schema->enum_values[i]);
+                }
+                text_append(expr, " )");
+            } else {
+                text_append(expr, "string");
+            }
+            break;
+        case AI_SCHEMA_NUMBER:  text_append(expr, "number"); break;
+        case AI_SCHEMA_INTEGER: text_append(expr, "integer"); break;
+        case AI_SCHEMA_BOOLEAN: text_append(expr, "boolean"); break;
+        case AI_SCHEMA_OBJECT:
+            gbnf_object(schema, name, rules);
+            text_append(expr, name);
+            break;
+        case AI_SCHEMA_ARRAY:
+            gbnf_array(schema, name, rules);
+            text_append(expr, name);
+            break;
+    }
+
+    if (schema->nullable) text_append(expr, " | null )");
+}
+
+char* ai_schema_to_gbnf(const AISchema* schema) {
+    if (!schema) return NULL;
+
+    TextBuffer rules = {0};
+    TextBuffer root = {0};
+
+    if (schema->type == AI_SCHEMA_OBJECT || schema->type == AI_SCHEMA_ARRAY) {
+        /* The root rule is the value itself */
+        gbnf_value(schema, "root", &rules, &root);
+    } else {
+        text_append(&rules, "root ::= ");
+        gbnf_value(schema, "root", &rules, &rules);
+        text_append(&rules, "\n");
+    }
+    text_append(&rules, GBNF_PRIMITIVES);
+
+    free(root.data);
+    if (rules.failed || root.failed) {
+        free(rules.data);
+        return NULL;
+    }
+    return rules.data;
+}
+
+/* ========================================================================
+ * JSON Schema
+ * ======================================================================== */
+
+static const char* json_type_name(AISchemaType type) {
+    switch (type) {
+        case AI_SCHEMA_STRING:  return "string";
+        case AI_SCHEMA_NUMBER:  return "number";
+        case AI_SCHEMA_INTEGER: return "integer";
+        case AI_SCHEMA_BOOLEAN: return "boolean";
+        case AI_SCHEMA_OBJECT:  return "object";
+        case AI_SCHEMA_ARRAY:   return "array";
+    }
+    return "string";
+}
+
+static cJSON* json_schema_node(const AISchema* schema) {
+    cJSON* node = cJSON_CreateObject();
+    if (!node) return NULL;
+
+    if (schema->nullable) {
+        cJSON* types = cJSON_AddArrayToObject(node, "type");
+        cJSON_AddItemToArray(types, cJSON_CreateString(json_type_name(schema->type)));
+        cJSON_AddItemToArray(types, cJSON_CreateString("null"));
+    } else {
+        cJSON_AddStringToObject(node, "type", json_type_name(schema->type));
+    }
+
+    if (schema->type == AI_SCHEMA_STRING && schema->enum_values) {
+        cJSON* values = cJSON_AddArrayToObject(node, "enum");
+        for (int i = 0; schema->enum_values[i]; i++) {
+            cJSON_AddItemToArray(values, cJSON_CreateString(schema->enum_values[i]));
+        }
+        if (schema->nullable) cJSON_AddItemToArray(values, cJSON_CreateNull());
+    }
+
+    if (schema->type == AI_SCHEMA_OBJECT) {
+        cJSON* properties = cJSON_AddObjectToObject(node, "properties");
+        cJSON* required = cJSON_AddArrayToObject(node, "required");
+        for (int i = 0; i < schema->property_count; i++) {
+            const AISchema* member = &schema->properties[i];
+            cJSON_AddItemToObject(properties, member->name, json_schema_node(member));
+            if (member->required) {
+                cJSON_AddItemToArray(required, cJSON_CreateString(member->name));
+            }
+        }
+        cJSON_AddBoolToObject(node, "additionalProperties", false);
+    }
+
+    if (schema->type == AI_SCHEMA_ARRAY && schema->items) {
+        cJSON_AddItemToObject(node, "items", json_schema_node(schema->items));
+    }
+
+    return node;
+}
+
+char* ai_schema_to_json_schema(const AISchema* schema) {
+    if (!schema) return NULL;
+
+    cJSON* root = json_schema_node(schema);
+    if (!root) return NULL;
+
+    char* text = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    return text;
+}
+
+/* ========================================================================
+ * Parsing
+ * ======================================================================== */
+
+/* Turn a string holding a number or boolean into that value, in place */
+static void coerce_string(cJSON* value, AISchemaType type) {
+    if (!cJSON_IsString(value) || (value->type & cJSON_StringIsConst)) return;
+
+    const char* text = value->valuestring;
+    if (type == AI_SCHEMA_NUMBER || type == AI_SCHEMA_INTEGER) {
+        char* end = NULL;
+        double number = strtod(text, &end);
+        if (end == text || *end != '\0') return;
+
+        cJSON_free(value->valuestring);
+        value->valuestring = NULL;
+        value->type = cJSON_Number;
+        cJSON_SetNumberValue(value, number);
+    } else if (type == AI_SCHEMA_BOOLEAN) {
+        bool is_true = strcmp(text, "true") == 0;
+        if (!is_true && strcmp(text, "false") != 0) return;
+
+        cJSON_free(value->valuestring);
+        value->valuestring = NULL;
+        value->type = is_true ? cJSON_True : cJSON_False;
+    }
+}
+
+static bool check_value(const AISchema* schema, cJSON* value, const char* path,
+                        char* error, size_t error_size) {
+    if (cJSON_IsNull(value)) {
+        if (schema->nullable || !schema->required) return true;
+        snprintf(error, error_size, "%s must not be null", path);
+        return false;
+    }
+
+    coerce_string(value, schema->type);
+
+    bool ok = false;
+    switch (schema->type) {
+        case AI_SCHEMA_STRING:  ok = cJSON_IsString(value); break;
+        case AI_SCHEMA_NUMBER:
+        case AI_SCHEMA_INTEGER: ok = cJSON_IsNumber(value); break;
+        case AI_SCHEMA_BOOLEAN: ok = cJSON_IsBool(value); break;
+        case AI_SCHEMA_OBJECT:  ok = cJSON_IsObject(value); break;
+        case AI_SCHEMA_ARRAY:   ok = cJSON_IsArray(value); break;
+    }
+    if (!ok) {
+        snprintf(error, error_size, "%s should be %s", path, json_type_name(schema->type));
+        return false;
+    }
+
+    if (schema->type == AI_SCHEMA_OBJECT) {
+        for (int i = 0; i < schema->property_count; i++) {
+            const AISchema* member = &schema->properties[i];
+            cJSON* item = cJSON_GetObjectItemCaseSensitive(value, member->name);
+            char member_path[256];
+            snprintf(member_path, sizeof(member_path), "%s.%s", path, member->name);
+
+            if (!item) {
+                if (!member->required) continue;
+                snprintf(error, error_size, "%s is missing", member_path);
+                return false;
+            }
+            if (!check_value(member, item, member_path, error, error_size)) return false;
+        }
+    }
+
+    /* One malformed element should not cost the whole reply */
+    if (schema->type == AI_SCHEMA_ARRAY && schema->items) {
+        cJSON* item = value->child;
+        for (int index = 0; item; index++) {
+            cJSON* next = item->next;
+            char item_path[256];
+            snprintf(item_path, sizeof(item_path), "%s[%d]", path, index);
+
+            char item_error[256];
+            if (!check_value(schema->items, item, item_path, item_error, sizeof(item_error))) {
+                log_debug("Dropping %s: %s", item_path, item_error);
+                cJSON_Delete(cJSON_DetachItemViaPointer(value, item));
+            }
+            item = next;
+        }
+    }
+
+    return true;
+}
+
+cJSON* ai_schema_parse(const AISchema* schema, const char* text,
+                       char* error, size_t error_size) {
+    char scratch[256];
+    if (!error || error_size == 0) {
+        error = scratch;
+        error_size = sizeof(scratch);
+    }
+    error[0] = '\0';
+
+    if (!schema || !text) {
+        snprintf(error, error_size, "No reply to parse");
+        return NULL;
+    }
+
+    char open = schema->type == AI_SCHEMA_ARRAY ? '[' : '{';
+    const char* fence = strstr(text, "```json");
+    const char* candidate = fence ? fence + 7 : strchr(text, open);
+
+    for (int attempt = 0; candidate && attempt < MAX_PARSE_ATTEMPTS; attempt++) {
+        while (*candidate && isspace((unsigned char)*candidate)) candidate++;
+
+        cJSON* value = cJSON_ParseWithOpts(candidate, NULL, false);
+        if (value) {
+            if (check_value(schema, value, "$", error, error_size)) return value;
+            cJSON_Delete(value);
+        }
+
+        const char* from = *candidate == open ? candidate + 1 : candidate;
+        candidate = strchr(from, open);
+    }
+
+    if (!error[0]) snprintf(error, error_size, "No JSON found in reply");
+    return NULL;
+}
+
+/* ========================================================================
+ * Accessors
+ * ======================================================================== */
+
+char* ai_json_strdup(const cJSON* object, const char* key) {
+    const char* value = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(object, key));
+    return value && value[0] ? strdup(value) : NULL;
+}
+
+double ai_json_number(const cJSON* object, const char* key, double fallback) {
+    const cJSON* item = cJSON_GetObjectItemCaseSensitive(object, key);
+    return cJSON_IsNumber(item) ? item->valuedouble : fallback;
+}
+
+bool ai_json_bool(const cJSON* object, const char* key, bool fallback) {
+    const cJSON* item = cJSON_GetObjectItemCaseSensitive(object, key);
+    return cJSON_IsBool(item) ? cJSON_IsTrue(item) : fallback;
+}
@@ -0,0 +1,552 @@
+/**
+ * @file ai_stream.c
+ * @brief Incremental parser for streamed AI completions
+ *
+ * The body is split into lines as chunks arrive; a line is only copied
+ * when it straddles two chunks. Each complete event is a small JSON
+ * document, parsed on its own and dispatched by provider dialect.
+ */
+
+#include "cyxmake/ai_stream.h"
+#include "cJSON.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#define strdup _strdup
+#else
+#include <sys/time.h>
+#endif
+
+/* ========================================================================
+ * Buffers and State
+ * ======================================================================== */
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t cap;
+} TextBuffer;
+
+typedef enum {
+    DIALECT_OPENAI,       /* SSE, choices[].delta */
+    DIALECT_ANTHROPIC,    /* SSE, typed content block events */
+    DIALECT_GEMINI,       /* SSE, one GenerateContentResponse per event */
+    DIALECT_OLLAMA        /* NDJSON, one chat response per line */
+} StreamDialect;
+
+typedef struct {
+    char* id;
+    char* name;
+    TextBuffer arguments;
+    int block;            /* Anthropic content block index (-1 otherwise) */
+    bool complete;
+} StreamToolCall;
+
+struct AIStreamParser {
+    StreamDialect dialect;
+    AIStreamCallbacks callbacks;
+
+    TextBuffer line;      /* Line split across chunks */
+    TextBuffer event;     /* Data lines of the pending SSE event */
+    bool event_pending;
+    TextBuffer unframed;  /* Body text outside any event */
+    int events;
+
+    TextBuffer content;
+    StreamToolCall* tools;
+    int tool_count;
+    int tool_capacity;
+
+    int prompt_tokens;
+    int completion_tokens;
+    int total_tokens;
+    char* error;
+
+    double start_sec;
+    double first_token_sec;
+};
+
+static double now_sec(void) {
+#ifdef _WIN32
+    return (double)GetTickCount64() / 1000.0;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1e6;
+#endif
+}
+
+static bool text_append(TextBuffer* buf, const char* data, size_t len) {
+    if (buf->len + len + 1 > buf->cap) {
+        size_t cap = buf->cap ? buf->cap : 256;
+        while (cap < buf->len + len + 1) cap *= 2;
+        char* grown = realloc(buf->data, cap);
+        if (!grown) return false;
+        buf->data = grown;
+        buf->cap = cap;
+    }
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+    buf->data[buf->len] = '\0';
+    return true;
+}
+
+static void set_error(AIStreamParser* p, const char* message) {
+    if (p->error) return;
+    p->error = strdup(message ? message : "Stream error");
+}
+
+static void mark_first_fragment(AIStreamParser* p) {
+    if (p->first_token_sec == 0) {
+        p->first_token_sec = now_sec() - p->start_sec;
+        if (p->first_token_sec <= 0) p->first_token_sec = 1e-6;
+    }
+}
+
+/* ========================================================================
+ * Text and Tool Call Assembly
+ * ======================================================================== */
+
+static void emit_text(AIStreamParser* p, const char* text) {
+    size_t len = text ? strlen(text) : 0;
+    if (len == 0) return;
+
+    mark_first_fragment(p);
+    if (!text_append(&p->content, text, len)) {
+        set_error(p, "Out of memory");
+        return;
+    }
+    if (p->callbacks.on_token) {
+        p->callbacks.on_token(text, len, p->callbacks.user_data);
+    }
+}
+
+static int tool_open(AIStreamParser* p, int block) {
+    if (p->tool_count >= p->tool_capacity) {
+        int cap = p->tool_capacity ? p->tool_capacity * 2 : 4;
+        StreamToolCall* grown = realloc(p->tools, (size_t)cap * sizeof(StreamToolCall));
+        if (!grown) {
+            set_error(p, "Out of memory");
+            return -1;
+        }
+        p->tools = grown;
+        p->tool_capacity = cap;
+    }
+    StreamToolCall* call = &p->tools[p->tool_count];
+    memset(call, 0, sizeof(*call));
+    call->block = block;
+    return p->tool_count++;
+}
+
+/* Record a fragment of call idx; id and name are only taken once */
+static void tool_update(AIStreamParser* p, int idx, const char* id,
+                        const char* name, const char* arguments) {
+    if (idx < 0 || idx >= p->tool_count) return;
+    StreamToolCall* call = &p->tools[idx];
+    if (call->complete) return;
+
+    if (id && !call->id) call->id = strdup(id);
+    else id = NULL;
+    if (name && !call->name) call->name = strdup(name);
+    else name = NULL;
+    if (arguments && *arguments &&
+        !text_append(&call->arguments, arguments, strlen(arguments))) {
+        set_error(p, "Out of memory");
+        return;
+    }
+
+    if (!id && !name && !(arguments && *arguments)) return;
+    mark_first_fragment(p);
+    if (p->callbacks.on_tool_call_delta) {
+        p->callbacks.on_tool_call_delta(idx, id, name, arguments ? arguments : "",
+                                        p->callbacks.user_data);
+    }
+}
+
+static void tool_complete(AIStreamParser* p, int idx) {
+    if (idx < 0 || idx >= p->tool_count) return;
+    StreamToolCall* call = &p->tools[idx];
+    if (call->complete) return;
+    call->complete = true;
+
+    /* A call without arguments still needs a valid JSON object */
+    if (call->arguments.len == 0 && !text_append(&call->arguments, "{}", 2)) {
+        set_error(p, "Out of memory");
+        return;
+    }
+
+    if (p->callbacks.on_tool_call && call->name) {
+        AIToolCall view = {call->id, call->name, call->arguments.data};
+        p->callbacks.on_tool_call(idx, &view, p->callbacks.user_data);
+    }
+}
+
+static void tool_complete_before(AIStreamParser* p, int idx) {
+    for (int i = 0; i < idx && i < p->tool_count; i++) {
+        tool_complete(p, i);
+    }
+}
+
+static int tool_find_block(AIStreamParser* p, int block) {
+    for (int i = 0; i < p->tool_count; i++) {
+        if (p->tools[i].block == block) return i;
+    }
+    return -1;
+}
+
+/* Add a call that arrives whole (Gemini, Ollama): arguments is an object */
+static void tool_add_whole(AIStreamParser* p, const char* id, const char* name,
+                           const cJSON* arguments) {
+    int idx = tool_open(p, -1);
+    if (idx < 0) return;
+
+    char* args = arguments ? cJSON_PrintUnformatted(arguments) : NULL;
+    tool_update(p, idx, id, name, args);
+    free(args);
+    tool_complete(p, idx);
+}
+
+/* ========================================================================
+ * Event Dispatch
+ * ======================================================================== */
+
+static const char* json_string(const cJSON* object, const char* key) {
+    const cJSON* item = cJSON_GetObjectItemCaseSensitive(object, key);
+    return cJSON_IsString(item) ? item->valuestring : NULL;
+}
+
+static void json_int(const cJSON* object, const char* key, int* out) {
+    const cJSON* item = cJSON_GetObjectItemCaseSensitive(object, key);
+    if (cJSON_IsNumber(item)) *out = item->valueint;
+}
+
+/* choices[0].delta.{content,tool_calls[]}, finish_reason, usage */
+static void dispatch_openai(AIStreamParser* p, const cJSON* root) {
+    const cJSON* choice = cJSON_GetArrayItem(
+        cJSON_GetObjectItemCaseSensitive(root, "choices"), 0);
+    const cJSON* delta = cJSON_GetObjectItemCaseSensitive(choice, "delta");
+
+    emit_text(p, json_string(delta, "content"));
+
+    const cJSON* tc;
+    cJSON_ArrayForEach(tc, cJSON_GetObjectItemCaseSensitive(delta, "tool_calls")) {
+        const cJSON* index = cJSON_GetObjectItemCaseSensitive(tc, "index");
+        int idx = cJSON_IsNumber(index) ? index->valueint :
+                  (p->tool_count > 0 ? p->tool_count - 1 : 0);
+        if (idx < 0) continue;
+
+        /* Calls stream one after another: a new index closes the earlier ones */
+        tool_complete_before(p, idx);
+        while (p->tool_count <= idx) {
+            if (tool_open(p, -1) < 0) return;
+        }
+
+        const cJSON* function = cJSON_GetObjectItemCaseSensitive(tc, "function");
+        tool_update(p, idx, json_string(tc, "id"), json_string(function, "name"),
+                    json_string(function, "arguments"));
+    }
+
+    if (json_string(choice, "finish_reason")) {
+        tool_complete_before(p, p->tool_count);
+    }
+
+    const cJSON* usage = cJSON_GetObjectItemCaseSensitive(root, "usage");
+    if (cJSON_IsObject(usage)) {
+        json_int(usage, "prompt_tokens", &p->prompt_tokens);
+        json_int(usage, "completion_tokens", &p->completion_tokens);
+        json_int(usage, "total_tokens", &p->total_tokens);
+    }
+}
+
+/* message_start, content_block_{start,delta,stop}, message_delta */
+static void dispatch_anthropic(AIStreamParser* p, const cJSON* root) {
+    const char* type = json_string(root, "type");
+    if (!type) return;
+
+    const cJSON* index = cJSON_GetObjectItemCaseSensitive(root, "index");
+    int block = cJSON_IsNumber(index) ? index->valueint : -1;
+
+    if (strcmp(type, "message_start") == 0) {
+        const cJSON* message = cJSON_GetObjectItemCaseSensitive(root, "message");
+        const cJSON* usage = cJSON_GetObjectItemCaseSensitive(message, "usage");
+        json_int(usage, "input_tokens", &p->prompt_tokens);
+        json_int(usage, "output_tokens", &p->completion_tokens);
+    } else if (strcmp(type, "content_block_start") == 0) {
+        const cJSON* cb = cJSON_GetObjectItemCaseSensitive(root, "content_block");
+        const char* cb_type = json_string(cb, "type");
+        if (cb_type && strcmp(cb_type, "tool_use") == 0) {
+            int idx = tool_open(p, block);
+            tool_update(p, idx, json_string(cb, "id"), json_string(cb, "name"), NULL);
+        } else {
+            emit_text(p, json_string(cb, "text"));
+        }
+    } else if (strcmp(type, "content_block_delta") == 0) {
+        const cJSON* delta = cJSON_GetObjectItemCaseSensitive(root, "delta");
+        const char* delta_type = json_string(delta, "type");
+        if (delta_type && strcmp(delta_type, "input_json_delta") == 0) {
+            tool_update(p, tool_find_block(p, block), NULL, NULL,
+                        json_string(delta, "partial_json"));
+        } else {
+            emit_text(p, json_string(delta, "text"));
+        }
+    } else if (strcmp(type, "content_block_stop") == 0) {
+        tool_complete(p, tool_find_block(p, block));
+    } else if (strcmp(type, "message_delta") == 0) {
+        json_int(cJSON_GetObjectItemCaseSensitive(root, "usage"), "output_tokens",
+                 &p->completion_tokens);
+    }
+}
+
+/* candidates[0].content.parts[].{text,functionCall}, usageMetadata */
+static void dispatch_gemini(AIStreamParser* p, const cJSON* root) {
+    const cJSON* candidate = cJSON_GetArrayItem(
+        cJSON_GetObjectItemCaseSensitive(root, "candidates"), 0);
+    const cJSON* content = cJSON_GetObjectItemCaseSensitive(candidate, "content");
+
+    const cJSON* part;
+    cJSON_ArrayForEach(part, cJSON_GetObjectItemCaseSensitive(content, "parts")) {
+        emit_text(p, json_string(part, "text"));
+
+        const cJSON* call = cJSON_GetObjectItemCaseSensitive(part, "functionCall");
+        if (cJSON_IsObject(call)) {
+            tool_add_whole(p, json_string(call, "id"), json_string(call, "name"),
+                           cJSON_GetObjectItemCaseSensitive(call, "args"));
+        }
+    }
+
+    const cJSON* usage = cJSON_GetObjectItemCaseSensitive(root, "usageMetadata");
+    if (cJSON_IsObject(usage)) {
+        json_int(usage, "promptTokenCount", &p->prompt_tokens);
+        json_int(usage, "candidatesTokenCount", &p->completion_tokens);
+        json_int(usage, "totalTokenCount", &p->total_tokens);
+    }
+}
+
+/* message.{content,tool_calls[]}, done with eval counts */
+static void dispatch_ollama(AIStreamParser* p, const cJSON* root) {
+    const cJSON* message = cJSON_GetObjectItemCaseSensitive(root, "message");
+    emit_text(p, json_string(message, "content"));
+
+    const cJSON* tc;
+    cJSON_ArrayForEach(tc, cJSON_GetObjectItemCaseSensitive(message, "tool_calls")) {
+        const cJSON* function = cJSON_GetObjectItemCaseSensitive(tc, "function");
+        tool_add_whole(p, json_string(tc, "id"), json_string(function, "name"),
+                       cJSON_GetObjectItemCaseSensitive(function, "arguments"));
+    }
+
+    if (cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(root, "done"))) {
+        json_int(root, "prompt_eval_count", &p->prompt_tokens);
+        json_int(root, "eval_count", &p->completion_tokens);
+    }
+}
+
+/* Dispatch one event; false if the text is not a JSON document */
+static bool dispatch_event(AIStreamParser* p, const char* data, size_t len) {
+    if (len == 6 && memcmp(data, "[DONE]", 6) == 0) {
+        p->events++;
+        tool_complete_before(p, p->tool_count);
+        return true;
+    }
+
+    cJSON* root = cJSON_ParseWithLength(data, len);
+    if (!root) return false;
+    p->events++;
+
+    /* Every dialect reports failures as "error": "..." or {"message": ...} */
+    const cJSON* error = cJSON_GetObjectItemCaseSensitive(root, "error");
+    if (cJSON_IsString(error)) {
+        set_error(p, error->valuestring);
+    } else if (cJSON_IsObject(error)) {
+        set_error(p, json_string(error, "message"));
+    } else {
+        switch (p->dialect) {
+            case DIALECT_OPENAI:    dispatch_openai(p, root); break;
+            case DIALECT_ANTHROPIC: dispatch_anthropic(p, root); break;
+            case DIALECT_GEMINI:    dispatch_gemini(p, root); break;
+            case DIALECT_OLLAMA:    dispatch_ollama(p, root); break;
+        }
+    }
+
+    cJSON_Delete(root);
+    return true;
+}
+
+/* ========================================================================
+ * Framing
+ * ======================================================================== */
+
+static void keep_unframed(AIStreamParser* p, const char* line, size_t len) {
+    if (!text_append(&p->unframed, line, len) || !text_append(&p->unframed, "\n", 1)) {
+        set_error(p, "Out of memory");
+    }
+}
+
+static void flush_sse_event(AIStreamParser* p) {
+    if (!p->event_pending) return;
+    /* A data payload that is not JSON is still an event; it is ignored */
+    dispatch_event(p, p->event.data, p->event.len);
+    p->event.len = 0;
+    p->event_pending = false;
+}
+
+static void process_line(AIStreamParser* p, const char* line, size_t len) {
+    if (len > 0 && line[len - 1] == '\r') len--;
+
+    if (p->dialect == DIALECT_OLLAMA) {
+        size_t start = 0;
+        while (start < len && (line[start] == ' ' || line[start] == '\t')) start++;
+        if (start == len) return;
+        if (!dispatch_event(p, line + start, len - start)) keep_unframed(p, line, len);
+        return;
+    }
+
+    /* Server-sent events: a blank line ends an event */
+    if (len == 0) {
+        flush_sse_event(p);
+        return;
+    }
+
+    if (len >= 5 && memcmp(line, "data:", 5) == 0) {
+        size_t skip = (len > 5 && line[5] == ' ') ? 6 : 5;
+        if (p->event_pending) text_append(&p->event, "\n", 1);
+        if (!text_append(&p->event, line + skip, len - skip)) {
+            set_error(p, "Out of memory");
+            return;
+        }
+        p->event_pending = true;
+    } else if (line[0] == ':' ||
+               (len >= 6 && memcmp(line, "event:", 6) == 0) ||
+               (len >= 3 && memcmp(line, "id:", 3) == 0) ||
+               (len >= 6 && memcmp(line, "retry:", 6) == 0)) {
+        /* Comments and fields the dialects carry in the data as well */
+    } else {
+        keep_unframed(p, line, len);
+    }
+}
+
+/* ========================================================================
+ * Parser API
+ * ======================================================================== */
+
+AIStreamParser* ai_stream_parser_create(AIProviderType type,
+                                        const AIStreamCallbacks* callbacks) {
+    AIStreamParser* parser = calloc(1, sizeof(AIStreamParser));
+    if (!parser) return NULL;
+
+    switch (type) {
+        case AI_PROVIDER_ANTHROPIC: parser->dialect = DIALECT_ANTHROPIC; break;
+        case AI_PROVIDER_GEMINI:    parser->dialect = DIALECT_GEMINI; break;
+        case AI_PROVIDER_OLLAMA:    parser->dialect = DIALECT_OLLAMA; break;
+        default:                    parser->dialect = DIALECT_OPENAI; break;
+    }
+    if (callbacks) parser->callbacks = *callbacks;
+    parser->start_sec = now_sec();
+    return parser;
+}
+
+void ai_stream_parser_free(AIStreamParser* parser) {
+    if (!parser) return;
+
+    free(parser->line.data);
+    free(parser->event.data);
+    free(parser->unframed.data);
+    free(parser->content.data);
+    for (int i = 0; i < parser->tool_count; i++) {
+        free(parser->tools[i].id);
+        free(parser->tools[i].name);
+        free(parser->tools[i].arguments.data);
+    }
+    free(parser->tools);
+    free(parser->error);
+    free(parser);
+}
+
+bool ai_stream_parser_feed(AIStreamParser* parser, const char* data, size_t len) {
+    if (!parser) return false;
+
+    while (len > 0 && !parser->error) {
+        const char* nl = memchr(data, '\n', len);
+        if (!nl) {
+            if (!text_append(&parser->line, data, len)) set_error(parser, "Out of memory");
+            break;
+        }
+
+        size_t n = (size_t)(nl - data);
+        if (parser->line.len > 0) {
+            if (!text_append(&parser->line, data, n)) {
+                set_error(parser, "Out of memory");
+                break;
+            }
+            size_t line_len = parser->line.len;
+            parser->line.len = 0;
+            process_line(parser, parser->line.data, line_len);
+        } else {
+            process_line(parser, data, n);
+        }
+        data = nl + 1;
+        len -= n + 1;
+    }
+    return parser->error == NULL;
+}
+
+AIResponse* ai_stream_parser_finish(AIStreamParser* parser) {
+    if (!parser) return NULL;
+
+    /* The body may end without a final newline or blank line */
+    if (parser->line.len > 0) {
+        size_t n = parser->line.len;
+        parser->line.len = 0;
+        process_line(parser, parser->line.data, n);
+    }
+    if (parser->dialect != DIALECT_OLLAMA) flush_sse_event(parser);
+
+    if (parser->events == 0) return NULL;
+
+    AIResponse* response = calloc(1, sizeof(AIResponse));
+    if (!response) return NULL;
+
+    if (parser->error) {
+        response->success = false;
+        response->error = strdup(parser->error);
+    } else {
+        /* The stream ended, so no call can receive more arguments */
+        tool_complete_before(parser, parser->tool_count);
+        response->success = true;
+    }
+
+    if (parser->content.len > 0) {
+        response->content = parser->content.data;
+        parser->content = (TextBuffer){0};
+    }
+
+    if (parser->tool_count > 0) {
+        response->tool_calls = calloc((size_t)parser->tool_count, sizeof(AIToolCall));
+    }
+    for (int i = 0; response->tool_calls && i < parser->tool_count; i++) {
+        StreamToolCall* call = &parser->tools[i];
+        if (!call->complete || !call->name) continue;
+
+        AIToolCall* out = &response->tool_calls[response->tool_call_count++];
+        out->id = call->id;
+        out->name = call->name;
+        out->arguments = call->arguments.data;
+        call->id = NULL;
+        call->name = NULL;
+        call->arguments = (TextBuffer){0};
+    }
+
+    response->prompt_tokens = parser->prompt_tokens;
+    response->completion_tokens = parser->completion_tokens;
+    response->total_tokens = parser->total_tokens > 0 ? parser->total_tokens :
+        parser->prompt_tokens + parser->completion_tokens;
+    response->first_token_sec = parser->first_token_sec;
+    return response;
+}
+
+const char* ai_stream_parser_unframed(const AIStreamParser* parser) {
+    return parser && parser->unframed.data ? parser->unframed.data : "";
+}
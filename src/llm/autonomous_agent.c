@@ -10,6 +10,7 @@
 #include "cyxmake/ai_provider.h"
 #include "cyxmake/logger.h"
 #include "cyxmake/file_ops.h"
+#include "cyxmake/context_packer.h"
 #include "cJSON.h"
 #include <stdlib.h>
 #include <string.h>
@@ -679,7 +680,10 @@ AgentConfig agent_config_default(void) {
         .temperature = 0.7f,
         .verbose = true,
         .require_approval = false,
-        .working_dir = NULL
+        .working_dir = NULL,
+        .context_tokens = 0,
+        .on_token = NULL,
+        .stream_user_data = NULL
     };
     return config;
 }
@@ -794,60 +798,83 @@ static char* build_tools_json(AutonomousAgent* agent) {
     return result;
 }
 
-/* Build messages JSON for API */
-static char* build_messages_json(AutonomousAgent* agent) {
-    cJSON* messages = cJSON_CreateArray();
-
-    /* Add system message */
-    cJSON* sys_msg = cJSON_CreateObject();
-    cJSON_AddStringToObject(sys_msg, "role", "system");
-    cJSON_AddStringToObject(sys_msg, "content", AGENT_SYSTEM_PROMPT);
-    cJSON_AddItemToArray(messages, sys_msg);
+/**
+ * Add the system prompt and conversation to a request, within the
+ * context budget
+ *
+ * The system prompt, tool definitions and the latest user message are
+ * always sent. Older messages are kept newest first; those that do not fit
+ * are cut (tool output), shortened to their first line, or left out.
+ */
+static bool add_request_messages(AutonomousAgent* agent, AIRequest* request,
+                                 const char* tools_json) {
+    int budget = agent->config.context_tokens > 0 ? agent->config.context_tokens
+                                                  : ai_provider_context_tokens(agent->ai);
+    ContextPacker* packer = context_packer_create(budget, NULL, NULL);
+    if (!packer) return false;
+
+    ContextItem system = { .text = AGENT_SYSTEM_PROMPT, .required = true };
+    ContextItem tools = { .text = tools_json, .required = true };
+    context_packer_add(packer, &system);
+    context_packer_add(packer, &tools);
+
+    int task = -1;
+    for (int i = agent->message_count - 1; i >= 0 && task < 0; i--) {
+        if (agent->messages[i].role == CHAT_MSG_USER) task = i;
+    }
 
-    /* Add conversation messages */
+    /* Packer index of each message */
+    int indices[MAX_MESSAGES];
     for (int i = 0; i < agent->message_count; i++) {
-        cJSON* msg = cJSON_CreateObject();
+        indices[i] = -1;
+        const ChatMessage* msg = &agent->messages[i];
+        if (!msg->content) continue;
+
+        char* summary = context_summarize_first_line(NULL, msg->content);
+        ContextItem item = {
+            .text = msg->content,
+            .summary = summary,
+            .priority = i - agent->message_count,
+            .required = i == task,
+            .excerpt = msg->role == CHAT_MSG_TOOL
+        };
+        indices[i] = context_packer_add(packer, &item);
+        free(summary);
+    }
 
-        const char* role = "user";
-        switch (agent->messages[i].role) {
-            case CHAT_MSG_SYSTEM: role = "system"; break;
-            case CHAT_MSG_USER: role = "user"; break;
-            case CHAT_MSG_ASSISTANT: role = "assistant"; break;
-            case CHAT_MSG_TOOL: role = "tool"; break;
-        }
-        cJSON_AddStringToObject(msg, "role", role);
+    context_packer_pack(packer);
 
-        if (agent->messages[i].content) {
-            cJSON_AddStringToObject(msg, "content", agent->messages[i].content);
-        }
+    ai_request_add_message(request, AI_ROLE_SYSTEM, AGENT_SYSTEM_PROMPT);
 
-        if (agent->messages[i].tool_call_id) {
-            cJSON_AddStringToObject(msg, "tool_call_id", agent->messages[i].tool_call_id);
+    int dropped = 0;
+    for (int i = 0; i < agent->message_count; i++) {
+        if (!agent->messages[i].content) continue;
+
+        /* A message the packer could not take is sent whole */
+        const char* text = indices[i] >= 0 ? context_packer_text(packer, indices[i])
+                                           : agent->messages[i].content;
+        if (!text) {
+            dropped++;
+            continue;
         }
 
-        if (agent->messages[i].tool_calls && agent->messages[i].tool_call_count > 0) {
-            cJSON* tool_calls = cJSON_CreateArray();
-            for (int j = 0; j < agent->messages[i].tool_call_count; j++) {
-                cJSON* tc = cJSON_CreateObject();
-                cJSON_AddStringToObject(tc, "id", agent->messages[i].tool_calls[j].id);
-                cJSON_AddStringToObject(tc, "type", "function");
-
-                cJSON* func = cJSON_CreateObject();
-                cJSON_AddStringToObject(func, "name", agent->messages[i].tool_calls[j].name);
-                cJSON_AddStringToObject(func, "arguments", agent->messages[i].tool_calls[j].arguments);
-                cJSON_AddItemToObject(tc, "function", func);
-
-                cJSON_AddItemToArray(tool_calls, tc);
-            }
-            cJSON_AddItemToObject(msg, "tool_calls", tool_calls);
+        AIMessageRole role = AI_ROLE_USER;
+        switch (agent->messages[i].role) {
+            case CHAT_MSG_SYSTEM: role = AI_ROLE_SYSTEM; break;
+            case CHAT_MSG_ASSISTANT: role = AI_ROLE_ASSISTANT; break;
+            case CHAT_MSG_USER:
+            case CHAT_MSG_TOOL: role = AI_ROLE_USER; break;
         }
+        ai_request_add_message(request, role, text);
+    }
 
-        cJSON_AddItemToArray(messages, msg);
+    if (dropped > 0 && agent->config.verbose) {
+        log_debug("Context budget of %d tokens: left out %d older message%s",
+                  budget, dropped, dropped == 1 ? "" : "s");
     }
 
-    char* result = cJSON_PrintUnformatted(messages);
-    cJSON_Delete(messages);
-    return result;
+    context_packer_free(packer);
+    return true;
 }
 
 /* Execute a tool and return result */
@@ -863,6 +890,89 @@ static ToolResult* execute_tool(AutonomousAgent* agent, const char* name, const
     return tool_result_create(false, NULL, "Unknown tool");
 }
 
+/* Execute a tool call requested by the AI, logging it in verbose mode */
+static ToolResult* run_tool_call(AutonomousAgent* agent, const char* name, const char* args) {
+    if (agent->config.verbose) {
+        log_info("Tool call: %s(%s)", name, args);
+    }
+
+    ToolResult* result = execute_tool(agent, name, args);
+
+    if (agent->config.verbose) {
+        if (result->success) {
+            log_success("Tool succeeded");
+        } else {
+            log_warning("Tool failed: %s", result->error ? result->error : "unknown");
+        }
+    }
+    return result;
+}
+
+/* Tool calls executed while their reply was still streaming */
+typedef struct {
+    char* id;
+    char* name;
+    char* arguments;
+    ToolResult* result;
+} EarlyToolCall;
+
+typedef struct {
+    AutonomousAgent* agent;
+    EarlyToolCall* calls;
+    int count;
+    int capacity;
+} AgentStream;
+
+static void stream_on_token(const char* text, size_t len, void* user_data) {
+    AgentStream* stream = (AgentStream*)user_data;
+    stream->agent->config.on_token(text, len, stream->agent->config.stream_user_data);
+}
+
+static void stream_on_tool_call(int index, const AIToolCall* call, void* user_data) {
+    (void)index;
+    AgentStream* stream = (AgentStream*)user_data;
+
+    if (stream->count >= stream->capacity) {
+        int cap = stream->capacity ? stream->capacity * 2 : 4;
+        EarlyToolCall* grown = realloc(stream->calls, (size_t)cap * sizeof(EarlyToolCall));
+        if (!grown) return;  /* Runs later from the final response */
+        stream->calls = grown;
+        stream->capacity = cap;
+    }
+
+    EarlyToolCall* early = &stream->calls[stream->count++];
+    early->id = strdup_safe(call->id);
+    early->name = strdup_safe(call->name);
+    early->arguments = strdup_safe(call->arguments);
+    early->result = run_tool_call(stream->agent, call->name, call->arguments);
+}
+
+/* Take the result of a call already executed during streaming */
+static ToolResult* take_early_result(AgentStream* stream, const AIToolCall* call) {
+    for (int i = 0; i < stream->count; i++) {
+        EarlyToolCall* early = &stream->calls[i];
+        if (early->result && early->name && call->name &&
+            strcmp(early->name, call->name) == 0 &&
+            strcmp(early->arguments ? early->arguments : "",
+                   call->arguments ? call->arguments : "") == 0) {
+            ToolResult* result = early->result;
+            early->result = NULL;
+            return result;
+        }
+    }
+    return NULL;
+}
+
+static void agent_stream_reset(AgentStream* stream) {
+    for (int i = 0; i < stream->count; i++) {
+        free(stream->calls[i].id);
+        free(stream->calls[i].name);
+        free(stream->calls[i].arguments);
+        if (stream->calls[i].result) tool_result_free(stream->calls[i].result);
+    }
+    stream->count = 0;
+}
+
 /* Add message to conversation */
 static void add_message(AutonomousAgent* agent, ChatMessageRole role,
                         const char* content, const char* tool_call_id) {
@@ -883,6 +993,82 @@ static void add_message(AutonomousAgent* agent, ChatMessageRole role,
     msg->tool_call_count = 0;
 }
 
+/* Add an assistant message carrying count tool calls (filled in by the caller) */
+static ChatMessage* add_tool_call_message(AutonomousAgent* agent, const char* content,
+                                          int count) {
+    if (agent->message_count >= MAX_MESSAGES) {
+        /* Shift messages to make room */
+        free(agent->messages[0].content);
+        free(agent->messages[0].tool_call_id);
+        if (agent->messages[0].tool_calls) {
+            for (int j = 0; j < agent->messages[0].tool_call_count; j++) {
+                free(agent->messages[0].tool_calls[j].id);
+                free(agent->messages[0].tool_calls[j].name);
+                free(agent->messages[0].tool_calls[j].arguments);
+            }
+            free(agent->messages[0].tool_calls);
+        }
+        memmove(&agent->messages[0], &agent->messages[1],
+                sizeof(ChatMessage) * (MAX_MESSAGES - 1));
+        agent->message_count = MAX_MESSAGES - 1;
+    }
+
+    ChatMessage* msg = &agent->messages[agent->message_count++];
+    memset(msg, 0, sizeof(ChatMessage));
+    msg->role = CHAT_MSG_ASSISTANT;
+    msg->content = strdup_safe(content);
+    msg->tool_call_id = NULL;
+    msg->tool_calls = calloc(count, sizeof(AgentToolCall));
+    msg->tool_call_count = msg->tool_calls ? count : 0;
+    return msg;
+}
+
+/* Add a tool result message */
+static void add_tool_result(AutonomousAgent* agent, const ToolResult* result,
+                            const char* tool_call_id) {
+    const char* content = result->success ? result->output : result->error;
+    add_message(agent, CHAT_MSG_TOOL, content ? content : "No output", tool_call_id);
+}
+
+/* A reply that failed mid-stream may already have run tools; keep those
+ * calls and results in the history so their side effects are not lost */
+static void record_early_results(AutonomousAgent* agent, AgentStream* stream) {
+    int count = 0;
+    for (int i = 0; i < stream->count; i++) {
+        if (stream->calls[i].result) count++;
+    }
+    if (count == 0) return;
+
+    /* Tool calls are not sent back to the provider, so name them in the text */
+    char content[512];
+    size_t len = (size_t)snprintf(content, sizeof(content),
+                                  "(Reply interrupted after running tools:");
+    for (int i = 0; i < stream->count && len < sizeof(content); i++) {
+        if (!stream->calls[i].result) continue;
+        len += (size_t)snprintf(content + len, sizeof(content) - len, " %s",
+                                stream->calls[i].name ? stream->calls[i].name : "?");
+    }
+    if (len < sizeof(content)) snprintf(content + len, sizeof(content) - len, ")");
+
+    ChatMessage* msg = add_tool_call_message(agent, content, count);
+    int n = 0;
+    for (int i = 0; i < stream->count && n < msg->tool_call_count; i++) {
+        EarlyToolCall* early = &stream->calls[i];
+        if (!early->result) continue;
+
+        char fallback_id[32];
+        snprintf(fallback_id, sizeof(fallback_id), "early_%d", i);
+        const char* id = early->id ? early->id : fallback_id;
+
+        msg->tool_calls[n].id = strdup_safe(id);
+        msg->tool_calls[n].name = strdup_safe(early->name);
+        msg->tool_calls[n].arguments = strdup_safe(early->arguments);
+        n++;
+
+        add_tool_result(agent, early->result, id);
+    }
+}
+
 /* Main agent loop */
 char* agent_run(AutonomousAgent* agent, const char* task) {
     if (!agent || !task) return NULL;
@@ -901,18 +1087,24 @@ char* agent_run(AutonomousAgent* agent, const char* task) {
 
     char* final_response = NULL;
 
+    AgentStream stream = {agent, NULL, 0, 0};
+    AIStreamCallbacks callbacks = {
+        .on_token = stream_on_token,
+        .on_tool_call_delta = NULL,
+        .on_tool_call = stream_on_tool_call,
+        .user_data = &stream
+    };
+
     for (int iter = 0; iter < agent->config.max_iterations; iter++) {
+        agent_stream_reset(&stream);
+
         if (agent->config.verbose) {
             log_debug("Iteration %d/%d", iter + 1, agent->config.max_iterations);
         }
 
         /* Build request */
-        char* messages_json = build_messages_json(agent);
         char* tools_json = build_tools_json(agent);
-
-        if (!messages_json || !tools_json) {
-            free(messages_json);
-            free(tools_json);
+        if (!tools_json) {
             set_error(agent, "Failed to build request");
             break;
         }
@@ -920,49 +1112,41 @@ char* agent_run(AutonomousAgent* agent, const char* task) {
         /* Create AI request with tools */
         AIRequest* request = ai_request_create();
         if (!request) {
-            free(messages_json);
             free(tools_json);
             set_error(agent, "Failed to create request");
             break;
         }
 
-        /* Parse messages and add to request */
-        cJSON* msgs = cJSON_Parse(messages_json);
-        if (msgs) {
-            cJSON* msg;
-            cJSON_ArrayForEach(msg, msgs) {
-                cJSON* role = cJSON_GetObjectItem(msg, "role");
-                cJSON* content = cJSON_GetObjectItem(msg, "content");
-
-                if (role && cJSON_IsString(role) && content && cJSON_IsString(content)) {
-                    AIMessageRole ai_role = AI_ROLE_USER;
-                    if (strcmp(role->valuestring, "system") == 0) ai_role = AI_ROLE_SYSTEM;
-                    else if (strcmp(role->valuestring, "assistant") == 0) ai_role = AI_ROLE_ASSISTANT;
-
-                    ai_request_add_message(request, ai_role, content->valuestring);
-                }
-            }
-            cJSON_Delete(msgs);
+        if (!add_request_messages(agent, request, tools_json)) {
+            ai_request_free(request);
+            free(tools_json);
+            set_error(agent, "Failed to build request");
+            break;
         }
 
         request->max_tokens = agent->config.max_tokens;
         request->temperature = agent->config.temperature;
         /* Duplicate tools_json since ai_request_free will free it */
         request->tools_json = strdup(tools_json);
+        if (agent->config.on_token) {
+            request->stream = true;
+            request->stream_callbacks = &callbacks;
+        }
 
         /* Call AI */
         AIResponse* response = ai_provider_complete(agent->ai, request);
 
-        free(messages_json);
         ai_request_free(request);  /* This frees request->tools_json (the copy) */
 
         if (!response) {
+            record_early_results(agent, &stream);
             free(tools_json);
             set_error(agent, "AI request failed");
             break;
         }
 
         if (!response->success) {
+            record_early_results(agent, &stream);
             set_error(agent, response->error ? response->error : "Unknown AI error");
             ai_response_free(response);
             free(tools_json);
@@ -971,62 +1155,27 @@ char* agent_run(AutonomousAgent* agent, const char* task) {
 
         /* Check for tool calls */
         if (response->tool_calls && response->tool_call_count > 0) {
-            /* Bounds check before adding assistant message */
-            if (agent->message_count >= MAX_MESSAGES) {
-                /* Shift messages to make room */
-                free(agent->messages[0].content);
-                free(agent->messages[0].tool_call_id);
-                if (agent->messages[0].tool_calls) {
-                    for (int j = 0; j < agent->messages[0].tool_call_count; j++) {
-                        free(agent->messages[0].tool_calls[j].id);
-                        free(agent->messages[0].tool_calls[j].name);
-                        free(agent->messages[0].tool_calls[j].arguments);
-                    }
-                    free(agent->messages[0].tool_calls);
-                }
-                memmove(&agent->messages[0], &agent->messages[1],
-                        sizeof(ChatMessage) * (MAX_MESSAGES - 1));
-                agent->message_count = MAX_MESSAGES - 1;
-            }
-
             /* Add assistant message with tool calls */
-            ChatMessage* asst_msg = &agent->messages[agent->message_count++];
-            memset(asst_msg, 0, sizeof(ChatMessage));
-            asst_msg->role = CHAT_MSG_ASSISTANT;
-            asst_msg->content = strdup_safe(response->content);
-            asst_msg->tool_call_id = NULL;
-            asst_msg->tool_calls = calloc(response->tool_call_count, sizeof(AgentToolCall));
-            asst_msg->tool_call_count = response->tool_call_count;
+            ChatMessage* asst_msg = add_tool_call_message(agent, response->content,
+                                                          response->tool_call_count);
 
             /* Execute each tool call */
             for (int i = 0; i < response->tool_call_count; i++) {
                 AIToolCall* tc = &response->tool_calls[i];
 
                 /* Copy tool call info */
-                asst_msg->tool_calls[i].id = strdup_safe(tc->id);
-                asst_msg->tool_calls[i].name = strdup_safe(tc->name);
-                asst_msg->tool_calls[i].arguments = strdup_safe(tc->arguments);
-
-                if (agent->config.verbose) {
-                    log_info("Tool call: %s(%s)", tc->name, tc->arguments);
+                if (asst_msg->tool_calls) {
+                    asst_msg->tool_calls[i].id = strdup_safe(tc->id);
+                    asst_msg->tool_calls[i].name = strdup_safe(tc->name);
+                    asst_msg->tool_calls[i].arguments = strdup_safe(tc->arguments);
                 }
 
-                /* Execute tool */
-                ToolResult* result = execute_tool(agent, tc->name, tc->arguments);
+                /* Execute tool, unless it already ran while streaming */
+                ToolResult* result = take_early_result(&stream, tc);
+                if (!result) result = run_tool_call(agent, tc->name, tc->arguments);
 
                 /* Add tool result message */
-                char* result_content = result->success ? result->output : result->error;
-                if (!result_content) result_content = "No output";
-
-                add_message(agent, CHAT_MSG_TOOL, result_content, tc->id);
-
-                if (agent->config.verbose) {
-                    if (result->success) {
-                        log_success("Tool succeeded");
-                    } else {
-                        log_warning("Tool failed: %s", result->error ? result->error : "unknown");
-                    }
-                }
+                add_tool_result(agent, result, tc->id);
 
                 tool_result_free(result);
             }
@@ -1056,6 +1205,9 @@ char* agent_run(AutonomousAgent* agent, const char* task) {
         free(tools_json);
     }
 
+    agent_stream_reset(&stream);
+    free(stream.calls);
+
     if (!final_response && !agent->last_error) {
         set_error(agent, "Max iterations reached without completing task");
     }
@@ -0,0 +1,285 @@
+/**
+ * @file context_packer.c
+ * @brief Fit prompt context into a token budget
+ *
+ * Items are visited by priority. Each is charged its full token count plus
+ * CONTEXT_ITEM_OVERHEAD; when that does not fit, an excerpt is cut to the
+ * tokens left, or the summary is used, or the item is dropped. Excerpts
+ * keep the head and tail of the text, where file headers and the final
+ * compiler errors are, and are recounted after cutting since the
+ * characters-per-token ratio varies along the text.
+ */
+
+#include "cyxmake/context_packer.h"
+#include "cyxmake/llm_interface.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#define strdup _strdup
+#endif
+
+/* Smallest excerpt worth sending */
+#define MIN_EXCERPT_TOKENS 32
+
+/* Attempts at shrinking an excerpt that came out over budget */
+#define MAX_EXCERPT_ATTEMPTS 4
+
+/* Longest first line kept by context_summarize_first_line */
+#define SUMMARY_MAX_CHARS 80
+
+typedef struct {
+    char* text;
+    char* summary;
+    char* excerpt_text;       /* Cut by the last pack */
+    int priority;
+    bool required;
+    bool excerpt;
+    int tokens;               /* Full text, counted once */
+    ContextPackedForm form;
+} PackerItem;
+
+struct ContextPacker {
+    int budget;
+    ContextTokenCounter counter;
+    void* user_data;
+
+    PackerItem* items;
+    int count;
+    int capacity;
+    int dropped;
+};
+
+static int count_tokens(const ContextPacker* packer, const char* text) {
+    return packer->counter ? packer->counter(text, packer->user_data)
+                           : llm_estimate_tokens(text);
+}
+
+ContextPacker* context_packer_create(int token_budget, ContextTokenCounter counter,
+                                     void* user_data) {
+    ContextPacker* packer = calloc(1, sizeof(ContextPacker));
+    if (!packer) return NULL;
+
+    packer->budget = token_budget;
+    packer->counter = counter;
+    packer->user_data = user_data;
+    return packer;
+}
+
+void context_packer_free(ContextPacker* packer) {
+    if (!packer) return;
+
+    for (int i = 0; i < packer->count; i++) {
+        free(packer->items[i].text);
+        free(packer->items[i].summary);
+        free(packer->items[i].excerpt_text);
+    }
+    free(packer->items);
+    free(packer);
+}
+
+int context_packer_add(ContextPacker* packer, const ContextItem* item) {
+    if (!packer || !item || !item->text) return -1;
+
+    if (packer->count >= packer->capacity) {
+        int cap = packer->capacity ? packer->capacity * 2 : 16;
+        PackerItem* grown = realloc(packer->items, (size_t)cap * sizeof(PackerItem));
+        if (!grown) return -1;
+        packer->items = grown;
+        packer->capacity = cap;
+    }
+
+    PackerItem* entry = &packer->items[packer->count];
+    memset(entry, 0, sizeof(PackerItem));
+    entry->text = strdup(item->text);
+    entry->summary = item->summary ? strdup(item->summary) : NULL;
+    if (!entry->text || (item->summary && !entry->summary)) {
+        free(entry->text);
+        free(entry->summary);
+        return -1;
+    }
+    entry->priority = item->priority;
+    entry->required = item->required;
+    entry->excerpt = item->excerpt;
+    entry->tokens = count_tokens(packer, entry->text);
+    entry->form = CONTEXT_PACKED_FULL;
+
+    return packer->count++;
+}
+
+/**
+ * Cut text to its head and tail, fitting in budget tokens
+ *
+ * Cuts fall on line boundaries when one is close, and the number of
+ * omitted lines is noted in between.
+ */
+static char* make_excerpt(const ContextPacker* packer, const char* text,
+                          int full_tokens, int budget) {
+    size_t len = strlen(text);
+    if (full_tokens <= 0 || len == 0) return NULL;
+
+    size_t keep = (size_t)((double)len * budget / full_tokens);
+    for (int attempt = 0; attempt < MAX_EXCERPT_ATTEMPTS && keep > 0 && keep < len; attempt++) {
+        size_t head_end = keep / 2;
+        size_t tail_start = len - (keep - head_end);
+
+        /* Prefer whole lines when a break is within the last quarter */
+        for (size_t i = head_end; i > head_end - head_end / 4 && i > 0; i--) {
+            if (text[i - 1] == '\n') {
+                head_end = i;
+                break;
+            }
+        }
+        for (size_t i = tail_start; i < tail_start + (len - tail_start) / 4; i++) {
+            if (text[i] == '\n') {
+                tail_start = i + 1;
+                break;
+            }
+        }
+
+        int omitted = 0;
+        for (size_t i = head_end; i < tail_start; i++) {
+            if (text[i] == '\n') omitted++;
+        }
+
+        char marker[64];
+        if (omitted > 0) {
+            snprintf(marker, sizeof(marker), "\n[... %d lines omitted ...]\n", omitted);
+        } else {
+            snprintf(marker, sizeof(marker), "\n[... %zu characters omitted ...]\n",
+                     tail_start - head_end);
+        }
+
+        size_t size = head_end + strlen(marker) + (len - tail_start) + 1;
+        char* excerpt = malloc(size);
+        if (!excerpt) return NULL;
+
+        memcpy(excerpt, text, head_end);
+        snprintf(excerpt + head_end, size - head_end, "%s%s", marker, text + tail_start);
+
+        if (count_tokens(packer, excerpt) <= budget) return excerpt;
+
+        free(excerpt);
+        keep = keep * 3 / 4;
+    }
+    return NULL;
+}
+
+/* Visit order: priority descending, later items first on ties */
+static bool visits_before(const PackerItem* items, int a, int b) {
+    if (items[a].priority != items[b].priority) return items[a].priority > items[b].priority;
+    return a > b;
+}
+
+int context_packer_pack(ContextPacker* packer) {
+    if (!packer) return 0;
+
+    int used = 0;
+    packer->dropped = 0;
+    for (int i = 0; i < packer->count; i++) {
+        PackerItem* item = &packer->items[i];
+        free(item->excerpt_text);
+        item->excerpt_text = NULL;
+        item->form = CONTEXT_PACKED_FULL;
+
+        if (packer->budget <= 0 || item->required) {
+            used += item->tokens + CONTEXT_ITEM_OVERHEAD;
+        }
+    }
+    if (packer->budget <= 0 || packer->count == 0) return used;
+
+    int* order = malloc((size_t)packer->count * sizeof(int));
+    if (!order) return used;
+    for (int i = 0; i < packer->count; i++) order[i] = i;
+
+    /* Insertion sort; a prompt has tens of items, not thousands */
+    for (int i = 1; i < packer->count; i++) {
+        int index = order[i];
+        int j = i;
+        while (j > 0 && visits_before(packer->items, index, order[j - 1])) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = index;
+    }
+
+    for (int n = 0; n < packer->count; n++) {
+        PackerItem* item = &packer->items[order[n]];
+        if (item->required) continue;
+
+        int remaining = packer->budget - used - CONTEXT_ITEM_OVERHEAD;
+        if (item->tokens <= remaining) {
+            used += item->tokens + CONTEXT_ITEM_OVERHEAD;
+            continue;
+        }
+
+        if (item->excerpt && remaining >= MIN_EXCERPT_TOKENS) {
+            item->excerpt_text = make_excerpt(packer, item->text, item->tokens, remaining);
+            if (item->excerpt_text) {
+                item->form = CONTEXT_PACKED_EXCERPT;
+                used += count_tokens(packer, item->excerpt_text) + CONTEXT_ITEM_OVERHEAD;
+                continue;
+            }
+        }
+
+        if (item->summary) {
+            int summary_tokens = count_tokens(packer, item->summary);
+            if (summary_tokens <= remaining) {
+                item->form = CONTEXT_PACKED_SUMMARY;
+                used += summary_tokens + CONTEXT_ITEM_OVERHEAD;
+                continue;
+            }
+        }
+
+        item->form = CONTEXT_PACKED_DROPPED;
+        packer->dropped++;
+    }
+
+    free(order);
+    return used;
+}
+
+const char* context_packer_text(const ContextPacker* packer, int index) {
+    if (!packer || index < 0 || index >= packer->count) return NULL;
+
+    const PackerItem* item = &packer->items[index];
+    switch (item->form) {
+        case CONTEXT_PACKED_FULL:    return item->text;
+        case CONTEXT_PACKED_EXCERPT: return item->excerpt_text;
+        case CONTEXT_PACKED_SUMMARY: return item->summary;
+        case CONTEXT_PACKED_DROPPED: return NULL;
+    }
+    return NULL;
+}
+
+ContextPackedForm context_packer_form(const ContextPacker* packer, int index) {
+    if (!packer || index < 0 || index >= packer->count) return CONTEXT_PACKED_DROPPED;
+    return packer->items[index].form;
+}
+
+int context_packer_dropped(const ContextPacker* packer) {
+    return packer ? packer->dropped : 0;
+}
+
+char* context_summarize_first_line(const char* role, const char* text) {
+    if (!text) return NULL;
+
+    size_t len = strcspn(text, "\n");
+    bool clipped = text[len] != '\0';
+    if (len > SUMMARY_MAX_CHARS) {
+        len = SUMMARY_MAX_CHARS;
+        clipped = true;
+    }
+
+    size_t size = (role ? strlen(role) : 0) + len + 16;
+    char* summary = malloc(size);
+    if (!summary) return NULL;
+    if (role) {
+        snprintf(summary, size, "[%s]: %.*s%s", role, (int)len, text, clipped ? "..." : "");
+    } else {
+        snprintf(summary, size, "%.*s%s", (int)len, text, clipped ? "..." : "");
+    }
+    return summary;
+}
@@ -0,0 +1,584 @@
+/**
+ * @file http_pool.c
+ * @brief Pooled HTTP client implementation
+ *
+ * Idle easy handles sit on a stack. All handles are attached to one share
+ * object holding the DNS cache, TLS session IDs and (libcurl 7.57+) the
+ * connection cache, so a handle created to serve a second concurrent
+ * request still finds the warm connection and session of the first.
+ */
+
+#include "cyxmake/http_pool.h"
+#include "cyxmake/threading.h"
+#include "cyxmake/logger.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#ifdef CYXMAKE_USE_CURL
+#include <curl/curl.h>
+#endif
+
+#define DEFAULT_MAX_IDLE 8
+
+/* Shared pool used by every provider */
+static HttpPool* shared_pool = NULL;
+static int shared_refs = 0;
+
+#ifdef CYXMAKE_USE_CURL
+
+/* ========================================================================
+ * Pool Structures
+ * ======================================================================== */
+
+struct HttpHeaders {
+    struct curl_slist* list;
+};
+
+struct HttpPool {
+    CURLSH* share;
+    MutexHandle share_locks[CURL_LOCK_DATA_LAST];
+    MutexHandle mutex;            /* Guards idle and stats */
+    CURL** idle;
+    int idle_count;
+    int max_idle;
+    HttpPoolStats stats;
+};
+
+typedef struct {
+    char* data;
+    size_t size;
+} ResponseBuffer;
+
+static size_t write_cb(char* contents, size_t size, size_t nmemb, void* userp) {
+    size_t realsize = size * nmemb;
+    ResponseBuffer* buf = (ResponseBuffer*)userp;
+
+    char* ptr = realloc(buf->data, buf->size + realsize + 1);
+    if (!ptr) return 0;
+
+    buf->data = ptr;
+    memcpy(buf->data + buf->size, contents, realsize);
+    buf->size += realsize;
+    buf->data[buf->size] = '\0';
+    return realsize;
+}
+
+/* Streamed transfer: chunks go to the caller as they arrive */
+typedef struct {
+    HttpChunkCallback on_chunk;
+    void* user_data;
+} StreamSink;
+
+static size_t stream_write_cb(char* contents, size_t size, size_t nmemb, void* userp) {
+    size_t realsize = size * nmemb;
+    StreamSink* sink = (StreamSink*)userp;
+
+    /* Returning short aborts the transfer with CURLE_WRITE_ERROR */
+    if (!sink->on_chunk(contents, realsize, sink->user_data)) return 0;
+    return realsize;
+}
+
+static void share_lock(CURL* handle, curl_lock_data data, curl_lock_access access,
+                       void* userp) {
+    (void)handle;
+    (void)access;
+    HttpPool* pool = (HttpPool*)userp;
+    mutex_lock(&pool->share_locks[data]);
+}
+
+static void share_unlock(CURL* handle, curl_lock_data data, void* userp) {
+    (void)handle;
+    HttpPool* pool = (HttpPool*)userp;
+    mutex_unlock(&pool->share_locks[data]);
+}
+
+/* Options every pooled handle carries; reapplied after each reset */
+static void apply_base_options(HttpPool* pool, CURL* curl) {
+    curl_easy_setopt(curl, CURLOPT_SHARE, pool->share);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+}
+
+static CURL* acquire_handle(HttpPool* pool) {
+    CURL* curl = NULL;
+
+    mutex_lock(&pool->mutex);
+    if (pool->idle_count > 0) {
+        curl = pool->idle[--pool->idle_count];
+    } else {
+        pool->stats.handles_created++;
+    }
+    mutex_unlock(&pool->mutex);
+
+    if (!curl) {
+        curl = curl_easy_init();
+        if (curl) apply_base_options(pool, curl);
+    }
+    return curl;
+}
+
+static void release_handle(HttpPool* pool, CURL* curl) {
+    /* Reset drops per-request pointers; connections and caches survive */
+    curl_easy_reset(curl);
+    apply_base_options(pool, curl);
+
+    mutex_lock(&pool->mutex);
+    if (pool->idle_count < pool->max_idle) {
+        pool->idle[pool->idle_count++] = curl;
+        curl = NULL;
+    }
+    mutex_unlock(&pool->mutex);
+
+    if (curl) curl_easy_cleanup(curl);
+}
+
+/* ========================================================================
+ * Pool API
+ * ======================================================================== */
+
+HttpPool* http_pool_create(int max_idle) {
+    HttpPool* pool = calloc(1, sizeof(HttpPool));
+    if (!pool) return NULL;
+
+    pool->max_idle = max_idle > 0 ? max_idle : DEFAULT_MAX_IDLE;
+    pool->idle = calloc((size_t)pool->max_idle, sizeof(CURL*));
+    if (!pool->idle || !mutex_init(&pool->mutex)) {
+        free(pool->idle);
+        free(pool);
+        return NULL;
+    }
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        mutex_init(&pool->share_locks[i]);
+    }
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    pool->share = curl_share_init();
+    if (pool->share) {
+        curl_share_setopt(pool->share, CURLSHOPT_LOCKFUNC, share_lock);
+        curl_share_setopt(pool->share, CURLSHOPT_UNLOCKFUNC, share_unlock);
+        curl_share_setopt(pool->share, CURLSHOPT_USERDATA, pool);
+        curl_share_setopt(pool->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(pool->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+        curl_share_setopt(pool->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+    } else {
+        log_warning("HTTP pool: share init failed, handles keep private caches");
+    }
+
+    log_debug("HTTP pool created (max idle handles: %d)", pool->max_idle);
+    return pool;
+}
+
+void http_pool_free(HttpPool* pool) {
+    if (!pool) return;
+
+    /* Handles go before the share they are attached to */
+    for (int i = 0; i < pool->idle_count; i++) {
+        curl_easy_cleanup(pool->idle[i]);
+    }
+    free(pool->idle);
+
+    if (pool->share) curl_share_cleanup(pool->share);
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) {
+        mutex_destroy(&pool->share_locks[i]);
+    }
+    mutex_destroy(&pool->mutex);
+
+    curl_global_cleanup();
+    free(pool);
+}
+
+/* Point a handle at a POST; the body goes to the given write callback */
+static void setup_post(CURL* curl, const char* url, const HttpHeaders* headers,
+                       const char* body, int timeout_sec, curl_write_callback write_fn,
+                       void* write_data) {
+    curl_easy_setopt(curl, CURLOPT_URL, url);
+    if (headers) curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers->list);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body ? body : "");
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_fn);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, write_data);
+    if (timeout_sec > 0) curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)timeout_sec);
+}
+
+/* Record the outcome of a finished transfer and return the handle */
+static void finish_post(HttpPool* pool, CURL* curl, CURLcode res, HttpResponse* response) {
+    long connects = 0;
+    double total_sec = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->status);
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &total_sec);
+    response->total_ms = total_sec * 1000.0;
+    response->new_connection = connects > 0;
+
+    if (res != CURLE_OK) {
+        response->error = strdup(curl_easy_strerror(res));
+    }
+
+    release_handle(pool, curl);
+
+    mutex_lock(&pool->mutex);
+    pool->stats.requests++;
+    if (response->new_connection) pool->stats.connections_opened++;
+    mutex_unlock(&pool->mutex);
+}
+
+/* Perform one POST; the body goes to the given write callback */
+static HttpResponse* perform_post(HttpPool* pool, const char* url,
+                                  const HttpHeaders* headers, const char* body,
+                                  int timeout_sec, curl_write_callback write_fn,
+                                  void* write_data) {
+    HttpResponse* response = calloc(1, sizeof(HttpResponse));
+    if (!response) return NULL;
+
+    if (!pool || !url) {
+        response->error = strdup("Invalid HTTP request");
+        return response;
+    }
+
+    CURL* curl = acquire_handle(pool);
+    if (!curl) {
+        response->error = strdup("Failed to initialize CURL");
+        return response;
+    }
+
+    setup_post(curl, url, headers, body, timeout_sec, write_fn, write_data);
+    finish_post(pool, curl, curl_easy_perform(curl), response);
+    return response;
+}
+
+HttpResponse* http_pool_post(HttpPool* pool, const char* url,
+                             const HttpHeaders* headers,
+                             const char* body, int timeout_sec) {
+    ResponseBuffer buf = {0};
+    HttpResponse* response = perform_post(pool, url, headers, body, timeout_sec,
+                                          write_cb, &buf);
+    if (!response) {
+        free(buf.data);
+        return NULL;
+    }
+
+    if (!response->error) {
+        response->body = buf.data ? buf.data : strdup("");
+        response->body_size = buf.size;
+    } else {
+        free(buf.data);
+    }
+    return response;
+}
+
+HttpResponse* http_pool_post_stream(HttpPool* pool, const char* url,
+                                    const HttpHeaders* headers,
+                                    const char* body, int timeout_sec,
+                                    HttpChunkCallback on_chunk, void* user_data) {
+    if (!on_chunk) return http_pool_post(pool, url, headers, body, timeout_sec);
+
+    StreamSink sink = {on_chunk, user_data};
+    return perform_post(pool, url, headers, body, timeout_sec, stream_write_cb, &sink);
+}
+
+/* ========================================================================
+ * Concurrent Batches
+ * ======================================================================== */
+
+typedef struct {
+    CURL* curl;
+    ResponseBuffer buf;
+    HttpResponse* response;
+    bool launched;
+    bool done;
+} BatchSlot;
+
+static double monotonic_ms(void) {
+#ifdef _WIN32
+    return (double)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#endif
+}
+
+static bool batch_launch(HttpPool* pool, CURLM* multi, const HttpBatchRequest* request,
+                         BatchSlot* slot) {
+    slot->launched = true;
+    slot->response = calloc(1, sizeof(HttpResponse));
+    if (!slot->response) {
+        slot->done = true;
+        return false;
+    }
+
+    slot->curl = request->url ? acquire_handle(pool) : NULL;
+    if (!slot->curl) {
+        slot->response->error = strdup(request->url ? "Failed to initialize CURL"
+                                                    : "Invalid HTTP request");
+        slot->done = true;
+        return false;
+    }
+
+    setup_post(slot->curl, request->url, request->headers, request->body,
+               request->timeout_sec, write_cb, &slot->buf);
+    curl_easy_setopt(slot->curl, CURLOPT_PRIVATE, slot);
+    if (curl_multi_add_handle(multi, slot->curl) != CURLM_OK) {
+        finish_post(pool, slot->curl, CURLE_FAILED_INIT, slot->response);
+        slot->curl = NULL;
+        slot->done = true;
+        return false;
+    }
+    return true;
+}
+
+int http_pool_post_batch(HttpPool* pool, const HttpBatchRequest* requests, int count,
+                         bool first_success, HttpResponse** responses) {
+    if (!responses || count <= 0) return -1;
+    for (int i = 0; i < count; i++) responses[i] = NULL;
+    if (!pool || !requests) return -1;
+
+    BatchSlot* slots = calloc((size_t)count, sizeof(BatchSlot));
+    CURLM* multi = slots ? curl_multi_init() : NULL;
+    if (!multi) {
+        free(slots);
+        return -1;
+    }
+
+    int winner = -1;
+    int in_flight = 0;
+    int next = 0;                 /* Lowest request not launched yet */
+    double start = monotonic_ms();
+
+    for (;;) {
+        /* Launch requests whose delay is up, or the next one when all failed */
+        double elapsed = monotonic_ms() - start;
+        for (int i = next; i < count; i++) {
+            if (slots[i].launched) continue;
+            bool due = requests[i].start_delay_ms <= elapsed;
+            bool all_failed = in_flight == 0 && i == next;
+            if (!due && !all_failed) continue;
+            if (batch_launch(pool, multi, &requests[i], &slots[i])) in_flight++;
+        }
+        while (next < count && slots[next].launched) next++;
+        if (in_flight == 0) {
+            if (next >= count) break;
+            continue;
+        }
+
+        int running = 0;
+        curl_multi_perform(multi, &running);
+
+        CURLMsg* msg;
+        int queued;
+        while ((msg = curl_multi_info_read(multi, &queued)) != NULL) {
+            if (msg->msg != CURLMSG_DONE) continue;
+
+            BatchSlot* slot = NULL;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**)&slot);
+            CURLcode res = msg->data.result;
+            curl_multi_remove_handle(multi, slot->curl);
+            finish_post(pool, slot->curl, res, slot->response);
+            slot->curl = NULL;
+            slot->done = true;
+            in_flight--;
+
+            if (!slot->response->error) {
+                slot->response->body = slot->buf.data ? slot->buf.data : strdup("");
+                slot->response->body_size = slot->buf.size;
+                slot->buf.data = NULL;
+                long status = slot->response->status;
+                if (winner < 0 && status >= 200 && status < 300) {
+                    winner = (int)(slot - slots);
+                }
+            }
+        }
+        if (winner >= 0 && first_success) break;
+        if (in_flight == 0) {
+            if (next >= count) break;
+            continue;
+        }
+
+        /* Sleep until traffic or the next launch is due */
+        int wait_ms = 1000;
+        elapsed = monotonic_ms() - start;
+        for (int i = next; i < count; i++) {
+            double until = requests[i].start_delay_ms - elapsed;
+            if (!slots[i].launched && until < wait_ms) wait_ms = until > 0 ? (int)until + 1 : 0;
+        }
+#if LIBCURL_VERSION_NUM >= 0x074200
+        curl_multi_poll(multi, NULL, 0, wait_ms, NULL);
+#else
+        curl_multi_wait(multi, NULL, 0, wait_ms, NULL);
+#endif
+    }
+
+    /* Cancel whatever is still running */
+    for (int i = 0; i < count; i++) {
+        BatchSlot* slot = &slots[i];
+        if (slot->curl) {
+            curl_multi_remove_handle(multi, slot->curl);
+            finish_post(pool, slot->curl, CURLE_OK, slot->response);
+            free(slot->response->error);
+            slot->response->error = strdup("Cancelled");
+        }
+        free(slot->buf.data);
+        responses[i] = slot->response;
+    }
+
+    curl_multi_cleanup(multi);
+    free(slots);
+    return winner;
+}
+
+HttpPoolStats http_pool_get_stats(HttpPool* pool) {
+    HttpPoolStats stats = {0};
+    if (!pool) return stats;
+
+    mutex_lock(&pool->mutex);
+    stats = pool->stats;
+    stats.idle_handles = pool->idle_count;
+    mutex_unlock(&pool->mutex);
+    return stats;
+}
+
+/* ========================================================================
+ * Headers
+ * ======================================================================== */
+
+HttpHeaders* http_headers_create(void) {
+    return calloc(1, sizeof(HttpHeaders));
+}
+
+bool http_headers_add(HttpHeaders* headers, const char* name, const char* value) {
+    if (!headers || !name || !value) return false;
+
+    size_t len = strlen(name) + strlen(value) + 3;
+    char* line = malloc(len);
+    if (!line) return false;
+    snprintf(line, len, "%s: %s", name, value);
+
+    struct curl_slist* list = curl_slist_append(headers->list, line);
+    free(line);
+    if (!list) return false;
+
+    headers->list = list;
+    return true;
+}
+
+void http_headers_free(HttpHeaders* headers) {
+    if (!headers) return;
+    curl_slist_free_all(headers->list);
+    free(headers);
+}
+
+#else /* No CURL */
+
+struct HttpHeaders {
+    int count;
+};
+
+struct HttpPool {
+    HttpPoolStats stats;
+};
+
+HttpPool* http_pool_create(int max_idle) {
+    (void)max_idle;
+    return calloc(1, sizeof(HttpPool));
+}
+
+void http_pool_free(HttpPool* pool) {
+    free(pool);
+}
+
+HttpResponse* http_pool_post(HttpPool* pool, const char* url,
+                             const HttpHeaders* headers,
+                             const char* body, int timeout_sec) {
+    (void)url;
+    (void)headers;
+    (void)body;
+    (void)timeout_sec;
+
+    HttpResponse* response = calloc(1, sizeof(HttpResponse));
+    if (!response) return NULL;
+    response->error = strdup("HTTP support not compiled (CURL not available)");
+    if (pool) pool->stats.requests++;
+    return response;
+}
+
+HttpResponse* http_pool_post_stream(HttpPool* pool, const char* url,
+                                    const HttpHeaders* headers,
+                                    const char* body, int timeout_sec,
+                                    HttpChunkCallback on_chunk, void* user_data) {
+    (void)on_chunk;
+    (void)user_data;
+    return http_pool_post(pool, url, headers, body, timeout_sec);
+}
+
+int http_pool_post_batch(HttpPool* pool, const HttpBatchRequest* requests, int count,
+                         bool first_success, HttpResponse** responses) {
+    (void)first_success;
+    if (!responses) return -1;
+    for (int i = 0; i < count; i++) {
+        responses[i] = requests ? http_pool_post(pool, requests[i].url, requests[i].headers,
+                                                 requests[i].body, requests[i].timeout_sec)
+                                : NULL;
+    }
+    return -1;
+}
+
+HttpPoolStats http_pool_get_stats(HttpPool* pool) {
+    HttpPoolStats stats = {0};
+    if (pool) stats = pool->stats;
+    return stats;
+}
+
+HttpHeaders* http_headers_create(void) {
+    return calloc(1, sizeof(HttpHeaders));
+}
+
+bool http_headers_add(HttpHeaders* headers, const char* name, const char* value) {
+    if (!headers || !name || !value) return false;
+    headers->count++;
+    return true;
+}
+
+void http_headers_free(HttpHeaders* headers) {
+    free(headers);
+}
+
+#endif /* CYXMAKE_USE_CURL */
+
+/* ========================================================================
+ * Shared Pool and Responses
+ * ======================================================================== */
+
+HttpPool* http_pool_acquire_shared(void) {
+    if (!shared_pool) {
+        shared_pool = http_pool_create(0);
+        if (!shared_pool) return NULL;
+    }
+    shared_refs++;
+    return shared_pool;
+}
+
+void http_pool_release_shared(void) {
+    if (shared_refs <= 0) return;
+    if (--shared_refs == 0) {
+        http_pool_free(shared_pool);
+        shared_pool = NULL;
+    }
+}
+
+void http_response_free(HttpResponse* response) {
+    if (!response) return;
+    free(response->body);
+    free(response->error);
+    free(response);
+}
@@ -4,7 +4,9 @@
  */
 
 #include "cyxmake/llm_interface.h"
+#include "cyxmake/ai_cache.h"
 #include "cyxmake/logger.h"
+#include "cyxmake/threading.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -21,6 +23,7 @@
 #else
     #include <unistd.h>
     #include <sys/stat.h>
+    #include <sys/time.h>
     #define PATH_SEPARATOR "/"
 #endif
 
@@ -30,6 +33,12 @@
 /* Maximum error message length */
 #define MAX_ERROR_LEN 512
 
+/* Sequence holding the session in the KV cache */
+#define SESSION_SEQ 0
+
+/* Multi-sequence server used when n_parallel > 1 */
+typedef struct LLMServer LLMServer;
+
 /**
  * LLM context structure
  */
@@ -39,9 +48,22 @@ struct LLMContext {
     struct llama_sampler* sampler;    /* Sampler for token generation */
     LLMConfig config;                 /* Configuration */
     char last_error[MAX_ERROR_LEN];   /* Last error message */
-    bool is_ready;                    /* Ready for inference */
     int actual_gpu_layers;            /* Actual GPU layers in use */
     LLMGpuBackend active_backend;     /* Active GPU backend */
+    AIResponseCache* response_cache;  /* Optional, not owned */
+    llama_token* session_tokens;      /* Tokens held in the KV cache, in order */
+    int n_session;                    /* Number of session tokens */
+    int session_capacity;             /* Allocated session tokens (n_ctx) */
+    MutexHandle query_mutex;          /* Serializes single-stream queries */
+    LLMServer* server;                /* Concurrent queries, if n_parallel > 1 */
+
+    /* Loading (see llm_init_deferred) */
+    MutexHandle load_mutex;
+    ConditionHandle load_cond;        /* Signalled when loading finishes */
+    LLMLoadState load_state;
+    ThreadHandle loader;              /* Background loader, if started */
+    bool loader_started;
+    bool backend_initialized;
 };
 
 /* ========================================================================
@@ -62,6 +84,22 @@ static void set_error(LLMContext* llm_ctx, const char* format, ...) {
     log_error("%s", llm_ctx->last_error);
 }
 
+/**
+ * Wall-clock time in seconds
+ */
+static double now_sec(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart / (double)freq.QuadPart;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1e6;
+#endif
+}
+
 /**
  * Get user home directory
  */
@@ -112,7 +150,11 @@ LLMConfig* llm_config_default(void) {
     config->model_path = NULL;      /* Must be set by caller */
     config->n_ctx = 8192;           /* 8K context */
     config->n_threads = 0;          /* Auto-detect */
+    config->n_threads_batch = 0;    /* Auto-detect */
+    config->n_batch = 512;          /* Prompt chunk size */
+    config->n_ubatch = 512;
     config->n_gpu_layers = -1;      /* Auto-detect: use all GPU layers */
+    config->n_parallel = 1;         /* One query at a time */
     config->use_mmap = true;        /* Memory mapping */
     config->use_mlock = false;      /* Don't lock in RAM */
     config->verbose = false;        /* Quiet by default */
@@ -133,35 +175,79 @@ void llm_config_free(LLMConfig* config) {
  * Lifecycle
  * ======================================================================== */
 
-LLMContext* llm_init(const LLMConfig* config) {
-    if (!config || !config->model_path) {
-        log_error("LLM config or model path is NULL");
-        return NULL;
+static bool server_start(LLMContext* llm_ctx, int n_parallel);
+static void server_stop(LLMContext* llm_ctx);
+
+/**
+ * Free whatever part of the model a load created
+ */
+static void unload_model(LLMContext* llm_ctx) {
+    server_stop(llm_ctx);
+
+    if (llm_ctx->sampler) {
+        llama_sampler_free(llm_ctx->sampler);
+        llm_ctx->sampler = NULL;
     }
 
-    /* Allocate context */
-    LLMContext* llm_ctx = calloc(1, sizeof(LLMContext));
-    if (!llm_ctx) {
-        log_error("Failed to allocate LLM context");
-        return NULL;
+    if (llm_ctx->ctx) {
+        llama_free(llm_ctx->ctx);
+        llm_ctx->ctx = NULL;
     }
 
-    /* Copy config */
-    memcpy(&llm_ctx->config, config, sizeof(LLMConfig));
-    llm_ctx->config.model_path = strdup(config->model_path);
+    if (llm_ctx->model) {
+        llama_free_model(llm_ctx->model);
+        llm_ctx->model = NULL;
+    }
+
+    free(llm_ctx->session_tokens);
+    llm_ctx->session_tokens = NULL;
+}
+
+/**
+ * Context parameters shared by the session context and the server
+ */
+static struct llama_context_params context_params(const LLMConfig* config) {
+    struct llama_context_params ctx_params = llama_context_default_params();
+    ctx_params.n_ctx = config->n_ctx;
+
+    /* Hyper-threads do not speed up either phase, so default to one
+     * thread per physical core */
+    int cores = thread_get_physical_core_count();
+    ctx_params.n_threads = config->n_threads > 0 ? config->n_threads : cores;
+    ctx_params.n_threads_batch = config->n_threads_batch > 0 ? config->n_threads_batch : cores;
+
+    if (config->n_batch > 0) {
+        ctx_params.n_batch = (uint32_t)config->n_batch;
+    }
+    if (config->n_ubatch > 0) {
+        ctx_params.n_ubatch = (uint32_t)config->n_ubatch;
+    }
+    if (ctx_params.n_ubatch > ctx_params.n_batch) {
+        ctx_params.n_ubatch = ctx_params.n_batch;
+    }
+
+    return ctx_params;
+}
+
+/**
+ * Load the model and create the inference context
+ */
+static bool load_model(LLMContext* llm_ctx) {
+    const LLMConfig* config = &llm_ctx->config;
 
     /* Expand path if needed */
     char* model_path = expand_path(config->model_path);
     if (!model_path) {
         set_error(llm_ctx, "Failed to expand model path");
-        free(llm_ctx);
-        return NULL;
+        return false;
     }
 
     log_info("Loading LLM model: %s", model_path);
+    double load_start = now_sec();
 
     /* Initialize llama.cpp backend */
     llama_backend_init();
+    llm_ctx->backend_initialized = true;
 
     /* Detect GPU backend if auto mode enabled */
     LLMGpuBackend detected_backend = LLM_GPU_NONE;
@@ -187,6 +273,10 @@ LLMContext* llm_init(const LLMConfig* config) {
     struct llama_model_params model_params = llama_model_default_params();
     model_params.n_gpu_layers = gpu_layers;
 
+    /* Mapped weights stay in the page cache, so later runs load quickly */
+    model_params.use_mmap = config->use_mmap;
+    model_params.use_mlock = config->use_mlock;
+
     log_info("Attempting to load with %d GPU layers...", gpu_layers);
 
     /* Load model - try with GPU first */
@@ -205,26 +295,35 @@ LLMContext* llm_init(const LLMConfig* config) {
 
     if (!llm_ctx->model) {
         set_error(llm_ctx, "Failed to load model from: %s", config->model_path);
-        llm_shutdown(llm_ctx);
-        return NULL;
+        return false;
     }
 
     /* Store actual GPU configuration */
     llm_ctx->actual_gpu_layers = gpu_layers;
     llm_ctx->active_backend = detected_backend;
 
-    /* Set up context parameters */
-    struct llama_context_params ctx_params = llama_context_default_params();
-    ctx_params.n_ctx = config->n_ctx;
-    ctx_params.n_threads = config->n_threads > 0 ? config->n_threads : 4;
-    ctx_params.n_threads_batch = ctx_params.n_threads;
+    /* A running server serves every query, so the session context (and its
+     * KV cache) is only created without one */
+    struct llama_context_params ctx_params = context_params(config);
+    if (config->n_parallel > 1 && !server_start(llm_ctx, config->n_parallel)) {
+        log_warning("Concurrent queries unavailable; serving one query at a time");
+    }
 
-    /* Create context */
-    llm_ctx->ctx = llama_new_context_with_model(llm_ctx->model, ctx_params);
-    if (!llm_ctx->ctx) {
-        set_error(llm_ctx, "Failed to create llama context");
-        llm_shutdown(llm_ctx);
-        return NULL;
+    if (!llm_ctx->server) {
+        llm_ctx->ctx = llama_new_context_with_model(llm_ctx->model, ctx_params);
+        if (!llm_ctx->ctx) {
+            set_error(llm_ctx, "Failed to create llama context");
+            unload_model(llm_ctx);
+            return false;
+        }
+
+        llm_ctx->session_capacity = (int)llama_n_ctx(llm_ctx->ctx);
+        llm_ctx->session_tokens = malloc(llm_ctx->session_capacity * sizeof(llama_token));
+        if (!llm_ctx->session_tokens) {
+            set_error(llm_ctx, "Failed to allocate session buffer");
+            unload_model(llm_ctx);
+            return false;
+        }
     }
 
     /* Create sampler chain */
@@ -237,8 +336,7 @@ LLMContext* llm_init(const LLMConfig* config) {
     llama_sampler_chain_add(llm_ctx->sampler, llama_sampler_init_temp(0.7f));
     llama_sampler_chain_add(llm_ctx->sampler, llama_sampler_init_dist(1234));  /* seed */
 
-    llm_ctx->is_ready = true;
-    log_success("LLM model loaded successfully");
+    log_success("LLM model loaded in %.2f seconds", now_sec() - load_start);
 
     /* Log model info */
     const struct llama_vocab * vocab = llama_model_get_vocab(llm_ctx->model);
@@ -246,7 +344,9 @@ LLMContext* llm_init(const LLMConfig* config) {
     int n_vocab = llama_vocab_n_tokens(vocab);
     log_info("Vocabulary size: %d", n_vocab);
     log_info("Context length: %d", n_ctx_train);
-    log_info("Using %d threads", ctx_params.n_threads);
+    log_info("Using %d threads (%d for prompt processing), batch %u/%u",
+             ctx_params.n_threads, ctx_params.n_threads_batch,
+             ctx_params.n_batch, ctx_params.n_ubatch);
     if (llm_ctx->actual_gpu_layers > 0) {
         log_info("GPU acceleration: %s (%d layers)",
                  llm_gpu_backend_name(llm_ctx->active_backend),
@@ -255,32 +355,128 @@ LLMContext* llm_init(const LLMConfig* config) {
         log_info("Running on CPU only");
     }
 
+    return true;
+}
+
+/**
+ * Allocate a context holding a copy of the configuration
+ */
+static LLMContext* context_create(const LLMConfig* config) {
+    if (!config || !config->model_path) {
+        log_error("LLM config or model path is NULL");
+        return NULL;
+    }
+
+    LLMContext* llm_ctx = calloc(1, sizeof(LLMContext));
+    if (!llm_ctx) {
+        log_error("Failed to allocate LLM context");
+        return NULL;
+    }
+
+    memcpy(&llm_ctx->config, config, sizeof(LLMConfig));
+    llm_ctx->config.model_path = strdup(config->model_path);
+    llm_ctx->load_state = LLM_LOAD_PENDING;
+    mutex_init(&llm_ctx->load_mutex);
+    condition_init(&llm_ctx->load_cond);
+    mutex_init(&llm_ctx->query_mutex);
     return llm_ctx;
 }
 
-void llm_shutdown(LLMContext* ctx) {
-    if (!ctx) return;
+#ifdef CYXMAKE_WINDOWS
+static DWORD WINAPI loader_thread_func(LPVOID arg) {
+#else
+static void* loader_thread_func(void* arg) {
+#endif
+    llm_wait_ready((LLMContext*)arg);
+#ifdef CYXMAKE_WINDOWS
+    return 0;
+#else
+    return NULL;
+#endif
+}
 
-    if (ctx->sampler) {
-        llama_sampler_free(ctx->sampler);
+LLMContext* llm_init(const LLMConfig* config) {
+    LLMContext* llm_ctx = context_create(config);
+    if (!llm_ctx) return NULL;
+
+    if (!llm_wait_ready(llm_ctx)) {
+        llm_shutdown(llm_ctx);
+        return NULL;
     }
+    return llm_ctx;
+}
+
+LLMContext* llm_init_deferred(const LLMConfig* config, bool prefetch) {
+    LLMContext* llm_ctx = context_create(config);
+    if (!llm_ctx) return NULL;
 
-    if (ctx->ctx) {
-        llama_free(ctx->ctx);
+    if (prefetch) {
+        llm_ctx->loader_started = thread_create(&llm_ctx->loader, loader_thread_func, llm_ctx);
+        if (!llm_ctx->loader_started) {
+            log_warning("Could not start model prefetch; loading on first use");
+        }
     }
+    return llm_ctx;
+}
 
-    if (ctx->model) {
-        llama_free_model(ctx->model);
+bool llm_wait_ready(LLMContext* ctx) {
+    if (!ctx) return false;
+
+    mutex_lock(&ctx->load_mutex);
+    if (ctx->load_state == LLM_LOAD_PENDING) {
+        /* First caller loads; anyone else arriving meanwhile waits below */
+        ctx->load_state = LLM_LOAD_LOADING;
+        mutex_unlock(&ctx->load_mutex);
+
+        bool loaded = load_model(ctx);
+
+        mutex_lock(&ctx->load_mutex);
+        ctx->load_state = loaded ? LLM_LOAD_READY : LLM_LOAD_FAILED;
+        condition_broadcast(&ctx->load_cond);
     }
+    while (ctx->load_state == LLM_LOAD_LOADING) {
+        condition_wait(&ctx->load_cond, &ctx->load_mutex);
+    }
+    bool ready = ctx->load_state == LLM_LOAD_READY;
+    mutex_unlock(&ctx->load_mutex);
 
-    llama_backend_free();
+    return ready;
+}
+
+LLMLoadState llm_load_state(const LLMContext* ctx) {
+    if (!ctx) return LLM_LOAD_FAILED;
+
+    LLMContext* mutable_ctx = (LLMContext*)ctx;
+    mutex_lock(&mutable_ctx->load_mutex);
+    LLMLoadState state = ctx->load_state;
+    mutex_unlock(&mutable_ctx->load_mutex);
+    return state;
+}
+
+void llm_shutdown(LLMContext* ctx) {
+    if (!ctx) return;
 
+    /* A prefetch still running finishes first */
+    if (ctx->loader_started) {
+        thread_join(ctx->loader);
+    }
+
+    unload_model(ctx);
+
+    if (ctx->backend_initialized) {
+        llama_backend_free();
+    }
+
+    mutex_destroy(&ctx->load_mutex);
+    condition_destroy(&ctx->load_cond);
+    mutex_destroy(&ctx->query_mutex);
     free((void*)ctx->config.model_path);
     free(ctx);
 }
 
 bool llm_is_ready(const LLMContext* ctx) {
-    return ctx && ctx->is_ready && ctx->model && ctx->ctx;
+    /* Loading is a one-time side effect behind an otherwise const query */
+    return ctx && llm_wait_ready((LLMContext*)ctx);
 }
 
 LLMModelInfo* llm_get_model_info(const LLMContext* ctx) {
@@ -314,6 +510,43 @@ LLMModelInfo* llm_get_model_info(const LLMContext* ctx) {
     return info;
 }
 
+LLMModelInfo* llm_read_model_info(const char* model_path) {
+    char* path = expand_path(model_path);
+    if (!path) return NULL;
+
+    llama_backend_init();
+
+    /* Vocab-only loads read the GGUF header and vocabulary, not the weights */
+    struct llama_model_params model_params = llama_model_default_params();
+    model_params.vocab_only = true;
+    model_params.n_gpu_layers = 0;
+    struct llama_model* model = llama_load_model_from_file(path, model_params);
+
+    LLMModelInfo* info = model ? calloc(1, sizeof(LLMModelInfo)) : NULL;
+    if (info) {
+        char buf[256];
+        info->model_name = strdup(
+            llama_model_meta_val_str(model, "general.name", buf, sizeof(buf)) >= 0
+                ? buf : "unknown");
+        llama_model_desc(model, buf, sizeof(buf));
+        info->model_type = strdup(buf);
+
+        const struct llama_vocab* vocab = llama_model_get_vocab(model);
+        info->vocab_size = llama_vocab_n_tokens(vocab);
+        info->context_length = llama_model_n_ctx_train(model);
+        info->gpu_backend = LLM_GPU_NONE;
+        info->is_loaded = false;
+
+        struct stat st;
+        info->model_size_bytes = stat(path, &st) == 0 ? (size_t)st.st_size : 0;
+    }
+
+    if (model) llama_free_model(model);
+    llama_backend_free();
+    free(path);
+    return info;
+}
+
 void llm_model_info_free(LLMModelInfo* info) {
     if (!info) return;
     free(info->model_name);
@@ -321,6 +554,189 @@ void llm_model_info_free(LLMModelInfo* info) {
     free(info);
 }
 
+/* ========================================================================
+ * Session (KV Cache)
+ * ======================================================================== */
+
+/**
+ * Tokenize text into a newly allocated buffer of n_ctx tokens
+ * @return Token count, or -1 (error set) if the text does not fit
+ */
+static int tokenize_text(LLMContext* llm_ctx, const char* text, llama_token** tokens) {
+    const struct llama_vocab* vocab = llama_model_get_vocab(llm_ctx->model);
+    const int n_ctx = llm_ctx->session_capacity;
+
+    *tokens = malloc(n_ctx * sizeof(llama_token));
+    if (!*tokens) {
+        set_error(llm_ctx, "Memory allocation failed");
+        return -1;
+    }
+
+    int n_tokens = llama_tokenize(vocab, text, (int32_t)strlen(text), *tokens, n_ctx,
+                                  llama_vocab_get_add_bos(vocab), true);
+    if (n_tokens < 0) {
+        set_error(llm_ctx, "Prompt does not fit the context (%d tokens, limit %d)",
+                  -n_tokens, n_ctx);
+        free(*tokens);
+        *tokens = NULL;
+        return -1;
+    }
+    return n_tokens;
+}
+
+/**
+ * Bring the KV cache in line with a token sequence
+ *
+ * Keeps the longest prefix shared with what is already cached and decodes
+ * only the remaining tokens, in chunks of n_batch. With need_logits the
+ * last token is always decoded, so the caller can sample from it.
+ *
+ * @return Number of cached tokens reused, or -1 if decoding failed
+ */
+static int session_sync(LLMContext* llm_ctx, llama_token* tokens, int n_tokens,
+                        bool need_logits) {
+    llama_memory_t mem = llama_get_memory(llm_ctx->ctx);
+
+    int n_keep = 0;
+    while (n_keep < llm_ctx->n_session && n_keep < n_tokens &&
+           llm_ctx->session_tokens[n_keep] == tokens[n_keep]) {
+        n_keep++;
+    }
+    if (need_logits && n_keep == n_tokens && n_keep > 0) {
+        n_keep--;
+    }
+
+    if (!llama_memory_seq_rm(mem, SESSION_SEQ, n_keep, -1)) {
+        /* Some memory types cannot drop a suffix; start over */
+        llama_memory_clear(mem, true);
+        n_keep = 0;
+    }
+    llm_ctx->n_session = n_keep;
+
+    const int n_batch = (int)llama_n_batch(llm_ctx->ctx);
+    for (int i = n_keep; i < n_tokens; i += n_batch) {
+        int n = n_tokens - i < n_batch ? n_tokens - i : n_batch;
+        if (llama_decode(llm_ctx->ctx, llama_batch_get_one(tokens + i, n)) != 0) {
+            llama_memory_seq_rm(mem, SESSION_SEQ, llm_ctx->n_session, -1);
+            return -1;
+        }
+        memcpy(llm_ctx->session_tokens + llm_ctx->n_session, tokens + i,
+               n * sizeof(llama_token));
+        llm_ctx->n_session += n;
+    }
+
+    return n_keep;
+}
+
+/**
+ * Session state lives in the session context, which is not created while
+ * a server handles queries
+ */
+static bool session_available(LLMContext* ctx) {
+    if (ctx->ctx) return true;
+    set_error(ctx, "Session state is unavailable while serving concurrent queries "
+                   "(n_parallel > 1)");
+    return false;
+}
+
+void llm_session_reset(LLMContext* ctx) {
+    if (llm_load_state(ctx) != LLM_LOAD_READY || !ctx->ctx) return;
+    llama_memory_clear(llama_get_memory(ctx->ctx), true);
+    ctx->n_session = 0;
+}
+
+int llm_session_tokens(const LLMContext* ctx) {
+    return llm_load_state(ctx) == LLM_LOAD_READY ? ctx->n_session : 0;
+}
+
+bool llm_session_save(LLMContext* ctx, const char* path) {
+    if (llm_load_state(ctx) != LLM_LOAD_READY || !path) return false;
+    if (!session_available(ctx)) return false;
+
+    if (ctx->n_session == 0) {
+        set_error(ctx, "No session state to save");
+        return false;
+    }
+
+    char* expanded = expand_path(path);
+    if (!expanded) return false;
+
+    size_t written = llama_state_seq_save_file(ctx->ctx, expanded, SESSION_SEQ,
+                                               ctx->session_tokens,
+                                               (size_t)ctx->n_session);
+    if (written == 0) {
+        set_error(ctx, "Failed to save session state to: %s", expanded);
+        free(expanded);
+        return false;
+    }
+
+    log_debug("Saved %d session tokens (%zu bytes) to %s",
+              ctx->n_session, written, expanded);
+    free(expanded);
+    return true;
+}
+
+bool llm_session_load(LLMContext* ctx, const char* path) {
+    if (!llm_is_ready(ctx) || !path) return false;
+    if (!session_available(ctx)) return false;
+
+    char* expanded = expand_path(path);
+    if (!expanded) return false;
+
+    llm_session_reset(ctx);
+
+    size_t n_loaded = 0;
+    size_t read = llama_state_seq_load_file(ctx->ctx, expanded, SESSION_SEQ,
+                                            ctx->session_tokens,
+                                            (size_t)ctx->session_capacity, &n_loaded);
+    if (read == 0) {
+        /* A partial load may have left cells behind */
+        llm_session_reset(ctx);
+        set_error(ctx, "Failed to load session state from: %s", expanded);
+        free(expanded);
+        return false;
+    }
+
+    ctx->n_session = (int)n_loaded;
+    log_debug("Loaded %d session tokens from %s", ctx->n_session, expanded);
+    free(expanded);
+    return true;
+}
+
+bool llm_session_prime(LLMContext* ctx, const char* prefix, const char* state_path) {
+    if (!llm_is_ready(ctx) || !prefix) return false;
+    if (!session_available(ctx)) return false;
+
+    llama_token* tokens = NULL;
+    int n_tokens = tokenize_text(ctx, prefix, &tokens);
+    if (n_tokens < 0) return false;
+
+    /* Whatever part of a saved state matches the prefix is reused below */
+    if (state_path) {
+        char* expanded = expand_path(state_path);
+        struct stat st;
+        bool saved = expanded && stat(expanded, &st) == 0;
+        free(expanded);
+        if (saved) {
+            llm_session_load(ctx, state_path);
+        }
+    }
+
+    int reused = session_sync(ctx, tokens, n_tokens, false);
+    free(tokens);
+    if (reused < 0) {
+        set_error(ctx, "Failed to process session prefix");
+        return false;
+    }
+
+    log_debug("Session prefix ready: %d tokens, %d reused", n_tokens, reused);
+
+    if (state_path && reused < n_tokens) {
+        return llm_session_save(ctx, state_path);
+    }
+    return true;
+}
+
 /* ========================================================================
  * Request/Response
  * ======================================================================== */
@@ -338,6 +754,7 @@ LLMRequest* llm_request_create(const char* prompt) {
     req->top_p = 0.9f;
     req->repeat_penalty = 1.1f;
     req->stop_sequence = NULL;
+    req->grammar = NULL;
 
     return req;
 }
@@ -346,6 +763,7 @@ void llm_request_free(LLMRequest* request) {
     if (!request) return;
     free((void*)request->prompt);
     free((void*)request->stop_sequence);
+    free((void*)request->grammar);
     free(request);
 }
 
@@ -357,18 +775,95 @@ void llm_response_free(LLMResponse* response) {
 }
 
 /* ========================================================================
- * Inference (Simplified placeholder)
+ * Inference
  * ======================================================================== */
 
-LLMResponse* llm_query(LLMContext* llm_ctx, const LLMRequest* request) {
-    if (!llm_is_ready(llm_ctx)) {
-        log_error("LLM context is not ready");
-        return NULL;
+void llm_set_response_cache(LLMContext* ctx, AIResponseCache* cache) {
+    if (ctx) ctx->response_cache = cache;
+}
+
+/**
+ * Key a query and look it up in the response cache
+ */
+static LLMResponse* query_cache_lookup(LLMContext* llm_ctx, const LLMRequest* request,
+                                       char key[AI_CACHE_KEY_SIZE]) {
+    char max_tokens[32], temperature[32], top_k[32], top_p[32], repeat_penalty[32];
+    snprintf(max_tokens, sizeof(max_tokens), "%d", request->max_tokens);
+    snprintf(temperature, sizeof(temperature), "%.2f", request->temperature);
+    snprintf(top_k, sizeof(top_k), "%d", request->top_k);
+    snprintf(top_p, sizeof(top_p), "%.2f", request->top_p);
+    snprintf(repeat_penalty, sizeof(repeat_penalty), "%.2f", request->repeat_penalty);
+
+    const char* parts[] = {
+        "llm_query", llm_ctx->config.model_path, request->prompt, max_tokens,
+        temperature, top_k, top_p, repeat_penalty, request->stop_sequence,
+        request->grammar
+    };
+    ai_response_cache_key(parts, (int)(sizeof(parts) / sizeof(parts[0])), key);
+
+    AIResponse* cached = ai_response_cache_get(llm_ctx->response_cache, key);
+    if (!cached) return NULL;
+
+    LLMResponse* response = calloc(1, sizeof(LLMResponse));
+    if (response) {
+        response->text = cached->content ? cached->content : strdup("");
+        cached->content = NULL;
+        response->tokens_prompt = cached->prompt_tokens;
+        response->tokens_generated = cached->completion_tokens;
+        response->duration_sec = cached->duration_sec;
+        response->success = true;
+        response->cached = true;
+        log_debug("LLM response cache hit (%.0f us)", response->duration_sec * 1e6);
     }
+    ai_response_free(cached);
+    return response;
+}
 
-    if (!request || !request->prompt) {
-        set_error(llm_ctx, "Invalid request or empty prompt");
-        return NULL;
+/**
+ * Sampler chain for one request's sampling parameters
+ */
+static struct llama_sampler* sampler_create(const struct llama_vocab* vocab,
+                                            const LLMRequest* request) {
+    struct llama_sampler* sampler =
+        llama_sampler_chain_init(llama_sampler_chain_default_params());
+
+    /* The grammar masks candidates before any other sampler sees them */
+    if (request->grammar) {
+        struct llama_sampler* grammar = llama_sampler_init_grammar(vocab, request->grammar, "root");
+        if (grammar) {
+            llama_sampler_chain_add(sampler, grammar);
+        } else {
+            log_warning("Invalid grammar; generating unconstrained output");
+        }
+    }
+
+    if (request->repeat_penalty > 0.0f && request->repeat_penalty != 1.0f) {
+        llama_sampler_chain_add(sampler,
+                                llama_sampler_init_penalties(64, request->repeat_penalty, 0.0f, 0.0f));
+    }
+    if (request->temperature <= 0.0f) {
+        llama_sampler_chain_add(sampler, llama_sampler_init_greedy());
+        return sampler;
+    }
+    if (request->top_k > 0) {
+        llama_sampler_chain_add(sampler, llama_sampler_init_top_k(request->top_k));
+    }
+    if (request->top_p > 0.0f && request->top_p < 1.0f) {
+        llama_sampler_chain_add(sampler, llama_sampler_init_top_p(request->top_p, 1));
+    }
+    llama_sampler_chain_add(sampler, llama_sampler_init_temp(request->temperature));
+    llama_sampler_chain_add(sampler, llama_sampler_init_dist(1234));  /* seed */
+    return sampler;
+}
+
+/**
+ * Run a query on the session context; the caller holds query_mutex
+ */
+static LLMResponse* query_session(LLMContext* llm_ctx, const LLMRequest* request) {
+    char cache_key[AI_CACHE_KEY_SIZE];
+    if (llm_ctx->response_cache) {
+        LLMResponse* cached = query_cache_lookup(llm_ctx, request, cache_key);
+        if (cached) return cached;
     }
 
     log_info("Running LLM inference...");
@@ -379,58 +874,53 @@ LLMResponse* llm_query(LLMContext* llm_ctx, const LLMRequest* request) {
     if (!response) return NULL;
 
     /* Start timing */
-    clock_t start = clock();
+    double start = now_sec();
 
     const struct llama_vocab * vocab = llama_model_get_vocab(llm_ctx->model);
 
     /* Step 1: Tokenize the prompt */
-    const int n_ctx = llama_n_ctx(llm_ctx->ctx);
-    llama_token* tokens = malloc(n_ctx * sizeof(llama_token));
-    if (!tokens) {
+    llama_token* tokens = NULL;
+    int n_tokens = tokenize_text(llm_ctx, request->prompt, &tokens);
+    if (n_tokens < 0) {
         response->success = false;
-        response->error_message = strdup("Memory allocation failed");
+        response->error_message = strdup(llm_ctx->last_error);
         return response;
     }
 
-    int n_tokens = llama_tokenize(
-        vocab,
-        request->prompt,
-        strlen(request->prompt),
-        tokens,
-        n_ctx,
-        llama_vocab_get_add_bos(vocab),  /* add_bos */
-        true  /* special */
-    );
-
-    if (n_tokens < 0) {
+    if (n_tokens >= llm_ctx->session_capacity) {
         free(tokens);
+        set_error(llm_ctx, "Prompt leaves no room to generate (%d tokens, limit %d)",
+                  n_tokens, llm_ctx->session_capacity);
         response->success = false;
-        response->error_message = strdup("Tokenization failed");
+        response->error_message = strdup(llm_ctx->last_error);
         return response;
     }
 
     response->tokens_prompt = n_tokens;
     log_debug("Tokenized prompt: %d tokens", n_tokens);
 
-    /* Step 2: Create batch and process prompt */
-    struct llama_batch batch = llama_batch_get_one(tokens, n_tokens);
-
-    /* Note: KV cache clearing may not be needed or API may have changed */
-    /* llama_kv_cache_clear(llm_ctx->ctx); */
-
-    /* Process prompt */
-    if (llama_decode(llm_ctx->ctx, batch) != 0) {
-        free(tokens);
+    /* Step 2: Process only the part of the prompt not already cached */
+    int n_reused = session_sync(llm_ctx, tokens, n_tokens, true);
+    free(tokens);
+    if (n_reused < 0) {
         response->success = false;
         response->error_message = strdup("Failed to process prompt");
         return response;
     }
 
+    response->tokens_reused = n_reused;
+    double prompt_done = now_sec();
+    response->prompt_sec = prompt_done - start;
+    log_debug("Reused %d of %d prompt tokens from the KV cache", n_reused, n_tokens);
+
     /* Step 3: Generate tokens */
-    const int max_tokens = request->max_tokens;
+    int max_tokens = request->max_tokens;
+    if (max_tokens > llm_ctx->session_capacity - n_tokens) {
+        max_tokens = llm_ctx->session_capacity - n_tokens;
+    }
+
     char* output = malloc(max_tokens * 32);  /* Estimate 32 bytes per token */
     if (!output) {
-        free(tokens);
         response->success = false;
         response->error_message = strdup("Memory allocation failed");
         return response;
@@ -439,17 +929,15 @@ LLMResponse* llm_query(LLMContext* llm_ctx, const LLMRequest* request) {
     output[0] = '\0';
     size_t output_pos = 0;
     int n_generated = 0;
-    int n_cur = n_tokens;
 
-    for (int i = 0; i < max_tokens; i++) {
-        /* Get logits for the last token */
-        float* logits = llama_get_logits_ith(llm_ctx->ctx, batch.n_tokens - 1);
+    /* A grammar carries per-request state, so it needs its own chain */
+    struct llama_sampler* sampler = request->grammar
+                                        ? sampler_create(vocab, request) : llm_ctx->sampler;
 
-        /* Sample next token */
-        llama_token new_token = llama_sampler_sample(llm_ctx->sampler, llm_ctx->ctx, batch.n_tokens - 1);
-
-        /* Accept token into sampler */
-        llama_sampler_accept(llm_ctx->sampler, new_token);
+    for (int i = 0; i < max_tokens; i++) {
+        /* Sample next token from the last decoded position; sampling also
+         * accepts it into the chain (grammar and penalty state) */
+        llama_token new_token = llama_sampler_sample(sampler, llm_ctx->ctx, -1);
 
         /* Check for end of generation */
         if (llama_vocab_is_eog(vocab, new_token)) {
@@ -460,23 +948,25 @@ LLMResponse* llm_query(LLMContext* llm_ctx, const LLMRequest* request) {
         char piece[128];
         int n_chars = llama_token_to_piece(vocab, new_token, piece, sizeof(piece), 0, true);
 
-        if (n_chars > 0 && output_pos + n_chars < max_tokens * 32 - 1) {
+        if (n_chars > 0 && output_pos + n_chars < (size_t)max_tokens * 32 - 1) {
             memcpy(output + output_pos, piece, n_chars);
             output_pos += n_chars;
             output[output_pos] = '\0';
         }
 
-        /* Prepare next batch */
-        batch = llama_batch_get_one(&new_token, 1);
+        n_generated++;
 
-        /* Decode next token */
-        if (llama_decode(llm_ctx->ctx, batch) != 0) {
-            log_warning("Failed to decode token %d", i);
+        /* Stop before the context fills up */
+        if (llm_ctx->n_session >= llm_ctx->session_capacity) {
             break;
         }
 
-        n_generated++;
-        n_cur++;
+        /* Decode next token; it stays cached as part of the session */
+        if (llama_decode(llm_ctx->ctx, llama_batch_get_one(&new_token, 1)) != 0) {
+            log_warning("Failed to decode token %d", i);
+            break;
+        }
+        llm_ctx->session_tokens[llm_ctx->n_session++] = new_token;
 
         /* Check stop sequence */
         if (request->stop_sequence && strstr(output, request->stop_sequence)) {
@@ -484,11 +974,12 @@ LLMResponse* llm_query(LLMContext* llm_ctx, const LLMRequest* request) {
         }
     }
 
-    free(tokens);
+    if (sampler != llm_ctx->sampler) llama_sampler_free(sampler);
 
     /* Calculate duration */
-    clock_t end = clock();
-    response->duration_sec = ((double)(end - start)) / CLOCKS_PER_SEC;
+    double end = now_sec();
+    response->duration_sec = end - start;
+    response->generation_sec = end - prompt_done;
 
     /* Set response */
     response->text = output;
@@ -496,13 +987,552 @@ LLMResponse* llm_query(LLMContext* llm_ctx, const LLMRequest* request) {
     response->success = true;
     response->error_message = NULL;
 
-    log_success("Generated %d tokens in %.2f seconds (%.1f tok/s)",
+    log_success("Generated %d tokens in %.2f seconds (prompt %.1f tok/s, generation %.1f tok/s)",
                 n_generated, response->duration_sec,
-                n_generated / response->duration_sec);
+                response->prompt_sec > 0 ? (n_tokens - n_reused) / response->prompt_sec : 0.0,
+                response->generation_sec > 0 ? n_generated / response->generation_sec : 0.0);
+
+    if (llm_ctx->response_cache) {
+        AIResponse entry = {
+            .success = true,
+            .content = response->text,
+            .prompt_tokens = response->tokens_prompt,
+            .completion_tokens = response->tokens_generated,
+            .total_tokens = response->tokens_prompt + response->tokens_generated
+        };
+        ai_response_cache_put(llm_ctx->response_cache, cache_key, &entry);
+    }
+
+    return response;
+}
+
+LLMResponse* llm_query(LLMContext* llm_ctx, const LLMRequest* request) {
+    if (!llm_is_ready(llm_ctx)) {
+        log_error("LLM context is not ready");
+        return NULL;
+    }
+
+    if (!request || !request->prompt) {
+        set_error(llm_ctx, "Invalid request or empty prompt");
+        return NULL;
+    }
+
+    if (llm_ctx->server) {
+        LLMFuture* future = llm_query_async(llm_ctx, request);
+        LLMResponse* response = llm_future_wait(future);
+        llm_future_free(future);
+        return response;
+    }
+
+    mutex_lock(&llm_ctx->query_mutex);
+    LLMResponse* response = query_session(llm_ctx, request);
+    mutex_unlock(&llm_ctx->query_mutex);
+    return response;
+}
+
+/* ========================================================================
+ * Concurrent Queries
+ * ======================================================================== */
+
+struct LLMFuture {
+    MutexHandle mutex;
+    ConditionHandle cond;         /* Signalled when the response is set */
+    bool done;
+    int refs;                     /* Caller, plus the server while it holds it */
+    LLMResponse* response;
+    LLMRequest request;           /* Copy; strings owned */
+    char cache_key[AI_CACHE_KEY_SIZE];
+    LLMFuture* next;              /* Server queue link */
+};
+
+typedef enum {
+    SLOT_IDLE = 0,
+    SLOT_PROMPT,                  /* Prompt tokens still being decoded */
+    SLOT_GENERATE                 /* Sampling one token per step */
+} SlotState;
+
+/**
+ * One request being served, on its own KV sequence
+ */
+typedef struct {
+    SlotState state;
+    llama_seq_id seq_id;
+    LLMFuture* future;
+    struct llama_sampler* sampler;
+    llama_token* prompt;          /* NULL until the request is started */
+    int n_prompt;
+    int n_past;                   /* Tokens in this sequence's KV cache */
+    llama_token next_token;       /* Sampled, waiting to be decoded */
+    int i_batch;                  /* Batch row to sample from, or -1 */
+    bool in_batch;                /* Has tokens in the current batch */
+    int max_tokens;
+    int n_generated;
+    char* output;
+    size_t output_len;
+    size_t output_cap;
+    double start;
+    double prompt_done;
+} ServerSlot;
+
+struct LLMServer {
+    LLMContext* owner;
+    struct llama_context* ctx;    /* One KV sequence per slot */
+    ServerSlot* slots;
+    int n_slots;
+    int n_active;                 /* Slots in use (server thread only) */
+    int n_ctx_seq;                /* Context available to each sequence */
+    llama_batch batch;
+    int batch_capacity;
+
+    MutexHandle mutex;            /* Guards the queue and stop */
+    ConditionHandle cond;         /* Signalled on submit and stop */
+    LLMFuture* queue_head;
+    LLMFuture* queue_tail;
+    bool stop;
+    ThreadHandle thread;
+};
+
+static LLMFuture* future_create(const LLMRequest* request) {
+    LLMFuture* future = calloc(1, sizeof(LLMFuture));
+    if (!future) return NULL;
+
+    future->request = *request;
+    future->request.prompt = strdup(request->prompt);
+    future->request.stop_sequence = request->stop_sequence ? strdup(request->stop_sequence) : NULL;
+    future->request.grammar = request->grammar ? strdup(request->grammar) : NULL;
+    future->refs = 1;
+    mutex_init(&future->mutex);
+    condition_init(&future->cond);
+    return future;
+}
+
+static void future_release(LLMFuture* future) {
+    mutex_lock(&future->mutex);
+    int refs = --future->refs;
+    mutex_unlock(&future->mutex);
+    if (refs > 0) return;
+
+    llm_response_free(future->response);
+    free((void*)future->request.prompt);
+    free((void*)future->request.stop_sequence);
+    free((void*)future->request.grammar);
+    mutex_destroy(&future->mutex);
+    condition_destroy(&future->cond);
+    free(future);
+}
+
+/**
+ * Hand the response to the caller and drop the server's reference
+ */
+static void future_complete(LLMFuture* future, LLMResponse* response) {
+    mutex_lock(&future->mutex);
+    future->response = response;
+    future->done = true;
+    condition_broadcast(&future->cond);
+    mutex_unlock(&future->mutex);
+    future_release(future);
+}
+
+static LLMResponse* error_response(const char* message) {
+    LLMResponse* response = calloc(1, sizeof(LLMResponse));
+    if (response) {
+        response->success = false;
+        response->error_message = strdup(message);
+    }
+    return response;
+}
+
+static void batch_add(llama_batch* batch, llama_token token, llama_pos pos,
+                      llama_seq_id seq_id, bool logits) {
+    int i = batch->n_tokens++;
+    batch->token[i] = token;
+    batch->pos[i] = pos;
+    batch->n_seq_id[i] = 1;
+    batch->seq_id[i][0] = seq_id;
+    batch->logits[i] = logits;
+}
+
+/**
+ * Complete a slot's request, successfully unless error is set, and free
+ * the slot and its KV sequence
+ */
+static void slot_finish(LLMServer* server, ServerSlot* slot, const char* error) {
+    LLMResponse* response;
+    if (error) {
+        log_error("LLM query failed: %s", error);
+        response = error_response(error);
+    } else {
+        double end = now_sec();
+        response = calloc(1, sizeof(LLMResponse));
+        if (response) {
+            response->text = slot->output;
+            slot->output = NULL;
+            response->tokens_prompt = slot->n_prompt;
+            response->tokens_generated = slot->n_generated;
+            response->duration_sec = end - slot->start;
+            response->prompt_sec = slot->prompt_done - slot->start;
+            response->generation_sec = end - slot->prompt_done;
+            response->success = true;
+        }
+
+        AIResponseCache* cache = server->owner->response_cache;
+        if (response && cache && slot->future->cache_key[0]) {
+            AIResponse entry = {
+                .success = true,
+                .content = response->text,
+                .prompt_tokens = response->tokens_prompt,
+                .completion_tokens = response->tokens_generated,
+                .total_tokens = response->tokens_prompt + response->tokens_generated
+            };
+            ai_response_cache_put(cache, slot->future->cache_key, &entry);
+        }
+    }
+    future_complete(slot->future, response);
+
+    llama_memory_seq_rm(llama_get_memory(server->ctx), slot->seq_id, -1, -1);
+    if (slot->sampler) llama_sampler_free(slot->sampler);
+    free(slot->prompt);
+    free(slot->output);
+
+    llama_seq_id seq_id = slot->seq_id;
+    memset(slot, 0, sizeof(ServerSlot));
+    slot->seq_id = seq_id;
+    slot->i_batch = -1;
+    server->n_active--;
+}
+
+/**
+ * Tokenize a newly assigned request and set up its sampler
+ */
+static void slot_begin(LLMServer* server, ServerSlot* slot) {
+    const LLMRequest* request = &slot->future->request;
+    const struct llama_vocab* vocab = llama_model_get_vocab(server->owner->model);
+    char error[128];
+
+    slot->start = now_sec();
+    slot->i_batch = -1;
+    slot->prompt = malloc(server->n_ctx_seq * sizeof(llama_token));
+    if (!slot->prompt) {
+        slot_finish(server, slot, "Memory allocation failed");
+        return;
+    }
+
+    slot->n_prompt = llama_tokenize(vocab, request->prompt, (int32_t)strlen(request->prompt),
+                                    slot->prompt, server->n_ctx_seq,
+                                    llama_vocab_get_add_bos(vocab), true);
+    if (slot->n_prompt == 0) {
+        slot_finish(server, slot, "Prompt is empty");
+        return;
+    }
+    if (slot->n_prompt < 0 || slot->n_prompt >= server->n_ctx_seq) {
+        snprintf(error, sizeof(error), "Prompt does not fit the context (%d tokens, limit %d)",
+                 slot->n_prompt < 0 ? -slot->n_prompt : slot->n_prompt, server->n_ctx_seq);
+        slot_finish(server, slot, error);
+        return;
+    }
+
+    slot->max_tokens = request->max_tokens;
+    if (slot->max_tokens > server->n_ctx_seq - slot->n_prompt) {
+        slot->max_tokens = server->n_ctx_seq - slot->n_prompt;
+    }
+
+    slot->output_cap = (size_t)slot->max_tokens * 32 + 1;  /* Estimate 32 bytes per token */
+    slot->output = malloc(slot->output_cap);
+    slot->sampler = sampler_create(vocab, request);
+    if (!slot->output || !slot->sampler) {
+        slot_finish(server, slot, "Memory allocation failed");
+        return;
+    }
+    slot->output[0] = '\0';
+}
+
+/**
+ * Decode one batch covering every active sequence, then sample
+ *
+ * Generating sequences contribute their next token first, so replies keep
+ * flowing while a long prompt is processed; prompts fill the rest of the
+ * batch in order.
+ */
+static void server_step(LLMServer* server) {
+    llama_batch* batch = &server->batch;
+    batch->n_tokens = 0;
+
+    for (int i = 0; i < server->n_slots; i++) {
+        ServerSlot* slot = &server->slots[i];
+        slot->in_batch = false;
+        if (slot->state != SLOT_GENERATE) continue;
+
+        slot->i_batch = batch->n_tokens;
+        batch_add(batch, slot->next_token, slot->n_past++, slot->seq_id, true);
+        slot->in_batch = true;
+    }
+
+    for (int i = 0; i < server->n_slots && batch->n_tokens < server->batch_capacity; i++) {
+        ServerSlot* slot = &server->slots[i];
+        if (slot->state != SLOT_PROMPT) continue;
+
+        int n = slot->n_prompt - slot->n_past;
+        if (n > server->batch_capacity - batch->n_tokens) {
+            n = server->batch_capacity - batch->n_tokens;
+        }
+        for (int j = 0; j < n; j++, slot->n_past++) {
+            batch_add(batch, slot->prompt[slot->n_past], slot->n_past, slot->seq_id,
+                      slot->n_past == slot->n_prompt - 1);
+        }
+        if (slot->n_past == slot->n_prompt) {
+            slot->i_batch = batch->n_tokens - 1;
+        }
+        slot->in_batch = n > 0;
+    }
+
+    if (batch->n_tokens == 0) return;
+
+    if (llama_decode(server->ctx, *batch) != 0) {
+        for (int i = 0; i < server->n_slots; i++) {
+            if (server->slots[i].in_batch) {
+                slot_finish(server, &server->slots[i], "Failed to decode batch");
+            }
+        }
+        return;
+    }
+
+    const struct llama_vocab* vocab = llama_model_get_vocab(server->owner->model);
+    double now = now_sec();
+
+    for (int i = 0; i < server->n_slots; i++) {
+        ServerSlot* slot = &server->slots[i];
+        if (slot->i_batch < 0) continue;
+
+        if (slot->state == SLOT_PROMPT) {
+            slot->prompt_done = now;
+            slot->state = SLOT_GENERATE;
+        }
+
+        llama_token token = llama_sampler_sample(slot->sampler, server->ctx, slot->i_batch);
+        slot->i_batch = -1;
+
+        if (llama_vocab_is_eog(vocab, token)) {
+            slot_finish(server, slot, NULL);
+            continue;
+        }
+
+        char piece[128];
+        int n_chars = llama_token_to_piece(vocab, token, piece, sizeof(piece), 0, true);
+        if (n_chars > 0 && slot->output_len + n_chars < slot->output_cap) {
+            memcpy(slot->output + slot->output_len, piece, n_chars);
+            slot->output_len += n_chars;
+            slot->output[slot->output_len] = '\0';
+        }
+        slot->n_generated++;
+
+        const char* stop = slot->future->request.stop_sequence;
+        if (slot->n_generated >= slot->max_tokens || slot->n_past >= server->n_ctx_seq ||
+            (stop && strstr(slot->output, stop))) {
+            slot_finish(server, slot, NULL);
+            continue;
+        }
+        slot->next_token = token;
+    }
+}
+
+#ifdef CYXMAKE_WINDOWS
+static DWORD WINAPI server_thread_func(LPVOID arg) {
+#else
+static void* server_thread_func(void* arg) {
+#endif
+    LLMServer* server = (LLMServer*)arg;
+
+    for (;;) {
+        mutex_lock(&server->mutex);
+        while (!server->stop && !server->queue_head && server->n_active == 0) {
+            condition_wait(&server->cond, &server->mutex);
+        }
+        if (server->stop) {
+            mutex_unlock(&server->mutex);
+            break;
+        }
+
+        /* Admit waiting requests into free sequences */
+        for (int i = 0; i < server->n_slots && server->queue_head; i++) {
+            ServerSlot* slot = &server->slots[i];
+            if (slot->state != SLOT_IDLE) continue;
+
+            slot->future = server->queue_head;
+            server->queue_head = slot->future->next;
+            if (!server->queue_head) server->queue_tail = NULL;
+            slot->state = SLOT_PROMPT;
+            server->n_active++;
+        }
+        mutex_unlock(&server->mutex);
+
+        for (int i = 0; i < server->n_slots; i++) {
+            ServerSlot* slot = &server->slots[i];
+            if (slot->state == SLOT_PROMPT && !slot->prompt) {
+                slot_begin(server, slot);
+            }
+        }
+
+        server_step(server);
+    }
+
+#ifdef CYXMAKE_WINDOWS
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+static bool server_start(LLMContext* llm_ctx, int n_parallel) {
+    LLMServer* server = calloc(1, sizeof(LLMServer));
+    if (!server) return false;
+
+    /* Each sequence gets the configured context size */
+    struct llama_context_params params = context_params(&llm_ctx->config);
+    params.n_ctx = (uint32_t)llm_ctx->config.n_ctx * (uint32_t)n_parallel;
+    params.n_seq_max = (uint32_t)n_parallel;
+
+    server->ctx = llama_new_context_with_model(llm_ctx->model, params);
+    if (!server->ctx) {
+        log_error("Failed to create context for %d parallel sequences", n_parallel);
+        free(server);
+        return false;
+    }
+
+    server->owner = llm_ctx;
+    server->n_slots = n_parallel;
+    server->n_ctx_seq = (int)llama_n_ctx(server->ctx) / n_parallel;
+    server->batch_capacity = (int)llama_n_batch(server->ctx);
+    server->batch = llama_batch_init(server->batch_capacity, 0, 1);
+    server->slots = calloc((size_t)n_parallel, sizeof(ServerSlot));
+    if (!server->slots) {
+        llama_batch_free(server->batch);
+        llama_free(server->ctx);
+        free(server);
+        return false;
+    }
+    for (int i = 0; i < n_parallel; i++) {
+        server->slots[i].seq_id = i;
+        server->slots[i].i_batch = -1;
+    }
+
+    mutex_init(&server->mutex);
+    condition_init(&server->cond);
+    if (!thread_create(&server->thread, server_thread_func, server)) {
+        mutex_destroy(&server->mutex);
+        condition_destroy(&server->cond);
+        free(server->slots);
+        llama_batch_free(server->batch);
+        llama_free(server->ctx);
+        free(server);
+        return false;
+    }
+
+    llm_ctx->server = server;
+    log_info("Serving up to %d concurrent queries (%d tokens of context each)",
+             n_parallel, server->n_ctx_seq);
+    return true;
+}
+
+static void server_stop(LLMContext* llm_ctx) {
+    LLMServer* server = llm_ctx->server;
+    if (!server) return;
+
+    mutex_lock(&server->mutex);
+    server->stop = true;
+    condition_broadcast(&server->cond);
+    mutex_unlock(&server->mutex);
+    thread_join(server->thread);
 
+    /* Nobody is left to serve what is still running or queued */
+    for (int i = 0; i < server->n_slots; i++) {
+        if (server->slots[i].state != SLOT_IDLE) {
+            slot_finish(server, &server->slots[i], "LLM context shut down");
+        }
+    }
+    while (server->queue_head) {
+        LLMFuture* future = server->queue_head;
+        server->queue_head = future->next;
+        future_complete(future, error_response("LLM context shut down"));
+    }
+
+    mutex_destroy(&server->mutex);
+    condition_destroy(&server->cond);
+    free(server->slots);
+    llama_batch_free(server->batch);
+    llama_free(server->ctx);
+    free(server);
+    llm_ctx->server = NULL;
+}
+
+LLMFuture* llm_query_async(LLMContext* llm_ctx, const LLMRequest* request) {
+    if (!llm_is_ready(llm_ctx)) {
+        log_error("LLM context is not ready");
+        return NULL;
+    }
+
+    if (!request || !request->prompt) {
+        set_error(llm_ctx, "Invalid request or empty prompt");
+        return NULL;
+    }
+
+    LLMFuture* future = future_create(request);
+    if (!future) return NULL;
+
+    LLMServer* server = llm_ctx->server;
+    if (!server) {
+        future->response = llm_query(llm_ctx, request);
+        future->done = true;
+        return future;
+    }
+
+    if (llm_ctx->response_cache) {
+        future->response = query_cache_lookup(llm_ctx, request, future->cache_key);
+        if (future->response) {
+            future->done = true;
+            return future;
+        }
+    }
+
+    future->refs = 2;
+    mutex_lock(&server->mutex);
+    if (server->queue_tail) {
+        server->queue_tail->next = future;
+    } else {
+        server->queue_head = future;
+    }
+    server->queue_tail = future;
+    condition_signal(&server->cond);
+    mutex_unlock(&server->mutex);
+
+    return future;
+}
+
+bool llm_future_ready(LLMFuture* future) {
+    if (!future) return false;
+
+    mutex_lock(&future->mutex);
+    bool done = future->done;
+    mutex_unlock(&future->mutex);
+    return done;
+}
+
+LLMResponse* llm_future_wait(LLMFuture* future) {
+    if (!future) return NULL;
+
+    mutex_lock(&future->mutex);
+    while (!future->done) {
+        condition_wait(&future->cond, &future->mutex);
+    }
+    LLMResponse* response = future->response;
+    future->response = NULL;
+    mutex_unlock(&future->mutex);
     return response;
 }
 
+void llm_future_free(LLMFuture* future) {
+    if (future) future_release(future);
+}
+
 /* ========================================================================
  * Convenience Functions
  * ======================================================================== */
@@ -604,6 +1634,16 @@ int llm_estimate_tokens(const char* text) {
     return (int)(strlen(text) / 4);
 }
 
+int llm_count_tokens(LLMContext* ctx, const char* text) {
+    if (!text) return 0;
+    if (llm_load_state(ctx) != LLM_LOAD_READY) return llm_estimate_tokens(text);
+
+    /* With no room for the tokens, llama_tokenize returns minus their count */
+    const struct llama_vocab* vocab = llama_model_get_vocab(ctx->model);
+    int n_tokens = llama_tokenize(vocab, text, (int32_t)strlen(text), NULL, 0, false, true);
+    return n_tokens < 0 ? -n_tokens : n_tokens;
+}
+
 /* ========================================================================
  * GPU Detection
  * ======================================================================== */
@@ -6,7 +6,9 @@
 #include "cyxmake/prompt_templates.h"
 #include "cyxmake/llm_interface.h"
 #include "cyxmake/project_context.h"
+#include "cyxmake/ai_schema.h"
 #include "cyxmake/logger.h"
+#include "cJSON.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -626,80 +628,40 @@ static AIActionType parse_action_type(const char* action_str) {
     return AI_ACTION_NONE;
 }
 
-/* Extract JSON string value */
-static char* extract_json_string(const char* json, const char* key) {
-    if (!json || !key) return NULL;
-
-    /* Build search pattern: "key": " */
-    char pattern[128];
-    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
-
-    const char* start = strstr(json, pattern);
-    if (!start) return NULL;
-
-    start += strlen(pattern);
-
-    /* Skip whitespace */
-    while (*start == ' ' || *start == '\t' || *start == '\n') start++;
-
-    /* Check for null */
-    if (strncmp(start, "null", 4) == 0) return NULL;
-
-    /* Find opening quote */
-    if (*start != '"') return NULL;
-    start++;
-
-    /* Find closing quote (handle escaped quotes) */
-    const char* end = start;
-    while (*end && !(*end == '"' && *(end-1) != '\\')) {
-        end++;
-    }
-
-    if (*end != '"') return NULL;
-
-    /* Extract string */
-    size_t len = end - start;
-    char* result = malloc(len + 1);
-    if (!result) return NULL;
-
-    /* Copy and unescape basic escapes */
-    size_t j = 0;
-    for (size_t i = 0; i < len; i++) {
-        if (start[i] == '\\' && i + 1 < len) {
-            i++;
-            switch (start[i]) {
-                case 'n': result[j++] = '\n'; break;
-                case 't': result[j++] = '\t'; break;
-                case '"': result[j++] = '"'; break;
-                case '\\': result[j++] = '\\'; break;
-                default: result[j++] = start[i]; break;
-            }
-        } else {
-            result[j++] = start[i];
-        }
-    }
-    result[j] = '\0';
-
-    return result;
-}
-
-/* Extract JSON boolean value */
-static bool extract_json_bool(const char* json, const char* key, bool default_val) {
-    if (!json || !key) return default_val;
-
-    char pattern[128];
-    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
-
-    const char* start = strstr(json, pattern);
-    if (!start) return default_val;
-
-    start += strlen(pattern);
-    while (*start == ' ' || *start == '\t' || *start == '\n') start++;
-
-    if (strncmp(start, "true", 4) == 0) return true;
-    if (strncmp(start, "false", 5) == 0) return false;
-
-    return default_val;
+/* Reply shape requested by prompt_ai_agent */
+static const char* const AGENT_ACTION_TYPES[] = {
+    "read_file", "create_file", "delete_file", "delete_dir", "build",
+    "clean", "install", "run_command", "list_files", "none", NULL
+};
+
+static const AISchema AGENT_ACTION_FIELDS[] = {
+    { .type = AI_SCHEMA_STRING, .name = "action", .required = true,
+      .enum_values = AGENT_ACTION_TYPES },
+    { .type = AI_SCHEMA_STRING, .name = "target", .nullable = true },
+    { .type = AI_SCHEMA_STRING, .name = "content", .nullable = true },
+    { .type = AI_SCHEMA_STRING, .name = "reason", .nullable = true },
+};
+
+static const AISchema AGENT_ACTION = {
+    .type = AI_SCHEMA_OBJECT,
+    .properties = AGENT_ACTION_FIELDS,
+    .property_count = 4
+};
+
+static const AISchema AGENT_RESPONSE_FIELDS[] = {
+    { .type = AI_SCHEMA_STRING, .name = "message", .required = true },
+    { .type = AI_SCHEMA_ARRAY, .name = "actions", .items = &AGENT_ACTION },
+    { .type = AI_SCHEMA_BOOLEAN, .name = "needs_confirmation" },
+};
+
+static const AISchema AGENT_RESPONSE_SCHEMA = {
+    .type = AI_SCHEMA_OBJECT,
+    .properties = AGENT_RESPONSE_FIELDS,
+    .property_count = 3
+};
+
+const AISchema* ai_agent_response_schema(void) {
+    return &AGENT_RESPONSE_SCHEMA;
 }
 
 AIAgentResponse* parse_ai_agent_response(const char* response) {
@@ -708,110 +670,44 @@ AIAgentResponse* parse_ai_agent_response(const char* response) {
     AIAgentResponse* result = calloc(1, sizeof(AIAgentResponse));
     if (!result) return NULL;
 
-    /* Find JSON block (look for ```json or just {) */
-    const char* json_start = strstr(response, "```json");
-    if (json_start) {
-        json_start += 7;
-        while (*json_start == '\n' || *json_start == '\r') json_start++;
-    } else {
-        json_start = strchr(response, '{');
-    }
-
-    if (!json_start) {
-        /* No JSON found, treat as plain message */
+    char error[256];
+    cJSON* json = ai_schema_parse(&AGENT_RESPONSE_SCHEMA, response, error, sizeof(error));
+    if (!json) {
+        /* No usable JSON, treat as plain message */
+        log_debug("Agent reply is not structured: %s", error);
         result->message = strdup(response);
         result->needs_confirmation = false;
         return result;
     }
 
-    /* Find end of JSON */
-    const char* json_end = strstr(json_start, "```");
-    if (!json_end) {
-        /* Find last closing brace */
-        json_end = strrchr(json_start, '}');
-        if (json_end) json_end++;
-    }
-
-    if (!json_end) {
-        result->message = strdup(response);
-        return result;
-    }
+    result->message = ai_json_strdup(json, "message");
+    result->needs_confirmation = ai_json_bool(json, "needs_confirmation", true);
 
-    /* Copy JSON for parsing */
-    size_t json_len = json_end - json_start;
-    char* json = malloc(json_len + 1);
-    if (!json) {
-        free(result);
-        return NULL;
-    }
-    strncpy(json, json_start, json_len);
-    json[json_len] = '\0';
-
-    /* Extract message */
-    result->message = extract_json_string(json, "message");
-
-    /* Extract needs_confirmation */
-    result->needs_confirmation = extract_json_bool(json, "needs_confirmation", true);
-
-    /* Parse actions array */
-    const char* actions_start = strstr(json, "\"actions\"");
-    if (actions_start) {
-        actions_start = strchr(actions_start, '[');
-        if (actions_start) {
-            actions_start++;
-
-            AIAction* last_action = NULL;
-
-            /* Parse each action object */
-            const char* action_start = strchr(actions_start, '{');
-            while (action_start) {
-                /* Find end of this action object */
-                const char* action_end = strchr(action_start, '}');
-                if (!action_end) break;
-
-                /* Extract action object substring */
-                size_t action_len = action_end - action_start + 1;
-                char* action_json = malloc(action_len + 1);
-                if (!action_json) break;
-                strncpy(action_json, action_start, action_len);
-                action_json[action_len] = '\0';
-
-                /* Parse action fields */
-                char* action_type_str = extract_json_string(action_json, "action");
-                AIActionType action_type = parse_action_type(action_type_str);
-                free(action_type_str);
-
-                if (action_type != AI_ACTION_NONE) {
-                    AIAction* action = calloc(1, sizeof(AIAction));
-                    if (action) {
-                        action->type = action_type;
-                        action->target = extract_json_string(action_json, "target");
-                        action->content = extract_json_string(action_json, "content");
-                        action->reason = extract_json_string(action_json, "reason");
-
-                        /* Add to chain */
-                        if (last_action) {
-                            last_action->next = action;
-                        } else {
-                            result->actions = action;
-                        }
-                        last_action = action;
-                    }
-                }
+    AIAction* last_action = NULL;
+    const cJSON* item = NULL;
+    cJSON_ArrayForEach(item, cJSON_GetObjectItemCaseSensitive(json, "actions")) {
+        AIActionType action_type =
+            parse_action_type(cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(item, "action")));
+        if (action_type == AI_ACTION_NONE) continue;
 
-                free(action_json);
+        AIAction* action = calloc(1, sizeof(AIAction));
+        if (!action) break;
 
-                /* Find next action object */
-                action_start = strchr(action_end + 1, '{');
+        action->type = action_type;
+        action->target = ai_json_strdup(item, "target");
+        action->content = ai_json_strdup(item, "content");
+        action->reason = ai_json_strdup(item, "reason");
 
-                /* Check if we've passed the actions array */
-                const char* array_end = strchr(actions_start, ']');
-                if (array_end && action_start > array_end) break;
-            }
+        /* Add to chain */
+        if (last_action) {
+            last_action->next = action;
+        } else {
+            result->actions = action;
         }
+        last_action = action;
     }
 
-    free(json);
+    cJSON_Delete(json);
     return result;
 }
 
@@ -1153,81 +1049,67 @@ char* prompt_parse_command(const char* user_input) {
     return prompt;
 }
 
+/* Reply shape requested by prompt_parse_command */
+static const char* const COMMAND_INTENTS[] = {
+    "build", "init", "clean", "test", "create_file", "read_file", "explain",
+    "fix", "install", "status", "help", "unknown", NULL
+};
+
+static const AISchema COMMAND_FIELDS[] = {
+    { .type = AI_SCHEMA_STRING, .name = "intent", .required = true,
+      .enum_values = COMMAND_INTENTS },
+    { .type = AI_SCHEMA_STRING, .name = "target", .nullable = true },
+    { .type = AI_SCHEMA_STRING, .name = "details", .nullable = true },
+};
+
+static const AISchema COMMAND_SCHEMA = {
+    .type = AI_SCHEMA_OBJECT,
+    .properties = COMMAND_FIELDS,
+    .property_count = 3
+};
+
 /* Parse AI response to extract intent */
 static ParsedCommand* parse_ai_response(const char* response) {
     if (!response) return NULL;
 
-    ParsedCommand* cmd = calloc(1, sizeof(ParsedCommand));
-    if (!cmd) return NULL;
-
-    cmd->intent = INTENT_UNKNOWN;
-    cmd->confidence = 0.7;  /* AI responses get moderate confidence */
-
-    /* Simple JSON parsing - look for intent field */
-    const char* intent_start = strstr(response, "\"intent\"");
-    if (intent_start) {
-        intent_start = strchr(intent_start, ':');
-        if (intent_start) {
-            intent_start = strchr(intent_start, '"');
-            if (intent_start) {
-                intent_start++;
-                char intent[64] = {0};
-                sscanf(intent_start, "%63[^\"]", intent);
-
-                if (strcmp(intent, "build") == 0) cmd->intent = INTENT_BUILD;
-                else if (strcmp(intent, "init") == 0) cmd->intent = INTENT_INIT;
-                else if (strcmp(intent, "clean") == 0) cmd->intent = INTENT_CLEAN;
-                else if (strcmp(intent, "test") == 0) cmd->intent = INTENT_TEST;
-                else if (strcmp(intent, "create_file") == 0) cmd->intent = INTENT_CREATE_FILE;
-                else if (strcmp(intent, "read_file") == 0) cmd->intent = INTENT_READ_FILE;
-                else if (strcmp(intent, "explain") == 0) cmd->intent = INTENT_EXPLAIN;
-                else if (strcmp(intent, "fix") == 0) cmd->intent = INTENT_FIX;
-                else if (strcmp(intent, "install") == 0) cmd->intent = INTENT_INSTALL;
-                else if (strcmp(intent, "status") == 0) cmd->intent = INTENT_STATUS;
-                else if (strcmp(intent, "help") == 0) cmd->intent = INTENT_HELP;
-
-                cmd->confidence = 0.85;
-            }
-        }
+    char error[256];
+    cJSON* json = ai_schema_parse(&COMMAND_SCHEMA, response, error, sizeof(error));
+    if (!json) {
+        log_debug("AI command reply rejected: %s", error);
+        return NULL;
     }
 
-    /* Extract target */
-    const char* target_start = strstr(response, "\"target\"");
-    if (target_start) {
-        target_start = strchr(target_start, ':');
-        if (target_start) {
-            /* Skip whitespace */
-            target_start++;
-            while (*target_start == ' ' || *target_start == '\t') target_start++;
-
-            if (*target_start == '"') {
-                target_start++;
-                char target[256] = {0};
-                sscanf(target_start, "%255[^\"]", target);
-                if (strlen(target) > 0 && strcmp(target, "null") != 0) {
-                    cmd->target = strdup(target);
-                }
-            }
-        }
+    ParsedCommand* cmd = calloc(1, sizeof(ParsedCommand));
+    if (!cmd) {
+        cJSON_Delete(json);
+        return NULL;
     }
 
-    /* Extract details */
-    const char* details_start = strstr(response, "\"details\"");
-    if (details_start) {
-        details_start = strchr(details_start, ':');
-        if (details_start) {
-            details_start = strchr(details_start, '"');
-            if (details_start) {
-                details_start++;
-                char details[512] = {0};
-                sscanf(details_start, "%511[^\"]", details);
-                if (strlen(details) > 0) {
-                    cmd->details = strdup(details);
-                }
-            }
-        }
+    const char* intent = cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(json, "intent"));
+    cmd->intent = INTENT_UNKNOWN;
+    if (strcmp(intent, "build") == 0) cmd->intent = INTENT_BUILD;
+    else if (strcmp(intent, "init") == 0) cmd->intent = INTENT_INIT;
+    else if (strcmp(intent, "clean") == 0) cmd->intent = INTENT_CLEAN;
+    else if (strcmp(intent, "test") == 0) cmd->intent = INTENT_TEST;
+    else if (strcmp(intent, "create_file") == 0) cmd->intent = INTENT_CREATE_FILE;
+    else if (strcmp(intent, "read_file") == 0) cmd->intent = INTENT_READ_FILE;
+    else if (strcmp(intent, "explain") == 0) cmd->intent = INTENT_EXPLAIN;
+    else if (strcmp(intent, "fix") == 0) cmd->intent = INTENT_FIX;
+    else if (strcmp(intent, "install") == 0) cmd->intent = INTENT_INSTALL;
+    else if (strcmp(intent, "status") == 0) cmd->intent = INTENT_STATUS;
+    else if (strcmp(intent, "help") == 0) cmd->intent = INTENT_HELP;
+
+    /* AI responses get moderate confidence, more when the intent is known */
+    cmd->confidence = cmd->intent == INTENT_UNKNOWN ? 0.7 : 0.85;
+
+    cmd->target = ai_json_strdup(json, "target");
+    if (cmd->target && strcmp(cmd->target, "null") == 0) {
+        free(cmd->target);
+        cmd->target = NULL;
     }
+    cmd->details = ai_json_strdup(json, "details");
 
+    cJSON_Delete(json);
     return cmd;
 }
 
@@ -1254,6 +1136,7 @@ ParsedCommand* parse_command_with_ai(const char* input, LLMContext* llm) {
 
     request->temperature = 0.1f;  /* Low temperature for consistent parsing */
     request->max_tokens = 256;
+    request->grammar = ai_schema_to_gbnf(&COMMAND_SCHEMA);  /* Only valid replies */
 
     /* Query LLM */
     LLMResponse* response = llm_query(llm, request);
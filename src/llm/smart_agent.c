@@ -8,6 +8,7 @@
 #include "cyxmake/tool_executor.h"
 #include "cyxmake/project_context.h"
 #include "cyxmake/conversation_context.h"
+#include "cyxmake/ai_schema.h"
 #include "cyxmake/logger.h"
 #include "cyxmake/compat.h"
 #include "cJSON/cJSON.h"
@@ -144,71 +145,53 @@ static char* build_context_string(SmartAgent* agent) {
     return ctx;
 }
 
-/* Simple JSON string extraction */
-static char* json_get_string(const char* json, const char* key) {
-    char search[128];
-    snprintf(search, sizeof(search), "\"%s\":", key);
-
-    const char* pos = strstr(json, search);
-    if (!pos) return NULL;
-
-    pos += strlen(search);
-    while (*pos == ' ' || *pos == '\t') pos++;
-
-    if (*pos != '"') return NULL;
-    pos++;
-
-    const char* end = strchr(pos, '"');
-    if (!end) return NULL;
-
-    size_t len = end - pos;
-    char* result = malloc(len + 1);
-    if (!result) return NULL;
-
-    strncpy(result, pos, len);
-    result[len] = '\0';
-
-    return result;
-}
-
-static float json_get_float(const char* json, const char* key) {
-    char search[128];
-    snprintf(search, sizeof(search), "\"%s\":", key);
-
-    const char* pos = strstr(json, search);
-    if (!pos) return 0.0f;
-
-    pos += strlen(search);
-    while (*pos == ' ' || *pos == '\t') pos++;
-
-    return (float)atof(pos);
-}
-
-static int json_get_int(const char* json, const char* key) {
-    char search[128];
-    snprintf(search, sizeof(search), "\"%s\":", key);
-
-    const char* pos = strstr(json, search);
-    if (!pos) return 0;
-
-    pos += strlen(search);
-    while (*pos == ' ' || *pos == '\t') pos++;
-
-    return atoi(pos);
-}
-
-static bool json_get_bool(const char* json, const char* key) {
-    char search[128];
-    snprintf(search, sizeof(search), "\"%s\":", key);
-
-    const char* pos = strstr(json, search);
-    if (!pos) return false;
-
-    pos += strlen(search);
-    while (*pos == ' ' || *pos == '\t') pos++;
-
-    return strncmp(pos, "true", 4) == 0;
-}
+/* Reply shapes requested by INTENT_SYSTEM_PROMPT and DECISION_SYSTEM_PROMPT */
+static const char* const INTENT_NAMES[] = {
+    "build", "clean", "test", "run", "fix", "install", "configure",
+    "explain", "create", "read", "help", "unknown", NULL
+};
+
+static const AISchema STRING_ITEM = { .type = AI_SCHEMA_STRING };
+
+static const AISchema MODIFIER_FIELDS[] = {
+    { .type = AI_SCHEMA_BOOLEAN, .name = "verbose" },
+    { .type = AI_SCHEMA_BOOLEAN, .name = "quiet" },
+    { .type = AI_SCHEMA_BOOLEAN, .name = "fast" },
+    { .type = AI_SCHEMA_BOOLEAN, .name = "force" },
+    { .type = AI_SCHEMA_BOOLEAN, .name = "dry_run" },
+};
+
+static const AISchema INTENT_FIELDS[] = {
+    { .type = AI_SCHEMA_STRING, .name = "intent", .required = true, .enum_values = INTENT_NAMES },
+    { .type = AI_SCHEMA_NUMBER, .name = "confidence" },
+    { .type = AI_SCHEMA_ARRAY, .name = "files", .items = &STRING_ITEM },
+    { .type = AI_SCHEMA_ARRAY, .name = "packages", .items = &STRING_ITEM },
+    { .type = AI_SCHEMA_ARRAY, .name = "targets", .items = &STRING_ITEM },
+    { .type = AI_SCHEMA_OBJECT, .name = "modifiers",
+      .properties = MODIFIER_FIELDS, .property_count = 5 },
+    { .type = AI_SCHEMA_BOOLEAN, .name = "references_context" },
+    { .type = AI_SCHEMA_STRING, .name = "interpretation" },
+};
+
+static const AISchema INTENT_SCHEMA = {
+    .type = AI_SCHEMA_OBJECT,
+    .properties = INTENT_FIELDS,
+    .property_count = 8
+};
+
+static const AISchema DECISION_FIELDS[] = {
+    { .type = AI_SCHEMA_INTEGER, .name = "selected_option", .required = true },
+    { .type = AI_SCHEMA_STRING, .name = "reasoning" },
+    { .type = AI_SCHEMA_NUMBER, .name = "confidence" },
+    { .type = AI_SCHEMA_ARRAY, .name = "risks", .items = &STRING_ITEM },
+    { .type = AI_SCHEMA_ARRAY, .name = "alternatives_if_fails", .items = &STRING_ITEM },
+};
+
+static const AISchema DECISION_SCHEMA = {
+    .type = AI_SCHEMA_OBJECT,
+    .properties = DECISION_FIELDS,
+    .property_count = 5
+};
 
 /* ============================================================================
  * Reasoning Chain
@@ -593,31 +576,30 @@ SmartIntent* smart_agent_understand(SmartAgent* agent, const char* input) {
             input);
         free(context);
 
-        char* response = ai_provider_query(agent->ai, prompt, 1024);
-        if (response) {
-            /* Parse JSON response */
-            char* intent_str = json_get_string(response, "intent");
-            if (intent_str) {
-                if (strcmp(intent_str, "build") == 0) intent->primary_intent = SMART_INTENT_BUILD;
-                else if (strcmp(intent_str, "clean") == 0) intent->primary_intent = SMART_INTENT_CLEAN;
-                else if (strcmp(intent_str, "test") == 0) intent->primary_intent = SMART_INTENT_TEST;
-                else if (strcmp(intent_str, "run") == 0) intent->primary_intent = SMART_INTENT_RUN;
-                else if (strcmp(intent_str, "fix") == 0) intent->primary_intent = SMART_INTENT_FIX;
-                else if (strcmp(intent_str, "install") == 0) intent->primary_intent = SMART_INTENT_INSTALL;
-                else if (strcmp(intent_str, "configure") == 0) intent->primary_intent = SMART_INTENT_CONFIGURE;
-                else if (strcmp(intent_str, "explain") == 0) intent->primary_intent = SMART_INTENT_EXPLAIN;
-                else if (strcmp(intent_str, "create") == 0) intent->primary_intent = SMART_INTENT_CREATE;
-                else if (strcmp(intent_str, "read") == 0) intent->primary_intent = SMART_INTENT_READ;
-                else if (strcmp(intent_str, "help") == 0) intent->primary_intent = SMART_INTENT_HELP;
-                free(intent_str);
-            }
-
-            intent->semantic_confidence = json_get_float(response, "confidence");
-            intent->ai_interpretation = json_get_string(response, "interpretation");
-            intent->references_last_error = json_get_bool(response, "references_context");
-
-            free(response);
+        char* response = ai_provider_query_structured(agent->ai, prompt, 1024, &INTENT_SCHEMA);
+        cJSON* json = response ? ai_schema_parse(&INTENT_SCHEMA, response, NULL, 0) : NULL;
+        if (json) {
+            const char* intent_str =
+                cJSON_GetStringValue(cJSON_GetObjectItemCaseSensitive(json, "intent"));
+            if (strcmp(intent_str, "build") == 0) intent->primary_intent = SMART_INTENT_BUILD;
+            else if (strcmp(intent_str, "clean") == 0) intent->primary_intent = SMART_INTENT_CLEAN;
+            else if (strcmp(intent_str, "test") == 0) intent->primary_intent = SMART_INTENT_TEST;
+            else if (strcmp(intent_str, "run") == 0) intent->primary_intent = SMART_INTENT_RUN;
+            else if (strcmp(intent_str, "fix") == 0) intent->primary_intent = SMART_INTENT_FIX;
+            else if (strcmp(intent_str, "install") == 0) intent->primary_intent = SMART_INTENT_INSTALL;
+            else if (strcmp(intent_str, "configure") == 0) intent->primary_intent = SMART_INTENT_CONFIGURE;
+            else if (strcmp(intent_str, "explain") == 0) intent->primary_intent = SMART_INTENT_EXPLAIN;
+            else if (strcmp(intent_str, "create") == 0) intent->primary_intent = SMART_INTENT_CREATE;
+            else if (strcmp(intent_str, "read") == 0) intent->primary_intent = SMART_INTENT_READ;
+            else if (strcmp(intent_str, "help") == 0) intent->primary_intent = SMART_INTENT_HELP;
+
+            intent->semantic_confidence = (float)ai_json_number(json, "confidence", 0.0);
+            intent->ai_interpretation = ai_json_strdup(json, "interpretation");
+            intent->references_last_error = ai_json_bool(json, "references_context",
+                                                         intent->references_last_error);
+            cJSON_Delete(json);
         }
+        free(response);
     }
 
     /* Calculate overall confidence */
@@ -776,19 +758,20 @@ Decision* smart_agent_decide(SmartAgent* agent, DecisionType type, const char* c
 
         free(ctx);
 
-        char* response = ai_provider_query(agent->ai, prompt, 1024);
-        if (response) {
-            decision->selected_option = json_get_int(response, "selected_option");
-            decision->selection_reasoning = json_get_string(response, "reasoning");
+        char* response = ai_provider_query_structured(agent->ai, prompt, 1024, &DECISION_SCHEMA);
+        cJSON* json = response ? ai_schema_parse(&DECISION_SCHEMA, response, NULL, 0) : NULL;
+        if (json) {
+            decision->selected_option = (int)ai_json_number(json, "selected_option", -1);
+            decision->selection_reasoning = ai_json_strdup(json, "reasoning");
 
             /* Update confidence of selected option */
-            float conf = json_get_float(response, "confidence");
             if (decision->selected_option >= 0 && decision->selected_option < decision->option_count) {
-                decision->options[decision->selected_option]->score = conf;
+                DecisionOption* option = decision->options[decision->selected_option];
+                option->score = (float)ai_json_number(json, "confidence", option->score);
             }
-
-            free(response);
+            cJSON_Delete(json);
         }
+        free(response);
     }
 
     /* Default to highest scored option if AI didn't select */
@@ -0,0 +1,126 @@
+/**
+ * @file bench_compile_db.c
+ * @brief Benchmark of compile_commands.json loading at CMake scale
+ *
+ * Writes a CMake-style compilation database (per-target flag lists that
+ * run to dozens of arguments, per-TU depfile names) with 10k and 100k
+ * entries, then measures the streaming load, how much of the file's text
+ * interning keeps, and the cost of turning every entry into a compile job.
+ *
+ * Usage: bench_compile_db
+ */
+
+#include "cyxmake/distributed/compile_db.h"
+#include "cyxmake/logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define BENCH_DB_FILE "bench_compile_commands.json"
+#define TARGETS 40
+#define DEFINES_PER_TARGET 12
+#define INCLUDES_PER_TARGET 16
+
+static double bench_time_ms(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+#endif
+}
+
+/* Sources are spread over TARGETS targets that each share one flag list */
+static bool write_database(int entries) {
+    FILE* f = fopen(BENCH_DB_FILE, "w");
+    if (!f) return false;
+
+    fprintf(f, "[\n");
+    for (int i = 0; i < entries; i++) {
+        int target = i % TARGETS;
+        fprintf(f, "%s{\n  \"directory\": \"/home/dev/project/build\",\n  \"command\": \"/usr/bin/c++",
+                i ? ",\n" : "");
+        for (int d = 0; d < DEFINES_PER_TARGET; d++) {
+            fprintf(f, " -DTARGET%d_OPTION_%d=1", target, d);
+        }
+        for (int n = 0; n < INCLUDES_PER_TARGET; n++) {
+            fprintf(f, " -I/home/dev/project/modules/target%d/include%d", target, n);
+        }
+        fprintf(f, " -isystem /usr/include/boost -O2 -g -std=gnu++17 -fPIC -Wall -Wextra"
+                " -MD -MT CMakeFiles/t%d.dir/src/file%d.cpp.o -MF CMakeFiles/t%d.dir/src/file%d.cpp.o.d"
+                " -o CMakeFiles/t%d.dir/src/file%d.cpp.o -c /home/dev/project/src/file%d.cpp\",\n"
+                "  \"file\": \"/home/dev/project/src/file%d.cpp\"\n}",
+                target, i, target, i, target, i, i, i);
+    }
+    fprintf(f, "\n]\n");
+    return fclose(f) == 0;
+}
+
+static int run(int entries) {
+    if (!write_database(entries)) {
+        fprintf(stderr, "Failed to write %s\n", BENCH_DB_FILE);
+        return 1;
+    }
+
+    double start = bench_time_ms();
+    CompileDatabase* db = compile_db_load(BENCH_DB_FILE);
+    double load_ms = bench_time_ms() - start;
+    if (!db) {
+        fprintf(stderr, "Failed to load %s\n", BENCH_DB_FILE);
+        remove(BENCH_DB_FILE);
+        return 1;
+    }
+
+    CompileDbStats stats = compile_db_get_stats(db);
+
+    start = bench_time_ms();
+    int made = 0;
+    for (int i = 0; i < compile_db_count(db); i++) {
+        DistributedJob* job = compile_db_make_job(compile_db_get(db, i));
+        if (job) made++;
+        distributed_job_free(job);
+    }
+    double jobs_ms = bench_time_ms() - start;
+
+    double mb = stats.bytes_read / (1024.0 * 1024.0);
+    printf("  %-8d %8.1fMB %9.0fms %8.0fMB/s %9.1fMB %6.1f%% %10.2fus\n",
+           stats.entries, mb, load_ms, load_ms > 0 ? mb * 1000.0 / load_ms : 0.0,
+           stats.string_bytes / (1024.0 * 1024.0),
+           stats.bytes_read ? 100.0 * stats.string_bytes / stats.bytes_read : 0.0,
+           made ? jobs_ms * 1000.0 / made : 0.0);
+
+    compile_db_free(db);
+    remove(BENCH_DB_FILE);
+    return made == entries ? 0 : 1;
+}
+
+int main(void) {
+    log_init(NULL);
+    log_set_level(LOG_LEVEL_ERROR);
+
+    int sizes[] = { 10000, 100000 };
+    int size_count = sizeof(sizes) / sizeof(sizes[0]);
+
+    printf("=== Compilation Database Benchmark ===\n\n");
+    printf("%d targets, %d defines and %d include paths per target\n\n",
+           TARGETS, DEFINES_PER_TARGET, INCLUDES_PER_TARGET);
+    printf("  %-8s %10s %11s %10s %11s %7s %12s\n",
+           "Entries", "File", "Load", "Rate", "Interned", "Kept", "Job/entry");
+
+    int failures = 0;
+    for (int i = 0; i < size_count; i++) {
+        failures += run(sizes[i]);
+    }
+
+    log_shutdown();
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,289 @@
+/**
+ * @file bench_dispatch_latency.c
+ * @brief Benchmark comparing polled and event-driven job dispatch
+ *
+ * Drives the real work scheduler against a loopback worker pool: workers
+ * live in-process and "finish" each job when a timer-wheel timer fires
+ * after its service time. Submissions and completions happen exactly as
+ * they would from the network, so the only difference between modes is
+ * when scheduler_process_queue runs:
+ *
+ *   poll N ms  - every N ms, like the coordinator's old heartbeat loop
+ *   event      - whenever the scheduler raises on_dispatch_needed
+ *
+ * Two workloads are measured per mode: steady arrivals (submit-to-assign
+ * latency percentiles) and a burst submitted at once (throughput).
+ *
+ * Usage: bench_dispatch_latency
+ */
+
+#include "cyxmake/distributed/work_scheduler.h"
+#include "cyxmake/distributed/worker_registry.h"
+#include "cyxmake/distributed/timer_wheel.h"
+#include "cyxmake/threading.h"
+#include "cyxmake/logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WORKERS 8
+#define SLOTS_PER_WORKER 4
+#define STEADY_JOBS 1000
+#define STEADY_INTERVAL_MS 1
+#define BURST_JOBS 640
+#define MIN_SERVICE_MS 5
+#define MAX_SERVICE_MS 15
+
+/* ============================================================
+ * Loopback Farm
+ * ============================================================ */
+
+typedef struct {
+    WorkerRegistry* registry;
+    WorkScheduler* scheduler;
+    TimerWheel* timers;
+
+    DistributedJob* specs;
+    uint64_t* submitted_ms;
+    uint64_t* assigned_ms;
+    int job_count;
+    int submitted;
+    int completed;
+
+    bool dispatch_pending;
+    unsigned int rng;
+} LoopbackFarm;
+
+typedef struct {
+    LoopbackFarm* farm;
+    char job_id[];
+} Completion;
+
+static int job_index(LoopbackFarm* farm, ScheduledJob* job) {
+    return (int)(job->spec - farm->specs);
+}
+
+static void on_service_done(void* user_data) {
+    Completion* done = (Completion*)user_data;
+
+    DistributedJobResult result = {0};
+    result.success = true;
+    result.duration_sec = 0.01;
+    scheduler_report_job_result(done->farm->scheduler, done->job_id, &result);
+    done->farm->completed++;
+}
+
+static void on_assigned(WorkScheduler* scheduler, ScheduledJob* job,
+                        RemoteWorker* worker, void* user_data) {
+    (void)scheduler;
+    (void)worker;
+    LoopbackFarm* farm = (LoopbackFarm*)user_data;
+
+    farm->assigned_ms[job_index(farm, job)] = timer_wheel_now_ms();
+
+    /* The worker runs the job and reports back after its service time */
+    size_t id_len = strlen(job->job_id) + 1;
+    Completion* done = malloc(sizeof(Completion) + id_len);
+    done->farm = farm;
+    memcpy(done->job_id, job->job_id, id_len);
+
+    farm->rng = farm->rng * 1103515245u + 12345u;
+    unsigned int service = MIN_SERVICE_MS + (farm->rng >> 16) % (MAX_SERVICE_MS - MIN_SERVICE_MS + 1);
+    timer_wheel_schedule(farm->timers, service, 0, on_service_done, done, free);
+}
+
+static void on_dispatch(WorkScheduler* scheduler, void* user_data) {
+    (void)scheduler;
+    ((LoopbackFarm*)user_data)->dispatch_pending = true;
+}
+
+static bool farm_init(LoopbackFarm* farm, int job_count) {
+    memset(farm, 0, sizeof(*farm));
+    farm->rng = 12345;
+    farm->job_count = job_count;
+
+    WorkerRegistryConfig reg_config = worker_registry_config_default();
+    farm->registry = worker_registry_create(&reg_config);
+    farm->scheduler = farm->registry ? scheduler_create(NULL, farm->registry) : NULL;
+    farm->timers = timer_wheel_create(1, 256);
+    farm->specs = calloc((size_t)job_count, sizeof(DistributedJob));
+    farm->submitted_ms = calloc((size_t)job_count, sizeof(uint64_t));
+    farm->assigned_ms = calloc((size_t)job_count, sizeof(uint64_t));
+    if (!farm->scheduler || !farm->timers || !farm->specs ||
+        !farm->submitted_ms || !farm->assigned_ms) {
+        return false;
+    }
+
+    WorkerSystemInfo info = {0};
+    info.cpu_cores = SLOTS_PER_WORKER;
+    for (int w = 0; w < WORKERS; w++) {
+        RemoteWorker* worker = worker_registry_register(farm->registry, &info, NULL);
+        if (!worker) return false;
+        worker_registry_set_profile(farm->registry, worker, NULL, 0, SLOTS_PER_WORKER);
+    }
+
+    for (int j = 0; j < job_count; j++) {
+        farm->specs[j].type = JOB_TYPE_CUSTOM;
+        farm->specs[j].build_command = "true";
+    }
+
+    SchedulerCallbacks callbacks = {0};
+    callbacks.on_job_assigned = on_assigned;
+    callbacks.on_dispatch_needed = on_dispatch;
+    callbacks.user_data = farm;
+    scheduler_set_callbacks(farm->scheduler, &callbacks);
+    scheduler_start(farm->scheduler);
+    return true;
+}
+
+static void farm_free(LoopbackFarm* farm) {
+    timer_wheel_free(farm->timers);
+    scheduler_free(farm->scheduler);
+    worker_registry_free(farm->registry);
+    free(farm->specs);
+    free(farm->submitted_ms);
+    free(farm->assigned_ms);
+}
+
+static void farm_submit(LoopbackFarm* farm) {
+    int j = farm->submitted++;
+    farm->submitted_ms[j] = timer_wheel_now_ms();
+    scheduler_submit_job(farm->scheduler, NULL, &farm->specs[j], 0);
+}
+
+/* ============================================================
+ * Driver
+ * ============================================================ */
+
+typedef struct {
+    double p50_ms;
+    double p99_ms;
+    double max_ms;
+    double elapsed_ms;
+    double jobs_per_sec;
+} RunResult;
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * Run one workload
+ * @param poll_ms Poll interval, or 0 for event-driven dispatch
+ * @param arrival_ms Gap between submissions, or 0 to submit everything at once
+ */
+static RunResult run_workload(int job_count, unsigned int poll_ms, unsigned int arrival_ms) {
+    RunResult r = {0};
+    LoopbackFarm farm;
+    if (!farm_init(&farm, job_count)) {
+        fprintf(stderr, "Failed to set up loopback farm\n");
+        farm_free(&farm);
+        return r;
+    }
+
+    uint64_t start = timer_wheel_now_ms();
+    uint64_t next_poll = start + poll_ms;
+    uint64_t next_arrival = start;
+
+    while (farm.completed < job_count) {
+        uint64_t now = timer_wheel_now_ms();
+
+        if (arrival_ms == 0) {
+            while (farm.submitted < job_count) farm_submit(&farm);
+        } else {
+            while (farm.submitted < job_count && now >= next_arrival) {
+                farm_submit(&farm);
+                next_arrival += arrival_ms;
+            }
+        }
+
+        timer_wheel_advance(farm.timers, now);
+
+        if (poll_ms == 0) {
+            if (farm.dispatch_pending) {
+                farm.dispatch_pending = false;
+                scheduler_process_queue(farm.scheduler);
+            }
+        } else if (now >= next_poll) {
+            scheduler_process_queue(farm.scheduler);
+            next_poll = now + poll_ms;
+        }
+
+        /* Sleep until the next completion, arrival or poll */
+        int64_t wait = timer_wheel_next_delay_ms(farm.timers, timer_wheel_now_ms());
+        now = timer_wheel_now_ms();
+        if (poll_ms > 0) {
+            int64_t until_poll = next_poll > now ? (int64_t)(next_poll - now) : 0;
+            if (wait < 0 || until_poll < wait) wait = until_poll;
+        }
+        if (arrival_ms > 0 && farm.submitted < job_count) {
+            int64_t until_arrival = next_arrival > now ? (int64_t)(next_arrival - now) : 0;
+            if (wait < 0 || until_arrival < wait) wait = until_arrival;
+        }
+        if (wait > 0 && (poll_ms > 0 || !farm.dispatch_pending)) {
+            thread_sleep((unsigned int)wait);
+        }
+    }
+
+    r.elapsed_ms = (double)(timer_wheel_now_ms() - start);
+    r.jobs_per_sec = r.elapsed_ms > 0 ? job_count * 1000.0 / r.elapsed_ms : 0;
+
+    uint64_t* latency = malloc(sizeof(uint64_t) * (size_t)job_count);
+    for (int j = 0; j < job_count; j++) {
+        latency[j] = farm.assigned_ms[j] - farm.submitted_ms[j];
+    }
+    qsort(latency, (size_t)job_count, sizeof(uint64_t), compare_u64);
+    r.p50_ms = (double)latency[job_count / 2];
+    r.p99_ms = (double)latency[(job_count * 99) / 100];
+    r.max_ms = (double)latency[job_count - 1];
+    free(latency);
+
+    farm_free(&farm);
+    return r;
+}
+
+/* ============================================================
+ * Main
+ * ============================================================ */
+
+int main(void) {
+    log_init(NULL);
+    log_set_level(LOG_LEVEL_ERROR);
+
+    struct { const char* name; unsigned int poll_ms; } modes[] = {
+        { "poll 100ms", 100 },
+        { "poll 10ms", 10 },
+        { "event", 0 }
+    };
+    int mode_count = sizeof(modes) / sizeof(modes[0]);
+
+    printf("=== Dispatch Latency Benchmark ===\n\n");
+    printf("Loopback farm: %d workers x %d slots, %d-%dms per job\n\n",
+           WORKERS, SLOTS_PER_WORKER, MIN_SERVICE_MS, MAX_SERVICE_MS);
+
+    printf("Steady arrivals: %d jobs, one every %dms (submit-to-assign latency)\n",
+           STEADY_JOBS, STEADY_INTERVAL_MS);
+    printf("  %-12s %10s %10s %10s\n", "Mode", "p50", "p99", "max");
+    for (int m = 0; m < mode_count; m++) {
+        RunResult r = run_workload(STEADY_JOBS, modes[m].poll_ms, STEADY_INTERVAL_MS);
+        printf("  %-12s %8.1fms %8.1fms %8.1fms\n", modes[m].name, r.p50_ms, r.p99_ms, r.max_ms);
+    }
+
+    printf("\nBurst: %d jobs submitted at once (end-to-end throughput)\n", BURST_JOBS);
+    printf("  %-12s %10s %12s\n", "Mode", "Elapsed", "Throughput");
+    double slowest = 0, fastest = 0;
+    for (int m = 0; m < mode_count; m++) {
+        RunResult r = run_workload(BURST_JOBS, modes[m].poll_ms, 0);
+        printf("  %-12s %8.0fms %8.0f jobs/s\n", modes[m].name, r.elapsed_ms, r.jobs_per_sec);
+        if (m == 0) slowest = r.jobs_per_sec;
+        if (m == mode_count - 1) fastest = r.jobs_per_sec;
+    }
+
+    if (slowest > 0) {
+        printf("\nEvent-driven vs 100ms polling: %.1fx throughput\n", fastest / slowest);
+    }
+
+    log_shutdown();
+    return 0;
+}
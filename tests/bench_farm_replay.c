@@ -0,0 +1,717 @@
+/**
+ * @file bench_farm_replay.c
+ * @brief Load benchmark of a real coordinator driving a simulated worker farm
+ *
+ * Starts a Coordinator on loopback and connects N simulated workers over
+ * the real transport. Workers advertise a number of job slots, accept every
+ * job they are sent, and report it complete (or failed, at a configurable
+ * rate) after a fixed latency plus the job's duration scaled down by
+ * --time-scale. The workers run in a forked process so the coordinator's
+ * CPU time can be measured on its own.
+ *
+ * The build is replayed twice: a cold pass with no duration history, and a
+ * warm pass where the scheduler has learned every job's duration and can
+ * prioritize the critical path. Each pass reports:
+ *
+ *   dispatch   - time from a job becoming ready (its last dependency
+ *                reported complete) to a worker receiving it, p50/p90/p99
+ *   msgs/s     - protocol messages exchanged with workers per second
+ *   makespan   - build start to completion, against the lower bound
+ *   cpu        - coordinator process CPU time over the pass
+ *
+ * Without a trace a synthetic build is generated (the same shape as
+ * bench_schedule_sim). Pass a trace recorded by the coordinator
+ * (trace_path) to replay a real one.
+ *
+ * Usage: bench_farm_replay [--workers N] [--slots N] [--latency-ms N]
+ *                          [--failure-rate F] [--time-scale F] [--batch N]
+ *                          [--port N] [trace_file [build_id]]
+ */
+
+#include "cyxmake/distributed/distributed.h"
+#include "cyxmake/distributed/schedule_sim.h"
+#include "cyxmake/threading.h"
+#include "cyxmake/logger.h"
+#include <cJSON.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#define SYNTH_LIBRARIES 8
+#define SYNTH_SOURCES_PER_LIB 60
+#define SYNTH_GENERATORS 3
+
+#define BENCH_TOKEN "bench-farm-token"
+#define CONNECT_TIMEOUT_MS 30000
+#define BUILD_TIMEOUT_MS 600000
+#define WORKER_HEARTBEAT_MS 10000
+#define PASS_COUNT 2
+
+typedef struct {
+    int workers;
+    int slots;
+    unsigned int latency_ms;
+    double failure_rate;
+    double time_scale;            /* Wall-clock seconds per recorded second */
+    int batch;
+    int port;
+    const char* trace_path;
+    const char* build_id;
+} FarmOptions;
+
+static FarmOptions options = {
+    .workers = 8,
+    .slots = 4,
+    .latency_ms = 2,
+    .failure_rate = 0.0,
+    .time_scale = 0.01,
+    .batch = 1,
+    .port = 19876,
+    .trace_path = NULL,
+    .build_id = NULL
+};
+
+#ifndef _WIN32
+
+/* ============================================================
+ * Synthetic Build
+ * ============================================================ */
+
+static unsigned int rng_state = 12345;
+
+static double next_random(void) {
+    rng_state = rng_state * 1103515245u + 12345u;
+    return ((rng_state >> 8) & 0xFFFF) / 65536.0;
+}
+
+static int* make_deps(int count) {
+    return count > 0 ? malloc(sizeof(int) * (size_t)count) : NULL;
+}
+
+static SimTrace* make_synthetic_build(void) {
+    int compiles = SYNTH_LIBRARIES * SYNTH_SOURCES_PER_LIB;
+    int total = SYNTH_GENERATORS + compiles + SYNTH_LIBRARIES + 1;
+
+    SimTrace* trace = calloc(1, sizeof(SimTrace));
+    trace->build_id = strdup("synthetic");
+    trace->jobs = calloc((size_t)total, sizeof(SimJob));
+    trace->count = total;
+
+    int n = 0;
+    int generators = n;
+    for (int g = 0; g < SYNTH_GENERATORS; g++) {
+        trace->jobs[n++].duration_sec = 6.0 + 4.0 * g;
+    }
+
+    int first_compile = n;
+    for (int lib = 0; lib < SYNTH_LIBRARIES; lib++) {
+        for (int s = 0; s < SYNTH_SOURCES_PER_LIB; s++) {
+            SimJob* job = &trace->jobs[n++];
+            double r = next_random();
+            job->duration_sec = r < 0.9 ? 0.5 + 2.0 * next_random() : 15.0 + 25.0 * next_random();
+            if (s >= SYNTH_SOURCES_PER_LIB - 4) {
+                job->deps = make_deps(1);
+                job->deps[job->dep_count++] = generators + lib % SYNTH_GENERATORS;
+            }
+        }
+    }
+
+    int first_link = n;
+    for (int lib = 0; lib < SYNTH_LIBRARIES; lib++) {
+        SimJob* job = &trace->jobs[n++];
+        job->duration_sec = 3.0;
+        job->deps = make_deps(SYNTH_SOURCES_PER_LIB);
+        for (int s = 0; s < SYNTH_SOURCES_PER_LIB; s++) {
+            job->deps[job->dep_count++] = first_compile + lib * SYNTH_SOURCES_PER_LIB + s;
+        }
+    }
+
+    SimJob* final_link = &trace->jobs[n++];
+    final_link->duration_sec = 8.0;
+    final_link->deps = make_deps(SYNTH_LIBRARIES);
+    for (int lib = 0; lib < SYNTH_LIBRARIES; lib++) {
+        final_link->deps[final_link->dep_count++] = first_link + lib;
+    }
+
+    return trace;
+}
+
+static double bench_time_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/* ============================================================
+ * Shared State
+ * ============================================================ */
+
+typedef struct {
+    double received_ms;           /* First time a worker received the job */
+    double completed_ms;          /* Successful completion reported */
+    int attempts;
+} JobTiming;
+
+/* Mapped shared between the coordinator and the worker process */
+typedef struct {
+    volatile int go;              /* Coordinator listening: workers connect */
+    volatile int stop;            /* Workers disconnect and exit */
+    volatile long messages;       /* Sent and received by workers */
+    volatile int injected_failures;
+    JobTiming jobs[];
+} FarmShared;
+
+static FarmShared* shared_create(int job_count) {
+    size_t size = sizeof(FarmShared) + sizeof(JobTiming) * (size_t)job_count;
+    void* mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) return NULL;
+    memset(mem, 0, size);
+    return (FarmShared*)mem;
+}
+
+/* ============================================================
+ * Simulated Workers (worker process)
+ * ============================================================ */
+
+typedef struct FarmWorkers FarmWorkers;
+
+typedef struct {
+    FarmWorkers* farm;
+    NetworkClient* net;
+    int index;
+} FarmWorker;
+
+struct FarmWorkers {
+    MutexHandle mutex;            /* Guards timers, rng and sends */
+    TimerWheel* timers;
+    FarmShared* shared;
+    const SimTrace* trace;
+    FarmWorker* workers;
+    unsigned int rng;
+};
+
+typedef struct {
+    FarmWorker* worker;
+    int job;
+    bool fail;
+    char job_id[];
+} Completion;
+
+/* Caller holds the farm mutex */
+static void send_message(FarmWorker* worker, ProtocolMessageType type,
+                         const char* job_id, const char* payload) {
+    ProtocolMessage* msg = protocol_message_create(type);
+    if (!msg) return;
+    if (job_id) msg->correlation_id = strdup(job_id);
+    if (payload) protocol_message_set_payload(msg, payload);
+    if (network_client_send(worker->net, msg)) {
+        worker->farm->shared->messages++;
+    }
+    protocol_message_free(msg);
+}
+
+static void on_job_done(void* user_data) {
+    Completion* done = (Completion*)user_data;
+    FarmWorker* worker = done->worker;
+
+    DistributedJobResult result = {0};
+    result.job_id = done->job_id;
+    result.success = !done->fail;
+    result.exit_code = done->fail ? 1 : 0;
+    result.duration_sec = worker->farm->trace->jobs[done->job].duration_sec *
+                          options.time_scale;
+
+    char* json = distributed_job_result_to_json(&result);
+    send_message(worker, done->fail ? PROTO_MSG_JOB_FAILED : PROTO_MSG_JOB_COMPLETE,
+                 done->job_id, json);
+    free(json);
+
+    if (!done->fail) {
+        worker->farm->shared->jobs[done->job].completed_ms = bench_time_ms();
+    }
+}
+
+static void on_heartbeat(void* user_data) {
+    FarmWorker* worker = (FarmWorker*)user_data;
+    if (network_client_is_connected(worker->net)) {
+        send_message(worker, PROTO_MSG_HEARTBEAT, NULL, NULL);
+    }
+}
+
+/* Accept a job and finish it after its scaled duration; caller holds the mutex */
+static void start_job(FarmWorker* worker, const char* job_json, const char* job_id) {
+    FarmWorkers* farm = worker->farm;
+    DistributedJob* job = job_json ? distributed_job_from_json(job_json) : NULL;
+
+    int index = -1;
+    if (!job || !job_id || !job->output_file ||
+        sscanf(job->output_file, "bench/%d.out", &index) != 1 ||
+        index < 0 || index >= farm->trace->count) {
+        distributed_job_free(job);
+        return;
+    }
+    distributed_job_free(job);
+
+    JobTiming* timing = &farm->shared->jobs[index];
+    if (timing->attempts++ == 0) {
+        timing->received_ms = bench_time_ms();
+    }
+
+    char accept[160];
+    snprintf(accept, sizeof(accept), "{\"job_id\":\"%s\"}", job_id);
+    send_message(worker, PROTO_MSG_JOB_ACCEPT, job_id, accept);
+
+    size_t id_len = strlen(job_id) + 1;
+    Completion* done = malloc(sizeof(Completion) + id_len);
+    if (!done) return;
+    done->worker = worker;
+    done->job = index;
+    memcpy(done->job_id, job_id, id_len);
+
+    farm->rng = farm->rng * 1103515245u + 12345u;
+    done->fail = ((farm->rng >> 8) & 0xFFFF) / 65536.0 < options.failure_rate;
+    if (done->fail) farm->shared->injected_failures++;
+
+    double run_ms = farm->trace->jobs[index].duration_sec * options.time_scale * 1000.0;
+    timer_wheel_schedule(farm->timers, options.latency_ms + (unsigned int)run_ms, 0,
+                         on_job_done, done, free);
+}
+
+static void on_worker_message(NetworkConnection* conn, ProtocolMessage* msg,
+                              void* user_data) {
+    (void)conn;
+    FarmWorker* worker = (FarmWorker*)user_data;
+    FarmWorkers* farm = worker->farm;
+
+    mutex_lock(&farm->mutex);
+    farm->shared->messages++;
+
+    if (msg->type == PROTO_MSG_JOB_REQUEST) {
+        start_job(worker, msg->payload_json, msg->correlation_id);
+    } else if (msg->type == PROTO_MSG_JOB_BATCH) {
+        cJSON* payload = msg->payload_json ? cJSON_Parse(msg->payload_json) : NULL;
+        cJSON* item;
+        cJSON_ArrayForEach(item, cJSON_GetObjectItem(payload, "jobs")) {
+            cJSON* id = cJSON_GetObjectItem(item, "job_id");
+            char* json = cJSON_PrintUnformatted(item);
+            start_job(worker, json, cJSON_IsString(id) ? id->valuestring : NULL);
+            free(json);
+        }
+        cJSON_Delete(payload);
+    }
+
+    mutex_unlock(&farm->mutex);
+}
+
+static void on_worker_connect(NetworkConnection* conn, void* user_data) {
+    (void)conn;
+    FarmWorker* worker = (FarmWorker*)user_data;
+
+    char hello[256];
+    snprintf(hello, sizeof(hello),
+             "{\"name\":\"sim-%d\",\"cpu_cores\":%d,\"max_jobs\":%d,"
+             "\"capabilities\":[\"COMPILE_C\",\"COMPILE_CPP\",\"JOB_BATCH\"],"
+             "\"auth_token\":\"" BENCH_TOKEN "\"}",
+             worker->index, options.slots, options.slots);
+
+    mutex_lock(&worker->farm->mutex);
+    send_message(worker, PROTO_MSG_HELLO, NULL, hello);
+    mutex_unlock(&worker->farm->mutex);
+}
+
+static void run_workers(FarmShared* shared, const SimTrace* trace) {
+    FarmWorkers farm = {0};
+    farm.shared = shared;
+    farm.trace = trace;
+    farm.rng = 54321;
+    farm.timers = timer_wheel_create(1, 1024);
+    farm.workers = calloc((size_t)options.workers, sizeof(FarmWorker));
+    if (!farm.timers || !farm.workers || !mutex_init(&farm.mutex)) {
+        fprintf(stderr, "Failed to set up simulated workers\n");
+        return;
+    }
+
+    while (!shared->go && !shared->stop) thread_sleep(1);
+
+    char url[64];
+    snprintf(url, sizeof(url), "ws://127.0.0.1:%d", options.port);
+
+    NetworkConfig net_config = {0};
+    net_config.connection_timeout_sec = 10;
+    net_config.ping_interval_sec = 30;
+    net_config.wire_format = PROTO_WIRE_BINARY;
+
+    for (int w = 0; w < options.workers && !shared->stop; w++) {
+        FarmWorker* worker = &farm.workers[w];
+        worker->farm = &farm;
+        worker->index = w;
+        worker->net = network_client_create(&net_config);
+        if (!worker->net) continue;
+
+        NetworkClientCallbacks callbacks = {0};
+        callbacks.on_message = on_worker_message;
+        callbacks.on_connect = on_worker_connect;
+        callbacks.user_data = worker;
+        network_client_set_callbacks(worker->net, &callbacks);
+        network_client_connect(worker->net, url);
+
+        mutex_lock(&farm.mutex);
+        timer_wheel_schedule(farm.timers, WORKER_HEARTBEAT_MS, WORKER_HEARTBEAT_MS,
+                             on_heartbeat, worker, NULL);
+        mutex_unlock(&farm.mutex);
+    }
+
+    while (!shared->stop) {
+        mutex_lock(&farm.mutex);
+        timer_wheel_advance(farm.timers, timer_wheel_now_ms());
+        mutex_unlock(&farm.mutex);
+        thread_sleep(1);
+    }
+
+    for (int w = 0; w < options.workers; w++) {
+        if (!farm.workers[w].net) continue;
+        network_client_disconnect(farm.workers[w].net);
+        network_client_free(farm.workers[w].net);
+    }
+    timer_wheel_free(farm.timers);
+    mutex_destroy(&farm.mutex);
+    free(farm.workers);
+}
+
+/* ============================================================
+ * Coordinator Side
+ * ============================================================ */
+
+typedef struct {
+    const char* build_id;
+    volatile int done;
+    volatile double done_ms;
+    volatile int success;
+} PassState;
+
+static PassState current_pass;
+
+static void on_build_completed(Coordinator* coord, BuildSession* build, void* user_data) {
+    (void)coord;
+    (void)user_data;
+    if (!current_pass.build_id || strcmp(build->build_id, current_pass.build_id) != 0) return;
+    current_pass.done_ms = bench_time_ms();
+    current_pass.success = build->success;
+    current_pass.done = 1;
+}
+
+static double cpu_time_ms(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec * 1000.0 + usage.ru_utime.tv_usec / 1000.0 +
+           usage.ru_stime.tv_sec * 1000.0 + usage.ru_stime.tv_usec / 1000.0;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+static double percentile(const double* sorted, int count, int pct) {
+    return count > 0 ? sorted[(count - 1) * pct / 100] : 0.0;
+}
+
+/**
+ * Submit the build with dispatch held until every dependency is wired up,
+ * run it to completion and print one result row
+ */
+static bool run_pass(Coordinator* coord, FarmShared* shared, const SimTrace* trace,
+                     DistributedJob* specs, const char* label, double bound_ms) {
+    WorkScheduler* sched = coordinator_get_scheduler(coord);
+
+    memset(shared->jobs, 0, sizeof(JobTiming) * (size_t)trace->count);
+    shared->injected_failures = 0;
+
+    BuildSession* build = scheduler_create_build(sched, "bench-farm", DIST_STRATEGY_COMPILE_UNITS);
+    ScheduledJob** jobs = calloc((size_t)trace->count, sizeof(ScheduledJob*));
+    if (!build || !jobs) {
+        free(jobs);
+        return false;
+    }
+
+    scheduler_stop(sched);
+    for (int j = 0; j < trace->count; j++) {
+        jobs[j] = scheduler_submit_job(sched, build->build_id, &specs[j], 0);
+        if (!jobs[j]) {
+            fprintf(stderr, "Failed to submit job %d\n", j);
+            scheduler_start(sched);
+            free(jobs);
+            return false;
+        }
+    }
+    for (int j = 0; j < trace->count; j++) {
+        for (int d = 0; d < trace->jobs[j].dep_count; d++) {
+            scheduler_add_job_dependency(sched, jobs[j], jobs[trace->jobs[j].deps[d]]->job_id);
+        }
+    }
+    free(jobs);
+
+    memset(&current_pass, 0, sizeof(current_pass));
+    current_pass.build_id = build->build_id;
+    long messages_before = shared->messages;
+    double cpu_before = cpu_time_ms();
+    double start_ms = bench_time_ms();
+
+    scheduler_start(sched);
+    scheduler_start_build(sched, build->build_id);
+
+    while (!current_pass.done && bench_time_ms() - start_ms < BUILD_TIMEOUT_MS) {
+        thread_sleep(5);
+    }
+    if (!current_pass.done) {
+        printf("  %-6s build did not finish within %ds\n", label, BUILD_TIMEOUT_MS / 1000);
+        return false;
+    }
+
+    double makespan_ms = current_pass.done_ms - start_ms;
+    double cpu_ms = cpu_time_ms() - cpu_before;
+    long messages = shared->messages - messages_before;
+
+    /* Ready when the last dependency reported; retried jobs are left out */
+    double* latency = malloc(sizeof(double) * (size_t)trace->count);
+    int samples = 0;
+    for (int j = 0; latency && j < trace->count; j++) {
+        const JobTiming* t = &shared->jobs[j];
+        if (t->attempts != 1 || t->received_ms <= 0) continue;
+
+        double ready_ms = start_ms;
+        for (int d = 0; d < trace->jobs[j].dep_count; d++) {
+            double dep_done = shared->jobs[trace->jobs[j].deps[d]].completed_ms;
+            if (dep_done > ready_ms) ready_ms = dep_done;
+        }
+        latency[samples++] = t->received_ms > ready_ms ? t->received_ms - ready_ms : 0.0;
+    }
+    if (latency) qsort(latency, (size_t)samples, sizeof(double), compare_double);
+
+    printf("  %-6s %7.2fms %7.2fms %7.2fms %9.0f %9.0fms %7.2fx %8.0fms %5.1f%%%s\n",
+           label,
+           percentile(latency, samples, 50),
+           percentile(latency, samples, 90),
+           percentile(latency, samples, 99),
+           makespan_ms > 0 ? messages * 1000.0 / makespan_ms : 0.0,
+           makespan_ms,
+           bound_ms > 0 ? makespan_ms / bound_ms : 0.0,
+           cpu_ms,
+           makespan_ms > 0 ? 100.0 * cpu_ms / makespan_ms : 0.0,
+           current_pass.success ? "" : "  (build failed)");
+    if (shared->injected_failures > 0) {
+        printf("         %d injected failures\n", shared->injected_failures);
+    }
+
+    free(latency);
+    return true;
+}
+
+static bool wait_for_workers(Coordinator* coord) {
+    WorkerRegistry* registry = coordinator_get_registry(coord);
+    double start = bench_time_ms();
+    while (worker_registry_get_online_count(registry) < options.workers) {
+        if (bench_time_ms() - start > CONNECT_TIMEOUT_MS) return false;
+        thread_sleep(5);
+    }
+    return true;
+}
+
+static int run_farm(SimTrace* trace) {
+    int count = trace->count;
+    FarmShared* shared = shared_create(count);
+    DistributedJob* specs = calloc((size_t)count, sizeof(DistributedJob));
+    char** names = calloc((size_t)count * 2, sizeof(char*));
+    if (!shared || !specs || !names) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    /* Jobs waiting on several others are links; the rest compile */
+    for (int j = 0; j < count; j++) {
+        char name[48];
+        snprintf(name, sizeof(name), "bench/%d.c", j);
+        names[j * 2] = strdup(name);
+        snprintf(name, sizeof(name), "bench/%d.out", j);
+        names[j * 2 + 1] = strdup(name);
+
+        specs[j].type = trace->jobs[j].dep_count > 1 ? JOB_TYPE_LINK : JOB_TYPE_COMPILE;
+        specs[j].source_file = names[j * 2];
+        specs[j].output_file = names[j * 2 + 1];
+        specs[j].compiler = "cc";
+    }
+
+    /* Fork before the coordinator starts any threads */
+    pid_t child = fork();
+    if (child < 0) {
+        perror("fork");
+        return 1;
+    }
+    if (child == 0) {
+        run_workers(shared, trace);
+        _exit(0);
+    }
+
+    char history_path[256];
+    const char* tmp = getenv("TMPDIR");
+    snprintf(history_path, sizeof(history_path), "%s/cyxmake-farm-%d.history",
+             tmp ? tmp : "/tmp", (int)getpid());
+
+    DistributedCoordinatorConfig config = distributed_coordinator_config_default();
+    config.port = (uint16_t)options.port;
+    config.bind_address = "127.0.0.1";
+    config.auth_token = BENCH_TOKEN;
+    config.history_path = history_path;
+    config.max_batch_size = options.batch;
+    config.max_workers = options.workers;
+    config.max_pending_jobs = count;
+    config.enable_cache = false;
+
+    Coordinator* coord = distributed_coordinator_create(&config);
+    CoordinatorCallbacks callbacks = {0};
+    callbacks.on_build_completed = on_build_completed;
+    if (coord) coordinator_set_callbacks(coord, &callbacks);
+
+    int status = 1;
+    if (!coord || !coordinator_start(coord)) {
+        fprintf(stderr, "Failed to start coordinator on port %d\n", options.port);
+    } else {
+        shared->go = 1;
+        if (!wait_for_workers(coord)) {
+            fprintf(stderr, "Only %d of %d workers connected\n",
+                    worker_registry_get_online_count(coordinator_get_registry(coord)),
+                    options.workers);
+        } else {
+            SimWorker* farm = calloc((size_t)options.workers, sizeof(SimWorker));
+            for (int w = 0; farm && w < options.workers; w++) {
+                farm[w].slots = options.slots;
+                farm[w].speed = options.time_scale;
+            }
+            double bound_ms = farm ? 1000.0 * schedule_lower_bound(trace->jobs, count,
+                                                                  farm, options.workers) : 0.0;
+            free(farm);
+
+            printf("  %-6s %9s %9s %9s %9s %11s %8s %10s %6s\n", "Pass", "p50", "p90", "p99",
+                   "msgs/s", "Makespan", "vs bound", "Coord CPU", "");
+            const char* labels[PASS_COUNT] = { "cold", "warm" };
+            status = 0;
+            for (int p = 0; p < PASS_COUNT && status == 0; p++) {
+                if (!run_pass(coord, shared, trace, specs, labels[p], bound_ms)) status = 1;
+            }
+            printf("\nLower bound: %.0fms (critical path or work / slots, no latency)\n",
+                   bound_ms);
+        }
+    }
+
+    shared->stop = 1;
+    waitpid(child, NULL, 0);
+    printf("Messages exchanged: %ld\n", shared->messages);
+
+    if (coord) {
+        coordinator_stop(coord);
+        distributed_coordinator_free(coord);
+    }
+    remove(history_path);
+
+    for (int j = 0; j < count * 2; j++) free(names[j]);
+    free(names);
+    free(specs);
+    munmap(shared, sizeof(FarmShared) + sizeof(JobTiming) * (size_t)count);
+    return status;
+}
+
+#endif /* !_WIN32 */
+
+/* ============================================================
+ * Main
+ * ============================================================ */
+
+static bool parse_options(int argc, char** argv) {
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--workers") == 0 && value) {
+            options.workers = atoi(argv[++i]);
+        } else if (strcmp(arg, "--slots") == 0 && value) {
+            options.slots = atoi(argv[++i]);
+        } else if (strcmp(arg, "--latency-ms") == 0 && value) {
+            options.latency_ms = (unsigned int)atoi(argv[++i]);
+        } else if (strcmp(arg, "--failure-rate") == 0 && value) {
+            options.failure_rate = atof(argv[++i]);
+        } else if (strcmp(arg, "--time-scale") == 0 && value) {
+            options.time_scale = atof(argv[++i]);
+        } else if (strcmp(arg, "--batch") == 0 && value) {
+            options.batch = atoi(argv[++i]);
+        } else if (strcmp(arg, "--port") == 0 && value) {
+            options.port = atoi(argv[++i]);
+        } else if (arg[0] != '-' && positional == 0) {
+            options.trace_path = arg;
+            positional++;
+        } else if (arg[0] != '-' && positional == 1) {
+            options.build_id = arg;
+            positional++;
+        } else {
+            return false;
+        }
+    }
+    return options.workers > 0 && options.slots > 0 && options.time_scale > 0 &&
+           options.batch > 0 && options.port > 0 && options.port < 65536;
+}
+
+int main(int argc, char** argv) {
+    if (!parse_options(argc, argv)) {
+        fprintf(stderr, "Usage: %s [--workers N] [--slots N] [--latency-ms N] "
+                "[--failure-rate F] [--time-scale F] [--batch N] [--port N] "
+                "[trace_file [build_id]]\n", argv[0]);
+        return 1;
+    }
+
+    printf("=== Build Farm Replay Benchmark ===\n\n");
+
+    if (!distributed_is_available()) {
+        printf("Distributed builds are not compiled in; nothing to measure\n");
+        return 0;
+    }
+
+#ifdef _WIN32
+    printf("Simulated workers run in a forked process; not supported on Windows\n");
+    return 0;
+#else
+    SimTrace* trace = options.trace_path ?
+                      schedule_trace_load(options.trace_path, options.build_id) :
+                      make_synthetic_build();
+    if (!trace) {
+        fprintf(stderr, "Failed to load build trace\n");
+        return 1;
+    }
+
+    log_init(NULL);
+    log_set_level(LOG_LEVEL_ERROR);
+
+    double work = 0.0;
+    for (int j = 0; j < trace->count; j++) {
+        work += trace->jobs[j].duration_sec;
+    }
+    printf("Build %s: %d jobs, %.1fs of work, replayed at %.3fx\n",
+           trace->build_id, trace->count, work, options.time_scale);
+    printf("Farm: %d workers x %d slots, %ums latency, %.1f%% failures, batch %d\n\n",
+           options.workers, options.slots, options.latency_ms,
+           100.0 * options.failure_rate, options.batch);
+
+    int status = run_farm(trace);
+
+    schedule_trace_free(trace);
+    log_shutdown();
+    return status;
+#endif
+}
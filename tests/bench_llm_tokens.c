@@ -0,0 +1,289 @@
+/**
+ * @file bench_llm_tokens.c
+ * @brief Benchmark of local llama.cpp prompt and generation throughput
+ *
+ * Feeds a synthetic build log of a given size to the local model and
+ * reports prompt-processing and generation tokens/sec separately, for each
+ * prompt batch size. A last row re-sends the log with only the question at
+ * the end changed, which is served mostly from the KV cache.
+ *
+ * A second table compares N agents querying one after another with the
+ * same N queries submitted at once and served as parallel sequences.
+ *
+ * Needs a GGUF model; exits quietly if none is found.
+ *
+ * Usage: bench_llm_tokens [--model PATH] [--prompt-tokens N] [--gen-tokens N]
+ *                         [--threads N] [--batch-threads N] [--batch N,N,...]
+ *                         [--ubatch N] [--runs N] [--parallel N]
+ */
+
+#include "cyxmake/llm_interface.h"
+#include "cyxmake/threading.h"
+#include "cyxmake/logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_BATCH_SIZES 8
+
+typedef struct {
+    double prompt_tps;
+    double gen_tps;
+    int prompt_tokens;
+    int reused_tokens;
+    int gen_tokens;
+} RunResult;
+
+static double bench_time_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/* Compiler output of roughly the requested token count, then a question */
+static char* build_prompt(int tokens, const char* question) {
+    size_t cap = (size_t)tokens * 4 + 1024;
+    char* prompt = malloc(cap);
+    if (!prompt) return NULL;
+
+    size_t len = (size_t)snprintf(prompt, cap, "Build output:\n```\n");
+    for (int i = 0; llm_estimate_tokens(prompt) < tokens; i++) {
+        len += (size_t)snprintf(prompt + len, cap - len,
+                                "src/module%d/file%d.c:%d:%d: error: implicit declaration "
+                                "of function 'helper_%d' [-Wimplicit-function-declaration]\n",
+                                i % 7, i, 10 + i % 300, 5 + i % 40, i);
+        if (len + 256 >= cap) break;
+    }
+    snprintf(prompt + len, cap - len, "```\n\n%s\n", question);
+    return prompt;
+}
+
+static bool run_query(LLMContext* llm, const char* prompt, int gen_tokens, RunResult* out) {
+    LLMRequest* request = llm_request_create(prompt);
+    request->max_tokens = gen_tokens;
+    request->temperature = 0.0f;
+
+    LLMResponse* response = llm_query(llm, request);
+    llm_request_free(request);
+    if (!response || !response->success) {
+        llm_response_free(response);
+        return false;
+    }
+
+    int evaluated = response->tokens_prompt - response->tokens_reused;
+    out->prompt_tokens = response->tokens_prompt;
+    out->reused_tokens = response->tokens_reused;
+    out->gen_tokens = response->tokens_generated;
+    out->prompt_tps = response->prompt_sec > 0 ? evaluated / response->prompt_sec : 0.0;
+    out->gen_tps = response->generation_sec > 0
+                       ? response->tokens_generated / response->generation_sec : 0.0;
+    llm_response_free(response);
+    return true;
+}
+
+/* Submit count queries, all at once if concurrent, and time them together */
+static bool run_agents(LLMContext* llm, const char* prompt, int gen_tokens, int count,
+                       bool concurrent, double* tokens_per_sec) {
+    LLMFuture* futures[64];
+    int generated = 0;
+    bool ok = true;
+
+    LLMRequest* request = llm_request_create(prompt);
+    request->max_tokens = gen_tokens;
+    request->temperature = 0.0f;
+
+    double start = bench_time_ms();
+    int submitted = 0;
+    for (int i = 0; i < count && ok; i++) {
+        futures[submitted++] = llm_query_async(llm, request);
+        if (concurrent && i < count - 1) continue;
+
+        for (int f = 0; f < submitted; f++) {
+            LLMResponse* response = llm_future_wait(futures[f]);
+            ok = ok && response && response->success;
+            if (response) generated += response->tokens_generated;
+            llm_response_free(response);
+            llm_future_free(futures[f]);
+        }
+        submitted = 0;
+    }
+    double elapsed = (bench_time_ms() - start) / 1000.0;
+    llm_request_free(request);
+
+    *tokens_per_sec = elapsed > 0 ? generated / elapsed : 0.0;
+    return ok;
+}
+
+static void print_row(const char* label, RunResult* runs, int count) {
+    double prompt_tps[16], gen_tps[16];
+    for (int i = 0; i < count; i++) {
+        prompt_tps[i] = runs[i].prompt_tps;
+        gen_tps[i] = runs[i].gen_tps;
+    }
+    qsort(prompt_tps, (size_t)count, sizeof(double), compare_double);
+    qsort(gen_tps, (size_t)count, sizeof(double), compare_double);
+
+    printf("  %-10s %8d %8d %12.1f %8d %12.1f\n", label,
+           runs[0].prompt_tokens, runs[0].reused_tokens, prompt_tps[count / 2],
+           runs[0].gen_tokens, gen_tps[count / 2]);
+}
+
+int main(int argc, char** argv) {
+    char* model_path = NULL;
+    int prompt_tokens = 2000;
+    int gen_tokens = 64;
+    int threads = 0;
+    int batch_threads = 0;
+    int ubatch = 0;
+    int runs = 3;
+    int parallel = 4;
+    int batch_sizes[MAX_BATCH_SIZES] = { 128, 512, 2048 };
+    int batch_count = 3;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--model") == 0 && i + 1 < argc) {
+            model_path = strdup(argv[++i]);
+        } else if (strcmp(argv[i], "--prompt-tokens") == 0 && i + 1 < argc) {
+            prompt_tokens = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--gen-tokens") == 0 && i + 1 < argc) {
+            gen_tokens = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--batch-threads") == 0 && i + 1 < argc) {
+            batch_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ubatch") == 0 && i + 1 < argc) {
+            ubatch = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--parallel") == 0 && i + 1 < argc) {
+            parallel = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch_count = 0;
+            for (char* item = strtok(argv[++i], ","); item && batch_count < MAX_BATCH_SIZES;
+                 item = strtok(NULL, ",")) {
+                batch_sizes[batch_count++] = atoi(item);
+            }
+        } else {
+            fprintf(stderr, "Usage: %s [--model PATH] [--prompt-tokens N] [--gen-tokens N] "
+                            "[--threads N] [--batch-threads N] [--batch N,N,...] "
+                            "[--ubatch N] [--runs N] [--parallel N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (runs < 1) runs = 1;
+    if (runs > 16) runs = 16;
+    if (parallel < 1) parallel = 1;
+    if (parallel > 64) parallel = 64;
+
+    log_init(NULL);
+    log_set_level(LOG_LEVEL_ERROR);
+
+    if (!model_path) model_path = llm_get_default_model_path();
+    if (!model_path || !llm_validate_model_file(model_path)) {
+        printf("No GGUF model at %s, skipping (use --model PATH)\n",
+               model_path ? model_path : "(unknown)");
+        free(model_path);
+        log_shutdown();
+        return 0;
+    }
+
+    char* prompt = build_prompt(prompt_tokens, "What is the most likely cause?");
+    char* follow_up = build_prompt(prompt_tokens, "Which header should be included?");
+    if (!prompt || !follow_up) return 1;
+
+    int cores = thread_get_physical_core_count();
+    printf("=== Local Inference Throughput Benchmark ===\n\n");
+    printf("%s\n", model_path);
+    printf("~%d prompt tokens, up to %d generated, %d physical cores (%d logical)\n",
+           prompt_tokens, gen_tokens, cores, thread_get_cpu_count());
+    printf("Threads: %d generation, %d prompt; median of %d runs\n\n",
+           threads > 0 ? threads : cores, batch_threads > 0 ? batch_threads : cores, runs);
+    printf("  %-10s %8s %8s %12s %8s %12s\n",
+           "Batch", "Prompt", "Reused", "Prompt t/s", "Gen", "Gen t/s");
+
+    int failures = 0;
+    RunResult results[16];
+    for (int b = 0; b < batch_count; b++) {
+        LLMConfig* config = llm_config_default();
+        config->model_path = model_path;
+        config->n_ctx = prompt_tokens + gen_tokens + 512;
+        config->n_threads = threads;
+        config->n_threads_batch = batch_threads;
+        config->n_batch = batch_sizes[b];
+        config->n_ubatch = ubatch > 0 ? ubatch : batch_sizes[b];
+
+        LLMContext* llm = llm_init(config);
+        llm_config_free(config);
+        if (!llm) {
+            fprintf(stderr, "Failed to load model with batch %d\n", batch_sizes[b]);
+            failures++;
+            continue;
+        }
+
+        char label[32];
+        snprintf(label, sizeof(label), "%d", batch_sizes[b]);
+
+        bool ok = true;
+        for (int r = 0; r < runs && ok; r++) {
+            llm_session_reset(llm);
+            ok = run_query(llm, prompt, gen_tokens, &results[r]);
+        }
+        if (ok) {
+            print_row(label, results, runs);
+        }
+
+        /* Only the question changes; the log stays in the KV cache */
+        if (ok && b == batch_count - 1) {
+            for (int r = 0; r < runs && ok; r++) {
+                ok = run_query(llm, prompt, gen_tokens, &results[r]) &&
+                     run_query(llm, follow_up, gen_tokens, &results[r]);
+            }
+            if (ok) print_row("re-query", results, runs);
+        }
+
+        if (!ok) {
+            fprintf(stderr, "Query failed with batch %d: %s\n", batch_sizes[b],
+                    llm_get_last_error(llm) ? llm_get_last_error(llm) : "unknown error");
+            failures++;
+        }
+        llm_shutdown(llm);
+    }
+
+    /* Same prompt for every agent; each still decodes it on its own sequence */
+    if (parallel > 1) {
+        LLMConfig* config = llm_config_default();
+        config->model_path = model_path;
+        config->n_ctx = prompt_tokens + gen_tokens + 512;
+        config->n_threads = threads;
+        config->n_threads_batch = batch_threads;
+        config->n_parallel = parallel;
+
+        LLMContext* llm = llm_init(config);
+        llm_config_free(config);
+        double sequential_tps = 0.0, concurrent_tps = 0.0;
+        if (!llm || !run_agents(llm, prompt, gen_tokens, parallel, false, &sequential_tps) ||
+            !run_agents(llm, prompt, gen_tokens, parallel, true, &concurrent_tps)) {
+            fprintf(stderr, "Parallel queries failed: %s\n",
+                    llm && llm_get_last_error(llm) ? llm_get_last_error(llm) : "unknown error");
+            failures++;
+        } else {
+            printf("\n  %-12s %16s\n", "Agents", "Aggregate gen t/s");
+            printf("  %-12s %16.1f\n", "sequential", sequential_tps);
+            printf("  %-12s %16.1f  (%.2fx)\n", "concurrent", concurrent_tps,
+                   sequential_tps > 0 ? concurrent_tps / sequential_tps : 0.0);
+        }
+        llm_shutdown(llm);
+    }
+
+    free(prompt);
+    free(follow_up);
+    free(model_path);
+    log_shutdown();
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file bench_protocol_codec.c
+ * @brief Benchmark for distributed protocol frame encoding
+ *
+ * Compares binary frames against JSON text frames:
+ * - Encode/decode throughput (messages per second)
+ * - Bytes on the wire per compile job (request, accept, result)
+ * - Bytes per file chunk (raw tail vs base64)
+ *
+ * Usage: bench_protocol_codec [iterations]
+ */
+
+#include "cyxmake/distributed/protocol.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define DEFAULT_ITERATIONS 20000
+#define FILE_CHUNK_SIZE (64 * 1024)
+
+static double bench_time_ms(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+#endif
+}
+
+/* ============================================================
+ * Sample Messages
+ * ============================================================ */
+
+static ProtocolMessage* make_job_request(void) {
+    static char* args[] = {
+        "-c", "-O2", "-g", "-Wall", "-Wextra", "-std=c11",
+        "-DCYXMAKE_ENABLE_DISTRIBUTED", "-fPIC", "-MD", "-MF",
+        "build/src/distributed/work_scheduler.c.o.d"
+    };
+    static char* includes[] = {
+        "/home/build/cyxmake/include",
+        "/home/build/cyxmake/external/cJSON",
+        "/home/build/cyxmake/external/tomlc99"
+    };
+
+    DistributedJob job = {0};
+    job.job_id = "job-6f1a2b3c-0042";
+    job.type = JOB_TYPE_COMPILE;
+    job.priority = 1;
+    job.source_file = "src/distributed/work_scheduler.c";
+    job.output_file = "build/src/distributed/work_scheduler.c.o";
+    job.compiler = "/usr/bin/gcc";
+    job.compiler_args = args;
+    job.arg_count = sizeof(args) / sizeof(args[0]);
+    job.include_paths = includes;
+    job.include_count = sizeof(includes) / sizeof(includes[0]);
+    job.timeout_sec = 300;
+
+    ProtocolMessage* msg = protocol_message_create(PROTO_MSG_JOB_REQUEST);
+    msg->sender_id = strdup("4b1f0c2e-9d7a-4e35-8a61-2f6b9c0d1e3a");
+    char* payload = distributed_job_to_json(&job);
+    protocol_message_set_payload(msg, payload);
+    free(payload);
+    return msg;
+}
+
+static ProtocolMessage* make_job_accept(const ProtocolMessage* request) {
+    ProtocolMessage* msg = protocol_message_create_response(request, PROTO_MSG_JOB_ACCEPT);
+    msg->sender_id = strdup("9e8d7c6b-5a49-4382-b716-05f4e3d2c1b0");
+    protocol_message_set_payload(msg, "{\"job_id\":\"job-6f1a2b3c-0042\"}");
+    return msg;
+}
+
+static ProtocolMessage* make_job_complete(const ProtocolMessage* request) {
+    static char* paths[] = { "build/src/distributed/work_scheduler.c.o" };
+    static char* hashes[] = {
+        "3f5a9c1e7b2d4f6081a3c5e7f9b1d3f5a7c9e1b3d5f7a9c1e3b5d7f9a1c3e5b7"
+    };
+
+    DistributedJobResult result = {0};
+    result.job_id = "job-6f1a2b3c-0042";
+    result.success = true;
+    result.exit_code = 0;
+    result.stdout_output = "";
+    result.stderr_output = "";
+    result.artifact_paths = paths;
+    result.artifact_hashes = hashes;
+    result.artifact_count = 1;
+    result.duration_sec = 1.42;
+    result.cpu_time_sec = 1.38;
+
+    ProtocolMessage* msg = protocol_message_create_response(request, PROTO_MSG_JOB_COMPLETE);
+    msg->sender_id = strdup("9e8d7c6b-5a49-4382-b716-05f4e3d2c1b0");
+    char* payload = distributed_job_result_to_json(&result);
+    protocol_message_set_payload(msg, payload);
+    free(payload);
+    return msg;
+}
+
+static ProtocolMessage* make_file_chunk(void) {
+    ProtocolMessage* msg = protocol_message_create(PROTO_MSG_FILE_CHUNK);
+    msg->sender_id = strdup("9e8d7c6b-5a49-4382-b716-05f4e3d2c1b0");
+    protocol_message_set_payload(msg, "{\"transfer_id\":\"t-1\",\"offset\":0}");
+
+    uint8_t* chunk = (uint8_t*)malloc(FILE_CHUNK_SIZE);
+    for (size_t i = 0; i < FILE_CHUNK_SIZE; i++) {
+        chunk[i] = (uint8_t)(i * 31 + 7);
+    }
+    protocol_message_set_binary(msg, chunk, FILE_CHUNK_SIZE);
+    free(chunk);
+    return msg;
+}
+
+/* ============================================================
+ * Measurements
+ * ============================================================ */
+
+static size_t encoded_size(const ProtocolMessage* msg, ProtocolWireFormat format) {
+    size_t size = 0;
+    uint8_t* frame = protocol_message_encode(msg, format, &size);
+    free(frame);
+    return size;
+}
+
+static void bench_roundtrip(const char* label, const ProtocolMessage* msg,
+                            ProtocolWireFormat format, int iterations) {
+    size_t bytes = 0;
+    double start = bench_time_ms();
+
+    for (int i = 0; i < iterations; i++) {
+        size_t size = 0;
+        uint8_t* frame = protocol_message_encode(msg, format, &size);
+        ProtocolMessage* decoded = protocol_message_decode(frame, size);
+        protocol_message_free(decoded);
+        free(frame);
+        bytes += size;
+    }
+
+    double elapsed = bench_time_ms() - start;
+    double per_sec = elapsed > 0 ? iterations * 1000.0 / elapsed : 0;
+    printf("  %-14s %-6s %10.0f msg/s  %8.2f MB/s  (%zu bytes/msg)\n",
+           label, protocol_wire_format_name(format), per_sec,
+           elapsed > 0 ? (bytes / (1024.0 * 1024.0)) / (elapsed / 1000.0) : 0,
+           bytes / (size_t)iterations);
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : DEFAULT_ITERATIONS;
+    if (iterations <= 0) iterations = DEFAULT_ITERATIONS;
+
+    ProtocolMessage* request = make_job_request();
+    ProtocolMessage* accept = make_job_accept(request);
+    ProtocolMessage* complete = make_job_complete(request);
+    ProtocolMessage* chunk = make_file_chunk();
+
+    printf("=== Protocol Codec Benchmark (%d iterations) ===\n\n", iterations);
+
+    printf("Encode + decode throughput:\n");
+    ProtocolWireFormat formats[] = { PROTO_WIRE_BINARY, PROTO_WIRE_JSON };
+    for (int f = 0; f < 2; f++) {
+        bench_roundtrip("JOB_REQUEST", request, formats[f], iterations);
+        bench_roundtrip("JOB_COMPLETE", complete, formats[f], iterations);
+        bench_roundtrip("FILE_CHUNK", chunk, formats[f], iterations / 20 + 1);
+    }
+
+    printf("\nBytes per compile job (request + accept + complete):\n");
+    for (int f = 0; f < 2; f++) {
+        size_t total = encoded_size(request, formats[f]) +
+                       encoded_size(accept, formats[f]) +
+                       encoded_size(complete, formats[f]);
+        printf("  %-6s %zu bytes\n", protocol_wire_format_name(formats[f]), total);
+    }
+
+    printf("\nBytes per %d KB file chunk:\n", FILE_CHUNK_SIZE / 1024);
+    for (int f = 0; f < 2; f++) {
+        printf("  %-6s %zu bytes\n", protocol_wire_format_name(formats[f]),
+               encoded_size(chunk, formats[f]));
+    }
+
+    protocol_message_free(request);
+    protocol_message_free(accept);
+    protocol_message_free(complete);
+    protocol_message_free(chunk);
+    return 0;
+}
@@ -0,0 +1,627 @@
+/**
+ * @file bench_provider_http.c
+ * @brief Benchmark of provider request latency with and without pooling
+ *
+ * Runs a mock OpenAI-compatible HTTP/1.1 server on loopback and sends a
+ * series of sequential agent turns to it two ways:
+ *
+ *   fresh   - a new curl handle, header list and connection per request,
+ *             as every provider did before the shared pool
+ *   pooled  - ai_provider_complete through the shared HTTP pool
+ *
+ * Loopback handshakes cost microseconds, so --handshake-ms stands in for
+ * a real endpoint: the server holds the first response on every new
+ * connection that long (a TLS 1.3 handshake over a 30 ms path costs about
+ * two round trips, 60 ms).
+ *
+ * A second pass measures time to first token. The server then generates
+ * its reply one token every --token-ms, answering "stream":true requests
+ * with SSE events as tokens are produced and other requests once the
+ * whole reply is done:
+ *
+ *   blocking - ai_provider_complete; text is visible when the reply is
+ *   streamed - the same request with stream callbacks
+ *
+ * A third pass puts three providers behind their own servers, each
+ * answering in 8 x --fanout-token-ms, and compares:
+ *
+ *   health checks - one provider after another vs ai_registry_health_check_all
+ *   fallback      - ai_registry_complete_with_fallback while the primary
+ *                   stalls for --stall-ms on every 25th request, without
+ *                   and with hedging
+ *
+ * Usage: bench_provider_http [--turns N] [--handshake-ms N] [--token-ms N]
+ *                            [--fanout-token-ms N] [--stall-ms N]
+ */
+
+#include "cyxmake/ai_provider.h"
+#include "cyxmake/http_pool.h"
+#include "cyxmake/threading.h"
+#include "cyxmake/logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(CYXMAKE_USE_CURL) && !defined(_WIN32)
+#include <curl/curl.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_CLIENTS 64
+#define PROMPT_BYTES 4096
+#define FANOUT_PROVIDERS 3
+#define STALL_EVERY 25
+
+static const char* MOCK_BODY =
+    "{\"id\":\"chatcmpl-bench\",\"object\":\"chat.completion\",\"choices\":[{\"index\":0,"
+    "\"message\":{\"role\":\"assistant\",\"content\":\"Run cmake --build build\\n\"},"
+    "\"finish_reason\":\"stop\"}],\"usage\":{\"prompt_tokens\":1024,"
+    "\"completion_tokens\":8,\"total_tokens\":1032}}";
+
+/* The same reply, token by token */
+static const char* MOCK_TOKENS[] = {
+    "Run", " c", "make", " --", "build", " b", "uild", "\\n"
+};
+#define MOCK_TOKEN_COUNT 8
+
+static double bench_time_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/* ============================================================
+ * Mock Server
+ * ============================================================ */
+
+typedef struct {
+    int fd;
+    char* buf;
+    size_t len;
+    size_t cap;
+    bool served;                  /* A response went out on this connection */
+} MockClient;
+
+typedef struct {
+    int listen_fd;
+    int port;
+    int handshake_ms;
+    volatile int token_ms;        /* Generation time per reply token */
+    volatile int stall_every;     /* Hold every Nth reply back (0 = never) */
+    volatile int stall_ms;
+    volatile bool stop;
+    int connections;              /* Connections accepted */
+    int replies;                  /* Whole (non-streamed) replies sent */
+    MockClient clients[MAX_CLIENTS];
+} MockServer;
+
+static void client_close(MockClient* c) {
+    close(c->fd);
+    free(c->buf);
+    memset(c, 0, sizeof(*c));
+    c->fd = -1;
+}
+
+/* Write one HTTP/1.1 chunk */
+static bool write_chunk(int fd, const char* data) {
+    char chunk[512];
+    int n = snprintf(chunk, sizeof(chunk), "%zx\r\n%s\r\n", strlen(data), data);
+    return write(fd, chunk, (size_t)n) == n;
+}
+
+/* Send the reply as SSE events, one per generated token */
+static bool client_stream(MockServer* server, MockClient* c) {
+    const char* head = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n"
+                       "Transfer-Encoding: chunked\r\nConnection: keep-alive\r\n\r\n";
+    if (write(c->fd, head, strlen(head)) != (ssize_t)strlen(head)) return false;
+
+    char event[256];
+    for (int i = 0; i < MOCK_TOKEN_COUNT; i++) {
+        if (server->token_ms > 0) usleep((useconds_t)server->token_ms * 1000);
+        snprintf(event, sizeof(event),
+                 "data: {\"choices\":[{\"index\":0,\"delta\":{\"content\":\"%s\"}}]}\n\n",
+                 MOCK_TOKENS[i]);
+        if (!write_chunk(c->fd, event)) return false;
+    }
+    if (!write_chunk(c->fd, "data: {\"choices\":[{\"index\":0,\"delta\":{},"
+                            "\"finish_reason\":\"stop\"}]}\n\ndata: [DONE]\n\n")) {
+        return false;
+    }
+    return write(c->fd, "0\r\n\r\n", 5) == 5;
+}
+
+/* Answer every complete request in the client's buffer */
+static bool client_serve(MockServer* server, MockClient* c) {
+    for (;;) {
+        char* end = c->len ? strstr(c->buf, "\r\n\r\n") : NULL;
+        if (!end) return true;
+
+        size_t header_len = (size_t)(end - c->buf) + 4;
+        size_t content_length = 0;
+        const char* cl = strstr(c->buf, "Content-Length:");
+        if (!cl) cl = strstr(c->buf, "content-length:");
+        if (cl && cl < end) content_length = (size_t)strtoul(cl + 15, NULL, 10);
+        if (c->len < header_len + content_length) return true;
+
+        if (!c->served && server->handshake_ms > 0) {
+            usleep((useconds_t)server->handshake_ms * 1000);
+        }
+        c->served = true;
+
+        bool stream = strstr(end, "\"stream\":true") != NULL;
+        if (stream) {
+            if (!client_stream(server, c)) return false;
+        } else {
+            if (server->token_ms > 0) {
+                usleep((useconds_t)(server->token_ms * MOCK_TOKEN_COUNT) * 1000);
+            }
+            server->replies++;
+            if (server->stall_every > 0 && server->replies % server->stall_every == 0) {
+                usleep((useconds_t)server->stall_ms * 1000);
+            }
+
+            /* One write: a second small one would wait out the client's
+             * delayed ACK (Nagle) once the connection leaves quick-ack mode */
+            char reply[1024];
+            int n = snprintf(reply, sizeof(reply),
+                             "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                             "Content-Length: %zu\r\nConnection: keep-alive\r\n\r\n%s",
+                             strlen(MOCK_BODY), MOCK_BODY);
+            if (write(c->fd, reply, (size_t)n) != n) return false;
+        }
+
+        size_t used = header_len + content_length;
+        memmove(c->buf, c->buf + used, c->len - used + 1);
+        c->len -= used;
+    }
+}
+
+static void* server_thread(void* arg) {
+    MockServer* server = (MockServer*)arg;
+    struct pollfd pfds[MAX_CLIENTS + 1];
+
+    while (!server->stop) {
+        int n = 0;
+        pfds[n++] = (struct pollfd){ .fd = server->listen_fd, .events = POLLIN };
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            pfds[n++] = (struct pollfd){ .fd = server->clients[i].fd, .events = POLLIN };
+        }
+        if (poll(pfds, (nfds_t)n, 50) <= 0) continue;
+
+        if (pfds[0].revents & POLLIN) {
+            int fd = accept(server->listen_fd, NULL, NULL);
+            if (fd >= 0) {
+                /* Token events are small writes spaced apart */
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            }
+            for (int i = 0; fd >= 0 && i < MAX_CLIENTS; i++) {
+                if (server->clients[i].fd < 0) {
+                    server->clients[i].fd = fd;
+                    server->connections++;
+                    fd = -1;
+                }
+            }
+            if (fd >= 0) close(fd);
+        }
+
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            MockClient* c = &server->clients[i];
+            if (c->fd < 0 || !(pfds[i + 1].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+            if (c->cap - c->len < 8192 + 1) {
+                size_t cap = c->cap ? c->cap * 2 : 16384;
+                char* buf = realloc(c->buf, cap);
+                if (!buf) {
+                    client_close(c);
+                    continue;
+                }
+                c->buf = buf;
+                c->cap = cap;
+            }
+            ssize_t got = read(c->fd, c->buf + c->len, c->cap - c->len - 1);
+            if (got <= 0) {
+                client_close(c);
+                continue;
+            }
+            c->len += (size_t)got;
+            c->buf[c->len] = '\0';
+            if (!client_serve(server, c)) client_close(c);
+        }
+    }
+    return NULL;
+}
+
+static bool server_start(MockServer* server, ThreadHandle* thread) {
+    for (int i = 0; i < MAX_CLIENTS; i++) server->clients[i].fd = -1;
+
+    server->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (server->listen_fd < 0) return false;
+    int one = 1;
+    setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t len = sizeof(addr);
+    if (bind(server->listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(server->listen_fd, 64) != 0 ||
+        getsockname(server->listen_fd, (struct sockaddr*)&addr, &len) != 0) {
+        close(server->listen_fd);
+        return false;
+    }
+    server->port = ntohs(addr.sin_port);
+    return thread_create(thread, server_thread, server);
+}
+
+static void server_stop(MockServer* server, ThreadHandle thread) {
+    server->stop = true;
+    thread_join(thread);
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (server->clients[i].fd >= 0) client_close(&server->clients[i]);
+    }
+    close(server->listen_fd);
+}
+
+/* ============================================================
+ * Clients
+ * ============================================================ */
+
+static size_t discard_cb(void* data, size_t size, size_t nmemb, void* userp) {
+    (void)data;
+    (void)userp;
+    return size * nmemb;
+}
+
+/* The pre-pool request path: handle, headers and connection per request */
+static bool fresh_request(const char* url, const char* body) {
+    CURL* curl = curl_easy_init();
+    if (!curl) return false;
+
+    struct curl_slist* headers = NULL;
+    headers = curl_slist_append(headers, "Content-Type: application/json");
+    headers = curl_slist_append(headers, "Authorization: Bearer sk-bench");
+
+    curl_easy_setopt(curl, CURLOPT_URL, url);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discard_cb);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
+
+    CURLcode res = curl_easy_perform(curl);
+
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
+    return res == CURLE_OK;
+}
+
+typedef struct {
+    double start;
+    double first;                 /* Time of the first token (0 = none yet) */
+    int tokens;
+} TokenClock;
+
+static void clock_token(const char* text, size_t len, void* user_data) {
+    (void)text;
+    (void)len;
+    TokenClock* clock = (TokenClock*)user_data;
+    if (clock->tokens++ == 0) clock->first = bench_time_ms();
+}
+
+static void print_row(const char* mode, double* latency, int turns, int connections,
+                      int failures) {
+    qsort(latency, (size_t)turns, sizeof(double), compare_double);
+    double sum = 0;
+    for (int i = 0; i < turns; i++) sum += latency[i];
+    printf("  %-8s %9.3f %9.3f %9.3f %9.3f %9.1f %7d %6d\n", mode,
+           sum / turns, latency[turns / 2], latency[turns * 9 / 10],
+           latency[turns * 99 / 100], sum, connections, failures);
+}
+
+/* Registry of providers, one per server */
+static AIProviderRegistry* fanout_registry(MockServer** servers, bool hedge) {
+    AIProviderRegistry* registry = ai_registry_create();
+    for (int i = 0; i < FANOUT_PROVIDERS; i++) {
+        char name[16], base_url[64];
+        snprintf(name, sizeof(name), "p%d", i);
+        snprintf(base_url, sizeof(base_url), "http://127.0.0.1:%d/v1", servers[i]->port);
+
+        AIProviderConfig* config = ai_config_create(name, AI_PROVIDER_OPENAI);
+        config->enabled = true;
+        config->base_url = strdup(base_url);
+        config->model = strdup("bench");
+        ai_config_set_api_key(config, "sk-bench");
+        config->timeout_sec = 30;
+        ai_registry_add(registry, config);
+        ai_config_free(config);
+        ai_provider_init(ai_registry_get(registry, name));
+    }
+
+    AIHedgeConfig config = ai_hedge_config_default();
+    config.enabled = hedge;
+    ai_registry_set_hedging(registry, &config);
+    return registry;
+}
+
+static double median_of(double* values, int count) {
+    qsort(values, (size_t)count, sizeof(double), compare_double);
+    return values[count / 2];
+}
+
+/* Health checks and hedged fallback across several providers */
+static void bench_fanout(const char* prompt, int turns, int token_ms, int stall_ms) {
+    MockServer* servers[FANOUT_PROVIDERS];
+    ThreadHandle threads[FANOUT_PROVIDERS];
+    for (int i = 0; i < FANOUT_PROVIDERS; i++) {
+        servers[i] = calloc(1, sizeof(MockServer));
+        servers[i]->token_ms = token_ms;
+        if (!server_start(servers[i], &threads[i])) {
+            fprintf(stderr, "Failed to start mock server\n");
+            exit(1);
+        }
+    }
+
+    printf("\n%d providers answering in %d ms each\n\n", FANOUT_PROVIDERS,
+           token_ms * MOCK_TOKEN_COUNT);
+
+    /* Health checks: each provider in turn vs all at once */
+    enum { ROUNDS = 5 };
+    double serial[ROUNDS], parallel[ROUNDS];
+    int healthy_serial = 0, healthy_parallel = 0;
+    AIProviderRegistry* registry = fanout_registry(servers, false);
+    for (int r = 0; r < ROUNDS; r++) {
+        double start = bench_time_ms();
+        healthy_serial = 0;
+        for (int i = 0; i < FANOUT_PROVIDERS; i++) {
+            char name[16];
+            snprintf(name, sizeof(name), "p%d", i);
+            AIHealthCheckResult* result =
+                ai_provider_health_check(ai_registry_get(registry, name));
+            if (result && result->healthy) healthy_serial++;
+            ai_health_check_free(result);
+        }
+        serial[r] = bench_time_ms() - start;
+
+        AIHealthCheckResult* results[FANOUT_PROVIDERS];
+        const char* names[FANOUT_PROVIDERS];
+        start = bench_time_ms();
+        int count = ai_registry_health_check_all(registry, results, names, FANOUT_PROVIDERS);
+        parallel[r] = bench_time_ms() - start;
+        healthy_parallel = 0;
+        for (int i = 0; i < count; i++) {
+            if (results[i] && results[i]->healthy) healthy_parallel++;
+            ai_health_check_free(results[i]);
+        }
+    }
+    ai_registry_free(registry);
+
+    printf("  %-14s %12s %8s\n", "Health checks", "p50 ms", "Healthy");
+    printf("  %-14s %12.2f %6d/%d\n", "one by one", median_of(serial, ROUNDS),
+           healthy_serial, FANOUT_PROVIDERS);
+    printf("  %-14s %12.2f %6d/%d\n", "concurrent", median_of(parallel, ROUNDS),
+           healthy_parallel, FANOUT_PROVIDERS);
+
+    /* Fallback while the primary stalls now and then */
+    printf("\n%d requests, primary stalls %d ms on every %dth\n\n",
+           turns, stall_ms, STALL_EVERY);
+    printf("  %-8s %9s %9s %9s %9s %9s %7s %6s\n", "Mode", "Mean ms", "p50 ms",
+           "p90 ms", "p99 ms", "Total ms", "Hedged", "Fails");
+
+    double* latency = calloc((size_t)turns, sizeof(double));
+    for (int hedge = 0; hedge <= 1; hedge++) {
+        registry = fanout_registry(servers, hedge);
+        servers[0]->replies = 0;
+        servers[0]->stall_every = STALL_EVERY;
+        servers[0]->stall_ms = stall_ms;
+        int secondary_before = servers[1]->replies;
+
+        int failures = 0;
+        for (int i = 0; i < turns; i++) {
+            AIRequest* request = ai_request_create();
+            ai_request_add_message(request, AI_ROLE_USER, prompt);
+            request->max_tokens = 64;
+
+            double start = bench_time_ms();
+            AIResponse* response = ai_registry_complete_with_fallback(registry, request,
+                                                                      "p0", NULL);
+            latency[i] = bench_time_ms() - start;
+
+            if (!response || !response->success || !response->content ||
+                strcmp(response->content, "Run cmake --build build\n") != 0) {
+                failures++;
+            }
+            ai_response_free(response);
+            ai_request_free(request);
+        }
+        servers[0]->stall_every = 0;
+        ai_registry_free(registry);
+
+        /* The server for the first hedge sees every request it answered */
+        print_row(hedge ? "hedged" : "plain", latency, turns,
+                  servers[1]->replies - secondary_before, failures);
+    }
+    free(latency);
+
+    for (int i = 0; i < FANOUT_PROVIDERS; i++) {
+        server_stop(servers[i], threads[i]);
+        free(servers[i]);
+    }
+}
+
+int main(int argc, char** argv) {
+    int turns = 100;
+    int handshake_ms = 0;
+    int token_ms = 20;
+    int fanout_token_ms = 5;
+    int stall_ms = 500;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--turns") == 0 && i + 1 < argc) {
+            turns = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--handshake-ms") == 0 && i + 1 < argc) {
+            handshake_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--token-ms") == 0 && i + 1 < argc) {
+            token_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fanout-token-ms") == 0 && i + 1 < argc) {
+            fanout_token_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--stall-ms") == 0 && i + 1 < argc) {
+            stall_ms = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--turns N] [--handshake-ms N] [--token-ms N] "
+                            "[--fanout-token-ms N] [--stall-ms N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (turns < 1) turns = 1;
+
+    log_init(NULL);
+    log_set_level(LOG_LEVEL_ERROR);
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    /* Cancelled hedges close connections the server still writes to */
+    signal(SIGPIPE, SIG_IGN);
+
+    MockServer* server = calloc(1, sizeof(MockServer));
+    ThreadHandle thread;
+    server->handshake_ms = handshake_ms;
+    if (!server_start(server, &thread)) {
+        fprintf(stderr, "Failed to start mock server\n");
+        return 1;
+    }
+
+    char base_url[64], url[96];
+    snprintf(base_url, sizeof(base_url), "http://127.0.0.1:%d/v1", server->port);
+    snprintf(url, sizeof(url), "%s/chat/completions", base_url);
+
+    char* prompt = malloc(PROMPT_BYTES + 1);
+    for (int i = 0; i < PROMPT_BYTES; i++) prompt[i] = (char)('a' + i % 26);
+    prompt[PROMPT_BYTES] = '\0';
+
+    size_t body_len = PROMPT_BYTES + 256;
+    char* body = malloc(body_len);
+    snprintf(body, body_len,
+             "{\"model\":\"bench\",\"messages\":[{\"role\":\"user\",\"content\":\"%s\"}],"
+             "\"max_tokens\":64}", prompt);
+
+    double* latency = calloc((size_t)turns, sizeof(double));
+
+    printf("=== Provider HTTP Benchmark ===\n\n");
+    printf("%d sequential turns, %d byte prompt, simulated handshake %d ms\n\n",
+           turns, PROMPT_BYTES, handshake_ms);
+    printf("  %-8s %9s %9s %9s %9s %9s %7s %6s\n", "Mode", "Mean ms", "p50 ms",
+           "p90 ms", "p99 ms", "Total ms", "Conns", "Fails");
+
+    /* Fresh handle per request */
+    int before = server->connections;
+    int failures = 0;
+    for (int i = 0; i < turns; i++) {
+        double start = bench_time_ms();
+        if (!fresh_request(url, body)) failures++;
+        latency[i] = bench_time_ms() - start;
+    }
+    print_row("fresh", latency, turns, server->connections - before, failures);
+
+    /* Shared pool through the provider */
+    AIProvider* provider = ai_provider_openai("sk-bench", "bench");
+    free(provider->config.base_url);
+    provider->config.base_url = strdup(base_url);
+    ai_provider_init(provider);
+
+    before = server->connections;
+    failures = 0;
+    for (int i = 0; i < turns; i++) {
+        AIRequest* request = ai_request_create();
+        ai_request_add_message(request, AI_ROLE_USER, prompt);
+        request->max_tokens = 64;
+
+        double start = bench_time_ms();
+        AIResponse* response = ai_provider_complete(provider, request);
+        latency[i] = bench_time_ms() - start;
+
+        if (!response || !response->success) failures++;
+        ai_response_free(response);
+        ai_request_free(request);
+    }
+    print_row("pooled", latency, turns, server->connections - before, failures);
+
+    HttpPoolStats stats = http_pool_get_stats(provider->http_pool);
+    printf("\nPool: %d requests, %d handles created, %d connections opened\n",
+           stats.requests, stats.handles_created, stats.connections_opened);
+
+    /* Time to first token while the server generates */
+    int ttft_turns = turns < 20 ? turns : 20;
+    server->token_ms = token_ms;
+    double* total = calloc((size_t)ttft_turns, sizeof(double));
+
+    printf("\n%d turns, %d tokens generated at %d ms/token\n\n",
+           ttft_turns, MOCK_TOKEN_COUNT, token_ms);
+    printf("  %-9s %12s %12s %10s %6s\n", "Mode", "TTFT p50 ms", "Total p50 ms",
+           "Tokens", "Fails");
+
+    for (int streamed = 0; streamed <= 1; streamed++) {
+        failures = 0;
+        int tokens = 0;
+        for (int i = 0; i < ttft_turns; i++) {
+            TokenClock clock = {0};
+            AIStreamCallbacks callbacks = { .on_token = clock_token, .user_data = &clock };
+
+            AIRequest* request = ai_request_create();
+            ai_request_add_message(request, AI_ROLE_USER, prompt);
+            request->max_tokens = 64;
+            request->stream = streamed;
+            request->stream_callbacks = &callbacks;
+
+            clock.start = bench_time_ms();
+            AIResponse* response = ai_provider_complete(provider, request);
+            total[i] = bench_time_ms() - clock.start;
+
+            /* Without streaming the first text is the whole reply */
+            latency[i] = clock.first > 0 ? clock.first - clock.start : total[i];
+            tokens = clock.tokens;
+
+            if (!response || !response->success || !response->content ||
+                strcmp(response->content, "Run cmake --build build\n") != 0) {
+                failures++;
+            }
+            ai_response_free(response);
+            ai_request_free(request);
+        }
+        qsort(latency, (size_t)ttft_turns, sizeof(double), compare_double);
+        qsort(total, (size_t)ttft_turns, sizeof(double), compare_double);
+        printf("  %-9s %12.2f %12.2f %10d %6d\n", streamed ? "streamed" : "blocking",
+               latency[ttft_turns / 2], total[ttft_turns / 2], tokens, failures);
+    }
+    free(total);
+
+    bench_fanout(prompt, turns, fanout_token_ms, stall_ms);
+
+    ai_provider_free(provider);
+    server_stop(server, thread);
+    free(server);
+    free(latency);
+    free(body);
+    free(prompt);
+    curl_global_cleanup();
+    log_shutdown();
+    return 0;
+}
+
+#else
+
+int main(void) {
+    printf("bench_provider_http needs CURL and POSIX sockets; skipped\n");
+    return 0;
+}
+
+#endif
@@ -0,0 +1,167 @@
+/**
+ * @file bench_schedule_sim.c
+ * @brief Benchmark comparing build makespan across scheduling policies
+ *
+ * Replays a build through the schedule simulator on a heterogeneous worker
+ * farm and reports makespan for FIFO, round-robin and critical-path
+ * scheduling against the theoretical lower bound.
+ *
+ * Without arguments a synthetic build is generated: code generators feeding
+ * some compiles, skewed compile times, per-library links and a final link.
+ * Pass a trace recorded by the coordinator (trace_path) to replay a real one.
+ *
+ * Usage: bench_schedule_sim [trace_file [build_id]]
+ */
+
+#include "cyxmake/distributed/schedule_sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define SYNTH_LIBRARIES 8
+#define SYNTH_SOURCES_PER_LIB 60
+#define SYNTH_GENERATORS 3
+
+static double bench_time_ms(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+#endif
+}
+
+/* ============================================================
+ * Synthetic Build
+ * ============================================================ */
+
+static unsigned int rng_state = 12345;
+
+static double next_random(void) {
+    rng_state = rng_state * 1103515245u + 12345u;
+    return ((rng_state >> 8) & 0xFFFF) / 65536.0;
+}
+
+static int* make_deps(int count) {
+    return count > 0 ? malloc(sizeof(int) * (size_t)count) : NULL;
+}
+
+/* Jobs are submitted in source order, the way a build system walks targets */
+static SimTrace* make_synthetic_build(void) {
+    int compiles = SYNTH_LIBRARIES * SYNTH_SOURCES_PER_LIB;
+    int total = SYNTH_GENERATORS + compiles + SYNTH_LIBRARIES + 1;
+
+    SimTrace* trace = calloc(1, sizeof(SimTrace));
+    trace->build_id = strdup("synthetic");
+    trace->jobs = calloc((size_t)total, sizeof(SimJob));
+    trace->count = total;
+
+    int n = 0;
+    int generators = n;
+    for (int g = 0; g < SYNTH_GENERATORS; g++) {
+        trace->jobs[n++].duration_sec = 6.0 + 4.0 * g;
+    }
+
+    int first_compile = n;
+    for (int lib = 0; lib < SYNTH_LIBRARIES; lib++) {
+        for (int s = 0; s < SYNTH_SOURCES_PER_LIB; s++) {
+            SimJob* job = &trace->jobs[n++];
+
+            /* Most files are quick; a few template-heavy ones dominate */
+            double r = next_random();
+            job->duration_sec = r < 0.9 ? 0.5 + 2.0 * next_random() : 15.0 + 25.0 * next_random();
+
+            /* Sources at the end of each library include generated headers */
+            if (s >= SYNTH_SOURCES_PER_LIB - 4) {
+                job->deps = make_deps(1);
+                job->deps[job->dep_count++] = generators + lib % SYNTH_GENERATORS;
+            }
+        }
+    }
+
+    int first_link = n;
+    for (int lib = 0; lib < SYNTH_LIBRARIES; lib++) {
+        SimJob* job = &trace->jobs[n++];
+        job->duration_sec = 3.0;
+        job->deps = make_deps(SYNTH_SOURCES_PER_LIB);
+        for (int s = 0; s < SYNTH_SOURCES_PER_LIB; s++) {
+            job->deps[job->dep_count++] = first_compile + lib * SYNTH_SOURCES_PER_LIB + s;
+        }
+    }
+
+    SimJob* final_link = &trace->jobs[n++];
+    final_link->duration_sec = 8.0;
+    final_link->deps = make_deps(SYNTH_LIBRARIES);
+    for (int lib = 0; lib < SYNTH_LIBRARIES; lib++) {
+        final_link->deps[final_link->dep_count++] = first_link + lib;
+    }
+
+    return trace;
+}
+
+/* ============================================================
+ * Main
+ * ============================================================ */
+
+int main(int argc, char** argv) {
+    SimTrace* trace = argc > 1 ?
+                      schedule_trace_load(argv[1], argc > 2 ? argv[2] : NULL) :
+                      make_synthetic_build();
+    if (!trace) {
+        fprintf(stderr, "Failed to load build trace\n");
+        return 1;
+    }
+
+    /* Two fast build servers, four desktops, two old laptops */
+    SimWorker farm[] = {
+        { 8, 0.6 }, { 8, 0.6 },
+        { 4, 1.0 }, { 4, 1.0 }, { 4, 1.0 }, { 4, 1.0 },
+        { 4, 1.8 }, { 4, 1.8 }
+    };
+    int farm_size = sizeof(farm) / sizeof(farm[0]);
+
+    double work = 0.0;
+    for (int j = 0; j < trace->count; j++) {
+        work += trace->jobs[j].duration_sec;
+    }
+
+    printf("=== Schedule Simulation Benchmark ===\n\n");
+    printf("Build %s: %d jobs, %.1fs of work, %d workers\n\n",
+           trace->build_id, trace->count, work, farm_size);
+
+    double bound = schedule_lower_bound(trace->jobs, trace->count, farm, farm_size);
+    SimPolicy policies[] = { SIM_POLICY_FIFO, SIM_POLICY_ROUND_ROBIN, SIM_POLICY_CRITICAL_PATH };
+    double makespans[3];
+
+    printf("  %-14s %10s %10s %12s\n", "Policy", "Makespan", "vs bound", "Sim time");
+    for (int p = 0; p < 3; p++) {
+        double start = bench_time_ms();
+        makespans[p] = schedule_simulate(trace->jobs, trace->count, farm, farm_size, policies[p]);
+        double elapsed = bench_time_ms() - start;
+
+        if (makespans[p] < 0) {
+            printf("  %-14s %10s\n", sim_policy_name(policies[p]), "cycle");
+            continue;
+        }
+        printf("  %-14s %9.1fs %9.2fx %10.2f ms\n", sim_policy_name(policies[p]),
+               makespans[p], bound > 0 ? makespans[p] / bound : 0, elapsed);
+    }
+
+    printf("\nLower bound: %.1fs\n", bound);
+    if (makespans[0] > 0 && makespans[2] > 0) {
+        printf("Critical path vs FIFO: %.1f%% shorter\n",
+               100.0 * (makespans[0] - makespans[2]) / makespans[0]);
+    }
+
+    schedule_trace_free(trace);
+    return 0;
+}
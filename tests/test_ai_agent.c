@@ -4,11 +4,27 @@
  */
 
 #include "cyxmake/prompt_templates.h"
+#include "cyxmake/ai_provider.h"
+#include "cyxmake/http_pool.h"
+#include "cyxmake/ai_stream.h"
+#include "cyxmake/ai_cache.h"
+#include "cyxmake/ai_schema.h"
+#include "cyxmake/context_packer.h"
+#include "cyxmake/file_ops.h"
 #include "cyxmake/logger.h"
+#include "cJSON.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <sys/utime.h>
+#define utime _utime
+#else
+#include <utime.h>
+#endif
 
 /* Test counters */
 static int tests_run = 0;
@@ -439,6 +455,787 @@ void test_parse_command_local_unknown(void) {
     PASS();
 }
 
+/* ========================================================================
+ * Test: Provider HTTP Pool
+ * ======================================================================== */
+
+void test_http_pool_shared(void) {
+    TEST("http_pool - shared by cloud providers");
+
+    AIProvider* openai = ai_provider_openai("sk-test", "model");
+    AIProvider* anthropic = ai_provider_anthropic("sk-test", "model");
+    ASSERT(openai && anthropic, "Providers should be created");
+    ASSERT(openai->http_pool != NULL, "Cloud provider should get a pool");
+    ASSERT(openai->http_pool == anthropic->http_pool, "Providers should share one pool");
+
+    /* Nothing listens on port 1: the request fails in transport */
+    HttpHeaders* headers = http_headers_create();
+    ASSERT(http_headers_add(headers, "Content-Type", "application/json"),
+           "Header should be added");
+    HttpResponse* response = http_pool_post(openai->http_pool, "http://127.0.0.1:1/v1",
+                                            headers, "{}", 5);
+    ASSERT(response && response->error && response->status == 0,
+           "Refused connection should report an error");
+    http_response_free(response);
+    http_headers_free(headers);
+
+    HttpPoolStats stats = http_pool_get_stats(openai->http_pool);
+    ASSERT(stats.requests == 1, "Request should be counted");
+    printf("  %d request(s), %d handle(s) created, %d idle\n",
+           stats.requests, stats.handles_created, stats.idle_handles);
+
+    ai_provider_free(anthropic);
+    ai_provider_free(openai);
+
+    /* The last reference frees the pool; the next provider gets a new one */
+    AIProvider* again = ai_provider_openai("sk-test", "model");
+    ASSERT(again && http_pool_get_stats(again->http_pool).requests == 0,
+           "Pool should be recreated after the last provider is freed");
+    ai_provider_free(again);
+
+    PASS();
+}
+
+void test_http_pool_batch(void) {
+    TEST("http_pool - concurrent batch and early launch after failures");
+
+    HttpPool* pool = http_pool_create(0);
+    ASSERT(pool != NULL, "Pool should be created");
+
+    /* Both refuse at once: the delayed one must not wait out its delay */
+    HttpBatchRequest requests[2] = {
+        {"http://127.0.0.1:1/a", NULL, "{}", 5, 0},
+        {"http://127.0.0.1:1/b", NULL, "{}", 5, 30000}
+    };
+    HttpResponse* responses[2];
+    time_t start = time(NULL);
+    int winner = http_pool_post_batch(pool, requests, 2, true, responses);
+    ASSERT(winner == -1, "No request should succeed");
+    ASSERT(time(NULL) - start < 10, "Delayed request should launch when the first fails");
+    ASSERT(responses[0] && responses[0]->error && responses[1] && responses[1]->error,
+           "Both requests should report their errors");
+    http_response_free(responses[0]);
+    http_response_free(responses[1]);
+    ASSERT(http_pool_get_stats(pool).requests == 2, "Both requests should be counted");
+
+    http_pool_free(pool);
+    PASS();
+}
+
+void test_registry_health_and_hedging(void) {
+    TEST("ai_registry - concurrent health checks and hedging config");
+
+    AIProviderRegistry* registry = ai_registry_create();
+    const char* names[] = {"first", "second", "third"};
+    for (int i = 0; i < 3; i++) {
+        AIProviderConfig* config = ai_config_create(names[i], AI_PROVIDER_OPENAI);
+        config->enabled = true;
+        config->base_url = strdup("http://127.0.0.1:1/v1");
+        config->model = strdup("model");
+        config->timeout_sec = 5;
+        ASSERT(ai_registry_add(registry, config), "Provider should be added");
+        ai_config_free(config);
+    }
+
+    AIHealthCheckResult* results[4];
+    const char* checked[4];
+    int count = ai_registry_health_check_all(registry, results, checked, 4);
+    ASSERT(count == 3, "All providers should be checked");
+    for (int i = 0; i < count; i++) {
+        ASSERT(strcmp(checked[i], names[i]) == 0, "Results should keep registry order");
+        ASSERT(results[i] && !results[i]->healthy && results[i]->message,
+               "Unreachable provider should be unhealthy with a reason");
+        ai_health_check_free(results[i]);
+    }
+    ASSERT(ai_registry_find_healthy(registry) == NULL, "No provider should be healthy");
+
+    AIHedgeConfig hedge = ai_hedge_config_default();
+    ASSERT(!hedge.enabled && hedge.percentile > 0.9 && hedge.max_hedges == 1,
+           "Hedging should be off by default");
+    ASSERT(ai_provider_latency_percentile(ai_registry_get(registry, "first"), 0.95) == 0,
+           "No latency before any success");
+
+    /* Hedged requests that all fail fall back to sequential retries */
+    hedge.enabled = true;
+    ai_registry_set_hedging(registry, &hedge);
+    AIRetryConfig retry = ai_retry_config_default();
+    retry.max_retries = 0;
+    AIRequest* request = ai_request_create();
+    ai_request_add_message(request, AI_ROLE_USER, "ping");
+    AIResponse* response = ai_registry_complete_with_fallback(registry, request, NULL, &retry);
+    ASSERT(response && !response->success && response->error,
+           "All providers failing should report an error");
+    ai_response_free(response);
+    ai_request_free(request);
+
+    ai_registry_free(registry);
+    PASS();
+}
+
+/* ========================================================================
+ * Test: Streaming Parser
+ * ======================================================================== */
+
+typedef struct {
+    char text[256];
+    int deltas;
+    int completed;
+    char completed_names[64];
+    int text_at_first_call;       /* Text length when the first call completed */
+    int deltas_at_first_call;
+} StreamCapture;
+
+static void capture_token(const char* text, size_t len, void* user_data) {
+    StreamCapture* cap = (StreamCapture*)user_data;
+    strncat(cap->text, text, len);
+}
+
+static void capture_delta(int index, const char* id, const char* name,
+                          const char* arguments_delta, void* user_data) {
+    (void)index; (void)id; (void)name; (void)arguments_delta;
+    ((StreamCapture*)user_data)->deltas++;
+}
+
+static void capture_call(int index, const AIToolCall* call, void* user_data) {
+    (void)index;
+    StreamCapture* cap = (StreamCapture*)user_data;
+    if (cap->completed++ == 0) {
+        cap->text_at_first_call = (int)strlen(cap->text);
+        cap->deltas_at_first_call = cap->deltas;
+    }
+    strcat(cap->completed_names, call->name);
+    strcat(cap->completed_names, ";");
+}
+
+/* Feed a body one byte at a time, the worst case for framing */
+static AIResponse* stream_bytewise(AIProviderType type, const char* body,
+                                   StreamCapture* cap) {
+    AIStreamCallbacks callbacks = {capture_token, capture_delta, capture_call, cap};
+    AIStreamParser* parser = ai_stream_parser_create(type, &callbacks);
+    for (const char* p = body; *p; p++) {
+        if (!ai_stream_parser_feed(parser, p, 1)) break;
+    }
+    AIResponse* response = ai_stream_parser_finish(parser);
+    ai_stream_parser_free(parser);
+    return response;
+}
+
+void test_stream_openai_sse(void) {
+    TEST("ai_stream - OpenAI SSE text and tool calls");
+
+    const char* body =
+        ": keep-alive\n\n"
+        "data: {\"choices\":[{\"delta\":{\"role\":\"assistant\",\"content\":\"Let me \"}}]}\n\n"
+        "data: {\"choices\":[{\"delta\":{\"content\":\"look.\"}}]}\r\n\r\n"
+        "data: {\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":0,\"id\":\"call_a\","
+        "\"function\":{\"name\":\"read_file\",\"arguments\":\"\"}}]}}]}\n\n"
+        "data: {\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":0,"
+        "\"function\":{\"arguments\":\"{\\\"path\\\":\"}}]}}]}\n\n"
+        "data: {\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":0,"
+        "\"function\":{\"arguments\":\"\\\"a.c\\\"}\"}}]}}]}\n\n"
+        "data: {\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":1,\"id\":\"call_b\","
+        "\"function\":{\"name\":\"list_directory\",\"arguments\":\"{}\"}}]}}]}\n\n"
+        "data: {\"choices\":[{\"delta\":{},\"finish_reason\":\"tool_calls\"}]}\n\n"
+        "data: {\"choices\":[],\"usage\":{\"prompt_tokens\":12,\"completion_tokens\":7,"
+        "\"total_tokens\":19}}\n\n"
+        "data: [DONE]\n\n";
+
+    StreamCapture cap = {0};
+    AIResponse* response = stream_bytewise(AI_PROVIDER_OPENAI, body, &cap);
+
+    ASSERT(response && response->success, "Stream should parse");
+    ASSERT(strcmp(cap.text, "Let me look.") == 0, "Tokens should arrive in order");
+    ASSERT(strcmp(response->content, "Let me look.") == 0, "Content should be assembled");
+    ASSERT(strcmp(cap.completed_names, "read_file;list_directory;") == 0,
+           "Both calls should complete in order");
+    ASSERT(cap.deltas_at_first_call == 3,
+           "First call should complete when the second one starts");
+    ASSERT(response->tool_call_count == 2, "Response should carry both calls");
+    ASSERT(strcmp(response->tool_calls[0].id, "call_a") == 0, "Call id should be kept");
+    ASSERT(strcmp(response->tool_calls[0].arguments, "{\"path\":\"a.c\"}") == 0,
+           "Argument fragments should be joined");
+    ASSERT(response->total_tokens == 19 && response->prompt_tokens == 12,
+           "Usage should come from the final chunk");
+    ASSERT(response->first_token_sec > 0, "Time to first token should be recorded");
+
+    ai_response_free(response);
+    PASS();
+}
+
+void test_stream_other_dialects(void) {
+    TEST("ai_stream - Anthropic, Gemini and Ollama streams");
+
+    const char* anthropic =
+        "event: message_start\n"
+        "data: {\"type\":\"message_start\",\"message\":{\"usage\":{\"input_tokens\":30,"
+        "\"output_tokens\":1}}}\n\n"
+        "event: content_block_start\n"
+        "data: {\"type\":\"content_block_start\",\"index\":0,"
+        "\"content_block\":{\"type\":\"text\",\"text\":\"\"}}\n\n"
+        "event: content_block_delta\n"
+        "data: {\"type\":\"content_block_delta\",\"index\":0,"
+        "\"delta\":{\"type\":\"text_delta\",\"text\":\"Building\"}}\n\n"
+        "data: {\"type\":\"content_block_stop\",\"index\":0}\n\n"
+        "data: {\"type\":\"content_block_start\",\"index\":1,\"content_block\":"
+        "{\"type\":\"tool_use\",\"id\":\"toolu_1\",\"name\":\"execute\",\"input\":{}}}\n\n"
+        "data: {\"type\":\"content_block_delta\",\"index\":1,"
+        "\"delta\":{\"type\":\"input_json_delta\",\"partial_json\":\"{\\\"cmd\\\": \"}}\n\n"
+        "data: {\"type\":\"content_block_delta\",\"index\":1,"
+        "\"delta\":{\"type\":\"input_json_delta\",\"partial_json\":\"\\\"make\\\"}\"}}\n\n"
+        "data: {\"type\":\"content_block_stop\",\"index\":1}\n\n"
+        "data: {\"type\":\"message_delta\",\"delta\":{\"stop_reason\":\"tool_use\"},"
+        "\"usage\":{\"output_tokens\":9}}\n\n"
+        "data: {\"type\":\"message_stop\"}\n\n";
+
+    StreamCapture cap = {0};
+    AIResponse* response = stream_bytewise(AI_PROVIDER_ANTHROPIC, anthropic, &cap);
+    ASSERT(response && response->success, "Anthropic stream should parse");
+    ASSERT(strcmp(response->content, "Building") == 0, "Anthropic text should be assembled");
+    ASSERT(response->tool_call_count == 1 && cap.completed == 1, "tool_use should complete");
+    ASSERT(strcmp(response->tool_calls[0].arguments, "{\"cmd\": \"make\"}") == 0,
+           "partial_json should be joined");
+    ASSERT(response->prompt_tokens == 30 && response->completion_tokens == 9,
+           "Anthropic usage should be read");
+    ai_response_free(response);
+
+    /* Gemini without a trailing blank line: the last event is flushed at finish */
+    const char* gemini =
+        "data: {\"candidates\":[{\"content\":{\"parts\":[{\"text\":\"Hi \"}]}}]}\n\n"
+        "data: {\"candidates\":[{\"content\":{\"parts\":[{\"text\":\"there\"},"
+        "{\"functionCall\":{\"name\":\"search_files\",\"args\":{\"pattern\":\"*.c\"}}}]}}],"
+        "\"usageMetadata\":{\"promptTokenCount\":4,\"candidatesTokenCount\":2,"
+        "\"totalTokenCount\":6}}";
+
+    memset(&cap, 0, sizeof(cap));
+    response = stream_bytewise(AI_PROVIDER_GEMINI, gemini, &cap);
+    ASSERT(response && response->success, "Gemini stream should parse");
+    ASSERT(strcmp(cap.text, "Hi there") == 0, "Gemini text should stream");
+    ASSERT(response->tool_call_count == 1 &&
+           strcmp(response->tool_calls[0].arguments, "{\"pattern\":\"*.c\"}") == 0,
+           "functionCall should become a tool call");
+    ASSERT(response->total_tokens == 6, "Gemini usage should be read");
+    ai_response_free(response);
+
+    const char* ollama =
+        "{\"message\":{\"role\":\"assistant\",\"content\":\"Done\"},\"done\":false}\n"
+        "{\"message\":{\"role\":\"assistant\",\"content\":\".\"},\"done\":false}\n"
+        "{\"message\":{\"role\":\"assistant\",\"content\":\"\"},\"done\":true,"
+        "\"prompt_eval_count\":8,\"eval_count\":2}\n";
+
+    memset(&cap, 0, sizeof(cap));
+    response = stream_bytewise(AI_PROVIDER_OLLAMA, ollama, &cap);
+    ASSERT(response && response->success, "Ollama stream should parse");
+    ASSERT(strcmp(response->content, "Done.") == 0, "Ollama lines should be joined");
+    ASSERT(response->total_tokens == 10, "Ollama eval counts should be summed");
+    ai_response_free(response);
+
+    PASS();
+}
+
+void test_stream_errors_and_fallback(void) {
+    TEST("ai_stream - error events and unframed bodies");
+
+    StreamCapture cap = {0};
+    AIStreamCallbacks callbacks = {capture_token, capture_delta, capture_call, &cap};
+
+    /* A rejected request comes back as a plain JSON body, not a stream */
+    const char* rejected = "{\n  \"error\": {\n    \"message\": \"Invalid API key\"\n  }\n}\n";
+    AIStreamParser* parser = ai_stream_parser_create(AI_PROVIDER_OPENAI, &callbacks);
+    ASSERT(ai_stream_parser_feed(parser, rejected, strlen(rejected)),
+           "Unframed text should not stop the parser");
+    ASSERT(ai_stream_parser_finish(parser) == NULL, "No events should yield no response");
+    ASSERT(strstr(ai_stream_parser_unframed(parser), "Invalid API key") != NULL,
+           "Unframed body should be kept for the plain parser");
+    ai_stream_parser_free(parser);
+
+    /* An error event mid-stream stops reading; the open call never runs */
+    const char* failing =
+        "data: {\"choices\":[{\"delta\":{\"tool_calls\":[{\"index\":0,\"id\":\"c\","
+        "\"function\":{\"name\":\"execute\",\"arguments\":\"{\\\"cmd\"}}]}}]}\n\n"
+        "data: {\"error\":{\"message\":\"Overloaded\"}}\n\n"
+        "data: {\"choices\":[{\"delta\":{\"content\":\"late\"}}]}\n\n";
+    parser = ai_stream_parser_create(AI_PROVIDER_OPENAI, &callbacks);
+    ASSERT(!ai_stream_parser_feed(parser, failing, strlen(failing)),
+           "Error event should stop the stream");
+    AIResponse* response = ai_stream_parser_finish(parser);
+    ASSERT(response && !response->success && strcmp(response->error, "Overloaded") == 0,
+           "Error message should be reported");
+    ASSERT(cap.completed == 0 && cap.text[0] == '\0',
+           "Nothing after the error should be delivered");
+    ai_response_free(response);
+    ai_stream_parser_free(parser);
+
+    PASS();
+}
+
+/* ========================================================================
+ * Test: Response Cache
+ * ======================================================================== */
+
+#define CACHE_TEST_DIR "test_ai_cache_tmp"
+
+static AIResponse* make_response(const char* content) {
+    AIResponse* response = calloc(1, sizeof(AIResponse));
+    response->success = true;
+    response->content = strdup(content);
+    response->prompt_tokens = 12;
+    response->completion_tokens = 3;
+    response->total_tokens = 15;
+    return response;
+}
+
+static void set_entry_mtime(const char* key, time_t when) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s.json", CACHE_TEST_DIR, key);
+    struct utimbuf times = {when, when};
+    utime(path, &times);
+}
+
+void test_response_cache_roundtrip(void) {
+    TEST("ai_cache - store, hit and key normalization");
+
+    AIResponseCacheConfig config = ai_response_cache_config_default();
+    config.cache_dir = CACHE_TEST_DIR;
+    AIResponseCache* cache = ai_response_cache_open(&config);
+    ASSERT(cache != NULL, "Cache should open");
+    ai_response_cache_clear(cache);
+
+    /* Same error text with CRLF and trailing blanks keys the same */
+    const char* a[] = {"openai", "gpt-4o", "error: undefined reference to 'foo'\n  at main.c:3\n"};
+    const char* b[] = {"openai", "gpt-4o", "error: undefined reference to 'foo'  \r\n  at main.c:3"};
+    const char* c[] = {"openai", "gpt-4o-mini", "error: undefined reference to 'foo'\n  at main.c:3"};
+    const char* d[] = {"openai", "gpt-4o", NULL};
+    const char* e[] = {"openai", "gpt-4o", ""};
+    char ka[AI_CACHE_KEY_SIZE], kb[AI_CACHE_KEY_SIZE], kc[AI_CACHE_KEY_SIZE];
+    char kd[AI_CACHE_KEY_SIZE], ke[AI_CACHE_KEY_SIZE];
+    ai_response_cache_key(a, 3, ka);
+    ai_response_cache_key(b, 3, kb);
+    ai_response_cache_key(c, 3, kc);
+    ai_response_cache_key(d, 3, kd);
+    ai_response_cache_key(e, 3, ke);
+    ASSERT(strlen(ka) == 64, "Key should be a hex SHA-256 digest");
+    ASSERT(strcmp(ka, kb) == 0, "Whitespace differences should not change the key");
+    ASSERT(strcmp(ka, kc) != 0, "A different model should change the key");
+    ASSERT(strcmp(kd, ke) != 0, "NULL and empty parts should differ");
+
+    ASSERT(ai_response_cache_get(cache, ka) == NULL, "Empty cache should miss");
+
+    AIResponse* response = make_response("Link with -lfoo");
+    response->tool_calls = calloc(1, sizeof(AIToolCall));
+    response->tool_calls[0].id = strdup("call_1");
+    response->tool_calls[0].name = strdup("execute");
+    response->tool_calls[0].arguments = strdup("{\"cmd\":\"make\"}");
+    response->tool_call_count = 1;
+    ASSERT(ai_response_cache_put(cache, ka, response), "Successful response should be stored");
+    ai_response_free(response);
+
+    AIResponse failed = {0};
+    failed.error = "timeout";
+    ASSERT(!ai_response_cache_put(cache, kc, &failed), "Failures should not be stored");
+    ASSERT(!ai_response_cache_put(cache, "../escape", response), "Bad keys should be refused");
+
+    AIResponse* hit = ai_response_cache_get(cache, kb);
+    ASSERT(hit && hit->success && hit->cached, "Hit should be marked cached");
+    ASSERT(strcmp(hit->content, "Link with -lfoo") == 0, "Content should round-trip");
+    ASSERT(hit->tool_call_count == 1 && strcmp(hit->tool_calls[0].name, "execute") == 0 &&
+           strcmp(hit->tool_calls[0].arguments, "{\"cmd\":\"make\"}") == 0,
+           "Tool calls should round-trip");
+    ASSERT(hit->total_tokens == 15, "Usage should round-trip");
+    printf("  Hit served in %.0f us\n", hit->duration_sec * 1e6);
+    ai_response_free(hit);
+
+    AIResponseCacheStats stats = ai_response_cache_get_stats(cache);
+    ASSERT(stats.hits == 1 && stats.misses == 1 && stats.stores == 1 && stats.entries == 1,
+           "Stats should count the lookups and the store");
+
+    /* Entries outlive the cache object */
+    ai_response_cache_close(cache);
+    cache = ai_response_cache_open(&config);
+    hit = ai_response_cache_get(cache, ka);
+    ASSERT(hit != NULL, "Entry should persist across opens");
+    ai_response_free(hit);
+
+    ASSERT(ai_response_cache_clear(cache) == 1, "Clear should remove the entry");
+    ai_response_cache_close(cache);
+
+    PASS();
+}
+
+void test_response_cache_expiry_and_eviction(void) {
+    TEST("ai_cache - TTL expiry and LRU eviction");
+
+    AIResponseCacheConfig config = ai_response_cache_config_default();
+    config.cache_dir = CACHE_TEST_DIR;
+    config.ttl_sec = 3600;
+    config.max_bytes = 1300;
+    AIResponseCache* cache = ai_response_cache_open(&config);
+    ASSERT(cache != NULL, "Cache should open");
+    ai_response_cache_clear(cache);
+
+    /* An entry created before the TTL window is dropped on lookup */
+    const char* stale_parts[] = {"stale"};
+    char stale[AI_CACHE_KEY_SIZE];
+    ai_response_cache_key(stale_parts, 1, stale);
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s.json", CACHE_TEST_DIR, stale);
+    char entry[128];
+    snprintf(entry, sizeof(entry), "{\"created\":%ld,\"content\":\"old\"}",
+             (long)time(NULL) - 7200);
+    ASSERT(file_write(path, entry), "Should write a stale entry");
+    ASSERT(ai_response_cache_get(cache, stale) == NULL, "Expired entry should miss");
+    ASSERT(!file_exists(path), "Expired entry should be removed");
+    ASSERT(ai_response_cache_get_stats(cache).expired == 1, "Expiry should be counted");
+
+    /* Fill to the budget; entries get distinct ages, oldest first */
+    char padding[200];
+    memset(padding, 'x', sizeof(padding) - 1);
+    padding[sizeof(padding) - 1] = '\0';
+    char keys[5][AI_CACHE_KEY_SIZE];
+    time_t now = time(NULL);
+    for (int i = 0; i < 4; i++) {
+        char name[8];
+        snprintf(name, sizeof(name), "k%d", i);
+        const char* parts[] = {name};
+        ai_response_cache_key(parts, 1, keys[i]);
+        AIResponse* response = make_response(padding);
+        ASSERT(ai_response_cache_put(cache, keys[i], response), "Entry should be stored");
+        ai_response_free(response);
+        set_entry_mtime(keys[i], now - 100 + i);
+    }
+    ASSERT(ai_response_cache_get_stats(cache).evictions == 0, "Budget not exceeded yet");
+
+    /* Using the oldest entry protects it from eviction */
+    AIResponse* hit = ai_response_cache_get(cache, keys[0]);
+    ASSERT(hit != NULL, "Oldest entry should still be there");
+    ai_response_free(hit);
+
+    const char* parts[] = {"k4"};
+    ai_response_cache_key(parts, 1, keys[4]);
+    AIResponse* response = make_response(padding);
+    ASSERT(ai_response_cache_put(cache, keys[4], response), "Entry should be stored");
+    ai_response_free(response);
+
+    AIResponseCacheStats stats = ai_response_cache_get_stats(cache);
+    ASSERT(stats.evictions >= 1, "Exceeding the budget should evict");
+    ASSERT(stats.total_bytes <= 1170, "Eviction should go below 90% of the budget");
+
+    AIResponse* kept = ai_response_cache_get(cache, keys[0]);
+    AIResponse* evicted = ai_response_cache_get(cache, keys[1]);
+    AIResponse* newest = ai_response_cache_get(cache, keys[4]);
+    ASSERT(kept != NULL, "Recently used entry should survive");
+    ASSERT(evicted == NULL, "Least recently used entry should be evicted");
+    ASSERT(newest != NULL, "New entry should survive");
+    ai_response_free(kept);
+    ai_response_free(newest);
+
+    ai_response_cache_clear(cache);
+    ai_response_cache_close(cache);
+
+    PASS();
+}
+
+static char replayed[256];
+
+static void replay_token(const char* text, size_t len, void* user_data) {
+    (void)user_data;
+    strncat(replayed, text, len < sizeof(replayed) - strlen(replayed) - 1
+                                ? len : sizeof(replayed) - strlen(replayed) - 1);
+}
+
+void test_response_cache_provider(void) {
+    TEST("ai_cache - provider lookups skip the network");
+
+    AIResponseCacheConfig config = ai_response_cache_config_default();
+    config.cache_dir = CACHE_TEST_DIR;
+    AIResponseCache* cache = ai_response_cache_open(&config);
+    ASSERT(cache != NULL, "Cache should open");
+    ai_response_cache_clear(cache);
+
+    /* Nothing listens on this port, so only a cache hit can succeed */
+    AIProviderConfig* pc = ai_config_create("cached", AI_PROVIDER_OPENAI);
+    pc->base_url = strdup("http://127.0.0.1:9");
+    pc->model = strdup("gpt-4o");
+    pc->timeout_sec = 2;
+    AIProvider* provider = ai_provider_create(pc);
+    ai_config_free(pc);
+    ASSERT(provider != NULL, "Provider should be created");
+    ai_provider_set_response_cache(provider, cache);
+
+    AIRequest* request = ai_request_create();
+    ai_request_add_message(request, AI_ROLE_USER, "Why does the link fail?");
+
+    AIResponse* response = ai_provider_complete(provider, request);
+    ASSERT(response && !response->success && !response->cached,
+           "Unreachable provider should fail");
+    ai_response_free(response);
+    ASSERT(ai_response_cache_get_stats(cache).stores == 0, "Failure should not be cached");
+
+    /* Default max_tokens spelled out explicitly keys the same */
+    AIRequest* explicit = ai_request_create();
+    ai_request_add_message(explicit, AI_ROLE_USER, "Why does the link fail?\r\n");
+    explicit->max_tokens = provider->config.max_tokens;
+    char key[AI_CACHE_KEY_SIZE];
+    ai_response_cache_request_key(provider, explicit, key);
+    AIResponse* stored = make_response("Missing -lm");
+    ai_response_cache_put(cache, key, stored);
+    ai_response_free(stored);
+
+    response = ai_provider_complete(provider, request);
+    ASSERT(response && response->success && response->cached,
+           "Identical request should be served from the cache");
+    ASSERT(strcmp(response->content, "Missing -lm") == 0, "Cached content expected");
+    ai_response_free(response);
+
+    /* A streamed request is replayed through its callbacks */
+    AIStreamCallbacks callbacks = {replay_token, NULL, NULL, NULL};
+    request->stream = true;
+    request->stream_callbacks = &callbacks;
+    replayed[0] = '\0';
+    response = ai_provider_complete(provider, request);
+    ASSERT(response && response->cached && strcmp(replayed, "Missing -lm") == 0,
+           "Cached reply should be streamed");
+    ai_response_free(response);
+
+    request->temperature = 0.2f;
+    request->stream = false;
+    response = ai_provider_complete(provider, request);
+    ASSERT(response && !response->cached, "Different temperature should miss");
+    ai_response_free(response);
+
+    ai_request_free(request);
+    ai_request_free(explicit);
+    ai_provider_free(provider);
+    ai_response_cache_clear(cache);
+    ai_response_cache_close(cache);
+    dir_delete_recursive(CACHE_TEST_DIR);
+
+    PASS();
+}
+
+/* ========================================================================
+ * Test: Structured Output
+ * ======================================================================== */
+
+void test_schema_generation(void) {
+    TEST("ai_schema - GBNF and JSON Schema for the agent reply");
+
+    char* grammar = ai_schema_to_gbnf(ai_agent_response_schema());
+    ASSERT(grammar != NULL, "Grammar should be generated");
+    ASSERT(strstr(grammar, "\nroot ::= \"{\" ws \"\\\"message\\\"\"") != NULL,
+           "Root rule should open an object");
+    ASSERT(strstr(grammar, "root-actions ::= \"[\" ws") != NULL, "Array rule expected");
+    ASSERT(strstr(grammar, "\"\\\"run_command\\\"\"") != NULL, "Enum literal expected");
+    ASSERT(strstr(grammar, "( string | null )") != NULL, "Nullable member expected");
+    ASSERT(strstr(grammar, "\nws ::= ") != NULL, "Whitespace rule expected");
+    free(grammar);
+
+    char* schema_json = ai_schema_to_json_schema(ai_agent_response_schema());
+    ASSERT(schema_json != NULL, "JSON Schema should be generated");
+    cJSON* schema = cJSON_Parse(schema_json);
+    free(schema_json);
+    ASSERT(schema != NULL, "JSON Schema should be valid JSON");
+
+    cJSON* required = cJSON_GetObjectItem(schema, "required");
+    ASSERT(cJSON_GetArraySize(required) == 1 &&
+           strcmp(cJSON_GetArrayItem(required, 0)->valuestring, "message") == 0,
+           "Only message should be required");
+    cJSON* action = cJSON_GetObjectItem(cJSON_GetObjectItem(
+        cJSON_GetObjectItem(cJSON_GetObjectItem(schema, "properties"), "actions"), "items"),
+        "properties");
+    ASSERT(cJSON_GetArraySize(cJSON_GetObjectItem(cJSON_GetObjectItem(action, "action"), "enum")) == 10,
+           "Action enum should list every action");
+    ASSERT(cJSON_IsArray(cJSON_GetObjectItem(cJSON_GetObjectItem(action, "target"), "type")),
+           "Nullable member should allow null");
+    cJSON_Delete(schema);
+
+    PASS();
+}
+
+void test_schema_parse(void) {
+    TEST("ai_schema - locate, check and coerce replies");
+
+    static const AISchema fields[] = {
+        { .type = AI_SCHEMA_STRING, .name = "name", .required = true },
+        { .type = AI_SCHEMA_INTEGER, .name = "count" },
+        { .type = AI_SCHEMA_BOOLEAN, .name = "ok" },
+    };
+    static const AISchema schema = {
+        .type = AI_SCHEMA_OBJECT, .properties = fields, .property_count = 3
+    };
+    char error[256];
+
+    /* Braces in the prose before the reply are skipped */
+    cJSON* json = ai_schema_parse(&schema,
+        "Use {braces} like this:\n{\"name\": \"a \\\"b\\\"\", \"count\": \"3\", \"ok\": \"true\"} done",
+        error, sizeof(error));
+    ASSERT(json != NULL, "Reply after prose should parse");
+    ASSERT(strcmp(cJSON_GetObjectItem(json, "name")->valuestring, "a \"b\"") == 0,
+           "Escapes should be decoded");
+    ASSERT(ai_json_number(json, "count", 0) == 3, "Numeric string should be coerced");
+    ASSERT(ai_json_bool(json, "ok", false), "Boolean string should be coerced");
+    cJSON_Delete(json);
+
+    json = ai_schema_parse(&schema, "{\"count\": 1}", error, sizeof(error));
+    ASSERT(json == NULL, "Missing required member should fail");
+    ASSERT(strstr(error, "name") != NULL, "Error should name the member");
+
+    json = ai_schema_parse(&schema, "{\"name\": 5}", error, sizeof(error));
+    ASSERT(json == NULL, "Wrong type should fail");
+
+    json = ai_schema_parse(&schema, "no json here", error, sizeof(error));
+    ASSERT(json == NULL && error[0], "Plain text should fail with a reason");
+
+    PASS();
+}
+
+void test_parse_agent_response_robust(void) {
+    TEST("parse_ai_agent_response - prose, nested braces and bad actions");
+
+    const char* reply =
+        "Sure! Here is what I will do:\n"
+        "{\"message\": \"Creating main.c\", \"actions\": ["
+        "{\"action\": \"create_file\", \"target\": \"main.c\","
+        " \"content\": \"int main(void) {\\n    return 0;\\n}\\n\", \"reason\": null},"
+        "{\"action\": 7},"
+        "{\"action\": \"build\"}],"
+        " \"needs_confirmation\": false}";
+
+    AIAgentResponse* response = parse_ai_agent_response(reply);
+    ASSERT(response != NULL, "Response should not be NULL");
+    ASSERT(response->message && strcmp(response->message, "Creating main.c") == 0,
+           "Message should be extracted");
+    ASSERT(response->actions && response->actions->type == AI_ACTION_CREATE_FILE,
+           "First action should be CREATE_FILE");
+    ASSERT(strcmp(response->actions->content, "int main(void) {\n    return 0;\n}\n") == 0,
+           "Content with braces should survive");
+    ASSERT(response->actions->reason == NULL, "null reason should stay NULL");
+    ASSERT(response->actions->next && response->actions->next->type == AI_ACTION_BUILD,
+           "Malformed action should be dropped, the next one kept");
+    ASSERT(response->actions->next->next == NULL, "Should have two actions");
+    ASSERT(!response->needs_confirmation, "needs_confirmation should be read");
+
+    ai_agent_response_free(response);
+    PASS();
+}
+
+void test_response_schema_cache_key(void) {
+    TEST("ai_cache - response schema is part of the key");
+
+    AIProviderConfig* pc = ai_config_create("schema", AI_PROVIDER_OPENAI);
+    pc->base_url = strdup("http://127.0.0.1:9");
+    pc->model = strdup("gpt-4o");
+    AIProvider* provider = ai_provider_create(pc);
+    ai_config_free(pc);
+    ASSERT(provider != NULL, "Provider should be created");
+
+    AIRequest* request = ai_request_create();
+    ai_request_add_message(request, AI_ROLE_USER, "Plan the build");
+    char plain[AI_CACHE_KEY_SIZE], structured[AI_CACHE_KEY_SIZE];
+    ai_response_cache_request_key(provider, request, plain);
+    request->response_schema = ai_schema_to_json_schema(ai_agent_response_schema());
+    ai_response_cache_request_key(provider, request, structured);
+    ASSERT(strcmp(plain, structured) != 0, "Keys should differ");
+
+    ai_request_free(request);
+    ai_provider_free(provider);
+    PASS();
+}
+
+/* ========================================================================
+ * Test: Context Packing
+ * ======================================================================== */
+
+/* One token per character keeps the budgets below easy to follow */
+static int count_chars(const char* text, void* user_data) {
+    (void)user_data;
+    return (int)strlen(text);
+}
+
+void test_context_packer_priority(void) {
+    TEST("context_packer - newest kept, older summarized or dropped");
+
+    ContextPacker* packer = context_packer_create(80, count_chars, NULL);
+    ASSERT(packer != NULL, "Packer should be created");
+
+    ContextItem system = { .text = "SYS", .required = true };
+    ContextItem oldest = { .text = "oldest message, no summary to fall back on", .priority = -3 };
+    ContextItem older = { .text = "older message that is too long to fit here",
+                          .summary = "older", .priority = -2 };
+    ContextItem newest = { .text = "newest message, kept whole because it ranks first",
+                           .priority = -1 };
+    int s = context_packer_add(packer, &system);
+    int a = context_packer_add(packer, &oldest);
+    int b = context_packer_add(packer, &older);
+    int c = context_packer_add(packer, &newest);
+    ASSERT(s == 0 && a == 1 && b == 2 && c == 3, "Indices should follow insertion");
+
+    int used = context_packer_pack(packer);
+    ASSERT(used <= 80, "Packed items should fit the budget");
+    ASSERT(context_packer_form(packer, s) == CONTEXT_PACKED_FULL, "Required item kept");
+    ASSERT(context_packer_form(packer, c) == CONTEXT_PACKED_FULL, "Newest item kept whole");
+    ASSERT(context_packer_form(packer, b) == CONTEXT_PACKED_SUMMARY, "Older item summarized");
+    ASSERT(strcmp(context_packer_text(packer, b), "older") == 0, "Summary text returned");
+    ASSERT(context_packer_text(packer, a) == NULL, "Oldest item dropped");
+    ASSERT(context_packer_dropped(packer) == 1, "One item dropped");
+
+    context_packer_free(packer);
+
+    /* Required items stay whole even over budget */
+    packer = context_packer_create(10, count_chars, NULL);
+    ContextItem task = { .text = "the current task, longer than the whole budget",
+                         .required = true };
+    int t = context_packer_add(packer, &task);
+    ASSERT(context_packer_pack(packer) > 10, "Required item is charged anyway");
+    ASSERT(context_packer_form(packer, t) == CONTEXT_PACKED_FULL, "Required item kept");
+    context_packer_free(packer);
+
+    /* First-line summaries for items that do not fit */
+    char* summary = context_summarize_first_line("tool", "cc failed\nmore output");
+    ASSERT(summary && strcmp(summary, "[tool]: cc failed...") == 0, "Role and first line kept");
+    free(summary);
+    summary = context_summarize_first_line(NULL, "one line");
+    ASSERT(summary && strcmp(summary, "one line") == 0, "Short line kept as is");
+    free(summary);
+
+    PASS();
+}
+
+void test_context_packer_excerpt(void) {
+    TEST("context_packer - long output cut to head and tail");
+
+    char output[2048] = "";
+    for (int i = 0; i < 60; i++) {
+        char line[32];
+        snprintf(line, sizeof(line), "line %02d: compiler output\n", i);
+        strcat(output, line);
+    }
+
+    ContextPacker* packer = context_packer_create(300, count_chars, NULL);
+    ContextItem item = { .text = output, .summary = "build output", .excerpt = true };
+    int index = context_packer_add(packer, &item);
+    int used = context_packer_pack(packer);
+
+    const char* text = context_packer_text(packer, index);
+    ASSERT(context_packer_form(packer, index) == CONTEXT_PACKED_EXCERPT, "Should be excerpted");
+    ASSERT(used <= 300, "Excerpt should fit the budget");
+    ASSERT(strncmp(text, "line 00:", 8) == 0, "Head should be kept");
+    ASSERT(strstr(text, "line 59: compiler output\n") != NULL, "Tail should be kept");
+    ASSERT(strstr(text, "lines omitted") != NULL, "Cut should be marked");
+
+    context_packer_free(packer);
+
+    /* Unlimited budget keeps everything */
+    packer = context_packer_create(0, count_chars, NULL);
+    index = context_packer_add(packer, &item);
+    context_packer_pack(packer);
+    ASSERT(context_packer_text(packer, index) &&
+           strcmp(context_packer_text(packer, index), output) == 0,
+           "Unlimited budget should keep the full text");
+    context_packer_free(packer);
+
+    PASS();
+}
+
 /* ========================================================================
  * Main
  * ======================================================================== */
@@ -486,6 +1283,36 @@ int main(void) {
     test_parse_command_local_install();
     test_parse_command_local_unknown();
 
+    /* Provider HTTP tests */
+    printf("\n--- Provider HTTP Tests ---\n");
+    test_http_pool_shared();
+    test_http_pool_batch();
+    test_registry_health_and_hedging();
+
+    /* Streaming tests */
+    printf("\n--- Streaming Tests ---\n");
+    test_stream_openai_sse();
+    test_stream_other_dialects();
+    test_stream_errors_and_fallback();
+
+    /* Response cache tests */
+    printf("\n--- Response Cache Tests ---\n");
+    test_response_cache_roundtrip();
+    test_response_cache_expiry_and_eviction();
+    test_response_cache_provider();
+
+    /* Structured output tests */
+    printf("\n--- Structured Output Tests ---\n");
+    test_schema_generation();
+    test_schema_parse();
+    test_parse_agent_response_robust();
+    test_response_schema_cache_key();
+
+    /* Context packing tests */
+    printf("\n--- Context Packing Tests ---\n");
+    test_context_packer_priority();
+    test_context_packer_excerpt();
+
     /* Summary */
     printf("\n===========================================\n");
     printf("   Results: %d/%d tests passed\n", tests_passed, tests_run);
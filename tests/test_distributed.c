@@ -3,8 +3,16 @@
  * @brief Test suite for the distributed build system
  *
  * Tests core components of the distributed build infrastructure:
- * - Protocol codec (message serialization/deserialization)
+ * - Protocol codec (message serialization/deserialization, binary frames)
+ * - Chunked file transfer (windowing, checksums, resume)
+ * - Worker selection under send-queue backpressure
+ * - Indexed worker registry (hash lookups, capability bitmaps, snapshots)
+ * - Worker job execution (sandboxed compile/custom jobs, cached outputs)
+ * - Critical-path scheduling (bottom levels, duration history, simulation)
  * - Coordinator (configuration, lifecycle, token generation)
+ * - Token digests, HMAC-SHA256 and challenge-response
+ * - compile_commands.json streaming, interning and per-TU jobs
+ * - Local compile fan-out (jobserver-metered process pool, cached objects)
  * - Build options (configuration)
  * - Version and availability
  */
@@ -12,11 +20,25 @@
 #include "cyxmake/distributed/distributed.h"
 #include "cyxmake/distributed/protocol.h"
 #include "cyxmake/distributed/auth.h"
+#include "cyxmake/distributed/sha256.h"
+#include "cyxmake/distributed/job_history.h"
+#include "cyxmake/distributed/schedule_sim.h"
+#include "cyxmake/distributed/compile_db.h"
+#include "cyxmake/distributed/local_executor.h"
+#include "cyxmake/file_ops.h"
+#include "cyxmake/tool_executor.h"
 #include "cyxmake/logger.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef _WIN32
+#include <direct.h>
+#define rmdir _rmdir
+#else
+#include <unistd.h>
+#endif
+
 /* Test counters */
 static int tests_run = 0;
 static int tests_passed = 0;
@@ -126,6 +148,7 @@ static void test_authentication(void) {
         /* Validate token */
         AuthResult result = auth_token_validate(auth, token->token_value, NULL);
         TEST_ASSERT(result == AUTH_RESULT_SUCCESS, "Token validates successfully");
+        auth_token_free(token);
     }
 
     /* Test invalid token */
@@ -137,10 +160,11 @@ static void test_authentication(void) {
     TEST_ASSERT(admin_token != NULL, "Generate admin token");
     if (admin_token) {
         TEST_ASSERT(admin_token->type == AUTH_TOKEN_TYPE_ADMIN, "Admin token type correct");
-        /* Note: Don't free tokens generated via auth_token_generate - they're owned by the context */
+        /* The issued copy is the caller's; the context keeps its own digest */
+        auth_token_free(admin_token);
     }
 
-    /* Cleanup - context frees all tokens it owns */
+    /* Cleanup - context frees the stored tokens */
     auth_context_free(auth);
 
     printf("  Authentication tests complete\n");
@@ -317,6 +341,1496 @@ static void test_strategy_names(void) {
     printf("  Strategy names tests complete\n");
 }
 
+/* ============================================================
+ * Binary Frame Tests
+ * ============================================================ */
+
+static void test_binary_frames(void) {
+    printf("\n=== Test 7: Binary Frames ===\n");
+
+    ProtocolMessage* msg = protocol_message_create(PROTO_MSG_FILE_CHUNK);
+    TEST_ASSERT(msg != NULL, "Create FILE_CHUNK message");
+    if (!msg) return;
+
+    msg->correlation_id = strdup("request-1");
+    msg->sender_id = strdup("worker-1");
+    protocol_message_set_payload(msg, "{\"offset\":4096}");
+
+    uint8_t chunk[256];
+    for (size_t i = 0; i < sizeof(chunk); i++) chunk[i] = (uint8_t)i;
+    protocol_message_set_binary(msg, chunk, sizeof(chunk));
+
+    /* Binary round-trip keeps the raw tail */
+    size_t size = 0;
+    uint8_t* frame = protocol_message_encode(msg, PROTO_WIRE_BINARY, &size);
+    TEST_ASSERT(frame != NULL, "Encode binary frame");
+    TEST_ASSERT(size == protocol_message_encoded_size(msg), "Frame size matches estimate");
+    TEST_ASSERT(protocol_frame_is_binary(frame, size), "Frame has binary magic");
+    printf("  Binary frame: %zu bytes\n", size);
+
+    ProtocolMessage* decoded = protocol_message_decode(frame, size);
+    TEST_ASSERT(decoded != NULL, "Decode binary frame");
+    if (decoded) {
+        TEST_ASSERT(decoded->type == PROTO_MSG_FILE_CHUNK, "Decoded type matches");
+        TEST_ASSERT(decoded->timestamp == msg->timestamp, "Decoded timestamp matches");
+        TEST_ASSERT(decoded->id && strcmp(decoded->id, msg->id) == 0, "Decoded id matches");
+        TEST_ASSERT(decoded->correlation_id &&
+                    strcmp(decoded->correlation_id, "request-1") == 0,
+                    "Decoded correlation id matches");
+        TEST_ASSERT(decoded->payload_json &&
+                    strcmp(decoded->payload_json, "{\"offset\":4096}") == 0,
+                    "Decoded payload matches");
+        TEST_ASSERT(decoded->binary_size == sizeof(chunk) &&
+                    memcmp(decoded->binary_data, chunk, sizeof(chunk)) == 0,
+                    "Decoded binary tail matches");
+        protocol_message_free(decoded);
+    }
+
+    /* Truncated frames are rejected */
+    TEST_ASSERT(protocol_message_decode(frame, size - 1) == NULL, "Reject truncated frame");
+    free(frame);
+
+    /* JSON debug format carries binary data as base64 */
+    uint8_t* json = protocol_message_encode(msg, PROTO_WIRE_JSON, &size);
+    TEST_ASSERT(json != NULL && !protocol_frame_is_binary(json, size), "Encode JSON frame");
+    decoded = json ? protocol_message_decode(json, size) : NULL;
+    TEST_ASSERT(decoded != NULL, "Decode JSON frame");
+    if (decoded) {
+        TEST_ASSERT(decoded->binary_size == sizeof(chunk) &&
+                    memcmp(decoded->binary_data, chunk, sizeof(chunk)) == 0,
+                    "JSON frame preserves binary data");
+        protocol_message_free(decoded);
+    }
+    free(json);
+    protocol_message_free(msg);
+
+    /* Payload set without payload_size is still framed */
+    msg = protocol_message_create(PROTO_MSG_ERROR);
+    TEST_ASSERT(msg != NULL, "Create ERROR message");
+    if (!msg) return;
+    msg->payload_json = strdup("Registration failed");
+    frame = protocol_message_encode(msg, PROTO_WIRE_BINARY, &size);
+    decoded = frame ? protocol_message_decode(frame, size) : NULL;
+    TEST_ASSERT(decoded && decoded->payload_json &&
+                strcmp(decoded->payload_json, "Registration failed") == 0,
+                "Payload without payload_size survives binary frame");
+    protocol_message_free(decoded);
+    free(frame);
+
+    protocol_message_free(msg);
+    printf("  Binary frame tests complete\n");
+}
+
+/* ============================================================
+ * File Transfer Tests
+ * ============================================================ */
+
+#define TRANSFER_SRC "test_transfer_src.bin"
+#define TRANSFER_DIR "test_transfer_out"
+#define TRANSFER_FILE_SIZE (100 * 1024 + 123)
+
+/*
+ * Deliver sender output to the receiver in rounds (one window per round),
+ * feeding acks back after each round. Stops after max_messages deliveries
+ * to simulate a dropped connection (-1 = run to completion).
+ * If corrupt_offset is set, that chunk is damaged once in transit.
+ */
+static int run_transfer(FileTransferSender* sender, FileTransferReceiver* receiver,
+                        int max_messages, long corrupt_offset) {
+    int delivered = 0;
+    bool corrupted = false;
+
+    for (int round = 0; round < 1000; round++) {
+        ProtocolMessage* acks[64];
+        int ack_count = 0;
+        bool sent_any = false;
+
+        ProtocolMessage* msg;
+        while ((msg = file_transfer_sender_next(sender)) != NULL) {
+            sent_any = true;
+            if (max_messages >= 0 && delivered >= max_messages) {
+                protocol_message_free(msg);  /* Lost with the connection */
+                continue;
+            }
+            delivered++;
+
+            if (!corrupted && corrupt_offset >= 0 && msg->type == PROTO_MSG_FILE_CHUNK &&
+                msg->payload_json && strstr(msg->payload_json, "\"offset\":")) {
+                char needle[48];
+                snprintf(needle, sizeof(needle), "\"offset\":%ld,", corrupt_offset);
+                if (strstr(msg->payload_json, needle) && msg->binary_size > 0) {
+                    msg->binary_data[0] ^= 0xFF;
+                    corrupted = true;
+                }
+            }
+
+            ProtocolMessage* reply = NULL;
+            file_transfer_receiver_handle(receiver, msg, &reply);
+            if (reply && ack_count < 64) {
+                acks[ack_count++] = reply;
+            } else {
+                protocol_message_free(reply);
+            }
+            protocol_message_free(msg);
+        }
+
+        if (max_messages >= 0 && delivered >= max_messages) {
+            for (int i = 0; i < ack_count; i++) protocol_message_free(acks[i]);
+            return delivered;
+        }
+
+        for (int i = 0; i < ack_count; i++) {
+            file_transfer_sender_handle_ack(sender, acks[i]);
+            protocol_message_free(acks[i]);
+        }
+
+        FileTransferState state = file_transfer_sender_get_state(sender);
+        if (state == FILE_TRANSFER_COMPLETE || state == FILE_TRANSFER_FAILED) break;
+        if (!sent_any && ack_count == 0) break;  /* Stalled */
+    }
+
+    return delivered;
+}
+
+static bool files_equal(const char* a, const char* b) {
+    FILE* fa = fopen(a, "rb");
+    FILE* fb = fopen(b, "rb");
+    bool equal = fa && fb;
+    while (equal) {
+        int ca = fgetc(fa);
+        int cb = fgetc(fb);
+        if (ca != cb) equal = false;
+        if (ca == EOF || cb == EOF) break;
+    }
+    if (fa) fclose(fa);
+    if (fb) fclose(fb);
+    return equal;
+}
+
+static void test_file_transfer(void) {
+    printf("\n=== Test 8: File Transfer ===\n");
+
+    /* Source file with an odd size so the last chunk is partial */
+    FILE* f = fopen(TRANSFER_SRC, "wb");
+    TEST_ASSERT(f != NULL, "Create source file");
+    if (!f) return;
+    for (int i = 0; i < TRANSFER_FILE_SIZE; i++) fputc((i * 7 + 3) & 0xFF, f);
+    fclose(f);
+
+    TEST_ASSERT(file_transfer_crc32(0, "123456789", 9) == 0xCBF43926u, "CRC-32 check value");
+
+    FileTransferConfig config = file_transfer_config_default();
+    config.chunk_size = 4096;
+    config.window_chunks = 4;
+    config.ack_every = 2;
+
+    FileTransferReceiver* receiver = file_transfer_receiver_create(TRANSFER_DIR, &config);
+    TEST_ASSERT(receiver != NULL, "Create receiver");
+
+    /* Drop the connection part way through */
+    FileTransferSender* sender = file_transfer_sender_create(TRANSFER_SRC, NULL, &config);
+    TEST_ASSERT(sender != NULL, "Create sender");
+    if (!sender || !receiver) {
+        file_transfer_sender_free(sender);
+        file_transfer_receiver_free(receiver);
+        remove(TRANSFER_SRC);
+        return;
+    }
+
+    run_transfer(sender, receiver, 10, -1);
+    TEST_ASSERT(file_transfer_sender_get_state(sender) == FILE_TRANSFER_ACTIVE,
+                "Transfer interrupted mid-stream");
+    char* transfer_id = strdup(file_transfer_sender_get_id(sender));
+    file_transfer_sender_free(sender);
+
+    /* A fresh sender for the same file resumes from the partial data */
+    sender = file_transfer_sender_create(TRANSFER_SRC, NULL, &config);
+    TEST_ASSERT(sender && strcmp(file_transfer_sender_get_id(sender), transfer_id) == 0,
+                "Resend reuses transfer ID");
+
+    ProtocolMessage* start = file_transfer_sender_next(sender);
+    ProtocolMessage* reply = NULL;
+    file_transfer_receiver_handle(receiver, start, &reply);
+    TEST_ASSERT(reply != NULL, "START acknowledged");
+    if (reply) {
+        file_transfer_sender_handle_ack(sender, reply);
+        TEST_ASSERT(file_transfer_sender_get_acked(sender) > 0, "Resumed at non-zero offset");
+        printf("  Resumed at offset %llu\n",
+               (unsigned long long)file_transfer_sender_get_acked(sender));
+        protocol_message_free(reply);
+    }
+    protocol_message_free(start);
+
+    /* Corrupt one chunk; the checksum forces a retry */
+    run_transfer(sender, receiver, -1, 16 * 4096);
+    TEST_ASSERT(file_transfer_sender_get_state(sender) == FILE_TRANSFER_COMPLETE,
+                "Transfer completed after corruption retry");
+    TEST_ASSERT(file_transfer_receiver_get_active_count(receiver) == 0,
+                "No transfers left in progress");
+
+    char dest[256];
+    snprintf(dest, sizeof(dest), "%s/%s", TRANSFER_DIR, TRANSFER_SRC);
+    TEST_ASSERT(files_equal(TRANSFER_SRC, dest), "Received file matches source");
+
+    free(transfer_id);
+    file_transfer_sender_free(sender);
+    file_transfer_receiver_free(receiver);
+    remove(dest);
+
+    /* A receiver configured to ack less often than the sender's window allows */
+    FileTransferConfig sparse = config;
+    sparse.window_chunks = 16;
+    sparse.ack_every = 16;
+    FileTransferConfig narrow = config;
+    narrow.window_chunks = 2;
+    narrow.ack_every = 1;
+    receiver = file_transfer_receiver_create(TRANSFER_DIR, &sparse);
+    sender = file_transfer_sender_create(TRANSFER_SRC, NULL, &narrow);
+    if (sender && receiver) run_transfer(sender, receiver, -1, -1);
+    TEST_ASSERT(sender && file_transfer_sender_get_state(sender) == FILE_TRANSFER_COMPLETE,
+                "Receiver acks within the sender's window");
+    file_transfer_sender_free(sender);
+    file_transfer_receiver_free(receiver);
+    remove(dest);
+
+    /* Every message fails to send once; rewinding resends it intact */
+    receiver = file_transfer_receiver_create(TRANSFER_DIR, &config);
+    sender = file_transfer_sender_create(TRANSFER_SRC, NULL, &config);
+    for (int round = 0; sender && receiver && round < 1000; round++) {
+        ProtocolMessage* msg = file_transfer_sender_next(sender);
+        if (!msg) break;
+        protocol_message_free(msg);
+        file_transfer_sender_rewind(sender);
+
+        msg = file_transfer_sender_next(sender);
+        ProtocolMessage* ack = NULL;
+        file_transfer_receiver_handle(receiver, msg, &ack);
+        if (ack) file_transfer_sender_handle_ack(sender, ack);
+        protocol_message_free(ack);
+        protocol_message_free(msg);
+    }
+    TEST_ASSERT(sender && file_transfer_sender_get_state(sender) == FILE_TRANSFER_COMPLETE &&
+                files_equal(TRANSFER_SRC, dest),
+                "Rewound messages are resent after a failed send");
+    file_transfer_sender_free(sender);
+    file_transfer_receiver_free(receiver);
+
+    remove(dest);
+    remove(TRANSFER_SRC);
+    rmdir(TRANSFER_DIR);
+
+    printf("  File transfer tests complete\n");
+}
+
+/* ============================================================
+ * Worker Selection Tests
+ * ============================================================ */
+
+static void test_congested_workers(void) {
+    printf("\n=== Test 9: Congested Worker Selection ===\n");
+
+    WorkerRegistryConfig config = worker_registry_config_default();
+    WorkerRegistry* registry = worker_registry_create(&config);
+    TEST_ASSERT(registry != NULL, "Create registry");
+    if (!registry) return;
+
+    WorkerSystemInfo big = {0};
+    big.cpu_cores = 16;
+    WorkerSystemInfo small = {0};
+    small.cpu_cores = 2;
+
+    RemoteWorker* fast = worker_registry_register(registry, &big, NULL);
+    RemoteWorker* slow = worker_registry_register(registry, &small, NULL);
+    TEST_ASSERT(fast && slow, "Register two workers");
+    if (!fast || !slow) {
+        worker_registry_free(registry);
+        return;
+    }
+
+    WorkerSelectionCriteria criteria = {0};
+    criteria.min_available_slots = 1;
+    criteria.prefer_idle = true;
+
+    worker_registry_update_job_count(registry, slow, 1);
+    TEST_ASSERT(worker_registry_select_worker(registry, &criteria) == fast,
+                "Idle worker preferred");
+
+    worker_registry_set_congested(registry, fast, true);
+    TEST_ASSERT(worker_registry_select_worker(registry, &criteria) == slow,
+                "Congested worker skipped");
+
+    RemoteWorker* picked[2] = {0};
+    TEST_ASSERT(worker_registry_select_workers(registry, &criteria, 2, picked) == 1 &&
+                picked[0] == slow, "Congested worker excluded from multi-select");
+
+    worker_registry_set_congested(registry, slow, true);
+    TEST_ASSERT(worker_registry_select_worker(registry, &criteria) == NULL,
+                "No worker while all are congested");
+
+    worker_registry_set_congested(registry, fast, false);
+    TEST_ASSERT(worker_registry_select_worker(registry, &criteria) == fast,
+                "Worker selectable again once drained");
+
+    worker_registry_free(registry);
+
+    printf("  Worker selection tests complete\n");
+}
+
+/* ============================================================
+ * Worker Execution Tests
+ * ============================================================ */
+
+#define WORKER_SANDBOX "test_worker_sandbox"
+#define WORKER_CACHE "test_worker_cache"
+#define WORKER_SRC "test_worker_job.c"
+
+static bool write_text(const char* path, const char* text) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fputs(text, f);
+    fclose(f);
+    return true;
+}
+
+static void test_worker_execution(void) {
+    printf("\n=== Test 10: Worker Job Execution ===\n");
+
+    ArtifactCacheConfig cache_config = artifact_cache_config_default();
+    cache_config.cache_dir = WORKER_CACHE;
+    ArtifactCache* cache = artifact_cache_create(&cache_config);
+    TEST_ASSERT(cache && artifact_cache_init(cache), "Create worker cache");
+    if (!cache) return;
+
+    /* Custom jobs run through the shell inside the job sandbox */
+    DistributedJob custom = {0};
+    custom.job_id = "job-custom";
+    custom.type = JOB_TYPE_CUSTOM;
+    custom.build_command = "echo distributed > out.txt";
+    custom.output_file = "out.txt";
+
+    DistributedJobResult* result = worker_execute_job(&custom, WORKER_SANDBOX, cache, false);
+    TEST_ASSERT(result && result->success, "Custom job succeeded");
+    TEST_ASSERT(result && result->artifact_count == 1 &&
+                strcmp(result->artifact_paths[0], "out.txt") == 0,
+                "Custom job reports its output");
+    TEST_ASSERT(result && result->artifact_count == 1 &&
+                artifact_cache_contains(cache, result->artifact_hashes[0]),
+                "Output stored in cache under its content hash");
+    distributed_job_result_free(result);
+
+    custom.build_command = "exit 0";
+    result = worker_execute_job(&custom, WORKER_SANDBOX, cache, false);
+    TEST_ASSERT(result && !result->success && result->artifact_count == 0,
+                "Missing output fails the job");
+    distributed_job_result_free(result);
+
+    /* Inputs are read in place, so a missing one is rejected up front */
+    DistributedJob missing = {0};
+    missing.job_id = "job-missing";
+    missing.type = JOB_TYPE_COMPILE;
+    missing.compiler = "cc";
+    missing.source_file = "test_worker_missing.c";
+
+    result = worker_execute_job(&missing, WORKER_SANDBOX, cache, false);
+    TEST_ASSERT(result && !result->success && result->stderr_output &&
+                strstr(result->stderr_output, "not found on worker"),
+                "Missing input rejects the job");
+    distributed_job_result_free(result);
+
+    /* Compile jobs need a C compiler on PATH */
+    char* cc = tool_find_in_path("cc");
+    if (cc) {
+        write_text(WORKER_SRC, "int worker_answer(void) { return 42; }\n");
+
+        DistributedJob compile = {0};
+        compile.job_id = "job-compile";
+        compile.type = JOB_TYPE_COMPILE;
+        compile.compiler = "cc";
+        compile.source_file = WORKER_SRC;
+        compile.output_file = "obj/test_worker_job.o";
+        compile.timeout_sec = 60;
+
+        result = worker_execute_job(&compile, WORKER_SANDBOX, cache, true);
+        TEST_ASSERT(result && result->success, "Compile job succeeded");
+        TEST_ASSERT(result && result->artifact_count == 1 &&
+                    artifact_cache_contains(cache, result->artifact_hashes[0]),
+                    "Object file cached");
+        distributed_job_result_free(result);
+
+        write_text(WORKER_SRC, "int worker_answer(void) { return }\n");
+        result = worker_execute_job(&compile, WORKER_SANDBOX, cache, true);
+        TEST_ASSERT(result && !result->success && result->exit_code != 0,
+                    "Broken source fails to compile");
+        TEST_ASSERT(result && result->stderr_output && result->stderr_output[0],
+                    "Compiler diagnostics returned");
+        distributed_job_result_free(result);
+
+        remove(WORKER_SRC);
+        free(cc);
+    } else {
+        printf("  (no C compiler on PATH, compile jobs skipped)\n");
+    }
+
+    /* rmdir only succeeds if every per-job sandbox was removed */
+    TEST_ASSERT(rmdir(WORKER_SANDBOX) == 0, "Job sandboxes cleaned up");
+
+    artifact_cache_free(cache);
+    dir_delete_recursive(WORKER_CACHE);
+
+    printf("  Worker execution tests complete\n");
+}
+
+/* ============================================================
+ * Critical-Path Scheduling Tests
+ * ============================================================ */
+
+#define HISTORY_FILE "test_job_history"
+
+typedef struct {
+    ScheduledJob* order[4];
+    int count;
+} AssignLog;
+
+static void record_assignment(WorkScheduler* scheduler, ScheduledJob* job,
+                              RemoteWorker* worker, void* user_data) {
+    (void)scheduler;
+    (void)worker;
+    AssignLog* log = (AssignLog*)user_data;
+    if (log->count < 4) log->order[log->count++] = job;
+}
+
+static void test_critical_path_scheduling(void) {
+    printf("\n=== Test 11: Critical-Path Scheduling ===\n");
+
+    /* Four short jobs submitted ahead of a long two-job chain */
+    int chain_dep[] = { 4 };
+    SimJob dag[6] = {
+        { 1.0, NULL, 0 }, { 1.0, NULL, 0 }, { 1.0, NULL, 0 }, { 1.0, NULL, 0 },
+        { 4.0, NULL, 0 }, { 4.0, chain_dep, 1 }
+    };
+    double levels[6];
+    TEST_ASSERT(schedule_critical_path(dag, 6, levels), "DAG has no cycle");
+    TEST_ASSERT(levels[4] == 8.0 && levels[5] == 4.0 && levels[0] == 1.0,
+                "Bottom levels include downstream work");
+
+    SimWorker workers[2] = { { 1, 1.0 }, { 1, 1.0 } };
+    double fifo = schedule_simulate(dag, 6, workers, 2, SIM_POLICY_FIFO);
+    double rr = schedule_simulate(dag, 6, workers, 2, SIM_POLICY_ROUND_ROBIN);
+    double cp = schedule_simulate(dag, 6, workers, 2, SIM_POLICY_CRITICAL_PATH);
+    printf("  Makespan: FIFO %.1fs, round-robin %.1fs, critical path %.1fs\n", fifo, rr, cp);
+    TEST_ASSERT(fifo == 10.0, "FIFO starts the chain late");
+    TEST_ASSERT(cp == 8.0 && cp < rr, "Critical path finishes at the lower bound");
+    TEST_ASSERT(schedule_lower_bound(dag, 6, workers, 2) == 8.0, "Lower bound is the chain");
+
+    int cycle_a[] = { 1 }, cycle_b[] = { 0 };
+    SimJob cyclic[2] = { { 1.0, cycle_a, 1 }, { 1.0, cycle_b, 1 } };
+    TEST_ASSERT(schedule_simulate(cyclic, 2, workers, 2, SIM_POLICY_FIFO) < 0,
+                "Cyclic graph rejected");
+
+    /* Durations persist across runs */
+    remove(HISTORY_FILE);
+    JobHistory* history = job_history_create(HISTORY_FILE);
+    TEST_ASSERT(history != NULL, "Create job history");
+    if (history) {
+        TEST_ASSERT(job_history_estimate(history, "abc") < 0, "Unknown digest has no estimate");
+        job_history_record(history, "abc", 2.0);
+        job_history_record(history, "abc", 4.0);
+        double estimate = job_history_estimate(history, "abc");
+        TEST_ASSERT(estimate > 2.0 && estimate < 4.0, "Repeated samples are averaged");
+        TEST_ASSERT(job_history_save(history), "Save job history");
+        job_history_free(history);
+
+        history = job_history_create(HISTORY_FILE);
+        TEST_ASSERT(history && job_history_count(history) == 1 &&
+                    job_history_estimate(history, "abc") > 2.0,
+                    "History reloaded from disk");
+        job_history_free(history);
+    }
+    remove(HISTORY_FILE);
+
+    /* The scheduler runs the head of the longest chain first */
+    WorkerRegistryConfig reg_config = worker_registry_config_default();
+    WorkerRegistry* registry = worker_registry_create(&reg_config);
+    WorkerSystemInfo info = {0};
+    info.cpu_cores = 4;
+    RemoteWorker* worker = registry ? worker_registry_register(registry, &info, NULL) : NULL;
+    WorkScheduler* scheduler = registry ? scheduler_create(NULL, registry) : NULL;
+    TEST_ASSERT(worker && scheduler, "Create scheduler with one worker");
+
+    if (worker && scheduler) {
+        worker_registry_set_profile(registry, worker, NULL, 0, 2);
+
+        AssignLog log = {0};
+        SchedulerCallbacks callbacks = {0};
+        callbacks.on_job_assigned = record_assignment;
+        callbacks.user_data = &log;
+        scheduler_set_callbacks(scheduler, &callbacks);
+
+        DistributedJob specs[3] = {0};
+        specs[0].type = JOB_TYPE_CUSTOM;
+        specs[0].build_command = "true # short";
+        specs[1].type = JOB_TYPE_CUSTOM;
+        specs[1].build_command = "true # chain head";
+        specs[2].type = JOB_TYPE_CUSTOM;
+        specs[2].build_command = "true # chain tail";
+
+        BuildSession* build = scheduler_create_build(scheduler, "cp-test",
+                                                     DIST_STRATEGY_COMPILE_UNITS);
+        ScheduledJob* shorter = scheduler_submit_job(scheduler, build->build_id, &specs[0], 0);
+        ScheduledJob* head = scheduler_submit_job(scheduler, build->build_id, &specs[1], 0);
+        ScheduledJob* tail = scheduler_submit_job(scheduler, build->build_id, &specs[2], 0);
+        TEST_ASSERT(scheduler_add_job_dependency(scheduler, tail, head->job_id),
+                    "Add job dependency");
+
+        scheduler_start(scheduler);
+        scheduler_start_build(scheduler, build->build_id);
+        TEST_ASSERT(head->critical_path_sec > shorter->critical_path_sec,
+                    "Chain head has the longer critical path");
+
+        TEST_ASSERT(scheduler_process_queue(scheduler) == 2, "Blocked job does not stall the queue");
+        TEST_ASSERT(log.count == 2 && log.order[0] == head && log.order[1] == shorter,
+                    "Longest path assigned first");
+
+        DistributedJobResult done = {0};
+        done.success = true;
+        done.duration_sec = 1.0;
+        scheduler_report_job_result(scheduler, head->job_id, &done);
+        TEST_ASSERT(scheduler_process_queue(scheduler) == 1 && log.order[2] == tail,
+                    "Dependent job runs once its dependency completes");
+
+        scheduler_free(scheduler);
+    }
+    worker_registry_free(registry);
+
+    /* Measured slowness steers work to the faster worker */
+    registry = worker_registry_create(&reg_config);
+    RemoteWorker* fast = registry ? worker_registry_register(registry, &info, NULL) : NULL;
+    RemoteWorker* slow = registry ? worker_registry_register(registry, &info, NULL) : NULL;
+    if (fast && slow) {
+        worker_registry_record_job_speed(registry, slow, 3.0);
+        worker_registry_record_job_speed(registry, fast, 0.5);
+
+        WorkerSelectionCriteria criteria = {0};
+        criteria.min_available_slots = 1;
+        criteria.prefer_fast = true;
+        worker_registry_update_job_count(registry, fast, 1);
+        TEST_ASSERT(worker_registry_select_worker(registry, &criteria) == fast,
+                    "Fastest worker preferred over an idle slow one");
+    }
+    worker_registry_free(registry);
+
+    printf("  Critical-path scheduling tests complete\n");
+}
+
+/* ============================================================
+ * Test: Timer Wheel and Event-Driven Dispatch
+ * ============================================================ */
+
+typedef struct {
+    int fired[8];
+    int count;
+} FireLog;
+
+typedef struct {
+    FireLog* log;
+    int tag;
+} FireTag;
+
+static void record_fire(void* user_data) {
+    FireTag* tag = (FireTag*)user_data;
+    if (tag->log->count < 8) tag->log->fired[tag->log->count++] = tag->tag;
+}
+
+static void count_dispatch(WorkScheduler* scheduler, void* user_data) {
+    (void)scheduler;
+    (*(int*)user_data)++;
+}
+
+static void test_event_dispatch(void) {
+    printf("\n=== Test 12: Timer Wheel and Event-Driven Dispatch ===\n");
+
+    /* 10ms ticks, 8 slots: the 500ms timer wraps the wheel several times */
+    TimerWheel* wheel = timer_wheel_create(10, 8);
+    TEST_ASSERT(wheel != NULL, "Create timer wheel");
+    if (wheel) {
+        FireLog log = {0};
+        FireTag late = { &log, 1 }, early = { &log, 2 }, cancelled = { &log, 3 }, repeat = { &log, 4 };
+        uint64_t now = timer_wheel_now_ms();
+
+        timer_wheel_schedule(wheel, 500, 0, record_fire, &late, NULL);
+        timer_wheel_schedule(wheel, 30, 0, record_fire, &early, NULL);
+        TimerId id = timer_wheel_schedule(wheel, 40, 0, record_fire, &cancelled, NULL);
+        TimerId periodic = timer_wheel_schedule(wheel, 100, 100, record_fire, &repeat, NULL);
+        TEST_ASSERT(timer_wheel_count(wheel) == 4, "Four timers pending");
+
+        int64_t delay = timer_wheel_next_delay_ms(wheel, now);
+        TEST_ASSERT(delay > 0 && delay <= 40, "Next delay is the earliest timer");
+
+        TEST_ASSERT(timer_wheel_cancel(wheel, id), "Cancel pending timer");
+        TEST_ASSERT(!timer_wheel_cancel(wheel, id), "Second cancel is rejected");
+
+        TEST_ASSERT(timer_wheel_advance(wheel, now + 60) == 1 && log.fired[0] == 2,
+                    "Only the due timer fires");
+        TEST_ASSERT(timer_wheel_advance(wheel, now + 120) == 1 && log.fired[1] == 4,
+                    "Periodic timer fires");
+        TEST_ASSERT(timer_wheel_advance(wheel, now + 230) == 1 && log.fired[2] == 4,
+                    "Periodic timer fires again");
+        TEST_ASSERT(timer_wheel_advance(wheel, now + 520) == 2 &&
+                    (log.fired[3] == 1 || log.fired[4] == 1),
+                    "Timer past several rotations fires on time");
+        TEST_ASSERT(timer_wheel_count(wheel) == 1, "Periodic timer stays armed");
+        TEST_ASSERT(timer_wheel_cancel(wheel, periodic) && timer_wheel_count(wheel) == 0,
+                    "Cancel periodic timer");
+        TEST_ASSERT(timer_wheel_next_delay_ms(wheel, now) == -1, "Empty wheel has no delay");
+
+        timer_wheel_free(wheel);
+    }
+
+    /* Scheduler events request a dispatch instead of waiting for a poll */
+    WorkerRegistryConfig reg_config = worker_registry_config_default();
+    WorkerRegistry* registry = worker_registry_create(&reg_config);
+    WorkerSystemInfo info = {0};
+    info.cpu_cores = 1;
+    RemoteWorker* worker = registry ? worker_registry_register(registry, &info, NULL) : NULL;
+    WorkScheduler* scheduler = registry ? scheduler_create(NULL, registry) : NULL;
+    TEST_ASSERT(worker && scheduler, "Create scheduler with one worker");
+
+    if (worker && scheduler) {
+        worker_registry_set_profile(registry, worker, NULL, 0, 1);
+
+        int dispatches = 0;
+        SchedulerCallbacks callbacks = {0};
+        callbacks.on_dispatch_needed = count_dispatch;
+        callbacks.user_data = &dispatches;
+        scheduler_set_callbacks(scheduler, &callbacks);
+        scheduler_start(scheduler);
+
+        DistributedJob specs[2] = {0};
+        specs[0].type = JOB_TYPE_CUSTOM;
+        specs[0].build_command = "true # first";
+        specs[1].type = JOB_TYPE_CUSTOM;
+        specs[1].build_command = "true # second";
+
+        ScheduledJob* first = scheduler_submit_job(scheduler, NULL, &specs[0], 0);
+        ScheduledJob* second = scheduler_submit_job(scheduler, NULL, &specs[1], 0);
+        TEST_ASSERT(dispatches == 2, "Each submit requests a dispatch");
+
+        TEST_ASSERT(scheduler_process_queue(scheduler) == 1, "One slot, one assignment");
+        ScheduledJob* running = first->state == JOB_STATE_ASSIGNED ? first : second;
+        ScheduledJob* waiting = running == first ? second : first;
+
+        /* A timer that fires before the deadline leaves the job alone */
+        TEST_ASSERT(!scheduler_check_job_timeout(scheduler, running->job_id),
+                    "Job within its deadline keeps running");
+
+        DistributedJobResult done = {0};
+        done.success = true;
+        done.duration_sec = 0.5;
+        scheduler_report_job_result(scheduler, running->job_id, &done);
+        TEST_ASSERT(dispatches == 3, "Completion requests a dispatch");
+        TEST_ASSERT(scheduler_process_queue(scheduler) == 1 &&
+                    waiting->state == JOB_STATE_ASSIGNED,
+                    "Freed slot goes to the waiting job");
+
+        waiting->deadline = time(NULL) - 1;
+        TEST_ASSERT(scheduler_check_job_timeout(scheduler, waiting->job_id),
+                    "Overdue job times out");
+        TEST_ASSERT(waiting->state == JOB_STATE_RETRY && dispatches == 4,
+                    "Timed-out job is requeued and dispatch requested");
+
+        scheduler_free(scheduler);
+    }
+    worker_registry_free(registry);
+
+    printf("  Event dispatch tests complete\n");
+}
+
+/* ============================================================
+ * Test: Job Batching
+ * ============================================================ */
+
+typedef struct {
+    int batches;
+    int batch_size;
+    int singles;
+} BatchLog;
+
+static void record_batch(WorkScheduler* scheduler, ScheduledJob** jobs, int count,
+                         RemoteWorker* worker, void* user_data) {
+    (void)scheduler;
+    (void)jobs;
+    (void)worker;
+    BatchLog* log = (BatchLog*)user_data;
+    log->batches++;
+    log->batch_size = count;
+}
+
+static void record_single(WorkScheduler* scheduler, ScheduledJob* job,
+                          RemoteWorker* worker, void* user_data) {
+    (void)scheduler;
+    (void)job;
+    (void)worker;
+    ((BatchLog*)user_data)->singles++;
+}
+
+static void test_job_batching(void) {
+    printf("\n=== Test 13: Job Batching ===\n");
+
+    TEST_ASSERT(strcmp(protocol_message_type_name(PROTO_MSG_JOB_BATCH), "JOB_BATCH") == 0,
+                "JOB_BATCH message type named");
+    const char* cap_names[] = { "COMPILE_C", "JOB_BATCH" };
+    TEST_ASSERT(worker_capabilities_parse(cap_names, 2) ==
+                (WORKER_CAP_COMPILE_C | WORKER_CAP_JOB_BATCH),
+                "JOB_BATCH capability parsed");
+
+    WorkerRegistryConfig reg_config = worker_registry_config_default();
+    WorkerRegistry* registry = worker_registry_create(&reg_config);
+    WorkerSystemInfo info = {0};
+    info.cpu_cores = 4;
+    RemoteWorker* worker = registry ? worker_registry_register(registry, &info, NULL) : NULL;
+    WorkScheduler* scheduler = registry ? scheduler_create(NULL, registry) : NULL;
+    TEST_ASSERT(worker && scheduler, "Create scheduler with one worker");
+
+    if (worker && scheduler) {
+        worker_registry_set_profile(registry, worker, NULL,
+                                    WORKER_CAP_COMPILE_C | WORKER_CAP_COMPILE_CPP |
+                                    WORKER_CAP_JOB_BATCH, 4);
+
+        BatchLog log = {0};
+        SchedulerCallbacks callbacks = {0};
+        callbacks.on_job_assigned = record_single;
+        callbacks.on_batch_assigned = record_batch;
+        callbacks.user_data = &log;
+        scheduler_set_callbacks(scheduler, &callbacks);
+        scheduler_start(scheduler);
+
+        DistributedJob specs[5] = {0};
+        ScheduledJob* jobs[5];
+        for (int i = 0; i < 5; i++) {
+            specs[i].type = JOB_TYPE_COMPILE;
+            specs[i].source_file = "missing.c";
+            specs[i].compiler = "cc";
+            jobs[i] = scheduler_submit_job(scheduler, NULL, &specs[i], 0);
+        }
+
+        TEST_ASSERT(scheduler_process_queue(scheduler) == 4, "Four slots filled");
+        TEST_ASSERT(log.batches == 1 && log.batch_size == 4 && log.singles == 0,
+                    "Short compiles sent as one batch sized to free slots");
+
+        SchedulerStats stats = scheduler_get_stats(scheduler);
+        TEST_ASSERT(stats.batches_dispatched == 1 && stats.messages_saved == 3,
+                    "Stats count the requests saved");
+
+        /* Results still arrive per job, and one failure retries alone */
+        DistributedJobResult failed = {0};
+        failed.success = false;
+        scheduler_report_job_result(scheduler, jobs[0]->job_id, &failed);
+        TEST_ASSERT(jobs[0]->state == JOB_STATE_RETRY, "Failed unit retries on its own");
+        TEST_ASSERT(jobs[1]->state == JOB_STATE_ASSIGNED, "Rest of the batch unaffected");
+
+        TEST_ASSERT(scheduler_process_queue(scheduler) == 1 && log.singles == 1,
+                    "Single free slot takes one job without a batch");
+
+        scheduler_free(scheduler);
+    }
+    worker_registry_free(registry);
+
+    printf("  Job batching tests complete\n");
+}
+
+typedef struct {
+    int assigned;
+    char revoked_from[64];
+} SpeculationLog;
+
+static void record_assigned(WorkScheduler* scheduler, ScheduledJob* job,
+                            RemoteWorker* worker, void* user_data) {
+    (void)scheduler;
+    (void)job;
+    (void)worker;
+    ((SpeculationLog*)user_data)->assigned++;
+}
+
+static void record_revoked(WorkScheduler* scheduler, ScheduledJob* job,
+                           const char* worker_id, void* user_data) {
+    (void)scheduler;
+    (void)job;
+    SpeculationLog* log = (SpeculationLog*)user_data;
+    snprintf(log->revoked_from, sizeof(log->revoked_from), "%s", worker_id);
+}
+
+static void test_speculative_execution(void) {
+    printf("\n=== Test 14: Speculative Execution ===\n");
+
+    WorkerRegistryConfig reg_config = worker_registry_config_default();
+    WorkerRegistry* registry = worker_registry_create(&reg_config);
+    WorkerSystemInfo info = {0};
+    info.cpu_cores = 1;
+    RemoteWorker* first = registry ? worker_registry_register(registry, &info, NULL) : NULL;
+    RemoteWorker* second = registry ? worker_registry_register(registry, &info, NULL) : NULL;
+
+    SchedulerConfig config = scheduler_config_default();
+    TEST_ASSERT(!config.enable_speculative, "Speculation is opt-in");
+    config.enable_speculative = true;
+    WorkScheduler* scheduler = registry ? scheduler_create(&config, registry) : NULL;
+    TEST_ASSERT(first && second && scheduler, "Create scheduler with two workers");
+
+    if (first && second && scheduler) {
+        worker_registry_set_profile(registry, first, NULL, 0, 1);
+        worker_registry_set_profile(registry, second, NULL, 0, 1);
+
+        SpeculationLog log = {0};
+        SchedulerCallbacks callbacks = {0};
+        callbacks.on_job_assigned = record_assigned;
+        callbacks.on_job_revoked = record_revoked;
+        callbacks.user_data = &log;
+        scheduler_set_callbacks(scheduler, &callbacks);
+        scheduler_start(scheduler);
+
+        DistributedJob spec = {0};
+        spec.type = JOB_TYPE_CUSTOM;
+        spec.build_command = "true";
+        spec.output_file = "out/job.o";
+        ScheduledJob* job = scheduler_submit_job(scheduler, NULL, &spec, 0);
+        TEST_ASSERT(job && scheduler_process_queue(scheduler) == 1, "Job assigned");
+
+        if (job) {
+            TEST_ASSERT(scheduler_speculate_stragglers(scheduler) == 0,
+                        "Job within its prediction is left alone");
+
+            /* Pretend the job has been running far past its estimate */
+            char* primary = strdup(job->assigned_worker_id);
+            job->started_at = time(NULL) - 100;
+            TEST_ASSERT(scheduler_speculate_stragglers(scheduler) == 1 && log.assigned == 2,
+                        "Straggler duplicated");
+            TEST_ASSERT(job->speculative_worker_id &&
+                        strcmp(job->speculative_worker_id, primary) != 0,
+                        "Duplicate runs on the other worker");
+            TEST_ASSERT(scheduler_speculate_stragglers(scheduler) == 0,
+                        "Job is duplicated only once");
+
+            /* Outputs go to the scheduled path, and only for workers holding a copy */
+            char* output = scheduler_get_job_output(scheduler, job->speculative_worker_id,
+                                                    job->job_id);
+            TEST_ASSERT(output && strcmp(output, "out/job.o") == 0,
+                        "Output path comes from the job");
+            free(output);
+            TEST_ASSERT(!scheduler_get_job_output(scheduler, "intruder", job->job_id),
+                        "No output path for a worker without the job");
+
+            /* A failed duplicate leaves the primary running */
+            scheduler_report_worker_failure(scheduler, job->speculative_worker_id,
+                                            job->job_id, "worker crashed");
+            TEST_ASSERT(job->state != JOB_STATE_FAILED && !job->speculative_worker_id &&
+                        strcmp(job->assigned_worker_id, primary) == 0,
+                        "Failed duplicate dropped, primary keeps running");
+            TEST_ASSERT(job->retry_count == 0, "Failed duplicate costs no retry");
+
+            /* The second duplicate finishes first and wins */
+            TEST_ASSERT(scheduler_speculate_stragglers(scheduler) == 1, "Straggler duplicated again");
+            char* duplicate = strdup(job->speculative_worker_id);
+            DistributedJobResult result = {0};
+            result.success = true;
+            result.duration_sec = 1.0;
+            scheduler_report_worker_result(scheduler, duplicate, job->job_id, &result);
+            TEST_ASSERT(job->state == JOB_STATE_COMPLETED, "First result completes the job");
+            TEST_ASSERT(strcmp(log.revoked_from, primary) == 0, "Losing copy revoked");
+            TEST_ASSERT(first->active_jobs + second->active_jobs == 1,
+                        "Losing copy keeps its slot until it stops");
+            scheduler_report_copy_released(scheduler, primary, job->job_id);
+            TEST_ASSERT(first->active_jobs == 0 && second->active_jobs == 0,
+                        "Both slots released");
+
+            SchedulerStats stats = scheduler_get_stats(scheduler);
+            TEST_ASSERT(stats.speculative_launched == 2 && stats.speculative_wins == 1,
+                        "Stats count launches and wins");
+            TEST_ASSERT(stats.speculative_wasted_sec >= 100.0, "Wasted work recorded");
+
+            /* A retry is timed from its new assignment, not the failed attempt */
+            ScheduledJob* retried = scheduler_submit_job(scheduler, NULL, &spec, 0);
+            TEST_ASSERT(retried && scheduler_process_queue(scheduler) == 1, "Second job assigned");
+            if (retried) {
+                retried->started_at = time(NULL) - 100;
+                scheduler_report_worker_failure(scheduler, retried->assigned_worker_id,
+                                                retried->job_id, "worker crashed");
+                TEST_ASSERT(scheduler_process_queue(scheduler) == 1 &&
+                            retried->retry_count == 1 && retried->started_at == 0,
+                            "Retry clears the previous start time");
+                TEST_ASSERT(scheduler_speculate_stragglers(scheduler) == 0,
+                            "Retried job is not duplicated at once");
+            }
+
+            free(primary);
+            free(duplicate);
+        }
+
+        scheduler_free(scheduler);
+    }
+    worker_registry_free(registry);
+
+    printf("  Speculative execution tests complete\n");
+}
+
+static void test_adaptive_capacity(void) {
+    printf("\n=== Test 15: Adaptive Capacity ===\n");
+
+    WorkerRegistryConfig reg_config = worker_registry_config_default();
+    WorkerRegistry* registry = worker_registry_create(&reg_config);
+    WorkerSystemInfo info = {0};
+    info.cpu_cores = 4;
+    RemoteWorker* fast = registry ? worker_registry_register(registry, &info, NULL) : NULL;
+    RemoteWorker* slow = registry ? worker_registry_register(registry, &info, NULL) : NULL;
+    TEST_ASSERT(fast && slow, "Register two workers");
+
+    if (fast && slow) {
+        TEST_ASSERT(worker_slot_limit(fast) == 4, "Capacity starts at declared slots");
+
+        /* Jobs on time keep full capacity and build up metrics */
+        for (int i = 0; i < 4; i++) {
+            worker_registry_record_job_complete(registry, fast, JOB_TYPE_CUSTOM, true, 1.0, 1.0);
+            worker_registry_record_job_complete(registry, slow, JOB_TYPE_CUSTOM, true, 4.0, 4.0);
+        }
+        const WorkerJobMetrics* m = &fast->metrics[JOB_TYPE_CUSTOM];
+        TEST_ASSERT(m->samples == 4 && m->latency_sec > 0.99 && m->latency_sec < 1.01 &&
+                    m->failure_rate == 0.0, "Per-type latency and failure rate tracked");
+        TEST_ASSERT(m->throughput > 0 && fast->metrics[JOB_TYPE_COMPILE].samples == 0,
+                    "Throughput tracked for the job's type only");
+        TEST_ASSERT(worker_slot_limit(fast) == 4, "On-time jobs keep full capacity");
+
+        /* A job far slower than usual halves capacity */
+        worker_registry_record_job_complete(registry, fast, JOB_TYPE_CUSTOM, true, 10.0, 1.0);
+        TEST_ASSERT(worker_slot_limit(fast) == 2, "Slowdown halves capacity");
+        worker_registry_update_job_count(registry, fast, 2);
+        TEST_ASSERT(fast->state == WORKER_STATE_BUSY, "Worker busy at effective capacity");
+        worker_registry_update_job_count(registry, fast, -2);
+
+        /* Quick failures are the job's fault, not overload */
+        worker_registry_record_job_complete(registry, fast, JOB_TYPE_CUSTOM, false, 0.1, 1.0);
+        TEST_ASSERT(fast->metrics[JOB_TYPE_CUSTOM].failure_rate > 0 &&
+                    worker_slot_limit(fast) == 2, "Failure counted without cutting capacity");
+
+        /* Additive increase: roughly one slot per window of on-time jobs */
+        for (int i = 0; i < 3; i++) {
+            worker_registry_record_job_complete(registry, fast, JOB_TYPE_CUSTOM, true, 1.0, 1.0);
+        }
+        TEST_ASSERT(worker_slot_limit(fast) == 3, "Capacity recovers additively");
+
+        /* Least-latency selection uses observed latency, not declared slots */
+        WorkScheduler* scheduler = NULL;
+        SchedulerConfig config = scheduler_config_default();
+        config.lb_algorithm = LB_LEAST_LATENCY;
+        scheduler = scheduler_create(&config, registry);
+        if (scheduler) {
+            scheduler_start(scheduler);
+            DistributedJob spec = {0};
+            spec.type = JOB_TYPE_CUSTOM;
+            spec.build_command = "true";
+            ScheduledJob* job = scheduler_submit_job(scheduler, NULL, &spec, 0);
+            TEST_ASSERT(job && scheduler_process_queue(scheduler) == 1 &&
+                        strcmp(job->assigned_worker_id, fast->id) == 0,
+                        "Least-latency picks the worker with lower observed latency");
+            scheduler_free(scheduler);
+        }
+    }
+    worker_registry_free(registry);
+
+    printf("  Adaptive capacity tests complete\n");
+}
+
+static void test_indexed_registry(void) {
+    printf("\n=== Test 16: Indexed Registry ===\n");
+
+    enum { WORKER_COUNT = 200 };
+    WorkerRegistryConfig reg_config = worker_registry_config_default();
+    WorkerRegistry* registry = worker_registry_create(&reg_config);
+    TEST_ASSERT(registry != NULL, "Create registry");
+    if (!registry) return;
+
+    RemoteWorker* workers[WORKER_COUNT] = {0};
+    WorkerSystemInfo info = {0};
+    info.cpu_cores = 2;
+    int registered = 0;
+    for (int i = 0; i < WORKER_COUNT; i++) {
+        NetworkConnection* conn = (NetworkConnection*)(uintptr_t)(0x1000 + i * 64);
+        workers[i] = worker_registry_register(registry, &info, conn);
+        if (!workers[i]) break;
+        /* Only every tenth worker can run C compiles */
+        uint32_t caps = (i % 10 == 0) ? WORKER_CAP_COMPILE_C : WORKER_CAP_MAKE;
+        worker_registry_set_profile(registry, workers[i], NULL, caps, 0);
+        registered++;
+    }
+    TEST_ASSERT(registered == WORKER_COUNT, "Register many workers");
+    if (registered != WORKER_COUNT) {
+        worker_registry_free(registry);
+        return;
+    }
+
+    bool found = true;
+    for (int i = 0; i < WORKER_COUNT; i++) {
+        NetworkConnection* conn = (NetworkConnection*)(uintptr_t)(0x1000 + i * 64);
+        found = found &&
+                worker_registry_find_by_id(registry, workers[i]->id) == workers[i] &&
+                worker_registry_find_by_connection(registry, conn) == workers[i];
+    }
+    TEST_ASSERT(found, "Find every worker by id and by connection");
+    TEST_ASSERT(worker_registry_find_by_id(registry, "no-such-worker") == NULL,
+                "Unknown id not found");
+
+    /* Capability bitmaps narrow the candidates */
+    WorkerSelectionCriteria criteria = {0};
+    criteria.required_capabilities = WORKER_CAP_COMPILE_C;
+    RemoteWorker* picked = worker_registry_select_worker(registry, &criteria);
+    TEST_ASSERT(picked && (picked->capabilities & WORKER_CAP_COMPILE_C),
+                "Selection honours required capabilities");
+    RemoteWorker* many[WORKER_COUNT];
+    TEST_ASSERT(worker_registry_select_workers(registry, &criteria, WORKER_COUNT, many) ==
+                WORKER_COUNT / 10, "Multi-select returns only capable workers");
+
+    /* Online membership follows state changes */
+    worker_registry_set_state(registry, workers[0], WORKER_STATE_OFFLINE);
+    TEST_ASSERT(worker_registry_get_online_count(registry) == WORKER_COUNT - 1,
+                "Offline worker leaves the online set");
+    TEST_ASSERT(worker_registry_select_workers(registry, &criteria, WORKER_COUNT, many) ==
+                WORKER_COUNT / 10 - 1, "Offline worker no longer selected");
+    worker_registry_set_state(registry, workers[0], WORKER_STATE_ONLINE);
+    TEST_ASSERT(worker_registry_get_online_count(registry) == WORKER_COUNT,
+                "Worker rejoins the online set");
+
+    /* Capability changes are re-indexed */
+    worker_registry_set_profile(registry, workers[1], NULL, WORKER_CAP_COMPILE_C, 0);
+    TEST_ASSERT(worker_registry_select_workers(registry, &criteria, WORKER_COUNT, many) ==
+                WORKER_COUNT / 10 + 1, "Profile change updates the capability index");
+
+    /* Round robin rotates and skips full workers */
+    RemoteWorker* first = worker_registry_select_round_robin(registry, 0);
+    RemoteWorker* second = worker_registry_select_round_robin(registry, 1);
+    TEST_ASSERT(first && second && first != second, "Round robin rotates");
+    worker_registry_update_job_count(registry, first, 2);
+    TEST_ASSERT(worker_registry_select_round_robin(registry, 0) == second,
+                "Round robin skips a full worker");
+    worker_registry_update_job_count(registry, first, -2);
+
+    /* Unregistered workers drop out of lookups and selection */
+    char removed_id[64];
+    snprintf(removed_id, sizeof(removed_id), "%s", workers[10]->id);
+    worker_registry_unregister(registry, removed_id, "test");
+    TEST_ASSERT(worker_registry_find_by_id(registry, removed_id) == NULL &&
+                worker_registry_find_by_connection(
+                    registry, (NetworkConnection*)(uintptr_t)(0x1000 + 10 * 64)) == NULL,
+                "Unregistered worker removed from indexes");
+    TEST_ASSERT(worker_registry_select_workers(registry, &criteria, WORKER_COUNT, many) ==
+                WORKER_COUNT / 10, "Selection works after unregister");
+    TEST_ASSERT(worker_registry_find_by_id(registry, workers[20]->id) == workers[20],
+                "Remaining workers still indexed");
+
+    worker_registry_free(registry);
+}
+
+static bool digest_hex_equals(const uint8_t* digest, const char* hex) {
+    char buf[SHA256_DIGEST_SIZE * 2 + 1];
+    for (int i = 0; i < SHA256_DIGEST_SIZE; i++) {
+        snprintf(buf + i * 2, 3, "%02x", digest[i]);
+    }
+    return strcmp(buf, hex) == 0;
+}
+
+static void test_token_hashing(void) {
+    printf("\n=== Test 17: Token Hashing ===\n");
+
+    /* FIPS 180-4 and RFC 4231 vectors */
+    uint8_t digest[SHA256_DIGEST_SIZE];
+    sha256("abc", 3, digest);
+    TEST_ASSERT(digest_hex_equals(digest,
+                "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"),
+                "SHA-256 of \"abc\"");
+    const char* two_blocks = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    sha256(two_blocks, strlen(two_blocks), digest);
+    TEST_ASSERT(digest_hex_equals(digest,
+                "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"),
+                "SHA-256 across a block boundary");
+    const char* hmac_data = "what do ya want for nothing?";
+    hmac_sha256("Jefe", 4, hmac_data, strlen(hmac_data), digest);
+    TEST_ASSERT(digest_hex_equals(digest,
+                "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"),
+                "HMAC-SHA256 of RFC 4231 case 2");
+
+    char* signature = auth_create_hmac(hmac_data, strlen(hmac_data), "Jefe", 4);
+    TEST_ASSERT(signature && auth_verify_hmac(hmac_data, strlen(hmac_data), signature, "Jefe", 4) &&
+                !auth_verify_hmac(hmac_data, strlen(hmac_data), signature, "Jeff", 4),
+                "HMAC signatures verify only under their key");
+    free(signature);
+    TEST_ASSERT(auth_secure_equals("secret", "secret") && !auth_secure_equals("secret", "secreT") &&
+                !auth_secure_equals("secret", "secret2") && !auth_secure_equals(NULL, "x"),
+                "Secure compare");
+
+    enum { TOKEN_COUNT = 2000 };
+    AuthConfig config = auth_config_default();
+    config.max_tokens = TOKEN_COUNT;
+    config.hmac_secret = "challenge-secret";
+    config.hmac_secret_len = strlen(config.hmac_secret);
+    AuthContext* auth = auth_context_create(&config);
+    TEST_ASSERT(auth != NULL, "Create auth context");
+    if (!auth) return;
+
+    char** values = calloc(TOKEN_COUNT, sizeof(char*));
+    int issued = 0;
+    for (int i = 0; i < TOKEN_COUNT && values; i++) {
+        AuthToken* token = auth_token_generate(auth, AUTH_TOKEN_TYPE_WORKER, "worker", 3600);
+        if (!token) break;
+        values[i] = strdup(token->token_value);
+        auth_token_free(token);
+        issued++;
+    }
+    TEST_ASSERT(issued == TOKEN_COUNT && auth_token_count(auth) == TOKEN_COUNT,
+                "Issue many tokens");
+    TEST_ASSERT(auth_token_generate(auth, AUTH_TOKEN_TYPE_WORKER, "extra", 0) == NULL,
+                "Token limit enforced");
+
+    if (issued == TOKEN_COUNT) {
+        bool all_valid = true;
+        for (int i = 0; i < TOKEN_COUNT; i++) {
+            all_valid = all_valid && auth_token_validate(auth, values[i], NULL) == AUTH_RESULT_SUCCESS;
+        }
+        TEST_ASSERT(all_valid, "Every issued token validates");
+
+        /* Only digests are stored */
+        AuthToken* stored = auth_token_lookup(auth, values[7]);
+        TEST_ASSERT(stored && stored->token_value == NULL && stored->token_hash &&
+                    stored->token_salt && !strstr(values[7], stored->token_hash),
+                    "Context stores a salted digest, not the value");
+        TEST_ASSERT(stored && auth_token_lookup_by_id(auth, stored->token_id) == stored,
+                    "Lookup by ID finds the stored token");
+
+        /* A known ID with the wrong secret, or a bare secret, is rejected */
+        char* forged = strdup(values[7]);
+        char* secret = strchr(forged, '.');
+        secret[1] = secret[1] == 'A' ? 'B' : 'A';
+        TEST_ASSERT(auth_token_validate(auth, forged, NULL) == AUTH_RESULT_INVALID_TOKEN,
+                    "Tampered secret rejected");
+        TEST_ASSERT(auth_token_validate(auth, strchr(values[7], '.') + 1, NULL) ==
+                    AUTH_RESULT_INVALID_TOKEN, "Secret without its ID rejected");
+        free(forged);
+
+        TEST_ASSERT(stored && auth_token_revoke(auth, stored->token_id, "test") &&
+                    auth_token_validate(auth, values[7], NULL) == AUTH_RESULT_REVOKED_TOKEN,
+                    "Revoked token found by ID and refused");
+    }
+
+    for (int i = 0; i < issued; i++) free(values[i]);
+    free(values);
+
+    /* Challenge responses are HMAC-SHA256 of the challenge under the shared secret */
+    AuthChallenge* challenge = auth_challenge_create(auth);
+    TEST_ASSERT(challenge != NULL, "Create challenge");
+    if (challenge) {
+        char* response = auth_create_hmac(challenge->challenge_data,
+                                          strlen(challenge->challenge_data),
+                                          config.hmac_secret, config.hmac_secret_len);
+        TEST_ASSERT(auth_challenge_verify(auth, challenge->challenge_id, response) ==
+                    AUTH_RESULT_SUCCESS, "Challenge response verifies");
+        free(response);
+    }
+
+    auth_context_free(auth);
+}
+
+/* ============================================================
+ * Test 19: Compile Database
+ * ============================================================ */
+
+#define COMPILE_DB_FILE "test_compile_commands.json"
+#define COMPILE_DB_BULK 5000
+
+static void test_compile_database(void) {
+    printf("\n=== Test 18: Compile Database ===\n");
+
+    FILE* f = fopen(COMPILE_DB_FILE, "w");
+    TEST_ASSERT(f != NULL, "Write compilation database");
+    if (!f) return;
+
+    /* CMake style: per-TU depfile names, the same flags otherwise */
+    fprintf(f, "[\n"
+        "{\"directory\": \"/proj/build\", \"file\": \"/proj/src/a.c\", \"output\": \"a.o\",\n"
+        " \"arguments\": [\"/usr/bin/cc\", \"-DNDEBUG\", \"-I../include\", \"-I\", \"/opt/inc\",\n"
+        "   \"-O2\", \"-MD\", \"-MT\", \"a.o\", \"-MF\", \"a.o.d\", \"-o\", \"a.o\", \"-c\", \"/proj/src/a.c\"]},\n"
+        "{\"directory\": \"/proj/build\", \"file\": \"/proj/src/b.c\",\n"
+        " \"command\": \"/usr/bin/cc -DNDEBUG -I../include -I /opt/inc -O2 -MD -MT b.o -MF b.o.d -o b.o -c /proj/src/b.c\"},\n"
+        "{\"directory\": \"/proj/build\", \"file\": \"../src/c.c\",\n"
+        " \"command\": \"cc \\\"-DMSG=\\\\\\\"hello world\\\\\\\"\\\" -I../other -o c.o -c ../src/c.c\"},\n"
+        "{\"directory\": \"/proj/build\", \"command\": \"cc -c orphan.c\"}\n"
+        "]\n");
+    fclose(f);
+
+    CompileDatabase* db = compile_db_load(COMPILE_DB_FILE);
+    TEST_ASSERT(db != NULL, "Load compilation database");
+    if (!db) {
+        remove(COMPILE_DB_FILE);
+        return;
+    }
+
+    CompileDbStats stats = compile_db_get_stats(db);
+    TEST_ASSERT(compile_db_count(db) == 3, "Entries with a file are loaded");
+    TEST_ASSERT(stats.skipped == 1, "Entry without a file is skipped");
+
+    const CompileCommand* a = compile_db_get(db, 0);
+    const CompileCommand* b = compile_db_get(db, 1);
+    const CompileCommand* c = compile_db_get(db, 2);
+    TEST_ASSERT(compile_db_get(db, 3) == NULL, "Out of range entry is NULL");
+
+    TEST_ASSERT(strcmp(a->compiler, "/usr/bin/cc") == 0, "Compiler is argv[0]");
+    TEST_ASSERT(a->arg_count == 2 && strcmp(a->args[0], "-DNDEBUG") == 0 &&
+                strcmp(a->args[1], "-O2") == 0, "Flags exclude -c, -o, -I, depfile and source");
+    TEST_ASSERT(a->include_count == 2 && strcmp(a->includes[0], "../include") == 0 &&
+                strcmp(a->includes[1], "/opt/inc") == 0, "Both -I forms are include paths");
+    TEST_ASSERT(a->depfile_arg_count == 5, "Depfile options kept apart");
+    TEST_ASSERT(strcmp(b->output, "b.o") == 0, "Output taken from -o");
+
+    /* Same flags in "arguments" and "command" form intern to one list */
+    TEST_ASSERT(a->args == b->args && a->includes == b->includes,
+                "Equal flag lists are shared");
+    TEST_ASSERT(a->directory == b->directory, "Equal strings are shared");
+    TEST_ASSERT(c->arg_count == 1 && strcmp(c->args[0], "-DMSG=\"hello world\"") == 0,
+                "Quoted command words are unescaped");
+
+    DistributedJob* job = compile_db_make_job(a);
+    TEST_ASSERT(job != NULL, "Make compile job");
+    if (job) {
+        TEST_ASSERT(job->type == JOB_TYPE_COMPILE &&
+                    strcmp(job->source_file, "/proj/src/a.c") == 0 &&
+                    strcmp(job->output_file, "a.o") == 0 &&
+                    strcmp(job->working_dir, "/proj/build") == 0, "Job fields from entry");
+        TEST_ASSERT(job->arg_count == 2 && job->include_count == 2,
+                    "Job has the TU's flags and include paths");
+        distributed_job_free(job);
+    }
+
+    DistributedJob* jobs[4];
+    int made = compile_db_decompose(db, jobs, 4);
+    TEST_ASSERT(made == 3, "Decompose makes one job per entry");
+    for (int i = 0; i < made; i++) distributed_job_free(jobs[i]);
+
+    /* Cache keys follow flags and include paths, not depfile names */
+    char* key_a = compile_db_cache_key(a);
+    CompileCommand renamed = *a;
+    renamed.depfile_args = b->depfile_args;
+    char* key_renamed = compile_db_cache_key(&renamed);
+    CompileCommand moved = *a;
+    moved.includes = c->includes;
+    moved.include_count = c->include_count;
+    char* key_moved = compile_db_cache_key(&moved);
+    TEST_ASSERT(key_a && key_renamed && strcmp(key_a, key_renamed) == 0,
+                "Depfile names do not change the cache key");
+    TEST_ASSERT(key_a && key_moved && strcmp(key_a, key_moved) != 0,
+                "Include paths change the cache key");
+    free(key_a);
+    free(key_renamed);
+    free(key_moved);
+
+    char* line = compile_db_command_line(c);
+    TEST_ASSERT(line && strcmp(line, "cc '-DMSG=\"hello world\"' -I../other -c -o c.o ../src/c.c") == 0,
+                "Command line quotes words for the shell");
+    free(line);
+
+    compile_db_free(db);
+
+    /* A larger file streams through chunk boundaries */
+    f = fopen(COMPILE_DB_FILE, "w");
+    if (f) {
+        fprintf(f, "[");
+        for (int i = 0; i < COMPILE_DB_BULK; i++) {
+            fprintf(f, "%s{\"directory\":\"/proj/build/lib%d\",\"file\":\"src/file%d.cpp\","
+                    "\"command\":\"c++ -std=c++17 -O2 -Wall -Wextra -DLIB=%d -I../include "
+                    "-MD -MF file%d.o.d -o file%d.o -c src/file%d.cpp\"}",
+                    i ? ",\n" : "", i % 10, i, i % 10, i, i, i);
+        }
+        fprintf(f, "]");
+        fclose(f);
+    }
+
+    db = compile_db_load(COMPILE_DB_FILE);
+    stats = compile_db_get_stats(db);
+    TEST_ASSERT(db && compile_db_count(db) == COMPILE_DB_BULK, "Bulk database loads");
+    int flag_lists = 0;
+    for (int i = 0; db && i < COMPILE_DB_BULK; i++) {
+        const CompileCommand* cmd = compile_db_get(db, i);
+        bool seen = false;
+        for (int j = 0; j < i && j < 10 && !seen; j++) {
+            seen = compile_db_get(db, j)->args == cmd->args;
+        }
+        if (!seen) flag_lists++;
+    }
+    TEST_ASSERT(db && flag_lists == 10, "One shared flag list per library");
+    TEST_ASSERT(db && stats.string_bytes < stats.bytes_read / 2,
+                "Interned text is much smaller than the file");
+    if (db) {
+        const CompileCommand* last = compile_db_get(db, COMPILE_DB_BULK - 1);
+        TEST_ASSERT(last && strcmp(last->file, "src/file4999.cpp") == 0 &&
+                    strcmp(last->output, "file4999.o") == 0, "Last entry read intact");
+    }
+    compile_db_free(db);
+
+    TEST_ASSERT(compile_db_load("no_such_compile_commands.json") == NULL,
+                "Missing database fails to load");
+    remove(COMPILE_DB_FILE);
+}
+
+/* ============================================================
+ * Local Executor Tests
+ * ============================================================ */
+
+#define LOCAL_DIR "test_local_build"
+#define LOCAL_CACHE "test_local_cache"
+#define LOCAL_DB LOCAL_DIR "/compile_commands.json"
+
+#ifndef _WIN32
+/* Database compiling each named source in dir to obj/<name>.o with a depfile */
+static bool write_local_db(const char* dir, const char* const* names, int count) {
+    FILE* f = fopen(LOCAL_DB, "w");
+    if (!f) return false;
+    fprintf(f, "[\n");
+    for (int i = 0; i < count; i++) {
+        fprintf(f, "%s{\"directory\": \"%s\", \"file\": \"%s.c\",\n"
+                   " \"command\": \"cc -Iinclude -O0 -MD -MF obj/%s.o.d -o obj/%s.o -c %s.c\"}",
+                i ? ",\n" : "", dir, names[i], names[i], names[i], names[i]);
+    }
+    fprintf(f, "\n]\n");
+    fclose(f);
+    return true;
+}
+
+static int count_objects(const char* const* names, int count) {
+    int found = 0;
+    for (int i = 0; i < count; i++) {
+        char path[256];
+        snprintf(path, sizeof(path), LOCAL_DIR "/obj/%s.o", names[i]);
+        if (file_exists(path)) found++;
+    }
+    return found;
+}
+
+static void remove_objects(const char* const* names, int count) {
+    for (int i = 0; i < count; i++) {
+        char path[256];
+        snprintf(path, sizeof(path), LOCAL_DIR "/obj/%s.o", names[i]);
+        remove(path);
+    }
+}
+
+static LocalBuildStats run_local(ArtifactCache* cache, int max_jobs, bool keep_going,
+                                 BuildResult** out_result) {
+    LocalBuildStats stats = {0};
+    CompileDatabase* db = compile_db_load(LOCAL_DB);
+    if (!db) return stats;
+
+    LocalExecutorConfig config = local_executor_config_default();
+    config.max_jobs = max_jobs;
+    config.cache = cache;
+    config.keep_going = keep_going;
+    config.join_jobserver = false;
+
+    BuildResult* result = local_execute_compile_db(db, &config, &stats);
+    if (out_result) {
+        *out_result = result;
+    } else {
+        build_result_free(result);
+    }
+    compile_db_free(db);
+    return stats;
+}
+#endif
+
+static void test_local_executor(void) {
+    printf("\n=== Test 19: Local Compile Fan-out ===\n");
+
+#ifdef _WIN32
+    printf("  (process pool is POSIX-only, skipped)\n");
+#else
+    char* cc = tool_find_in_path("cc");
+    char cwd[1024];
+    if (!cc || !getcwd(cwd, sizeof(cwd))) {
+        printf("  (no C compiler on PATH, local compiles skipped)\n");
+        free(cc);
+        return;
+    }
+    free(cc);
+
+    char dir[1100];
+    snprintf(dir, sizeof(dir), "%s/" LOCAL_DIR, cwd);
+    dir_create(LOCAL_DIR);
+    dir_create(LOCAL_DIR "/include");
+
+    static const char* const names[] = { "alpha", "beta", "gamma", "delta" };
+    const int count = 4;
+    bool ok = write_text(LOCAL_DIR "/include/shared.h", "#define SHARED 1\n");
+    for (int i = 0; i < count; i++) {
+        char path[256], text[256];
+        snprintf(path, sizeof(path), LOCAL_DIR "/%s.c", names[i]);
+        snprintf(text, sizeof(text),
+                 "#include \"shared.h\"\nint %s_value(void) { return SHARED + %d; }\n",
+                 names[i], i);
+        ok = ok && write_text(path, text);
+    }
+    ok = ok && write_local_db(dir, names, count);
+    TEST_ASSERT(ok, "Write sources and compilation database");
+
+    ArtifactCacheConfig cache_config = artifact_cache_config_default();
+    cache_config.cache_dir = LOCAL_CACHE;
+    ArtifactCache* cache = artifact_cache_create(&cache_config);
+    TEST_ASSERT(cache && artifact_cache_init(cache), "Create local cache");
+
+    /* Cold: every TU compiles, object directories are created */
+    BuildResult* result = NULL;
+    LocalBuildStats stats = run_local(cache, 2, false, &result);
+    TEST_ASSERT(result && result->success, "Cold build succeeded");
+    TEST_ASSERT(stats.total == count && stats.compiled == count && stats.cache_hits == 0,
+                "Cold build compiles every TU");
+    TEST_ASSERT(stats.peak_running >= 1 && stats.peak_running <= 2,
+                "Never more compiles than slots");
+    TEST_ASSERT(count_objects(names, count) == count, "Objects written");
+    build_result_free(result);
+
+    /* Warm, in a fresh cache instance as a new process would see it */
+    artifact_cache_free(cache);
+    cache = artifact_cache_create(&cache_config);
+    remove_objects(names, count);
+    stats = run_local(cache, 2, false, NULL);
+    TEST_ASSERT(stats.cache_hits == count && stats.compiled == 0,
+                "Warm build restores every object from the cache");
+    TEST_ASSERT(count_objects(names, count) == count, "Restored objects in place");
+
+    /* A header edit changes every object key */
+    write_text(LOCAL_DIR "/include/shared.h", "#define SHARED 2\n");
+    remove_objects(names, count);
+    stats = run_local(cache, 2, false, NULL);
+    TEST_ASSERT(stats.compiled == count && stats.cache_hits == 0,
+                "Header change recompiles dependents");
+
+    /* Failures stop the fan-out unless keep_going is set; cached entries
+     * are restored while compiles run, so the second one is uncached */
+    static const char* const mixed[] = { "broken", "epsilon" };
+    write_text(LOCAL_DIR "/broken.c", "int broken(void) { return }\n");
+    write_text(LOCAL_DIR "/epsilon.c", "int epsilon_value(void) { return 5; }\n");
+    write_local_db(dir, mixed, 2);
+    stats = run_local(cache, 1, false, &result);
+    TEST_ASSERT(result && !result->success && result->exit_code != 0,
+                "Failed compile fails the build");
+    TEST_ASSERT(result && strstr(result->stdout_output, "FAILED: broken.c") != NULL,
+                "Failure output collected");
+    TEST_ASSERT(stats.failed == 1 && stats.not_run == 1, "Remaining entries not run");
+    build_result_free(result);
+
+    stats = run_local(cache, 1, true, NULL);
+    TEST_ASSERT(stats.failed == 1 && stats.compiled == 1 && stats.not_run == 0,
+                "keep_going finishes the other entries");
+
+    artifact_cache_free(cache);
+    dir_delete_recursive(LOCAL_DIR);
+    dir_delete_recursive(LOCAL_CACHE);
+#endif
+
+    printf("  Local executor tests complete\n");
+}
+
 /* ============================================================
  * Main
  * ============================================================ */
@@ -336,6 +1850,19 @@ int main(void) {
     test_build_options();
     test_version_and_availability();
     test_strategy_names();
+    test_binary_frames();
+    test_file_transfer();
+    test_congested_workers();
+    test_worker_execution();
+    test_critical_path_scheduling();
+    test_event_dispatch();
+    test_job_batching();
+    test_speculative_execution();
+    test_adaptive_capacity();
+    test_indexed_registry();
+    test_token_hashing();
+    test_compile_database();
+    test_local_executor();
 
     /* Summary */
     printf("\n=== Test Summary ===\n");